@@ -9,6 +9,7 @@
 #include "PicoNetDriver.generated.h"
 
 class FOnlineSessionPico;
+class IPicoNetTransport;
 
 /**
  *
@@ -28,11 +29,18 @@ private:
 	//TMap<uint64, EConnectionState> PendingClientConnections;
 	TMap<FString, EConnectionState> PendingClientConnections;
 
+	/** The relay packets go through, picked by InitConnect or InitListen unless set before */
+	TSharedPtr<IPicoNetTransport> Transport;
+
 public:
 	// todo
 	//TMap<uint64, UPicoNetConnection*> Connections;
 	TMap<FString, UPicoNetConnection*> Connections;
 
+	/** Makes the driver use the given relay, e.g. an endpoint of a private FPicoLoopbackNetwork. Call before InitConnect or InitListen. */
+	void SetTransport(TSharedPtr<IPicoNetTransport> InTransport) { Transport = InTransport; }
+	const TSharedPtr<IPicoNetTransport>& GetTransport() const { return Transport; }
+
 	// Begin UNetDriver interface.
 	virtual bool IsAvailable() const override;
 	virtual bool InitBase(bool bInitAsClient, FNetworkNotify* InNotify, const FURL& URL, bool bReuseAddressAndPort, FString& Error) override;
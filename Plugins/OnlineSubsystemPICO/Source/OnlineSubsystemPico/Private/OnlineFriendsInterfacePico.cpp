@@ -5,12 +5,12 @@
 #include "OnlineSubsystemPicoPrivate.h"
 #include "OnlineError.h"
 #include "OnlineSubsystemPicoPackage.h"
+#include "PicoUserProfileCache.h"
 
 const FString FOnlineFriendsPico::FriendsListInviteableUsers = TEXT("invitableUsers");
-void FOnlineFriendsPico::OnQueryFriendsComplete(ppfMessageHandle Message, bool bIsError, int32 LocalUserNum, const FString& ListName, TMap<FString, TSharedRef<FOnlineFriend>>& OutList, bool bAppendToExistingMap, const FOnReadFriendsListComplete& Delegate)
+void FOnlineFriendsPico::OnQueryFriendsComplete(ppfMessageHandle Message, bool bIsError, const FString& ListName, TMap<FString, TSharedRef<FOnlineFriend>>& OutList, TSharedRef<FListRefresh> Refresh)
 {
     UE_LOG_ONLINE_FRIEND(Log, TEXT("PPF_GAME FOnlineFriendsPico::On Query Friends Complete Recive!"));
-    FString ErrorStr;
     if (bIsError)
     {
         auto Error = ppf_Message_GetError(Message);
@@ -18,49 +18,60 @@ void FOnlineFriendsPico::OnQueryFriendsComplete(ppfMessageHandle Message, bool b
         FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
         FString ErrorMessageStr = UTF8_TO_TCHAR(ErrorMessage) + FString(". Error Code: ") + ErrorCode;
         UE_LOG_ONLINE_FRIEND(Log, TEXT("PPF_GAME FOnlineFriendsPico::On Query Friends Complete Recive Failed :%s"), *ErrorMessageStr);
-        ErrorStr = UTF8_TO_TCHAR(ErrorMessage);
-        if (bAppendToExistingMap)
-        {
-            Delegate.ExecuteIfBound(LocalUserNum, true, ListName, ErrorStr);
-            return;
-        }
-        Delegate.ExecuteIfBound(LocalUserNum, false, ListName, ErrorStr);
+        // Pages already read stay in the list, but the read failed and is not cached.
+        CompleteRefresh(*Refresh, false, UTF8_TO_TCHAR(ErrorMessage));
         return;
     }
+
+    FPicoUserProfileCache& ProfileCache = *PicoSubsystem.GetPicoUserProfileCache();
+    if (Refresh->NumPages++ == 0)
+    {
+        ProfileCache.BeginRefresh();
+    }
+
     auto UserArray = ppf_Message_GetUserArray(Message);
     auto UserNum = ppf_UserArray_GetSize(UserArray);
     UE_LOG_ONLINE_FRIEND(Log, TEXT("PPF_GAME FOnlineFriendsPico::On Query Friends Complete FriendNum :%i"), UserNum);
-    if (!bAppendToExistingMap)
-    {
-        OutList.Empty(UserNum);
-    }
 
+    // The list is updated in place page by page, so readers never see it empty halfway through a refresh,
+    // and users that did not change keep their entry.
+    bool bListChanged = false;
     for (size_t FriendIndex = 0; FriendIndex < UserNum; ++FriendIndex)
     {
-        auto Friend = ppf_UserArray_GetElement(UserArray, FriendIndex);
-        FString FriendId = UTF8_TO_TCHAR(ppf_User_GetID(Friend));
-        FString FriendDisplayName = UTF8_TO_TCHAR(ppf_User_GetDisplayName(Friend));
-        auto FriendInviteToken = ppf_User_GetInviteToken(Friend);
-        FString FriendInviteTokenString(UTF8_TO_TCHAR((FriendInviteToken != nullptr) ? FriendInviteToken : ""));
-        FString SmallImageUrl = UTF8_TO_TCHAR(ppf_User_GetSmallImageUrl(Friend));
-        FString PresencePackage = UTF8_TO_TCHAR(ppf_User_GetPresencePackage(Friend));
-        FString ImageUrl = UTF8_TO_TCHAR(ppf_User_GetImageUrl(Friend));
-        ppfGender Gender = ppf_User_GetGender(Friend);
-        FString Presence = UTF8_TO_TCHAR(ppf_User_GetPresence(Friend));
-        FString PresenceDeeplinkMessage = UTF8_TO_TCHAR(ppf_User_GetPresenceDeeplinkMessage(Friend));
-        FString PresenceDestinationApiName = UTF8_TO_TCHAR(ppf_User_GetPresenceDestinationApiName(Friend));
-        FString PresenceLobbySessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceLobbySessionId(Friend));
-        FString PresenceMatchSessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceMatchSessionId(Friend));
-        auto FriendPresenceStatus = ppf_User_GetPresenceStatus(Friend);
-        FString PresenceExtra = ppf_User_GetPresenceExtra(Friend);
-        TSharedRef<FOnlinePicoFriend> OnlineFriend(new FOnlinePicoFriend(FriendId, FriendDisplayName, FriendPresenceStatus, FriendInviteTokenString,
-            ImageUrl, Gender, SmallImageUrl, PresencePackage, Presence, PresenceDeeplinkMessage, PresenceDestinationApiName, PresenceLobbySessionId,
-            PresenceMatchSessionId, PresenceExtra));
-
-        UE_LOG_ONLINE(Display, TEXT("PPF_GAME add friend in outlist: FriendId: %s, DisplayName: %s, InviteToken: %s"), *FriendId, *FriendDisplayName, *FriendInviteTokenString);
-        OutList.Add(FriendId, OnlineFriend);
+        bool bProfileChanged = false;
+        TSharedPtr<FOnlinePicoFriend> OnlineFriend = ProfileCache.FindOrUpdate(ppf_UserArray_GetElement(UserArray, FriendIndex), &bProfileChanged);
+        if (!OnlineFriend.IsValid())
+        {
+            continue;
+        }
+        const TSharedRef<FOnlineFriend>* Existing = OutList.Find(OnlineFriend->GetUserStrId());
+        if (!Existing || &Existing->Get() != OnlineFriend.Get())
+        {
+            UE_LOG_ONLINE_FRIEND(Verbose, TEXT("PPF_GAME add friend in outlist: FriendId: %s, DisplayName: %s"), *OnlineFriend->GetUserStrId(), *OnlineFriend->GetDisplayName());
+            OutList.Add(OnlineFriend->GetUserStrId(), OnlineFriend.ToSharedRef());
+            bListChanged = true;
+        }
+        bListChanged |= bProfileChanged;
+        Refresh->Seen.Add(OnlineFriend.Get());
     }
+
     bool bHasPaging = ppf_UserArray_HasNextPage(UserArray);
+    if (!bHasPaging)
+    {
+        for (auto It = OutList.CreateIterator(); It; ++It)
+        {
+            if (!Refresh->Seen.Contains(&It.Value().Get()))
+            {
+                It.RemoveCurrent();
+                bListChanged = true;
+            }
+        }
+    }
+    if (bListChanged)
+    {
+        TriggerOnFriendsChangeDelegates(Refresh->Waiters[0].LocalUserNum);
+    }
+
     if (bHasPaging)
     {
         UE_LOG_ONLINE_FRIEND(Log, TEXT("FOnlineFriendsPico::GetNextUserArray!"));
@@ -69,23 +80,46 @@ void FOnlineFriendsPico::OnQueryFriendsComplete(ppfMessageHandle Message, bool b
             ppf_User_GetNextUserArrayPage(ppf_UserArray_GetNextPageParam(UserArray)),
             FPicoMessageOnCompleteDelegate::CreateLambda
             (
-                [this, LocalUserNum, ListName, &OutList, Delegate](ppfMessageHandle InMessage, bool bInIsError)
+                [this, ListName, &OutList, Refresh](ppfMessageHandle InMessage, bool bInIsError)
                 {
-                    OnQueryFriendsComplete(InMessage, bInIsError, LocalUserNum, ListName, OutList, /* bAppendToExistingMap */ true, Delegate);
+                    OnQueryFriendsComplete(InMessage, bInIsError, ListName, OutList, Refresh);
                 }
             )
         );
     }
     else
     {
-        Delegate.ExecuteIfBound(LocalUserNum, true, ListName, ErrorStr);
+        CompleteRefresh(*Refresh, true, FString());
+    }
+}
+
+void FOnlineFriendsPico::CompleteRefresh(FListRefresh& Refresh, bool bWasSuccessful, const FString& ErrorStr)
+{
+    if (Refresh.NumPages > 0)
+    {
+        PicoSubsystem.GetPicoUserProfileCache()->EndRefresh(Refresh.Waiters[0].ListName);
+    }
+    if (&Refresh == PlayerFriendsRefresh.Get())
+    {
+        // The pending callback still holds a reference, so Refresh outlives this.
+        PlayerFriendsRefresh.Reset();
+        if (bWasSuccessful)
+        {
+            PlayerFriendsReadTime = FPlatformTime::Seconds();
+        }
+    }
+
+    TArray<FListRefresh::FWaiter> Waiters = MoveTemp(Refresh.Waiters);
+    for (const FListRefresh::FWaiter& Waiter : Waiters)
+    {
+        Waiter.Delegate.ExecuteIfBound(Waiter.LocalUserNum, bWasSuccessful, Waiter.ListName, ErrorStr);
     }
 }
 
 FOnlineFriendsPico::FOnlineFriendsPico(FOnlineSubsystemPico& InSubsystem)
     :PicoSubsystem(InSubsystem)
 {
-
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("FriendsListCacheSeconds"), FriendsListCacheSeconds, GEngineIni);
 }
 
 bool FOnlineFriendsPico::ReadFriendsList(int32 LocalUserNum, const FString& ListName, const FOnReadFriendsListComplete& Delegate /*= FOnReadFriendsListComplete()*/)
@@ -93,14 +127,35 @@ bool FOnlineFriendsPico::ReadFriendsList(int32 LocalUserNum, const FString& List
     UE_LOG_ONLINE_FRIEND(Log, TEXT("FOnlineFriendsPico::ReadFriendsList!"));
     if (ListName == EFriendsLists::ToString(EFriendsLists::Default) || ListName == EFriendsLists::ToString(EFriendsLists::OnlinePlayers))
     {
+        if (FriendsListCacheSeconds > 0.0f && PlayerFriendsReadTime > 0.0 && FPlatformTime::Seconds() - PlayerFriendsReadTime < FriendsListCacheSeconds)
+        {
+            // Still fresh, presence changes seen since then have been applied in place.
+            PicoSubsystem.ExecuteNextTick
+            (
+                [LocalUserNum, ListName, Delegate]()
+                {
+                    Delegate.ExecuteIfBound(LocalUserNum, true, ListName, FString());
+                }
+            );
+            return true;
+        }
+        if (PlayerFriendsRefresh.IsValid())
+        {
+            PlayerFriendsRefresh->Waiters.Add({ LocalUserNum, ListName, Delegate });
+            return true;
+        }
+
+        TSharedRef<FListRefresh> Refresh = MakeShared<FListRefresh>();
+        Refresh->Waiters.Add({ LocalUserNum, ListName, Delegate });
+        PlayerFriendsRefresh = Refresh;
         PicoSubsystem.AddAsyncTask
         (
             ppf_User_GetLoggedInUserFriends(),
             FPicoMessageOnCompleteDelegate::CreateLambda
             (
-                [this, LocalUserNum, ListName, Delegate](ppfMessageHandle Message, bool bIsError)
+                [this, ListName, Refresh](ppfMessageHandle Message, bool bIsError)
                 {
-                    OnQueryFriendsComplete(Message, bIsError, LocalUserNum, ListName, PlayerFriends, /*bAppendToExistingMap */ false, Delegate);
+                    OnQueryFriendsComplete(Message, bIsError, ListName, PlayerFriends, Refresh);
                 }
             )
         );
@@ -122,14 +177,16 @@ bool FOnlineFriendsPico::ReadFriendsList(int32 LocalUserNum, const FString& List
         auto RoomOptions = ppf_RoomOptions_Create();
         ppf_RoomOptions_SetRoomId(RoomOptions, RoomId);
 
+        TSharedRef<FListRefresh> Refresh = MakeShared<FListRefresh>();
+        Refresh->Waiters.Add({ LocalUserNum, ListName, Delegate });
         PicoSubsystem.AddAsyncTask
         (
             ppf_Room_GetInvitableUsers2(RoomOptions),
             FPicoMessageOnCompleteDelegate::CreateLambda
             (
-                [this, LocalUserNum, ListName, Delegate](ppfMessageHandle Message, bool bIsError)
+                [this, ListName, Refresh](ppfMessageHandle Message, bool bIsError)
                 {
-                    OnQueryFriendsComplete(Message, bIsError, LocalUserNum, ListName, InvitableUsers, /* bAppendToExistingMap */ false, Delegate);
+                    OnQueryFriendsComplete(Message, bIsError, ListName, InvitableUsers, Refresh);
                 }
             )
         );
@@ -27,22 +27,37 @@ private:
     TSharedRef<const FUniqueNetIdPico> UserId;
 #endif
 
+    // The profile cache updates entries in place, so everything but the ID can change.
+    friend class FPicoUserProfileCache;
+
     const FString StrUserId;
-    const FString DisplayName;
+    FString DisplayName;
     FOnlineUserPresence Presence;
-    const FString InviteToken;
-    const FString ImageUrl;
-    ppfGender Gender;
-    const FString SmallImageUrl;
-    const FString PresencePackage;
-    ppfUserPresenceStatus UserPresenceStatus;
-    const FString Presencestr;
-    const FString PresenceDeeplinkMessage;
-    const FString PresenceDestinationApiName;
-    const FString PresenceLobbySessionId;
-    const FString PresenceMatchSessionId;
-    const FString PresenceExtra;
+    FString InviteToken;
+    FString ImageUrl;
+    ppfGender Gender = ppfGender_Unknown;
+    FString SmallImageUrl;
+    FString PresencePackage;
+    ppfUserPresenceStatus UserPresenceStatus = ppfUserPresenceStatus_Unknown;
+    FString Presencestr;
+    FString PresenceDeeplinkMessage;
+    FString PresenceDestinationApiName;
+    FString PresenceLobbySessionId;
+    FString PresenceMatchSessionId;
+    FString PresenceExtra;
 public:
+    explicit FOnlinePicoFriend(const FString& StrId) :
+#if ENGINE_MAJOR_VERSION > 4
+        UserId(FUniqueNetIdPico::Create(StrId)),
+#elif ENGINE_MINOR_VERSION > 26
+        UserId(FUniqueNetIdPico::Create(StrId)),
+#elif ENGINE_MINOR_VERSION > 24
+        UserId(new FUniqueNetIdPico(StrId)),
+#endif
+        StrUserId(StrId)
+    {
+    }
+
     FOnlinePicoFriend(/*const ppfID ID*/const FString StrId, const FString& InDisplayName, ppfUserPresenceStatus FriendPresenceStatus,
         const FString& InInviteToken, const FString& InImageUrl, ppfGender InGender, const FString& InSmallImageUrl,
         const FString& InPresencePackage, const FString& InPresence, const FString& InPresenceDeeplinkMessage,
@@ -91,7 +106,7 @@ public:
 #endif
 
 
-    FString GetUserStrId() const
+    const FString& GetUserStrId() const
     {
         return StrUserId;
     }
@@ -208,10 +223,37 @@ private:
     // @brief Current friends map can user invite.
     TMap<FString, TSharedRef<FOnlineFriend>> InvitableUsers;
 
+    // @brief A list being read page by page. Callers asking for the same list meanwhile wait for it.
+    struct FListRefresh
+    {
+        struct FWaiter
+        {
+            int32 LocalUserNum;
+            FString ListName;
+            FOnReadFriendsListComplete Delegate;
+        };
+        TArray<FWaiter> Waiters;
+        // @brief Entries seen in this read, anything else is dropped from the list at the end.
+        TSet<const FOnlineFriend*> Seen;
+        int32 NumPages = 0;
+    };
+
+    // @brief The friends list read in flight, if any.
+    TSharedPtr<FListRefresh> PlayerFriendsRefresh;
+
+    // @brief When the friends list was last read completely, 0 if never.
+    double PlayerFriendsReadTime = 0.0;
+
+    // @brief A complete friends list younger than this is served without a request, 0 to always read.
+    // FriendsListCacheSeconds in [OnlineSubsystemPico] of Engine.ini.
+    float FriendsListCacheSeconds = 30.0f;
+
 PACKAGE_SCOPE:
 
 
-    void OnQueryFriendsComplete(ppfMessageHandle Message, bool bIsError, int32 LocalUserNum, const FString& ListName, TMap<FString, TSharedRef<FOnlineFriend>>& OutList, bool bAppendToExistingMap, const FOnReadFriendsListComplete& Delegate);
+    void OnQueryFriendsComplete(ppfMessageHandle Message, bool bIsError, const FString& ListName, TMap<FString, TSharedRef<FOnlineFriend>>& OutList, TSharedRef<FListRefresh> Refresh);
+
+    void CompleteRefresh(FListRefresh& Refresh, bool bWasSuccessful, const FString& ErrorStr);
 
 public:
 
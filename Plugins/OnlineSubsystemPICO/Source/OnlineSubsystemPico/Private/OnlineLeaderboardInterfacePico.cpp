@@ -3,6 +3,7 @@
 #include "OnlineLeaderboardInterfacePico.h"
 #include "OnlineSubsystemPicoPrivate.h"
 #include "OnlineIdentityPico.h"
+#include "PicoUserProfileCache.h"
 #include "OnlineSubsystemPico.h"
 #include "OnlineSessionSettings.h"
 #include "Misc/FileHelper.h"
@@ -149,7 +150,8 @@ void FOnlineLeaderboardPico::OnReadLeaderboardsComplete(ppfMessageHandle Message
 		auto LeaderboardEntry = ppf_LeaderboardEntryArray_GetElement(LeaderboardArray, i);
 		auto User = ppf_LeaderboardEntry_GetUser(LeaderboardEntry);
 		auto UserID = ppf_User_GetID(User);
-		FString NickName = UTF8_TO_TCHAR(ppf_User_GetDisplayName(User));
+		TSharedPtr<FOnlinePicoFriend> Profile = PicoSubsystem.GetPicoUserProfileCache()->FindOrUpdate(User);
+		FString NickName = Profile.IsValid() ? Profile->GetDisplayName() : FString();
 		auto Rank = ppf_LeaderboardEntry_GetRank(LeaderboardEntry);
 		auto Score = ppf_LeaderboardEntry_GetScore(LeaderboardEntry);
 		
@@ -6,18 +6,18 @@
 
 void FOnlineMessageMultiTaskPico::AddNewRequest(ppfRequest RequestId)
 {
-	InProgressRequests.Add(RequestId);
+	++NumInProgressRequests;
 	PicoSubsystem.AddAsyncTask(
 		RequestId,
-		FPicoMessageOnCompleteDelegate::CreateLambda([this, RequestId](ppfMessageHandle Message, bool bIsError)
+		FPicoMessageOnCompleteDelegate::CreateLambda([this](ppfMessageHandle Message, bool bIsError)
 	{
-		InProgressRequests.Remove(RequestId);
+		--NumInProgressRequests;
 		if (bIsError)
 		{
 			bDidAllRequestsFinishedSuccessfully = false;
 		}
 
-		if (InProgressRequests.Num() == 0)
+		if (NumInProgressRequests == 0)
 		{
 			Delegate.ExecuteIfBound();
 		}
@@ -14,8 +14,8 @@
 class FOnlineMessageMultiTaskPico
 {
 private:
-	/** Requests that are waiting to be completed */
-	TArray<ppfRequest> InProgressRequests;
+	/** Number of requests that are waiting to be completed */
+	int32 NumInProgressRequests = 0;
 
 protected:
 	bool bDidAllRequestsFinishedSuccessfully = true;
@@ -4,6 +4,10 @@
 #include "OnlineMessageTaskManagerPico.h"
 #include "OnlineSubsystemPicoPrivate.h"
 #include "PPF_Message.h"
+#include "HAL/Event.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/ScopeRWLock.h"
+#include "Misc/ConfigCacheIni.h"
 
 FString FOnlineAsyncTaskPico::ToString() const
 {
@@ -75,12 +79,93 @@ void FOnlineAsyncTaskPico::TaskReceiveMessage(ppfMessageHandle InMessageHandle,
     }
 }
 
+FOnlineAsyncTaskManagerPico::~FOnlineAsyncTaskManagerPico()
+{
+    StopMessageWorker();
+
+    FReceivedMessage Received;
+    while (PoppedMessages.Dequeue(Received))
+    {
+        ppf_FreeMessage(Received.MessageHandle);
+    }
+    while (ReceivedMessages.Dequeue(Received))
+    {
+        ppf_FreeMessage(Received.MessageHandle);
+    }
+}
+
 void FOnlineAsyncTaskManagerPico::OnlineTick()
 {
 }
 
-void FOnlineAsyncTaskManagerPico::TickTask()
+void FOnlineAsyncTaskManagerPico::StartMessageWorker()
+{
+    bool bDecodeOnWorker = true;
+    GConfig->GetBool(TEXT("OnlineSubsystemPico"), TEXT("bDecodeMessagesOnWorker"), bDecodeOnWorker, GEngineIni);
+    if (MessageWorkerThread || !bDecodeOnWorker || !FPlatformProcess::SupportsMultithreading())
+    {
+        return;
+    }
+    MessageWorker = MakeUnique<FMessageWorker>(*this);
+    MessageWorkerThread = FRunnableThread::Create(MessageWorker.Get(), TEXT("PicoMessageWorker"), 0, TPri_BelowNormal);
+    if (!MessageWorkerThread)
+    {
+        MessageWorker.Reset();
+    }
+    UE_LOG_ONLINE(Log, TEXT("Pico messages are decoded on %s"), MessageWorkerThread ? TEXT("a worker thread") : TEXT("the game thread"));
+}
+
+void FOnlineAsyncTaskManagerPico::StopMessageWorker()
+{
+    if (MessageWorkerThread)
+    {
+        MessageWorkerThread->Kill(true);
+        delete MessageWorkerThread;
+        MessageWorkerThread = nullptr;
+    }
+    MessageWorker.Reset();
+
+    // Whatever the worker did not get to is decoded here, ahead of anything popped later
+    DecodePoppedMessages();
+}
+
+FOnlineAsyncTaskManagerPico::FMessageWorker::FMessageWorker(FOnlineAsyncTaskManagerPico& InManager) :
+    Manager(InManager),
+    WorkEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+}
+
+FOnlineAsyncTaskManagerPico::FMessageWorker::~FMessageWorker()
+{
+    FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+    WorkEvent = nullptr;
+}
+
+uint32 FOnlineAsyncTaskManagerPico::FMessageWorker::Run()
+{
+    while (!bStopping)
+    {
+        WorkEvent->Wait();
+        Manager.DecodePoppedMessages();
+    }
+    return 0;
+}
+
+void FOnlineAsyncTaskManagerPico::FMessageWorker::Stop()
+{
+    bStopping = true;
+    WorkEvent->Trigger();
+}
+
+void FOnlineAsyncTaskManagerPico::FMessageWorker::Wake()
 {
+    WorkEvent->Trigger();
+}
+
+void FOnlineAsyncTaskManagerPico::PumpMessages()
+{
+    check(IsInGameThread());
+    bool bPopped = false;
     for (;;)
     {
         ppfMessageHandle MessageHandle = ppf_PopMessage();
@@ -88,33 +173,191 @@ void FOnlineAsyncTaskManagerPico::TickTask()
         {
             break;
         }
-        UE_LOG_ONLINE(Log, TEXT("OnlineTick Receive Message !"));
-        bool bIsError = ppf_Message_IsError(MessageHandle);
-        ppfRequest RequestId = ppf_Message_GetRequestID(MessageHandle);
-        UE_LOG_ONLINE(Log, TEXT("Receive request id: %llu!"), RequestId);
 
-        if (RequestTaskMap.Contains(RequestId))
+        FReceivedMessage Received;
+        Received.MessageHandle = MessageHandle;
+        Received.MessageType = ppf_Message_GetType(MessageHandle);
+        Received.RequestId = ppf_Message_GetRequestID(MessageHandle);
+        Received.bIsError = ppf_Message_IsError(MessageHandle);
+        if (MessageWorkerThread)
         {
-            auto Item = RequestTaskMap[RequestId];
-            Item->TaskReceiveMessage(MessageHandle, bIsError);
-            delete Item;
-            Item = nullptr;
-            RequestTaskMap.Remove(RequestId);
-            break;
+            PoppedMessages.Enqueue(MoveTemp(Received));
+            bPopped = true;
+        }
+        else
+        {
+            DecodeMessage(Received);
+            ReceivedMessages.Enqueue(MoveTemp(Received));
         }
+    }
+    if (bPopped)
+    {
+        MessageWorker->Wake();
+    }
+}
 
-        ppfMessageType MessageType = ppf_Message_GetType(MessageHandle);
-        if (NotificationMap.Contains(MessageType))
+void FOnlineAsyncTaskManagerPico::DecodeMessage(FReceivedMessage& Received) const
+{
+    if (Received.bIsError)
+    {
+        return;
+    }
+    const double DecodeStart = FPlatformTime::Seconds();
+    {
+        FReadScopeLock ReadLock(DecodersLock);
+        if (const FPicoMessageDecoder* Decoder = Decoders.Find(Received.MessageType))
         {
-            UE_LOG_ONLINE(Log, TEXT("Receive MessageTypeID: %i"), static_cast<int32>(MessageType));
-            FOnlineAsyncEventPico* NewEvent = new FOnlineAsyncEventPico(PicoSubsystem, MessageHandle, bIsError, NotificationMap[MessageType]);
-            NewEvent->TriggerDelegates();
-            delete NewEvent;
-            NewEvent = nullptr;
-            break;
+            Received.Decoded = (*Decoder)(Received.MessageHandle);
         }
+    }
+    Received.DecodeSeconds = FPlatformTime::Seconds() - DecodeStart;
+}
+
+void FOnlineAsyncTaskManagerPico::DecodePoppedMessages()
+{
+    FReceivedMessage Received;
+    while (PoppedMessages.Dequeue(Received))
+    {
+        DecodeMessage(Received);
+        ReceivedMessages.Enqueue(MoveTemp(Received));
+    }
+}
+
+void FOnlineAsyncTaskManagerPico::TickTask()
+{
+    PumpMessages();
+
+    FReceivedMessage Received;
+    while (ReceivedMessages.Dequeue(Received))
+    {
+        DispatchMessage(Received);
+    }
+}
+
+void FOnlineAsyncTaskManagerPico::DispatchMessage(FReceivedMessage& Received)
+{
+    const double DispatchStart = FPlatformTime::Seconds();
+    ppfMessageHandle MessageHandle = Received.MessageHandle;
+    UE_LOG_ONLINE(Log, TEXT("Receive request id: %llu, MessageTypeID: %i"), Received.RequestId, static_cast<int32>(Received.MessageType));
+
+    DispatchingMessage = MessageHandle;
+    DispatchingDecoded = Received.Decoded.Get();
+
+    if (FOnlineAsyncTaskPico** Task = RequestTaskMap.Find(Received.RequestId))
+    {
+        FOnlineAsyncTaskPico* Item = *Task;
+        RequestTaskMap.Remove(Received.RequestId);
+        Item->TaskReceiveMessage(MessageHandle, Received.bIsError);
+        delete Item;
+    }
+    else if (NotificationMap.Contains(Received.MessageType))
+    {
+        FOnlineAsyncEventPico NewEvent(PicoSubsystem, MessageHandle, Received.bIsError, NotificationMap[Received.MessageType]);
+        NewEvent.TriggerDelegates();
+    }
+    else
+    {
         ppf_FreeMessage(MessageHandle);
     }
+
+    DispatchingMessage = nullptr;
+    DispatchingDecoded = nullptr;
+
+    const double DispatchSeconds = FPlatformTime::Seconds() - DispatchStart;
+    FPicoMessageTiming& Timing = MessageTimings.FindOrAdd(Received.MessageType);
+    Timing.Count++;
+    Timing.DecodeSeconds += Received.DecodeSeconds;
+    Timing.DispatchSeconds += DispatchSeconds;
+    Timing.MaxDispatchSeconds = FMath::Max(Timing.MaxDispatchSeconds, DispatchSeconds);
+}
+
+void FOnlineAsyncTaskManagerPico::RegisterDecoder(ppfMessageType MessageType, FPicoMessageDecoder Decoder)
+{
+    FWriteScopeLock WriteLock(DecodersLock);
+    Decoders.Add(MessageType, MoveTemp(Decoder));
+}
+
+const FPicoDecodedMessage* FOnlineAsyncTaskManagerPico::GetDecodedMessage(ppfMessageHandle Message) const
+{
+    return Message == DispatchingMessage ? DispatchingDecoded : nullptr;
+}
+
+void FOnlineAsyncTaskManagerPico::DumpMessageTimings(FOutputDevice& Ar) const
+{
+    Ar.Logf(TEXT("Pico message timings (%s, %d interned IDs):"), MessageWorkerThread ? TEXT("worker decode") : TEXT("game thread decode"), IdInterner.Num());
+    for (const auto& TimingKV : MessageTimings)
+    {
+        const FPicoMessageTiming& Timing = TimingKV.Value;
+        Ar.Logf(TEXT("  MessageType 0x%08x: Count: %lld, Decode avg: %.3f ms, Dispatch avg: %.3f ms, Dispatch max: %.3f ms"),
+            static_cast<uint32>(TimingKV.Key), Timing.Count,
+            Timing.DecodeSeconds * 1000.0 / Timing.Count, Timing.DispatchSeconds * 1000.0 / Timing.Count, Timing.MaxDispatchSeconds * 1000.0);
+    }
+}
+
+int32 FPicoIdInterner::Intern(const char* Utf8Id)
+{
+    if (!Utf8Id)
+    {
+        Utf8Id = "";
+    }
+    const int32 Length = FCStringAnsi::Strlen(Utf8Id);
+    const uint32 Hash = FCrc::MemCrc32(Utf8Id, Length);
+
+    {
+        FReadScopeLock ReadLock(Lock);
+        const int32 Existing = FindLocked(Utf8Id, Hash);
+        if (Existing != INDEX_NONE)
+        {
+            return Existing;
+        }
+    }
+
+    FWriteScopeLock WriteLock(Lock);
+    const int32 Existing = FindLocked(Utf8Id, Hash);
+    if (Existing != INDEX_NONE)
+    {
+        return Existing;
+    }
+    const int32 InternedId = Ids.Add(new FString(UTF8_TO_TCHAR(Utf8Id)));
+    Utf8Ids.Emplace(Utf8Id, Length + 1);
+    IdsByHash.Add(Hash, InternedId);
+    return InternedId;
+}
+
+int32 FPicoIdInterner::Find(const char* Utf8Id) const
+{
+    if (!Utf8Id)
+    {
+        Utf8Id = "";
+    }
+    const uint32 Hash = FCrc::MemCrc32(Utf8Id, FCStringAnsi::Strlen(Utf8Id));
+    FReadScopeLock ReadLock(Lock);
+    return FindLocked(Utf8Id, Hash);
+}
+
+int32 FPicoIdInterner::FindLocked(const char* Utf8Id, uint32 Hash) const
+{
+    for (auto It = IdsByHash.CreateConstKeyIterator(Hash); It; ++It)
+    {
+        if (FCStringAnsi::Strcmp(Utf8Ids[It.Value()].GetData(), Utf8Id) == 0)
+        {
+            return It.Value();
+        }
+    }
+    return INDEX_NONE;
+}
+
+const FString& FPicoIdInterner::Resolve(int32 InternedId) const
+{
+    static const FString Empty;
+    FReadScopeLock ReadLock(Lock);
+    return Ids.IsValidIndex(InternedId) ? Ids[InternedId] : Empty;
+}
+
+int32 FPicoIdInterner::Num() const
+{
+    FReadScopeLock ReadLock(Lock);
+    return Ids.Num();
 }
 
 void FOnlineAsyncTaskManagerPico::CollectedRequestTask(ppfRequest Request, FOnlineAsyncTaskPico* InTask)
@@ -4,6 +4,7 @@
 #include "OnlineSubsystemPicoPrivate.h"
 #include "Interfaces/OnlineIdentityInterface.h"
 #include "OnlineFriendsInterfacePico.h"
+#include "PicoUserProfileCache.h"
 #include "OnlineSubsystemPico.h"
 #include "OnlineSessionSettings.h"
 #include "OnlineSubsystemPicoTypes.h"
@@ -87,6 +88,9 @@ FOnlineSessionPico::FOnlineSessionPico(FOnlineSubsystemPico& InSubsystem) :
     OnRoomNotificationUpdateMembershipLockStatusHandle =
         PicoSubsystem.GetOrAddNotify(ppfMessageType_Room_UpdateMembershipLockStatus)
         .AddRaw(this, &FOnlineSessionPico::OnRoomNotificationUpdateMembershipLockStatus);
+
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("RoomSessionCacheTTL"), RoomSessionCacheTTL, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("RoomDataStoreUpdateInterval"), RoomDataStoreUpdateInterval, GEngineIni);
 }
 
 FOnlineSessionPico::~FOnlineSessionPico()
@@ -483,60 +487,195 @@ bool FOnlineSessionPico::UpdateRoomDataStore(FName SessionName, FOnlineSessionSe
         SaveLog(ELogVerbosity::Type::Warning, FString::Printf(TEXT("UpdateRoomDataStore cannot find session: %s"), *SessionName.ToString()));
         return false;
     }
-    int NewDataStoreSize = 0;
-    for (auto Setting : UpdatedSessionSettings.Settings)
+    auto RoomId = GetRoomIDOfSession(*Session);
+    FRoomDataStoreSync& Sync = RoomDataStoreSyncs.FindOrAdd(SessionName);
+    if (Sync.RoomId != RoomId)
     {
-        NewDataStoreSize++;
+        Sync = FRoomDataStoreSync();
+        Sync.RoomId = RoomId;
     }
-    int index = 0;
 
-    ppfKeyValuePairArray DataStore = ppf_KeyValuePairArray_Create(NewDataStoreSize);
+    // Only keys whose value differs from what the room holds or is about to hold are queued.
+    int32 ChangedKeys = 0;
     for (auto& Setting : UpdatedSessionSettings.Settings)
     {
-        auto Key = new FTCHARToUTF8(*Setting.Key.ToString());
-        auto Value = new FTCHARToUTF8(*Setting.Value.Data.ToString());
-        auto item = ppf_KeyValuePairArray_GetElement(DataStore, index);
-        ppf_KeyValuePair_SetKey(item, Key->Get());
-        ppf_KeyValuePair_SetStringValue(item, Value->Get());
-        index++;
+        FString Key = Setting.Key.ToString();
+        FString Value = Setting.Value.Data.ToString();
+        const FString* Known = Sync.Pending.Find(Key);
+        if (!Known)
+        {
+            Known = Sync.InFlight.Find(Key);
+        }
+        if (!Known)
+        {
+            Known = Sync.Sent.Find(Key);
+        }
+        if (Known && *Known == Value)
+        {
+            RoomDataStoreKeysSkipped++;
+            continue;
+        }
+        Sync.Pending.Add(MoveTemp(Key), MoveTemp(Value));
+        ChangedKeys++;
     }
+    SaveLog(ELogVerbosity::Type::Display, FString::Printf(TEXT("UpdateRoomDataStore SessionName: %s, ChangedKeys: %d, PendingKeys: %d, bRequestInFlight: %d"),
+        *SessionName.ToString(), ChangedKeys, Sync.Pending.Num(), Sync.bRequestInFlight));
 
-    if (NewDataStoreSize > 0)
+    if (Sync.Pending.Num() == 0)
     {
-        PicoSubsystem.AddAsyncTask(
-            ppf_Room_UpdateDataStore(GetRoomIDOfSession(*Session), DataStore, NewDataStoreSize),
-            FPicoMessageOnCompleteDelegate::CreateLambda([this, SessionName](ppfMessageHandle Message, bool bIsError)
-                {
-                    if (bIsError)
-                    {
-                        auto Error = ppf_Message_GetError(Message);
-                        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-                        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-                        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-                        SaveLog(ELogVerbosity::Type::Error, FString::Printf(TEXT("UpdateRoomDataStore ErrorMessage: %s"), *FString(ErrorMessage)));
-                        TriggerOnUpdateSessionCompleteDelegates(SessionName, false);
-                        return;
-                    }
+        if (Sync.bRequestInFlight)
+        {
+            // Nothing new, but the caller still expects the pending values to have landed.
+            Sync.InFlightCompletions++;
+        }
+        else
+        {
+            TriggerOnUpdateSessionCompleteDelegates(SessionName, true);
+        }
+        return true;
+    }
 
-                    SaveLog(ELogVerbosity::Type::Display, FString::Printf(TEXT("UpdateRoomDataStore no error")));
-                    auto NewSession = GetNamedSession(SessionName);
-                    if (NewSession == nullptr)
-                    {
-                        SaveLog(ELogVerbosity::Type::Error, FString::Printf(TEXT("UpdateRoomDataStore Session: %s does not exist"), *SessionName.ToString()));
-                        TriggerOnUpdateSessionCompleteDelegates(SessionName, false);
-                        return;
-                    }
-                    auto Room = ppf_Message_GetRoom(Message);
-                    UpdateSessionFromRoom(*NewSession, Room);
-                    TriggerOnUpdateSessionCompleteDelegates(SessionName, true);
-                }));
-        ppf_KeyValuePairArray_Destroy(DataStore);
+    Sync.PendingCompletions++;
+    FlushRoomDataStore(SessionName);
+    return true;
+}
+
+void FOnlineSessionPico::FlushRoomDataStore(FName SessionName)
+{
+    FRoomDataStoreSync* Sync = RoomDataStoreSyncs.Find(SessionName);
+    if (Sync == nullptr || Sync->bRequestInFlight || Sync->Pending.Num() == 0)
+    {
+        return;
     }
-    else
+    const double Now = FPlatformTime::Seconds();
+    if (Sync->LastRequestTime > 0.0 && Now - Sync->LastRequestTime < RoomDataStoreUpdateInterval)
+    {
+        // Coalesced into the request TickRoomDataStoreUpdates sends once the interval has passed.
+        return;
+    }
+
+    int32 DataStoreSize = Sync->Pending.Num();
+    int32 Bytes = 0;
+    TArray<TUniquePtr<FTCHARToUTF8>> Utf8Strings;
+    Utf8Strings.Reserve(DataStoreSize * 2);
+    ppfKeyValuePairArray DataStore = ppf_KeyValuePairArray_Create(DataStoreSize);
+    int32 Index = 0;
+    for (auto& Pair : Sync->Pending)
+    {
+        auto& Key = Utf8Strings.Add_GetRef(MakeUnique<FTCHARToUTF8>(*Pair.Key));
+        auto& Value = Utf8Strings.Add_GetRef(MakeUnique<FTCHARToUTF8>(*Pair.Value));
+        auto Item = ppf_KeyValuePairArray_GetElement(DataStore, Index);
+        ppf_KeyValuePair_SetKey(Item, Key->Get());
+        ppf_KeyValuePair_SetStringValue(Item, Value->Get());
+        Bytes += Key->Length() + Value->Length();
+        Index++;
+    }
+
+    Sync->InFlight = MoveTemp(Sync->Pending);
+    Sync->Pending.Reset();
+    Sync->InFlightCompletions = Sync->PendingCompletions;
+    Sync->PendingCompletions = 0;
+    Sync->bRequestInFlight = true;
+    Sync->LastRequestTime = Now;
+    RoomDataStoreRequestLog.Add(TPair<double, int32>(Now, Bytes));
+
+    SaveLog(ELogVerbosity::Type::Display, FString::Printf(TEXT("FlushRoomDataStore SessionName: %s, Keys: %d, Bytes: %d"), *SessionName.ToString(), DataStoreSize, Bytes));
+    PicoSubsystem.AddAsyncTask(
+        ppf_Room_UpdateDataStore(Sync->RoomId, DataStore, DataStoreSize),
+        FPicoMessageOnCompleteDelegate::CreateRaw(this, &FOnlineSessionPico::OnUpdateRoomDataStoreComplete, SessionName));
+    ppf_KeyValuePairArray_Destroy(DataStore);
+}
+
+void FOnlineSessionPico::OnUpdateRoomDataStoreComplete(ppfMessageHandle Message, bool bIsError, FName SessionName)
+{
+    int32 Completions = 1;
+    if (FRoomDataStoreSync* Sync = RoomDataStoreSyncs.Find(SessionName))
+    {
+        Completions = FMath::Max(Sync->InFlightCompletions, 1);
+        if (!bIsError)
+        {
+            Sync->Sent.Append(Sync->InFlight);
+        }
+        // On error the room keeps its old values, so the next UpdateSession sends these keys again.
+        Sync->InFlight.Reset();
+        Sync->InFlightCompletions = 0;
+        Sync->bRequestInFlight = false;
+    }
+
+    if (bIsError)
+    {
+        auto Error = ppf_Message_GetError(Message);
+        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
+        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
+        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
+        SaveLog(ELogVerbosity::Type::Error, FString::Printf(TEXT("UpdateRoomDataStore ErrorMessage: %s"), *FString(ErrorMessage)));
+        for (int32 i = 0; i < Completions; i++)
+        {
+            TriggerOnUpdateSessionCompleteDelegates(SessionName, false);
+        }
+        return;
+    }
+
+    SaveLog(ELogVerbosity::Type::Display, FString::Printf(TEXT("UpdateRoomDataStore no error")));
+    auto NewSession = GetNamedSession(SessionName);
+    if (NewSession == nullptr)
+    {
+        SaveLog(ELogVerbosity::Type::Error, FString::Printf(TEXT("UpdateRoomDataStore Session: %s does not exist"), *SessionName.ToString()));
+        RoomDataStoreSyncs.Remove(SessionName);
+        for (int32 i = 0; i < Completions; i++)
+        {
+            TriggerOnUpdateSessionCompleteDelegates(SessionName, false);
+        }
+        return;
+    }
+    auto Room = ppf_Message_GetRoom(Message);
+    UpdateSessionFromRoom(*NewSession, Room);
+    for (int32 i = 0; i < Completions; i++)
     {
         TriggerOnUpdateSessionCompleteDelegates(SessionName, true);
     }
-    return true;
+}
+
+void FOnlineSessionPico::SyncRoomDataStoreFromRoom(FName SessionName, ppfRoomHandle Room)
+{
+    FRoomDataStoreSync* Sync = RoomDataStoreSyncs.Find(SessionName);
+    if (Sync == nullptr)
+    {
+        return;
+    }
+    auto DataStore = ppf_Room_GetDataStore(Room);
+    auto DataStoreSize = ppf_DataStore_GetNumKeys(DataStore);
+    Sync->Sent.Empty(DataStoreSize);
+    for (size_t DataStoreIndex = 0; DataStoreIndex < DataStoreSize; DataStoreIndex++)
+    {
+        auto Key = ppf_DataStore_GetKey(DataStore, DataStoreIndex);
+        Sync->Sent.Add(UTF8_TO_TCHAR(Key), UTF8_TO_TCHAR(ppf_DataStore_GetValue(DataStore, Key)));
+    }
+}
+
+void FOnlineSessionPico::TickRoomDataStoreUpdates()
+{
+    for (auto& SyncKV : RoomDataStoreSyncs)
+    {
+        if (!SyncKV.Value.bRequestInFlight && SyncKV.Value.Pending.Num() > 0)
+        {
+            FlushRoomDataStore(SyncKV.Key);
+        }
+    }
+}
+
+void FOnlineSessionPico::GetRoomDataStoreTrafficStats(int32& OutRequestsPerMinute, int32& OutBytesPerMinute, int64& OutKeysSkipped)
+{
+    const double WindowStart = FPlatformTime::Seconds() - 60.0;
+    RoomDataStoreRequestLog.RemoveAll([WindowStart](const TPair<double, int32>& Request) { return Request.Key < WindowStart; });
+
+    OutRequestsPerMinute = RoomDataStoreRequestLog.Num();
+    OutBytesPerMinute = 0;
+    for (auto& Request : RoomDataStoreRequestLog)
+    {
+        OutBytesPerMinute += Request.Value;
+    }
+    OutKeysSkipped = RoomDataStoreKeysSkipped;
 }
 
 bool FOnlineSessionPico::EndSession(FName SessionName)
@@ -823,7 +962,10 @@ bool FOnlineSessionPico::FindModeratedRoomSessions(const TSharedRef<FOnlineSessi
                 {
                     SearchResultsSize = SearchSettings->MaxSearchResults;
                 }
-                SearchSettings->SearchResults.Reset(SearchResultsSize);
+                // Results are updated in place, so searching again with the same search only copies the rooms that changed.
+                PruneRoomSessionCache();
+                int32 RoomsRebuilt = 0;
+                int32 RoomsReused = 0;
                 int32 BuildUniqueId = GetBuildUniqueId();
                 SaveLog(ELogVerbosity::Type::Display, FString::Printf(TEXT("FindModeratedRoomSessions GetBuildUniqueId(): %d"), BuildUniqueId));
                 for (size_t i = 0; i < SearchResultsSize; i++)
@@ -836,12 +978,13 @@ bool FOnlineSessionPico::FindModeratedRoomSessions(const TSharedRef<FOnlineSessi
                         SaveLog(ELogVerbosity::Type::Warning, FString::Printf(TEXT("FindModeratedRoomSessions ServerBuildId != 0 && ServerBuildId != BuildUniqueId")));
                         // continue;
                     }
-                    auto Session = CreateSessionFromRoom(Room);
-                    auto SearchResult = FOnlineSessionSearchResult();
-                    SearchResult.Session = Session.Get();
-                    SearchResult.PingInMs = 0;
-                    SearchSettings->SearchResults.Add(MoveTemp(SearchResult));
+                    bool bRebuilt = false;
+                    auto Session = GetOrCreateCachedSession(Room, bRebuilt);
+                    bRebuilt ? ++RoomsRebuilt : ++RoomsReused;
+                    SetCachedSearchResult(SearchSettings->SearchResults, (int32)i, Session.Get()).PingInMs = 0;
                 }
+                SearchSettings->SearchResults.SetNum((int32)SearchResultsSize);
+                RecordSearchCacheStats(TEXT("FindModeratedRoomSessions"), RoomsRebuilt, RoomsReused);
                 SearchSettings->SearchState = EOnlineAsyncTaskState::Done;
                 TriggerOnFindSessionsCompleteDelegates(true);
             }));
@@ -887,7 +1030,10 @@ bool FOnlineSessionPico::FindMatchmakingSessions(const FString Pool, const TShar
                 {
                     SearchResultsSize = SearchSettings->MaxSearchResults;
                 }
-                SearchSettings->SearchResults.Reset(SearchResultsSize);
+                // Results are updated in place, so searching again with the same search only copies the rooms that changed.
+                PruneRoomSessionCache();
+                int32 RoomsRebuilt = 0;
+                int32 RoomsReused = 0;
                 int32 BuildUniqueId = GetBuildUniqueId();
                 SaveLog(ELogVerbosity::Type::Display, FString::Printf(TEXT("FindMatchmakingSessions GetBuildUniqueId(): %d"), BuildUniqueId));
                 for (size_t i = 0; i < SearchResultsSize; i++)
@@ -901,12 +1047,14 @@ bool FOnlineSessionPico::FindMatchmakingSessions(const FString Pool, const TShar
                         SaveLog(ELogVerbosity::Type::Warning, FString::Printf(TEXT("FindMatchmakingSessions ServerBuildId != BuildUniqueId")));
                         // continue;
                     }
-                    auto Session = CreateSessionFromRoom(Room);
-                    auto SearchResult = FOnlineSessionSearchResult();
-                    SearchResult.Session = Session.Get();
+                    bool bRebuilt = false;
+                    auto Session = GetOrCreateCachedSession(Room, bRebuilt);
+                    bRebuilt ? ++RoomsRebuilt : ++RoomsReused;
+                    FOnlineSessionSearchResult& SearchResult = SetCachedSearchResult(SearchSettings->SearchResults, (int32)i, Session.Get());
                     SearchResult.PingInMs = ppf_MatchmakingRoom_HasPingTime(MatchmakingRoom) ? ppf_MatchmakingRoom_GetPingTime(MatchmakingRoom) : 0;
-                    SearchSettings->SearchResults.Add(MoveTemp(SearchResult));
                 }
+                SearchSettings->SearchResults.SetNum((int32)SearchResultsSize);
+                RecordSearchCacheStats(TEXT("FindMatchmakingSessions"), RoomsRebuilt, RoomsReused);
                 SearchSettings->SearchState = EOnlineAsyncTaskState::Done;
                 TriggerOnFindSessionsCompleteDelegates(true);
             }));
@@ -1374,6 +1522,7 @@ void FOnlineSessionPico::RemoveNamedSession(FName SessionName)
     {
         Sessions.Remove(SessionName);
     }
+    RoomDataStoreSyncs.Remove(SessionName);
 }
 
 EOnlineSessionState::Type FOnlineSessionPico::GetSessionState(FName SessionName) const
@@ -1452,6 +1601,90 @@ TSharedRef<FOnlineSession> FOnlineSessionPico::CreateSessionFromRoom(ppfRoomHand
     return MakeShareable(Session);
 }
 
+uint32 FOnlineSessionPico::GetRoomShape(ppfRoomHandle Room)
+{
+    auto RoomOwnerId = ppf_User_GetID(ppf_Room_GetOwner(Room));
+    uint32 Shape = RoomOwnerId ? FCrc::MemCrc32(RoomOwnerId, FCStringAnsi::Strlen(RoomOwnerId)) : 0;
+    Shape = HashCombine(Shape, GetTypeHash(ppf_Room_GetMaxUsers(Room)));
+    Shape = HashCombine(Shape, GetTypeHash((int32)ppf_Room_GetJoinPolicy(Room)));
+    Shape = HashCombine(Shape, GetTypeHash((int32)ppf_Room_GetJoinability(Room)));
+    Shape = HashCombine(Shape, GetTypeHash((int32)ppf_Room_GetType(Room)));
+    Shape = HashCombine(Shape, GetTypeHash((uint64)ppf_UserArray_GetSize(ppf_Room_GetUsers(Room))));
+    Shape = HashCombine(Shape, GetTypeHash((uint64)ppf_DataStore_GetNumKeys(ppf_Room_GetDataStore(Room))));
+    return Shape;
+}
+
+TSharedRef<FOnlineSession> FOnlineSessionPico::GetOrCreateCachedSession(ppfRoomHandle Room, bool& bOutRebuilt)
+{
+    const double Now = FPlatformTime::Seconds();
+    auto RoomId = ppf_Room_GetID(Room);
+    auto Shape = GetRoomShape(Room);
+
+    FCachedRoomSession& Cached = RoomSessionCache.FindOrAdd(RoomId);
+    Cached.LastSeenTime = Now;
+
+    bOutRebuilt = !Cached.Session.IsValid()
+        || Cached.BuiltRoomVersion != Cached.RoomVersion
+        || Cached.Shape != Shape
+        || Now - Cached.BuildTime > RoomSessionCacheTTL;
+    if (bOutRebuilt)
+    {
+        Cached.Session = CreateSessionFromRoom(Room);
+        Cached.Shape = Shape;
+        Cached.BuiltRoomVersion = Cached.RoomVersion;
+        Cached.BuildTime = Now;
+        ++Cached.Version;
+        SaveLog(ELogVerbosity::Type::Log, FString::Printf(TEXT("GetOrCreateCachedSession RoomId: %llu rebuilt, Version: %u"), RoomId, Cached.Version));
+    }
+    return Cached.Session.ToSharedRef();
+}
+
+FOnlineSessionSearchResult& FOnlineSessionPico::SetCachedSearchResult(TArray<FOnlineSessionSearchResult>& Results, int32 Index, const FOnlineSession& Session)
+{
+    if (!Results.IsValidIndex(Index))
+    {
+        FOnlineSessionSearchResult& Result = Results.AddDefaulted_GetRef();
+        Result.Session = Session;
+        return Result;
+    }
+    // Every build of a session gets its own SessionInfo, so a result sharing it was copied from this very build.
+    FOnlineSessionSearchResult& Result = Results[Index];
+    if (!Session.SessionInfo.IsValid() || Result.Session.SessionInfo != Session.SessionInfo)
+    {
+        Result.Session = Session;
+    }
+    return Result;
+}
+
+void FOnlineSessionPico::PruneRoomSessionCache()
+{
+    const double Now = FPlatformTime::Seconds();
+    for (auto It = RoomSessionCache.CreateIterator(); It; ++It)
+    {
+        if (Now - It.Value().LastSeenTime > RoomSessionCacheTTL)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+void FOnlineSessionPico::RecordSearchCacheStats(const TCHAR* SearchName, int32 Rebuilt, int32 Reused)
+{
+    LastSearchRoomsRebuilt = Rebuilt;
+    LastSearchRoomsReused = Reused;
+    TotalRoomsRebuilt += Rebuilt;
+    TotalRoomsReused += Reused;
+    SaveLog(ELogVerbosity::Type::Display, FString::Printf(TEXT("%s RoomsRebuilt: %d, RoomsReused: %d, CachedRooms: %d"), SearchName, Rebuilt, Reused, RoomSessionCache.Num()));
+}
+
+void FOnlineSessionPico::GetRoomSessionCacheStats(int32& OutLastSearchRebuilt, int32& OutLastSearchReused, int64& OutTotalRebuilt, int64& OutTotalReused) const
+{
+    OutLastSearchRebuilt = LastSearchRoomsRebuilt;
+    OutLastSearchReused = LastSearchRoomsReused;
+    OutTotalRebuilt = TotalRoomsRebuilt;
+    OutTotalReused = TotalRoomsReused;
+}
+
 void FOnlineSessionPico::LogRoomData(ppfRoomHandle Room) const
 {
     auto RoomId = ppf_Room_GetID(Room);
@@ -1489,6 +1722,8 @@ void FOnlineSessionPico::UpdateSessionFromRoom(FNamedOnlineSession & Session, pp
     for (size_t UserIndex = 0; UserIndex < UserArraySize; ++UserIndex)
     {
         auto User = ppf_UserArray_GetElement(UserArray, UserIndex);
+        // Keeps the presence of members who are also friends current without reading the friends list again.
+        PicoSubsystem.GetPicoUserProfileCache()->FindOrUpdate(User);
         FString UserId = UTF8_TO_TCHAR(ppf_User_GetID(User));
 #if ENGINE_MAJOR_VERSION > 4
         auto PlayerId = FUniqueNetIdPico::Create(UserId);
@@ -1749,10 +1984,16 @@ void FOnlineSessionPico::OnForcedLeaveRoom(ppfID RoomID)
         }
     }
     Sessions.Empty();
+    RoomDataStoreSyncs.Empty();
 }
 bool FOnlineSessionPico::OnUpdateRoomData(ppfRoomHandle Room, ppfID RoomId)
 {
     SaveLog(ELogVerbosity::Type::Log, FString::Printf(TEXT("OnUpdateRoomData begin RoomId: %llu"), RoomId));
+    if (FCachedRoomSession* Cached = RoomSessionCache.Find(RoomId))
+    {
+        // Rebuilt by the next search that returns the room.
+        ++Cached->RoomVersion;
+    }
     for (auto SessionKV : Sessions)
     {
         SaveLog(ELogVerbosity::Type::Log, FString::Printf(TEXT("OnUpdateRoomData each item begin: SessionKV.Key: %s"), *SessionKV.Key.ToString()));
@@ -1766,6 +2007,7 @@ bool FOnlineSessionPico::OnUpdateRoomData(ppfRoomHandle Room, ppfID RoomId)
                 if (RoomId == SessionRoomId)
                 {
                     UpdateSessionFromRoom(*Session, Room);
+                    SyncRoomDataStoreFromRoom(SessionKV.Key, Room);
                     return true;
                 }
             }
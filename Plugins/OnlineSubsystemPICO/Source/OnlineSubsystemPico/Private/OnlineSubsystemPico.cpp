@@ -14,6 +14,10 @@
 #include "OnlineLeaderboardInterfacePico.h"
 #include "Pico_Sport.h"
 #include "Pico_AssetFile.h"
+#include "PicoAssetDownloadScheduler.h"
+#include "PicoRequestFutures.h"
+#include "PicoUserProfileCache.h"
+#include "PicoNetTransport.h"
 #include "Pico_Achievements.h"
 #include "Pico_Leaderboards.h"
 #include "Pico_Challenges.h"
@@ -208,6 +212,21 @@ TSharedPtr<FPicoAssetFileInterface> FOnlineSubsystemPico::GetPicoAssetFileInterf
     return PicoAssetFileInterface;
 }
 
+TSharedPtr<FPicoAssetDownloadScheduler> FOnlineSubsystemPico::GetPicoAssetDownloadScheduler() const
+{
+    return PicoAssetDownloadScheduler;
+}
+
+TSharedPtr<FPicoRequestFutures> FOnlineSubsystemPico::GetPicoRequestFutures() const
+{
+    return PicoRequestFutures;
+}
+
+TSharedPtr<FPicoUserProfileCache> FOnlineSubsystemPico::GetPicoUserProfileCache() const
+{
+    return PicoUserProfileCache;
+}
+
 FOnlineSessionPicoPtr FOnlineSubsystemPico::GetGameSessionInterface() const
 {
     return GameSessionInterface;
@@ -275,6 +294,8 @@ bool FOnlineSubsystemPico::Init()
         // Create the online async task thread
         OnlineAsyncTaskThreadRunnable = new FOnlineAsyncTaskManagerPico(this);
         check(OnlineAsyncTaskThreadRunnable);
+        PicoRequestFutures = MakeShareable(new FPicoRequestFutures(this));
+        PicoUserProfileCache = MakeShareable(new FPicoUserProfileCache(GetIdInterner()));
 
         IdentityInterface = MakeShareable(new FOnlineIdentityPico(*this));
         FriendsInterface = MakeShareable(new FOnlineFriendsPico(*this));
@@ -285,6 +306,12 @@ bool FOnlineSubsystemPico::Init()
         PicoIAPInterface = MakeShareable(new FPicoIAPInterface(*this));
         PicoUserInterface = MakeShareable(new FPicoUserInterface(*this));
         PicoAssetFileInterface = MakeShareable(new FPicoAssetFileInterface(*this));
+        bool bUseScriptedAssetFileBackend = false;
+        GConfig->GetBool(TEXT("OnlineSubsystemPico"), TEXT("bUseScriptedAssetFileBackend"), bUseScriptedAssetFileBackend, GEngineIni);
+        TSharedRef<IPicoAssetFileBackend> AssetFileBackend = bUseScriptedAssetFileBackend
+            ? StaticCastSharedRef<IPicoAssetFileBackend>(MakeShared<FPicoScriptedAssetFileBackend>())
+            : FPicoAssetDownloadScheduler::CreatePlatformBackend(*this);
+        PicoAssetDownloadScheduler = MakeShareable(new FPicoAssetDownloadScheduler(AssetFileBackend, FPaths::ProjectSavedDir() / TEXT("PicoAssetDownloadQueue.json")));
         PicoSportInterface = MakeShareable(new FPicoSportInterface(*this));
 
         GameSessionInterface = MakeShareable(new FOnlineSessionPico(*this));
@@ -302,6 +329,9 @@ bool FOnlineSubsystemPico::Init()
         PicoComplianceInterface = MakeShareable(new FPicoComplianceInterface(*this));
         PicoSpeechInterface = MakeShareable(new FPicoSpeechInterface(*this));
         PicoHighlightInterface = MakeShareable(new FPicoHighlightInterface(*this));
+
+        // Decoders are registered by the interfaces above, so the worker only starts now.
+        OnlineAsyncTaskThreadRunnable->StartMessageWorker();
 #if WITH_EDITOR
         StartTicker();
 #endif
@@ -318,6 +348,12 @@ bool FOnlineSubsystemPico::Shutdown()
     UE_LOG_ONLINE(Display, TEXT("FOnlineSubsystemPico::Shutdown()"));
 
     FOnlineSubsystemImpl::Shutdown();
+    if (OnlineAsyncTaskThreadRunnable)
+    {
+        OnlineAsyncTaskThreadRunnable->StopMessageWorker();
+    }
+    PicoRequestFutures.Reset();
+    PicoUserProfileCache.Reset();
     RtcPicoUserInterface.Reset();
     PicoPresenceInterface.Reset();
     PicoApplicationInterface.Reset();
@@ -329,6 +365,7 @@ bool FOnlineSubsystemPico::Shutdown()
     GameSessionInterface.Reset();
     LeaderboardInterface.Reset();
     AchievementInterface.Reset();
+    PicoAssetDownloadScheduler.Reset();
     PicoAssetFileInterface.Reset();
     PicoSportInterface.Reset();
     PicoAchievementsInterface.Reset();
@@ -365,9 +402,173 @@ FString FOnlineSubsystemPico::GetAppId() const
 
 bool FOnlineSubsystemPico::Exec(class UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar)
 {
+    if (FParse::Command(&Cmd, TEXT("MESSAGETIMINGS")) && OnlineAsyncTaskThreadRunnable)
+    {
+        OnlineAsyncTaskThreadRunnable->DumpMessageTimings(Ar);
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("REQUESTTRACE")) && PicoRequestFutures.IsValid())
+    {
+        const FString CountToken = FParse::Token(Cmd, false);
+        PicoRequestFutures->DumpTrace(Ar, CountToken.IsEmpty() ? 20 : FCString::Atoi(*CountToken));
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("PRESENCEWRITER")) && PicoPresenceInterface.IsValid())
+    {
+        if (FParse::Command(&Cmd, TEXT("SIMULATE")))
+        {
+            Ar.Log(FPicoPresenceWriter::RunScriptedSimulation());
+            return true;
+        }
+        PicoPresenceInterface->GetPresenceWriter().Dump(Ar);
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("ACHIEVEMENTQUEUE")) && PicoAchievementsInterface.IsValid())
+    {
+        if (FParse::Command(&Cmd, TEXT("SIMULATE")))
+        {
+            Ar.Log(FPicoAchievementWriteQueue::RunScriptedSimulation());
+            return true;
+        }
+        if (FParse::Command(&Cmd, TEXT("FLUSH")))
+        {
+            PicoAchievementsInterface->Checkpoint();
+        }
+        PicoAchievementsInterface->GetWriteQueue().Dump(Ar);
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("USERCACHE")) && PicoUserProfileCache.IsValid())
+    {
+        if (FParse::Command(&Cmd, TEXT("TRIM")))
+        {
+            Ar.Logf(TEXT("Dropped %d unreferenced user profiles"), PicoUserProfileCache->Trim());
+        }
+        PicoUserProfileCache->Dump(Ar);
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("PICONETLOOPBACK")))
+    {
+        // PICONETLOOPBACK [SET <LatencyMs> <JitterMs> <LossPercent> <KBps>] [LOADTEST <MaxClients> <SecondsPerStep>]
+        TSharedRef<FPicoLoopbackNetwork> Network = FPicoLoopbackNetwork::Get();
+        if (FParse::Command(&Cmd, TEXT("SET")))
+        {
+            FPicoLoopbackLinkSettings LinkSettings = Network->GetLinkSettings();
+            LinkSettings.LatencySeconds = FCString::Atof(*FParse::Token(Cmd, false)) / 1000.0f;
+            LinkSettings.JitterSeconds = FCString::Atof(*FParse::Token(Cmd, false)) / 1000.0f;
+            LinkSettings.LossRate = FCString::Atof(*FParse::Token(Cmd, false)) / 100.0f;
+            LinkSettings.BytesPerSecond = FCString::Atoi(*FParse::Token(Cmd, false)) * 1024;
+            Network->SetLinkSettings(LinkSettings);
+        }
+        else if (FParse::Command(&Cmd, TEXT("LOADTEST")))
+        {
+            // Defaults to a full 32 player room, five seconds per client count.
+            const FString ClientsToken = FParse::Token(Cmd, false);
+            const FString SecondsToken = FParse::Token(Cmd, false);
+            const int32 MaxClients = ClientsToken.IsEmpty() ? 32 : FCString::Atoi(*ClientsToken);
+            const float SecondsPerStep = SecondsToken.IsEmpty() ? 5.0f : FCString::Atof(*SecondsToken);
+            Ar.Log(FPicoLoopbackNetwork::RunLoadTest(MaxClients, SecondsPerStep, Network->GetLinkSettings()));
+            return true;
+        }
+        Network->Dump(Ar);
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("RESULTOBJECTS")))
+    {
+        const double Now = FPlatformTime::Seconds();
+        const int64 Created = GetResultObjectsCreated();
+        const double WindowMinutes = (Now - ResultObjectsWindowStart) / 60.0;
+        if (ResultObjectsWindowStart > 0.0 && WindowMinutes > 0.0)
+        {
+            Ar.Logf(TEXT("Result objects: %lld total, %.1f per minute over the last %.1f minutes"),
+                Created, (Created - ResultObjectsWindowBase) / WindowMinutes, WindowMinutes);
+        }
+        else
+        {
+            Ar.Logf(TEXT("Result objects: %lld total, measurement window started"), Created);
+        }
+        ResultObjectsWindowStart = Now;
+        ResultObjectsWindowBase = Created;
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("SIMULATEROOMUPDATES")) && PicoRoomInterface.IsValid())
+    {
+        // Defaults to one minute of a 32 user room updating at 10 Hz.
+        const FString UpdatesToken = FParse::Token(Cmd, false);
+        const FString UsersToken = FParse::Token(Cmd, false);
+        const int32 NumUpdates = UpdatesToken.IsEmpty() ? 600 : FCString::Atoi(*UpdatesToken);
+        const int32 NumUsers = UsersToken.IsEmpty() ? 32 : FCString::Atoi(*UsersToken);
+
+        // Once with a struct listener only, once with an additional UPico_Room listener.
+        for (const bool bObjectListener : { false, true })
+        {
+            const int64 CreatedBefore = GetResultObjectsCreated();
+            const double StartTime = FPlatformTime::Seconds();
+            PicoRoomInterface->SimulateRoomUpdates(NumUpdates, NumUsers, bObjectListener);
+            const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+            const int64 Created = GetResultObjectsCreated() - CreatedBefore;
+
+            Ar.Logf(TEXT("Simulated %d room updates with %d users (%s listener): %lld result objects (%.1f per update) in %.2f ms"),
+                NumUpdates, NumUsers, bObjectListener ? TEXT("object") : TEXT("struct"), Created,
+                NumUpdates > 0 ? double(Created) / NumUpdates : 0.0, ElapsedMs);
+        }
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("ASSETDOWNLOADS")) && PicoAssetDownloadScheduler.IsValid())
+    {
+        if (FParse::Command(&Cmd, TEXT("SIMULATE")))
+        {
+            // Defaults to a DLC pack of 24 files over two slots.
+            const FString AssetsToken = FParse::Token(Cmd, false);
+            const FString ConcurrentToken = FParse::Token(Cmd, false);
+            const FString RateToken = FParse::Token(Cmd, false);
+            const int32 NumAssets = AssetsToken.IsEmpty() ? 24 : FCString::Atoi(*AssetsToken);
+            const int32 MaxConcurrent = ConcurrentToken.IsEmpty() ? 2 : FCString::Atoi(*ConcurrentToken);
+            const int64 MaxBytesPerSecond = RateToken.IsEmpty() ? 0 : FCString::Atoi64(*RateToken);
+            Ar.Log(FPicoAssetDownloadScheduler::RunScriptedSimulation(NumAssets, MaxConcurrent, MaxBytesPerSecond));
+            return true;
+        }
+
+        const FPicoAssetDownloadProgress& Progress = PicoAssetDownloadScheduler->GetProgress();
+        Ar.Logf(TEXT("Asset downloads: %lld / %lld bytes at %.0f B/s, %d active, %d queued, %d paused, %d succeeded, %d failed%s"),
+            Progress.BytesTransferred, Progress.BytesTotal, Progress.BytesPerSecond, Progress.NumActive, Progress.NumQueued,
+            Progress.NumPaused, Progress.NumSucceeded, Progress.NumFailed, Progress.bPaused ? TEXT(", paused") : TEXT(""));
+        for (const FPicoAssetDownloadEntry& Entry : PicoAssetDownloadScheduler->GetEntries())
+        {
+            Ar.Logf(TEXT("  %s priority %d state %d: %lld / %lld bytes, %d attempts"), *Entry.Key, int32(Entry.Priority), int32(Entry.State),
+                Entry.BytesTransferred, Entry.BytesTotal, Entry.Attempts);
+        }
+        return true;
+    }
+    if (FParse::Command(&Cmd, TEXT("RTCSPEAKINGBENCH")) && RtcPicoUserInterface.IsValid())
+    {
+        const FString SpeakersToken = FParse::Token(Cmd, false);
+        const FString ReportsToken = FParse::Token(Cmd, false);
+        const int32 NumSpeakers = SpeakersToken.IsEmpty() ? 32 : FCString::Atoi(*SpeakersToken);
+        const int32 NumReports = ReportsToken.IsEmpty() ? 600 : FCString::Atoi(*ReportsToken);
+
+        const double BenchmarkMicroseconds = RtcPicoUserInterface->RunSpeakingStateBenchmark(NumSpeakers, NumReports);
+        int64 LiveReports = 0;
+        double LiveMicroseconds = 0.0;
+        RtcPicoUserInterface->GetSpeakingStateStats(LiveReports, LiveMicroseconds);
+        Ar.Logf(TEXT("Speaking state: %.2f us per report with %d synthetic speakers; %lld live reports at %.2f us"),
+            BenchmarkMicroseconds, NumSpeakers, LiveReports, LiveMicroseconds);
+        return true;
+    }
     return false;
 }
 
+TAtomic<int64> FOnlineSubsystemPico::ResultObjectsCreated(0);
+
+void FOnlineSubsystemPico::RecordResultObjects(int32 NumObjects)
+{
+    ResultObjectsCreated += NumObjects;
+}
+
+int64 FOnlineSubsystemPico::GetResultObjectsCreated()
+{
+    return ResultObjectsCreated.Load();
+}
+
 FText FOnlineSubsystemPico::GetOnlineServiceName() const
 {
     return NSLOCTEXT("OnlineSubsystemPico", "OnlineServiceName", "Pico Platform");
@@ -384,12 +585,33 @@ bool FOnlineSubsystemPico::Tick(float DeltaTime)
     if (GameSessionInterface.IsValid())
     {
         GameSessionInterface->TickPendingInvites(DeltaTime);
+        GameSessionInterface->TickRoomDataStoreUpdates();
+    }
+    if (PicoPresenceInterface.IsValid())
+    {
+        PicoPresenceInterface->Tick(DeltaTime);
+    }
+    if (PicoAchievementsInterface.IsValid())
+    {
+        PicoAchievementsInterface->Tick(DeltaTime);
+    }
+    if (PicoAssetFileInterface.IsValid())
+    {
+        PicoAssetFileInterface->Tick(DeltaTime);
+    }
+    if (PicoAssetDownloadScheduler.IsValid())
+    {
+        PicoAssetDownloadScheduler->Tick(DeltaTime);
     }
 
     if (OnlineAsyncTaskThreadRunnable)
     {
         OnlineAsyncTaskThreadRunnable->TickTask();
     }
+    if (PicoRequestFutures.IsValid())
+    {
+        PicoRequestFutures->Tick(DeltaTime);
+    }
     return true;
 }
 
@@ -420,6 +642,23 @@ void FOnlineSubsystemPico::RemoveNotifyDelegate(ppfMessageType MessageType, cons
     return OnlineAsyncTaskThreadRunnable->RemoveNotifyDelegate(MessageType, Delegate);
 }
 
+void FOnlineSubsystemPico::RegisterMessageDecoder(ppfMessageType MessageType, FPicoMessageDecoder Decoder) const
+{
+    check(OnlineAsyncTaskThreadRunnable);
+    OnlineAsyncTaskThreadRunnable->RegisterDecoder(MessageType, MoveTemp(Decoder));
+}
+
+const FPicoDecodedMessage* FOnlineSubsystemPico::GetDecodedMessageInternal(ppfMessageHandle Message) const
+{
+    return OnlineAsyncTaskThreadRunnable ? OnlineAsyncTaskThreadRunnable->GetDecodedMessage(Message) : nullptr;
+}
+
+FPicoIdInterner& FOnlineSubsystemPico::GetIdInterner() const
+{
+    check(OnlineAsyncTaskThreadRunnable);
+    return OnlineAsyncTaskThreadRunnable->IdInterner;
+}
+
 bool FOnlineSubsystemPico::IsInitialized() const
 {
     return bPicoInit;
@@ -135,7 +135,7 @@ UOnlineSubsystemPicoManager::UOnlineSubsystemPicoManager()
         PicoAssetFileInterface = Subsystem->GetPicoAssetFileInterface();
         if (PicoAssetFileInterface)
         {
-            PicoAssetFileInterface->AssetFileDownloadUpdateCallback.AddUObject(this, &UOnlineSubsystemPicoManager::OnAssetFileDownloadUpdate);
+            PicoAssetFileInterface->AssetFileDownloadUpdateDataCallback.AddUObject(this, &UOnlineSubsystemPicoManager::OnAssetFileDownloadUpdate);
             PicoAssetFileInterface->AssetFileDeleteForSafetyCallback.AddUObject(this, &UOnlineSubsystemPicoManager::OnAssetFileDeleteForSafety);
         }
         PicoHighlightInterface = Subsystem->GetPicoHighlightInterface();
@@ -148,10 +148,10 @@ UOnlineSubsystemPicoManager::UOnlineSubsystemPicoManager()
         PicoRoomInterface = Subsystem->GetPicoRoomInterface();
         if (PicoRoomInterface)
         {
-            PicoRoomInterface->RoomUpdateNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomUpdateNotification);
+            PicoRoomInterface->RoomUpdateDataNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomUpdateNotification);
             PicoRoomInterface->RoomUpdateOwnerNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomUpdateOwnerNotification);
-            PicoRoomInterface->RoomJoinNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomJoinNotification);
-            PicoRoomInterface->RoomLeaveNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomLeaveNotification);
+            PicoRoomInterface->RoomJoinDataNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomJoinNotification);
+            PicoRoomInterface->RoomLeaveDataNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomLeaveNotification);
             PicoRoomInterface->RoomInviteAcceptedNotify.AddUObject(this, &UOnlineSubsystemPicoManager::OnPicoRoomInviteAcceptedNotification);
         }
         // Pico_Matchmaking Notification
@@ -178,21 +178,30 @@ UOnlineSubsystemPicoManager::UOnlineSubsystemPicoManager()
 /*
  * Pico_Room Notification begin
  */
-void UOnlineSubsystemPicoManager::OnPicoRoomUpdateNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, UPico_Room* Room)
+void UOnlineSubsystemPicoManager::OnPicoRoomUpdateNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FPicoRoomData& Room)
 {
-    OnPicoRoomUpdateNotifyDelegate.Broadcast(bIsError, ErrorCode, ErrorMessage, Room);
+    if (OnPicoRoomUpdateNotifyDelegate.IsBound())
+    {
+        OnPicoRoomUpdateNotifyDelegate.Broadcast(bIsError, ErrorCode, ErrorMessage, bIsError ? nullptr : FPicoRoomInterface::CreateRoomObject(Room));
+    }
 }
 void UOnlineSubsystemPicoManager::OnPicoRoomUpdateOwnerNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage)
 {
     OnPicoRoomUpdateOwnerNotifyDelegate.Broadcast(bIsError, ErrorCode, ErrorMessage);
 }
-void UOnlineSubsystemPicoManager::OnPicoRoomJoinNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, UPico_Room* Room)
+void UOnlineSubsystemPicoManager::OnPicoRoomJoinNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FPicoRoomData& Room)
 {
-    OnPicoRoomLeaveNotifyDelegate.Broadcast(bIsError, ErrorCode, ErrorMessage, Room);
+    if (OnPicoRoomJoinNotifyDelegate.IsBound())
+    {
+        OnPicoRoomJoinNotifyDelegate.Broadcast(bIsError, ErrorCode, ErrorMessage, bIsError ? nullptr : FPicoRoomInterface::CreateRoomObject(Room));
+    }
 }
-void UOnlineSubsystemPicoManager::OnPicoRoomLeaveNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, UPico_Room* Room)
+void UOnlineSubsystemPicoManager::OnPicoRoomLeaveNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FPicoRoomData& Room)
 {
-    OnPicoRoomJoinNotifyDelegate.Broadcast(bIsError, ErrorCode, ErrorMessage, Room);
+    if (OnPicoRoomLeaveNotifyDelegate.IsBound())
+    {
+        OnPicoRoomLeaveNotifyDelegate.Broadcast(bIsError, ErrorCode, ErrorMessage, bIsError ? nullptr : FPicoRoomInterface::CreateRoomObject(Room));
+    }
 }
 void UOnlineSubsystemPicoManager::OnPicoRoomInviteAcceptedNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FString& RoomID)
 {
@@ -311,13 +320,11 @@ void UOnlineSubsystemPicoManager::PicoGetFriendList(UObject* WorldContextObject,
     {
         TArray< TSharedRef<FOnlineFriend> > OutFriends;
         Subsystem->GetFriendsInterface()->GetFriendsList(InLocalUserNum, ListName, OutFriends);
-        OutFriendList.Empty();
-        for (auto Friend : OutFriends)
+        // Blueprints need their own copy, but the array's allocation is reused across refreshes.
+        OutFriendList.Reset(OutFriends.Num());
+        for (const TSharedRef<FOnlineFriend>& Friend : OutFriends)
         {
-            // StaticCastSharedPtr
-            TSharedRef<FOnlinePicoFriend> OnlineFriend = StaticCastSharedRef<FOnlinePicoFriend>(Friend);
-            FPicoUserInfo NewFriend = GetBPPicoFriend(OnlineFriend);
-            OutFriendList.Add(NewFriend);
+            OutFriendList.Add(GetBPPicoFriend(StaticCastSharedRef<FOnlinePicoFriend>(Friend)));
         }
     }
 }
@@ -1915,9 +1922,12 @@ bool UOnlineSubsystemPicoManager::GetSystemInfo(UObject* WorldContextObject, FPi
     return false;
 }
 
-void UOnlineSubsystemPicoManager::OnAssetFileDownloadUpdate(UPico_AssetFileDownloadUpdate* AssetFileDownloadUpdateObj)
+void UOnlineSubsystemPicoManager::OnAssetFileDownloadUpdate(const FPicoAssetFileDownloadUpdateData& DownloadUpdate)
 {
-    OnAssetFileDownloadUpdateDelegate.Broadcast(AssetFileDownloadUpdateObj);
+    if (OnAssetFileDownloadUpdateDelegate.IsBound())
+    {
+        OnAssetFileDownloadUpdateDelegate.Broadcast(FPicoAssetFileInterface::CreateDownloadUpdateObject(DownloadUpdate));
+    }
 }
 
 void UOnlineSubsystemPicoManager::OnAssetFileDeleteForSafety(UPico_AssetFileDeleteForSafety* AssetFileDeleteForSafetyObj)
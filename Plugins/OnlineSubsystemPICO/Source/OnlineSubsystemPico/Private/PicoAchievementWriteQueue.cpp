@@ -0,0 +1,1019 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoAchievementWriteQueue.h"
+#include "OnlineSubsystemPico.h"
+#include "OnlineSubsystemPicoPrivate.h"
+#include "Pico_Achievements.h"
+#include "Async/Async.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include <vector>
+#include <string>
+
+namespace
+{
+    bool HasSetBit(const FString& Fields)
+    {
+        int32 Index;
+        return Fields.FindChar(TEXT('1'), Index);
+    }
+
+    void OrFields(FString& Into, const FString& Fields)
+    {
+        if (Into.Len() < Fields.Len())
+        {
+            Into += FString::ChrN(Fields.Len() - Into.Len(), TEXT('0'));
+        }
+        for (int32 Index = 0; Index < Fields.Len(); ++Index)
+        {
+            if (Fields[Index] == TEXT('1'))
+            {
+                Into[Index] = TEXT('1');
+            }
+        }
+    }
+
+    /** Writes the serialized queue, or deletes the file if the queue is empty. */
+    bool WriteQueueFile(const FString& QueueFilePath, const FString& Json)
+    {
+        if (Json.IsEmpty())
+        {
+            return IFileManager::Get().Delete(*QueueFilePath, false, false, true);
+        }
+        if (!FFileHelper::SaveStringToFile(Json, *QueueFilePath))
+        {
+            UE_LOG(PicoAchievements, Warning, TEXT("Saving the achievement queue to %s failed"), *QueueFilePath);
+            return false;
+        }
+        return true;
+    }
+
+    class FPlatformAchievementBackend : public IPicoAchievementBackend
+    {
+    public:
+        FPlatformAchievementBackend(FOnlineSubsystemPico& InSubsystem) :
+            PicoSubsystem(InSubsystem)
+        {
+        }
+
+        virtual int32 Write(const FPicoAchievementWrite& Write, FOnComplete OnComplete) override
+        {
+            FTCHARToUTF8 ExtraData(*Write.ExtraData);
+            if (Write.bUnlock)
+            {
+                Send(ppf_Achievements_Unlock(TCHAR_TO_UTF8(*Write.Name), ExtraData.Get(), ExtraData.Length()), MakeShared<FBatch>(1, MoveTemp(OnComplete)));
+                return 1;
+            }
+
+            const bool bAddCount = Write.Count > 0;
+            const bool bAddFields = HasSetBit(Write.Fields);
+            TSharedRef<FBatch> Batch = MakeShared<FBatch>(int32(bAddCount) + int32(bAddFields), MoveTemp(OnComplete));
+            if (bAddCount)
+            {
+                Send(ppf_Achievements_AddCount(TCHAR_TO_UTF8(*Write.Name), Write.Count, ExtraData.Get(), ExtraData.Length()), Batch);
+            }
+            if (bAddFields)
+            {
+                Send(ppf_Achievements_AddFields(TCHAR_TO_UTF8(*Write.Name), TCHAR_TO_UTF8(*Write.Fields), ExtraData.Get(), ExtraData.Length()), Batch);
+            }
+            return Batch->NumPending;
+        }
+
+        virtual void GetDefinitions(const TArray<FString>& Names, FOnDefinitions OnDefinitions) override
+        {
+            std::vector<std::string> StringArray;
+            for (const FString& Name : Names)
+            {
+                StringArray.push_back(std::string(TCHAR_TO_UTF8(*Name)));
+            }
+            std::vector<const char*> NamePointers;
+            for (const std::string& Name : StringArray)
+            {
+                NamePointers.push_back(Name.c_str());
+            }
+
+            PicoSubsystem.AddAsyncTask
+            (
+                ppf_Achievements_GetDefinitionsByName(NamePointers.data(), Names.Num()),
+                FPicoMessageOnCompleteDelegate::CreateLambda
+                (
+                    [OnDefinitions](ppfMessageHandle Message, bool bIsError)
+                    {
+                        TArray<FPicoAchievementDefinitionInfo> Definitions;
+                        if (bIsError)
+                        {
+                            OnDefinitions(false, Definitions, false);
+                            return;
+                        }
+                        ppfAchievementDefinitionArrayHandle Array = ppf_Message_GetAchievementDefinitionArray(Message);
+                        const size_t Size = ppf_AchievementDefinitionArray_GetSize(Array);
+                        for (size_t Index = 0; Index < Size; ++Index)
+                        {
+                            ppfAchievementDefinitionHandle Handle = ppf_AchievementDefinitionArray_GetElement(Array, Index);
+                            FPicoAchievementDefinitionInfo& Definition = Definitions.AddDefaulted_GetRef();
+                            Definition.Name = UTF8_TO_TCHAR(ppf_AchievementDefinition_GetName(Handle));
+                            Definition.Type = ppf_AchievementDefinition_GetType(Handle);
+                            Definition.Target = ppf_AchievementDefinition_GetTarget(Handle);
+                            Definition.BitfieldLength = ppf_AchievementDefinition_GetBitfieldLength(Handle);
+                            Definition.bArchived = ppf_AchievementDefinition_IsArchived(Handle);
+                        }
+                        OnDefinitions(true, Definitions, !ppf_AchievementDefinitionArray_HasNextPage(Array));
+                    }
+                )
+            );
+        }
+
+    private:
+        struct FBatch
+        {
+            FBatch(int32 InNumPending, FOnComplete&& InOnComplete) :
+                NumPending(InNumPending),
+                OnComplete(MoveTemp(InOnComplete))
+            {
+            }
+
+            int32 NumPending;
+            bool bSuccess = true;
+            bool bJustUnlocked = false;
+            FString ErrorMessage;
+            FOnComplete OnComplete;
+        };
+
+        void Send(ppfRequest Request, TSharedRef<FBatch> Batch)
+        {
+            PicoSubsystem.AddAsyncTask
+            (
+                Request,
+                FPicoMessageOnCompleteDelegate::CreateLambda
+                (
+                    [Batch](ppfMessageHandle Message, bool bIsError)
+                    {
+                        if (bIsError && Batch->bSuccess)
+                        {
+                            auto Error = ppf_Message_GetError(Message);
+                            Batch->bSuccess = false;
+                            Batch->ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error)) + FString(". Error Code: ") + FString::FromInt(ppf_Error_GetCode(Error));
+                        }
+                        else if (!bIsError)
+                        {
+                            Batch->bJustUnlocked |= ppf_AchievementUpdate_GetJustUnlocked(ppf_Message_GetAchievementUpdate(Message));
+                        }
+                        if (--Batch->NumPending == 0 && Batch->OnComplete)
+                        {
+                            Batch->OnComplete(Batch->bSuccess, Batch->ErrorMessage, Batch->bJustUnlocked);
+                        }
+                    }
+                )
+            );
+        }
+
+        FOnlineSubsystemPico& PicoSubsystem;
+    };
+}
+
+bool FPicoAchievementWrite::IsEmpty() const
+{
+    return !bUnlock && Count <= 0 && !HasSetBit(Fields);
+}
+
+void FPicoAchievementWrite::Merge(const FPicoAchievementWrite& Other)
+{
+    bUnlock |= Other.bUnlock;
+    if (bUnlock)
+    {
+        // Unlocking makes any progress moot.
+        Count = 0;
+        Fields.Reset();
+    }
+    else
+    {
+        Count = Count > MAX_int64 - Other.Count ? MAX_int64 : Count + Other.Count;
+        OrFields(Fields, Other.Fields);
+    }
+    if (!Other.ExtraData.IsEmpty())
+    {
+        ExtraData = Other.ExtraData;
+    }
+}
+
+void FPicoScriptedAchievementBackend::AddDefinition(const FString& Name, ppfAchievementType Type, int64 Target, int32 BitfieldLength)
+{
+    FPicoAchievementDefinitionInfo& Definition = Definitions.Add(Name);
+    Definition.Name = Name;
+    Definition.Type = Type;
+    Definition.Target = Target;
+    Definition.BitfieldLength = BitfieldLength;
+}
+
+int32 FPicoScriptedAchievementBackend::Write(const FPicoAchievementWrite& Write, FOnComplete OnComplete)
+{
+    const int32 NumWriteRequests = Write.bUnlock ? 1 : int32(Write.Count > 0) + int32(HasSetBit(Write.Fields));
+    NumWrites++;
+    NumRequests += NumWriteRequests;
+
+    Pending.Add({ LatencySeconds, [this, Write, OnComplete]()
+        {
+            FString ErrorMessage = TEXT("Network unavailable");
+            bool bJustUnlocked = false;
+            const bool bSuccess = bOnline && Apply(Write, ErrorMessage, bJustUnlocked);
+            OnComplete(bSuccess, bSuccess ? FString() : ErrorMessage, bJustUnlocked);
+        } });
+    return NumWriteRequests;
+}
+
+void FPicoScriptedAchievementBackend::GetDefinitions(const TArray<FString>& Names, FOnDefinitions OnDefinitions)
+{
+    Pending.Add({ LatencySeconds, [this, Names, OnDefinitions]()
+        {
+            TArray<FPicoAchievementDefinitionInfo> Found;
+            if (bOnline)
+            {
+                for (const FString& Name : Names)
+                {
+                    if (const FPicoAchievementDefinitionInfo* Definition = Definitions.Find(Name))
+                    {
+                        Found.Add(*Definition);
+                    }
+                }
+            }
+            OnDefinitions(bOnline, Found, bOnline);
+        } });
+}
+
+bool FPicoScriptedAchievementBackend::Apply(const FPicoAchievementWrite& Write, FString& OutError, bool& bOutJustUnlocked)
+{
+    const FPicoAchievementDefinitionInfo* Definition = Definitions.Find(Write.Name);
+    if (Definition == nullptr || Definition->bArchived)
+    {
+        OutError = FString::Printf(TEXT("Unknown achievement %s"), *Write.Name);
+        return false;
+    }
+
+    FProgress& Entry = Progress.FindOrAdd(Write.Name);
+    const bool bWasUnlocked = Entry.bUnlocked;
+    if (Write.bUnlock)
+    {
+        Entry.bUnlocked = true;
+    }
+    else if (Definition->Type == ppfAchievement_TypeCount)
+    {
+        Entry.Count += Write.Count;
+        Entry.bUnlocked |= Entry.Count >= Definition->Target;
+    }
+    else if (Definition->Type == ppfAchievement_TypeBitfield)
+    {
+        OrFields(Entry.Fields, Write.Fields.Left(Definition->BitfieldLength));
+        int32 NumSet = 0;
+        for (TCHAR Bit : Entry.Fields)
+        {
+            NumSet += Bit == TEXT('1') ? 1 : 0;
+        }
+        Entry.bUnlocked |= NumSet >= Definition->Target;
+    }
+    else
+    {
+        OutError = FString::Printf(TEXT("%s can only be unlocked"), *Write.Name);
+        return false;
+    }
+    bOutJustUnlocked = !bWasUnlocked && Entry.bUnlocked;
+    return true;
+}
+
+void FPicoScriptedAchievementBackend::Tick(float DeltaTime)
+{
+    TArray<TFunction<void()>> Due;
+    for (int32 Index = 0; Index < Pending.Num(); ++Index)
+    {
+        Pending[Index].RemainingSeconds -= DeltaTime;
+        if (Pending[Index].RemainingSeconds <= 0.0f)
+        {
+            Due.Add(MoveTemp(Pending[Index].Answer));
+            Pending.RemoveAt(Index--);
+        }
+    }
+    for (TFunction<void()>& Answer : Due)
+    {
+        Answer();
+    }
+}
+
+FPicoAchievementWriteQueue::FPicoAchievementWriteQueue(TSharedRef<IPicoAchievementBackend> InBackend, const FString& InQueueFilePrefix, bool bInSaveInBackground) :
+    Backend(InBackend),
+    QueueFilePrefix(InQueueFilePrefix),
+    bSaveInBackground(bInSaveInBackground)
+{
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("AchievementFlushSeconds"), FlushSeconds, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("AchievementQueueSaveSeconds"), SaveSeconds, GEngineIni);
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("AchievementMaxConcurrentWrites"), MaxConcurrentWrites, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("AchievementWriteRetrySeconds"), RetrySeconds, GEngineIni);
+    FlushSeconds = FMath::Max(FlushSeconds, 0.0f);
+    SaveSeconds = FMath::Max(SaveSeconds, 0.0f);
+    MaxConcurrentWrites = FMath::Max(MaxConcurrentWrites, 1);
+}
+
+FPicoAchievementWriteQueue::~FPicoAchievementWriteQueue()
+{
+    // Writes in flight stay in the file until they are confirmed, and go out again on the next launch.
+    if (bQueueDirty)
+    {
+        SaveQueue(false);
+    }
+    WaitForSave();
+}
+
+TSharedRef<IPicoAchievementBackend> FPicoAchievementWriteQueue::CreatePlatformBackend(FOnlineSubsystemPico& InSubsystem)
+{
+    return MakeShared<FPlatformAchievementBackend>(InSubsystem);
+}
+
+void FPicoAchievementWriteQueue::AddCount(const FString& Name, int64 Count, const FString& ExtraData, IPicoAchievementBackend::FOnComplete OnComplete)
+{
+    if (Count <= 0)
+    {
+        if (OnComplete)
+        {
+            OnComplete(false, FString::Printf(TEXT("Invalid count %lld for %s"), Count, *Name), false);
+        }
+        return;
+    }
+    FPicoAchievementWrite Write;
+    Write.Name = Name;
+    Write.Count = Count;
+    Write.ExtraData = ExtraData;
+    Enqueue(Write, MoveTemp(OnComplete));
+}
+
+void FPicoAchievementWriteQueue::AddFields(const FString& Name, const FString& Fields, const FString& ExtraData, IPicoAchievementBackend::FOnComplete OnComplete)
+{
+    FPicoAchievementWrite Write;
+    Write.Name = Name;
+    Write.Fields = Fields;
+    Write.ExtraData = ExtraData;
+    Enqueue(Write, MoveTemp(OnComplete));
+}
+
+void FPicoAchievementWriteQueue::Unlock(const FString& Name, const FString& ExtraData, IPicoAchievementBackend::FOnComplete OnComplete)
+{
+    FPicoAchievementWrite Write;
+    Write.Name = Name;
+    Write.bUnlock = true;
+    Write.ExtraData = ExtraData;
+    Enqueue(Write, MoveTemp(OnComplete));
+    FlushTime = Time;
+}
+
+void FPicoAchievementWriteQueue::Checkpoint()
+{
+    if (bQueueDirty && !UserId.IsEmpty())
+    {
+        SaveQueue(bSaveInBackground);
+    }
+    FlushTime = Time;
+}
+
+void FPicoAchievementWriteQueue::SetUserId(const FString& InUserId)
+{
+    if (InUserId == UserId)
+    {
+        return;
+    }
+
+    TArray<TPair<FWaiters, FString>> Failed;
+    if (!UserId.IsEmpty())
+    {
+        // The progress of the previous user stays in their file until they sign in again.
+        if (bQueueDirty)
+        {
+            SaveQueue(false);
+        }
+        WaitForSave();
+        UE_LOG(PicoAchievements, Log, TEXT("Keeping %d queued achievements of %s until they sign in again"), Entries.Num(), *UserId);
+        for (TPair<FString, FEntry>& Pair : Entries)
+        {
+            FWaiters Waiters = MoveTemp(Pair.Value.InFlightWaiters);
+            Waiters.Append(MoveTemp(Pair.Value.PendingWaiters));
+            Failed.Emplace(MoveTemp(Waiters), FString::Printf(TEXT("%s: %s signed out, the write is sent once they sign in again"), *Pair.Key, *UserId));
+        }
+        // Answers to the writes and the reconcile of the previous user are ignored from now on.
+        Entries.Reset();
+        NumInFlight = 0;
+        bQueueDirty = false;
+        bOnline = true;
+        bNeedsReconcile = false;
+        bReconciling = false;
+        OfflineAttempts = 0;
+        RetryTime = 0.0;
+        FlushTime = TNumericLimits<double>::Max();
+    }
+    else if (Entries.Num() > 0)
+    {
+        // Queued before the sign in completed, so by this user.
+        bQueueDirty = true;
+    }
+
+    UserId = InUserId;
+    LoadQueue();
+
+    for (TPair<FWaiters, FString>& Failure : Failed)
+    {
+        CompleteWaiters(Failure.Key, false, Failure.Value, false);
+    }
+}
+
+void FPicoAchievementWriteQueue::Enqueue(const FPicoAchievementWrite& Write, IPicoAchievementBackend::FOnComplete&& OnComplete)
+{
+    Stats.NumChanges++;
+    if (Write.IsEmpty())
+    {
+        // Nothing to unlock, e.g. all zero fields.
+        if (OnComplete)
+        {
+            OnComplete(true, FString(), false);
+        }
+        return;
+    }
+
+    FEntry& Entry = Entries.FindOrAdd(Write.Name);
+    Entry.Pending.Name = Write.Name;
+    Entry.Pending.Merge(Write);
+    if (OnComplete)
+    {
+        Entry.PendingWaiters.Add(MoveTemp(OnComplete));
+    }
+    bQueueDirty = true;
+    FlushTime = FMath::Min(FlushTime, Time + FlushSeconds);
+}
+
+void FPicoAchievementWriteQueue::Tick(float DeltaTime)
+{
+    Time += DeltaTime;
+    Backend->Tick(DeltaTime);
+
+    if (UserId.IsEmpty())
+    {
+        // The platform only accepts writes of the signed in user.
+        return;
+    }
+
+    // Write-ahead: nothing goes out before it is on disk. Changes are saved together, unless a write is due.
+    const bool bFlushDue = !bReconciling && !bNeedsReconcile && Time >= RetryTime && Time >= FlushTime;
+    if (bQueueDirty && !IsSaving() && (bFlushDue || Time >= SaveTime))
+    {
+        SaveQueue(bSaveInBackground);
+    }
+    if (bReconciling || Time < RetryTime)
+    {
+        return;
+    }
+    if (bNeedsReconcile)
+    {
+        Reconcile();
+        return;
+    }
+    if (bFlushDue && !bQueueDirty && !IsSaving())
+    {
+        Flush();
+    }
+}
+
+void FPicoAchievementWriteQueue::Flush()
+{
+    FlushTime = TNumericLimits<double>::Max();
+    TWeakPtr<FPicoAchievementWriteQueue> WeakQueue = AsShared();
+    for (TPair<FString, FEntry>& Pair : Entries)
+    {
+        FEntry& Entry = Pair.Value;
+        if (Entry.bInFlight || Entry.Pending.IsEmpty())
+        {
+            continue;
+        }
+        if (Time < Entry.RetryTime)
+        {
+            FlushTime = FMath::Min(FlushTime, Entry.RetryTime);
+            continue;
+        }
+        if (NumInFlight >= MaxConcurrentWrites)
+        {
+            // The rest goes out as writes complete.
+            FlushTime = Time;
+            break;
+        }
+
+        Entry.InFlight = MoveTemp(Entry.Pending);
+        Entry.Pending = FPicoAchievementWrite();
+        Entry.Pending.Name = Pair.Key;
+        Entry.InFlightWaiters = MoveTemp(Entry.PendingWaiters);
+        Entry.bInFlight = true;
+        Entry.InFlightId = ++LastWriteId;
+        NumInFlight++;
+        Stats.NumRetries += Entry.Attempts > 0 ? 1 : 0;
+
+        const FString Name = Pair.Key;
+        const uint32 WriteId = Entry.InFlightId;
+        Stats.NumRequests += Backend->Write(Entry.InFlight, [WeakQueue, Name, WriteId](bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked)
+            {
+                if (TSharedPtr<FPicoAchievementWriteQueue> Queue = WeakQueue.Pin())
+                {
+                    Queue->OnWriteComplete(Name, WriteId, bSuccess, ErrorMessage, bJustUnlocked);
+                }
+            });
+    }
+}
+
+void FPicoAchievementWriteQueue::OnWriteComplete(const FString& Name, uint32 WriteId, bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked)
+{
+    FEntry* Entry = Entries.Find(Name);
+    if (Entry == nullptr || !Entry->bInFlight || Entry->InFlightId != WriteId)
+    {
+        // Dropped meanwhile.
+        return;
+    }
+    Entry->bInFlight = false;
+    NumInFlight--;
+    bQueueDirty = true;
+
+    if (bSuccess)
+    {
+        FWaiters Completed = MoveTemp(Entry->InFlightWaiters);
+        if (Entry->InFlight.bUnlock)
+        {
+            // Progress added after the unlock is moot.
+            Completed.Append(MoveTemp(Entry->PendingWaiters));
+            Entry->Pending = FPicoAchievementWrite();
+        }
+        Entry->InFlight = FPicoAchievementWrite();
+        Entry->Attempts = 0;
+        if (Entry->Pending.IsEmpty())
+        {
+            Entries.Remove(Name);
+        }
+        CompleteWaiters(Completed, true, FString(), bJustUnlocked);
+        return;
+    }
+
+    Stats.NumFailures++;
+    Entry->Attempts++;
+    // Backs off on its own, on top of the queue going offline, so an achievement the server keeps refusing doesn't hold up the others.
+    Entry->RetryTime = Time + FMath::Min(RetrySeconds * FMath::Pow(2.0f, float(Entry->Attempts - 1)), MaxRetrySeconds);
+    UE_LOG(PicoAchievements, Warning, TEXT("Achievement write for %s failed (attempt %d), retrying in %.0f s: %s"), *Name, Entry->Attempts, Entry->RetryTime - Time, *ErrorMessage);
+
+    // Merge it back in front of whatever was added meanwhile.
+    FPicoAchievementWrite Retry = MoveTemp(Entry->InFlight);
+    Retry.Merge(Entry->Pending);
+    Entry->Pending = MoveTemp(Retry);
+    Entry->InFlight = FPicoAchievementWrite();
+    Entry->InFlightWaiters.Append(MoveTemp(Entry->PendingWaiters));
+    Entry->PendingWaiters = MoveTemp(Entry->InFlightWaiters);
+    GoOffline();
+}
+
+void FPicoAchievementWriteQueue::GoOffline()
+{
+    if (!bOnline)
+    {
+        return;
+    }
+    UE_LOG(PicoAchievements, Log, TEXT("Achievement writes are queued until the server can be reached again"));
+    bOnline = false;
+    bNeedsReconcile = true;
+    OfflineAttempts = 1;
+    RetryTime = Time + RetrySeconds;
+}
+
+void FPicoAchievementWriteQueue::Reconcile()
+{
+    bNeedsReconcile = false;
+    TArray<FString> Names;
+    Entries.GetKeys(Names);
+    if (Names.Num() == 0)
+    {
+        bOnline = true;
+        OfflineAttempts = 0;
+        return;
+    }
+
+    bReconciling = true;
+    TWeakPtr<FPicoAchievementWriteQueue> WeakQueue = AsShared();
+    Backend->GetDefinitions(Names, [WeakQueue, ForUserId = UserId](bool bSuccess, const TArray<FPicoAchievementDefinitionInfo>& Definitions, bool bComplete)
+        {
+            TSharedPtr<FPicoAchievementWriteQueue> Queue = WeakQueue.Pin();
+            // The definitions of another user's queue would drop ours as unknown.
+            if (Queue.IsValid() && Queue->UserId == ForUserId)
+            {
+                Queue->OnDefinitions(bSuccess, Definitions, bComplete);
+            }
+        });
+}
+
+void FPicoAchievementWriteQueue::OnDefinitions(bool bSuccess, const TArray<FPicoAchievementDefinitionInfo>& Definitions, bool bComplete)
+{
+    bReconciling = false;
+    if (!bSuccess)
+    {
+        bOnline = false;
+        bNeedsReconcile = true;
+        RetryTime = Time + FMath::Min(RetrySeconds * FMath::Pow(2.0f, float(OfflineAttempts)), MaxRetrySeconds);
+        OfflineAttempts++;
+        return;
+    }
+
+    if (!bOnline)
+    {
+        UE_LOG(PicoAchievements, Log, TEXT("Achievement server reachable again, sending %d queued achievements"), Entries.Num());
+    }
+    Stats.NumReconciles++;
+    bOnline = true;
+    OfflineAttempts = 0;
+    RetryTime = 0.0;
+    FlushTime = Time;
+
+    TMap<FString, const FPicoAchievementDefinitionInfo*> DefinitionsByName;
+    for (const FPicoAchievementDefinitionInfo& Definition : Definitions)
+    {
+        DefinitionsByName.Add(Definition.Name, &Definition);
+    }
+
+    TArray<FString> Names;
+    Entries.GetKeys(Names);
+    TArray<TPair<FWaiters, FString>> Failed;
+    for (const FString& Name : Names)
+    {
+        FEntry& Entry = Entries[Name];
+        const FPicoAchievementDefinitionInfo* Definition = DefinitionsByName.FindRef(Name);
+        if (Definition == nullptr)
+        {
+            // Only a complete answer tells the achievement does not exist.
+            if (bComplete)
+            {
+                Drop(Name, TEXT("unknown achievement"), Failed);
+            }
+            continue;
+        }
+        if (Definition->bArchived)
+        {
+            Drop(Name, TEXT("achievement is archived"), Failed);
+            continue;
+        }
+
+        // Keep only the progress the achievement type accepts.
+        FPicoAchievementWrite& Pending = Entry.Pending;
+        const bool bWasEmpty = Pending.IsEmpty();
+        if (!Pending.bUnlock)
+        {
+            if (Definition->Type != ppfAchievement_TypeCount)
+            {
+                Pending.Count = 0;
+            }
+            else if (Definition->Target > 0)
+            {
+                Pending.Count = FMath::Min(Pending.Count, Definition->Target);
+            }
+            if (Definition->Type != ppfAchievement_TypeBitfield)
+            {
+                Pending.Fields.Reset();
+            }
+            else
+            {
+                Pending.Fields.LeftInline(Definition->BitfieldLength);
+            }
+        }
+        if (!bWasEmpty && Pending.IsEmpty())
+        {
+            const FString Reason = FString::Printf(TEXT("progress does not fit a %s achievement"), UTF8_TO_TCHAR(ppfAchievementType_ToString(Definition->Type)));
+            if (Entry.bInFlight)
+            {
+                Failed.Emplace(MoveTemp(Entry.PendingWaiters), Reason);
+                Entry.PendingWaiters.Reset();
+            }
+            else
+            {
+                Drop(Name, Reason, Failed);
+            }
+        }
+    }
+
+    for (TPair<FWaiters, FString>& Failure : Failed)
+    {
+        CompleteWaiters(Failure.Key, false, Failure.Value, false);
+    }
+}
+
+void FPicoAchievementWriteQueue::Drop(const FString& Name, const FString& Reason, TArray<TPair<FWaiters, FString>>& OutFailed)
+{
+    FEntry Entry;
+    if (!Entries.RemoveAndCopyValue(Name, Entry))
+    {
+        return;
+    }
+    // An answer to a write in flight is ignored from now on.
+    NumInFlight -= Entry.bInFlight ? 1 : 0;
+    Stats.NumDropped++;
+    bQueueDirty = true;
+    UE_LOG(PicoAchievements, Warning, TEXT("Dropping the queued writes for %s: %s"), *Name, *Reason);
+
+    FWaiters Waiters = MoveTemp(Entry.InFlightWaiters);
+    Waiters.Append(MoveTemp(Entry.PendingWaiters));
+    OutFailed.Emplace(MoveTemp(Waiters), FString::Printf(TEXT("%s: %s"), *Name, *Reason));
+}
+
+void FPicoAchievementWriteQueue::CompleteWaiters(FWaiters& Waiters, bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked)
+{
+    // Callbacks may queue more writes.
+    FWaiters Completed = MoveTemp(Waiters);
+    for (IPicoAchievementBackend::FOnComplete& OnComplete : Completed)
+    {
+        OnComplete(bSuccess, ErrorMessage, bJustUnlocked);
+    }
+}
+
+FString FPicoAchievementWriteQueue::GetQueueFilePath() const
+{
+    if (QueueFilePrefix.IsEmpty() || UserId.IsEmpty())
+    {
+        return FString();
+    }
+    return FString::Printf(TEXT("%s_%s.json"), *QueueFilePrefix, *FPaths::MakeValidFileName(UserId, TEXT('_')));
+}
+
+void FPicoAchievementWriteQueue::WaitForSave()
+{
+    if (PendingSave.IsValid())
+    {
+        PendingSave.Wait();
+        PendingSave = TFuture<bool>();
+    }
+}
+
+bool FPicoAchievementWriteQueue::SaveQueue(bool bInBackground)
+{
+    bQueueDirty = false;
+    SaveTime = Time + SaveSeconds;
+    const FString QueueFilePath = GetQueueFilePath();
+    if (QueueFilePath.IsEmpty())
+    {
+        return false;
+    }
+
+    TArray<TSharedPtr<FJsonValue>> Achievements;
+    for (const TPair<FString, FEntry>& Pair : Entries)
+    {
+        // Unconfirmed writes are saved too, the server may never have seen them.
+        FPicoAchievementWrite Write = Pair.Value.InFlight;
+        Write.Name = Pair.Key;
+        Write.Merge(Pair.Value.Pending);
+        if (Write.IsEmpty())
+        {
+            continue;
+        }
+        TSharedRef<FJsonObject> Achievement = MakeShared<FJsonObject>();
+        Achievement->SetStringField(TEXT("Name"), Write.Name);
+        // As a string, JSON numbers lose precision above 2^53.
+        Achievement->SetStringField(TEXT("Count"), LexToString(Write.Count));
+        Achievement->SetStringField(TEXT("Fields"), Write.Fields);
+        Achievement->SetBoolField(TEXT("Unlock"), Write.bUnlock);
+        Achievement->SetStringField(TEXT("ExtraData"), Write.ExtraData);
+        Achievements.Add(MakeShared<FJsonValueObject>(Achievement));
+    }
+
+    // An empty string deletes the file.
+    FString Json;
+    if (Achievements.Num() > 0)
+    {
+        TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+        Root->SetStringField(TEXT("UserId"), UserId);
+        Root->SetArrayField(TEXT("Achievements"), Achievements);
+        TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+        if (!FJsonSerializer::Serialize(Root, Writer))
+        {
+            UE_LOG(PicoAchievements, Warning, TEXT("Serializing the achievement queue of %s failed"), *UserId);
+            return false;
+        }
+    }
+
+    // One save at a time, so an older one never lands over a newer one.
+    WaitForSave();
+    if (bInBackground)
+    {
+        PendingSave = Async(EAsyncExecution::ThreadPool, [QueueFilePath, Json = MoveTemp(Json)]()
+            {
+                return WriteQueueFile(QueueFilePath, Json);
+            });
+        return true;
+    }
+    return WriteQueueFile(QueueFilePath, Json);
+}
+
+bool FPicoAchievementWriteQueue::LoadQueue()
+{
+    const FString QueueFilePath = GetQueueFilePath();
+    FString Json;
+    if (QueueFilePath.IsEmpty() || !FFileHelper::LoadFileToString(Json, *QueueFilePath))
+    {
+        return false;
+    }
+
+    TSharedPtr<FJsonObject> Root;
+    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+    const TArray<TSharedPtr<FJsonValue>>* Achievements = nullptr;
+    if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("Achievements"), Achievements))
+    {
+        UE_LOG(PicoAchievements, Warning, TEXT("Ignoring unreadable achievement queue %s"), *QueueFilePath);
+        return false;
+    }
+    FString FileUserId;
+    if (!Root->TryGetStringField(TEXT("UserId"), FileUserId) || FileUserId != UserId)
+    {
+        UE_LOG(PicoAchievements, Warning, TEXT("Ignoring achievement queue %s, it is not of %s"), *QueueFilePath, *UserId);
+        return false;
+    }
+
+    int32 NumRestored = 0;
+    for (const TSharedPtr<FJsonValue>& Value : *Achievements)
+    {
+        const TSharedPtr<FJsonObject>* Achievement = nullptr;
+        if (!Value->TryGetObject(Achievement))
+        {
+            continue;
+        }
+        FPicoAchievementWrite Write;
+        Write.Name = (*Achievement)->GetStringField(TEXT("Name"));
+        LexFromString(Write.Count, *(*Achievement)->GetStringField(TEXT("Count")));
+        Write.Fields = (*Achievement)->GetStringField(TEXT("Fields"));
+        Write.bUnlock = (*Achievement)->GetBoolField(TEXT("Unlock"));
+        Write.ExtraData = (*Achievement)->GetStringField(TEXT("ExtraData"));
+        if (Write.Name.IsEmpty() || Write.IsEmpty())
+        {
+            continue;
+        }
+        FEntry& Entry = Entries.FindOrAdd(Write.Name);
+        Entry.Pending.Name = Write.Name;
+        Entry.Pending.Merge(Write);
+        NumRestored++;
+    }
+    Stats.NumRestored += NumRestored;
+
+    // The definitions may have changed since the queue was written.
+    bNeedsReconcile |= NumRestored > 0;
+    FlushTime = Time;
+
+    UE_LOG(PicoAchievements, Log, TEXT("Restored %d queued achievements of %s from %s"), NumRestored, *UserId, *QueueFilePath);
+    return true;
+}
+
+void FPicoAchievementWriteQueue::Dump(FOutputDevice& Ar) const
+{
+    Ar.Logf(TEXT("Pico achievement write queue of %s: %s, %d achievements queued, %d writes in flight, flush every %.1f s"),
+        UserId.IsEmpty() ? TEXT("nobody, waiting for a sign in") : *UserId, bOnline ? TEXT("online") : bReconciling ? TEXT("reconciling") : TEXT("offline"),
+        Entries.Num(), NumInFlight, FlushSeconds);
+    Ar.Logf(TEXT("  Calls: %lld, Requests: %lld, Saved by merging: %lld, Failures: %lld, Retries: %lld, Reconciles: %lld, Dropped: %lld, Restored: %lld"),
+        Stats.NumChanges, Stats.NumRequests, Stats.GetRequestsSaved(), Stats.NumFailures, Stats.NumRetries, Stats.NumReconciles, Stats.NumDropped, Stats.NumRestored);
+    for (const TPair<FString, FEntry>& Pair : Entries)
+    {
+        const FPicoAchievementWrite& Pending = Pair.Value.Pending;
+        Ar.Logf(TEXT("  %s: count %lld, fields %s, unlock %d, %s, %d failed attempts"), *Pair.Key, Pending.Count, *Pending.Fields, Pending.bUnlock,
+            Pair.Value.bInFlight ? TEXT("writing") : TEXT("pending"), Pair.Value.Attempts);
+    }
+}
+
+FString FPicoAchievementWriteQueue::RunScriptedSimulation()
+{
+    const float FrameTime = 1.0f / 72.0f;
+    const double SessionSeconds = 120.0;
+    const double OfflineStart = 30.0;
+    const double RestartTime = 60.0;
+    const double OnlineTime = 75.0;
+    const double CheckpointSeconds = 20.0;
+    const int32 NumCollectibles = 24;
+    const FString QueueFilePrefix = FPaths::ProjectSavedDir() / TEXT("PicoAchievementQueueSimulation");
+    const FString UserId = TEXT("SimulatedUser");
+
+    int32 NumCalls = 0;
+    int32 NumCallbacks = 0;
+    int32 NumFailedCallbacks = 0;
+    auto OnComplete = [&NumCallbacks, &NumFailedCallbacks](bool bSuccess, const FString&, bool)
+    {
+        NumCallbacks++;
+        NumFailedCallbacks += bSuccess ? 0 : 1;
+    };
+
+    TSharedRef<FPicoScriptedAchievementBackend> ScriptedBackend = MakeShared<FPicoScriptedAchievementBackend>();
+    ScriptedBackend->AddDefinition(TEXT("kills"), ppfAchievement_TypeCount, 1000);
+    ScriptedBackend->AddDefinition(TEXT("headshots"), ppfAchievement_TypeCount, 200);
+    ScriptedBackend->AddDefinition(TEXT("collectibles"), ppfAchievement_TypeBitfield, NumCollectibles, NumCollectibles);
+    ScriptedBackend->AddDefinition(TEXT("first_blood"), ppfAchievement_TypeSimple, 1);
+    ScriptedBackend->AddDefinition(TEXT("boss_rush"), ppfAchievement_TypeSimple, 1);
+    ScriptedBackend->Definitions[TEXT("boss_rush")].bArchived = true;
+
+    // The simulated clock runs far ahead of a background save, so the file is written within Tick.
+    auto MakeQueue = [&ScriptedBackend, &QueueFilePrefix](const FString& ForUserId)
+    {
+        TSharedPtr<FPicoAchievementWriteQueue> NewQueue = MakeShared<FPicoAchievementWriteQueue>(ScriptedBackend, QueueFilePrefix, false);
+        NewQueue->SetUserId(ForUserId);
+        return NewQueue;
+    };
+    const FString QueueFile = QueueFilePrefix + TEXT("_") + UserId + TEXT(".json");
+    IFileManager::Get().Delete(*QueueFile, false, false, true);
+    TSharedPtr<FPicoAchievementWriteQueue> Queue = MakeQueue(UserId);
+    FPicoAchievementWriteQueueStats TotalStats;
+    auto AddStats = [&TotalStats](const FPicoAchievementWriteQueueStats& Other)
+    {
+        TotalStats.NumChanges += Other.NumChanges;
+        TotalStats.NumRequests += Other.NumRequests;
+        TotalStats.NumFailures += Other.NumFailures;
+        TotalStats.NumReconciles += Other.NumReconciles;
+        TotalStats.NumDropped += Other.NumDropped;
+        TotalStats.NumRestored += Other.NumRestored;
+    };
+
+    // Gameplay reports every kill and pickup as it happens.
+    FRandomStream Random(0x51A7);
+    int64 ExpectedKills = 0;
+    int64 ExpectedHeadshots = 0;
+    FString ExpectedCollectibles = FString::ChrN(NumCollectibles, TEXT('0'));
+    double NextKillTime = 0.5;
+    double NextCollectibleTime = 2.0;
+    double NextCheckpointTime = CheckpointSeconds;
+    int32 NumCollected = 0;
+    bool bFirstBlood = false;
+    bool bBossRush = false;
+    bool bRestarted = false;
+    bool bOtherUserIsolated = false;
+    for (double Now = 0.0; Now < SessionSeconds; Now += FrameTime)
+    {
+        ScriptedBackend->bOnline = Now < OfflineStart || Now >= OnlineTime;
+        if (!bRestarted && Now >= RestartTime)
+        {
+            // The app is killed while offline; the callbacks of the old session are gone with it.
+            AddStats(Queue->GetStats());
+            Queue.Reset();
+            // Another user signing in on the device must not pick up the queue.
+            bOtherUserIsolated = MakeQueue(TEXT("OtherUser"))->IsIdle();
+            Queue = MakeQueue(UserId);
+            bRestarted = true;
+        }
+        if (Now >= NextKillTime)
+        {
+            Queue->AddCount(TEXT("kills"), 1, FString(), OnComplete);
+            ExpectedKills++;
+            NumCalls++;
+            if (Random.FRand() < 0.3f)
+            {
+                Queue->AddCount(TEXT("headshots"), 1, FString(), OnComplete);
+                ExpectedHeadshots++;
+                NumCalls++;
+            }
+            if (!bFirstBlood)
+            {
+                Queue->Unlock(TEXT("first_blood"), TEXT("{\"weapon\":\"pistol\"}"), OnComplete);
+                bFirstBlood = true;
+                NumCalls++;
+            }
+            NextKillTime += Random.FRandRange(0.1f, 0.5f);
+        }
+        if (Now >= NextCollectibleTime)
+        {
+            FString Fields = FString::ChrN(NumCollectibles, TEXT('0'));
+            Fields[NumCollected++ % NumCollectibles] = TEXT('1');
+            Queue->AddFields(TEXT("collectibles"), Fields, FString(), OnComplete);
+            OrFields(ExpectedCollectibles, Fields);
+            NumCalls++;
+            NextCollectibleTime += 4.0;
+        }
+        if (!bBossRush && Now >= OnlineTime + 5.0)
+        {
+            Queue->Unlock(TEXT("boss_rush"), FString(), OnComplete);
+            bBossRush = true;
+            NumCalls++;
+        }
+        if (Now >= NextCheckpointTime)
+        {
+            Queue->Checkpoint();
+            NextCheckpointTime += CheckpointSeconds;
+        }
+        Queue->Tick(FrameTime);
+    }
+    for (int32 Frame = 0; Frame < 72 * 120 && !Queue->IsIdle(); ++Frame)
+    {
+        Queue->Tick(FrameTime);
+    }
+    AddStats(Queue->GetStats());
+    Queue.Reset();
+    IFileManager::Get().Delete(*QueueFile, false, false, true);
+
+    const FPicoScriptedAchievementBackend::FProgress Kills = ScriptedBackend->Progress.FindRef(TEXT("kills"));
+    const FPicoScriptedAchievementBackend::FProgress Headshots = ScriptedBackend->Progress.FindRef(TEXT("headshots"));
+    const FPicoScriptedAchievementBackend::FProgress Collectibles = ScriptedBackend->Progress.FindRef(TEXT("collectibles"));
+    const bool bConverged = Kills.Count == ExpectedKills && Headshots.Count == ExpectedHeadshots
+        && Collectibles.Fields == ExpectedCollectibles && ScriptedBackend->Progress.FindRef(TEXT("first_blood")).bUnlocked
+        && !ScriptedBackend->Progress.Contains(TEXT("boss_rush")) && bOtherUserIsolated;
+    return FString::Printf(TEXT("%d calls over %.0f s, offline from %.0f s to %.0f s with a restart at %.0f s; one request per call would be %d requests; ")
+        TEXT("queued: %d requests (%lld saved), %lld failures, %lld reconciles, %lld restored, %lld dropped; kills %lld of %lld, headshots %lld of %lld, %s; ")
+        TEXT("%d callbacks (%d failed), the ones pending at the restart are lost"),
+        NumCalls, SessionSeconds, OfflineStart, OnlineTime, RestartTime, NumCalls,
+        ScriptedBackend->NumRequests, int64(NumCalls) - ScriptedBackend->NumRequests, TotalStats.NumFailures, TotalStats.NumReconciles,
+        TotalStats.NumRestored, TotalStats.NumDropped, Kills.Count, ExpectedKills, Headshots.Count, ExpectedHeadshots,
+        bConverged ? TEXT("converged") : TEXT("DIVERGED"), NumCallbacks, NumFailedCallbacks);
+}
@@ -0,0 +1,856 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoAssetDownloadScheduler.h"
+#include "OnlineSubsystemPico.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+    /** Higher priority first, then first in first out. */
+    bool RunsBefore(const FPicoAssetDownloadEntry& A, const FPicoAssetDownloadEntry& B)
+    {
+        if (A.Priority != B.Priority)
+        {
+            return A.Priority > B.Priority;
+        }
+        return A.Sequence < B.Sequence;
+    }
+
+    /** Forwards to the ppf_AssetFile_* calls. Progress comes from FPicoAssetFileInterface, which owns the notification. */
+    class FPicoPlatformAssetFileBackend : public IPicoAssetFileBackend
+    {
+    public:
+        FPicoPlatformAssetFileBackend(FOnlineSubsystemPico& InSubsystem) :
+            PicoSubsystem(InSubsystem),
+            AssetFileInterface(InSubsystem.GetPicoAssetFileInterface())
+        {
+            if (AssetFileInterface.IsValid())
+            {
+                DownloadUpdateHandle = AssetFileInterface.Pin()->AssetFileDownloadUpdateDataCallback
+                    .AddRaw(this, &FPicoPlatformAssetFileBackend::OnAssetFileDownloadUpdate);
+            }
+        }
+
+        virtual ~FPicoPlatformAssetFileBackend()
+        {
+            if (TSharedPtr<FPicoAssetFileInterface> Interface = AssetFileInterface.Pin())
+            {
+                Interface->AssetFileDownloadUpdateDataCallback.Remove(DownloadUpdateHandle);
+            }
+        }
+
+        virtual bool StartDownload(const FString& AssetId, const FString& AssetName, FOnDownloadStarted OnStarted) override
+        {
+#if PLATFORM_ANDROID
+            ppfRequest RequestId = AssetId.IsEmpty()
+                ? ppf_AssetFile_DownloadByName(TCHAR_TO_UTF8(*AssetName))
+                : ppf_AssetFile_DownloadById(FStringTouint64(AssetId));
+            if (RequestId == 0)
+            {
+                return false;
+            }
+            PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
+                [OnStarted](ppfMessageHandle Message, bool bIsError)
+                {
+                    if (bIsError)
+                    {
+                        auto Error = ppf_Message_GetError(Message);
+                        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
+                        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
+                        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
+                        OnStarted.ExecuteIfBound(true, ErrorMessage, FString());
+                    }
+                    else
+                    {
+                        ppfAssetFileDownloadResultHandle Result = ppf_Message_GetAssetFileDownloadResult(Message);
+                        OnStarted.ExecuteIfBound(false, FString(), uint64ToFString(ppf_AssetFileDownloadResult_GetAssetId(Result)));
+                    }
+                }));
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        virtual bool CancelDownload(const FString& AssetId) override
+        {
+#if PLATFORM_ANDROID
+            ppfRequest RequestId = ppf_AssetFile_DownloadCancelById(FStringTouint64(AssetId));
+            if (RequestId == 0)
+            {
+                return false;
+            }
+            PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
+                [AssetId](ppfMessageHandle Message, bool bIsError)
+                {
+                    if (bIsError)
+                    {
+                        UE_LOG(PicoAssetFile, Warning, TEXT("Cancelling scheduled download %s failed"), *AssetId);
+                    }
+                }));
+            return true;
+#else
+            return false;
+#endif
+        }
+
+    private:
+        void OnAssetFileDownloadUpdate(const FPicoAssetFileDownloadUpdateData& DownloadUpdate)
+        {
+            OnDownloadUpdate.Broadcast(DownloadUpdate);
+        }
+
+        FOnlineSubsystemPico& PicoSubsystem;
+        TWeakPtr<FPicoAssetFileInterface> AssetFileInterface;
+        FDelegateHandle DownloadUpdateHandle;
+    };
+}
+
+void FPicoScriptedAssetFileBackend::SetScript(const FString& AssetKey, const FScript& Script)
+{
+    Scripts.Add(AssetKey, Script);
+}
+
+const FPicoScriptedAssetFileBackend::FScript& FPicoScriptedAssetFileBackend::GetScript(const FString& AssetKey) const
+{
+    const FScript* Script = Scripts.Find(AssetKey);
+    return Script ? *Script : DefaultScript;
+}
+
+bool FPicoScriptedAssetFileBackend::StartDownload(const FString& AssetId, const FString& AssetName, FOnDownloadStarted OnStarted)
+{
+    ++NumStartCalls;
+    const FString& AssetKey = AssetId.IsEmpty() ? AssetName : AssetId;
+    const FString ResolvedId = AssetId.IsEmpty() ? uint64ToFString(NextScriptedAssetId++) : AssetId;
+
+    // Like the platform, asking again for a running download restarts it.
+    Downloads.RemoveAll([&ResolvedId](const FScriptedDownload& Download) { return Download.AssetId == ResolvedId; });
+
+    FScriptedDownload& Download = Downloads.AddDefaulted_GetRef();
+    Download.AssetId = ResolvedId;
+    Download.Script = GetScript(AssetKey);
+    Download.OnStarted = OnStarted;
+    Download.StartDelay = FMath::Max(Download.Script.StartLatency, KINDA_SMALL_NUMBER);
+    return true;
+}
+
+bool FPicoScriptedAssetFileBackend::CancelDownload(const FString& AssetId)
+{
+    ++NumCancelCalls;
+    return Downloads.RemoveAll([&AssetId](const FScriptedDownload& Download) { return Download.AssetId == AssetId; }) > 0;
+}
+
+void FPicoScriptedAssetFileBackend::Tick(float DeltaTime)
+{
+    int32 NumTransferring = 0;
+    for (const FScriptedDownload& Download : Downloads)
+    {
+        NumTransferring += Download.StartDelay <= 0.0f ? 1 : 0;
+    }
+    const double LinkShare = LinkBytesPerSecond > 0.0 && NumTransferring > 0 ? LinkBytesPerSecond / NumTransferring : 0.0;
+
+    // Callbacks may start or cancel downloads, so they only run once the list is settled.
+    TArray<TPair<FOnDownloadStarted, FString>> Started;
+    TArray<FOnDownloadStarted> RejectedCallbacks;
+    TArray<FPicoAssetFileDownloadUpdateData> Updates;
+
+    for (int32 Index = 0; Index < Downloads.Num(); ++Index)
+    {
+        FScriptedDownload& Download = Downloads[Index];
+        if (Download.StartDelay > 0.0f)
+        {
+            Download.StartDelay -= DeltaTime;
+            if (Download.StartDelay <= 0.0f)
+            {
+                if (Download.Script.bRejectStart)
+                {
+                    RejectedCallbacks.Add(Download.OnStarted);
+                    Downloads.RemoveAt(Index--);
+                }
+                else
+                {
+                    Started.Emplace(Download.OnStarted, Download.AssetId);
+                }
+            }
+            continue;
+        }
+
+        const double Rate = LinkShare > 0.0 ? FMath::Min(LinkShare, Download.Script.BytesPerSecond) : Download.Script.BytesPerSecond;
+        Download.BytesTransferred = FMath::Min(Download.BytesTransferred + Rate * DeltaTime, double(Download.Script.BytesTotal));
+
+        FPicoAssetFileDownloadUpdateData& Update = Updates.AddDefaulted_GetRef();
+        Update.AssetId = Download.AssetId;
+        Update.ppfAssetId = FStringTouint64(Download.AssetId);
+        Update.BytesTotal = Download.Script.BytesTotal;
+        Update.BytesTransferred = int64(Download.BytesTransferred);
+        Update.CompleteStatus = EAssetFileDownloadCompleteStatus::Downloading;
+        if (Download.Script.FailAtBytes >= 0 && Update.BytesTransferred >= Download.Script.FailAtBytes)
+        {
+            Update.CompleteStatus = EAssetFileDownloadCompleteStatus::Failed;
+        }
+        else if (Update.BytesTransferred >= Update.BytesTotal)
+        {
+            Update.CompleteStatus = EAssetFileDownloadCompleteStatus::Succeed;
+        }
+
+        if (Update.CompleteStatus != EAssetFileDownloadCompleteStatus::Downloading)
+        {
+            Downloads.RemoveAt(Index--);
+        }
+    }
+
+    for (const FOnDownloadStarted& OnStarted : RejectedCallbacks)
+    {
+        OnStarted.ExecuteIfBound(true, TEXT("Scripted download rejected"), FString());
+    }
+    for (const TPair<FOnDownloadStarted, FString>& Start : Started)
+    {
+        Start.Key.ExecuteIfBound(false, FString(), Start.Value);
+    }
+    for (const FPicoAssetFileDownloadUpdateData& Update : Updates)
+    {
+        OnDownloadUpdate.Broadcast(Update);
+    }
+}
+
+FPicoAssetDownloadScheduler::FPicoAssetDownloadScheduler(TSharedRef<IPicoAssetFileBackend> InBackend, const FString& InQueueFilePath) :
+    Backend(InBackend),
+    QueueFilePath(InQueueFilePath)
+{
+    int32 ConfigMaxBytesPerSecond = 0;
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("AssetDownloadMaxConcurrent"), MaxConcurrentDownloads, GEngineIni);
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("AssetDownloadMaxBytesPerSecond"), ConfigMaxBytesPerSecond, GEngineIni);
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("AssetDownloadMaxRetries"), MaxRetries, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("AssetDownloadRetryDelay"), RetryDelay, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("AssetDownloadMaxRetryDelay"), MaxRetryDelay, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("AssetDownloadProgressInterval"), ProgressInterval, GEngineIni);
+    MaxConcurrentDownloads = FMath::Max(MaxConcurrentDownloads, 1);
+    MaxBytesPerSecond = FMath::Max(ConfigMaxBytesPerSecond, 0);
+    MaxRetries = FMath::Max(MaxRetries, 0);
+    RetryDelay = FMath::Max(RetryDelay, 0.0f);
+    MaxRetryDelay = FMath::Max(MaxRetryDelay, RetryDelay);
+
+    DownloadUpdateHandle = Backend->OnDownloadUpdate.AddRaw(this, &FPicoAssetDownloadScheduler::OnDownloadUpdate);
+
+    LoadQueue();
+}
+
+FPicoAssetDownloadScheduler::~FPicoAssetDownloadScheduler()
+{
+    // Running downloads are left alone; they are requested again on the next launch.
+    if (bQueueDirty)
+    {
+        SaveQueue();
+    }
+    Backend->OnDownloadUpdate.Remove(DownloadUpdateHandle);
+}
+
+TSharedRef<IPicoAssetFileBackend> FPicoAssetDownloadScheduler::CreatePlatformBackend(FOnlineSubsystemPico& InSubsystem)
+{
+    return MakeShareable(new FPicoPlatformAssetFileBackend(InSubsystem));
+}
+
+bool FPicoAssetDownloadScheduler::EnqueueById(const FString& AssetId, EPicoAssetDownloadPriority Priority)
+{
+    return Enqueue(AssetId, FString(), Priority);
+}
+
+bool FPicoAssetDownloadScheduler::EnqueueByName(const FString& AssetName, EPicoAssetDownloadPriority Priority)
+{
+    return Enqueue(FString(), AssetName, Priority);
+}
+
+bool FPicoAssetDownloadScheduler::Enqueue(const FString& AssetId, const FString& AssetName, EPicoAssetDownloadPriority Priority)
+{
+    const FString& Key = AssetId.IsEmpty() ? AssetName : AssetId;
+    if (Key.IsEmpty())
+    {
+        return false;
+    }
+
+    FPicoAssetDownloadEntry* Entry = Entries.FindByPredicate([&Key](const FPicoAssetDownloadEntry& Existing) { return Existing.Key == Key; });
+    if (!Entry && !AssetId.IsEmpty())
+    {
+        Entry = FindEntryByAssetId(AssetId);
+    }
+
+    if (Entry)
+    {
+        if (Entry->IsFinished())
+        {
+            Entry->State = EPicoAssetDownloadState::Queued;
+            Entry->Priority = Priority;
+            Entry->Attempts = 0;
+            Entry->RetryTime = 0.0;
+            Entry->Sequence = NextSequence++;
+        }
+        else
+        {
+            Entry->Priority = FMath::Max(Entry->Priority, Priority);
+        }
+    }
+    else
+    {
+        FPicoAssetDownloadEntry& NewEntry = Entries.AddDefaulted_GetRef();
+        NewEntry.Key = Key;
+        NewEntry.AssetId = AssetId;
+        NewEntry.AssetName = AssetName;
+        NewEntry.Priority = Priority;
+        NewEntry.Sequence = NextSequence++;
+    }
+    bQueueDirty = true;
+    return true;
+}
+
+bool FPicoAssetDownloadScheduler::SetPriority(const FString& AssetKey, EPicoAssetDownloadPriority Priority)
+{
+    FPicoAssetDownloadEntry* Entry = FindMutableEntry(AssetKey);
+    if (!Entry)
+    {
+        return false;
+    }
+    Entry->Priority = Priority;
+    bQueueDirty = true;
+    return true;
+}
+
+bool FPicoAssetDownloadScheduler::Cancel(const FString& AssetKey)
+{
+    FPicoAssetDownloadEntry* Entry = FindMutableEntry(AssetKey);
+    if (!Entry)
+    {
+        return false;
+    }
+    const int32 Index = UE_PTRDIFF_TO_INT32(Entry - Entries.GetData());
+    StopEntry(*Entry, EPicoAssetDownloadState::Queued);
+    Entries.RemoveAt(Index);
+    bQueueDirty = true;
+    return true;
+}
+
+void FPicoAssetDownloadScheduler::Pause()
+{
+    bPaused = true;
+    Schedule();
+}
+
+void FPicoAssetDownloadScheduler::Resume()
+{
+    bPaused = false;
+}
+
+void FPicoAssetDownloadScheduler::BeginCriticalSection()
+{
+    ++CriticalSectionDepth;
+    Schedule();
+}
+
+void FPicoAssetDownloadScheduler::EndCriticalSection()
+{
+    CriticalSectionDepth = FMath::Max(CriticalSectionDepth - 1, 0);
+}
+
+void FPicoAssetDownloadScheduler::SetMaxConcurrentDownloads(int32 InMaxConcurrentDownloads)
+{
+    MaxConcurrentDownloads = FMath::Max(InMaxConcurrentDownloads, 1);
+}
+
+void FPicoAssetDownloadScheduler::SetMaxBytesPerSecond(int64 InMaxBytesPerSecond)
+{
+    MaxBytesPerSecond = FMath::Max<int64>(InMaxBytesPerSecond, 0);
+}
+
+const FPicoAssetDownloadEntry* FPicoAssetDownloadScheduler::FindEntry(const FString& AssetKey) const
+{
+    if (AssetKey.IsEmpty())
+    {
+        return nullptr;
+    }
+    return Entries.FindByPredicate([&AssetKey](const FPicoAssetDownloadEntry& Entry) { return Entry.Key == AssetKey || Entry.AssetId == AssetKey; });
+}
+
+FPicoAssetDownloadEntry* FPicoAssetDownloadScheduler::FindMutableEntry(const FString& AssetKey)
+{
+    if (AssetKey.IsEmpty())
+    {
+        return nullptr;
+    }
+    return Entries.FindByPredicate([&AssetKey](const FPicoAssetDownloadEntry& Entry) { return Entry.Key == AssetKey || Entry.AssetId == AssetKey; });
+}
+
+FPicoAssetDownloadEntry* FPicoAssetDownloadScheduler::FindEntryBySequence(uint32 Sequence)
+{
+    return Entries.FindByPredicate([Sequence](const FPicoAssetDownloadEntry& Entry) { return Entry.Sequence == Sequence; });
+}
+
+FPicoAssetDownloadEntry* FPicoAssetDownloadScheduler::FindEntryByAssetId(const FString& AssetId)
+{
+    if (AssetId.IsEmpty())
+    {
+        return nullptr;
+    }
+    return Entries.FindByPredicate([&AssetId](const FPicoAssetDownloadEntry& Entry) { return Entry.AssetId == AssetId; });
+}
+
+FPicoAssetDownloadEntry* FPicoAssetDownloadScheduler::FindLowestActive()
+{
+    FPicoAssetDownloadEntry* Lowest = nullptr;
+    for (FPicoAssetDownloadEntry& Entry : Entries)
+    {
+        if (Entry.IsActive() && (!Lowest || RunsBefore(*Lowest, Entry)))
+        {
+            Lowest = &Entry;
+        }
+    }
+    return Lowest;
+}
+
+void FPicoAssetDownloadScheduler::ClearFinished()
+{
+    Entries.RemoveAll([](const FPicoAssetDownloadEntry& Entry) { return Entry.IsFinished(); });
+}
+
+bool FPicoAssetDownloadScheduler::CanRun(const FPicoAssetDownloadEntry& Entry) const
+{
+    return !bPaused && (CriticalSectionDepth == 0 || Entry.Priority == EPicoAssetDownloadPriority::Required);
+}
+
+bool FPicoAssetDownloadScheduler::CanStart(const FPicoAssetDownloadEntry& Entry) const
+{
+    return Entry.State == EPicoAssetDownloadState::Queued && CanRun(Entry) && Entry.RetryTime <= SchedulerTime;
+}
+
+bool FPicoAssetDownloadScheduler::HasBandwidthFor(int32 NumActive) const
+{
+    if (MaxBytesPerSecond <= 0 || NumActive == 0)
+    {
+        return true;
+    }
+    // Wait for a throughput sample that includes the last download we started, then assume another one
+    // would take an average share.
+    if (!bRateSampledSinceStart)
+    {
+        return false;
+    }
+    return BytesPerSecond + BytesPerSecond / NumActive <= double(MaxBytesPerSecond);
+}
+
+void FPicoAssetDownloadScheduler::StartEntry(FPicoAssetDownloadEntry& Entry)
+{
+    Entry.State = EPicoAssetDownloadState::Starting;
+    ++Entry.Attempts;
+    Entry.StartRequest = NextStartRequest++;
+    bRateSampledSinceStart = false;
+
+    UE_LOG(PicoAssetFile, Log, TEXT("Starting scheduled download %s, attempt %d"), *Entry.Key, Entry.Attempts);
+    const bool bSent = Backend->StartDownload(Entry.AssetId, Entry.AssetName,
+        IPicoAssetFileBackend::FOnDownloadStarted::CreateSP(this, &FPicoAssetDownloadScheduler::OnDownloadStarted, Entry.Sequence, Entry.StartRequest));
+    if (!bSent)
+    {
+        FailAttempt(Entry, TEXT("Sending download request failed"));
+    }
+}
+
+void FPicoAssetDownloadScheduler::StopEntry(FPicoAssetDownloadEntry& Entry, EPicoAssetDownloadState NewState)
+{
+    // There is no pause in the asset file API, so stopping cancels, losing what was transferred, and starting again
+    // asks for the whole download. A download by name without an ID yet is cancelled once its request returns,
+    // see OnDownloadStarted.
+    if (Entry.IsActive() && !Entry.AssetId.IsEmpty())
+    {
+        Backend->CancelDownload(Entry.AssetId);
+    }
+    Entry.State = NewState;
+}
+
+void FPicoAssetDownloadScheduler::FailAttempt(FPicoAssetDownloadEntry& Entry, const FString& ErrorMessage)
+{
+    if (Entry.Attempts <= MaxRetries)
+    {
+        // Exponential backoff, so a server or network outage is not hammered with requests every tick.
+        const float Delay = FMath::Min(RetryDelay * float(1 << FMath::Min(Entry.Attempts - 1, 16)), MaxRetryDelay);
+        UE_LOG(PicoAssetFile, Warning, TEXT("Scheduled download %s failed, retrying in %.1f s: %s"), *Entry.Key, Delay, *ErrorMessage);
+        Entry.State = EPicoAssetDownloadState::Queued;
+        Entry.RetryTime = SchedulerTime + Delay;
+        return;
+    }
+
+    UE_LOG(PicoAssetFile, Warning, TEXT("Scheduled download %s failed after %d attempts: %s"), *Entry.Key, Entry.Attempts, *ErrorMessage);
+    Entry.State = EPicoAssetDownloadState::Failed;
+    PendingCompletions.Emplace(Entry, ErrorMessage);
+    bQueueDirty = true;
+}
+
+void FPicoAssetDownloadScheduler::Schedule()
+{
+    // Running downloads are never stopped to throttle, that would throw their progress away. Pause, critical
+    // sections and a lowered concurrency limit only keep new ones from starting until the running ones finish.
+    int32 NumActive = 0;
+    for (FPicoAssetDownloadEntry& Entry : Entries)
+    {
+        const bool bCanRun = CanRun(Entry);
+        if (Entry.IsActive())
+        {
+            ++NumActive;
+        }
+        else if (Entry.State == EPicoAssetDownloadState::Queued && !bCanRun)
+        {
+            Entry.State = EPicoAssetDownloadState::Paused;
+        }
+        else if (Entry.State == EPicoAssetDownloadState::Paused && bCanRun)
+        {
+            Entry.State = EPicoAssetDownloadState::Queued;
+        }
+    }
+
+    TArray<int32, TInlineAllocator<16>> Candidates;
+    for (int32 Index = 0; Index < Entries.Num(); ++Index)
+    {
+        if (CanStart(Entries[Index]))
+        {
+            Candidates.Add(Index);
+        }
+    }
+    Candidates.Sort([this](int32 A, int32 B) { return RunsBefore(Entries[A], Entries[B]); });
+
+    for (int32 Index : Candidates)
+    {
+        FPicoAssetDownloadEntry& Candidate = Entries[Index];
+        if (NumActive >= MaxConcurrentDownloads)
+        {
+            // A higher priority download takes the slot of the lowest priority one that runs.
+            FPicoAssetDownloadEntry* Lowest = FindLowestActive();
+            if (!Lowest || Lowest->Priority >= Candidate.Priority)
+            {
+                break;
+            }
+            StopEntry(*Lowest, EPicoAssetDownloadState::Queued);
+            --NumActive;
+        }
+        else if (!HasBandwidthFor(NumActive))
+        {
+            break;
+        }
+
+        StartEntry(Candidate);
+        NumActive += Candidate.IsActive() ? 1 : 0;
+    }
+}
+
+void FPicoAssetDownloadScheduler::OnDownloadStarted(bool bIsError, const FString& ErrorMessage, const FString& AssetId, uint32 Sequence, uint32 StartRequest)
+{
+    FPicoAssetDownloadEntry* Entry = FindEntryBySequence(Sequence);
+    if (!Entry || Entry->StartRequest != StartRequest || Entry->State != EPicoAssetDownloadState::Starting)
+    {
+        // Cancelled, paused or restarted while the request was in flight. A restarted download shares the platform
+        // download of the stale request, so that one must not be cancelled.
+        const bool bRequestedAgain = Entry && Entry->IsActive() && (Entry->AssetId.IsEmpty() || Entry->AssetId == AssetId);
+        if (!bIsError && !AssetId.IsEmpty() && !bRequestedAgain)
+        {
+            Backend->CancelDownload(AssetId);
+        }
+        return;
+    }
+
+    if (bIsError)
+    {
+        FailAttempt(*Entry, ErrorMessage);
+        return;
+    }
+
+    if (!AssetId.IsEmpty() && Entry->AssetId != AssetId)
+    {
+        Entry->AssetId = AssetId;
+        bQueueDirty = true;
+    }
+    Entry->State = EPicoAssetDownloadState::Downloading;
+}
+
+void FPicoAssetDownloadScheduler::OnDownloadUpdate(const FPicoAssetFileDownloadUpdateData& DownloadUpdate)
+{
+    FPicoAssetDownloadEntry* Entry = FindEntryByAssetId(DownloadUpdate.AssetId);
+    if (!Entry || !Entry->IsActive())
+    {
+        // Downloads started outside the scheduler, or late updates of stopped ones.
+        return;
+    }
+
+    WindowBytes += FMath::Max<int64>(DownloadUpdate.BytesTransferred - Entry->BytesTransferred, 0);
+    Entry->BytesTransferred = DownloadUpdate.BytesTransferred;
+    Entry->BytesTotal = DownloadUpdate.BytesTotal;
+
+    switch (DownloadUpdate.CompleteStatus)
+    {
+    case EAssetFileDownloadCompleteStatus::Succeed:
+        UE_LOG(PicoAssetFile, Log, TEXT("Scheduled download %s succeeded"), *Entry->Key);
+        Entry->State = EPicoAssetDownloadState::Succeeded;
+        Entry->BytesTransferred = Entry->BytesTotal;
+        PendingCompletions.Emplace(*Entry, FString());
+        bQueueDirty = true;
+        break;
+    case EAssetFileDownloadCompleteStatus::Failed:
+        FailAttempt(*Entry, TEXT("Download failed"));
+        break;
+    default:
+        Entry->State = EPicoAssetDownloadState::Downloading;
+        break;
+    }
+}
+
+void FPicoAssetDownloadScheduler::UpdateProgress(float DeltaTime)
+{
+    WindowTime += DeltaTime;
+    if (WindowTime < ProgressInterval)
+    {
+        return;
+    }
+
+    FPicoAssetDownloadProgress NewProgress;
+    NewProgress.bPaused = bPaused || CriticalSectionDepth > 0;
+    for (const FPicoAssetDownloadEntry& Entry : Entries)
+    {
+        NewProgress.BytesTotal += Entry.BytesTotal;
+        NewProgress.BytesTransferred += Entry.BytesTransferred;
+        NewProgress.NumQueued += Entry.State == EPicoAssetDownloadState::Queued ? 1 : 0;
+        NewProgress.NumActive += Entry.IsActive() ? 1 : 0;
+        NewProgress.NumPaused += Entry.State == EPicoAssetDownloadState::Paused ? 1 : 0;
+        NewProgress.NumSucceeded += Entry.State == EPicoAssetDownloadState::Succeeded ? 1 : 0;
+        NewProgress.NumFailed += Entry.State == EPicoAssetDownloadState::Failed ? 1 : 0;
+    }
+
+    const double WindowRate = WindowBytes / WindowTime;
+    BytesPerSecond = NewProgress.NumActive == 0 ? 0.0 : (BytesPerSecond > 0.0 ? FMath::Lerp(BytesPerSecond, WindowRate, 0.5) : WindowRate);
+    NewProgress.BytesPerSecond = BytesPerSecond;
+    WindowBytes = 0;
+    WindowTime = 0.0f;
+    bRateSampledSinceStart = true;
+
+    // Over the cap nothing new starts, see HasBandwidthFor, and the rate comes down as running downloads finish.
+    if (MaxBytesPerSecond > 0 && BytesPerSecond > MaxBytesPerSecond * 1.1)
+    {
+        UE_LOG(PicoAssetFile, Verbose, TEXT("Download rate %.0f B/s over cap, holding back new downloads"), BytesPerSecond);
+    }
+
+    const bool bChanged = !(NewProgress == Progress);
+    Progress = NewProgress;
+    if (bChanged || Progress.NumActive > 0)
+    {
+        OnProgress.Broadcast(Progress);
+    }
+
+    if (bQueueDirty)
+    {
+        SaveQueue();
+    }
+}
+
+void FPicoAssetDownloadScheduler::Tick(float DeltaTime)
+{
+    SchedulerTime += DeltaTime;
+    Backend->Tick(DeltaTime);
+    Schedule();
+    UpdateProgress(DeltaTime);
+
+    if (PendingCompletions.Num() > 0)
+    {
+        TArray<TPair<FPicoAssetDownloadEntry, FString>> Completions = MoveTemp(PendingCompletions);
+        for (const TPair<FPicoAssetDownloadEntry, FString>& Completion : Completions)
+        {
+            OnDownloadComplete.Broadcast(Completion.Key, Completion.Key.State == EPicoAssetDownloadState::Succeeded, Completion.Value);
+        }
+    }
+}
+
+bool FPicoAssetDownloadScheduler::SaveQueue()
+{
+    bQueueDirty = false;
+    if (QueueFilePath.IsEmpty())
+    {
+        return false;
+    }
+
+    TArray<TSharedPtr<FJsonValue>> Downloads;
+    for (const FPicoAssetDownloadEntry& Entry : Entries)
+    {
+        if (Entry.IsFinished())
+        {
+            continue;
+        }
+        TSharedRef<FJsonObject> Download = MakeShared<FJsonObject>();
+        Download->SetStringField(TEXT("AssetId"), Entry.AssetId);
+        Download->SetStringField(TEXT("AssetName"), Entry.AssetName);
+        Download->SetNumberField(TEXT("Priority"), int32(Entry.Priority));
+        Downloads.Add(MakeShared<FJsonValueObject>(Download));
+    }
+
+    if (Downloads.Num() == 0)
+    {
+        IFileManager::Get().Delete(*QueueFilePath, false, false, true);
+        return true;
+    }
+
+    TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+    Root->SetArrayField(TEXT("Downloads"), Downloads);
+
+    FString Json;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+    if (!FJsonSerializer::Serialize(Root, Writer) || !FFileHelper::SaveStringToFile(Json, *QueueFilePath))
+    {
+        UE_LOG(PicoAssetFile, Warning, TEXT("Saving the download queue to %s failed"), *QueueFilePath);
+        return false;
+    }
+    return true;
+}
+
+bool FPicoAssetDownloadScheduler::LoadQueue()
+{
+    FString Json;
+    if (QueueFilePath.IsEmpty() || !FFileHelper::LoadFileToString(Json, *QueueFilePath))
+    {
+        return false;
+    }
+
+    TSharedPtr<FJsonObject> Root;
+    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+    const TArray<TSharedPtr<FJsonValue>>* Downloads = nullptr;
+    if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("Downloads"), Downloads))
+    {
+        UE_LOG(PicoAssetFile, Warning, TEXT("Ignoring unreadable download queue %s"), *QueueFilePath);
+        return false;
+    }
+
+    for (const TSharedPtr<FJsonValue>& Value : *Downloads)
+    {
+        const TSharedPtr<FJsonObject>* Download = nullptr;
+        if (!Value->TryGetObject(Download))
+        {
+            continue;
+        }
+        const int32 Priority = FMath::Clamp((*Download)->GetIntegerField(TEXT("Priority")), 0, int32(EPicoAssetDownloadPriority::Required));
+        Enqueue((*Download)->GetStringField(TEXT("AssetId")), (*Download)->GetStringField(TEXT("AssetName")), EPicoAssetDownloadPriority(Priority));
+    }
+    bQueueDirty = false;
+
+    UE_LOG(PicoAssetFile, Log, TEXT("Restored %d downloads from %s"), Entries.Num(), *QueueFilePath);
+    return true;
+}
+
+FString FPicoAssetDownloadScheduler::RunScriptedSimulation(int32 NumAssets, int32 InMaxConcurrentDownloads, int64 InMaxBytesPerSecond)
+{
+    const float FrameTime = 1.0f / 72.0f;
+    const float CriticalStart = 2.0f;
+    const float CriticalEnd = 4.0f;
+    const float MaxSimulatedTime = 600.0f;
+
+    TSharedRef<FPicoScriptedAssetFileBackend> ScriptedBackend = MakeShared<FPicoScriptedAssetFileBackend>();
+    ScriptedBackend->DefaultScript.BytesTotal = 32 * 1024 * 1024;
+    ScriptedBackend->DefaultScript.BytesPerSecond = 8 * 1024 * 1024;
+    ScriptedBackend->LinkBytesPerSecond = 24 * 1024 * 1024;
+
+    // One download that keeps failing halfway to exercise retries.
+    FPicoScriptedAssetFileBackend::FScript Failing = ScriptedBackend->DefaultScript;
+    Failing.FailAtBytes = Failing.BytesTotal / 2;
+    ScriptedBackend->SetScript(TEXT("1001"), Failing);
+
+    TSharedRef<FPicoAssetDownloadScheduler> Scheduler = MakeShareable(new FPicoAssetDownloadScheduler(ScriptedBackend, FString()));
+    Scheduler->SetMaxConcurrentDownloads(InMaxConcurrentDownloads);
+    Scheduler->SetMaxBytesPerSecond(InMaxBytesPerSecond);
+
+    int32 NumRawUpdates = 0;
+    ScriptedBackend->OnDownloadUpdate.AddLambda([&NumRawUpdates](const FPicoAssetFileDownloadUpdateData&) { ++NumRawUpdates; });
+    int32 NumProgressReports = 0;
+    Scheduler->OnProgress.AddLambda([&NumProgressReports](const FPicoAssetDownloadProgress&) { ++NumProgressReports; });
+
+    float SimulatedTime = 0.0f;
+    double FinishTimeSum[3] = { 0.0, 0.0, 0.0 };
+    int32 FinishCount[3] = { 0, 0, 0 };
+    Scheduler->OnDownloadComplete.AddLambda([&](const FPicoAssetDownloadEntry& Entry, bool bSucceeded, const FString&)
+        {
+            if (bSucceeded)
+            {
+                FinishTimeSum[int32(Entry.Priority)] += SimulatedTime;
+                ++FinishCount[int32(Entry.Priority)];
+            }
+        });
+
+    // Enqueued lowest priority first, so ordering comes from the scheduler rather than from the caller.
+    for (int32 Index = 0; Index < NumAssets; ++Index)
+    {
+        const EPicoAssetDownloadPriority Priority = Index < NumAssets / 2 ? EPicoAssetDownloadPriority::Background
+            : (Index < NumAssets * 3 / 4 ? EPicoAssetDownloadPriority::Prefetch : EPicoAssetDownloadPriority::Required);
+        Scheduler->EnqueueById(FString::FromInt(1000 + Index), Priority);
+    }
+
+    const double StartTime = FPlatformTime::Seconds();
+    int32 PeakActive = 0;
+    int32 CriticalViolations = 0;
+    bool bInCritical = false;
+    // Running downloads finish through a critical section, only starting another one is a violation.
+    TSet<uint32> RunningAtCriticalStart;
+    while (SimulatedTime < MaxSimulatedTime)
+    {
+        if (!bInCritical && SimulatedTime >= CriticalStart && SimulatedTime < CriticalEnd)
+        {
+            Scheduler->BeginCriticalSection();
+            bInCritical = true;
+            RunningAtCriticalStart.Reset();
+            for (const FPicoAssetDownloadEntry& Entry : Scheduler->GetEntries())
+            {
+                if (Entry.IsActive())
+                {
+                    RunningAtCriticalStart.Add(Entry.Sequence);
+                }
+            }
+        }
+        else if (bInCritical && SimulatedTime >= CriticalEnd)
+        {
+            Scheduler->EndCriticalSection();
+            bInCritical = false;
+        }
+
+        Scheduler->Tick(FrameTime);
+        SimulatedTime += FrameTime;
+
+        int32 NumActive = 0;
+        bool bAllFinished = true;
+        for (const FPicoAssetDownloadEntry& Entry : Scheduler->GetEntries())
+        {
+            NumActive += Entry.IsActive() ? 1 : 0;
+            CriticalViolations += bInCritical && Entry.IsActive() && Entry.Priority != EPicoAssetDownloadPriority::Required
+                && !RunningAtCriticalStart.Contains(Entry.Sequence) ? 1 : 0;
+            bAllFinished &= Entry.IsFinished();
+        }
+        PeakActive = FMath::Max(PeakActive, NumActive);
+        if (bAllFinished)
+        {
+            // One more tick delivers the last completions.
+            Scheduler->Tick(FrameTime);
+            break;
+        }
+    }
+    const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+    int32 NumSucceeded = 0;
+    int32 NumFailed = 0;
+    for (const FPicoAssetDownloadEntry& Entry : Scheduler->GetEntries())
+    {
+        NumSucceeded += Entry.State == EPicoAssetDownloadState::Succeeded ? 1 : 0;
+        NumFailed += Entry.State == EPicoAssetDownloadState::Failed ? 1 : 0;
+    }
+
+    auto MeanFinish = [&](EPicoAssetDownloadPriority Priority)
+    {
+        const int32 Index = int32(Priority);
+        return FinishCount[Index] > 0 ? FinishTimeSum[Index] / FinishCount[Index] : 0.0;
+    };
+
+    return FString::Printf(TEXT("%d downloads in %.1f simulated s (%.2f ms): %d succeeded, %d failed, peak %d active, %d start and %d cancel calls, ")
+        TEXT("%d raw updates delivered as %d progress reports, %d critical section violations, mean finish required %.1f s, prefetch %.1f s, background %.1f s"),
+        NumAssets, SimulatedTime, ElapsedMs, NumSucceeded, NumFailed, PeakActive, ScriptedBackend->NumStartCalls, ScriptedBackend->NumCancelCalls,
+        NumRawUpdates, NumProgressReports, CriticalViolations,
+        MeanFinish(EPicoAssetDownloadPriority::Required), MeanFinish(EPicoAssetDownloadPriority::Prefetch), MeanFinish(EPicoAssetDownloadPriority::Background));
+}
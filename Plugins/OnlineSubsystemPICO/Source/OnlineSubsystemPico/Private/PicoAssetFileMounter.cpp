@@ -0,0 +1,287 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoAssetFileMounter.h"
+#include "Pico_AssetFile.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/SecureHash.h"
+
+FString FPicoAssetMountResult::ToString() const
+{
+    if (!bSuccess)
+    {
+        return FString::Printf(TEXT("Mounting %s failed after %.1f ms: %s"), *Filepath, TotalSeconds * 1000.0, *ErrorMessage);
+    }
+    return FString::Printf(TEXT("Mounted %s (%lld bytes%s) in %.1f ms: verify %.1f ms, mount %.1f ms, preload %.1f ms; ")
+        TEXT("game thread %.2f ms, longest slice %.2f ms, longest frame %.1f ms"),
+        *Filepath, FileSize, bMemoryMapped ? TEXT(", mapped") : TEXT(""), TotalSeconds * 1000.0,
+        VerifySeconds * 1000.0, MountSeconds * 1000.0, PreloadSeconds * 1000.0,
+        GameThreadSeconds * 1000.0, MaxGameThreadSliceSeconds * 1000.0, MaxFrameSeconds * 1000.0);
+}
+
+FPicoAssetFileMounter::FPicoAssetFileMounter()
+{
+    int32 MemoryMapThresholdKB = int32(Settings.MemoryMapThreshold / 1024);
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("AssetMountMemoryMapThresholdKB"), MemoryMapThresholdKB, GEngineIni);
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("AssetMountPreloadBatchSize"), PreloadBatchSize, GEngineIni);
+    Settings.MemoryMapThreshold = int64(FMath::Max(MemoryMapThresholdKB, 0)) * 1024;
+    PreloadBatchSize = FMath::Max(PreloadBatchSize, 1);
+}
+
+FPicoAssetFileMounter::~FPicoAssetFileMounter()
+{
+    // Do not let a mount finish behind the back of a subsystem that is shutting down.
+    for (const TSharedRef<FJob>& Job : Jobs)
+    {
+        if (Job->WorkerTask.IsValid())
+        {
+            Job->WorkerTask.Wait();
+        }
+    }
+}
+
+void FPicoAssetFileMounter::Mount(const FPicoAssetMountRequest& Request, FPicoAssetMountComplete OnComplete)
+{
+    TSharedRef<FJob> Job = MakeShared<FJob>();
+    Job->Request = Request;
+    Job->OnComplete = OnComplete;
+    Job->Result.Filepath = Request.Filepath;
+    Job->StartTime = FPlatformTime::Seconds();
+
+    // The job is shared with the worker, which only touches Result until the future is ready.
+    const FSettings WorkerSettings = Settings;
+    Job->WorkerTask = Async(EAsyncExecution::ThreadPool, [Job, WorkerSettings]()
+        {
+            Verify(Job->Request, WorkerSettings, Job->Result);
+        });
+    Jobs.Add(Job);
+}
+
+FPicoAssetMountResult FPicoAssetFileMounter::MountSynchronously(const FPicoAssetMountRequest& Request)
+{
+    const double StartTime = FPlatformTime::Seconds();
+    FPicoAssetMountResult Result;
+    Result.Filepath = Request.Filepath;
+    Verify(Request, Settings, Result);
+    if (Result.bSuccess)
+    {
+        MountPak(Request, Result);
+    }
+
+    if (Result.bSuccess && Request.PrimaryAssets.Num() > 0)
+    {
+        const double PreloadStart = FPlatformTime::Seconds();
+        TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestSyncLoad(Request.PrimaryAssets, false, TEXT("PicoAssetMount"));
+        Result.PreloadHandles.Add(Handle);
+        Result.PreloadSeconds = FPlatformTime::Seconds() - PreloadStart;
+    }
+
+    Result.TotalSeconds = FPlatformTime::Seconds() - StartTime;
+    Result.GameThreadSeconds = Result.TotalSeconds;
+    Result.MaxGameThreadSliceSeconds = Result.TotalSeconds;
+    Result.MaxFrameSeconds = Result.TotalSeconds;
+    return Result;
+}
+
+void FPicoAssetFileMounter::Verify(const FPicoAssetMountRequest& Request, const FSettings& Settings, FPicoAssetMountResult& Result)
+{
+    // Downloaded files live outside the mounted paks, so skip the pak layer.
+    IPlatformFile& PhysicalFile = IPlatformFile::GetPlatformPhysical();
+
+    const double VerifyStart = FPlatformTime::Seconds();
+    Result.FileSize = PhysicalFile.FileSize(*Request.Filepath);
+    if (Result.FileSize < 0)
+    {
+        Result.ErrorMessage = TEXT("File not found");
+        return;
+    }
+
+    if (!Request.ExpectedSha1.IsEmpty())
+    {
+        FString Hash;
+        if (!HashFile(Request.Filepath, Settings, Result, Hash))
+        {
+            return;
+        }
+        if (!Hash.Equals(Request.ExpectedSha1, ESearchCase::IgnoreCase))
+        {
+            Result.ErrorMessage = FString::Printf(TEXT("SHA-1 mismatch, expected %s, got %s"), *Request.ExpectedSha1, *Hash);
+            return;
+        }
+    }
+    Result.VerifySeconds = FPlatformTime::Seconds() - VerifyStart;
+    Result.bSuccess = true;
+}
+
+void FPicoAssetFileMounter::MountPak(const FPicoAssetMountRequest& Request, FPicoAssetMountResult& Result)
+{
+    check(IsInGameThread());
+    Result.bSuccess = false;
+
+    const double MountStart = FPlatformTime::Seconds();
+    if (!FCoreDelegates::MountPak.IsBound())
+    {
+        Result.ErrorMessage = TEXT("Pak file support is not enabled");
+        return;
+    }
+    if (!FCoreDelegates::MountPak.Execute(Request.Filepath, Request.PakOrder))
+    {
+        Result.ErrorMessage = TEXT("Mounting the pak file failed");
+        return;
+    }
+    Result.MountSeconds = FPlatformTime::Seconds() - MountStart;
+    Result.bSuccess = true;
+}
+
+bool FPicoAssetFileMounter::HashFile(const FString& Filepath, const FSettings& Settings, FPicoAssetMountResult& Result, FString& OutHash)
+{
+    IPlatformFile& PhysicalFile = IPlatformFile::GetPlatformPhysical();
+    FSHA1 Sha;
+
+    // Large files are mapped so the hash reads straight from the page cache instead of copying through a buffer.
+    if (Result.FileSize >= Settings.MemoryMapThreshold)
+    {
+        TUniquePtr<IMappedFileHandle> MappedFile(PhysicalFile.OpenMapped(*Filepath));
+        TUniquePtr<IMappedFileRegion> Region(MappedFile ? MappedFile->MapRegion(0, Result.FileSize) : nullptr);
+        if (Region)
+        {
+            Sha.Update(Region->GetMappedPtr(), Region->GetMappedSize());
+            Result.bMemoryMapped = true;
+        }
+    }
+
+    if (!Result.bMemoryMapped)
+    {
+        TUniquePtr<IFileHandle> File(PhysicalFile.OpenRead(*Filepath));
+        if (!File)
+        {
+            Result.ErrorMessage = TEXT("Opening the file failed");
+            return false;
+        }
+
+        TArray<uint8> Buffer;
+        Buffer.SetNumUninitialized(int32(FMath::Min<int64>(Settings.HashChunkSize, FMath::Max<int64>(Result.FileSize, 1))));
+        for (int64 Remaining = Result.FileSize; Remaining > 0;)
+        {
+            const int32 ChunkSize = int32(FMath::Min<int64>(Remaining, Buffer.Num()));
+            if (!File->Read(Buffer.GetData(), ChunkSize))
+            {
+                Result.ErrorMessage = TEXT("Reading the file failed");
+                return false;
+            }
+            Sha.Update(Buffer.GetData(), ChunkSize);
+            Remaining -= ChunkSize;
+        }
+    }
+
+    Sha.Final();
+    FSHAHash Hash;
+    Sha.GetHash(Hash.Hash);
+    OutHash = Hash.ToString();
+    return true;
+}
+
+void FPicoAssetFileMounter::Tick(float DeltaTime)
+{
+    if (Jobs.Num() == 0)
+    {
+        return;
+    }
+
+    // Completion callbacks may start new mounts, so they run after the list is updated.
+    TArray<TSharedRef<FJob>, TInlineAllocator<4>> Finished;
+    for (int32 Index = 0; Index < Jobs.Num(); ++Index)
+    {
+        if (TickJob(*Jobs[Index], DeltaTime))
+        {
+            Finished.Add(Jobs[Index]);
+            Jobs.RemoveAt(Index--);
+        }
+    }
+
+    for (const TSharedRef<FJob>& Job : Finished)
+    {
+        UE_LOG(PicoAssetFile, Log, TEXT("%s"), *Job->Result.ToString());
+        Job->OnComplete.ExecuteIfBound(Job->Result);
+    }
+}
+
+bool FPicoAssetFileMounter::TickJob(FJob& Job, float DeltaTime)
+{
+    const double SliceStart = FPlatformTime::Seconds();
+    bool bFinished = false;
+    FPicoAssetMountResult& Result = Job.Result;
+    Result.MaxFrameSeconds = FMath::Max(Result.MaxFrameSeconds, double(DeltaTime));
+
+    if (Job.Stage == EStage::Worker)
+    {
+        if (!Job.WorkerTask.IsReady())
+        {
+            return false;
+        }
+        Job.WorkerTask.Reset();
+        if (Result.bSuccess)
+        {
+            MountPak(Job.Request, Result);
+        }
+        bFinished = !Result.bSuccess;
+        Job.Stage = EStage::Preload;
+        Job.PreloadStartTime = SliceStart;
+    }
+
+    if (!bFinished && Job.Stage == EStage::Preload)
+    {
+        // One batch at a time, so the engine never has more than a slice of post load work queued for us.
+        const TSharedPtr<FStreamableHandle> Pending = Result.PreloadHandles.Num() > 0 ? Result.PreloadHandles.Last() : nullptr;
+        if (!Pending.IsValid() || Pending->HasLoadCompleted() || Pending->WasCanceled())
+        {
+            if (Job.NextPreload >= Job.Request.PrimaryAssets.Num())
+            {
+                FinishPreload(Job);
+                bFinished = true;
+            }
+            else
+            {
+                const int32 Count = FMath::Min(PreloadBatchSize, Job.Request.PrimaryAssets.Num() - Job.NextPreload);
+                TArray<FSoftObjectPath> Batch(Job.Request.PrimaryAssets.GetData() + Job.NextPreload, Count);
+                Job.NextPreload += Count;
+                Result.PreloadHandles.Add(StreamableManager.RequestAsyncLoad(MoveTemp(Batch), FStreamableDelegate(),
+                    FStreamableManager::DefaultAsyncLoadPriority, false, false, TEXT("PicoAssetMount")));
+            }
+        }
+    }
+
+    const double Slice = FPlatformTime::Seconds() - SliceStart;
+    Result.GameThreadSeconds += Slice;
+    Result.MaxGameThreadSliceSeconds = FMath::Max(Result.MaxGameThreadSliceSeconds, Slice);
+    if (bFinished)
+    {
+        Result.TotalSeconds = FPlatformTime::Seconds() - Job.StartTime;
+    }
+    return bFinished;
+}
+
+void FPicoAssetFileMounter::FinishPreload(FJob& Job)
+{
+    FPicoAssetMountResult& Result = Job.Result;
+    Result.PreloadSeconds = FPlatformTime::Seconds() - Job.PreloadStartTime;
+
+    int32 NumLoaded = 0;
+    for (const TSharedPtr<FStreamableHandle>& Handle : Result.PreloadHandles)
+    {
+        if (Handle.IsValid())
+        {
+            TArray<UObject*> Loaded;
+            Handle->GetLoadedAssets(Loaded);
+            NumLoaded += Loaded.Num();
+        }
+    }
+    if (NumLoaded < Job.Request.PrimaryAssets.Num())
+    {
+        Result.bSuccess = false;
+        Result.ErrorMessage = FString::Printf(TEXT("%d of %d primary assets failed to load"), Job.Request.PrimaryAssets.Num() - NumLoaded, Job.Request.PrimaryAssets.Num());
+    }
+}
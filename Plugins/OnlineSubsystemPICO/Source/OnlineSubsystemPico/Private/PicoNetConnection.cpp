@@ -3,6 +3,8 @@
 #include "PicoNetConnection.h"
 #include "OnlineSubsystemPicoPrivate.h"
 #include "IPAddressPico.h"
+#include "PicoNetDriver.h"
+#include "PicoNetTransport.h"
 #include "Net/DataChannel.h"
 #include "PacketHandler.h"
 
@@ -131,7 +133,11 @@ void UPicoNetConnection::LowLevelSend(void* Data, int32 CountBits, FOutPacketTra
     if (!bBlockSend && CountBytes > 0)
     {
         UE_LOG(LogNetTraffic, VeryVerbose, TEXT("Low level send to: %llu Count: %d, UserID: %s"), PeerID, CountBytes, *UserID);
-        ppf_Net_SendPacket(TCHAR_TO_UTF8(*UserID), static_cast<size_t>(CountBytes), DataToSend);
+        UPicoNetDriver* PicoDriver = Cast<UPicoNetDriver>(Driver);
+        if (PicoDriver && PicoDriver->GetTransport().IsValid())
+        {
+            PicoDriver->GetTransport()->Send(UserID, DataToSend, CountBytes);
+        }
     }
 }
 
@@ -4,6 +4,7 @@
 #include "OnlineSubsystemPicoPrivate.h"
 #include "OnlineSessionInterfacePico.h"
 #include "IPAddressPico.h"
+#include "PicoNetTransport.h"
 #include "PicoNetConnection.h"
 #include "PacketHandlers/StatelessConnectHandlerComponent.h"
 #include "Engine/NetworkDelegates.h"
@@ -101,6 +102,11 @@ bool UPicoNetDriver::InitConnect(FNetworkNotify* InNotify, const FURL& ConnectUR
         return UIpNetDriver::InitConnect(InNotify, ConnectURL, Error);
     }
 
+    if (!Transport.IsValid())
+    {
+        Transport = IPicoNetTransport::CreateForUrl(ConnectURL);
+    }
+
     if (!InitBase(true, InNotify, ConnectURL, false, Error))
     {
         return false;
@@ -130,6 +136,11 @@ bool UPicoNetDriver::InitListen(FNetworkNotify* InNotify, FURL& LocalURL, bool b
         return Super::InitListen(InNotify, LocalURL, bReuseAddressAndPort, Error);
     }
 
+    if (!Transport.IsValid())
+    {
+        Transport = IPicoNetTransport::CreateForUrl(LocalURL);
+    }
+
     if (!InitBase(false, InNotify, LocalURL, bReuseAddressAndPort, Error))
     {
         return false;
@@ -152,21 +163,21 @@ void UPicoNetDriver::TickDispatch(float DeltaTime)
 
     UNetDriver::TickDispatch(DeltaTime);
 
-    // Process all incoming packets.
-    for (;;)
+    if (!Transport.IsValid())
     {
-        auto Packet = ppf_Net_ReadPacket();
-        if (!Packet)
-        {
-            break;
-        }
+        return;
+    }
 
+    // Process all incoming packets.
+    Transport->ReadPackets([this](const FString& SenderIDStr, uint8* Data, int32 PacketSize)
+    {
         bool bIgnorePacket = false;
 
-        auto SenderID = ppf_Packet_GetSenderID(Packet);
-        FString SenderIDStr = UTF8_TO_TCHAR(SenderID);
-        auto PacketSize = static_cast<int32>(ppf_Packet_GetSize(Packet));
-        auto Data = (uint8*)ppf_Packet_GetBytes(Packet);
+        // A peer we know nothing about yet is a client starting the stateless handshake
+        if (IsServer() && !Connections.Contains(SenderIDStr) && !PendingClientConnections.Contains(SenderIDStr))
+        {
+            AddNewClientConnection(SenderIDStr);
+        }
 
         // The server must check the pending client connections first to see if any clients are challenging the server
         // This logic is basically the same as the one in IpNetDriver
@@ -180,7 +191,7 @@ void UPicoNetDriver::TickDispatch(float DeltaTime)
                 UE_LOG(LogNet, Log,
                     TEXT("Invalid ConnectionlessHandler (%i) or StatelessConnectComponent (%i); can't accept connections."),
                     (int32)(ConnectionlessHandler.IsValid()), (int32)(StatelessConnectComponent.IsValid()));
-                continue;
+                return;
             }
 
             UE_LOG(LogNet, Verbose, TEXT("Checking challenge from: %s"), *SenderIDStr);
@@ -267,8 +278,7 @@ void UPicoNetDriver::TickDispatch(float DeltaTime)
         {
             UE_LOG(LogNet, Warning, TEXT("There is no connection to: %s"), *SenderIDStr);
         }
-        ppf_Packet_Free(Packet);
-    }
+    });
 }
 
 void UPicoNetDriver::LowLevelSend(TSharedPtr<const FInternetAddr> Address, void* Data, int32 CountBits, FOutPacketTraits& Traits)
@@ -286,18 +296,11 @@ void UPicoNetDriver::LowLevelSend(TSharedPtr<const FInternetAddr> Address, void*
     FInternetAddrPico PicoAddr(FURL(nullptr, *Address->ToString(false), ETravelType::TRAVEL_Absolute));
 #endif
 
-    ppfID PeerID = PicoAddr.GetID();
     FString UserID = PicoAddr.GetStrID();
-    if (IOnlineSubsystem* Subsystem = IOnlineSubsystem::Get())
+    if (Transport.IsValid())
     {
-        auto PicoSubsystem = static_cast<FOnlineSubsystemPico*>(Subsystem);
-        if (PicoSubsystem && PicoSubsystem->Init() && PicoSubsystem->GetGameSessionInterface())
+        if (Transport->IsReady())
         {
-            auto SessionInterface = PicoSubsystem->GetGameSessionInterface();
-            if (!SessionInterface->IsInitSuccess())
-            {
-                return;
-            }
             const uint8* DataToSend = reinterpret_cast<uint8*>(Data);
 
             if (ConnectionlessHandler.IsValid())
@@ -320,7 +323,7 @@ void UPicoNetDriver::LowLevelSend(TSharedPtr<const FInternetAddr> Address, void*
 
             if (CountBits > 0)
             {
-                ppf_Net_SendPacket(TCHAR_TO_UTF8(*UserID), static_cast<size_t>(CountBytes), DataToSend);
+                Transport->Send(UserID, DataToSend, CountBytes);
             }
         }
         else
@@ -358,6 +361,7 @@ void UPicoNetDriver::Shutdown()
         return;
     }
     UNetDriver::Shutdown();
+    Transport.Reset();
     UE_LOG(LogNet, Verbose, TEXT("Pico Net Driver shutdown"));
 }
 
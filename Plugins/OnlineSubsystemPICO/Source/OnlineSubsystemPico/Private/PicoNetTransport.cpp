@@ -0,0 +1,534 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoNetTransport.h"
+#include "OnlineSubsystemPico.h"
+#include "OnlineSubsystemPicoPrivate.h"
+#include "OnlineSessionInterfacePico.h"
+#include "PicoNetDriver.h"
+#include "PicoNetConnection.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Engine/NetworkDelegates.h"
+#include "Net/DataChannel.h"
+#include "PacketHandler.h"
+#include "UObject/Package.h"
+
+namespace
+{
+    class FPicoPlatformNetTransport : public IPicoNetTransport
+    {
+    public:
+        virtual bool IsReady() const override
+        {
+            FOnlineSubsystemPico* PicoSubsystem = static_cast<FOnlineSubsystemPico*>(IOnlineSubsystem::Get());
+            return PicoSubsystem && PicoSubsystem->Init() && PicoSubsystem->GetGameSessionInterface() && PicoSubsystem->GetGameSessionInterface()->IsInitSuccess();
+        }
+
+        virtual bool Send(const FString& PeerId, const uint8* Data, int32 Size) override
+        {
+            return ppf_Net_SendPacket(TCHAR_TO_UTF8(*PeerId), static_cast<size_t>(Size), Data);
+        }
+
+        virtual void ReadPackets(TFunctionRef<void(const FString&, uint8*, int32)> Visitor) override
+        {
+            for (;;)
+            {
+                auto Packet = ppf_Net_ReadPacket();
+                if (!Packet)
+                {
+                    break;
+                }
+                Visitor(UTF8_TO_TCHAR(ppf_Packet_GetSenderID(Packet)), (uint8*)ppf_Packet_GetBytes(Packet), static_cast<int32>(ppf_Packet_GetSize(Packet)));
+                ppf_Packet_Free(Packet);
+            }
+        }
+    };
+
+    struct FEarlierDelivery
+    {
+        template <typename PacketType>
+        bool operator()(const PacketType& A, const PacketType& B) const
+        {
+            return A.DeliveryTime < B.DeliveryTime;
+        }
+    };
+}
+
+/** An endpoint of a FPicoLoopbackNetwork. */
+class FPicoLoopbackTransport : public IPicoNetTransport
+{
+public:
+    FPicoLoopbackTransport(TSharedRef<FPicoLoopbackNetwork> InNetwork, const FString& InLocalId) :
+        Network(InNetwork),
+        LocalId(InLocalId)
+    {
+    }
+
+    virtual ~FPicoLoopbackTransport()
+    {
+        Network->RemoveEndpoint(LocalId);
+    }
+
+    virtual bool IsReady() const override
+    {
+        return true;
+    }
+
+    virtual bool Send(const FString& PeerId, const uint8* Data, int32 Size) override
+    {
+        return Network->Send(LocalId, PeerId, Data, Size);
+    }
+
+    virtual void ReadPackets(TFunctionRef<void(const FString&, uint8*, int32)> Visitor) override
+    {
+        // Delivered outside the lock, the driver answers from within the visitor.
+        Network->Receive(LocalId, Received);
+        for (FPicoLoopbackNetwork::FPacket& Packet : Received)
+        {
+            Visitor(Packet.SenderId, Packet.Data.GetData(), Packet.Data.Num());
+        }
+        Received.Reset();
+    }
+
+    virtual FString GetLocalId() const override
+    {
+        return LocalId;
+    }
+
+private:
+    TSharedRef<FPicoLoopbackNetwork> Network;
+    FString LocalId;
+    TArray<FPicoLoopbackNetwork::FPacket> Received;
+};
+
+TSharedRef<IPicoNetTransport> IPicoNetTransport::CreateForUrl(const FURL& URL)
+{
+    bool bUseLoopback = false;
+    GConfig->GetBool(TEXT("OnlineSubsystemPico"), TEXT("bUsePicoLoopbackNetwork"), bUseLoopback, GEngineIni);
+    if (!bUseLoopback && !URL.HasOption(TEXT("PicoLoopback")))
+    {
+        return MakeShared<FPicoPlatformNetTransport>();
+    }
+    TSharedRef<IPicoNetTransport> Endpoint = FPicoLoopbackNetwork::Get()->CreateEndpoint(URL.GetOption(TEXT("PicoLoopback="), TEXT("")));
+    UE_LOG(LogNet, Log, TEXT("Using the loopback network as %s.pico"), *Endpoint->GetLocalId());
+    return Endpoint;
+}
+
+FPicoLoopbackNetwork::FPicoLoopbackNetwork() :
+    Random(0x100B)
+{
+}
+
+TSharedRef<FPicoLoopbackNetwork> FPicoLoopbackNetwork::Get()
+{
+    static TSharedRef<FPicoLoopbackNetwork> Network = []()
+    {
+        TSharedRef<FPicoLoopbackNetwork> Result = MakeShared<FPicoLoopbackNetwork>();
+        FPicoLoopbackLinkSettings LinkSettings;
+        int32 LatencyMs = 0;
+        int32 JitterMs = 0;
+        GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("LoopbackLatencyMs"), LatencyMs, GEngineIni);
+        GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("LoopbackJitterMs"), JitterMs, GEngineIni);
+        GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("LoopbackLossRate"), LinkSettings.LossRate, GEngineIni);
+        GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("LoopbackBytesPerSecond"), LinkSettings.BytesPerSecond, GEngineIni);
+        LinkSettings.LatencySeconds = LatencyMs / 1000.0f;
+        LinkSettings.JitterSeconds = JitterMs / 1000.0f;
+        Result->SetLinkSettings(LinkSettings);
+        return Result;
+    }();
+    return Network;
+}
+
+TSharedRef<IPicoNetTransport> FPicoLoopbackNetwork::CreateEndpoint(const FString& RequestedId)
+{
+    FScopeLock ScopeLock(&Lock);
+    FString Id = RequestedId;
+    if (Id.IsEmpty() || Endpoints.Contains(Id))
+    {
+        if (!Id.IsEmpty())
+        {
+            UE_LOG(LogNet, Warning, TEXT("Loopback endpoint %s is taken, picking another ID"), *Id);
+        }
+        do
+        {
+            Id = LexToString(NextId++);
+        } while (Endpoints.Contains(Id));
+    }
+    Endpoints.Add(Id);
+    return MakeShared<FPicoLoopbackTransport>(AsShared(), Id);
+}
+
+void FPicoLoopbackNetwork::RemoveEndpoint(const FString& Id)
+{
+    FScopeLock ScopeLock(&Lock);
+    Endpoints.Remove(Id);
+}
+
+void FPicoLoopbackNetwork::SetLinkSettings(const FPicoLoopbackLinkSettings& InSettings)
+{
+    FScopeLock ScopeLock(&Lock);
+    Settings = InSettings;
+    Settings.LossRate = FMath::Clamp(Settings.LossRate, 0.0f, 1.0f);
+    Settings.LatencySeconds = FMath::Max(Settings.LatencySeconds, 0.0f);
+    Settings.JitterSeconds = FMath::Max(Settings.JitterSeconds, 0.0f);
+    Settings.BytesPerSecond = FMath::Max(Settings.BytesPerSecond, 0);
+}
+
+FPicoLoopbackLinkSettings FPicoLoopbackNetwork::GetLinkSettings() const
+{
+    FScopeLock ScopeLock(&Lock);
+    return Settings;
+}
+
+void FPicoLoopbackNetwork::UseSimulatedClock(bool bInUseSimulatedClock)
+{
+    FScopeLock ScopeLock(&Lock);
+    bUseSimulatedClock = bInUseSimulatedClock;
+}
+
+void FPicoLoopbackNetwork::AdvanceClock(double DeltaSeconds)
+{
+    FScopeLock ScopeLock(&Lock);
+    SimulatedTime += DeltaSeconds;
+}
+
+double FPicoLoopbackNetwork::GetTime() const
+{
+    return bUseSimulatedClock ? SimulatedTime : FPlatformTime::Seconds();
+}
+
+bool FPicoLoopbackNetwork::Send(const FString& SenderId, const FString& PeerId, const uint8* Data, int32 Size)
+{
+    FScopeLock ScopeLock(&Lock);
+    FEndpoint* Sender = Endpoints.Find(SenderId);
+    FEndpoint* Peer = Endpoints.Find(PeerId);
+    if (Sender == nullptr)
+    {
+        return false;
+    }
+    Sender->Stats.PacketsSent++;
+    Sender->Stats.BytesSent += Size;
+    if (Peer == nullptr)
+    {
+        Sender->Stats.PacketsDropped++;
+        return false;
+    }
+
+    // Like the relay, the sender cannot tell a lost packet from a delivered one.
+    if (Settings.LossRate > 0.0f && Random.FRand() < Settings.LossRate)
+    {
+        Sender->Stats.PacketsLost++;
+        return true;
+    }
+
+    const double Now = GetTime();
+    double DepartureTime = Now;
+    if (Settings.BytesPerSecond > 0)
+    {
+        const double TransmitSeconds = double(Size) / Settings.BytesPerSecond;
+        const double QueuedUntil = FMath::Max(Sender->UplinkFreeTime, Now) + TransmitSeconds;
+        if (QueuedUntil - Now > Settings.MaxQueueSeconds)
+        {
+            Sender->Stats.PacketsDropped++;
+            return true;
+        }
+        Sender->UplinkFreeTime = QueuedUntil;
+        DepartureTime = QueuedUntil;
+    }
+
+    FPacket Packet;
+    Packet.DeliveryTime = DepartureTime + Settings.LatencySeconds + (Settings.JitterSeconds > 0.0f ? Random.FRandRange(0.0f, Settings.JitterSeconds) : 0.0f);
+    Packet.SenderId = SenderId;
+    Packet.Data.Append(Data, Size);
+    Peer->Incoming.HeapPush(MoveTemp(Packet), FEarlierDelivery());
+    return true;
+}
+
+void FPicoLoopbackNetwork::Receive(const FString& Id, TArray<FPacket>& OutPackets)
+{
+    FScopeLock ScopeLock(&Lock);
+    FEndpoint* Endpoint = Endpoints.Find(Id);
+    if (Endpoint == nullptr)
+    {
+        return;
+    }
+    const double Now = GetTime();
+    while (Endpoint->Incoming.Num() > 0 && Endpoint->Incoming.HeapTop().DeliveryTime <= Now)
+    {
+        FPacket& Packet = OutPackets.Emplace_GetRef();
+        Endpoint->Incoming.HeapPop(Packet, FEarlierDelivery(), false);
+        Endpoint->Stats.PacketsReceived++;
+        Endpoint->Stats.BytesReceived += Packet.Data.Num();
+    }
+}
+
+TMap<FString, FPicoLoopbackEndpointStats> FPicoLoopbackNetwork::GetStats() const
+{
+    FScopeLock ScopeLock(&Lock);
+    TMap<FString, FPicoLoopbackEndpointStats> Result;
+    for (const TPair<FString, FEndpoint>& Pair : Endpoints)
+    {
+        Result.Add(Pair.Key, Pair.Value.Stats);
+    }
+    return Result;
+}
+
+void FPicoLoopbackNetwork::ResetStats()
+{
+    FScopeLock ScopeLock(&Lock);
+    for (TPair<FString, FEndpoint>& Pair : Endpoints)
+    {
+        Pair.Value.Stats = FPicoLoopbackEndpointStats();
+    }
+}
+
+void FPicoLoopbackNetwork::Dump(FOutputDevice& Ar) const
+{
+    const FPicoLoopbackLinkSettings LinkSettings = GetLinkSettings();
+    const TMap<FString, FPicoLoopbackEndpointStats> Stats = GetStats();
+    Ar.Logf(TEXT("Pico loopback network: %d endpoints, latency %.0f ms, jitter %.0f ms, loss %.1f%%, uplink cap %d bytes/s"),
+        Stats.Num(), LinkSettings.LatencySeconds * 1000.0f, LinkSettings.JitterSeconds * 1000.0f, LinkSettings.LossRate * 100.0f, LinkSettings.BytesPerSecond);
+    for (const TPair<FString, FPicoLoopbackEndpointStats>& Pair : Stats)
+    {
+        const FPicoLoopbackEndpointStats& Entry = Pair.Value;
+        Ar.Logf(TEXT("  %s.pico: sent %lld packets / %lld bytes, received %lld packets / %lld bytes, lost %lld, dropped %lld"),
+            *Pair.Key, Entry.PacketsSent, Entry.BytesSent, Entry.PacketsReceived, Entry.BytesReceived, Entry.PacketsLost, Entry.PacketsDropped);
+    }
+}
+
+namespace
+{
+    /** Accepts everything and hands NMT_DebugText messages, which carry the load test traffic, to OnMessage. */
+    class FPicoLoadTestNotify : public FNetworkNotify
+    {
+    public:
+        TFunction<void(UNetConnection*, const FString&)> OnMessage;
+
+        virtual EAcceptConnection::Type NotifyAcceptingConnection() override
+        {
+            return EAcceptConnection::Accept;
+        }
+
+        virtual void NotifyAcceptedConnection(UNetConnection* Connection) override
+        {
+            // Skip the login, there is no world to join
+            Connection->SetClientLoginState(EClientLoginState::Welcomed);
+        }
+
+        virtual bool NotifyAcceptingChannel(UChannel* Channel) override
+        {
+            return true;
+        }
+
+        virtual void NotifyControlMessage(UNetConnection* Connection, uint8 MessageType, FInBunch& Bunch) override
+        {
+            FString Text;
+            if (MessageType == NMT_DebugText && FNetControlMessage<NMT_DebugText>::Receive(Bunch, Text) && OnMessage)
+            {
+                OnMessage(Connection, Text);
+            }
+        }
+    };
+
+    struct FPicoLoadTestClient
+    {
+        UPicoNetDriver* Driver = nullptr;
+        FString Id;
+        bool bReady = false;
+        int64 MessagesReceived = 0;
+    };
+
+    UPicoNetDriver* CreateLoadTestDriver(const TSharedRef<FPicoLoopbackNetwork>& Network, const FString& RequestedId)
+    {
+        UPicoNetDriver* Driver = NewObject<UPicoNetDriver>(GetTransientPackage());
+        Driver->AddToRoot();
+        Driver->NetConnectionClassName = TEXT("/Script/OnlineSubsystemPico.PicoNetConnection");
+        Driver->bSkipServerReplicateActors = true;
+        Driver->SetTransport(Network->CreateEndpoint(RequestedId));
+        return Driver;
+    }
+
+    void DestroyLoadTestDriver(UPicoNetDriver* Driver)
+    {
+        Driver->Shutdown();
+        Driver->RemoveFromRoot();
+        Driver->MarkAsGarbage();
+    }
+
+    void TickLoadTestDriver(UPicoNetDriver* Driver, float DeltaTime, TFunctionRef<void()> Send)
+    {
+        Driver->TickDispatch(DeltaTime);
+        Driver->PostTickDispatch();
+        Send();
+        Driver->TickFlush(DeltaTime);
+        Driver->PostTickFlush();
+    }
+}
+
+FString FPicoLoopbackNetwork::RunLoadTest(int32 MaxClients, float SecondsPerStep, const FPicoLoopbackLinkSettings& LinkSettings)
+{
+    const float TickSeconds = 1.0f / 60.0f;
+    const float SendSeconds = 1.0f / 30.0f;
+    const float MaxConnectSeconds = 10.0f;
+    const FString ServerId = TEXT("1000");
+    FString Input = FString::ChrN(64, TEXT('i'));
+    FString State = FString::ChrN(256, TEXT('s'));
+
+    MaxClients = FMath::Clamp(MaxClients, 1, 256);
+    SecondsPerStep = FMath::Max(SecondsPerStep, 1.0f);
+
+    FString Report = FString::Printf(TEXT("Pico net driver load test: %d ms latency, %d ms jitter, %.1f%% loss, uplink cap %d bytes/s, %.0f s per step\n"),
+        FMath::RoundToInt(LinkSettings.LatencySeconds * 1000.0f), FMath::RoundToInt(LinkSettings.JitterSeconds * 1000.0f),
+        LinkSettings.LossRate * 100.0f, LinkSettings.BytesPerSecond, SecondsPerStep);
+    Report += TEXT("clients connected | per client up KB/s  down KB/s  pkts/s  lost  dropped | server up KB/s  pkts/s | server tick avg / max ms\n");
+
+    for (int32 NumClients = 1; ; NumClients = FMath::Min(NumClients * 2, MaxClients))
+    {
+        // A private network on a simulated clock, so steps are independent and run faster than real time
+        TSharedRef<FPicoLoopbackNetwork> Network = MakeShared<FPicoLoopbackNetwork>();
+        Network->UseSimulatedClock(true);
+        Network->SetLinkSettings(LinkSettings);
+
+        FPicoLoadTestNotify ServerNotify;
+        ServerNotify.OnMessage = [](UNetConnection*, const FString&) {};
+        FString Error;
+        FURL ListenURL(nullptr, *FString::Printf(TEXT("%s.pico"), *ServerId), TRAVEL_Absolute);
+        UPicoNetDriver* Server = CreateLoadTestDriver(Network, ServerId);
+        if (!Server->InitListen(&ServerNotify, ListenURL, false, Error))
+        {
+            DestroyLoadTestDriver(Server);
+            return Report + FString::Printf(TEXT("The server failed to listen: %s\n"), *Error);
+        }
+
+        TArray<TSharedRef<FPicoLoadTestClient>> Clients;
+        FPicoLoadTestNotify ClientNotify;
+        for (int32 Index = 0; Index < NumClients; ++Index)
+        {
+            TSharedRef<FPicoLoadTestClient> Client = MakeShared<FPicoLoadTestClient>();
+            Client->Driver = CreateLoadTestDriver(Network, FString());
+            Client->Id = Client->Driver->GetTransport()->GetLocalId();
+            Clients.Add(Client);
+            if (!Client->Driver->InitConnect(&ClientNotify, FURL(nullptr, *FString::Printf(TEXT("%s.pico"), *ServerId), TRAVEL_Absolute), Error))
+            {
+                UE_LOG(LogNet, Warning, TEXT("Load test client %s failed to connect: %s"), *Client->Id, *Error);
+                continue;
+            }
+            UNetConnection* Connection = Client->Driver->ServerConnection;
+            if (Connection->Handler.IsValid())
+            {
+                Connection->Handler->BeginHandshaking(FPacketHandlerHandshakeComplete::CreateLambda([Client]() { Client->bReady = true; }));
+            }
+            else
+            {
+                Client->bReady = true;
+            }
+        }
+        ClientNotify.OnMessage = [&Clients](UNetConnection* Connection, const FString&)
+        {
+            for (const TSharedRef<FPicoLoadTestClient>& Client : Clients)
+            {
+                if (Client->Driver->ServerConnection == Connection)
+                {
+                    Client->MessagesReceived++;
+                    break;
+                }
+            }
+        };
+
+        double ServerTickSeconds = 0.0;
+        double MaxServerTickSeconds = 0.0;
+        int32 NumServerTicks = 0;
+        float SendAccumulator = 0.0f;
+        auto Tick = [&](bool bSendTraffic)
+        {
+            Network->AdvanceClock(TickSeconds);
+            SendAccumulator += TickSeconds;
+            const bool bSendNow = bSendTraffic && SendAccumulator >= SendSeconds;
+            if (bSendNow)
+            {
+                SendAccumulator -= SendSeconds;
+            }
+
+            for (const TSharedRef<FPicoLoadTestClient>& Client : Clients)
+            {
+                TickLoadTestDriver(Client->Driver, TickSeconds, [&]()
+                {
+                    if (bSendNow && Client->bReady && Client->Driver->ServerConnection)
+                    {
+                        FNetControlMessage<NMT_DebugText>::Send(Client->Driver->ServerConnection, Input);
+                    }
+                });
+            }
+
+            const double StartTime = FPlatformTime::Seconds();
+            TickLoadTestDriver(Server, TickSeconds, [&]()
+            {
+                if (bSendNow)
+                {
+                    for (UNetConnection* Connection : Server->ClientConnections)
+                    {
+                        FNetControlMessage<NMT_DebugText>::Send(Connection, State);
+                    }
+                }
+            });
+            const double Elapsed = FPlatformTime::Seconds() - StartTime;
+            if (bSendTraffic)
+            {
+                ServerTickSeconds += Elapsed;
+                MaxServerTickSeconds = FMath::Max(MaxServerTickSeconds, Elapsed);
+                NumServerTicks++;
+            }
+        };
+
+        // Handshake everybody, then measure
+        for (float Time = 0.0f; Time < MaxConnectSeconds; Time += TickSeconds)
+        {
+            if (Server->ClientConnections.Num() == NumClients && Clients.FilterByPredicate([](const TSharedRef<FPicoLoadTestClient>& Client) { return Client->bReady; }).Num() == NumClients)
+            {
+                break;
+            }
+            Tick(false);
+        }
+        const int32 NumConnected = Server->ClientConnections.Num();
+        Network->ResetStats();
+        for (float Time = 0.0f; Time < SecondsPerStep; Time += TickSeconds)
+        {
+            Tick(true);
+        }
+
+        const TMap<FString, FPicoLoopbackEndpointStats> Stats = Network->GetStats();
+        FPicoLoopbackEndpointStats ClientTotal;
+        for (const TSharedRef<FPicoLoadTestClient>& Client : Clients)
+        {
+            if (const FPicoLoopbackEndpointStats* Entry = Stats.Find(Client->Id))
+            {
+                ClientTotal.BytesSent += Entry->BytesSent;
+                ClientTotal.BytesReceived += Entry->BytesReceived;
+                ClientTotal.PacketsSent += Entry->PacketsSent;
+                ClientTotal.PacketsReceived += Entry->PacketsReceived;
+                ClientTotal.PacketsLost += Entry->PacketsLost;
+                ClientTotal.PacketsDropped += Entry->PacketsDropped;
+            }
+        }
+        const FPicoLoopbackEndpointStats ServerStats = Stats.FindRef(ServerId);
+        const double PerClientSeconds = double(NumClients) * SecondsPerStep;
+        Report += FString::Printf(TEXT("%7d %9d | %17.2f %10.2f %7.1f %5lld %8lld | %14.2f %7.1f | %13.3f / %.3f\n"),
+            NumClients, NumConnected,
+            ClientTotal.BytesSent / 1024.0 / PerClientSeconds, ClientTotal.BytesReceived / 1024.0 / PerClientSeconds,
+            (ClientTotal.PacketsSent + ClientTotal.PacketsReceived) / PerClientSeconds, ClientTotal.PacketsLost, ClientTotal.PacketsDropped,
+            ServerStats.BytesSent / 1024.0 / SecondsPerStep, (ServerStats.PacketsSent + ServerStats.PacketsReceived) / SecondsPerStep,
+            NumServerTicks > 0 ? ServerTickSeconds * 1000.0 / NumServerTicks : 0.0, MaxServerTickSeconds * 1000.0);
+
+        for (const TSharedRef<FPicoLoadTestClient>& Client : Clients)
+        {
+            DestroyLoadTestDriver(Client->Driver);
+        }
+        DestroyLoadTestDriver(Server);
+
+        if (NumClients == MaxClients)
+        {
+            break;
+        }
+    }
+    return Report;
+}
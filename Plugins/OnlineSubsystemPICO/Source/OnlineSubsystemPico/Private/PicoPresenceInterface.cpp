@@ -4,13 +4,15 @@
 #include "PicoPresenceInterface.h"
 #include "OnlineSubsystemPicoPrivate.h"
 #include "OnlineFriendsInterfacePico.h"
+#include "PicoUserProfileCache.h"
 #include <vector>
 #include <string>
 
 DEFINE_LOG_CATEGORY(PresenceInterface);
 
 FPicoPresenceInterface::FPicoPresenceInterface(FOnlineSubsystemPico& InSubsystem) :
-    PicoSubsystem(InSubsystem)
+    PicoSubsystem(InSubsystem),
+    PresenceWriter(MakeShared<FPicoPresenceWriter>(FPicoPresenceWriter::CreatePlatformBackend(InSubsystem)))
 {
     OnJoinIntentReceivedHandle =
         PicoSubsystem.GetOrAddNotify(ppfMessageType_Notification_Presence_JoinIntentReceived)
@@ -33,9 +35,15 @@ FPicoPresenceInterface::~FPicoPresenceInterface()
     }
 }
 
+void FPicoPresenceInterface::Tick(float DeltaTime)
+{
+    PresenceWriter->Tick(DeltaTime);
+}
+
 bool FPicoPresenceInterface::PresenceClear(const FOnPresenceClearComplete& Delegate /*= FOnPresenceClearComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceClear"));
+    PresenceWriter->OnClearSent();
     PicoSubsystem.AddAsyncTask
     (
         ppf_Presence_Clear(),
@@ -64,6 +72,7 @@ void FPicoPresenceInterface::OnQueryPresenceClearComplete(ppfMessageHandle Messa
     }
     else
     {
+        PresenceWriter->OnCleared();
         Delegate.ExecuteIfBound(true, FString());
     }
 }
@@ -116,27 +125,11 @@ void FPicoPresenceInterface::OnQueryReadInvitableUserComplete(ppfMessageHandle M
 
     for (size_t FriendIndex = 0; FriendIndex < UserNum; ++FriendIndex)
     {
-        auto Friend = ppf_UserArray_GetElement(UserArray, FriendIndex);
-        FString FriendId = UTF8_TO_TCHAR(ppf_User_GetID(Friend));
-        FString FriendDisplayName = UTF8_TO_TCHAR(ppf_User_GetDisplayName(Friend));
-        auto FriendInviteToken = ppf_User_GetInviteToken(Friend);
-        FString FriendInviteTokenString(UTF8_TO_TCHAR((FriendInviteToken != nullptr) ? FriendInviteToken : ""));
-        FString SmallImageUrl = UTF8_TO_TCHAR(ppf_User_GetSmallImageUrl(Friend));
-        FString PresencePackage = UTF8_TO_TCHAR(ppf_User_GetPresencePackage(Friend));
-        FString ImageUrl = UTF8_TO_TCHAR(ppf_User_GetImageUrl(Friend));
-        ppfGender Gender = ppf_User_GetGender(Friend);
-        FString Presence = UTF8_TO_TCHAR(ppf_User_GetPresence(Friend));
-        FString PresenceDeeplinkMessage = UTF8_TO_TCHAR(ppf_User_GetPresenceDeeplinkMessage(Friend));
-        FString PresenceDestinationApiName = UTF8_TO_TCHAR(ppf_User_GetPresenceDestinationApiName(Friend));
-        FString PresenceLobbySessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceLobbySessionId(Friend));
-        FString PresenceMatchSessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceMatchSessionId(Friend));
-        auto FriendPresenceStatus = ppf_User_GetPresenceStatus(Friend);
-        FString PresenceExtra = ppf_User_GetPresenceExtra(Friend);
-        TSharedRef<FOnlinePicoFriend> OnlineFriend(new FOnlinePicoFriend(FriendId, FriendDisplayName, FriendPresenceStatus, FriendInviteTokenString,
-            ImageUrl, Gender, SmallImageUrl, PresencePackage, Presence, PresenceDeeplinkMessage, PresenceDestinationApiName, PresenceLobbySessionId,
-            PresenceMatchSessionId, PresenceExtra));
-
-        OutList.Add(FriendId, OnlineFriend);
+        TSharedPtr<FOnlinePicoFriend> OnlineFriend = PicoSubsystem.GetPicoUserProfileCache()->FindOrUpdate(ppf_UserArray_GetElement(UserArray, FriendIndex));
+        if (OnlineFriend.IsValid())
+        {
+            OutList.Add(OnlineFriend->GetUserStrId(), OnlineFriend.ToSharedRef());
+        }
     }
     bool bHasPaging = ppf_UserArray_HasNextPage(UserArray);
     if (bHasPaging)
@@ -169,222 +162,79 @@ bool FPicoPresenceInterface::GetInvitableFriendList(TArray<TSharedRef<FOnlinePic
 bool FPicoPresenceInterface::PresenceSet(const FString& ApiName, const FString& LobbySessionId, const FString& MatchSessionId, bool bIsJoinable, const FString& Extra, const FOnPresenceSetComplete& Delegate /*= FOnPresenceSetComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceSet"));
-    auto PresenceOptions = ppf_PresenceOptions_Create();
-    ppf_PresenceOptions_SetDestinationApiName(PresenceOptions, TCHAR_TO_UTF8(*ApiName));
-    ppf_PresenceOptions_SetLobbySessionId(PresenceOptions, TCHAR_TO_UTF8(*LobbySessionId));
-    ppf_PresenceOptions_SetMatchSessionId(PresenceOptions, TCHAR_TO_UTF8(*MatchSessionId));
-    ppf_PresenceOptions_SetExtra(PresenceOptions, TCHAR_TO_UTF8(*Extra));
-    ppf_PresenceOptions_SetIsJoinable(PresenceOptions, bIsJoinable);
-    PicoSubsystem.AddAsyncTask
-    (
-        ppf_Presence_Set(PresenceOptions),
-        FPicoMessageOnCompleteDelegate::CreateLambda
-        (
-            [this, Delegate](ppfMessageHandle Message, bool bIsError)
-            {
-                OnQueryPresenceSetComplete(Message, bIsError, Delegate);
-            }
-        )
-    );
-    ppf_PresenceOptions_Destroy(PresenceOptions);
+    FPicoPresenceState State;
+    State.DestinationApiName = ApiName;
+    State.LobbySessionId = LobbySessionId;
+    State.MatchSessionId = MatchSessionId;
+    State.Extra = Extra;
+    State.bIsJoinable = bIsJoinable;
+    PresenceWriter->Set(State, EPicoPresenceField::All, [Delegate](bool bSuccess, const FString& ErrorMessage)
+        {
+            Delegate.ExecuteIfBound(bSuccess, ErrorMessage);
+        });
     return true;
-
-}
-
-void FPicoPresenceInterface::OnQueryPresenceSetComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetComplete& Delegate)
-{
-    UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::OnQueryPresenceSetComplete"));
-    if (bIsError)
-    {
-        auto Error = ppf_Message_GetError(Message);
-        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-        Delegate.ExecuteIfBound(false, ErrorMessage);
-        return;
-    }
-    else
-    {
-        Delegate.ExecuteIfBound(true, FString());
-    }
 }
 
 bool FPicoPresenceInterface::PresenceSetDestination(const FString& ApiName, const FOnPresenceSetDestinationComplete& Delegate /*= FOnPresenceSetDestinationComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceSetDestination"));
-    PicoSubsystem.AddAsyncTask
-    (
-        ppf_Presence_SetDestination(TCHAR_TO_UTF8(*ApiName)),
-        FPicoMessageOnCompleteDelegate::CreateLambda
-        (
-            [this, Delegate](ppfMessageHandle Message, bool bIsError)
-            {
-                OnQueryPresenceSetDestinationComplete(Message, bIsError, Delegate);
-            }
-        )
-    );
+    FPicoPresenceState State;
+    State.DestinationApiName = ApiName;
+    PresenceWriter->Set(State, EPicoPresenceField::Destination, [Delegate](bool bSuccess, const FString& ErrorMessage)
+        {
+            Delegate.ExecuteIfBound(bSuccess, ErrorMessage);
+        });
     return true;
 }
 
-void FPicoPresenceInterface::OnQueryPresenceSetDestinationComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetDestinationComplete& Delegate)
-{
-    UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::OnQueryPresenceSetDestinationComplete"));
-    if (bIsError)
-    {
-        auto Error = ppf_Message_GetError(Message);
-        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-        Delegate.ExecuteIfBound(false, ErrorMessage);
-        return;
-    }
-    else
-    {
-        Delegate.ExecuteIfBound(true, FString());
-    }
-}
-
 bool FPicoPresenceInterface::PresenceSetSetIsJoinable(bool bIsJoinable, const FOnPresenceSetIsJoinableComplete& Delegate /*= FOnPresenceSetIsJoinableComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceSetSetIsJoinable"));
-    PicoSubsystem.AddAsyncTask
-    (
-        ppf_Presence_SetIsJoinable(bIsJoinable),
-        FPicoMessageOnCompleteDelegate::CreateLambda
-        (
-            [this, Delegate](ppfMessageHandle Message, bool bIsError)
-            {
-                OnQueryPresenceSetSetIsJoinableComplete(Message, bIsError, Delegate);
-            }
-        )
-    );
+    FPicoPresenceState State;
+    State.bIsJoinable = bIsJoinable;
+    PresenceWriter->Set(State, EPicoPresenceField::IsJoinable, [Delegate](bool bSuccess, const FString& ErrorMessage)
+        {
+            Delegate.ExecuteIfBound(bSuccess, ErrorMessage);
+        });
     return true;
 }
 
-void FPicoPresenceInterface::OnQueryPresenceSetSetIsJoinableComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetIsJoinableComplete& Delegate)
-{
-    UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::OnQueryPresenceSetSetIsJoinableComplete"));
-    if (bIsError)
-    {
-        auto Error = ppf_Message_GetError(Message);
-        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-        Delegate.ExecuteIfBound(false, ErrorMessage);
-        return;
-    }
-    else
-    {
-        Delegate.ExecuteIfBound(true, FString());
-    }
-}
-
 bool FPicoPresenceInterface::PresenceSetLobbySession(const FString& LobbySession, const FOnPresenceSetLobbySessionComplete& Delegate /*= FOnPresenceSetLobbySessionComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceSetLobbySession"));
-    PicoSubsystem.AddAsyncTask
-    (
-        ppf_Presence_SetLobbySession(TCHAR_TO_UTF8(*LobbySession)),
-        FPicoMessageOnCompleteDelegate::CreateLambda
-        (
-            [this, Delegate](ppfMessageHandle Message, bool bIsError)
-            {
-                OnQueryPresenceSetLobbySessionComplete(Message, bIsError, Delegate);
-            }
-        )
-    );
+    FPicoPresenceState State;
+    State.LobbySessionId = LobbySession;
+    PresenceWriter->Set(State, EPicoPresenceField::LobbySession, [Delegate](bool bSuccess, const FString& ErrorMessage)
+        {
+            Delegate.ExecuteIfBound(bSuccess, ErrorMessage);
+        });
     return true;
 }
 
-void FPicoPresenceInterface::OnQueryPresenceSetLobbySessionComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetLobbySessionComplete& Delegate)
-{
-    UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::OnQueryPresenceSetLobbySessionComplete"));
-    if (bIsError)
-    {
-        auto Error = ppf_Message_GetError(Message);
-        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-        Delegate.ExecuteIfBound(false, ErrorMessage);
-
-        return;
-    }
-    else
-    {
-        Delegate.ExecuteIfBound(true, FString());
-    }
-}
-
 bool FPicoPresenceInterface::PresenceSetMatchSession(const FString& MatchSession, const FOnPresenceSetMatchSessionComplete& Delegate /*= FOnPresenceSetMatchSessionComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceSetMatchSession"));
-    PicoSubsystem.AddAsyncTask
-    (
-        ppf_Presence_SetMatchSession(TCHAR_TO_UTF8(*MatchSession)),
-        FPicoMessageOnCompleteDelegate::CreateLambda
-        (
-            [this, Delegate](ppfMessageHandle Message, bool bIsError)
-            {
-                OnQueryPresenceSetMatchSessionComplete(Message, bIsError, Delegate);
-            }
-        )
-    );
+    FPicoPresenceState State;
+    State.MatchSessionId = MatchSession;
+    PresenceWriter->Set(State, EPicoPresenceField::MatchSession, [Delegate](bool bSuccess, const FString& ErrorMessage)
+        {
+            Delegate.ExecuteIfBound(bSuccess, ErrorMessage);
+        });
     return true;
 }
 
-void FPicoPresenceInterface::OnQueryPresenceSetMatchSessionComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetMatchSessionComplete& Delegate)
-{
-    UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::OnQueryPresenceSetMatchSessionComplete"));
-    if (bIsError)
-    {
-        auto Error = ppf_Message_GetError(Message);
-        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-        Delegate.ExecuteIfBound(false, ErrorMessage);
-        return;
-    }
-    else
-    {
-        Delegate.ExecuteIfBound(true, FString());
-    }
-}
-
 bool FPicoPresenceInterface::PresenceSetExtra(const FString& Extra, const FOnPresenceSetPresenceExtraComplete& Delegate /*= FOnPresenceSetPresenceExtraComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceSetExtra"));
-    PicoSubsystem.AddAsyncTask
-    (
-        ppf_Presence_SetExtra(TCHAR_TO_UTF8(*Extra)),
-        FPicoMessageOnCompleteDelegate::CreateLambda
-        (
-            [this, Delegate](ppfMessageHandle Message, bool bIsError)
-            {
-                OnQueryPresenceSetExtraComplete(Message, bIsError, Delegate);
-            }
-        )
-    );
+    FPicoPresenceState State;
+    State.Extra = Extra;
+    PresenceWriter->Set(State, EPicoPresenceField::Extra, [Delegate](bool bSuccess, const FString& ErrorMessage)
+        {
+            Delegate.ExecuteIfBound(bSuccess, ErrorMessage);
+        });
     return true;
 }
 
-void FPicoPresenceInterface::OnQueryPresenceSetExtraComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetPresenceExtraComplete& Delegate)
-{
-    UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::OnQueryPresenceSetExtraComplete"));
-    if (bIsError)
-    {
-        auto Error = ppf_Message_GetError(Message);
-        FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-        FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-        ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-        Delegate.ExecuteIfBound(false, ErrorMessage);
-        return;
-    }
-    else
-    {
-        Delegate.ExecuteIfBound(true, FString());
-    }
-}
-
 bool FPicoPresenceInterface::PresenceReadSendInvites(const FOnReadSentInvitesComplete& Delegate /*= FOnReadGetSentInvitesComplete()*/)
 {
     UE_LOG(PresenceInterface, Log, TEXT("FPicoPresenceInterface::PresenceReadSendInvites"));
@@ -437,24 +287,8 @@ void FPicoPresenceInterface::OnQueryPresenceReadSendInvitesComplete(ppfMessageHa
         FString LobbySessionId = UTF8_TO_TCHAR(ppf_ApplicationInvite_GetLobbySessionId(ApplicationInviteElement));
         FString MatchSessionId = UTF8_TO_TCHAR(ppf_ApplicationInvite_GetMatchSessionId(ApplicationInviteElement));
         auto ApplicationInviteElementUser = ppf_ApplicationInvite_GetRecipient(ApplicationInviteElement);
-        FString FriendId = UTF8_TO_TCHAR(ppf_User_GetID(ApplicationInviteElementUser));
-        FString FriendDisplayName = UTF8_TO_TCHAR(ppf_User_GetDisplayName(ApplicationInviteElementUser));
-        auto FriendInviteToken = ppf_User_GetInviteToken(ApplicationInviteElementUser);
-        FString FriendInviteTokenString(UTF8_TO_TCHAR((FriendInviteToken != nullptr) ? FriendInviteToken : ""));
-        FString SmallImageUrl = UTF8_TO_TCHAR(ppf_User_GetSmallImageUrl(ApplicationInviteElementUser));
-        FString PresencePackage = UTF8_TO_TCHAR(ppf_User_GetPresencePackage(ApplicationInviteElementUser));
-        FString ImageUrl = UTF8_TO_TCHAR(ppf_User_GetImageUrl(ApplicationInviteElementUser));
-        ppfGender Gender = ppf_User_GetGender(ApplicationInviteElementUser);
-        FString Presence = UTF8_TO_TCHAR(ppf_User_GetPresence(ApplicationInviteElementUser));
-        FString PresenceDeeplinkMessage = UTF8_TO_TCHAR(ppf_User_GetPresenceDeeplinkMessage(ApplicationInviteElementUser));
-        FString PresenceDestinationApiName = UTF8_TO_TCHAR(ppf_User_GetPresenceDestinationApiName(ApplicationInviteElementUser));
-        FString PresenceLobbySessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceLobbySessionId(ApplicationInviteElementUser));
-        FString PresenceMatchSessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceMatchSessionId(ApplicationInviteElementUser));
-        auto FriendPresenceStatus = ppf_User_GetPresenceStatus(ApplicationInviteElementUser);
-        FString PresenceExtra = ppf_User_GetPresenceExtra(ApplicationInviteElementUser);
-        TSharedRef<FOnlinePicoFriend> OnlineFriend(new FOnlinePicoFriend(FriendId, FriendDisplayName, FriendPresenceStatus, FriendInviteTokenString,
-            ImageUrl, Gender, SmallImageUrl, PresencePackage, Presence, PresenceDeeplinkMessage, PresenceDestinationApiName, PresenceLobbySessionId,
-            PresenceMatchSessionId, PresenceExtra));
+        TSharedPtr<FOnlinePicoFriend> OnlineFriend = PicoSubsystem.GetPicoUserProfileCache()->FindOrUpdate(ApplicationInviteElementUser);
+        auto FriendPresenceStatus = OnlineFriend.IsValid() ? OnlineFriend->GetUserPresenceStates() : ppfUserPresenceStatus_Unknown;
         EUserPresenceStatus PresenceStatus;
         if (FriendPresenceStatus == ppfUserPresenceStatus_OffLine)
         {
@@ -469,9 +303,12 @@ void FPicoPresenceInterface::OnQueryPresenceReadSendInvitesComplete(ppfMessageHa
             PresenceStatus = EUserPresenceStatus::Unknow;
         }
         FPicoUserInfo Friend;
-        Friend.DisplayName = FriendDisplayName;
+        if (OnlineFriend.IsValid())
+        {
+            Friend.DisplayName = OnlineFriend->GetDisplayName();
+            Friend.UserId = OnlineFriend->GetUserStrId();
+        }
         Friend.UserPresenceStatus = PresenceStatus;
-        Friend.UserId = FriendId;
         FPicoApplicationInvite PicoApplicationInvite;
         //       PicoApplicationInvite.Recipent = OnlineFriend;
         PicoApplicationInvite.Recipent = Friend;
@@ -769,24 +606,8 @@ void FPicoPresenceInterface::OnQuerySendInvitesComplete(ppfMessageHandle Message
         FString LobbySessionId = UTF8_TO_TCHAR(ppf_ApplicationInvite_GetLobbySessionId(ApplicationInviteElement));
         FString MatchSessionId = UTF8_TO_TCHAR(ppf_ApplicationInvite_GetMatchSessionId(ApplicationInviteElement));
         auto ApplicationInviteElementUser = ppf_ApplicationInvite_GetRecipient(ApplicationInviteElement);
-        FString FriendId = UTF8_TO_TCHAR(ppf_User_GetID(ApplicationInviteElementUser));
-        FString FriendDisplayName = UTF8_TO_TCHAR(ppf_User_GetDisplayName(ApplicationInviteElementUser));
-        auto FriendInviteToken = ppf_User_GetInviteToken(ApplicationInviteElementUser);
-        FString FriendInviteTokenString(UTF8_TO_TCHAR((FriendInviteToken != nullptr) ? FriendInviteToken : ""));
-        FString SmallImageUrl = UTF8_TO_TCHAR(ppf_User_GetSmallImageUrl(ApplicationInviteElementUser));
-        FString PresencePackage = UTF8_TO_TCHAR(ppf_User_GetPresencePackage(ApplicationInviteElementUser));
-        FString ImageUrl = UTF8_TO_TCHAR(ppf_User_GetImageUrl(ApplicationInviteElementUser));
-        ppfGender Gender = ppf_User_GetGender(ApplicationInviteElementUser);
-        FString Presence = UTF8_TO_TCHAR(ppf_User_GetPresence(ApplicationInviteElementUser));
-        FString PresenceDeeplinkMessage = UTF8_TO_TCHAR(ppf_User_GetPresenceDeeplinkMessage(ApplicationInviteElementUser));
-        FString PresenceDestinationApiName = UTF8_TO_TCHAR(ppf_User_GetPresenceDestinationApiName(ApplicationInviteElementUser));
-        FString PresenceLobbySessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceLobbySessionId(ApplicationInviteElementUser));
-        FString PresenceMatchSessionId = UTF8_TO_TCHAR(ppf_User_GetPresenceMatchSessionId(ApplicationInviteElementUser));
-        auto FriendPresenceStatus = ppf_User_GetPresenceStatus(ApplicationInviteElementUser);
-        FString PresenceExtra = ppf_User_GetPresenceExtra(ApplicationInviteElementUser);
-        TSharedRef<FOnlinePicoFriend> OnlineFriend(new FOnlinePicoFriend(FriendId, FriendDisplayName, FriendPresenceStatus, FriendInviteTokenString,
-            ImageUrl, Gender, SmallImageUrl, PresencePackage, Presence, PresenceDeeplinkMessage, PresenceDestinationApiName, PresenceLobbySessionId,
-            PresenceMatchSessionId, PresenceExtra));
+        TSharedPtr<FOnlinePicoFriend> OnlineFriend = PicoSubsystem.GetPicoUserProfileCache()->FindOrUpdate(ApplicationInviteElementUser);
+        auto FriendPresenceStatus = OnlineFriend.IsValid() ? OnlineFriend->GetUserPresenceStates() : ppfUserPresenceStatus_Unknown;
         EUserPresenceStatus PresenceStatus;
         if (FriendPresenceStatus == ppfUserPresenceStatus_OffLine)
         {
@@ -801,9 +622,12 @@ void FPicoPresenceInterface::OnQuerySendInvitesComplete(ppfMessageHandle Message
             PresenceStatus = EUserPresenceStatus::Unknow;
         }
         FPicoUserInfo Friend;
-        Friend.DisplayName = FriendDisplayName;
+        if (OnlineFriend.IsValid())
+        {
+            Friend.DisplayName = OnlineFriend->GetDisplayName();
+            Friend.UserId = OnlineFriend->GetUserStrId();
+        }
         Friend.UserPresenceStatus = PresenceStatus;
-        Friend.UserId = FriendId;
         FPicoApplicationInvite PicoApplicationInvite;
         //       PicoApplicationInvite.Recipent = OnlineFriend;
         PicoApplicationInvite.Recipent = Friend;
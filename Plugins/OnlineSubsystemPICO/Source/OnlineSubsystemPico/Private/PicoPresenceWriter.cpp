@@ -0,0 +1,460 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoPresenceWriter.h"
+#include "OnlineSubsystemPico.h"
+#include "OnlineSubsystemPicoPrivate.h"
+#include "PicoPresenceInterface.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+    void CopyFields(FPicoPresenceState& To, const FPicoPresenceState& From, EPicoPresenceField Fields)
+    {
+        if (EnumHasAnyFlags(Fields, EPicoPresenceField::Destination))
+        {
+            To.DestinationApiName = From.DestinationApiName;
+        }
+        if (EnumHasAnyFlags(Fields, EPicoPresenceField::LobbySession))
+        {
+            To.LobbySessionId = From.LobbySessionId;
+        }
+        if (EnumHasAnyFlags(Fields, EPicoPresenceField::MatchSession))
+        {
+            To.MatchSessionId = From.MatchSessionId;
+        }
+        if (EnumHasAnyFlags(Fields, EPicoPresenceField::Extra))
+        {
+            To.Extra = From.Extra;
+        }
+        if (EnumHasAnyFlags(Fields, EPicoPresenceField::IsJoinable))
+        {
+            To.bIsJoinable = From.bIsJoinable;
+        }
+    }
+
+    int32 CountFields(EPicoPresenceField Fields)
+    {
+        return FMath::CountBits(uint64(Fields));
+    }
+
+    class FPlatformPresenceBackend : public IPicoPresenceBackend
+    {
+    public:
+        FPlatformPresenceBackend(FOnlineSubsystemPico& InSubsystem) :
+            PicoSubsystem(InSubsystem)
+        {
+        }
+
+        virtual int32 Write(const FPicoPresenceState& State, EPicoPresenceField Fields, FOnComplete OnComplete) override
+        {
+            if (Fields == EPicoPresenceField::All)
+            {
+                auto PresenceOptions = ppf_PresenceOptions_Create();
+                ppf_PresenceOptions_SetDestinationApiName(PresenceOptions, TCHAR_TO_UTF8(*State.DestinationApiName));
+                ppf_PresenceOptions_SetLobbySessionId(PresenceOptions, TCHAR_TO_UTF8(*State.LobbySessionId));
+                ppf_PresenceOptions_SetMatchSessionId(PresenceOptions, TCHAR_TO_UTF8(*State.MatchSessionId));
+                ppf_PresenceOptions_SetExtra(PresenceOptions, TCHAR_TO_UTF8(*State.Extra));
+                ppf_PresenceOptions_SetIsJoinable(PresenceOptions, State.bIsJoinable);
+                Send(ppf_Presence_Set(PresenceOptions), MakeShared<FBatch>(1, MoveTemp(OnComplete)));
+                ppf_PresenceOptions_Destroy(PresenceOptions);
+                return 1;
+            }
+
+            // Without the full state only the single field calls leave the other fields alone. Joinable goes last,
+            // the platform refuses it while the destination or session is not set yet.
+            TSharedRef<FBatch> Batch = MakeShared<FBatch>(CountFields(Fields), MoveTemp(OnComplete));
+            if (EnumHasAnyFlags(Fields, EPicoPresenceField::Destination))
+            {
+                Send(ppf_Presence_SetDestination(TCHAR_TO_UTF8(*State.DestinationApiName)), Batch);
+            }
+            if (EnumHasAnyFlags(Fields, EPicoPresenceField::LobbySession))
+            {
+                Send(ppf_Presence_SetLobbySession(TCHAR_TO_UTF8(*State.LobbySessionId)), Batch);
+            }
+            if (EnumHasAnyFlags(Fields, EPicoPresenceField::MatchSession))
+            {
+                Send(ppf_Presence_SetMatchSession(TCHAR_TO_UTF8(*State.MatchSessionId)), Batch);
+            }
+            if (EnumHasAnyFlags(Fields, EPicoPresenceField::Extra))
+            {
+                Send(ppf_Presence_SetExtra(TCHAR_TO_UTF8(*State.Extra)), Batch);
+            }
+            if (EnumHasAnyFlags(Fields, EPicoPresenceField::IsJoinable))
+            {
+                Send(ppf_Presence_SetIsJoinable(State.bIsJoinable), Batch);
+            }
+            return Batch->NumPending;
+        }
+
+    private:
+        struct FBatch
+        {
+            FBatch(int32 InNumPending, FOnComplete&& InOnComplete) :
+                NumPending(InNumPending),
+                OnComplete(MoveTemp(InOnComplete))
+            {
+            }
+
+            int32 NumPending;
+            bool bSuccess = true;
+            FString ErrorMessage;
+            FOnComplete OnComplete;
+        };
+
+        void Send(ppfRequest Request, TSharedRef<FBatch> Batch)
+        {
+            PicoSubsystem.AddAsyncTask
+            (
+                Request,
+                FPicoMessageOnCompleteDelegate::CreateLambda
+                (
+                    [Batch](ppfMessageHandle Message, bool bIsError)
+                    {
+                        if (bIsError && Batch->bSuccess)
+                        {
+                            auto Error = ppf_Message_GetError(Message);
+                            Batch->bSuccess = false;
+                            Batch->ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error)) + FString(". Error Code: ") + FString::FromInt(ppf_Error_GetCode(Error));
+                        }
+                        if (--Batch->NumPending == 0 && Batch->OnComplete)
+                        {
+                            Batch->OnComplete(Batch->bSuccess, Batch->ErrorMessage);
+                        }
+                    }
+                )
+            );
+        }
+
+        FOnlineSubsystemPico& PicoSubsystem;
+    };
+}
+
+EPicoPresenceField FPicoPresenceState::Diff(const FPicoPresenceState& Other) const
+{
+    EPicoPresenceField Fields = EPicoPresenceField::None;
+    Fields |= DestinationApiName != Other.DestinationApiName ? EPicoPresenceField::Destination : EPicoPresenceField::None;
+    Fields |= LobbySessionId != Other.LobbySessionId ? EPicoPresenceField::LobbySession : EPicoPresenceField::None;
+    Fields |= MatchSessionId != Other.MatchSessionId ? EPicoPresenceField::MatchSession : EPicoPresenceField::None;
+    Fields |= Extra != Other.Extra ? EPicoPresenceField::Extra : EPicoPresenceField::None;
+    Fields |= bIsJoinable != Other.bIsJoinable ? EPicoPresenceField::IsJoinable : EPicoPresenceField::None;
+    return Fields;
+}
+
+int32 FPicoScriptedPresenceBackend::Write(const FPicoPresenceState& State, EPicoPresenceField Fields, FOnComplete OnComplete)
+{
+    const int32 NumWriteRequests = Fields == EPicoPresenceField::All ? 1 : CountFields(Fields);
+    NumWrites++;
+    NumRequests += NumWriteRequests;
+
+    FPendingWrite& PendingWrite = Pending.AddDefaulted_GetRef();
+    PendingWrite.RemainingSeconds = LatencySeconds;
+    PendingWrite.bFail = NumFailuresToInject > 0;
+    PendingWrite.State = State;
+    PendingWrite.Fields = Fields;
+    PendingWrite.OnComplete = MoveTemp(OnComplete);
+    NumFailuresToInject = FMath::Max(NumFailuresToInject - 1, 0);
+    return NumWriteRequests;
+}
+
+void FPicoScriptedPresenceBackend::Tick(float DeltaTime)
+{
+    TArray<FPendingWrite> Due;
+    for (int32 Index = 0; Index < Pending.Num(); ++Index)
+    {
+        Pending[Index].RemainingSeconds -= DeltaTime;
+        if (Pending[Index].RemainingSeconds <= 0.0f)
+        {
+            Due.Add(MoveTemp(Pending[Index]));
+            Pending.RemoveAt(Index--);
+        }
+    }
+    for (FPendingWrite& DueWrite : Due)
+    {
+        if (!DueWrite.bFail)
+        {
+            CopyFields(ServerState, DueWrite.State, DueWrite.Fields);
+        }
+        if (DueWrite.OnComplete)
+        {
+            DueWrite.OnComplete(!DueWrite.bFail, DueWrite.bFail ? TEXT("Injected failure") : TEXT(""));
+        }
+    }
+}
+
+FPicoPresenceWriter::FPicoPresenceWriter(TSharedRef<IPicoPresenceBackend> InBackend) :
+    Backend(InBackend)
+{
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("PresenceWriteDebounceSeconds"), DebounceSeconds, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("PresenceWriteMaxDelaySeconds"), MaxDelaySeconds, GEngineIni);
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("PresenceWriteMaxRetries"), MaxRetries, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("PresenceWriteRetrySeconds"), RetrySeconds, GEngineIni);
+    MaxDelaySeconds = FMath::Max(MaxDelaySeconds, DebounceSeconds);
+}
+
+TSharedRef<IPicoPresenceBackend> FPicoPresenceWriter::CreatePlatformBackend(FOnlineSubsystemPico& InSubsystem)
+{
+    return MakeShared<FPlatformPresenceBackend>(InSubsystem);
+}
+
+EPicoPresenceField FPicoPresenceWriter::ComputeDirty() const
+{
+    FPicoPresenceState Expected = Applied;
+    EPicoPresenceField ExpectedKnown = KnownFields;
+    if (bInFlight)
+    {
+        CopyFields(Expected, InFlightState, InFlightFields);
+        ExpectedKnown |= InFlightFields;
+    }
+    return (Desired.Diff(Expected) | (EPicoPresenceField::All & ~ExpectedKnown)) & TouchedFields;
+}
+
+void FPicoPresenceWriter::Set(const FPicoPresenceState& State, EPicoPresenceField Fields, IPicoPresenceBackend::FOnComplete OnComplete)
+{
+    Stats.NumChanges++;
+    CopyFields(Desired, State, Fields);
+    TouchedFields |= Fields;
+
+    const bool bWasDirty = DirtyFields != EPicoPresenceField::None;
+    DirtyFields = ComputeDirty();
+    if (DirtyFields != EPicoPresenceField::None)
+    {
+        FirstChangeTime = bWasDirty ? FirstChangeTime : Time;
+        LastChangeTime = Time;
+    }
+    if (OnComplete)
+    {
+        DirtyWaiters.Add(MoveTemp(OnComplete));
+    }
+}
+
+void FPicoPresenceWriter::OnClearSent()
+{
+    Desired = FPicoPresenceState();
+    TouchedFields = EPicoPresenceField::None;
+    DirtyFields = EPicoPresenceField::None;
+    Attempts = 0;
+    RetryTime = 0.0;
+
+    // A write in flight went out before the clear and completes as usual; the clear then wipes what it did.
+    CompleteWaiters(DirtyWaiters, false, TEXT("Presence was cleared"));
+}
+
+void FPicoPresenceWriter::OnCleared()
+{
+    // Requests are answered in order, so a write in flight now was sent after the clear and lands on top of it.
+    Applied = FPicoPresenceState();
+    KnownFields = EPicoPresenceField::All;
+    DirtyFields = ComputeDirty();
+}
+
+void FPicoPresenceWriter::Tick(float DeltaTime)
+{
+    Time += DeltaTime;
+    Backend->Tick(DeltaTime);
+
+    const int32 NumExpired = Algo::LowerBound(RequestTimes, Time - 60.0);
+    RequestTimes.RemoveAt(0, NumExpired, false);
+
+    if (bInFlight)
+    {
+        return;
+    }
+    if (DirtyFields == EPicoPresenceField::None)
+    {
+        // Changes that were reverted before they went out, or that match what the server already has.
+        CompleteWaiters(DirtyWaiters, true, FString());
+        return;
+    }
+    if (Time < RetryTime)
+    {
+        return;
+    }
+    if (Time - LastChangeTime >= DebounceSeconds || Time - FirstChangeTime >= MaxDelaySeconds)
+    {
+        Flush();
+    }
+}
+
+void FPicoPresenceWriter::Flush()
+{
+    InFlightState = Desired;
+    InFlightFields = DirtyFields;
+    // One full write is cheaper than several single field writes, but only safe once every field is known.
+    if (CountFields(DirtyFields) > 1 && EnumHasAllFlags(KnownFields | TouchedFields, EPicoPresenceField::All))
+    {
+        InFlightFields = EPicoPresenceField::All;
+    }
+    InFlightWaiters = MoveTemp(DirtyWaiters);
+    InFlightFirstChangeTime = FirstChangeTime;
+    DirtyFields = EPicoPresenceField::None;
+    bInFlight = true;
+    Attempts++;
+
+    const uint32 WriteId = ++InFlightId;
+    TWeakPtr<FPicoPresenceWriter> WeakWriter = AsShared();
+    const int32 NumRequests = Backend->Write(InFlightState, InFlightFields, [WeakWriter, WriteId](bool bSuccess, const FString& ErrorMessage)
+        {
+            if (TSharedPtr<FPicoPresenceWriter> Writer = WeakWriter.Pin())
+            {
+                Writer->OnWriteComplete(WriteId, bSuccess, ErrorMessage);
+            }
+        });
+
+    Stats.NumRequests += NumRequests;
+    for (int32 Index = 0; Index < NumRequests; ++Index)
+    {
+        RequestTimes.Add(Time);
+    }
+}
+
+void FPicoPresenceWriter::OnWriteComplete(uint32 WriteId, bool bSuccess, const FString& ErrorMessage)
+{
+    if (!bInFlight || WriteId != InFlightId)
+    {
+        return;
+    }
+    bInFlight = false;
+
+    if (bSuccess)
+    {
+        CopyFields(Applied, InFlightState, InFlightFields);
+        KnownFields |= InFlightFields;
+        Stats.LastAppliedLatencySeconds = Time - InFlightFirstChangeTime;
+        Attempts = 0;
+        RetryTime = 0.0;
+        DirtyFields = ComputeDirty();
+        CompleteWaiters(InFlightWaiters, true, FString());
+        return;
+    }
+
+    Stats.NumFailures++;
+    UE_LOG(PresenceInterface, Warning, TEXT("Presence write failed (attempt %d): %s"), Attempts, *ErrorMessage);
+
+    // Single field writes may have partly gone through.
+    KnownFields &= ~InFlightFields;
+    if (Attempts > MaxRetries)
+    {
+        Attempts = 0;
+        RetryTime = 0.0;
+        CompleteWaiters(InFlightWaiters, false, ErrorMessage);
+        if (DirtyFields == EPicoPresenceField::None)
+        {
+            // Asked for what the failed write carried.
+            CompleteWaiters(DirtyWaiters, false, ErrorMessage);
+            return;
+        }
+        // Newer changes still go out, and carry the failed fields along with them.
+        DirtyFields = ComputeDirty();
+        return;
+    }
+
+    // Retry, merged with whatever changed meanwhile: a newer value simply replaces the failed one.
+    Stats.NumRetries++;
+    const bool bWasDirty = DirtyFields != EPicoPresenceField::None;
+    DirtyFields = ComputeDirty();
+    InFlightWaiters.Append(MoveTemp(DirtyWaiters));
+    DirtyWaiters = MoveTemp(InFlightWaiters);
+    FirstChangeTime = bWasDirty ? FMath::Min(FirstChangeTime, InFlightFirstChangeTime) : InFlightFirstChangeTime;
+    RetryTime = Time + FMath::Min(RetrySeconds * FMath::Pow(2.0f, float(Attempts - 1)), MaxRetrySeconds);
+}
+
+void FPicoPresenceWriter::CompleteWaiters(FWaiters& Waiters, bool bSuccess, const FString& ErrorMessage)
+{
+    // Callbacks may change the presence again, which adds new waiters.
+    FWaiters Completed = MoveTemp(Waiters);
+    for (IPicoPresenceBackend::FOnComplete& OnComplete : Completed)
+    {
+        OnComplete(bSuccess, ErrorMessage);
+    }
+}
+
+FPicoPresenceWriterStats FPicoPresenceWriter::GetStats() const
+{
+    FPicoPresenceWriterStats Result = Stats;
+    Result.RequestsPerMinute = RequestTimes.Num();
+    return Result;
+}
+
+void FPicoPresenceWriter::Dump(FOutputDevice& Ar) const
+{
+    const FPicoPresenceWriterStats Current = GetStats();
+    Ar.Logf(TEXT("Pico presence writer: %s, debounce %.0f ms"), IsIdle() ? TEXT("idle") : bInFlight ? TEXT("writing") : TEXT("pending"), DebounceSeconds * 1000.0f);
+    Ar.Logf(TEXT("  Changes: %lld, Requests: %lld, Requests per minute: %d, Failures: %lld, Retries: %lld, Last applied latency: %.0f ms"),
+        Current.NumChanges, Current.NumRequests, Current.RequestsPerMinute, Current.NumFailures, Current.NumRetries, Current.LastAppliedLatencySeconds * 1000.0);
+    Ar.Logf(TEXT("  Desired: destination %s, lobby %s, match %s, joinable %d, extra %s"),
+        *Desired.DestinationApiName, *Desired.LobbySessionId, *Desired.MatchSessionId, Desired.bIsJoinable, *Desired.Extra);
+}
+
+FString FPicoPresenceWriter::RunScriptedSimulation()
+{
+    const float FrameTime = 1.0f / 72.0f;
+    const float ZoneSeconds = 0.1f;
+    const float WalkSeconds = 10.0f;
+
+    auto Run = [=](float Debounce)
+    {
+        TSharedRef<FPicoScriptedPresenceBackend> ScriptedBackend = MakeShared<FPicoScriptedPresenceBackend>();
+        ScriptedBackend->LatencySeconds = 0.15f;
+        TSharedRef<FPicoPresenceWriter> Writer = MakeShared<FPicoPresenceWriter>(ScriptedBackend);
+        Writer->DebounceSeconds = Debounce;
+        Writer->MaxDelaySeconds = FMath::Max(1.0f, Debounce);
+        Writer->RetrySeconds = 0.2f;
+
+        int32 NumSetterCalls = 0;
+        int32 NumCallbacks = 0;
+        int32 NumFailedCallbacks = 0;
+        auto OnComplete = [&NumCallbacks, &NumFailedCallbacks](bool bSuccess, const FString&)
+        {
+            NumCallbacks++;
+            NumFailedCallbacks += bSuccess ? 0 : 1;
+        };
+
+        // Gameplay sets each field on its own whenever the player crosses into another zone.
+        int32 Zone = 0;
+        double NextZoneTime = 0.0;
+        bool bFailureInjected = false;
+        for (double Now = 0.0; Now < WalkSeconds; Now += FrameTime)
+        {
+            if (Now >= NextZoneTime)
+            {
+                FPicoPresenceState State;
+                State.DestinationApiName = FString::Printf(TEXT("zone_%d"), Zone % 7);
+                State.LobbySessionId = TEXT("lobby");
+                State.MatchSessionId = FString::Printf(TEXT("match_%d"), Zone / 20);
+                State.bIsJoinable = Zone % 3 != 0;
+                State.Extra = FString::Printf(TEXT("{\"zone\":%d}"), Zone);
+                for (EPicoPresenceField Field : { EPicoPresenceField::Destination, EPicoPresenceField::LobbySession,
+                    EPicoPresenceField::MatchSession, EPicoPresenceField::IsJoinable, EPicoPresenceField::Extra })
+                {
+                    Writer->Set(State, Field, OnComplete);
+                    NumSetterCalls++;
+                }
+                Zone++;
+                NextZoneTime += ZoneSeconds;
+            }
+            if (!bFailureInjected && Now >= WalkSeconds * 0.5)
+            {
+                ScriptedBackend->NumFailuresToInject = 1;
+                bFailureInjected = true;
+            }
+            Writer->Tick(FrameTime);
+        }
+        for (int32 Frame = 0; Frame < 72 * 5 && !Writer->IsIdle(); ++Frame)
+        {
+            Writer->Tick(FrameTime);
+        }
+        Writer->Tick(FrameTime);
+
+        const FPicoPresenceWriterStats WriterStats = Writer->GetStats();
+        const bool bConverged = ScriptedBackend->ServerState.Diff(Writer->GetDesiredState()) == EPicoPresenceField::None;
+        return FString::Printf(TEXT("debounce %.0f ms: %d requests (%d per minute), %lld retries, last applied latency %.0f ms, %s, %d of %d callbacks (%d failed)"),
+            Debounce * 1000.0f, ScriptedBackend->NumRequests, WriterStats.RequestsPerMinute, WriterStats.NumRetries,
+            WriterStats.LastAppliedLatencySeconds * 1000.0, bConverged ? TEXT("converged") : TEXT("DIVERGED"),
+            NumCallbacks, NumSetterCalls, NumFailedCallbacks);
+    };
+
+    const int32 NumZones = FMath::CeilToInt(WalkSeconds / ZoneSeconds);
+    return FString::Printf(TEXT("%d zone changes over %.0f s, 5 setters each, one request per setter would be %d requests; per frame %s; %s"),
+        NumZones, WalkSeconds, NumZones * 5, *Run(0.0f), *Run(0.25f));
+}
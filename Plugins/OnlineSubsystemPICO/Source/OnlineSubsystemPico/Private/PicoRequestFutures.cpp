@@ -0,0 +1,218 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoRequestFutures.h"
+#include "OnlineSubsystemPico.h"
+#include "OnlineSubsystemPicoPrivate.h"
+
+FPicoCancelToken::FPicoCancelToken() :
+    State(MakeShared<FState>())
+{
+}
+
+void FPicoCancelToken::Cancel()
+{
+    if (State->bCancelled)
+    {
+        return;
+    }
+    State->bCancelled = true;
+
+    // Cancelling fulfils futures, whose continuations may register more requests with this token.
+    TArray<TFunction<void()>> Callbacks = MoveTemp(State->OnCancel);
+    for (TFunction<void()>& Callback : Callbacks)
+    {
+        Callback();
+    }
+}
+
+void FPicoCancelToken::OnCancel(TFunction<void()> OnCancel) const
+{
+    if (State->bCancelled)
+    {
+        OnCancel();
+        return;
+    }
+    State->OnCancel.Add(MoveTemp(OnCancel));
+}
+
+uint64 FPicoScriptedMessageQueue::Post(float LatencySeconds, TFunction<void()> Respond)
+{
+    FPosted& Message = Posted.AddDefaulted_GetRef();
+    Message.DueTime = Time + FMath::Max(LatencySeconds, 0.0f);
+    Message.Respond = MoveTemp(Respond);
+    return NextRequestId++;
+}
+
+void FPicoScriptedMessageQueue::Tick(float DeltaTime)
+{
+    Time += DeltaTime;
+
+    TArray<FPosted> Due;
+    for (int32 Index = 0; Index < Posted.Num(); ++Index)
+    {
+        if (Posted[Index].DueTime <= Time)
+        {
+            Due.Add(MoveTemp(Posted[Index]));
+            Posted.RemoveAt(Index--);
+        }
+    }
+
+    // Like the SDK queue, answers come out in the order they are due.
+    Due.StableSort([](const FPosted& A, const FPosted& B) { return A.DueTime < B.DueTime; });
+    for (FPosted& Message : Due)
+    {
+        Message.Respond();
+    }
+}
+
+FPicoRequestFutures::FPicoRequestFutures(FOnlineSubsystemPico* InSubsystem) :
+    PicoSubsystem(InSubsystem)
+{
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("RequestTraceSize"), TraceCapacity, GEngineIni);
+    TraceCapacity = FMath::Max(TraceCapacity, 1);
+}
+
+FPicoRequestFutures::~FPicoRequestFutures()
+{
+    TArray<TSharedRef<FPendingRequest>> Unanswered;
+    Pending.GenerateValueArray(Unanswered);
+    Pending.Reset();
+    for (const TSharedRef<FPendingRequest>& Request : Unanswered)
+    {
+        Request->Fail(FPicoRequestTrace::EOutcome::Cancelled, TEXT("Shutting down"));
+    }
+}
+
+double FPicoRequestFutures::GetTime() const
+{
+    return PicoSubsystem ? FPlatformTime::Seconds() : SimulatedTime;
+}
+
+void FPicoRequestFutures::SendRequest(ppfRequest RequestId, const TSharedRef<FPendingRequest>& Request, TFunction<void(FPendingRequest&, ppfMessageHandle, bool)>&& Resolve)
+{
+    // The subsystem's task manager outlives us, so the response must not reach back into this object.
+    TWeakPtr<FPendingRequest> WeakRequest = Request;
+    PicoSubsystem->AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
+        [WeakRequest, Resolve = MoveTemp(Resolve)](ppfMessageHandle Message, bool bIsError)
+        {
+            TSharedPtr<FPendingRequest> Answered = WeakRequest.Pin();
+            if (!Answered.IsValid() || Answered->bDone)
+            {
+                // Timed out, cancelled or shut down before the response came in.
+                return;
+            }
+            Answered->CompleteTime = FPlatformTime::Seconds();
+            Resolve(*Answered, Message, bIsError);
+        }));
+}
+
+void FPicoRequestFutures::Tick(float DeltaTime)
+{
+    SimulatedTime += DeltaTime;
+    ScriptedQueue.Tick(DeltaTime);
+
+    const double Now = GetTime();
+
+    // Failing a request runs its continuations, which may send more, so collect first.
+    TArray<TSharedRef<FPendingRequest>, TInlineAllocator<8>> Expired;
+    for (const TPair<uint64, TSharedRef<FPendingRequest>>& Request : Pending)
+    {
+        if (!Request.Value->bDone && Request.Value->Deadline > 0.0 && Request.Value->Deadline <= Now)
+        {
+            Expired.Add(Request.Value);
+        }
+    }
+    for (const TSharedRef<FPendingRequest>& Request : Expired)
+    {
+        Request->CompleteTime = Now;
+        Request->Fail(FPicoRequestTrace::EOutcome::TimedOut, TEXT("Timed out"));
+    }
+
+    TArray<FTimer> ExpiredTimers;
+    for (int32 Index = 0; Index < Timers.Num(); ++Index)
+    {
+        if (Timers[Index].Deadline <= Now)
+        {
+            ExpiredTimers.Add(MoveTemp(Timers[Index]));
+            Timers.RemoveAtSwap(Index--);
+        }
+    }
+    for (FTimer& Timer : ExpiredTimers)
+    {
+        Timer.OnExpired();
+    }
+
+    for (auto It = Pending.CreateIterator(); It; ++It)
+    {
+        FPendingRequest& Request = *It.Value();
+        if (Request.bDone)
+        {
+            if (Request.CompleteTime < 0.0)
+            {
+                Request.CompleteTime = Now;
+            }
+            RecordTrace(Request);
+            It.RemoveCurrent();
+        }
+    }
+}
+
+void FPicoRequestFutures::RecordTrace(const FPendingRequest& Request)
+{
+    FPicoRequestTrace Entry;
+    Entry.Name = Request.Name;
+    Entry.RequestId = Request.RequestId;
+    Entry.SendTime = Request.SendTime;
+    Entry.LatencySeconds = Request.CompleteTime - Request.SendTime;
+    Entry.Outcome = Request.Outcome;
+
+    FPicoRequestStats& NameStats = Stats.FindOrAdd(Request.Name);
+    NameStats.Count++;
+    NameStats.NumFailed += Entry.Outcome != FPicoRequestTrace::EOutcome::Succeeded ? 1 : 0;
+    NameStats.TotalSeconds += Entry.LatencySeconds;
+    NameStats.MaxSeconds = FMath::Max(NameStats.MaxSeconds, Entry.LatencySeconds);
+
+    UE_LOG_ONLINE(Verbose, TEXT("Request %s (%llu) finished in %.1f ms"), *Entry.Name, Entry.RequestId, Entry.LatencySeconds * 1000.0);
+
+    if (Trace.Num() < TraceCapacity)
+    {
+        Trace.Add(MoveTemp(Entry));
+    }
+    else
+    {
+        Trace[TraceHead] = MoveTemp(Entry);
+        TraceHead = (TraceHead + 1) % TraceCapacity;
+    }
+}
+
+void FPicoRequestFutures::GetTrace(TArray<FPicoRequestTrace>& OutTrace) const
+{
+    OutTrace.Reset(Trace.Num());
+    for (int32 Offset = 0; Offset < Trace.Num(); ++Offset)
+    {
+        OutTrace.Add(Trace[(TraceHead + Offset) % Trace.Num()]);
+    }
+}
+
+void FPicoRequestFutures::DumpTrace(FOutputDevice& Ar, int32 NumRecent) const
+{
+    static const TCHAR* OutcomeNames[] = { TEXT("ok"), TEXT("failed"), TEXT("timed out"), TEXT("cancelled") };
+
+    Ar.Logf(TEXT("Pico request latency (%d pending):"), Pending.Num());
+    for (const TPair<FString, FPicoRequestStats>& NameStats : Stats)
+    {
+        const FPicoRequestStats& Entry = NameStats.Value;
+        Ar.Logf(TEXT("  %s: Count: %lld, Failed: %lld, Avg: %.1f ms, Max: %.1f ms"), *NameStats.Key, Entry.Count, Entry.NumFailed,
+            Entry.Count > 0 ? Entry.TotalSeconds * 1000.0 / Entry.Count : 0.0, Entry.MaxSeconds * 1000.0);
+    }
+
+    TArray<FPicoRequestTrace> Recent;
+    GetTrace(Recent);
+    for (int32 Index = FMath::Max(Recent.Num() - NumRecent, 0); Index < Recent.Num(); ++Index)
+    {
+        const FPicoRequestTrace& Entry = Recent[Index];
+        Ar.Logf(TEXT("  %.3f %s (%llu): %.1f ms, %s"), Entry.SendTime, *Entry.Name, Entry.RequestId,
+            Entry.LatencySeconds * 1000.0, OutcomeNames[int32(Entry.Outcome)]);
+    }
+}
@@ -0,0 +1,186 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoUserProfileCache.h"
+#include "OnlineFriendsInterfacePico.h"
+#include "OnlineMessageTaskManagerPico.h"
+#include "OnlineSubsystemPicoPrivate.h"
+
+FPicoUserProfileCache::FPicoUserProfileCache(FPicoIdInterner& InIdInterner) :
+    IdInterner(InIdInterner)
+{
+    GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("UserProfileCacheMaxEntries"), MaxEntries, GEngineIni);
+    MaxEntries = FMath::Max(MaxEntries, 1);
+    TrimThreshold = MaxEntries;
+}
+
+TSharedPtr<FOnlinePicoFriend> FPicoUserProfileCache::FindOrUpdate(ppfUserHandle User, bool* bOutChanged)
+{
+    if (bOutChanged)
+    {
+        *bOutChanged = false;
+    }
+    if (User == nullptr)
+    {
+        return nullptr;
+    }
+
+    bool bChanged = false;
+    const int32 Key = IdInterner.Intern(ppf_User_GetID(User));
+    if (FEntry* Entry = Entries.Find(Key))
+    {
+        const int64 Bytes = Merge(*Entry, User, bChanged);
+        Count(!bChanged, bChanged, Bytes);
+    }
+    else
+    {
+        if (Entries.Num() >= TrimThreshold)
+        {
+            const int32 NumRemoved = Trim();
+            TrimThreshold = FMath::Max(MaxEntries, Entries.Num() * 2);
+            UE_LOG_ONLINE_FRIEND(Verbose, TEXT("Dropped %d unreferenced user profiles, %d left"), NumRemoved, Entries.Num());
+        }
+        FEntry& NewEntry = Entries.Add(Key, FEntry{ MakeShared<FOnlinePicoFriend>(IdInterner.Resolve(Key)) });
+        const int64 Bytes = sizeof(FOnlinePicoFriend) + NewEntry.Profile->GetUserStrId().GetAllocatedSize() + Merge(NewEntry, User, bChanged);
+        Count(false, false, Bytes);
+        bChanged = true;
+    }
+
+    if (bOutChanged)
+    {
+        *bOutChanged = bChanged;
+    }
+    return Entries.FindChecked(Key).Profile;
+}
+
+TSharedPtr<FOnlinePicoFriend> FPicoUserProfileCache::Find(const FString& UserId) const
+{
+    const int32 Key = IdInterner.Find(TCHAR_TO_UTF8(*UserId));
+    const FEntry* Entry = Key != INDEX_NONE ? Entries.Find(Key) : nullptr;
+    return Entry ? TSharedPtr<FOnlinePicoFriend>(Entry->Profile) : nullptr;
+}
+
+int64 FPicoUserProfileCache::Merge(FEntry& Entry, ppfUserHandle User, bool& bOutChanged)
+{
+    struct FStringField
+    {
+        const char* (*Get)(ppfUserHandle);
+        FString FOnlinePicoFriend::* Member;
+        bool bPresence;
+    };
+    static const FStringField StringFields[Field_Num] =
+    {
+        { [](ppfUserHandle InUser) { return ppf_User_GetDisplayName(InUser); }, &FOnlinePicoFriend::DisplayName, false },
+        { [](ppfUserHandle InUser) { return ppf_User_GetInviteToken(InUser); }, &FOnlinePicoFriend::InviteToken, false },
+        { [](ppfUserHandle InUser) { return ppf_User_GetImageUrl(InUser); }, &FOnlinePicoFriend::ImageUrl, false },
+        { [](ppfUserHandle InUser) { return ppf_User_GetSmallImageUrl(InUser); }, &FOnlinePicoFriend::SmallImageUrl, false },
+        { [](ppfUserHandle InUser) { return ppf_User_GetPresencePackage(InUser); }, &FOnlinePicoFriend::PresencePackage, true },
+        { [](ppfUserHandle InUser) { return ppf_User_GetPresence(InUser); }, &FOnlinePicoFriend::Presencestr, true },
+        { [](ppfUserHandle InUser) { return ppf_User_GetPresenceDeeplinkMessage(InUser); }, &FOnlinePicoFriend::PresenceDeeplinkMessage, true },
+        { [](ppfUserHandle InUser) { return ppf_User_GetPresenceDestinationApiName(InUser); }, &FOnlinePicoFriend::PresenceDestinationApiName, true },
+        { [](ppfUserHandle InUser) { return ppf_User_GetPresenceLobbySessionId(InUser); }, &FOnlinePicoFriend::PresenceLobbySessionId, true },
+        { [](ppfUserHandle InUser) { return ppf_User_GetPresenceMatchSessionId(InUser); }, &FOnlinePicoFriend::PresenceMatchSessionId, true },
+        { [](ppfUserHandle InUser) { return ppf_User_GetPresenceExtra(InUser); }, &FOnlinePicoFriend::PresenceExtra, true },
+    };
+
+    FOnlinePicoFriend& Profile = *Entry.Profile;
+    int64 Bytes = 0;
+
+    // Sparse users (leaderboard entries, some invite recipients) come with an unknown presence status and empty
+    // presence strings. Those must not overwrite the presence a friends list read put there.
+    const ppfUserPresenceStatus PresenceStatus = ppf_User_GetPresenceStatus(User);
+    const bool bHasPresence = PresenceStatus != ppfUserPresenceStatus_Unknown;
+    if (bHasPresence && Profile.UserPresenceStatus != PresenceStatus)
+    {
+        Profile.UserPresenceStatus = PresenceStatus;
+        Profile.Presence.bIsOnline = PresenceStatus == ppfUserPresenceStatus_OnLine;
+        bOutChanged = true;
+    }
+    const ppfGender Gender = ppf_User_GetGender(User);
+    if (Gender != ppfGender_Unknown && Profile.Gender != Gender)
+    {
+        Profile.Gender = Gender;
+        bOutChanged = true;
+    }
+
+    for (int32 FieldIndex = 0; FieldIndex < Field_Num; ++FieldIndex)
+    {
+        const FStringField& Field = StringFields[FieldIndex];
+        const char* Utf8 = Field.Get(User);
+        const int32 Length = Utf8 ? FCStringAnsi::Strlen(Utf8) : 0;
+        if (Field.bPresence ? !bHasPresence : Length == 0)
+        {
+            continue;
+        }
+        // Hash 0 stands for never assigned, an empty string hashes to 0 as well, which is what the profile holds.
+        const uint32 Hash = Length > 0 ? FCrc::MemCrc32(Utf8, Length) : 0;
+        if (Hash == Entry.FieldHashes[FieldIndex])
+        {
+            continue;
+        }
+        FString& Value = Profile.*Field.Member;
+        Value = Length > 0 ? FString(UTF8_TO_TCHAR(Utf8)) : FString();
+        Entry.FieldHashes[FieldIndex] = Hash;
+        Bytes += Value.GetAllocatedSize();
+        bOutChanged = true;
+    }
+    return Bytes;
+}
+
+void FPicoUserProfileCache::Count(bool bHit, bool bUpdate, int64 Bytes)
+{
+    for (FStats* Target : { &Stats, &RefreshStats })
+    {
+        Target->Lookups++;
+        Target->Hits += bHit ? 1 : 0;
+        Target->Updates += bUpdate ? 1 : 0;
+        Target->BytesAllocated += Bytes;
+    }
+}
+
+void FPicoUserProfileCache::BeginRefresh()
+{
+    if (RefreshDepth++ == 0)
+    {
+        RefreshStats = FStats();
+    }
+}
+
+void FPicoUserProfileCache::EndRefresh(const FString& ListName)
+{
+    if (RefreshDepth == 0 || --RefreshDepth > 0)
+    {
+        return;
+    }
+    LastRefreshStats = RefreshStats;
+    UE_LOG_ONLINE_FRIEND(Log, TEXT("Refreshed %s: %lld users, %lld unchanged, %lld updated, %lld bytes allocated"),
+        *ListName, RefreshStats.Lookups, RefreshStats.Hits, RefreshStats.Updates, RefreshStats.BytesAllocated);
+}
+
+int32 FPicoUserProfileCache::Trim()
+{
+    int32 NumRemoved = 0;
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (It.Value().Profile.IsUnique())
+        {
+            It.RemoveCurrent();
+            ++NumRemoved;
+        }
+    }
+    return NumRemoved;
+}
+
+void FPicoUserProfileCache::Dump(FOutputDevice& Ar) const
+{
+    auto HitRate = [](const FStats& Entry)
+    {
+        return Entry.Lookups > 0 ? 100.0 * Entry.Hits / Entry.Lookups : 0.0;
+    };
+
+    Ar.Logf(TEXT("Pico user profiles: %d cached"), Entries.Num());
+    Ar.Logf(TEXT("  Total: Lookups: %lld, Hit rate: %.1f%%, Updated: %lld, Bytes allocated: %lld"),
+        Stats.Lookups, HitRate(Stats), Stats.Updates, Stats.BytesAllocated);
+    Ar.Logf(TEXT("  Last refresh: Lookups: %lld, Hit rate: %.1f%%, Updated: %lld, Bytes allocated: %lld"),
+        LastRefreshStats.Lookups, HitRate(LastRefreshStats), LastRefreshStats.Updates, LastRefreshStats.BytesAllocated);
+}
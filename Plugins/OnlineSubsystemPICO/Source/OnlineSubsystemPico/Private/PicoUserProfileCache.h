@@ -0,0 +1,103 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OnlineSubsystemPicoPackage.h"
+
+class FOnlinePicoFriend;
+class FPicoIdInterner;
+
+/// @file PicoUserProfileCache.h
+
+/// <summary>
+/// One shared profile per user ID for every user the SDK hands us: friends, invitable users, invite recipients,
+/// room members and leaderboard entries. A user seen again with the same fields is not converted again, and a
+/// changed user is updated in place, so every list holding the profile sees e.g. the new presence without a refetch.
+/// Responses that only carry part of a user, e.g. leaderboard entries without presence, only update that part.
+/// Once more than UserProfileCacheMaxEntries ([OnlineSubsystemPico] in Engine.ini, 1024 by default) profiles are
+/// cached, adding one first drops the profiles no list references any more. Game thread only.
+/// </summary>
+class FPicoUserProfileCache
+{
+public:
+    struct FStats
+    {
+        int64 Lookups = 0;
+        int64 Hits = 0; /*!< The user was cached and unchanged */
+        int64 Updates = 0; /*!< The user was cached and updated in place */
+        int64 BytesAllocated = 0; /*!< Estimated, for new profiles and changed fields */
+    };
+
+    FPicoUserProfileCache(FPicoIdInterner& InIdInterner);
+
+    /// <summary>Gets the profile of a user from a response, creating it or updating it in place if any field it carries changed.</summary>
+    /// <param name="User">The user handle, only read during the call.</param>
+    /// <param name="bOutChanged">Optional, set if the profile is new or was updated.</param>
+    /// <returns>null if `User` is null.</returns>
+    TSharedPtr<FOnlinePicoFriend> FindOrUpdate(ppfUserHandle User, bool* bOutChanged = nullptr);
+
+    /// <summary>Gets a cached profile without touching the stats. Null for users that were never seen.</summary>
+    TSharedPtr<FOnlinePicoFriend> Find(const FString& UserId) const;
+
+    /// <summary>Starts counting the stats of one list refresh, see EndRefresh.</summary>
+    void BeginRefresh();
+
+    /// <summary>Logs the hit rate and bytes allocated since BeginRefresh.</summary>
+    void EndRefresh(const FString& ListName);
+
+    /// <summary>Drops profiles that no list references any more. Also done on insert above the configured size.</summary>
+    /// <returns>The number of profiles dropped.</returns>
+    int32 Trim();
+
+    int32 Num() const { return Entries.Num(); }
+    const FStats& GetStats() const { return Stats; }
+    const FStats& GetLastRefreshStats() const { return LastRefreshStats; }
+
+    void Dump(FOutputDevice& Ar) const;
+
+private:
+    enum EField
+    {
+        Field_DisplayName,
+        Field_InviteToken,
+        Field_ImageUrl,
+        Field_SmallImageUrl,
+        Field_PresencePackage,
+        Field_Presence,
+        Field_PresenceDeeplinkMessage,
+        Field_PresenceDestinationApiName,
+        Field_PresenceLobbySessionId,
+        Field_PresenceMatchSessionId,
+        Field_PresenceExtra,
+        Field_Num
+    };
+
+    struct FEntry
+    {
+        TSharedRef<FOnlinePicoFriend> Profile;
+        /** Hash of the raw UTF-8 of each string field as last assigned, so an unchanged field costs no conversion. */
+        uint32 FieldHashes[Field_Num];
+    };
+
+    /**
+     * Copies the fields User carries into the profile: names and images when not empty, gender when known and
+     * presence only when the presence status is known. Returns the bytes allocated, bOutChanged is set if any differed.
+     */
+    static int64 Merge(FEntry& Entry, ppfUserHandle User, bool& bOutChanged);
+
+    void Count(bool bHit, bool bUpdate, int64 Bytes);
+
+    FPicoIdInterner& IdInterner;
+
+    /** Keyed by interned user ID. */
+    TMap<int32, FEntry> Entries;
+
+    int32 MaxEntries = 1024;
+    /** Size at which the next insert trims, kept at least twice what survived the last trim so inserts stay cheap. */
+    int32 TrimThreshold = 1024;
+
+    FStats Stats;
+    FStats RefreshStats;
+    FStats LastRefreshStats;
+    int32 RefreshDepth = 0;
+};
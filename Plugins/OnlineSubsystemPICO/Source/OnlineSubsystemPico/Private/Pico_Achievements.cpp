@@ -5,6 +5,7 @@
 #include "Pico_Achievements.h"
 
 #include "OnlineSubsystemUtils.h"
+#include "Interfaces/OnlineIdentityInterface.h"
 #include "OnlineSubsystemPico.h"
 #include <vector>
 #include <string>
@@ -123,36 +124,51 @@ void UOnlinePicoAchievementsFunction::PicoGetProgressByName(UObject* WorldContex
 
 // FPicoAchievementsInterface
 FPicoAchievementsInterface::FPicoAchievementsInterface(FOnlineSubsystemPico& InSubsystem) :
-    PicoSubsystem(InSubsystem)
+    PicoSubsystem(InSubsystem),
+    WriteQueue(MakeShared<FPicoAchievementWriteQueue>(FPicoAchievementWriteQueue::CreatePlatformBackend(InSubsystem), FPaths::ProjectSavedDir() / TEXT("PicoAchievementQueue")))
 {
-
+    IOnlineIdentityPtr IdentityInterface = PicoSubsystem.GetIdentityInterface();
+    if (IdentityInterface.IsValid())
+    {
+        LoginCompleteHandle = IdentityInterface->AddOnLoginCompleteDelegate_Handle(0, FOnLoginCompleteDelegate::CreateRaw(this, &FPicoAchievementsInterface::OnLoginComplete));
+    }
 }
 
 FPicoAchievementsInterface::~FPicoAchievementsInterface()
 {
+    IOnlineIdentityPtr IdentityInterface = PicoSubsystem.GetIdentityInterface();
+    if (IdentityInterface.IsValid())
+    {
+        IdentityInterface->ClearOnLoginCompleteDelegate_Handle(0, LoginCompleteHandle);
+    }
+}
 
+void FPicoAchievementsInterface::OnLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error)
+{
+    // A logout alone keeps the queue, Login logs out first.
+    if (bWasSuccessful && UserId.IsValid())
+    {
+        WriteQueue->SetUserId(UserId.ToString());
+    }
+}
+
+void FPicoAchievementsInterface::Tick(float DeltaTime)
+{
+    WriteQueue->Tick(DeltaTime);
+}
+
+void FPicoAchievementsInterface::Checkpoint()
+{
+    WriteQueue->Checkpoint();
 }
 
 bool FPicoAchievementsInterface::AddCount(const FString& Name, const int64& Count, const FString& ExtraData, FAddCount InAddCountDelegate)
 {
     UE_LOG(PicoAchievements, Log, TEXT("FPicoAchievementsInterface::AddCount"));
-    const TCHAR* StrPtr = *ExtraData;
-    FTCHARToUTF8 UTF8String(StrPtr);
-    int32 Size = UTF8String.Length();
-    TArray<uint8> UTF8Data;
-    UTF8Data.SetNum(Size);
-    memcpy(UTF8Data.GetData(), UTF8String.Get(), Size);
-
-    ppfRequest RequestId = ppf_Achievements_AddCount(TCHAR_TO_UTF8(*Name), Count, UTF8Data.GetData(), Size);
-    PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
-        [InAddCountDelegate, this](ppfMessageHandle Message, bool bIsError)
+    WriteQueue->AddCount(Name, Count, ExtraData, [InAddCountDelegate, Name, this](bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked)
         {
-            if (bIsError)
+            if (!bSuccess)
             {
-                auto Error = ppf_Message_GetError(Message);
-                FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-                FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-                ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
                 UE_LOG(PicoAchievements, Log, TEXT("AddCount return failed:%s"), *ErrorMessage);
                 this->AddCountDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
                 InAddCountDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
@@ -161,34 +177,21 @@ bool FPicoAchievementsInterface::AddCount(const FString& Name, const int64& Coun
             {
                 UE_LOG(PicoAchievements, Log, TEXT("AddCount Successfully"));
                 UPico_AchievementUpdate* Pico_AchievementUpdate = NewObject<UPico_AchievementUpdate>();
-                Pico_AchievementUpdate->InitParams(ppf_Message_GetAchievementUpdate(Message));
+                Pico_AchievementUpdate->InitParams(Name, bJustUnlocked);
                 this->AddCountDelegate.ExecuteIfBound(false, FString(), Pico_AchievementUpdate);
                 InAddCountDelegate.ExecuteIfBound(false, FString(), Pico_AchievementUpdate);
             }
-        }));
+        });
     return true;
 }
 
 bool FPicoAchievementsInterface::AddFields(const FString& Name, const FString& Fields, const FString& ExtraData, FAddFields InAddFieldsDelegate)
 {
     UE_LOG(PicoAchievements, Log, TEXT("FPicoAchievementsInterface::AddFields"));
-    const TCHAR* StrPtr = *ExtraData;
-    FTCHARToUTF8 UTF8String(StrPtr);
-    int32 Size = UTF8String.Length();
-    TArray<uint8> UTF8Data;
-    UTF8Data.SetNum(Size);
-    memcpy(UTF8Data.GetData(), UTF8String.Get(), Size);
-
-    ppfRequest RequestId = ppf_Achievements_AddFields(TCHAR_TO_UTF8(*Name), TCHAR_TO_UTF8(*Fields), UTF8Data.GetData(), Size);
-    PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
-        [InAddFieldsDelegate, this](ppfMessageHandle Message, bool bIsError)
+    WriteQueue->AddFields(Name, Fields, ExtraData, [InAddFieldsDelegate, Name, this](bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked)
         {
-            if (bIsError)
+            if (!bSuccess)
             {
-                auto Error = ppf_Message_GetError(Message);
-                FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-                FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-                ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
                 UE_LOG(PicoAchievements, Log, TEXT("AddFields return failed:%s"), *ErrorMessage);
                 this->AddFieldsDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
                 InAddFieldsDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
@@ -197,47 +200,34 @@ bool FPicoAchievementsInterface::AddFields(const FString& Name, const FString& F
             {
                 UE_LOG(PicoAchievements, Log, TEXT("AddFields Successfully"));
                 UPico_AchievementUpdate* Pico_AchievementUpdate = NewObject<UPico_AchievementUpdate>();
-                Pico_AchievementUpdate->InitParams(ppf_Message_GetAchievementUpdate(Message));
+                Pico_AchievementUpdate->InitParams(Name, bJustUnlocked);
                 this->AddFieldsDelegate.ExecuteIfBound(false, FString(), Pico_AchievementUpdate);
                 InAddFieldsDelegate.ExecuteIfBound(false, FString(), Pico_AchievementUpdate);
             }
-        }));
+        });
     return true;
 }
 
 bool FPicoAchievementsInterface::Unlock(const FString& Name, const FString& ExtraData, FUnlock InUnlockDelegate)
 {
     UE_LOG(PicoAchievements, Log, TEXT("FPicoAchievementsInterface::Unlock"));
-    const TCHAR* StrPtr = *ExtraData;
-    FTCHARToUTF8 UTF8String(StrPtr);
-    int32 Size = UTF8String.Length();
-    TArray<uint8> UTF8Data;
-    UTF8Data.SetNum(Size);
-    memcpy(UTF8Data.GetData(), UTF8String.Get(), Size);
-
-    ppfRequest RequestId = ppf_Achievements_Unlock(TCHAR_TO_UTF8(*Name), UTF8Data.GetData(), Size);
-    PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
-        [InUnlockDelegate, this](ppfMessageHandle Message, bool bIsError)
+    WriteQueue->Unlock(Name, ExtraData, [InUnlockDelegate, Name, this](bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked)
         {
-            if (bIsError)
+            if (!bSuccess)
             {
-                auto Error = ppf_Message_GetError(Message);
-                FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-                FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-                ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-                UE_LOG(PicoAchievements, Log, TEXT("AddFields return failed:%s"), *ErrorMessage);
+                UE_LOG(PicoAchievements, Log, TEXT("Unlock return failed:%s"), *ErrorMessage);
                 this->UnlockDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
                 InUnlockDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
             }
             else
             {
-                UE_LOG(PicoAchievements, Log, TEXT("AddFields Successfully"));
+                UE_LOG(PicoAchievements, Log, TEXT("Unlock Successfully"));
                 UPico_AchievementUpdate* Pico_AchievementUpdate = NewObject<UPico_AchievementUpdate>();
-                Pico_AchievementUpdate->InitParams(ppf_Message_GetAchievementUpdate(Message));
+                Pico_AchievementUpdate->InitParams(Name, bJustUnlocked);
                 this->UnlockDelegate.ExecuteIfBound(false, FString(), Pico_AchievementUpdate);
                 InUnlockDelegate.ExecuteIfBound(false, FString(), Pico_AchievementUpdate);
             }
-        }));
+        });
     return true;
 }
 
@@ -389,6 +379,12 @@ void UPico_AchievementUpdate::InitParams(ppfAchievementUpdateHandle ppfAchieveme
     JustUnlocked = ppf_AchievementUpdate_GetJustUnlocked(ppfAchievementUpdateHandle);
 }
 
+void UPico_AchievementUpdate::InitParams(const FString& InName, bool bInJustUnlocked)
+{
+    Name = InName;
+    JustUnlocked = bInJustUnlocked;
+}
+
 FString UPico_AchievementUpdate::GetName()
 {
     return Name;
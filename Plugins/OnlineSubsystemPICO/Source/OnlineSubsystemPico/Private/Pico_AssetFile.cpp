@@ -7,6 +7,15 @@
 
 DEFINE_LOG_CATEGORY(PicoAssetFile);
 
+namespace
+{
+    /** ppfMessageType_Notification_AssetFile_DownloadUpdate, decoded on the message worker. */
+    struct FDecodedAssetFileDownloadUpdate : public FPicoDecodedMessage
+    {
+        FPicoAssetFileDownloadUpdateData Data;
+    };
+}
+
 FPicoAssetFileInterface::FPicoAssetFileInterface(FOnlineSubsystemPico& InSubsystem) :
     PicoSubsystem(InSubsystem)
 {
@@ -14,6 +23,16 @@ FPicoAssetFileInterface::FPicoAssetFileInterface(FOnlineSubsystemPico& InSubsyst
         PicoSubsystem.GetOrAddNotify(ppfMessageType_Notification_AssetFile_DownloadUpdate)
         .AddRaw(this, &FPicoAssetFileInterface::OnAssetFileDownloadUpdate);
 
+#if PLATFORM_ANDROID
+    PicoSubsystem.RegisterMessageDecoder(ppfMessageType_Notification_AssetFile_DownloadUpdate,
+        [](ppfMessageHandle Message) -> TUniquePtr<FPicoDecodedMessage>
+        {
+            TUniquePtr<FDecodedAssetFileDownloadUpdate> Decoded = MakeUnique<FDecodedAssetFileDownloadUpdate>();
+            Decoded->Data.InitParams(ppf_Message_GetAssetFileDownloadUpdate(Message));
+            return Decoded;
+        });
+#endif
+
     AssetFileDeleteForSafetyHandle =
         PicoSubsystem.GetOrAddNotify(ppfMessageType_Notification_AssetFile_DeleteForSafety)
         .AddRaw(this, &FPicoAssetFileInterface::OnAssetFileDeleteForSafety);
@@ -354,21 +373,136 @@ bool FPicoAssetFileInterface::GetAssetFileStatusByName(FString AssetFileName, FG
     return false;
 }
 
+void FPicoAssetFileInterface::MountAssetFile(const FPicoAssetMountRequest& Request, FPicoAssetMountComplete OnComplete)
+{
+    UE_LOG(PicoAssetFile, Log, TEXT("FPicoAssetFileInterface::MountAssetFile %s"), *Request.Filepath);
+    Mounter.Mount(Request, OnComplete);
+}
+
+bool FPicoAssetFileInterface::DownloadAndMountById(FString AssetFileID, const FPicoAssetMountRequest& Request, FPicoAssetMountComplete OnComplete)
+{
+    UE_LOG(PicoAssetFile, Log, TEXT("FPicoAssetFileInterface::DownloadAndMountById"));
+#if PLATFORM_ANDROID
+    ppfRequest RequestId = ppf_AssetFile_DownloadById(FStringTouint64(AssetFileID));
+    if (RequestId == 0)
+    {
+        UE_LOG(PicoAssetFile, Log, TEXT("DownloadAndMountById sending the download request failed"));
+        FPicoAssetMountResult Result;
+        Result.Filepath = Request.Filepath;
+        Result.ErrorMessage = TEXT("Sending the download request failed");
+        OnComplete.ExecuteIfBound(Result);
+        return false;
+    }
+    FPendingMount& PendingMount = PendingMounts.Add(AssetFileID);
+    PendingMount.Request = Request;
+    PendingMount.OnComplete = OnComplete;
+    PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
+        [AssetFileID, this](ppfMessageHandle Message, bool bIsError)
+        {
+            if (bIsError)
+            {
+                auto Error = ppf_Message_GetError(Message);
+                FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
+                FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
+                ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
+                UE_LOG(PicoAssetFile, Log, TEXT("DownloadAndMountById return failed:%s"), *ErrorMessage);
+                UpdatePendingMount(AssetFileID, nullptr, EAssetFileDownloadCompleteStatus::Failed, ErrorMessage);
+            }
+            else
+            {
+                const FString Filepath = UTF8_TO_TCHAR(ppf_AssetFileDownloadResult_GetFilepath(ppf_Message_GetAssetFileDownloadResult(Message)));
+                UpdatePendingMount(AssetFileID, &Filepath, EAssetFileDownloadCompleteStatus::Downloading, FString());
+            }
+        }));
+    return true;
+#else
+    FPicoAssetMountResult Result;
+    Result.Filepath = Request.Filepath;
+    Result.ErrorMessage = TEXT("Asset files can only be downloaded on Android");
+    OnComplete.ExecuteIfBound(Result);
+    return false;
+#endif
+}
+
+void FPicoAssetFileInterface::UpdatePendingMount(const FString& AssetFileID, const FString* Filepath, EAssetFileDownloadCompleteStatus Status, const FString& ErrorMessage)
+{
+    FPendingMount* PendingMount = PendingMounts.Find(AssetFileID);
+    if (!PendingMount)
+    {
+        return;
+    }
+
+    if (Filepath)
+    {
+        PendingMount->Request.Filepath = *Filepath;
+    }
+    PendingMount->bDownloaded |= Status == EAssetFileDownloadCompleteStatus::Succeed;
+
+    if (Status == EAssetFileDownloadCompleteStatus::Failed)
+    {
+        FPicoAssetMountResult Result;
+        Result.Filepath = PendingMount->Request.Filepath;
+        Result.ErrorMessage = ErrorMessage;
+        const FPicoAssetMountComplete OnComplete = PendingMount->OnComplete;
+        PendingMounts.Remove(AssetFileID);
+        OnComplete.ExecuteIfBound(Result);
+    }
+    else if (PendingMount->bDownloaded && !PendingMount->Request.Filepath.IsEmpty())
+    {
+        // The download result and the final progress update can arrive in either order.
+        FPendingMount Ready = MoveTemp(*PendingMount);
+        PendingMounts.Remove(AssetFileID);
+        Mounter.Mount(Ready.Request, Ready.OnComplete);
+    }
+}
+
+void FPicoAssetFileInterface::Tick(float DeltaTime)
+{
+    Mounter.Tick(DeltaTime);
+}
+
 void FPicoAssetFileInterface::OnAssetFileDownloadUpdate(ppfMessageHandle Message, bool bIsError)
 {
-    UE_LOG(PicoAssetFile, Log, TEXT("FPicoAssetFileInterface::OnAssetFileDownloadUpdate"));
+    UE_LOG(PicoAssetFile, Verbose, TEXT("FPicoAssetFileInterface::OnAssetFileDownloadUpdate"));
     if (bIsError)
     {
         UE_LOG(PicoAssetFile, Error, TEXT("AssetFileDownloadUpdate error!"));
     }
 
 #if PLATFORM_ANDROID
-    UPico_AssetFileDownloadUpdate* AssetFileDownloadUpdate = NewObject<UPico_AssetFileDownloadUpdate>();
-    AssetFileDownloadUpdate->InitParams(ppf_Message_GetAssetFileDownloadUpdate(Message));
-    AssetFileDownloadUpdateCallback.Broadcast(AssetFileDownloadUpdate);
+    const FPicoAssetFileDownloadUpdateData* Data = nullptr;
+    if (const FDecodedAssetFileDownloadUpdate* Decoded = PicoSubsystem.GetDecodedMessage<FDecodedAssetFileDownloadUpdate>(Message))
+    {
+        Data = &Decoded->Data;
+    }
+    else
+    {
+        DownloadUpdateData.InitParams(ppf_Message_GetAssetFileDownloadUpdate(Message));
+        Data = &DownloadUpdateData;
+    }
+    AssetFileDownloadUpdateDataCallback.Broadcast(*Data);
+
+    if (PendingMounts.Num() > 0 && Data->CompleteStatus != EAssetFileDownloadCompleteStatus::Downloading)
+    {
+        UpdatePendingMount(Data->AssetId, nullptr, Data->CompleteStatus, TEXT("Download failed"));
+    }
+
+    // Only pay for the UObject when somebody still listens through the object based callback.
+    if (AssetFileDownloadUpdateCallback.IsBound())
+    {
+        AssetFileDownloadUpdateCallback.Broadcast(CreateDownloadUpdateObject(*Data));
+    }
 #endif
 }
 
+UPico_AssetFileDownloadUpdate* FPicoAssetFileInterface::CreateDownloadUpdateObject(const FPicoAssetFileDownloadUpdateData& DownloadUpdate)
+{
+    UPico_AssetFileDownloadUpdate* AssetFileDownloadUpdate = NewObject<UPico_AssetFileDownloadUpdate>();
+    AssetFileDownloadUpdate->InitParams(DownloadUpdate);
+    FOnlineSubsystemPico::RecordResultObjects(1);
+    return AssetFileDownloadUpdate;
+}
+
 void FPicoAssetFileInterface::OnAssetFileDeleteForSafety(ppfMessageHandle Message, bool bIsError)
 {
     UE_LOG(PicoAssetFile, Log, TEXT("FPicoAssetFileInterface::OnAssetFileDeleteForSafety"));
@@ -774,7 +908,7 @@ ppfID UPico_AssetFileDownloadCancelResult::GetppfAssetId()
 
 void UPico_AssetFileDownloadUpdate::InitParams(ppfAssetFileDownloadUpdate* InppfAssetFileDownloadUpdateHandle)
 {
-    UE_LOG(PicoAssetFile, Log, TEXT("UPico_AssetFileDownloadUpdate::InitParams"));
+    UE_LOG(PicoAssetFile, Verbose, TEXT("UPico_AssetFileDownloadUpdate::InitParams"));
 #if PLATFORM_ANDROID
     ppfAssetId = ppf_AssetFileDownloadUpdate_GetAssetId(InppfAssetFileDownloadUpdateHandle);
     AssetId = uint64ToFString(ppfAssetId);
@@ -796,6 +930,38 @@ void UPico_AssetFileDownloadUpdate::InitParams(ppfAssetFileDownloadUpdate* Inppf
 #endif
 }
 
+void UPico_AssetFileDownloadUpdate::InitParams(const FPicoAssetFileDownloadUpdateData& InDownloadUpdate)
+{
+    ppfAssetId = InDownloadUpdate.ppfAssetId;
+    AssetId = InDownloadUpdate.AssetId;
+    BytesTotal = InDownloadUpdate.BytesTotal;
+    BytesTransferred = InDownloadUpdate.BytesTransferred;
+    AssetFileDownloadCompleteStatus = InDownloadUpdate.CompleteStatus;
+}
+
+void FPicoAssetFileDownloadUpdateData::InitParams(ppfAssetFileDownloadUpdateHandle InppfAssetFileDownloadUpdateHandle)
+{
+#if PLATFORM_ANDROID
+    ppfAssetId = ppf_AssetFileDownloadUpdate_GetAssetId(InppfAssetFileDownloadUpdateHandle);
+    AssetId = uint64ToFString(ppfAssetId);
+    BytesTotal = ppf_AssetFileDownloadUpdate_GetBytesTotal(InppfAssetFileDownloadUpdateHandle);
+    BytesTransferred = ppf_AssetFileDownloadUpdate_GetBytesTransferred(InppfAssetFileDownloadUpdateHandle);
+    ppfAssetFileDownloadCompleteStatus pAssetFileDownloadCompleteStatus = ppf_AssetFileDownloadUpdate_GetCompleteStatus(InppfAssetFileDownloadUpdateHandle);
+    if (pAssetFileDownloadCompleteStatus == ppfAssetFileDownloadCompleteStatus_Downloading)
+    {
+        CompleteStatus = EAssetFileDownloadCompleteStatus::Downloading;
+    }
+    else if (pAssetFileDownloadCompleteStatus == ppfAssetFileDownloadCompleteStatus_Succeed)
+    {
+        CompleteStatus = EAssetFileDownloadCompleteStatus::Succeed;
+    }
+    else
+    {
+        CompleteStatus = EAssetFileDownloadCompleteStatus::Failed;
+    }
+#endif
+}
+
 FString UPico_AssetFileDownloadUpdate::GetAssetId()
 {
     return AssetId;
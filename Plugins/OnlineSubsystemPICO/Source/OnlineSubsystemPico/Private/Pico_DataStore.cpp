@@ -7,19 +7,26 @@
 DEFINE_LOG_CATEGORY(DataStore);
 void UPico_DataStore::InitParams(ppfDataStore* InppfDataStoreHandle)
 {
-    UE_LOG(DataStore, Log, TEXT("Data store init!"));
+    UE_LOG(DataStore, Verbose, TEXT("Data store init!"));
     NumKey = ppf_DataStore_GetNumKeys(InppfDataStoreHandle);
-    UE_LOG(DataStore, Log, TEXT("DataStore init GetNumKeys:%i"), NumKey);
+    UE_LOG(DataStore, Verbose, TEXT("DataStore init GetNumKeys:%i"), NumKey);
     for (int i = 0; i < NumKey; i++)
     {
         FString Key = UTF8_TO_TCHAR(ppf_DataStore_GetKey(InppfDataStoreHandle, i));
-        UE_LOG(DataStore, Log, TEXT("UPico_DataStore::InitParams Key:%s"), *Key);
+        UE_LOG(DataStore, Verbose, TEXT("UPico_DataStore::InitParams Key:%s"), *Key);
         KeyArray.Add(Key);
         FString Value = UTF8_TO_TCHAR(ppf_DataStore_GetValue(InppfDataStoreHandle, TCHAR_TO_UTF8(*Key)));
         DataStoreMap.Add(Key, Value);
     }
 }
 
+void UPico_DataStore::InitParams(const TMap<FString, FString>& InDataStoreMap)
+{
+    DataStoreMap = InDataStoreMap;
+    DataStoreMap.GenerateKeyArray(KeyArray);
+    NumKey = KeyArray.Num();
+}
+
 int32 UPico_DataStore::Contains(FString Key)
 {
     return KeyArray.Find(Key);
@@ -15,11 +15,174 @@ DEFINE_LOG_CATEGORY(PicoLeaderboards);
 FPicoLeaderboardsInterface::FPicoLeaderboardsInterface(FOnlineSubsystemPico& InSubsystem) :
 	PicoSubsystem(InSubsystem)
 {
-	
+	GConfig->GetInt(TEXT("OnlineSubsystemPico"), TEXT("LeaderboardCacheMaxPages"), MaxCachedPages, GEngineIni);
+	GConfig->GetBool(TEXT("OnlineSubsystemPico"), TEXT("bLeaderboardPrefetch"), bPrefetchAdjacentPages, GEngineIni);
 }
 FPicoLeaderboardsInterface::~FPicoLeaderboardsInterface()
 {
-	
+	FPicoLeaderboardCacheStats Stats = GetCacheStats();
+	UE_LOG(PicoLeaderboards, Log, TEXT("Leaderboard page cache: HitRate: %.2f, Hits: %lld, Misses: %lld, Requests: %lld, Prefetches: %lld, Invalidations: %lld"),
+		Stats.GetHitRate(), Stats.Hits, Stats.Misses, Stats.Requests, Stats.Prefetches, Stats.Invalidations);
+}
+
+void FPicoLeaderboardsInterface::RequestPage(const FPicoLeaderboardPageKey& Key, FOnPageReady OnPageReady)
+{
+	if (FCachedPage* Cached = PageCache.Find(Key))
+	{
+		CacheStats.Hits++;
+		Cached->LastUsed = ++UseCounter;
+		TSharedPtr<const FPicoLeaderboardPage> Page = Cached->Page;
+		UE_LOG(PicoLeaderboards, Log, TEXT("RequestPage cache hit: %s, PageIdx: %d"), *Key.LeaderboardName, Key.PageIdx);
+		// Complete on the next tick like a miss would, so callers never see the callback before RequestPage returns.
+		PicoSubsystem.ExecuteNextTick
+		(
+			[OnPageReady = MoveTemp(OnPageReady), Page]()
+			{
+				OnPageReady(false, FString(), Page);
+			}
+		);
+		PrefetchAdjacentPages(Key, *Page);
+		return;
+	}
+
+	if (FPendingPage* Pending = PendingPages.Find(Key))
+	{
+		// Usually a prefetch the user scrolled into before it came back.
+		CacheStats.Hits++;
+		Pending->Callbacks.Add(MoveTemp(OnPageReady));
+		return;
+	}
+
+	CacheStats.Misses++;
+	SendPageRequest(Key);
+	PendingPages.FindChecked(Key).Callbacks.Add(MoveTemp(OnPageReady));
+}
+
+void FPicoLeaderboardsInterface::SendPageRequest(const FPicoLeaderboardPageKey& Key)
+{
+	ppfRequest RequestId = Key.bAfterRank
+		? ppf_Leaderboard_GetEntriesAfterRank(TCHAR_TO_UTF8(*Key.LeaderboardName), Key.PageSize, Key.PageIdx, Key.AfterRank)
+		: ppf_Leaderboard_GetEntries(TCHAR_TO_UTF8(*Key.LeaderboardName), Key.PageSize, Key.PageIdx, Key.Filter, Key.StartAt);
+	CacheStats.Requests++;
+
+	FPendingPage& Pending = PendingPages.Add(Key);
+	Pending.Generation = GetGeneration(Key.LeaderboardName);
+	PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateRaw(this, &FPicoLeaderboardsInterface::OnPageRequestComplete, Key));
+}
+
+void FPicoLeaderboardsInterface::OnPageRequestComplete(ppfMessageHandle Message, bool bIsError, FPicoLeaderboardPageKey Key)
+{
+	FPendingPage Pending;
+	PendingPages.RemoveAndCopyValue(Key, Pending);
+
+	if (bIsError)
+	{
+		auto Error = ppf_Message_GetError(Message);
+		FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
+		FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
+		ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
+		UE_LOG(PicoLeaderboards, Log, TEXT("RequestPage return failed:%s"), *ErrorMessage);
+		for (FOnPageReady& Callback : Pending.Callbacks)
+		{
+			Callback(true, ErrorMessage, nullptr);
+		}
+		return;
+	}
+
+	TSharedRef<FPicoLeaderboardPage> Page = MakeShared<FPicoLeaderboardPage>();
+	Page->InitParams(ppf_Message_GetLeaderboardEntryArray(Message));
+	if (Pending.Generation == GetGeneration(Key.LeaderboardName))
+	{
+		AddToCache(Key, Page);
+	}
+	for (FOnPageReady& Callback : Pending.Callbacks)
+	{
+		Callback(false, FString(), Page);
+	}
+	if (Pending.Callbacks.Num() > 0)
+	{
+		PrefetchAdjacentPages(Key, *Page);
+	}
+}
+
+void FPicoLeaderboardsInterface::AddToCache(const FPicoLeaderboardPageKey& Key, const TSharedPtr<const FPicoLeaderboardPage>& Page)
+{
+	FCachedPage& Cached = PageCache.Add(Key);
+	Cached.Page = Page;
+	Cached.LastUsed = ++UseCounter;
+
+	while (PageCache.Num() > FMath::Max(MaxCachedPages, 1))
+	{
+		auto Oldest = PageCache.CreateIterator();
+		for (auto It = PageCache.CreateIterator(); It; ++It)
+		{
+			if (It.Value().LastUsed < Oldest.Value().LastUsed)
+			{
+				Oldest = It;
+			}
+		}
+		Oldest.RemoveCurrent();
+	}
+}
+
+void FPicoLeaderboardsInterface::PrefetchAdjacentPages(const FPicoLeaderboardPageKey& Key, const FPicoLeaderboardPage& Page)
+{
+	if (!bPrefetchAdjacentPages)
+	{
+		return;
+	}
+	auto Prefetch = [this](const FPicoLeaderboardPageKey& AdjacentKey)
+	{
+		if (!PageCache.Contains(AdjacentKey) && !PendingPages.Contains(AdjacentKey))
+		{
+			CacheStats.Prefetches++;
+			SendPageRequest(AdjacentKey);
+		}
+	};
+	if (Page.bHasNextPage)
+	{
+		FPicoLeaderboardPageKey Next = Key;
+		Next.PageIdx++;
+		Prefetch(Next);
+	}
+	if (Page.bHasPreviousPage && Key.PageIdx > 0)
+	{
+		FPicoLeaderboardPageKey Previous = Key;
+		Previous.PageIdx--;
+		Prefetch(Previous);
+	}
+}
+
+uint32 FPicoLeaderboardsInterface::GetGeneration(const FString& LeaderboardName) const
+{
+	const uint32* Generation = LeaderboardGenerations.Find(LeaderboardName);
+	return Generation ? *Generation : 0;
+}
+
+void FPicoLeaderboardsInterface::InvalidateLeaderboard(const FString& LeaderboardName)
+{
+	UE_LOG(PicoLeaderboards, Log, TEXT("InvalidateLeaderboard: %s"), *LeaderboardName);
+	CacheStats.Invalidations++;
+	LeaderboardGenerations.FindOrAdd(LeaderboardName)++;
+	for (auto It = PageCache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().LeaderboardName == LeaderboardName)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FPicoLeaderboardCacheStats FPicoLeaderboardsInterface::GetCacheStats() const
+{
+	FPicoLeaderboardCacheStats Stats = CacheStats;
+	Stats.CachedPages = PageCache.Num();
+	Stats.CachedBytes = PageCache.GetAllocatedSize();
+	for (auto& Cached : PageCache)
+	{
+		Stats.CachedBytes += Cached.Value.Page->GetAllocatedSize();
+	}
+	return Stats;
 }
 
 // ppf_Leaderboard_Get
@@ -57,18 +220,17 @@ bool FPicoLeaderboardsInterface::GetEntries(const FString& LeaderboardName, int
                                             ppfLeaderboardFilterType Filter, ppfLeaderboardStartAt StartAt,
                                             FGetEntries InGetEntriesDelegate)
 {
-	UE_LOG(PicoLeaderboards, Log, TEXT("FPicoLeaderboardsInterface::AddCount"));
-	ppfRequest RequestId = ppf_Leaderboard_GetEntries(TCHAR_TO_UTF8(*LeaderboardName), PageSize, PageIdx, Filter, StartAt);
-	PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
-		[InGetEntriesDelegate, this](ppfMessageHandle Message, bool bIsError)
+	UE_LOG(PicoLeaderboards, Log, TEXT("FPicoLeaderboardsInterface::GetEntries"));
+	FPicoLeaderboardPageKey Key;
+	Key.LeaderboardName = LeaderboardName;
+	Key.PageIdx = PageIdx;
+	Key.PageSize = PageSize;
+	Key.Filter = Filter;
+	Key.StartAt = StartAt;
+	RequestPage(Key, [InGetEntriesDelegate, this](bool bIsError, const FString& ErrorMessage, const TSharedPtr<const FPicoLeaderboardPage>& Page)
 		{
 			if (bIsError)
 			{
-				auto Error = ppf_Message_GetError(Message);
-                FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-                FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-                ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-				UE_LOG(PicoLeaderboards, Log, TEXT("GetEntries return failed:%s"), *ErrorMessage);
 				this->GetEntriesDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
 				InGetEntriesDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
 			}
@@ -76,11 +238,11 @@ bool FPicoLeaderboardsInterface::GetEntries(const FString& LeaderboardName, int
 			{
 				UE_LOG(PicoLeaderboards, Log, TEXT("GetEntries Successfully"));
 				UPico_LeaderboardEntryArray* Pico_LeaderboardEntryArray = NewObject<UPico_LeaderboardEntryArray>();
-				Pico_LeaderboardEntryArray->InitParams(ppf_Message_GetLeaderboardEntryArray(Message));
+				Pico_LeaderboardEntryArray->InitParams(Page);
 				this->GetEntriesDelegate.ExecuteIfBound(false, FString(), Pico_LeaderboardEntryArray);
 				InGetEntriesDelegate.ExecuteIfBound(false, FString(), Pico_LeaderboardEntryArray);
 			}
-		}));
+		});
 	return true;
 }
 
@@ -89,18 +251,17 @@ bool FPicoLeaderboardsInterface::GetEntriesAfterRank(const FString& LeaderboardN
                                                      unsigned long long AfterRank,
                                                      FGetEntriesAfterRank InGetEntriesAfterRankDelegate)
 {
-	UE_LOG(PicoLeaderboards, Log, TEXT("FPicoLeaderboardsInterface::AddCount"));
-	ppfRequest RequestId = ppf_Leaderboard_GetEntriesAfterRank(TCHAR_TO_UTF8(*LeaderboardName), PageSize, PageIdx, AfterRank);
-	PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
-		[InGetEntriesAfterRankDelegate, this](ppfMessageHandle Message, bool bIsError)
+	UE_LOG(PicoLeaderboards, Log, TEXT("FPicoLeaderboardsInterface::GetEntriesAfterRank"));
+	FPicoLeaderboardPageKey Key;
+	Key.LeaderboardName = LeaderboardName;
+	Key.PageIdx = PageIdx;
+	Key.PageSize = PageSize;
+	Key.bAfterRank = true;
+	Key.AfterRank = AfterRank;
+	RequestPage(Key, [InGetEntriesAfterRankDelegate, this](bool bIsError, const FString& ErrorMessage, const TSharedPtr<const FPicoLeaderboardPage>& Page)
 		{
 			if (bIsError)
 			{
-				auto Error = ppf_Message_GetError(Message);
-                FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-                FString ErrorCode = FString::FromInt(ppf_Error_GetCode(Error));
-                ErrorMessage = ErrorMessage + FString(". Error Code: ") + ErrorCode;
-				UE_LOG(PicoLeaderboards, Log, TEXT("GetEntriesAfterRank return failed:%s"), *ErrorMessage);
 				this->GetEntriesAfterRankDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
 				InGetEntriesAfterRankDelegate.ExecuteIfBound(true, ErrorMessage, nullptr);
 			}
@@ -108,11 +269,11 @@ bool FPicoLeaderboardsInterface::GetEntriesAfterRank(const FString& LeaderboardN
 			{
 				UE_LOG(PicoLeaderboards, Log, TEXT("GetEntriesAfterRank Successfully"));
 				UPico_LeaderboardEntryArray* Pico_LeaderboardEntryArray = NewObject<UPico_LeaderboardEntryArray>();
-				Pico_LeaderboardEntryArray->InitParams(ppf_Message_GetLeaderboardEntryArray(Message));
+				Pico_LeaderboardEntryArray->InitParams(Page);
 				this->GetEntriesAfterRankDelegate.ExecuteIfBound(false, FString(), Pico_LeaderboardEntryArray);
 				InGetEntriesAfterRankDelegate.ExecuteIfBound(false, FString(), Pico_LeaderboardEntryArray);
 			}
-		}));
+		});
 	return true;
 }
 
@@ -175,7 +336,7 @@ bool FPicoLeaderboardsInterface::WriteEntry(const FString& LeaderboardName, cons
 	
 	ppfRequest RequestId = ppf_Leaderboard_WriteEntry(TCHAR_TO_UTF8(*LeaderboardName), Score, UTF8Data.GetData(), Size, ForceUpdate);
 	PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
-		[InWriteEntryDelegate, this](ppfMessageHandle Message, bool bIsError)
+		[InWriteEntryDelegate, LeaderboardName, this](ppfMessageHandle Message, bool bIsError)
 		{
 			if (bIsError)
 			{
@@ -191,6 +352,10 @@ bool FPicoLeaderboardsInterface::WriteEntry(const FString& LeaderboardName, cons
 			{
                 UE_LOG(PicoLeaderboards, Log, TEXT("WriteEntry Successfully"));
                 bool Result = ppf_LeaderboardUpdateStatus_GetDidUpdate(ppf_Message_GetLeaderboardUpdateStatus(Message));
+                if (Result)
+                {
+                    InvalidateLeaderboard(LeaderboardName);
+                }
                 this->WriteEntryDelegate.ExecuteIfBound(false, FString(), Result);
                 InWriteEntryDelegate.ExecuteIfBound(false, FString(), Result);
 			}
@@ -215,7 +380,7 @@ bool FPicoLeaderboardsInterface::WriteEntryWithSupplementaryMetric(const FString
 	
 	ppfRequest RequestId = ppf_Leaderboard_WriteEntryWithSupplementaryMetric(TCHAR_TO_UTF8(*LeaderboardName), Score, SupplementaryMetric, UTF8Data.GetData(), Size, ForceUpdate);
 	PicoSubsystem.AddAsyncTask(RequestId, FPicoMessageOnCompleteDelegate::CreateLambda(
-		[InWriteEntryWithSupplementaryMetricDelegate, this](ppfMessageHandle Message, bool bIsError)
+		[InWriteEntryWithSupplementaryMetricDelegate, LeaderboardName, this](ppfMessageHandle Message, bool bIsError)
 		{
 			if (bIsError)
 			{
@@ -231,6 +396,10 @@ bool FPicoLeaderboardsInterface::WriteEntryWithSupplementaryMetric(const FString
 			{
                 UE_LOG(PicoLeaderboards, Log, TEXT("WriteEntryWithSupplementaryMetric Successfully"));
                 bool Result = ppf_LeaderboardUpdateStatus_GetDidUpdate(ppf_Message_GetLeaderboardUpdateStatus(Message));
+                if (Result)
+                {
+                    InvalidateLeaderboard(LeaderboardName);
+                }
                 this->WriteEntryWithSupplementaryMetricDelegate.ExecuteIfBound(false, FString(), Result);
                 InWriteEntryWithSupplementaryMetricDelegate.ExecuteIfBound(false, FString(), Result);
 			}
@@ -388,6 +557,27 @@ void UPico_LeaderboardEntry::InitParams(ppfLeaderboardEntryHandle ppfLeaderboard
 	}
 }
 
+void UPico_LeaderboardEntry::InitParams(const FPicoLeaderboardPage& Page, int32 Index)
+{
+	DisplayScore = Page.DisplayScores[Index];
+	ID = Page.IDs[Index];
+	Rank = Page.Ranks[Index];
+	Score = Page.Scores[Index];
+	Timestamp = Page.Timestamps[Index];
+	if (User == nullptr)
+	{
+		User = NewObject<UPico_User>(this);
+	}
+	User->InitParams(Page.UserIDs[Index], Page.UserDisplayNames[Index], Page.UserImageUrls[Index], Page.UserSmallImageUrls[Index]);
+	const int32 ExtraDataStart = Page.ExtraDataOffsets[Index];
+	ExtraData = TArray<uint8>(Page.ExtraData.GetData() + ExtraDataStart, Page.ExtraDataOffsets[Index + 1] - ExtraDataStart);
+	if (Page.HasSupplementaryMetric[Index])
+	{
+		SupplementaryMetricOptional.ID = FString::Printf(TEXT("%llu"), Page.SupplementaryMetricIDs[Index]);
+		SupplementaryMetricOptional.Metric = FString::Printf(TEXT("%lld"), Page.SupplementaryMetrics[Index]);
+	}
+}
+
 FString UPico_LeaderboardEntry::GetID()
 {
 	return FString::Printf(TEXT("%llu"), ID);
@@ -473,28 +663,106 @@ FPicoDestination UPico_Leaderboard::GetDestinationOptional()
 
 
 
-// UPico_LeaderboardEntryArray
-void UPico_LeaderboardEntryArray::InitParams(ppfLeaderboardEntryArrayHandle InppfLeaderboardEntryArrayHandle)
+// FPicoLeaderboardPage
+void FPicoLeaderboardPage::InitParams(ppfLeaderboardEntryArrayHandle InppfLeaderboardEntryArrayHandle)
 {
-	UE_LOG(PicoLeaderboards, Log, TEXT("UPico_LeaderboardEntryArray::InitParams"));
-	Size = ppf_LeaderboardEntryArray_GetSize(InppfLeaderboardEntryArrayHandle);
-	UE_LOG(PicoLeaderboards, Log, TEXT("UPico_LeaderboardEntryArray::InitParams ppf_LeaderboardEntryArray_GetSize: %d"), Size);
+	const int32 Size = ppf_LeaderboardEntryArray_GetSize(InppfLeaderboardEntryArrayHandle);
+	UE_LOG(PicoLeaderboards, Log, TEXT("FPicoLeaderboardPage::InitParams ppf_LeaderboardEntryArray_GetSize: %d"), Size);
+	IDs.Reserve(Size);
+	Ranks.Reserve(Size);
+	Scores.Reserve(Size);
+	Timestamps.Reserve(Size);
+	DisplayScores.Reserve(Size);
+	UserIDs.Reserve(Size);
+	UserDisplayNames.Reserve(Size);
+	UserImageUrls.Reserve(Size);
+	UserSmallImageUrls.Reserve(Size);
+	HasSupplementaryMetric.Reserve(Size);
+	SupplementaryMetricIDs.Reserve(Size);
+	SupplementaryMetrics.Reserve(Size);
+	ExtraDataOffsets.Reserve(Size + 1);
 	for (int32 i = 0; i < Size; i++)
 	{
-		UPico_LeaderboardEntry* ThisElement = NewObject<UPico_LeaderboardEntry>(this);
-		ThisElement->InitParams(ppf_LeaderboardEntryArray_GetElement(InppfLeaderboardEntryArrayHandle, i));
-		LeaderboardEntryArray.Add(ThisElement);
+		ppfLeaderboardEntryHandle Entry = ppf_LeaderboardEntryArray_GetElement(InppfLeaderboardEntryArrayHandle, i);
+		IDs.Add(ppf_LeaderboardEntry_GetID(Entry));
+		Ranks.Add(ppf_LeaderboardEntry_GetRank(Entry));
+		Scores.Add(ppf_LeaderboardEntry_GetScore(Entry));
+		Timestamps.Add(ppf_LeaderboardEntry_GetTimestamp(Entry));
+		DisplayScores.Add(UTF8_TO_TCHAR(ppf_LeaderboardEntry_GetDisplayScore(Entry)));
+
+		ppfUserHandle User = ppf_LeaderboardEntry_GetUser(Entry);
+		UserIDs.Add(UTF8_TO_TCHAR(ppf_User_GetID(User)));
+		UserDisplayNames.Add(UTF8_TO_TCHAR(ppf_User_GetDisplayName(User)));
+		UserImageUrls.Add(UTF8_TO_TCHAR(ppf_User_GetImageUrl(User)));
+		UserSmallImageUrls.Add(UTF8_TO_TCHAR(ppf_User_GetSmallImageUrl(User)));
+
+		ppfSupplementaryMetricHandle SupplementaryMetricHandle = ppf_LeaderboardEntry_GetSupplementaryMetric(Entry);
+		HasSupplementaryMetric.Add(SupplementaryMetricHandle != nullptr);
+		SupplementaryMetricIDs.Add(SupplementaryMetricHandle ? ppf_SupplementaryMetric_GetID(SupplementaryMetricHandle) : 0);
+		SupplementaryMetrics.Add(SupplementaryMetricHandle ? ppf_SupplementaryMetric_GetMetric(SupplementaryMetricHandle) : 0);
+
+		ExtraDataOffsets.Add(ExtraData.Num());
+		const int32 ExtraDataSize = ppf_LeaderboardEntry_GetExtraDataLength(Entry);
+		if (ExtraDataSize > 0)
+		{
+			ExtraData.Append((const uint8*)ppf_LeaderboardEntry_GetExtraData(Entry), ExtraDataSize);
+		}
 	}
+	ExtraDataOffsets.Add(ExtraData.Num());
 	bHasNextPage = ppf_LeaderboardEntryArray_HasNextPage(InppfLeaderboardEntryArrayHandle);
 	bHasPreviousPage = ppf_LeaderboardEntryArray_HasPreviousPage(InppfLeaderboardEntryArrayHandle);
 	TotalSize = ppf_LeaderboardEntryArray_GetTotalCount(InppfLeaderboardEntryArrayHandle);
 }
 
+SIZE_T FPicoLeaderboardPage::GetAllocatedSize() const
+{
+	SIZE_T Bytes = IDs.GetAllocatedSize() + Ranks.GetAllocatedSize() + Scores.GetAllocatedSize() + Timestamps.GetAllocatedSize()
+		+ HasSupplementaryMetric.GetAllocatedSize() + SupplementaryMetricIDs.GetAllocatedSize() + SupplementaryMetrics.GetAllocatedSize()
+		+ ExtraDataOffsets.GetAllocatedSize() + ExtraData.GetAllocatedSize();
+	for (const TArray<FString>* Column : { &DisplayScores, &UserIDs, &UserDisplayNames, &UserImageUrls, &UserSmallImageUrls })
+	{
+		Bytes += Column->GetAllocatedSize();
+		for (const FString& Value : *Column)
+		{
+			Bytes += Value.GetAllocatedSize();
+		}
+	}
+	return Bytes;
+}
+
+
+
+
+// UPico_LeaderboardEntryArray
+void UPico_LeaderboardEntryArray::InitParams(ppfLeaderboardEntryArrayHandle InppfLeaderboardEntryArrayHandle)
+{
+	UE_LOG(PicoLeaderboards, Log, TEXT("UPico_LeaderboardEntryArray::InitParams"));
+	TSharedRef<FPicoLeaderboardPage> NewPage = MakeShared<FPicoLeaderboardPage>();
+	NewPage->InitParams(InppfLeaderboardEntryArrayHandle);
+	InitParams(NewPage);
+}
+
+void UPico_LeaderboardEntryArray::InitParams(const TSharedPtr<const FPicoLeaderboardPage>& InPage)
+{
+	Page = InPage;
+	Size = Page->Num();
+	LeaderboardEntryArray.Init(nullptr, Size);
+	bHasNextPage = Page->bHasNextPage;
+	bHasPreviousPage = Page->bHasPreviousPage;
+	TotalSize = Page->TotalSize;
+}
+
 UPico_LeaderboardEntry* UPico_LeaderboardEntryArray::GetElement(int32 Index)
 {
 	UE_LOG(PicoLeaderboards, Log, TEXT("UPico_LeaderboardEntryArray::GetElement Index: %d"), Index);
 	if (LeaderboardEntryArray.IsValidIndex(Index))
 	{
+		if (LeaderboardEntryArray[Index] == nullptr)
+		{
+			UPico_LeaderboardEntry* ThisElement = NewObject<UPico_LeaderboardEntry>(this);
+			ThisElement->InitParams(*Page, Index);
+			LeaderboardEntryArray[Index] = ThisElement;
+		}
 		return LeaderboardEntryArray[Index];
 	}
 	return nullptr;
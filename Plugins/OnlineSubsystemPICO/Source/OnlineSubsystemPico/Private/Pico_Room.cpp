@@ -341,22 +341,8 @@ FPicoRoomInterface::FPicoRoomInterface(FOnlineSubsystemPico& InSubsystem) :
 }
 void FPicoRoomInterface::OnRoomUpdateNotification(ppfMessageHandle Message, bool bIsError)
 {
-	UE_LOG(PicoRoom, Log, TEXT("FPicoRoomInterface::OnRoomUpdateNotification"));
-	if (bIsError)
-	{
-		const ppfErrorHandle Error = ppf_Message_GetError(Message);
-		const int ErrorCode = ppf_Error_GetCode(Error);
-		const FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-		UE_LOG(PicoRoom, Error, TEXT("RoomUpdateNotification error! ErrorCode: %d, ErrorMessage: %s"), ErrorCode, *ErrorMessage);
-		RoomUpdateNotify.Broadcast(bIsError, ErrorCode, ErrorMessage, nullptr);
-	}
-	else
-	{
-		UE_LOG(PicoRoom, Log, TEXT("RoomUpdateNotification success!"));
-		UPico_Room* Room = NewObject<UPico_Room>();
-		Room->InitParams(ppf_Message_GetRoom(Message));
-		RoomUpdateNotify.Broadcast(bIsError, 0, FString(), Room);
-	}
+	UE_LOG(PicoRoom, Verbose, TEXT("FPicoRoomInterface::OnRoomUpdateNotification"));
+	BroadcastRoomNotification(TEXT("RoomUpdateNotification"), RoomUpdateDataNotify, RoomUpdateNotify, Message, bIsError);
 }
 
 void FPicoRoomInterface::OnRoomUpdateOwnerNotification(ppfMessageHandle Message, bool bIsError)
@@ -380,40 +366,92 @@ void FPicoRoomInterface::OnRoomUpdateOwnerNotification(ppfMessageHandle Message,
 void FPicoRoomInterface::OnRoomJoinNotification(ppfMessageHandle Message, bool bIsError)
 {
 	UE_LOG(PicoRoom, Log, TEXT("FPicoRoomInterface::OnRoomJoinNotification"));
+	BroadcastRoomNotification(TEXT("RoomJoinNotification"), RoomJoinDataNotify, RoomJoinNotify, Message, bIsError);
+}
+
+void FPicoRoomInterface::OnRoomLeaveNotification(ppfMessageHandle Message, bool bIsError)
+{
+	UE_LOG(PicoRoom, Log, TEXT("FPicoRoomInterface::OnRoomLeaveNotification"));
+	BroadcastRoomNotification(TEXT("RoomLeaveNotification"), RoomLeaveDataNotify, RoomLeaveNotify, Message, bIsError);
+}
+
+template<typename LegacyNotifyType>
+void FPicoRoomInterface::BroadcastRoomNotification(const TCHAR* NotificationName, FRoomDataNotify& DataNotify, LegacyNotifyType& LegacyNotify, ppfMessageHandle Message, bool bIsError)
+{
 	if (bIsError)
 	{
 		const ppfErrorHandle Error = ppf_Message_GetError(Message);
 		const int ErrorCode = ppf_Error_GetCode(Error);
 		const FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-		UE_LOG(PicoRoom, Error, TEXT("RoomJoinNotification error! ErrorCode: %d, ErrorMessage: %s"), ErrorCode, *ErrorMessage);
-		RoomJoinNotify.Broadcast(bIsError, ErrorCode, ErrorMessage, nullptr);
+		UE_LOG(PicoRoom, Error, TEXT("%s error! ErrorCode: %d, ErrorMessage: %s"), NotificationName, ErrorCode, *ErrorMessage);
+		NotificationRoomData.Reset();
+		DataNotify.Broadcast(bIsError, ErrorCode, ErrorMessage, NotificationRoomData);
+		LegacyNotify.Broadcast(bIsError, ErrorCode, ErrorMessage, nullptr);
 	}
 	else
 	{
-		UE_LOG(PicoRoom, Log, TEXT("RoomJoinNotification success!"));
-		UPico_Room* Room = NewObject<UPico_Room>();
-		Room->InitParams(ppf_Message_GetRoom(Message));
-		RoomJoinNotify.Broadcast(bIsError, 0, FString(), Room);
+		UE_LOG(PicoRoom, Verbose, TEXT("%s success!"), NotificationName);
+		NotificationRoomData.InitParams(ppf_Message_GetRoom(Message));
+		BroadcastRoomData(DataNotify, LegacyNotify, NotificationRoomData);
 	}
 }
 
-void FPicoRoomInterface::OnRoomLeaveNotification(ppfMessageHandle Message, bool bIsError)
+template<typename LegacyNotifyType>
+void FPicoRoomInterface::BroadcastRoomData(FRoomDataNotify& DataNotify, LegacyNotifyType& LegacyNotify, const FPicoRoomData& RoomData)
 {
-	UE_LOG(PicoRoom, Log, TEXT("FPicoRoomInterface::OnRoomLeaveNotification"));
-	if (bIsError)
+	DataNotify.Broadcast(false, 0, FString(), RoomData);
+
+	// The UPico_Room graph (room, datastore, owner, user array and one object per user) is only built for object based listeners.
+	if (LegacyNotify.IsBound())
 	{
-		const ppfErrorHandle Error = ppf_Message_GetError(Message);
-		const int ErrorCode = ppf_Error_GetCode(Error);
-		const FString ErrorMessage = UTF8_TO_TCHAR(ppf_Error_GetMessage(Error));
-		UE_LOG(PicoRoom, Error, TEXT("RoomLeaveNotification error! ErrorCode: %d, ErrorMessage: %s"), ErrorCode, *ErrorMessage);
-		RoomUpdateNotify.Broadcast(bIsError, ErrorCode, ErrorMessage, nullptr);
+		LegacyNotify.Broadcast(false, 0, FString(), CreateRoomObject(RoomData));
 	}
-	else
+}
+
+UPico_Room* FPicoRoomInterface::CreateRoomObject(const FPicoRoomData& RoomData)
+{
+	UPico_Room* Room = NewObject<UPico_Room>();
+	Room->InitParams(RoomData);
+	FOnlineSubsystemPico::RecordResultObjects(RoomData.GetWrapperObjectCount());
+	return Room;
+}
+
+void FPicoRoomInterface::SimulateRoomUpdates(int32 NumUpdates, int32 NumUsers, bool bObjectListener)
+{
+	// Private stand-ins for the live delegates, so game listeners don't receive the synthetic rooms.
+	FRoomDataNotify SimulatedDataNotify;
+	FRoomUpdateNotify SimulatedNotify;
+	SimulatedDataNotify.AddLambda([](bool, int, const FString&, const FPicoRoomData&) {});
+	if (bObjectListener)
+	{
+		SimulatedNotify.AddLambda([](bool, int, const FString&, UPico_Room*) {});
+	}
+
+	FPicoRoomData RoomData;
+	RoomData.ID = 1;
+	RoomData.RoomID = TEXT("1");
+	RoomData.RoomName = TEXT("SimulatedRoom");
+	RoomData.RoomType = ERoomType::TypePrivate;
+	RoomData.MaxUsers = FMath::Max(NumUsers, 1);
+	RoomData.Users.SetNum(NumUsers);
+	for (int32 UserIndex = 0; UserIndex < NumUsers; UserIndex++)
+	{
+		RoomData.Users[UserIndex].UserId = FString::Printf(TEXT("SimulatedUser%d"), UserIndex);
+		RoomData.Users[UserIndex].DisplayName = RoomData.Users[UserIndex].UserId;
+		RoomData.Users[UserIndex].UserPresenceStatus = EUserPresenceStatus::OnLine;
+		RoomData.Users[UserIndex].Gender = EUserGender::Unknow;
+	}
+	if (NumUsers > 0)
+	{
+		RoomData.Owner = RoomData.Users[0];
+	}
+	RoomData.PlayerNumber = NumUsers;
+
+	for (int32 Update = 0; Update < NumUpdates; Update++)
 	{
-		UE_LOG(PicoRoom, Log, TEXT("RoomLeaveNotification success!"));
-		UPico_Room* Room = NewObject<UPico_Room>();
-		Room->InitParams(ppf_Message_GetRoom(Message));
-		RoomUpdateNotify.Broadcast(bIsError, 0, FString(), Room);
+		// A typical busy room update: one datastore value changes.
+		RoomData.DataStore.Add(TEXT("tick"), FString::FromInt(Update));
+		BroadcastRoomData(SimulatedDataNotify, SimulatedNotify, RoomData);
 	}
 }
 
@@ -1038,9 +1076,177 @@ ppfRoomMembershipLockStatus FPicoRoomInterface::GetppfRoomMembershipLockStatus(E
 
 
 
+namespace
+{
+	ERoomJoinPolicy ToRoomJoinPolicy(ppfRoomJoinPolicy ppfRoomJP)
+	{
+		switch (ppfRoomJP)
+		{
+		case ppfRoom_JoinPolicyNone:
+			return ERoomJoinPolicy::JoinPolicyNone;
+		case ppfRoom_JoinPolicyEveryone:
+			return ERoomJoinPolicy::JoinPolicyEveryone;
+		case ppfRoom_JoinPolicyFriendsOfMembers:
+			return ERoomJoinPolicy::JoinPolicyFriendsOfMembers;
+		case ppfRoom_JoinPolicyFriendsOfOwner:
+			return ERoomJoinPolicy::JoinPolicyFriendsOfOwner;
+		case ppfRoom_JoinPolicyInvitedUsers:
+			return ERoomJoinPolicy::JoinPolicyInvitedUsers;
+		default:
+			return ERoomJoinPolicy::JoinPolicyUnknown;
+		}
+	}
+
+	ERoomJoinabilit ToRoomJoinability(ppfRoomJoinability ppfRoomJoin)
+	{
+		switch (ppfRoomJoin)
+		{
+		case ppfRoom_JoinabilityAreIn:
+			return ERoomJoinabilit::JoinabilityAreIn;
+		case ppfRoom_JoinabilityAreKicked:
+			return ERoomJoinabilit::JoinabilityAreKicked;
+		case ppfRoom_JoinabilityCanJoin:
+			return ERoomJoinabilit::JoinabilityCanJoin;
+		case ppfRoom_JoinabilityIsFull:
+			return ERoomJoinabilit::JoinabilityIsFull;
+		case ppfRoom_JoinabilityNoViewer:
+			return ERoomJoinabilit::JoinabilityNoViewer;
+		case ppfRoom_JoinabilityPolicyPrevents:
+			return ERoomJoinabilit::JoinabilityPolicyPrevents;
+		default:
+			return ERoomJoinabilit::JoinabilityUnknown;
+		}
+	}
+
+	ERoomType ToRoomType(ppfRoomType ppfRT)
+	{
+		switch (ppfRT)
+		{
+		case ppfRoom_TypeMatchmaking:
+			return ERoomType::TypeMatchmaking;
+		case ppfRoom_TypeModerated:
+			return ERoomType::TypeModerated;
+		case ppfRoom_TypePrivate:
+			return ERoomType::TypePrivate;
+		default:
+			return ERoomType::TypeUnknown;
+		}
+	}
+
+	/** Overwrites Out with a UTF-8 string from the SDK, keeping its buffer when it is large enough. */
+	void AssignUtf8(FString& Out, const char* Utf8)
+	{
+		Out.Reset();
+		if (Utf8 && *Utf8)
+		{
+			FUTF8ToTCHAR Converted(Utf8);
+			Out.AppendChars(Converted.Get(), Converted.Length());
+		}
+	}
+
+	void InitUserInfo(FPicoUserInfo& UserInfo, ppfUserHandle UserHandle)
+	{
+		if (UserHandle == nullptr)
+		{
+			UserInfo = FPicoUserInfo();
+			UserInfo.UserPresenceStatus = EUserPresenceStatus::Unknow;
+			UserInfo.Gender = EUserGender::Unknow;
+			return;
+		}
+		AssignUtf8(UserInfo.UserId, ppf_User_GetID(UserHandle));
+		AssignUtf8(UserInfo.DisplayName, ppf_User_GetDisplayName(UserHandle));
+		AssignUtf8(UserInfo.InviteToken, ppf_User_GetInviteToken(UserHandle));
+		AssignUtf8(UserInfo.ImageUrl, ppf_User_GetImageUrl(UserHandle));
+		AssignUtf8(UserInfo.SmallImageUrl, ppf_User_GetSmallImageUrl(UserHandle));
+		AssignUtf8(UserInfo.PresencePackage, ppf_User_GetPresencePackage(UserHandle));
+		AssignUtf8(UserInfo.PresenceStr, ppf_User_GetPresence(UserHandle));
+		AssignUtf8(UserInfo.PresenceDeeplinkMessage, ppf_User_GetPresenceDeeplinkMessage(UserHandle));
+		AssignUtf8(UserInfo.PresenceDestinationApiName, ppf_User_GetPresenceDestinationApiName(UserHandle));
+		AssignUtf8(UserInfo.PresenceLobbySessionId, ppf_User_GetPresenceLobbySessionId(UserHandle));
+		AssignUtf8(UserInfo.PresenceMatchSessionId, ppf_User_GetPresenceMatchSessionId(UserHandle));
+		AssignUtf8(UserInfo.PresenceExtra, ppf_User_GetPresenceExtra(UserHandle));
+		const ppfUserPresenceStatus PresenceStatus = ppf_User_GetPresenceStatus(UserHandle);
+		UserInfo.UserPresenceStatus = PresenceStatus == ppfUserPresenceStatus_OnLine ? EUserPresenceStatus::OnLine
+			: PresenceStatus == ppfUserPresenceStatus_OffLine ? EUserPresenceStatus::OffLine
+			: EUserPresenceStatus::Unknow;
+		const ppfGender Gender = ppf_User_GetGender(UserHandle);
+		UserInfo.Gender = Gender == ppfGender_Male ? EUserGender::Male
+			: Gender == ppfGender_Female ? EUserGender::Female
+			: EUserGender::Unknow;
+	}
+}
+
+void FPicoRoomData::InitParams(ppfRoomHandle InRoomHandle)
+{
+	ID = ppf_Room_GetID(InRoomHandle);
+	RoomID.Reset();
+	RoomID.Appendf(TEXT("%llu"), ID);
+	AssignUtf8(RoomName, ppf_Room_GetName(InRoomHandle));
+	AssignUtf8(Description, ppf_Room_GetDescription(InRoomHandle));
+	bIsMembershipLocked = ppf_Room_GetIsMembershipLocked(InRoomHandle);
+	JoinPolicy = ToRoomJoinPolicy(ppf_Room_GetJoinPolicy(InRoomHandle));
+	Joinability = ToRoomJoinability(ppf_Room_GetJoinability(InRoomHandle));
+	RoomType = ToRoomType(ppf_Room_GetType(InRoomHandle));
+	MaxUsers = ppf_Room_GetMaxUsers(InRoomHandle);
+	PlayerNumber = ppf_Room_GetPlayerNumber(InRoomHandle);
+
+	InitUserInfo(Owner, ppf_Room_GetOwner(InRoomHandle));
+
+	// Resize in place so the user entries and their strings keep their buffers between updates.
+	ppfUserArrayHandle UserArrayHandle = ppf_Room_GetUsers(InRoomHandle);
+	const int32 NumUsers = UserArrayHandle ? static_cast<int32>(ppf_UserArray_GetSize(UserArrayHandle)) : 0;
+	Users.SetNum(NumUsers, false);
+	for (int32 UserIndex = 0; UserIndex < NumUsers; UserIndex++)
+	{
+		InitUserInfo(Users[UserIndex], ppf_UserArray_GetElement(UserArrayHandle, UserIndex));
+	}
+
+	// Room datastores rarely change their keys, only their values. While the keys come back in the order they were
+	// added the values are overwritten in place, otherwise the map is rebuilt.
+	ppfDataStoreHandle DataStoreHandle = ppf_Room_GetDataStore(InRoomHandle);
+	const int32 NumKeys = DataStoreHandle ? static_cast<int32>(ppf_DataStore_GetNumKeys(DataStoreHandle)) : 0;
+	bool bSameKeys = DataStore.Num() == NumKeys;
+	int32 KeyIndex = 0;
+	for (auto It = DataStore.CreateIterator(); bSameKeys && It; ++It, ++KeyIndex)
+	{
+		const char* Key = ppf_DataStore_GetKey(DataStoreHandle, KeyIndex);
+		bSameKeys = FCString::Strcmp(*It.Key(), UTF8_TO_TCHAR(Key)) == 0;
+		if (bSameKeys)
+		{
+			AssignUtf8(It.Value(), ppf_DataStore_GetValue(DataStoreHandle, Key));
+		}
+	}
+	if (!bSameKeys)
+	{
+		DataStore.Reset();
+		for (KeyIndex = 0; KeyIndex < NumKeys; KeyIndex++)
+		{
+			const char* Key = ppf_DataStore_GetKey(DataStoreHandle, KeyIndex);
+			DataStore.Add(UTF8_TO_TCHAR(Key), UTF8_TO_TCHAR(ppf_DataStore_GetValue(DataStoreHandle, Key)));
+		}
+	}
+}
+
+void FPicoRoomData::Reset()
+{
+	ID = 0;
+	RoomID.Reset();
+	RoomName.Reset();
+	Description.Reset();
+	Owner = FPicoUserInfo();
+	Users.Reset();
+	DataStore.Reset();
+	bIsMembershipLocked = false;
+	JoinPolicy = ERoomJoinPolicy::JoinPolicyUnknown;
+	Joinability = ERoomJoinabilit::JoinabilityUnknown;
+	RoomType = ERoomType::TypeUnknown;
+	MaxUsers = 0;
+	PlayerNumber = 0;
+}
+
 void UPico_Room::InitParams(ppfRoomHandle InRoomHandle)
 {
-	UE_LOG(PicoRoom, Log, TEXT("Pico room init!"));
+	UE_LOG(PicoRoom, Verbose, TEXT("Pico room init!"));
 	DataStore = NewObject<UPico_DataStore>(this);
 	DataStore->InitParams(ppf_Room_GetDataStore(InRoomHandle));
 	Owner = NewObject<UPico_User>(this);
@@ -1052,68 +1258,31 @@ void UPico_Room::InitParams(ppfRoomHandle InRoomHandle)
 	RoomID = FString::Printf(TEXT("%llu"), ID);
 	RoomName = UTF8_TO_TCHAR(ppf_Room_GetName(InRoomHandle));
 	bIsMembershipLocked = ppf_Room_GetIsMembershipLocked(InRoomHandle);
-	ppfRoomJoinPolicy ppfRoomJP = ppf_Room_GetJoinPolicy(InRoomHandle);
-	switch (ppfRoomJP)
-	{
-	case ppfRoom_JoinPolicyNone:
-		RoomJoinPolicy = ERoomJoinPolicy::JoinPolicyNone;
-		break;
-	case ppfRoom_JoinPolicyEveryone:
-		RoomJoinPolicy = ERoomJoinPolicy::JoinPolicyEveryone;
-		break;
-	case ppfRoom_JoinPolicyFriendsOfMembers:
-		RoomJoinPolicy = ERoomJoinPolicy::JoinPolicyFriendsOfMembers;
-		break;
-	case ppfRoom_JoinPolicyFriendsOfOwner:
-		RoomJoinPolicy = ERoomJoinPolicy::JoinPolicyFriendsOfOwner;
-		break;
-	case ppfRoom_JoinPolicyInvitedUsers:
-		RoomJoinPolicy = ERoomJoinPolicy::JoinPolicyInvitedUsers;
-		break;
-	default:
-		break;
-	}
-	ppfRoomJoinability ppfRoomJoin = ppf_Room_GetJoinability(InRoomHandle);
-	switch (ppfRoomJoin)
-	{
-	case ppfRoom_JoinabilityAreIn:
-		RoomJoinabilit = ERoomJoinabilit::JoinabilityAreIn;
-		break;
-	case ppfRoom_JoinabilityAreKicked:
-		RoomJoinabilit = ERoomJoinabilit::JoinabilityAreKicked;
-		break;
-	case ppfRoom_JoinabilityCanJoin:
-		RoomJoinabilit = ERoomJoinabilit::JoinabilityCanJoin;
-		break;
-	case ppfRoom_JoinabilityIsFull:
-		RoomJoinabilit = ERoomJoinabilit::JoinabilityIsFull;
-		break;
-	case ppfRoom_JoinabilityNoViewer:
-		RoomJoinabilit = ERoomJoinabilit::JoinabilityNoViewer;
-		break;
-	case ppfRoom_JoinabilityPolicyPrevents:
-		RoomJoinabilit = ERoomJoinabilit::JoinabilityPolicyPrevents;
-		break;
-	default:
-		break;
-	}
+	RoomJoinPolicy = ToRoomJoinPolicy(ppf_Room_GetJoinPolicy(InRoomHandle));
+	RoomJoinabilit = ToRoomJoinability(ppf_Room_GetJoinability(InRoomHandle));
 	MaxUserNum = ppf_Room_GetMaxUsers(InRoomHandle);
 	PlayerNum = ppf_Room_GetPlayerNumber(InRoomHandle);
-	ppfRoomType ppfRT = ppf_Room_GetType(InRoomHandle);
-	switch (ppfRT)
-	{
-	case ppfRoom_TypeMatchmaking:
-		RoomType = ERoomType::TypeMatchmaking;
-		break;
-	case ppfRoom_TypeModerated:
-		RoomType = ERoomType::TypeModerated;
-		break;
-	case ppfRoom_TypePrivate:
-		RoomType = ERoomType::TypePrivate;
-		break;
-	default:
-		break;
-	}
+	RoomType = ToRoomType(ppf_Room_GetType(InRoomHandle));
+}
+
+void UPico_Room::InitParams(const FPicoRoomData& InRoomData)
+{
+	DataStore = NewObject<UPico_DataStore>(this);
+	DataStore->InitParams(InRoomData.DataStore);
+	Owner = NewObject<UPico_User>(this);
+	Owner->InitParams(InRoomData.Owner);
+	Users = NewObject<UPico_UserArray>(this);
+	Users->InitParams(InRoomData.Users);
+	Description = InRoomData.Description;
+	ID = InRoomData.ID;
+	RoomID = InRoomData.RoomID;
+	RoomName = InRoomData.RoomName;
+	bIsMembershipLocked = InRoomData.bIsMembershipLocked;
+	RoomJoinPolicy = InRoomData.JoinPolicy;
+	RoomJoinabilit = InRoomData.Joinability;
+	MaxUserNum = InRoomData.MaxUsers;
+	PlayerNum = InRoomData.PlayerNumber;
+	RoomType = InRoomData.RoomType;
 }
 
 UPico_DataStore* UPico_Room::GetDataStore()
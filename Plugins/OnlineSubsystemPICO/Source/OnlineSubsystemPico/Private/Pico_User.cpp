@@ -226,7 +226,7 @@ bool UOnlinePicoUserFunction::GetOrgScopedID(UObject* WorldContextObject, const
 
 void UPico_User::InitParams(ppfUser* ppfUserHandle)
 {
-    UE_LOG(PicoUser, Log, TEXT("UPico_User::InitParams"));
+    UE_LOG(PicoUser, Verbose, TEXT("UPico_User::InitParams"));
 
     DisplayName = UTF8_TO_TCHAR(ppf_User_GetDisplayName(ppfUserHandle));
     ImageUrl = UTF8_TO_TCHAR(ppf_User_GetImageUrl(ppfUserHandle));
@@ -265,6 +265,32 @@ void UPico_User::InitParams(ppfUser* ppfUserHandle)
 
 }
 
+void UPico_User::InitParams(const FString& InID, const FString& InDisplayName, const FString& InImageUrl, const FString& InSmallImageUrl)
+{
+    ID = InID;
+    DisplayName = InDisplayName;
+    ImageUrl = InImageUrl;
+    SmallImageUrl = InSmallImageUrl;
+}
+
+void UPico_User::InitParams(const FPicoUserInfo& InUserInfo)
+{
+    ID = InUserInfo.UserId;
+    DisplayName = InUserInfo.DisplayName;
+    ImageUrl = InUserInfo.ImageUrl;
+    SmallImageUrl = InUserInfo.SmallImageUrl;
+    InviteToken = InUserInfo.InviteToken;
+    PresencePackage = InUserInfo.PresencePackage;
+    UserPresenceStatus = InUserInfo.UserPresenceStatus;
+    UserGender = InUserInfo.Gender;
+    Presence = InUserInfo.PresenceStr;
+    PresenceDeeplinkMessage = InUserInfo.PresenceDeeplinkMessage;
+    PresenceDestinationApiName = InUserInfo.PresenceDestinationApiName;
+    PresenceLobbySessionId = InUserInfo.PresenceLobbySessionId;
+    PresenceMatchSessionId = InUserInfo.PresenceMatchSessionId;
+    PresenceExtra = InUserInfo.PresenceExtra;
+}
+
 FString UPico_User::GetDisplayName()
 {
     return DisplayName;
@@ -347,7 +373,7 @@ bool UPico_User::GetPresenceIsJoinable()
 
 void UPico_UserArray::InitParams(ppfUserArray* InppfUserArrayHandle)
 {
-    UE_LOG(PicoUser, Log, TEXT("UPico_UserArray::InitParams"));
+    UE_LOG(PicoUser, Verbose, TEXT("UPico_UserArray::InitParams"));
     Size = ppf_UserArray_GetSize(InppfUserArrayHandle);
     for (int32 i = 0; i < Size; i++)
     {
@@ -364,6 +390,20 @@ void UPico_UserArray::InitParams(ppfUserArray* InppfUserArrayHandle)
     }
 }
 
+void UPico_UserArray::InitParams(const TArray<FPicoUserInfo>& InUsers)
+{
+    Size = InUsers.Num();
+    UserArray.Reset(Size);
+    for (const FPicoUserInfo& User : InUsers)
+    {
+        UPico_User* ThisElement = NewObject<UPico_User>(this);
+        ThisElement->InitParams(User);
+        UserArray.Add(ThisElement);
+    }
+    bHasNextPage = false;
+    NextPageParam = FString();
+}
+
 UPico_User* UPico_UserArray::GetElement(int32 Index)
 {
     if (UserArray.IsValidIndex(Index))
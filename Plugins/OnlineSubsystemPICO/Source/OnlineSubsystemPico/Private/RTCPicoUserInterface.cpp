@@ -4,6 +4,8 @@
 #include "RTCPicoUserInterface.h"
 #include "OnlineSubsystemPicoPrivate.h"
 #include "PPF_RtcEngineInitResult.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Math/RandomStream.h"
 
 #if PLATFORM_WINDOWS
 #include <stdio.h>
@@ -11,6 +13,52 @@
 
 DEFINE_LOG_CATEGORY(RtcInterface);
 
+namespace
+{
+    /** ppfMessageType_Notification_Rtc_OnRemoteAudioPropertiesReport, decoded on the message worker. */
+    struct FDecodedRemoteAudioPropertiesReport : public FPicoDecodedMessage
+    {
+        int TotalRemoteVolume = 0;
+        TArray<int> Volumes;
+        TArray<int32> RoomIds;
+        TArray<int32> UserIds;
+        TArray<ERtcStreamIndex> StreamIndices;
+    };
+
+    ERtcStreamIndex ToStreamIndex(ppfRtcStreamIndex RtcStreamIndex)
+    {
+        if (RtcStreamIndex == ppfRtcStreamIndex_Main)
+        {
+            return ERtcStreamIndex::Main;
+        }
+        if (RtcStreamIndex == ppfRtcStreamIndex_Screen)
+        {
+            return ERtcStreamIndex::Screen;
+        }
+        return ERtcStreamIndex::None;
+    }
+
+    void DecodeRemoteAudioPropertiesReport(ppfMessageHandle Message, FPicoIdInterner& IdInterner, FDecodedRemoteAudioPropertiesReport& OutDecoded)
+    {
+        ppfRtcRemoteAudioPropertiesReportHandle Report = ppf_Message_GetRtcRemoteAudioPropertiesReport(Message);
+        const size_t InfosSize = ppf_RtcRemoteAudioPropertiesReport_GetAudioPropertiesInfosSize(Report);
+        OutDecoded.TotalRemoteVolume = ppf_RtcRemoteAudioPropertiesReport_GetTotalRemoteVolume(Report);
+        OutDecoded.Volumes.Reset(InfosSize);
+        OutDecoded.RoomIds.Reset(InfosSize);
+        OutDecoded.UserIds.Reset(InfosSize);
+        OutDecoded.StreamIndices.Reset(InfosSize);
+        for (size_t i = 0; i < InfosSize; i++)
+        {
+            auto AudioPropertiesInfos = ppf_RtcRemoteAudioPropertiesReport_GetAudioPropertiesInfos(Report, i);
+            auto StreamKey = ppf_RtcRemoteAudioPropertiesInfo_GetStreamKey(AudioPropertiesInfos);
+            OutDecoded.Volumes.Add(ppf_RtcAudioPropertyInfo_GetVolume(ppf_RtcRemoteAudioPropertiesInfo_GetAudioPropertiesInfo(AudioPropertiesInfos)));
+            OutDecoded.RoomIds.Add(IdInterner.Intern(ppf_RtcRemoteStreamKey_GetRoomId(StreamKey)));
+            OutDecoded.UserIds.Add(IdInterner.Intern(ppf_RtcRemoteStreamKey_GetUserId(StreamKey)));
+            OutDecoded.StreamIndices.Add(ToStreamIndex(ppf_RtcRemoteStreamKey_GetStreamIndex(StreamKey)));
+        }
+    }
+}
+
 FRTCPicoUserInterface::FRTCPicoUserInterface(FOnlineSubsystemPico& InSubsystem) :
     PicoSubsystem(InSubsystem)
 {
@@ -69,11 +117,25 @@ FRTCPicoUserInterface::FRTCPicoUserInterface(FOnlineSubsystemPico& InSubsystem)
     OnRemoteAudioPropertiesReportNotificationHandle =
         PicoSubsystem.GetOrAddNotify(ppfMessageType_Notification_Rtc_OnRemoteAudioPropertiesReport)
         .AddRaw(this, &FRTCPicoUserInterface::OnRemoteAudioPropertiesReportNotification);
+    FPicoIdInterner& IdInterner = PicoSubsystem.GetIdInterner();
+    PicoSubsystem.RegisterMessageDecoder(ppfMessageType_Notification_Rtc_OnRemoteAudioPropertiesReport,
+        [&IdInterner](ppfMessageHandle Message) -> TUniquePtr<FPicoDecodedMessage>
+        {
+            TUniquePtr<FDecodedRemoteAudioPropertiesReport> Decoded = MakeUnique<FDecodedRemoteAudioPropertiesReport>();
+            DecodeRemoteAudioPropertiesReport(Message, IdInterner, *Decoded);
+            return Decoded;
+        });
 
     OnLocalAudioPropertiesReportNotificationHandle =
         PicoSubsystem.GetOrAddNotify(ppfMessageType_Notification_Rtc_OnLocalAudioPropertiesReport)
         .AddRaw(this, &FRTCPicoUserInterface::OnLocalAudioPropertiesReportNotification);
 
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("RtcSpeakingStartLevel"), SpeakingStartLevel, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("RtcSpeakingStopLevel"), SpeakingStopLevel, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("RtcSpeakingHoldTime"), SpeakingHoldTime, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("RtcLevelAttackTime"), LevelAttackTime, GEngineIni);
+    GConfig->GetFloat(TEXT("OnlineSubsystemPico"), TEXT("RtcLevelReleaseTime"), LevelReleaseTime, GEngineIni);
+
     OnUserMuteAudioNotificationHandle =
         PicoSubsystem.GetOrAddNotify(ppfMessageType_Notification_Rtc_OnUserMuteAudio)
         .AddRaw(this, &FRTCPicoUserInterface::OnUserMuteAudioNotification);
@@ -577,6 +639,7 @@ void FRTCPicoUserInterface::OnLeaveRoomResult(ppfMessageHandle Message, bool bIs
     }
     auto LeaveRoomResult = ppf_Message_GetRtcLeaveRoomResult(Message);
     FString RoomId = UTF8_TO_TCHAR(ppf_RtcLeaveRoomResult_GetRoomId(LeaveRoomResult));
+    RemoveSpeakers(PicoSubsystem.GetIdInterner().Intern(ppf_RtcLeaveRoomResult_GetRoomId(LeaveRoomResult)), INDEX_NONE);
     RtcLeaveRoomCallback.Broadcast(RoomId);
 }
 
@@ -621,6 +684,8 @@ void FRTCPicoUserInterface::OnUserLeaveRoomResult(ppfMessageHandle Message, bool
         RtcUserLeaveReasonType = ERtcUserLeaveReasonType::None;
     }
     FString RoomId = UTF8_TO_TCHAR((ppf_RtcUserLeaveInfo_GetRoomId(UserLeaveInfo)));
+    FPicoIdInterner& IdInterner = PicoSubsystem.GetIdInterner();
+    RemoveSpeakers(IdInterner.Intern(ppf_RtcUserLeaveInfo_GetRoomId(UserLeaveInfo)), IdInterner.Intern(ppf_RtcUserLeaveInfo_GetUserId(UserLeaveInfo)));
     RtcUserLeaveInfoCallback.Broadcast(UserId, RtcUserLeaveReasonType, RoomId);
 }
 
@@ -762,50 +827,57 @@ void FRTCPicoUserInterface::OnAudioPlaybackDeviceChangeNotification(ppfMessageHa
 
 void FRTCPicoUserInterface::OnRemoteAudioPropertiesReportNotification(ppfMessageHandle Message, bool bIsError)
 {
-    UE_LOG(RtcInterface, Log, TEXT("FRTCPicoUserInterface::OnRemoteAudioPropertiesReportNotification!"));
+    UE_LOG(RtcInterface, Verbose, TEXT("FRTCPicoUserInterface::OnRemoteAudioPropertiesReportNotification!"));
     if (bIsError)
     {
         UE_LOG(RtcInterface, Error, TEXT("Remote audio properties report notification error!"));
         return;
     }
-    ppfRtcRemoteAudioPropertiesReportHandle RtcRemoteAudioProperitesReport = ppf_Message_GetRtcRemoteAudioPropertiesReport(Message);
-    size_t S_AudioPropertiesInfosSize = ppf_RtcRemoteAudioPropertiesReport_GetAudioPropertiesInfosSize(RtcRemoteAudioProperitesReport);
-    int TotalRemoteVolume = ppf_RtcRemoteAudioPropertiesReport_GetTotalRemoteVolume(RtcRemoteAudioProperitesReport);
+    const FDecodedRemoteAudioPropertiesReport* Report = PicoSubsystem.GetDecodedMessage<FDecodedRemoteAudioPropertiesReport>(Message);
+    FDecodedRemoteAudioPropertiesReport DecodedHere;
+    if (!Report)
+    {
+        // No decoder was registered yet when the message was popped, decode it here.
+        DecodeRemoteAudioPropertiesReport(Message, PicoSubsystem.GetIdInterner(), DecodedHere);
+        Report = &DecodedHere;
+    }
+    const int32 InfosSize = Report->Volumes.Num();
+
+    const uint64 StartCycles = FPlatformTime::Cycles64();
+    const double Now = FPlatformTime::Seconds();
+    for (int32 i = 0; i < InfosSize; i++)
+    {
+        UpdateSpeakerState(Report->RoomIds[i], Report->UserIds[i], Report->StreamIndices[i], Report->Volumes[i], false, Now);
+    }
+    FinishSpeakerReport(false, Now);
+    SpeakerReportCycles += FPlatformTime::Cycles64() - StartCycles;
+    SpeakerReportsProcessed++;
+
+    // The per-report arrays are only built for listeners of the raw report.
+    if (!RtcRemoteAudioPropertiesReportCallback.IsBound())
+    {
+        return;
+    }
+    FPicoIdInterner& IdInterner = PicoSubsystem.GetIdInterner();
+    int TotalRemoteVolume = Report->TotalRemoteVolume;
     TArray<FString> RoomIdArray;
     TArray<FString> UserIdArray;
-    TArray<ERtcStreamIndex> StreamIndexArray;
-    TArray<int> VolumeArray;
-    for (size_t i = 0; i < S_AudioPropertiesInfosSize; i++)
+    RoomIdArray.Reserve(InfosSize);
+    UserIdArray.Reserve(InfosSize);
+    for (int32 i = 0; i < InfosSize; i++)
     {
-        auto AudioPropertiesInfos = ppf_RtcRemoteAudioPropertiesReport_GetAudioPropertiesInfos(RtcRemoteAudioProperitesReport, i);
-        auto AudioPropertiesInfo = ppf_RtcRemoteAudioPropertiesInfo_GetAudioPropertiesInfo(AudioPropertiesInfos);
-        int Volume = ppf_RtcAudioPropertyInfo_GetVolume(AudioPropertiesInfo);
-        VolumeArray.Add(Volume);
-        auto StreamKey = ppf_RtcRemoteAudioPropertiesInfo_GetStreamKey(AudioPropertiesInfos);
-        FString RoomId = UTF8_TO_TCHAR(ppf_RtcRemoteStreamKey_GetRoomId(StreamKey));
-        RoomIdArray.Add(RoomId);
-        FString UserId = UTF8_TO_TCHAR(ppf_RtcRemoteStreamKey_GetUserId(StreamKey));
-        UserIdArray.Add(UserId);
-        ppfRtcStreamIndex RtcStreamIndex = ppf_RtcRemoteStreamKey_GetStreamIndex(StreamKey);
-        ERtcStreamIndex StreamIndex = ERtcStreamIndex::None;
-        if (RtcStreamIndex == ppfRtcStreamIndex_Main)
-        {
-            StreamIndex = ERtcStreamIndex::Main;
-        }
-        else if (RtcStreamIndex == ppfRtcStreamIndex_Screen)
-        {
-            StreamIndex = ERtcStreamIndex::Screen;
-        }
-        StreamIndexArray.Add(StreamIndex);
-
+        RoomIdArray.Add(IdInterner.Resolve(Report->RoomIds[i]));
+        UserIdArray.Add(IdInterner.Resolve(Report->UserIds[i]));
     }
-    UE_LOG(RtcInterface, Log, TEXT("Remote audio properties broadcast!"));
+    const TArray<int>& VolumeArray = Report->Volumes;
+    const TArray<ERtcStreamIndex>& StreamIndexArray = Report->StreamIndices;
+    UE_LOG(RtcInterface, Verbose, TEXT("Remote audio properties broadcast!"));
     RtcRemoteAudioPropertiesReportCallback.Broadcast(TotalRemoteVolume, VolumeArray, RoomIdArray, UserIdArray, StreamIndexArray);
 }
 
 void FRTCPicoUserInterface::OnLocalAudioPropertiesReportNotification(ppfMessageHandle Message, bool bIsError)
 {
-    UE_LOG(RtcInterface, Log, TEXT("FRTCPicoUserInterface::OnLocalAudioPropertiesReportNotification!"));
+    UE_LOG(RtcInterface, Verbose, TEXT("FRTCPicoUserInterface::OnLocalAudioPropertiesReportNotification!"));
     if (bIsError)
     {
         UE_LOG(RtcInterface, Error, TEXT("Local audio properties report notification error!"));
@@ -813,28 +885,296 @@ void FRTCPicoUserInterface::OnLocalAudioPropertiesReportNotification(ppfMessageH
     }
     auto RtcLocalAudioProperitesReport = ppf_Message_GetRtcLocalAudioPropertiesReport(Message);
     size_t S_AudioPropertiesInfosSize = ppf_RtcLocalAudioPropertiesReport_GetAudioPropertiesInfosSize(RtcLocalAudioProperitesReport);
+    const bool bBuildArrays = RtcLocalAudioPropertiesReportCallback.IsBound();
     TArray<ERtcStreamIndex> StreamIndexArray;
     TArray<int> VolumeArray;
+    const double Now = FPlatformTime::Seconds();
     for (size_t i = 0; i < S_AudioPropertiesInfosSize; i++)
     {
         auto AudioPropertiesInfos = ppf_RtcLocalAudioPropertiesReport_GetAudioPropertiesInfos(RtcLocalAudioProperitesReport, i);
-        ppfRtcStreamIndex RtcStreamIndex = ppf_RtcLocalAudioPropertiesInfo_GetStreamIndex(AudioPropertiesInfos);
-        ERtcStreamIndex StreamIndex = ERtcStreamIndex::None;
-        if (RtcStreamIndex == ppfRtcStreamIndex_Main)
+        ERtcStreamIndex StreamIndex = ToStreamIndex(ppf_RtcLocalAudioPropertiesInfo_GetStreamIndex(AudioPropertiesInfos));
+
+        auto AudioPropertyInfo = ppf_RtcLocalAudioPropertiesInfo_GetAudioPropertyInfo(AudioPropertiesInfos);
+        int Volume = ppf_RtcAudioPropertyInfo_GetVolume(AudioPropertyInfo);
+        UpdateSpeakerState(INDEX_NONE, INDEX_NONE, StreamIndex, Volume, true, Now);
+        if (bBuildArrays)
         {
-            StreamIndex = ERtcStreamIndex::Main;
+            StreamIndexArray.Add(StreamIndex);
+            VolumeArray.Add(Volume);
         }
-        else if (RtcStreamIndex == ppfRtcStreamIndex_Screen)
+    }
+    FinishSpeakerReport(true, Now);
+    if (bBuildArrays)
+    {
+        RtcLocalAudioPropertiesReportCallback.Broadcast(StreamIndexArray, VolumeArray);
+    }
+}
+
+int32 FRTCPicoUserInterface::SubscribeSpeakingState(float LevelUpdateRate, FRtcSpeakingChanged OnSpeakingChanged, FRtcSpeakerLevels OnLevels)
+{
+    FSpeakingSubscription& Subscription = SpeakingSubscriptions.AddDefaulted_GetRef();
+    Subscription.Id = NextSpeakingSubscriptionId++;
+    Subscription.MinLevelInterval = LevelUpdateRate > 0.f ? 1.0 / LevelUpdateRate : 0.0;
+    Subscription.OnSpeakingChanged = MoveTemp(OnSpeakingChanged);
+    if (LevelUpdateRate > 0.f)
+    {
+        Subscription.OnLevels = MoveTemp(OnLevels);
+    }
+    return Subscription.Id;
+}
+
+void FRTCPicoUserInterface::UnsubscribeSpeakingState(int32 SubscriptionId)
+{
+    SpeakingSubscriptions.RemoveAll([SubscriptionId](const FSpeakingSubscription& Subscription)
         {
-            StreamIndex = ERtcStreamIndex::Screen;
+            return Subscription.Id == SubscriptionId;
+        });
+}
+
+const FString& FRTCPicoUserInterface::ResolveRtcId(int32 InternedId) const
+{
+    static const FString LocalUser;
+    return InternedId == INDEX_NONE ? LocalUser : PicoSubsystem.GetIdInterner().Resolve(InternedId);
+}
+
+void FRTCPicoUserInterface::GetSpeakingStateStats(int64& OutReports, double& OutAverageMicroseconds) const
+{
+    OutReports = SpeakerReportsProcessed;
+    OutAverageMicroseconds = SpeakerReportsProcessed > 0 ? FPlatformTime::ToSeconds64(SpeakerReportCycles) * 1000000.0 / SpeakerReportsProcessed : 0.0;
+}
+
+uint64 FRTCPicoUserInterface::GetSpeakerKey(int32 RoomId, int32 UserId, ERtcStreamIndex StreamIndex, bool bIsLocal)
+{
+    // Interned IDs are small non-negative indices; INDEX_NONE only occurs for the local user.
+    const uint64 Room = static_cast<uint32>(RoomId);
+    const uint64 User = static_cast<uint32>(UserId) & 0x3fffffff;
+    return (Room << 32) | (User << 2) | (uint64(StreamIndex == ERtcStreamIndex::Screen) << 1) | uint64(bIsLocal);
+}
+
+void FRTCPicoUserInterface::UpdateSpeakerState(int32 RoomId, int32 UserId, ERtcStreamIndex StreamIndex, int32 Volume, bool bIsLocal, double Now)
+{
+    const uint64 Key = GetSpeakerKey(RoomId, UserId, StreamIndex, bIsLocal);
+    int32 SpeakerIndex;
+    if (const int32* ExistingIndex = SpeakerIndices.Find(Key))
+    {
+        SpeakerIndex = *ExistingIndex;
+    }
+    else
+    {
+        SpeakerIndex = SpeakerStates.AddDefaulted();
+        FRtcSpeakerState& NewState = SpeakerStates[SpeakerIndex];
+        NewState.RoomId = RoomId;
+        NewState.UserId = UserId;
+        NewState.StreamIndex = StreamIndex;
+        NewState.bIsLocal = bIsLocal;
+        SpeakerIndices.Add(Key, SpeakerIndex);
+    }
+    SpeakerStates[SpeakerIndex].ReportGeneration = bIsLocal ? LocalReportGeneration : RemoteReportGeneration;
+    StepSpeakerState(SpeakerIndex, Volume, Now);
+}
+
+void FRTCPicoUserInterface::StepSpeakerState(int32 SpeakerIndex, int32 Volume, double Now)
+{
+    FRtcSpeakerState& State = SpeakerStates[SpeakerIndex];
+    const float Target = FMath::Clamp(Volume / 255.f, 0.f, 1.f);
+    const float DeltaTime = State.LastReportTime > 0.0 ? static_cast<float>(FMath::Clamp(Now - State.LastReportTime, 0.0, 1.0)) : 1.f;
+    const float TimeConstant = Target > State.SmoothedLevel ? LevelAttackTime : LevelReleaseTime;
+    const float Alpha = TimeConstant > 0.f ? 1.f - FMath::Exp(-DeltaTime / TimeConstant) : 1.f;
+    const float PreviousLevel = State.SmoothedLevel;
+
+    State.Volume = Volume;
+    State.SmoothedLevel += (Target - State.SmoothedLevel) * Alpha;
+    State.LastReportTime = Now;
+    if (!FMath::IsNearlyEqual(PreviousLevel, State.SmoothedLevel, 1.e-3f))
+    {
+        bSpeakerLevelsChanged = true;
+    }
+
+    // Hysteresis between the start and stop levels, plus a hold time so pauses between words don't flicker.
+    if (State.SmoothedLevel >= SpeakingStopLevel)
+    {
+        State.LastLoudTime = Now;
+    }
+    const bool bWasSpeaking = State.bIsSpeaking;
+    if (!State.bIsSpeaking && State.SmoothedLevel >= SpeakingStartLevel)
+    {
+        State.bIsSpeaking = true;
+    }
+    else if (State.bIsSpeaking && Now - State.LastLoudTime >= SpeakingHoldTime)
+    {
+        State.bIsSpeaking = false;
+    }
+    if (State.bIsSpeaking != bWasSpeaking)
+    {
+        State.SpeakingChangedTime = Now;
+        SpeakingEdges.Add(SpeakerIndex);
+    }
+}
+
+void FRTCPicoUserInterface::FinishSpeakerReport(bool bIsLocal, double Now)
+{
+    // Streams missing from the report have gone quiet.
+    uint32& Generation = bIsLocal ? LocalReportGeneration : RemoteReportGeneration;
+    for (int32 SpeakerIndex = 0; SpeakerIndex < SpeakerStates.Num(); SpeakerIndex++)
+    {
+        const FRtcSpeakerState& State = SpeakerStates[SpeakerIndex];
+        if (State.bIsLocal == bIsLocal && State.ReportGeneration != Generation)
+        {
+            StepSpeakerState(SpeakerIndex, 0, Now);
         }
+    }
+    Generation++;
 
-        auto AudioPropertyInfo = ppf_RtcLocalAudioPropertiesInfo_GetAudioPropertyInfo(AudioPropertiesInfos);
-        int Volume = ppf_RtcAudioPropertyInfo_GetVolume(AudioPropertyInfo);
-        StreamIndexArray.Add(StreamIndex);
-        VolumeArray.Add(Volume);
+    if (bSpeakerLevelsChanged)
+    {
+        SpeakerLevelsVersion++;
+        bSpeakerLevelsChanged = false;
+    }
+
+    if (SpeakingEdges.Num() > 0)
+    {
+        TArray<FRtcSpeakerState, TInlineAllocator<8>> ChangedStates;
+        for (int32 SpeakerIndex : SpeakingEdges)
+        {
+            ChangedStates.Add(SpeakerStates[SpeakerIndex]);
+        }
+        SpeakingEdges.Reset();
+        BroadcastSpeakingChanged(ChangedStates);
+    }
+
+    // Looked up by ID for every call, a callback may have added or removed subscriptions.
+    TArray<int32, TInlineAllocator<8>> SubscriptionIds;
+    for (const FSpeakingSubscription& Subscription : SpeakingSubscriptions)
+    {
+        SubscriptionIds.Add(Subscription.Id);
+    }
+    for (int32 SubscriptionId : SubscriptionIds)
+    {
+        FSpeakingSubscription* Subscription = SpeakingSubscriptions.FindByPredicate([SubscriptionId](const FSpeakingSubscription& Candidate)
+            {
+                return Candidate.Id == SubscriptionId;
+            });
+        if (Subscription && Subscription->OnLevels.IsBound() && Subscription->LastLevelsVersion != SpeakerLevelsVersion
+            && Now - Subscription->LastLevelTime >= Subscription->MinLevelInterval)
+        {
+            Subscription->LastLevelTime = Now;
+            Subscription->LastLevelsVersion = SpeakerLevelsVersion;
+            const FRtcSpeakerLevels OnLevels = Subscription->OnLevels;
+            OnLevels.Execute(SpeakerStates);
+        }
+    }
+}
+
+void FRTCPicoUserInterface::BroadcastSpeakingChanged(TArrayView<const FRtcSpeakerState> ChangedStates)
+{
+    // Copied, so a callback that unsubscribes or subscribes does not move the list from under the loop.
+    TArray<FRtcSpeakingChanged, TInlineAllocator<4>> Callbacks;
+    for (const FSpeakingSubscription& Subscription : SpeakingSubscriptions)
+    {
+        if (Subscription.OnSpeakingChanged.IsBound())
+        {
+            Callbacks.Add(Subscription.OnSpeakingChanged);
+        }
+    }
+    for (const FRtcSpeakingChanged& Callback : Callbacks)
+    {
+        for (const FRtcSpeakerState& State : ChangedStates)
+        {
+            Callback.ExecuteIfBound(State);
+        }
+    }
+}
+
+void FRTCPicoUserInterface::RemoveSpeakers(int32 RoomId, int32 UserId)
+{
+    // Subscribers hear about it once the table is consistent again.
+    TArray<FRtcSpeakerState, TInlineAllocator<8>> StoppedStates;
+    for (int32 SpeakerIndex = SpeakerStates.Num() - 1; SpeakerIndex >= 0; SpeakerIndex--)
+    {
+        FRtcSpeakerState& State = SpeakerStates[SpeakerIndex];
+        if (State.bIsLocal || State.RoomId != RoomId || (UserId != INDEX_NONE && State.UserId != UserId))
+        {
+            continue;
+        }
+        if (State.bIsSpeaking)
+        {
+            State.bIsSpeaking = false;
+            State.SmoothedLevel = 0.f;
+            State.SpeakingChangedTime = FPlatformTime::Seconds();
+            StoppedStates.Add(State);
+        }
+        SpeakerIndices.Remove(GetSpeakerKey(State.RoomId, State.UserId, State.StreamIndex, State.bIsLocal));
+        SpeakerStates.RemoveAtSwap(SpeakerIndex, 1, false);
+        if (SpeakerStates.IsValidIndex(SpeakerIndex))
+        {
+            const FRtcSpeakerState& Moved = SpeakerStates[SpeakerIndex];
+            SpeakerIndices.Add(GetSpeakerKey(Moved.RoomId, Moved.UserId, Moved.StreamIndex, Moved.bIsLocal), SpeakerIndex);
+        }
     }
-    RtcLocalAudioPropertiesReportCallback.Broadcast(StreamIndexArray, VolumeArray);
+    SpeakerLevelsVersion++;
+    BroadcastSpeakingChanged(StoppedStates);
+}
+
+double FRTCPicoUserInterface::RunSpeakingStateBenchmark(int32 NumSpeakers, int32 NumReports)
+{
+    // Not interned, the interner never forgets an ID. The table is private to the benchmark, so the IDs only have to
+    // differ from each other; the base keeps them clear of INDEX_NONE and within GetSpeakerKey's 30 user bits.
+    const int32 FakeIdBase = 0x20000000;
+    const int32 RoomId = FakeIdBase;
+    TArray<int32> UserIds;
+    for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; SpeakerIndex++)
+    {
+        UserIds.Add(FakeIdBase + 1 + SpeakerIndex);
+    }
+
+    // Run on an empty table with a single UI-like subscriber, so real speakers and subscribers are left alone.
+    TArray<FRtcSpeakerState> SavedStates = MoveTemp(SpeakerStates);
+    TMap<uint64, int32> SavedIndices = MoveTemp(SpeakerIndices);
+    TArray<FSpeakingSubscription> SavedSubscriptions = MoveTemp(SpeakingSubscriptions);
+    const uint32 SavedGeneration = RemoteReportGeneration;
+    SpeakerStates.Reset();
+    SpeakerIndices.Reset();
+    SpeakingSubscriptions.Reset();
+    int32 SpeakingChanges = 0;
+    float LevelSum = 0.f;
+    SubscribeSpeakingState(10.f,
+        FRtcSpeakingChanged::CreateLambda([&SpeakingChanges](const FRtcSpeakerState&) { SpeakingChanges++; }),
+        FRtcSpeakerLevels::CreateLambda([&LevelSum](TArrayView<const FRtcSpeakerState> Speakers)
+            {
+                for (const FRtcSpeakerState& Speaker : Speakers)
+                {
+                    LevelSum += Speaker.SmoothedLevel;
+                }
+            }));
+
+    // Reports at the SDK's fastest interval (100 ms); each speaker talks in bursts.
+    FRandomStream Random(0x5eed);
+    uint64 Cycles = 0;
+    double Now = FPlatformTime::Seconds();
+    for (int32 Report = 0; Report < NumReports; Report++)
+    {
+        Now += 0.1;
+        const uint64 StartCycles = FPlatformTime::Cycles64();
+        for (int32 SpeakerIndex = 0; SpeakerIndex < NumSpeakers; SpeakerIndex++)
+        {
+            const bool bTalking = ((Report / 20) + SpeakerIndex) % 4 == 0;
+            const int32 Volume = bTalking ? Random.RandRange(60, 200) : Random.RandRange(0, 10);
+            UpdateSpeakerState(RoomId, UserIds[SpeakerIndex], ERtcStreamIndex::Main, Volume, false, Now);
+        }
+        FinishSpeakerReport(false, Now);
+        Cycles += FPlatformTime::Cycles64() - StartCycles;
+    }
+
+    SpeakerStates = MoveTemp(SavedStates);
+    SpeakerIndices = MoveTemp(SavedIndices);
+    SpeakingSubscriptions = MoveTemp(SavedSubscriptions);
+    RemoteReportGeneration = SavedGeneration;
+    SpeakerLevelsVersion++;
+
+    const double AverageMicroseconds = NumReports > 0 ? FPlatformTime::ToSeconds64(Cycles) * 1000000.0 / NumReports : 0.0;
+    UE_LOG(RtcInterface, Log, TEXT("Speaking state benchmark: %d speakers, %d reports, %.2f us per report, %d speaking changes"),
+        NumSpeakers, NumReports, AverageMicroseconds, SpeakingChanges);
+    return AverageMicroseconds;
 }
 
 void FRTCPicoUserInterface::OnUserMuteAudioNotification(ppfMessageHandle Message, bool bIsError)
@@ -0,0 +1,78 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoAssetFileMounter.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPicoAssetFileMounterStallTest, "OnlineSubsystemPico.AssetFile.MountStall",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FPicoAssetFileMounterStallTest::RunTest(const FString& Parameters)
+{
+    // Large enough to take the memory mapped path, and to hash for a noticeable number of frames.
+    const int32 FileSize = 64 * 1024 * 1024;
+    const float FrameTime = 1.0f / 72.0f;
+    const double TimeoutSeconds = 30.0;
+
+    TArray<uint8> Contents;
+    Contents.SetNumUninitialized(FileSize);
+    FRandomStream Random(0x9A4D);
+    for (int32 Index = 0; Index < FileSize; Index += sizeof(uint32))
+    {
+        *reinterpret_cast<uint32*>(Contents.GetData() + Index) = Random.GetUnsignedInt();
+    }
+    FSHAHash ExpectedHash;
+    FSHA1::HashBuffer(Contents.GetData(), Contents.Num(), ExpectedHash.Hash);
+
+    FPicoAssetMountRequest Request;
+    Request.Filepath = FPaths::AutomationTransientDir() / TEXT("PicoAssetMountStall.pak");
+    Request.ExpectedSha1 = ExpectedHash.ToString();
+    if (!FFileHelper::SaveArrayToFile(Contents, *Request.Filepath))
+    {
+        AddError(FString::Printf(TEXT("Writing %s failed"), *Request.Filepath));
+        return false;
+    }
+    Contents.Empty();
+
+    // The file is not a real pak, so the mount itself fails unless pak support is off; the stall is in the hash.
+    FPicoAssetFileMounter Mounter;
+    const FPicoAssetMountResult SyncResult = Mounter.MountSynchronously(Request);
+
+    TOptional<FPicoAssetMountResult> AsyncResult;
+    double MaxTickSeconds = 0.0;
+    Mounter.Mount(Request, FPicoAssetMountComplete::CreateLambda([&AsyncResult](const FPicoAssetMountResult& Result)
+        {
+            AsyncResult = Result;
+        }));
+    const double StartTime = FPlatformTime::Seconds();
+    while (!AsyncResult.IsSet() && FPlatformTime::Seconds() - StartTime < TimeoutSeconds)
+    {
+        const double TickStart = FPlatformTime::Seconds();
+        Mounter.Tick(FrameTime);
+        MaxTickSeconds = FMath::Max(MaxTickSeconds, FPlatformTime::Seconds() - TickStart);
+        FPlatformProcess::Sleep(FrameTime);
+    }
+    IFileManager::Get().Delete(*Request.Filepath, false, false, true);
+
+    if (!TestTrue(TEXT("The mount completes"), AsyncResult.IsSet()))
+    {
+        return false;
+    }
+    AddInfo(FString::Printf(TEXT("On the game thread: %s"), *SyncResult.ToString()));
+    AddInfo(FString::Printf(TEXT("Pipelined: %s; longest tick %.2f ms"), *AsyncResult->ToString(), MaxTickSeconds * 1000.0));
+
+    TestFalse(TEXT("The file verifies"), AsyncResult->ErrorMessage.Contains(TEXT("SHA-1")) || SyncResult.ErrorMessage.Contains(TEXT("SHA-1")));
+    TestTrue(TEXT("The file is hashed through a memory mapping"), AsyncResult->bMemoryMapped);
+    // Only the mount is left on the game thread, the hash must not be.
+    const double GameThreadVerifySeconds = MaxTickSeconds - AsyncResult->MountSeconds;
+    TestTrue(FString::Printf(TEXT("The longest game thread tick without the mount (%.2f ms) is well below the synchronous verify (%.2f ms)"),
+        GameThreadVerifySeconds * 1000.0, SyncResult.VerifySeconds * 1000.0), GameThreadVerifySeconds < SyncResult.VerifySeconds * 0.25);
+    return true;
+}
+
+#endif
@@ -0,0 +1,149 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+
+#include "PicoRequestFutures.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPicoRequestFuturesTest, "OnlineSubsystemPico.RequestFutures.Scripted",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FPicoRequestFuturesTest::RunTest(const FString& Parameters)
+{
+    typedef TPicoRequestResult<FString> FStringResult;
+    typedef TPicoRequestResult<TArray<FString>> FListResult;
+
+    const float FrameTime = 1.0f / 72.0f;
+    const float LoginLatency = 0.08f;
+    const float FriendsLatency = 0.12f;
+    const float RoomsLatency = 0.15f;
+    const float JoinLatency = 0.10f;
+
+    // Scripted only, on a simulated clock
+    FPicoRequestFutures Futures(nullptr);
+    auto RunUntilReady = [&Futures, FrameTime](const auto& Future)
+    {
+        const double Start = Futures.GetTime();
+        while (!Future.IsReady() && Futures.GetTime() - Start < 5.0)
+        {
+            Futures.Tick(FrameTime);
+        }
+        return Futures.GetTime() - Start;
+    };
+
+    auto Login = [&Futures, LoginLatency]() { return Futures.SendScripted(TEXT("Login"), LoginLatency, FStringResult::Ok(TEXT("User"))); };
+    auto GetFriends = [&Futures, FriendsLatency]() { return Futures.SendScripted(TEXT("GetFriends"), FriendsLatency, FListResult::Ok({ TEXT("Friend") })); };
+    auto GetRooms = [&Futures, RoomsLatency]() { return Futures.SendScripted(TEXT("GetRooms"), RoomsLatency, FListResult::Ok({ TEXT("Room") })); };
+    auto Join = [&Futures, JoinLatency](const FString& Room) { return Futures.SendScripted(TEXT("Join"), JoinLatency, FStringResult::Ok(Room)); };
+
+    // Serial: every step waits for the previous one, as nested delegates do.
+    TFuture<FStringResult> Serial = PicoFutures::Then(Login(), [&](const FString&)
+        {
+            return PicoFutures::Then(GetFriends(), [&](const TArray<FString>&)
+                {
+                    return PicoFutures::Then(GetRooms(), [&](const TArray<FString>& Rooms) { return Join(Rooms[0]); });
+                });
+        });
+    const double SerialSeconds = RunUntilReady(Serial);
+    if (TestTrue(TEXT("The serial chain completes"), Serial.IsReady()))
+    {
+        TestFalse(TEXT("The serial chain succeeds"), Serial.Get().bIsError);
+        TestEqual(TEXT("The serial chain joins the room"), Serial.Get().Value, FString(TEXT("Room")));
+    }
+
+    // Concurrent: friends and rooms only depend on login, so they go out together.
+    TFuture<FStringResult> Concurrent = PicoFutures::Then(Login(), [&](const FString&)
+        {
+            TSharedRef<TPromise<FStringResult>> JoinedPromise = MakeShared<TPromise<FStringResult>>();
+            TFuture<FStringResult> JoinedFuture = JoinedPromise->GetFuture();
+            PicoFutures::WhenAll(GetFriends(), GetRooms()).Then([&, JoinedPromise](TFuture<TTuple<FListResult, FListResult>> Both)
+                {
+                    const FListResult& Rooms = Both.Get().Get<1>();
+                    if (Rooms.bIsError)
+                    {
+                        JoinedPromise->SetValue(FStringResult::FromError(Rooms));
+                        return;
+                    }
+                    Join(Rooms.Value[0]).Then([JoinedPromise](TFuture<FStringResult> Done) { JoinedPromise->SetValue(Done.Get()); });
+                });
+            return JoinedFuture;
+        });
+    const double ConcurrentSeconds = RunUntilReady(Concurrent);
+    if (TestTrue(TEXT("The concurrent chain completes"), Concurrent.IsReady()))
+    {
+        TestFalse(TEXT("The concurrent chain succeeds"), Concurrent.Get().bIsError);
+        TestEqual(TEXT("The concurrent chain joins the room"), Concurrent.Get().Value, FString(TEXT("Room")));
+    }
+
+    // Each step is noticed on the first tick after it is due, so allow a frame per step.
+    const double SerialExpected = LoginLatency + FriendsLatency + RoomsLatency + JoinLatency;
+    const double ConcurrentExpected = LoginLatency + FMath::Max(FriendsLatency, RoomsLatency) + JoinLatency;
+    TestTrue(FString::Printf(TEXT("The serial chain takes the sum of its latencies (%.0f ms, expected %.0f ms)"), SerialSeconds * 1000.0, SerialExpected * 1000.0),
+        SerialSeconds >= SerialExpected - KINDA_SMALL_NUMBER && SerialSeconds <= SerialExpected + 4 * FrameTime);
+    TestTrue(FString::Printf(TEXT("The concurrent chain overlaps friends and rooms (%.0f ms, expected %.0f ms)"), ConcurrentSeconds * 1000.0, ConcurrentExpected * 1000.0),
+        ConcurrentSeconds >= ConcurrentExpected - KINDA_SMALL_NUMBER && ConcurrentSeconds <= ConcurrentExpected + 3 * FrameTime);
+
+    // Timeout: a late answer must not overwrite the timeout.
+    TFuture<FStringResult> Slow = Futures.SendScripted(TEXT("Slow"), 0.5f, FStringResult::Ok(TEXT("Late")), 0.2f);
+    RunUntilReady(Slow);
+    if (TestTrue(TEXT("The slow request completes"), Slow.IsReady()))
+    {
+        TestTrue(TEXT("The slow request times out"), Slow.Get().bTimedOut);
+    }
+
+    // Cancel.
+    FPicoCancelToken CancelToken;
+    TFuture<FStringResult> Cancelled = Futures.SendScripted(TEXT("Cancelled"), 0.3f, FStringResult::Ok(TEXT("Late")), 0.0f, &CancelToken);
+    Futures.Tick(FrameTime);
+    CancelToken.Cancel();
+    if (TestTrue(TEXT("Cancelling completes the request right away"), Cancelled.IsReady()))
+    {
+        TestTrue(TEXT("The request is cancelled"), Cancelled.Get().bCancelled);
+    }
+
+    // When any: the fastest of three wins.
+    TArray<TFuture<FStringResult>> Racing;
+    Racing.Add(Futures.SendScripted(TEXT("Race"), 0.3f, FStringResult::Ok(TEXT("A"))));
+    Racing.Add(Futures.SendScripted(TEXT("Race"), 0.1f, FStringResult::Ok(TEXT("B"))));
+    Racing.Add(Futures.SendScripted(TEXT("Race"), 0.2f, FStringResult::Ok(TEXT("C"))));
+    TFuture<TPair<int32, FStringResult>> First = PicoFutures::WhenAny(MoveTemp(Racing));
+    RunUntilReady(First);
+    if (TestTrue(TEXT("When-any completes"), First.IsReady()))
+    {
+        TestEqual(TEXT("The fastest request wins"), First.Get().Key, 1);
+    }
+
+    // Drain the remaining answers so the trace is complete.
+    for (int32 Frame = 0; Frame < 72 && (Futures.GetNumPending() > 0 || Futures.GetScriptedQueue().Num() > 0); ++Frame)
+    {
+        Futures.Tick(FrameTime);
+    }
+    TestEqual(TEXT("No request is left pending"), Futures.GetNumPending(), 0);
+
+    const FPicoRequestStats* JoinStats = Futures.GetStats().Find(TEXT("Join"));
+    if (TestNotNull(TEXT("Joins are traced"), JoinStats))
+    {
+        TestEqual(TEXT("Both joins are traced"), JoinStats->Count, int64(2));
+        TestEqual(TEXT("No join failed"), JoinStats->NumFailed, int64(0));
+    }
+    const FPicoRequestStats* SlowStats = Futures.GetStats().Find(TEXT("Slow"));
+    if (TestNotNull(TEXT("The slow request is traced"), SlowStats))
+    {
+        TestEqual(TEXT("The timeout is traced as a failure"), SlowStats->NumFailed, int64(1));
+    }
+
+    // Shutting down fails whatever is still waiting, and a late answer finds nothing to resolve.
+    TFuture<FStringResult> Orphaned;
+    {
+        FPicoRequestFutures ShortLived(nullptr);
+        Orphaned = ShortLived.SendScripted(TEXT("Orphaned"), 0.1f, FStringResult::Ok(TEXT("Late")));
+    }
+    if (TestTrue(TEXT("Destroying the futures completes pending requests"), Orphaned.IsReady()))
+    {
+        TestTrue(TEXT("Pending requests are cancelled on shutdown"), Orphaned.Get().bCancelled);
+    }
+    return true;
+}
+
+#endif
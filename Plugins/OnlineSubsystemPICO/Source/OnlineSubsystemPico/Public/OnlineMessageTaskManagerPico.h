@@ -8,9 +8,64 @@
 #include "Runtime/Launch/Resources/Version.h"
 #include "OnlineSubsystemPicoNames.h"
 
+#include "Containers/IndirectArray.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+#include "Templates/Atomic.h"
+
 DECLARE_DELEGATE_TwoParams(FPicoMessageOnCompleteDelegate, ppfMessageHandle, bool /*bIsTimeOut or bIsError*/);
 DECLARE_MULTICAST_DELEGATE_TwoParams(FPicoMulticastMessageOnCompleteDelegate, ppfMessageHandle, bool);
 
+/**
+ * Base of the plain structs a message is decoded into on the message worker thread.
+ * Handlers get theirs with FOnlineSubsystemPico::GetDecodedMessage while the message is dispatched.
+ */
+struct FPicoDecodedMessage
+{
+    virtual ~FPicoDecodedMessage()
+    {
+    }
+};
+
+/** Runs on the message worker thread, or in TickTask without one. Must only read the message through the ppf_* accessors. */
+typedef TFunction<TUniquePtr<FPicoDecodedMessage>(ppfMessageHandle)> FPicoMessageDecoder;
+
+/**
+ * Maps the UTF-8 IDs handed out by the SDK (users, rooms) to small integers so that an ID seen
+ * again is neither converted nor allocated again. Thread safe; entries are never removed, so
+ * the strings returned by Resolve stay valid for the lifetime of the interner.
+ */
+class ONLINESUBSYSTEMPICO_API FPicoIdInterner
+{
+public:
+    int32 Intern(const char* Utf8Id);
+    /** Like Intern, but returns INDEX_NONE instead of adding an ID seen for the first time. */
+    int32 Find(const char* Utf8Id) const;
+    const FString& Resolve(int32 InternedId) const;
+    int32 Num() const;
+
+private:
+    /** Lock must be held. */
+    int32 FindLocked(const char* Utf8Id, uint32 Hash) const;
+
+    mutable FRWLock Lock;
+    TMultiMap<uint32, int32> IdsByHash;
+    TArray<TArray<ANSICHAR>> Utf8Ids;
+    /** Indirect so that the strings do not move when more IDs are interned. */
+    TIndirectArray<FString> Ids;
+};
+
+/** Per message type cost of the pipeline, in seconds. */
+struct FPicoMessageTiming
+{
+    int64 Count = 0;
+    /** Spent on the message worker thread popping and decoding. */
+    double DecodeSeconds = 0.0;
+    /** Spent on the game thread running the handlers. */
+    double DispatchSeconds = 0.0;
+    double MaxDispatchSeconds = 0.0;
+};
+
 
 class FOnlineAsyncTaskPico : public FOnlineAsyncTaskBasic<class FOnlineSubsystemPico>
 {
@@ -134,6 +189,61 @@ private:
 
     TMap<uint64, FOnlineAsyncTaskPico*> RequestTaskMap;
 
+    /** A popped message on its way from the worker thread to the game thread. */
+    struct FReceivedMessage
+    {
+        ppfMessageHandle MessageHandle = nullptr;
+        ppfMessageType MessageType = ppfMessageType_Unknown;
+        ppfRequest RequestId = 0;
+        bool bIsError = false;
+        TUniquePtr<FPicoDecodedMessage> Decoded;
+        double DecodeSeconds = 0.0;
+    };
+
+    /** Decodes the messages TickTask popped, sleeping until there are some. */
+    class FMessageWorker : public FRunnable
+    {
+    public:
+        FMessageWorker(FOnlineAsyncTaskManagerPico& InManager);
+        virtual ~FMessageWorker();
+
+        virtual uint32 Run() override;
+        virtual void Stop() override;
+
+        void Wake();
+
+    private:
+        FOnlineAsyncTaskManagerPico& Manager;
+        FEvent* WorkEvent = nullptr;
+        TAtomic<bool> bStopping{ false };
+    };
+
+    /** Written by TickTask, read by the message worker. */
+    TQueue<FReceivedMessage, EQueueMode::Spsc> PoppedMessages;
+
+    /** Written by the message worker (or by TickTask when there is none), read by TickTask. */
+    TQueue<FReceivedMessage, EQueueMode::Spsc> ReceivedMessages;
+
+    TMap<ppfMessageType, FPicoMessageDecoder> Decoders;
+    mutable FRWLock DecodersLock;
+
+    TUniquePtr<FMessageWorker> MessageWorker;
+    FRunnableThread* MessageWorkerThread = nullptr;
+
+    /** The message whose handlers are running, so they can find its decoded payload. */
+    ppfMessageHandle DispatchingMessage = nullptr;
+    const FPicoDecodedMessage* DispatchingDecoded = nullptr;
+
+    TMap<ppfMessageType, FPicoMessageTiming> MessageTimings;
+
+    /** Pops every available message. Only the game thread talks to the SDK's message queue. */
+    void PumpMessages();
+    /** Runs the registered decoder, if any, on whichever thread decodes. */
+    void DecodeMessage(FReceivedMessage& Received) const;
+    /** Decodes everything PumpMessages handed over and queues it for dispatch, in order. */
+    void DecodePoppedMessages();
+    void DispatchMessage(FReceivedMessage& Received);
+
 protected:
 
     /** Cached reference to the main online subsystem */
@@ -144,15 +254,32 @@ public:
     {
     }
 
-    ~FOnlineAsyncTaskManagerPico()
-    {
-    }
+    ~FOnlineAsyncTaskManagerPico();
 
     // FOnlineAsyncTaskManager
     virtual void OnlineTick() override;
 
     void TickTask();
 
+    /** Moves message decoding to a worker thread, controlled by bDecodeMessagesOnWorker. Messages are always popped by TickTask. */
+    void StartMessageWorker();
+    void StopMessageWorker();
+
+    void RegisterDecoder(ppfMessageType MessageType, FPicoMessageDecoder Decoder);
+
+    /** The decoded payload of Message while its handlers run, null otherwise. */
+    const FPicoDecodedMessage* GetDecodedMessage(ppfMessageHandle Message) const;
+
+    const TMap<ppfMessageType, FPicoMessageTiming>& GetMessageTimings() const
+    {
+        return MessageTimings;
+    }
+
+    void DumpMessageTimings(FOutputDevice& Ar) const;
+
+    /** Interned user and room IDs shared by all decoders. */
+    FPicoIdInterner IdInterner;
+
     void CollectedRequestTask(ppfRequest Request, FOnlineAsyncTaskPico* InTask);
 
     FPicoMulticastMessageOnCompleteDelegate& GetOrAddNotifyDelegate(ppfMessageType MessageType);
@@ -72,6 +72,97 @@ private:
 	// <summary>The SessionName when in matchmaking.</summary>
 	FName InProgressMatchmakingSearchName;
 
+	// <summary>A room returned by a search, kept so that an unchanged room is not rebuilt on the next search.</summary>
+	struct FCachedRoomSession
+	{
+		// <summary>Hash of the room fields that are read in constant time, see `GetRoomShape`.</summary>
+		uint32 Shape = 0;
+		// <summary>The room API has no version field, so room notifications bump this one.</summary>
+		uint32 RoomVersion = 0;
+		// <summary>`RoomVersion` when the cached session was built.</summary>
+		uint32 BuiltRoomVersion = 0;
+		// <summary>Bumped every time the cached session is rebuilt.</summary>
+		uint32 Version = 0;
+		double BuildTime = 0.0;
+		double LastSeenTime = 0.0;
+		TSharedPtr<FOnlineSession> Session;
+	};
+
+	// <summary>Rooms seen by `FindModeratedRoomSessions`, `FindMatchmakingSessions` and room notifications, keyed by room ID.</summary>
+	TMap<ppfID, FCachedRoomSession> RoomSessionCache;
+
+	// <summary>Seconds after which a cached room is rebuilt even if unchanged, and an unseen room is dropped. Read from [OnlineSubsystemPico] RoomSessionCacheTTL.</summary>
+	float RoomSessionCacheTTL = 30.f;
+
+	int32 LastSearchRoomsRebuilt = 0;
+	int32 LastSearchRoomsReused = 0;
+	int64 TotalRoomsRebuilt = 0;
+	int64 TotalRoomsReused = 0;
+
+	/// <summary>Hashes the owner, capacity, policies, user count and data store size of a room, without walking its users or data store.</summary>
+	/// <param name="Room">The handle of the room.</param>
+	/// <returns>The shape of the room.</returns>
+	static uint32 GetRoomShape(ppfRoomHandle Room);
+
+	/// <summary>
+	/// Returns the cached session of a room. It is rebuilt if a notification reported a change, its shape changed or the
+	/// cached copy has expired, so a data store value changed in a room we are not in shows up after `RoomSessionCacheTTL`.
+	/// </summary>
+	/// <param name="Room">The handle of the room.</param>
+	/// <param name="bOutRebuilt">Set to whether the session had to be rebuilt.</param>
+	/// <returns>The session of the room.</returns>
+	TSharedRef<FOnlineSession> GetOrCreateCachedSession(ppfRoomHandle Room, bool& bOutRebuilt);
+
+	/// <summary>Stores a cached session as the result at `Index`. A result that already holds this build of the session is left as is.</summary>
+	/// <param name="Results">The results of the search, grown by one if `Index` is past the end.</param>
+	/// <param name="Index">The index of the result.</param>
+	/// <param name="Session">The session from `GetOrCreateCachedSession`.</param>
+	/// <returns>The result.</returns>
+	static FOnlineSessionSearchResult& SetCachedSearchResult(TArray<FOnlineSessionSearchResult>& Results, int32 Index, const FOnlineSession& Session);
+
+	/// <summary>Drops the rooms that no search or notification has reported within `RoomSessionCacheTTL`.</summary>
+	void PruneRoomSessionCache();
+
+	/// <summary>Records and logs how many rooms one search rebuilt and reused.</summary>
+	void RecordSearchCacheStats(const TCHAR* SearchName, int32 Rebuilt, int32 Reused);
+
+	// <summary>What the room data store of one session holds, is being sent, and still has to be sent.</summary>
+	struct FRoomDataStoreSync
+	{
+		ppfID RoomId = 0;
+		// <summary>Key/value pairs the room is known to hold.</summary>
+		TMap<FString, FString> Sent;
+		// <summary>Key/value pairs of the request in flight.</summary>
+		TMap<FString, FString> InFlight;
+		// <summary>Changed key/value pairs waiting for the next request.</summary>
+		TMap<FString, FString> Pending;
+		double LastRequestTime = 0.0;
+		bool bRequestInFlight = false;
+		// <summary>`UpdateSession` calls answered by the request in flight and by the next one.</summary>
+		int32 InFlightCompletions = 0;
+		int32 PendingCompletions = 0;
+	};
+
+	// <summary>Data store state of the sessions this player owns, keyed by session name.</summary>
+	TMap<FName, FRoomDataStoreSync> RoomDataStoreSyncs;
+
+	// <summary>Minimum seconds between two data store requests of one session. Read from [OnlineSubsystemPico] RoomDataStoreUpdateInterval.</summary>
+	float RoomDataStoreUpdateInterval = 0.5f;
+
+	// <summary>Time and payload size of the data store requests sent within the last minute.</summary>
+	TArray<TPair<double, int32>> RoomDataStoreRequestLog;
+	int64 RoomDataStoreKeysSkipped = 0;
+
+	/// <summary>Sends the pending data store changes of a session if no request is in flight and the update interval has passed.</summary>
+	/// <param name="SessionName">The name of the session.</param>
+	void FlushRoomDataStore(FName SessionName);
+
+	/// <summary>Answers the `UpdateSession` calls covered by the request that just completed.</summary>
+	void OnUpdateRoomDataStoreComplete(ppfMessageHandle Message, bool bIsError, FName SessionName);
+
+	/// <summary>Resets what the data store of a session is known to hold from the room.</summary>
+	void SyncRoomDataStoreFromRoom(FName SessionName, ppfRoomHandle Room);
+
 	/// <summary>Gets the room ID of the session.</summary>
 	/// <param name="Session">The session to get room ID for.</param>
 	/// <returns>The room ID of the specified session.</returns>
@@ -108,6 +199,7 @@ PACKAGE_SCOPE:
 	void UpdateSessionSettingsFromDataStore(FOnlineSessionSettings& SessionSettings, ppfDataStoreHandle DataStore) const;
 
 	void TickPendingInvites(float DeltaTime);
+	void TickRoomDataStoreUpdates();
 
 	bool CreateRoomSession(FNamedOnlineSession& Session, ppfRoomJoinPolicy JoinPolicy);
 	bool CreateMatchmakingSession(FNamedOnlineSession& Session, ppfRoomJoinPolicy JoinPolicy);
@@ -315,6 +407,19 @@ public:
 	class FNamedOnlineSession* AddNamedSession(FName SessionName, const FOnlineSessionSettings& SessionSettings) override;
 	class FNamedOnlineSession* AddNamedSession(FName SessionName, const FOnlineSession& Session) override;
 
+	/// <summary>Gets how many rooms the session searches rebuilt and how many they reused from the room cache.</summary>
+	/// <param name="OutLastSearchRebuilt">Rooms rebuilt by the most recent search.</param>
+	/// <param name="OutLastSearchReused">Rooms reused by the most recent search.</param>
+	/// <param name="OutTotalRebuilt">Rooms rebuilt since startup.</param>
+	/// <param name="OutTotalReused">Rooms reused since startup.</param>
+	void GetRoomSessionCacheStats(int32& OutLastSearchRebuilt, int32& OutLastSearchReused, int64& OutTotalRebuilt, int64& OutTotalReused) const;
+
+	/// <summary>Gets the traffic of `UpdateSession` to the room data store over the last minute.</summary>
+	/// <param name="OutRequestsPerMinute">Data store requests sent within the last minute.</param>
+	/// <param name="OutBytesPerMinute">Key and value bytes sent within the last minute.</param>
+	/// <param name="OutKeysSkipped">Unchanged keys not sent since startup.</param>
+	void GetRoomDataStoreTrafficStats(int32& OutRequestsPerMinute, int32& OutBytesPerMinute, int64& OutKeysSkipped);
+
 
 private:
 	FString InitStateErrorMessage = FString("Error: InitSuccess is false");
@@ -37,6 +37,9 @@ class FApplicationLifecycleInterface;
 class FPicoIAPInterface;
 class FPicoUserInterface;
 class FPicoAssetFileInterface;
+class FPicoAssetDownloadScheduler;
+class FPicoRequestFutures;
+class FPicoUserProfileCache;
 class FPicoSportInterface;
 class FPicoLeaderboardsInterface;
 class FPicoAchievementsInterface;
@@ -109,6 +112,14 @@ public:
 
     TSharedPtr<FPicoAssetFileInterface> GetPicoAssetFileInterface() const;
 
+    TSharedPtr<FPicoAssetDownloadScheduler> GetPicoAssetDownloadScheduler() const;
+
+    /// <summary>Future based requests with a latency trace.</summary>
+    TSharedPtr<FPicoRequestFutures> GetPicoRequestFutures() const;
+
+    /// <summary>Profiles of every user seen in a response, shared by friends, presence, rooms and leaderboards.</summary>
+    TSharedPtr<FPicoUserProfileCache> GetPicoUserProfileCache() const;
+
     TSharedPtr<FPicoSportInterface> GetPicoSportInterface() const;
 
 
@@ -143,6 +154,28 @@ public:
     FPicoMulticastMessageOnCompleteDelegate& GetOrAddNotify(ppfMessageType MessageType) const;
     void RemoveNotifyDelegate(ppfMessageType MessageType, const FDelegateHandle& Delegate) const;
 
+    /**
+     * Decodes every message of MessageType into a plain struct off the game thread.
+     * The handlers of the message then read it with GetDecodedMessage instead of walking the ppf_* API.
+     */
+    void RegisterMessageDecoder(ppfMessageType MessageType, FPicoMessageDecoder Decoder) const;
+
+    /** The payload the registered decoder produced for Message, or null if there is none. Only valid inside the message handlers. */
+    template<typename DecodedType>
+    const DecodedType* GetDecodedMessage(ppfMessageHandle Message) const
+    {
+        return static_cast<const DecodedType*>(GetDecodedMessageInternal(Message));
+    }
+
+    /** Interned user and room IDs of decoded messages. */
+    FPicoIdInterner& GetIdInterner() const;
+
+    /** Counts the UObjects built to wrap notification payloads for object based listeners, see the RESULTOBJECTS exec command. */
+    static void RecordResultObjects(int32 NumObjects);
+
+    /** Result UObjects recorded since startup. */
+    static int64 GetResultObjectsCreated();
+
 PACKAGE_SCOPE:
 
     /** Only the factory makes instances */
@@ -158,6 +191,14 @@ private:
 
     bool bPicoInit;
 
+    const FPicoDecodedMessage* GetDecodedMessageInternal(ppfMessageHandle Message) const;
+
+    static TAtomic<int64> ResultObjectsCreated;
+
+    /** Start of the current RESULTOBJECTS measurement window. */
+    double ResultObjectsWindowStart = 0.0;
+    int64 ResultObjectsWindowBase = 0;
+
 #if PLATFORM_WINDOWS
     bool InitWithWindowsPlatform() const;
 
@@ -186,6 +227,12 @@ private:
 
     TSharedPtr<FPicoAssetFileInterface> PicoAssetFileInterface;
 
+    TSharedPtr<FPicoAssetDownloadScheduler> PicoAssetDownloadScheduler;
+
+    TSharedPtr<FPicoRequestFutures> PicoRequestFutures;
+
+    TSharedPtr<FPicoUserProfileCache> PicoUserProfileCache;
+
     TSharedPtr<FPicoSportInterface> PicoSportInterface;
 
     FOnlineSessionPicoPtr GameSessionInterface;
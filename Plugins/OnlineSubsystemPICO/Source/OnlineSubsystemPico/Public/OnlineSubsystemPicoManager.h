@@ -628,7 +628,7 @@ public:
 
     void OnHighlightRecordStop(UPico_RecordInfo* RecordInfoObj);
 
-    void OnAssetFileDownloadUpdate(UPico_AssetFileDownloadUpdate* AssetFileDownloadUpdateObj);
+    void OnAssetFileDownloadUpdate(const FPicoAssetFileDownloadUpdateData& DownloadUpdate);
 
     void OnAssetFileDeleteForSafety(UPico_AssetFileDeleteForSafety* AssetFileDeleteForSafetyObj);
 
@@ -656,10 +656,10 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Pico Room")
 	FPicoRoomInviteAcceptedNotifyDelegate OnPicoRoomInviteAcceptedNotifyDelegate;
 
-	void OnPicoRoomUpdateNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, UPico_Room* Room);
+	void OnPicoRoomUpdateNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FPicoRoomData& Room);
 	void OnPicoRoomUpdateOwnerNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage);
-	void OnPicoRoomJoinNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, UPico_Room* Room);
-	void OnPicoRoomLeaveNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, UPico_Room* Room);
+	void OnPicoRoomJoinNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FPicoRoomData& Room);
+	void OnPicoRoomLeaveNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FPicoRoomData& Room);
 	void OnPicoRoomInviteAcceptedNotification(bool bIsError, int ErrorCode, const FString& ErrorMessage, const FString& RoomID);
 	/*
 	 * Pico_Room Notification end
@@ -0,0 +1,243 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "PPF_Platform.h"
+
+class FOnlineSubsystemPico;
+
+/// @file PicoAchievementWriteQueue.h
+
+/// <summary>The progress written to one achievement, merged from any number of calls.</summary>
+struct FPicoAchievementWrite
+{
+    FString Name;
+    int64 Count = 0; /*!< Sum of the counts added */
+    FString Fields; /*!< Bitwise OR of the fields added, '0' and '1' characters */
+    bool bUnlock = false;
+    FString ExtraData; /*!< Of the latest call that passed any */
+
+    bool IsEmpty() const;
+
+    /// <summary>Adds the progress of `Other` on top of this one.</summary>
+    void Merge(const FPicoAchievementWrite& Other);
+};
+
+/// <summary>What the server knows about an achievement, as far as the write queue cares.</summary>
+struct FPicoAchievementDefinitionInfo
+{
+    FString Name;
+    ppfAchievementType Type = ppfAchievement_TypeUnknown;
+    int64 Target = 0;
+    int32 BitfieldLength = 0;
+    bool bArchived = false;
+};
+
+/// <summary>Request savings and health of the achievement write queue.</summary>
+struct FPicoAchievementWriteQueueStats
+{
+    int64 NumChanges = 0; /*!< AddCount, AddFields and Unlock calls */
+    int64 NumRequests = 0; /*!< Platform write requests sent, retries included */
+    int64 NumFailures = 0;
+    int64 NumRetries = 0;
+    int64 NumDropped = 0; /*!< Writes dropped for good, see FPicoAchievementWriteQueue::Reconcile */
+    int64 NumReconciles = 0;
+    int64 NumRestored = 0; /*!< Achievements restored from the queue file at startup */
+
+    /// <summary>The requests one request per call would have sent on top of ours.</summary>
+    int64 GetRequestsSaved() const { return NumChanges - NumRequests; }
+};
+
+/// <summary>
+/// Sends achievement writes. The platform implementation uses the `ppf_Achievements_*` calls, FPicoScriptedAchievementBackend
+/// keeps the progress itself and can be taken offline, so the queue can be exercised without a device.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API IPicoAchievementBackend
+{
+public:
+    typedef TFunction<void(bool /*bSuccess*/, const FString& /*ErrorMessage*/, bool /*bJustUnlocked*/)> FOnComplete;
+    typedef TFunction<void(bool /*bSuccess*/, const TArray<FPicoAchievementDefinitionInfo>& /*Definitions*/, bool /*bComplete*/)> FOnDefinitions;
+
+    virtual ~IPicoAchievementBackend() = default;
+
+    /// <summary>Writes the merged progress of one achievement. An unlock makes the count and fields moot and is sent alone.
+    /// `OnComplete` must not run from within the call.</summary>
+    /// <returns>The number of platform requests sent.</returns>
+    virtual int32 Write(const FPicoAchievementWrite& Write, FOnComplete OnComplete) = 0;
+
+    /// <summary>Gets the definitions of the given achievements. `bComplete` is false if the server returned only a page of them.</summary>
+    virtual void GetDefinitions(const TArray<FString>& Names, FOnDefinitions OnDefinitions) = 0;
+
+    virtual void Tick(float DeltaTime) {}
+};
+
+/// <summary>Keeps the progress of every achievement itself and answers after a fixed latency, or fails everything while offline.</summary>
+class ONLINESUBSYSTEMPICO_API FPicoScriptedAchievementBackend : public IPicoAchievementBackend
+{
+public:
+    struct FProgress
+    {
+        int64 Count = 0;
+        FString Fields;
+        bool bUnlocked = false;
+    };
+
+    float LatencySeconds = 0.2f;
+    bool bOnline = true; /*!< Requests answered while offline fail */
+    int32 NumWrites = 0;
+    int32 NumRequests = 0;
+    TMap<FString, FPicoAchievementDefinitionInfo> Definitions;
+    TMap<FString, FProgress> Progress; /*!< What the server has after the writes answered so far */
+
+    void AddDefinition(const FString& Name, ppfAchievementType Type, int64 Target, int32 BitfieldLength = 0);
+
+    virtual int32 Write(const FPicoAchievementWrite& Write, FOnComplete OnComplete) override;
+    virtual void GetDefinitions(const TArray<FString>& Names, FOnDefinitions OnDefinitions) override;
+    virtual void Tick(float DeltaTime) override;
+
+private:
+    /** Applies the write, or tells why it cannot be. */
+    bool Apply(const FPicoAchievementWrite& Write, FString& OutError, bool& bOutJustUnlocked);
+
+    struct FPendingAnswer
+    {
+        float RemainingSeconds;
+        TFunction<void()> Answer;
+    };
+    TArray<FPendingAnswer> Pending;
+};
+
+/** @addtogroup Function Function
+ *  This is the Function group
+ *  @{
+ */
+
+/** @defgroup Achievements Achievements
+ *  This is the Achievements group
+ *  @{
+ */
+
+/// <summary>
+/// Write-ahead queue for achievement progress. Counts and fields added to the same achievement are merged locally
+/// and flushed every AchievementFlushSeconds, at a checkpoint, or on the next tick for an unlock; at most one write
+/// per achievement is in flight. The queue is saved before anything is sent, so progress made offline or not yet
+/// confirmed survives a restart. Saves are coalesced to one every AchievementQueueSaveSeconds unless a write is due,
+/// and the file is written on a worker thread. A failed write takes the queue offline: it then probes the server with
+/// the definitions of the queued achievements, with backoff, and once they arrive drops the writes the server can no
+/// longer accept (unknown or archived achievements, or progress that does not fit the type) before flushing again.
+/// An achievement whose writes keep failing is retried with its own backoff and is never dropped for it.
+/// Writes are delivered at least once: a write the server applied just before the app died is sent again.
+/// The queue belongs to the signed in user, see SetUserId; nothing is sent before a user signs in.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API FPicoAchievementWriteQueue : public TSharedFromThis<FPicoAchievementWriteQueue>
+{
+public:
+    /// <param name="InQueueFilePrefix">Where the queue is persisted, `_<UserId>.json` is appended. Empty to keep it in memory only.</param>
+    /// <param name="bInSaveInBackground">Whether the file is written on a worker thread, rather than within Tick.</param>
+    FPicoAchievementWriteQueue(TSharedRef<IPicoAchievementBackend> InBackend, const FString& InQueueFilePrefix, bool bInSaveInBackground = true);
+    ~FPicoAchievementWriteQueue();
+
+    /// <summary>Creates the backend that sends `ppf_Achievements_*` requests through the subsystem.</summary>
+    static TSharedRef<IPicoAchievementBackend> CreatePlatformBackend(FOnlineSubsystemPico& InSubsystem);
+
+    /// <summary>Adds to a count achievement. `OnComplete` runs once a write including this count was applied or dropped.</summary>
+    void AddCount(const FString& Name, int64 Count, const FString& ExtraData, IPicoAchievementBackend::FOnComplete OnComplete = nullptr);
+
+    /// <summary>Unlocks bits of a bitfield achievement. `OnComplete` runs once a write including these bits was applied or dropped.</summary>
+    void AddFields(const FString& Name, const FString& Fields, const FString& ExtraData, IPicoAchievementBackend::FOnComplete OnComplete = nullptr);
+
+    /// <summary>Unlocks an achievement, sent on the next tick.</summary>
+    void Unlock(const FString& Name, const FString& ExtraData, IPicoAchievementBackend::FOnComplete OnComplete = nullptr);
+
+    /// <summary>Saves the queue and sends everything queued on the next tick, e.g. at the end of a level.</summary>
+    void Checkpoint();
+
+    /// <summary>Switches the queue to the given user. The queue of the previous user is saved to their file and sent once they
+    /// sign in again, and the callbacks waiting on it fail. Progress queued while no user was signed in goes to the new user.</summary>
+    void SetUserId(const FString& InUserId);
+
+    const FString& GetUserId() const { return UserId; }
+
+    void Tick(float DeltaTime);
+
+    bool IsIdle() const { return Entries.Num() == 0 && !bReconciling; }
+    bool IsOnline() const { return bOnline; }
+
+    const FPicoAchievementWriteQueueStats& GetStats() const { return Stats; }
+
+    void Dump(FOutputDevice& Ar) const;
+
+    /// <summary>Plays a burst heavy session against a scripted backend that goes offline, restarts the queue from its
+    /// file while offline and comes back, then checks the server progress and compares the request count with one
+    /// request per call.</summary>
+    static FString RunScriptedSimulation();
+
+private:
+    typedef TArray<IPicoAchievementBackend::FOnComplete> FWaiters;
+
+    struct FEntry
+    {
+        FPicoAchievementWrite Pending; /*!< Not sent yet */
+        FWaiters PendingWaiters;
+        bool bInFlight = false;
+        uint32 InFlightId = 0;
+        FPicoAchievementWrite InFlight;
+        FWaiters InFlightWaiters;
+        int32 Attempts = 0; /*!< Failed writes in a row */
+        double RetryTime = 0.0; /*!< Not sent again before this after a failed write */
+    };
+
+    void Enqueue(const FPicoAchievementWrite& Write, IPicoAchievementBackend::FOnComplete&& OnComplete);
+    void Flush();
+    void OnWriteComplete(const FString& Name, uint32 WriteId, bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked);
+
+    /** Asks the server for the definitions of everything queued; their arrival means we are online again. */
+    void Reconcile();
+    void OnDefinitions(bool bSuccess, const TArray<FPicoAchievementDefinitionInfo>& Definitions, bool bComplete);
+    void GoOffline();
+    /** Removes the achievement from the queue, its waiters are added to `OutFailed` to run once the queue is consistent. */
+    void Drop(const FString& Name, const FString& Reason, TArray<TPair<FWaiters, FString>>& OutFailed);
+
+    static void CompleteWaiters(FWaiters& Waiters, bool bSuccess, const FString& ErrorMessage, bool bJustUnlocked);
+
+    /** The file of the current user, empty if there is none. */
+    FString GetQueueFilePath() const;
+    bool IsSaving() const { return PendingSave.IsValid() && !PendingSave.IsReady(); }
+    /** Blocks until the last save has been written. */
+    void WaitForSave();
+    bool SaveQueue(bool bInBackground);
+    bool LoadQueue();
+
+    TSharedRef<IPicoAchievementBackend> Backend;
+    FString QueueFilePrefix;
+    FString UserId;
+    bool bSaveInBackground = true;
+    bool bQueueDirty = false;
+    double SaveTime = 0.0; /*!< No save before this unless a write is due */
+    TFuture<bool> PendingSave; /*!< At most one save is written at a time, so they land in order */
+
+    TMap<FString, FEntry> Entries;
+    int32 NumInFlight = 0;
+    uint32 LastWriteId = 0;
+
+    bool bOnline = true;
+    bool bNeedsReconcile = false;
+    bool bReconciling = false;
+    int32 OfflineAttempts = 0;
+    double RetryTime = 0.0; /*!< No request before this while offline */
+    double FlushTime = TNumericLimits<double>::Max(); /*!< When the pending writes go out */
+
+    double Time = 0.0;
+    float FlushSeconds = 2.0f; /*!< How long a change may wait to be merged with later ones */
+    float SaveSeconds = 1.0f; /*!< How long a change may wait to be saved with later ones */
+    int32 MaxConcurrentWrites = 4;
+    float RetrySeconds = 2.0f;
+    float MaxRetrySeconds = 60.0f;
+
+    FPicoAchievementWriteQueueStats Stats;
+};
+
+/** @} */ // end of Achievements
+/** @} */ // end of Function
@@ -0,0 +1,293 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Pico_AssetFile.h"
+
+/// @file PicoAssetDownloadScheduler.h
+
+/// <summary>Priority of a scheduled asset file download. Higher priorities start first.</summary>
+enum class EPicoAssetDownloadPriority : uint8
+{
+    Background, /**< Speculative content, e.g. levels the player may never reach */
+    Prefetch, /**< Content for the next level */
+    Required, /**< Content the current level needs; keeps running during critical sections */
+};
+
+/// <summary>State of a scheduled asset file download.</summary>
+enum class EPicoAssetDownloadState : uint8
+{
+    Queued, /**< Waiting for a free download slot */
+    Starting, /**< The download request has been sent */
+    Downloading, /**< The platform reported progress */
+    Paused, /**< Held back by Pause or a critical section before it started, starts automatically */
+    Succeeded, /**< Downloaded */
+    Failed, /**< Failed after all retries */
+};
+
+/// <summary>One entry of the download queue.</summary>
+struct FPicoAssetDownloadEntry
+{
+    FString Key; /*!< AssetId for downloads by ID, AssetName for downloads by name */
+    FString AssetId; /*!< Known once the platform accepted the download */
+    FString AssetName;
+    EPicoAssetDownloadPriority Priority = EPicoAssetDownloadPriority::Background;
+    EPicoAssetDownloadState State = EPicoAssetDownloadState::Queued;
+    int64 BytesTotal = 0;
+    int64 BytesTransferred = 0;
+    int32 Attempts = 0;
+    uint32 Sequence = 0; /*!< Enqueue order, keeps entries of the same priority first in first out */
+    uint32 StartRequest = 0; /*!< Latest download request, responses to older ones are ignored */
+    double RetryTime = 0.0; /*!< Scheduler time before which a failed download is not retried */
+
+    bool IsActive() const { return State == EPicoAssetDownloadState::Starting || State == EPicoAssetDownloadState::Downloading; }
+    bool IsFinished() const { return State == EPicoAssetDownloadState::Succeeded || State == EPicoAssetDownloadState::Failed; }
+};
+
+/// <summary>Progress of the whole queue, delivered at a fixed rate.</summary>
+struct FPicoAssetDownloadProgress
+{
+    int64 BytesTotal = 0; /*!< Sum over entries whose size is known */
+    int64 BytesTransferred = 0;
+    double BytesPerSecond = 0.0; /*!< Smoothed throughput of all active downloads */
+    int32 NumQueued = 0;
+    int32 NumActive = 0;
+    int32 NumPaused = 0;
+    int32 NumSucceeded = 0;
+    int32 NumFailed = 0;
+    bool bPaused = false;
+
+    bool operator==(const FPicoAssetDownloadProgress& Other) const
+    {
+        return BytesTotal == Other.BytesTotal && BytesTransferred == Other.BytesTransferred
+            && NumQueued == Other.NumQueued && NumActive == Other.NumActive && NumPaused == Other.NumPaused
+            && NumSucceeded == Other.NumSucceeded && NumFailed == Other.NumFailed && bPaused == Other.bPaused;
+    }
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FPicoAssetDownloadProgressNotify, const FPicoAssetDownloadProgress& /*Progress*/);
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FPicoAssetDownloadCompleteNotify, const FPicoAssetDownloadEntry& /*Entry*/, bool /*bSucceeded*/, const FString& /*ErrorMessage*/);
+
+/// <summary>
+/// The `ppf_AssetFile_*` calls the scheduler depends on. The platform implementation talks to the PICO SDK,
+/// FPicoScriptedAssetFileBackend replays scripted downloads so the scheduler can be exercised without a device.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API IPicoAssetFileBackend
+{
+public:
+    DECLARE_DELEGATE_ThreeParams(FOnDownloadStarted, bool /*bIsError*/, const FString& /*ErrorMessage*/, const FString& /*AssetId*/);
+
+    virtual ~IPicoAssetFileBackend() = default;
+
+    /// <summary>Starts downloading an asset file by ID, or by name if `AssetId` is empty.</summary>
+    virtual bool StartDownload(const FString& AssetId, const FString& AssetName, FOnDownloadStarted OnStarted) = 0;
+
+    /// <summary>Cancels a running download.</summary>
+    virtual bool CancelDownload(const FString& AssetId) = 0;
+
+    virtual void Tick(float DeltaTime) {}
+
+    /// <summary>Download progress, in the same form as FPicoAssetFileInterface::AssetFileDownloadUpdateDataCallback.</summary>
+    FAssetFileDownloadUpdateDataNotify OnDownloadUpdate;
+};
+
+/// <summary>Scripted stand-in for the `ppf_AssetFile_*` calls.</summary>
+class ONLINESUBSYSTEMPICO_API FPicoScriptedAssetFileBackend : public IPicoAssetFileBackend
+{
+public:
+    /// <summary>How a scripted download behaves.</summary>
+    struct FScript
+    {
+        int64 BytesTotal = 64 * 1024 * 1024;
+        double BytesPerSecond = 8 * 1024 * 1024; /*!< Shared with other running downloads when LinkBytesPerSecond is set */
+        float StartLatency = 0.1f; /*!< Seconds until the download request returns */
+        bool bRejectStart = false; /*!< The download request returns an error */
+        int64 FailAtBytes = -1; /*!< Reports a failed download once this many bytes arrived */
+    };
+
+    FScript DefaultScript;
+
+    /// <summary>Total bandwidth shared by all running downloads, 0 for no limit.</summary>
+    double LinkBytesPerSecond = 0.0;
+
+    int32 NumStartCalls = 0;
+    int32 NumCancelCalls = 0;
+
+    /// <summary>Sets the script for an asset ID or name.</summary>
+    void SetScript(const FString& AssetKey, const FScript& Script);
+
+    virtual bool StartDownload(const FString& AssetId, const FString& AssetName, FOnDownloadStarted OnStarted) override;
+    virtual bool CancelDownload(const FString& AssetId) override;
+    virtual void Tick(float DeltaTime) override;
+
+private:
+    struct FScriptedDownload
+    {
+        FString AssetId;
+        FScript Script;
+        FOnDownloadStarted OnStarted;
+        float StartDelay = 0.0f;
+        double BytesTransferred = 0.0;
+    };
+
+    const FScript& GetScript(const FString& AssetKey) const;
+
+    TMap<FString, FScript> Scripts;
+    TArray<FScriptedDownload> Downloads;
+    uint64 NextScriptedAssetId = 1000000;
+};
+
+/** @addtogroup Function Function
+ *  This is the Function group
+ *  @{
+ */
+
+ /** @defgroup AssetFile AssetFile
+  *  This is the AssetFile group
+  *  @{
+  */
+
+/// <summary>
+/// Download manager on top of the asset file API. Downloads run by priority with a concurrency limit and an optional
+/// bandwidth cap, lower priorities are held back around gameplay critical moments, progress of the whole queue is
+/// delivered at a fixed rate and unfinished downloads are saved and restarted on the next launch.
+/// The asset file API cannot resume a cancelled download, so pausing, critical sections, the concurrency limit and
+/// the bandwidth cap only hold back downloads that have not started; running ones finish. Only Cancel and a higher
+/// priority download taking the slot of a lower one stop a running download.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API FPicoAssetDownloadScheduler : public TSharedFromThis<FPicoAssetDownloadScheduler>
+{
+public:
+    /// <summary>Keeps a critical section open for its lifetime.</summary>
+    class FScopedCriticalSection
+    {
+    public:
+        FScopedCriticalSection(FPicoAssetDownloadScheduler& InScheduler) : Scheduler(InScheduler) { Scheduler.BeginCriticalSection(); }
+        ~FScopedCriticalSection() { Scheduler.EndCriticalSection(); }
+
+    private:
+        FPicoAssetDownloadScheduler& Scheduler;
+    };
+
+    /// <param name="InBackend">The asset file calls to schedule.</param>
+    /// <param name="InQueueFilePath">Where the queue is saved. No persistence if empty.</param>
+    FPicoAssetDownloadScheduler(TSharedRef<IPicoAssetFileBackend> InBackend, const FString& InQueueFilePath);
+    ~FPicoAssetDownloadScheduler();
+
+    /// <summary>Backend that forwards to the PICO SDK and listens to FPicoAssetFileInterface for progress.</summary>
+    static TSharedRef<IPicoAssetFileBackend> CreatePlatformBackend(FOnlineSubsystemPico& InSubsystem);
+
+    /// <summary>
+    /// Runs a queue of mixed priority downloads against FPicoScriptedAssetFileBackend, with a critical section in the
+    /// middle, and returns a summary of ordering, concurrency and progress delivery.
+    /// </summary>
+    static FString RunScriptedSimulation(int32 NumAssets, int32 InMaxConcurrentDownloads, int64 InMaxBytesPerSecond);
+
+    /// <summary>Fires at most every `AssetDownloadProgressInterval` seconds while the queue changes.</summary>
+    FPicoAssetDownloadProgressNotify OnProgress;
+
+    /// <summary>Fires once per download when it succeeded or failed for good.</summary>
+    FPicoAssetDownloadCompleteNotify OnDownloadComplete;
+
+    /// <summary>Adds a download by asset file ID. Raises the priority if it is already queued.</summary>
+    bool EnqueueById(const FString& AssetId, EPicoAssetDownloadPriority Priority);
+
+    /// <summary>Adds a download by asset file name. Raises the priority if it is already queued.</summary>
+    bool EnqueueByName(const FString& AssetName, EPicoAssetDownloadPriority Priority);
+
+    /// <summary>Changes the priority of a queued or running download. Takes effect on the next tick.</summary>
+    bool SetPriority(const FString& AssetKey, EPicoAssetDownloadPriority Priority);
+
+    /// <summary>Removes a download from the queue and cancels it if it runs.</summary>
+    bool Cancel(const FString& AssetKey);
+
+    /// <summary>Starts no more downloads until Resume. Running downloads finish.</summary>
+    void Pause();
+    void Resume();
+    bool IsPaused() const { return bPaused; }
+
+    /// <summary>
+    /// Starts no more downloads but required ones until the matching EndCriticalSection, e.g. during a boss fight or a
+    /// level load. Running downloads finish. Sections nest. Prefer FScopedCriticalSection.
+    /// </summary>
+    void BeginCriticalSection();
+    void EndCriticalSection();
+    bool IsInCriticalSection() const { return CriticalSectionDepth > 0; }
+
+    void SetMaxConcurrentDownloads(int32 InMaxConcurrentDownloads);
+
+    /// <summary>Sets the bandwidth cap in bytes per second, 0 for no cap. Over the cap no more downloads start.</summary>
+    void SetMaxBytesPerSecond(int64 InMaxBytesPerSecond);
+
+    const FPicoAssetDownloadEntry* FindEntry(const FString& AssetKey) const;
+    const TArray<FPicoAssetDownloadEntry>& GetEntries() const { return Entries; }
+    const FPicoAssetDownloadProgress& GetProgress() const { return Progress; }
+    IPicoAssetFileBackend& GetBackend() const { return *Backend; }
+
+    /// <summary>Forgets succeeded and failed downloads.</summary>
+    void ClearFinished();
+
+    void Tick(float DeltaTime);
+
+    /// <summary>Writes unfinished downloads to the queue file.</summary>
+    bool SaveQueue();
+
+private:
+    bool Enqueue(const FString& AssetId, const FString& AssetName, EPicoAssetDownloadPriority Priority);
+    bool LoadQueue();
+
+    FPicoAssetDownloadEntry* FindMutableEntry(const FString& AssetKey);
+    FPicoAssetDownloadEntry* FindEntryBySequence(uint32 Sequence);
+    FPicoAssetDownloadEntry* FindEntryByAssetId(const FString& AssetId);
+    FPicoAssetDownloadEntry* FindLowestActive();
+    bool CanRun(const FPicoAssetDownloadEntry& Entry) const;
+    bool CanStart(const FPicoAssetDownloadEntry& Entry) const;
+    bool HasBandwidthFor(int32 NumActive) const;
+
+    void StartEntry(FPicoAssetDownloadEntry& Entry);
+    void StopEntry(FPicoAssetDownloadEntry& Entry, EPicoAssetDownloadState NewState);
+    void FailAttempt(FPicoAssetDownloadEntry& Entry, const FString& ErrorMessage);
+    void Schedule();
+
+    void OnDownloadStarted(bool bIsError, const FString& ErrorMessage, const FString& AssetId, uint32 Sequence, uint32 StartRequest);
+    void OnDownloadUpdate(const FPicoAssetFileDownloadUpdateData& DownloadUpdate);
+
+    void UpdateProgress(float DeltaTime);
+
+    TSharedRef<IPicoAssetFileBackend> Backend;
+    FDelegateHandle DownloadUpdateHandle;
+    FString QueueFilePath;
+
+    TArray<FPicoAssetDownloadEntry> Entries;
+    uint32 NextSequence = 1;
+    uint32 NextStartRequest = 1;
+
+    int32 MaxConcurrentDownloads = 2;
+    int64 MaxBytesPerSecond = 0;
+    int32 MaxRetries = 2;
+    /** Seconds before the first retry, doubled for every further one up to MaxRetryDelay. */
+    float RetryDelay = 1.0f;
+    float MaxRetryDelay = 30.0f;
+    float ProgressInterval = 0.25f;
+    /** Sum of the tick times, so retries wait in the simulation as they do on the device. */
+    double SchedulerTime = 0.0;
+
+    bool bPaused = false;
+    int32 CriticalSectionDepth = 0;
+
+    // Throughput measurement, bytes since the last progress report.
+    int64 WindowBytes = 0;
+    float WindowTime = 0.0f;
+    double BytesPerSecond = 0.0;
+    bool bRateSampledSinceStart = true;
+
+    FPicoAssetDownloadProgress Progress;
+    bool bQueueDirty = false;
+
+    // Completions are delivered from Tick so listeners can change the queue.
+    TArray<TPair<FPicoAssetDownloadEntry, FString>> PendingCompletions;
+};
+
+/** @} */ // end of AssetFile
+/** @} */ // end of Function
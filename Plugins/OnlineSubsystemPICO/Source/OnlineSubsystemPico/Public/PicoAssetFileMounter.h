@@ -0,0 +1,114 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Engine/StreamableManager.h"
+
+/// @file PicoAssetFileMounter.h
+
+/// <summary>What to do with a downloaded asset file.</summary>
+struct FPicoAssetMountRequest
+{
+    FString Filepath; /*!< The pak file, e.g. UPico_AssetFileDownloadResult::GetFilepath */
+    FString ExpectedSha1; /*!< Hex SHA-1 of the file, verification is skipped if empty */
+    int32 PakOrder = 100; /*!< Mount order, files in higher paks win */
+    TArray<FSoftObjectPath> PrimaryAssets; /*!< Loaded once the pak is mounted */
+};
+
+/// <summary>Outcome and timings of mounting an asset file.</summary>
+struct FPicoAssetMountResult
+{
+    FString Filepath;
+    bool bSuccess = false;
+    FString ErrorMessage;
+    int64 FileSize = 0;
+    bool bMemoryMapped = false; /*!< The file was hashed through a memory mapping */
+    double VerifySeconds = 0.0;
+    double MountSeconds = 0.0;
+    double PreloadSeconds = 0.0;
+    double TotalSeconds = 0.0;
+    double GameThreadSeconds = 0.0; /*!< Time the pipeline itself spent on the game thread */
+    double MaxGameThreadSliceSeconds = 0.0; /*!< Longest single stretch of that time */
+    double MaxFrameSeconds = 0.0; /*!< Longest frame while the mount was in progress, includes the engine's share of loading */
+    TArray<TSharedPtr<FStreamableHandle>> PreloadHandles; /*!< Hold on to these to keep the primary assets loaded */
+
+    FString ToString() const;
+};
+
+DECLARE_DELEGATE_OneParam(FPicoAssetMountComplete, const FPicoAssetMountResult& /*Result*/);
+
+/** @addtogroup Function Function
+ *  This is the Function group
+ *  @{
+ */
+
+ /** @defgroup AssetFile AssetFile
+  *  This is the AssetFile group
+  *  @{
+  */
+
+/// <summary>
+/// Gets downloaded asset files into the game without stalling the game thread: the file is hashed (memory mapped when
+/// large) on a worker thread, mounted on the game thread, then its primary assets are streamed in a few at a time.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API FPicoAssetFileMounter
+{
+public:
+    FPicoAssetFileMounter();
+    ~FPicoAssetFileMounter();
+
+    /// <summary>Starts the pipeline. `OnComplete` runs on the game thread once the primary assets are loaded or a step failed.</summary>
+    void Mount(const FPicoAssetMountRequest& Request, FPicoAssetMountComplete OnComplete);
+
+    /// <summary>Runs the same steps on the calling thread, for comparison.</summary>
+    FPicoAssetMountResult MountSynchronously(const FPicoAssetMountRequest& Request);
+
+    void Tick(float DeltaTime);
+
+    int32 GetNumPending() const { return Jobs.Num(); }
+
+private:
+    enum class EStage : uint8
+    {
+        Worker,
+        Preload,
+    };
+
+    struct FJob
+    {
+        FPicoAssetMountRequest Request;
+        FPicoAssetMountComplete OnComplete;
+        FPicoAssetMountResult Result;
+        TFuture<void> WorkerTask;
+        EStage Stage = EStage::Worker;
+        int32 NextPreload = 0;
+        double StartTime = 0.0;
+        double PreloadStartTime = 0.0;
+    };
+
+    struct FSettings
+    {
+        int64 MemoryMapThreshold = 16 * 1024 * 1024;
+        int32 HashChunkSize = 1024 * 1024;
+    };
+
+    /** Thread safe, only touches the file. */
+    static void Verify(const FPicoAssetMountRequest& Request, const FSettings& Settings, FPicoAssetMountResult& Result);
+    /** Game thread only, the pak platform file and the asset registry are not safe to change from other threads. */
+    static void MountPak(const FPicoAssetMountRequest& Request, FPicoAssetMountResult& Result);
+    static bool HashFile(const FString& Filepath, const FSettings& Settings, FPicoAssetMountResult& Result, FString& OutHash);
+
+    /** Returns true once the job is finished. */
+    bool TickJob(FJob& Job, float DeltaTime);
+    void FinishPreload(FJob& Job);
+
+    TArray<TSharedRef<FJob>> Jobs;
+    FStreamableManager StreamableManager;
+    FSettings Settings;
+    int32 PreloadBatchSize = 4;
+};
+
+/** @} */ // end of AssetFile
+/** @} */ // end of Function
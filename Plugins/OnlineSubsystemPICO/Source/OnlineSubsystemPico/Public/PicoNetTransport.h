@@ -0,0 +1,128 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "Math/RandomStream.h"
+
+struct FURL;
+
+/// @file PicoNetTransport.h
+
+/// <summary>
+/// The packet relay under UPicoNetDriver and UPicoNetConnection. The platform implementation wraps `ppf_Net_SendPacket`
+/// and `ppf_Net_ReadPacket`; FPicoLoopbackNetwork hands out in-process endpoints so a server and any number of
+/// clients can run in one process through the same driver code.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API IPicoNetTransport
+{
+public:
+    virtual ~IPicoNetTransport() = default;
+
+    /// <summary>Whether packets can be sent yet.</summary>
+    virtual bool IsReady() const = 0;
+
+    /// <returns>false if the packet could not be queued.</returns>
+    virtual bool Send(const FString& PeerId, const uint8* Data, int32 Size) = 0;
+
+    /// <summary>Calls `Visitor` for every packet received since the last call. The data is only valid during the call.</summary>
+    virtual void ReadPackets(TFunctionRef<void(const FString& /*SenderId*/, uint8* /*Data*/, int32 /*Size*/)> Visitor) = 0;
+
+    /// <summary>The ID peers send to, empty for the platform, which knows it.</summary>
+    virtual FString GetLocalId() const { return FString(); }
+
+    /// <summary>
+    /// Picks the transport for a net driver: a loopback endpoint if the URL has the `PicoLoopback[=<id>]` option or
+    /// bUsePicoLoopbackNetwork is set in [OnlineSubsystemPico], the platform relay otherwise.
+    /// </summary>
+    static TSharedRef<IPicoNetTransport> CreateForUrl(const FURL& URL);
+};
+
+/// <summary>Link conditions of the loopback network, applied to each direction of every endpoint.</summary>
+struct FPicoLoopbackLinkSettings
+{
+    float LatencySeconds = 0.0f; /*!< One way */
+    float JitterSeconds = 0.0f; /*!< Added uniformly on top of the latency, may reorder packets */
+    float LossRate = 0.0f; /*!< 0 to 1 */
+    int32 BytesPerSecond = 0; /*!< Uplink cap of each endpoint, 0 for none */
+    float MaxQueueSeconds = 0.25f; /*!< Packets that would wait longer than this for a capped uplink are dropped */
+};
+
+/// <summary>Traffic of one loopback endpoint.</summary>
+struct FPicoLoopbackEndpointStats
+{
+    int64 PacketsSent = 0;
+    int64 BytesSent = 0;
+    int64 PacketsReceived = 0;
+    int64 BytesReceived = 0;
+    int64 PacketsLost = 0; /*!< Sent and lost to LossRate */
+    int64 PacketsDropped = 0; /*!< Sent and dropped by a full uplink queue, or to an unknown peer */
+};
+
+/// <summary>
+/// In-process stand-in for the PICO packet relay. Endpoints are keyed by numeric user ID strings, like the platform
+/// IDs UPicoNetDriver parses from `<id>.pico` URLs. Thread safe, so drivers of several worlds may share it.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API FPicoLoopbackNetwork : public TSharedFromThis<FPicoLoopbackNetwork>
+{
+public:
+    FPicoLoopbackNetwork();
+
+    /// <summary>The network shared by every loopback net driver of the process.</summary>
+    static TSharedRef<FPicoLoopbackNetwork> Get();
+
+    /// <summary>Creates an endpoint, removed again when the last reference to it goes.</summary>
+    /// <param name="RequestedId">Numeric ID, empty to pick the next free one.</param>
+    TSharedRef<IPicoNetTransport> CreateEndpoint(const FString& RequestedId);
+
+    void SetLinkSettings(const FPicoLoopbackLinkSettings& InSettings);
+    FPicoLoopbackLinkSettings GetLinkSettings() const;
+
+    /// <summary>Runs the network on a simulated clock advanced by AdvanceClock instead of the platform time.</summary>
+    void UseSimulatedClock(bool bInUseSimulatedClock);
+    void AdvanceClock(double DeltaSeconds);
+
+    TMap<FString, FPicoLoopbackEndpointStats> GetStats() const;
+    void ResetStats();
+
+    void Dump(FOutputDevice& Ar) const;
+
+    /// <summary>
+    /// Runs a listen server and 1, 2, 4 ... MaxClients headless clients through UPicoNetDriver and UPicoNetConnection
+    /// on a private network with the given link settings. Every client sends input at 30 Hz and the server sends each one
+    /// with state at 30 Hz, both as control channel messages. Reports per connection throughput and packet rate and the
+    /// server tick cost for every client count.
+    /// </summary>
+    static FString RunLoadTest(int32 MaxClients, float SecondsPerStep, const FPicoLoopbackLinkSettings& LinkSettings);
+
+private:
+    friend class FPicoLoopbackTransport;
+
+    struct FPacket
+    {
+        double DeliveryTime;
+        FString SenderId;
+        TArray<uint8> Data;
+    };
+
+    struct FEndpoint
+    {
+        TArray<FPacket> Incoming; /*!< Heap by delivery time */
+        double UplinkFreeTime = 0.0; /*!< When a capped uplink has sent everything queued */
+        FPicoLoopbackEndpointStats Stats;
+    };
+
+    bool Send(const FString& SenderId, const FString& PeerId, const uint8* Data, int32 Size);
+    void Receive(const FString& Id, TArray<FPacket>& OutPackets);
+    void RemoveEndpoint(const FString& Id);
+    double GetTime() const;
+
+    mutable FCriticalSection Lock;
+    TMap<FString, FEndpoint> Endpoints;
+    FPicoLoopbackLinkSettings Settings;
+    FRandomStream Random;
+    uint64 NextId = 1000;
+    bool bUseSimulatedClock = false;
+    double SimulatedTime = 0.0;
+};
@@ -6,6 +6,7 @@
 #include "OnlineSubsystemPico.h"
 #include "OnlineSubsystemPicoPackage.h"
 #include "OnlineSubsystemPicoNames.h"
+#include "PicoPresenceWriter.h"
 
 
 class FOnlinePicoFriend;
@@ -59,10 +60,18 @@ private:
 
 	TArray<FPicoDestination> DestinationArray;
 
+    TSharedRef<FPicoPresenceWriter> PresenceWriter;
+
 public:
 	FPicoPresenceInterface(FOnlineSubsystemPico& InSubsystem);
 	~FPicoPresenceInterface();
 
+    /// <summary>Sends the presence changes made since the last tick, see FPicoPresenceWriter.</summary>
+    void Tick(float DeltaTime);
+
+    /// <summary>Coalesces the presence setters below into as few requests as possible.</summary>
+    FPicoPresenceWriter& GetPresenceWriter() const { return *PresenceWriter; }
+
     /// <summary>Clears a user's presence data in the current app.</summary>
     /// <param name ="Delegate">Will be executed when the request has been completed.  
     /// Delegate will contain the requested object class (bool /*IsSuccessed*/, const FString& /*Error Message*/).</param>
@@ -120,7 +129,6 @@ public:
     /// </ul>
     /// </returns>
 	bool PresenceSet(const FString& ApiName, const FString& LobbySessionId, const FString& MatchSessionId, bool bIsJoinable, const FString& Extra, const FOnPresenceSetComplete& Delegate = FOnPresenceSetComplete());
-	void OnQueryPresenceSetComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetComplete& Delegate);
 
     /// <summary>Replaces a user's current destination with the provided one.
     /// @note Other presence-related parameters will remain the same.
@@ -135,7 +143,6 @@ public:
     /// </ul>
     /// </returns>
 	bool PresenceSetDestination(const FString& ApiName, const FOnPresenceSetDestinationComplete& Delegate = FOnPresenceSetDestinationComplete());
-	void OnQueryPresenceSetDestinationComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetDestinationComplete& Delegate);
 
     /// <summary>Sets whether a user is joinable.
 	/// @note Other presence-related parameters will remain the same. If the destination or session
@@ -154,7 +161,6 @@ public:
     /// </ul>
     /// </returns>
     bool PresenceSetSetIsJoinable(bool bIsJoinable, const FOnPresenceSetIsJoinableComplete& Delegate = FOnPresenceSetIsJoinableComplete());
-    void OnQueryPresenceSetSetIsJoinableComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetIsJoinableComplete& Delegate);
 
     /// <summary>Replaces a user's current lobby session ID with the provided one.
     /// @note Other presence parameter settings will remain the same.
@@ -169,7 +175,6 @@ public:
     /// </ul>
     /// </returns>
     bool PresenceSetLobbySession(const FString& LobbySession, const FOnPresenceSetLobbySessionComplete& Delegate = FOnPresenceSetLobbySessionComplete());
-    void OnQueryPresenceSetLobbySessionComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetLobbySessionComplete& Delegate);
 
     /// <summary>Replaces a user's current match session ID with the provided one.
     /// @note Other presence parameter settings will remain the same.
@@ -184,7 +189,6 @@ public:
     /// </ul>
     /// </returns>
     bool PresenceSetMatchSession(const FString& MatchSession, const FOnPresenceSetMatchSessionComplete& Delegate = FOnPresenceSetMatchSessionComplete());
-    void OnQueryPresenceSetMatchSessionComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetMatchSessionComplete& Delegate);
 
     /// <summary> 
     /// Sets extra presence data for a user.
@@ -199,7 +203,6 @@ public:
     /// </ul>
     /// </returns>
 	bool PresenceSetExtra(const FString& Extra, const FOnPresenceSetPresenceExtraComplete& Delegate = FOnPresenceSetPresenceExtraComplete());
-	void OnQueryPresenceSetExtraComplete(ppfMessageHandle Message, bool bIsError, const FOnPresenceSetPresenceExtraComplete& Delegate);
 
     /// <summary>Reads a list of sent invitations.
     /// @note Call `GetSendInvitesList` after the Delegate has been executed.
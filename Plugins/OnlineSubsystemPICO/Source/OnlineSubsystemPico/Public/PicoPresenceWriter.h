@@ -0,0 +1,178 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FOnlineSubsystemPico;
+
+/// @file PicoPresenceWriter.h
+
+/// <summary>The presence fields a user can set, as flags.</summary>
+enum class EPicoPresenceField : uint8
+{
+    None = 0,
+    Destination = 1 << 0,
+    LobbySession = 1 << 1,
+    MatchSession = 1 << 2,
+    Extra = 1 << 3,
+    IsJoinable = 1 << 4,
+    All = Destination | LobbySession | MatchSession | Extra | IsJoinable,
+};
+ENUM_CLASS_FLAGS(EPicoPresenceField);
+
+/// <summary>A user's presence in the current app.</summary>
+struct FPicoPresenceState
+{
+    FString DestinationApiName;
+    FString LobbySessionId;
+    FString MatchSessionId;
+    FString Extra;
+    bool bIsJoinable = false;
+
+    /// <summary>Returns the fields that differ from `Other`.</summary>
+    EPicoPresenceField Diff(const FPicoPresenceState& Other) const;
+};
+
+/// <summary>Request rate and latency of the presence writer.</summary>
+struct FPicoPresenceWriterStats
+{
+    int64 NumChanges = 0; /*!< Field changes asked for */
+    int64 NumRequests = 0; /*!< Platform requests sent */
+    int64 NumFailures = 0;
+    int64 NumRetries = 0;
+    int32 RequestsPerMinute = 0; /*!< Requests sent during the last 60 seconds */
+    double LastAppliedLatencySeconds = 0.0; /*!< From the first change of the last applied write until the platform confirmed it */
+};
+
+/// <summary>
+/// Sends presence writes. The platform implementation uses the `ppf_Presence_*` calls, FPicoScriptedPresenceBackend
+/// answers after a scripted delay so the writer can be exercised without a device.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API IPicoPresenceBackend
+{
+public:
+    typedef TFunction<void(bool /*bSuccess*/, const FString& /*ErrorMessage*/)> FOnComplete;
+
+    virtual ~IPicoPresenceBackend() = default;
+
+    /// <summary>Writes `Fields` of `State`, other fields must remain what they are on the server.</summary>
+    /// <returns>The number of platform requests sent.</returns>
+    virtual int32 Write(const FPicoPresenceState& State, EPicoPresenceField Fields, FOnComplete OnComplete) = 0;
+
+    virtual void Tick(float DeltaTime) {}
+};
+
+/// <summary>Answers presence writes after a fixed latency, optionally failing some of them.</summary>
+class ONLINESUBSYSTEMPICO_API FPicoScriptedPresenceBackend : public IPicoPresenceBackend
+{
+public:
+    float LatencySeconds = 0.1f;
+    int32 NumFailuresToInject = 0; /*!< The next this many writes fail */
+    int32 NumWrites = 0;
+    int32 NumRequests = 0;
+    FPicoPresenceState ServerState; /*!< What the server has after the writes answered so far */
+
+    virtual int32 Write(const FPicoPresenceState& State, EPicoPresenceField Fields, FOnComplete OnComplete) override;
+    virtual void Tick(float DeltaTime) override;
+
+private:
+    struct FPendingWrite
+    {
+        float RemainingSeconds;
+        bool bFail;
+        FPicoPresenceState State;
+        EPicoPresenceField Fields;
+        FOnComplete OnComplete;
+    };
+    TArray<FPendingWrite> Pending;
+};
+
+/** @addtogroup Function Function
+ *  This is the Function group
+ *  @{
+ */
+
+/** @defgroup Presence Presence
+ *  This is the Presence group
+ *  @{
+ */
+
+/// <summary>
+/// Coalesces presence changes. Changes made within a frame, or within the debounce window, go out as one write;
+/// only one write is in flight at a time and a newer change supersedes anything not yet sent. Failed writes are
+/// retried with exponential backoff unless a newer change replaced them.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API FPicoPresenceWriter : public TSharedFromThis<FPicoPresenceWriter>
+{
+public:
+    FPicoPresenceWriter(TSharedRef<IPicoPresenceBackend> InBackend);
+
+    /// <summary>Creates the backend that sends `ppf_Presence_*` requests through the subsystem.</summary>
+    static TSharedRef<IPicoPresenceBackend> CreatePlatformBackend(FOnlineSubsystemPico& InSubsystem);
+
+    /// <summary>Changes the given fields. `OnComplete` runs once a write including this change was applied or finally failed.</summary>
+    void Set(const FPicoPresenceState& State, EPicoPresenceField Fields, IPicoPresenceBackend::FOnComplete OnComplete = nullptr);
+
+    /// <summary>Call when a clear is sent by other means. Changes not written yet are dropped, so they do not undo the clear.</summary>
+    void OnClearSent();
+
+    /// <summary>Call once that clear succeeded: all fields are now known to be empty, except for changes made since it was sent.</summary>
+    void OnCleared();
+
+    void Tick(float DeltaTime);
+
+    /// <summary>The presence the writer is heading for, including changes not yet sent.</summary>
+    const FPicoPresenceState& GetDesiredState() const { return Desired; }
+
+    bool IsIdle() const { return DirtyFields == EPicoPresenceField::None && !bInFlight; }
+
+    FPicoPresenceWriterStats GetStats() const;
+
+    void Dump(FOutputDevice& Ar) const;
+
+    /// <summary>Moves between zones at a fixed rate against a scripted backend and compares the request count with one request per setter.</summary>
+    static FString RunScriptedSimulation();
+
+private:
+    typedef TArray<IPicoPresenceBackend::FOnComplete> FWaiters;
+
+    /** The fields to write so that the server ends up with Desired, given what is applied and in flight. */
+    EPicoPresenceField ComputeDirty() const;
+    void Flush();
+    void OnWriteComplete(uint32 WriteId, bool bSuccess, const FString& ErrorMessage);
+    static void CompleteWaiters(FWaiters& Waiters, bool bSuccess, const FString& ErrorMessage);
+
+    TSharedRef<IPicoPresenceBackend> Backend;
+
+    FPicoPresenceState Desired;
+    FPicoPresenceState Applied; /*!< Last confirmed value of every known field */
+    EPicoPresenceField KnownFields = EPicoPresenceField::None; /*!< Fields whose server value is known */
+    EPicoPresenceField TouchedFields = EPicoPresenceField::None; /*!< Fields set through the writer, others are left alone */
+    EPicoPresenceField DirtyFields = EPicoPresenceField::None;
+    FWaiters DirtyWaiters;
+    double FirstChangeTime = 0.0;
+    double LastChangeTime = 0.0;
+
+    bool bInFlight = false;
+    uint32 InFlightId = 0;
+    FPicoPresenceState InFlightState;
+    EPicoPresenceField InFlightFields = EPicoPresenceField::None;
+    FWaiters InFlightWaiters;
+    double InFlightFirstChangeTime = 0.0;
+    int32 Attempts = 0;
+    double RetryTime = 0.0; /*!< No write before this, after a failure */
+
+    double Time = 0.0;
+    float DebounceSeconds = 0.0f; /*!< 0 coalesces the changes of one frame */
+    float MaxDelaySeconds = 1.0f; /*!< A stream of changes is still written at least this often */
+    int32 MaxRetries = 3;
+    float RetrySeconds = 1.0f;
+    float MaxRetrySeconds = 30.0f;
+
+    FPicoPresenceWriterStats Stats;
+    TArray<double> RequestTimes; /*!< Send times during the last minute */
+};
+
+/** @} */ // end of Presence
+/** @} */ // end of Function
@@ -0,0 +1,492 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "PPF_Platform.h"
+
+/// @file PicoRequestFutures.h
+
+class FOnlineSubsystemPico;
+
+/// <summary>Outcome of a request sent through FPicoRequestFutures. `Value` is only meaningful without an error.</summary>
+template<typename T>
+struct TPicoRequestResult
+{
+    bool bIsError = false;
+    bool bTimedOut = false;
+    bool bCancelled = false;
+    int32 ErrorCode = 0;
+    FString ErrorMessage;
+    T Value{};
+
+    static TPicoRequestResult Ok(T InValue)
+    {
+        TPicoRequestResult Result;
+        Result.Value = MoveTemp(InValue);
+        return Result;
+    }
+
+    static TPicoRequestResult Error(const FString& InErrorMessage, int32 InErrorCode = 0)
+    {
+        TPicoRequestResult Result;
+        Result.bIsError = true;
+        Result.ErrorCode = InErrorCode;
+        Result.ErrorMessage = InErrorMessage;
+        return Result;
+    }
+
+    /** Carries the error of a request of another type, e.g. the failed step of a chain. */
+    template<typename OtherType>
+    static TPicoRequestResult FromError(const TPicoRequestResult<OtherType>& Other)
+    {
+        TPicoRequestResult Result = Error(Other.ErrorMessage, Other.ErrorCode);
+        Result.bTimedOut = Other.bTimedOut;
+        Result.bCancelled = Other.bCancelled;
+        return Result;
+    }
+};
+
+template<typename T>
+struct TPicoFutureValue;
+
+template<typename T>
+struct TPicoFutureValue<TFuture<T>>
+{
+    typedef T Type;
+};
+
+/// <summary>Cancels every request it was passed to. Copies share the same state. Game thread only.</summary>
+class ONLINESUBSYSTEMPICO_API FPicoCancelToken
+{
+public:
+    FPicoCancelToken();
+
+    void Cancel();
+    bool IsCancelled() const { return State->bCancelled; }
+
+    /** Runs OnCancel when the token is cancelled, or right away if it already is. */
+    void OnCancel(TFunction<void()> OnCancel) const;
+
+private:
+    struct FState
+    {
+        bool bCancelled = false;
+        TArray<TFunction<void()>> OnCancel;
+    };
+    TSharedRef<FState> State;
+};
+
+/// <summary>One request in the latency trace.</summary>
+struct FPicoRequestTrace
+{
+    enum class EOutcome : uint8
+    {
+        Succeeded,
+        Failed,
+        TimedOut,
+        Cancelled,
+    };
+
+    FString Name;
+    uint64 RequestId = 0;
+    double SendTime = 0.0;
+    double LatencySeconds = 0.0;
+    EOutcome Outcome = EOutcome::Succeeded;
+};
+
+/// <summary>Latency of all traced requests of one name.</summary>
+struct FPicoRequestStats
+{
+    int64 Count = 0;
+    int64 NumFailed = 0;
+    double TotalSeconds = 0.0;
+    double MaxSeconds = 0.0;
+};
+
+/// <summary>Scripted stand-in for the SDK message queue: answers are delivered after a scripted latency as it is ticked.</summary>
+class ONLINESUBSYSTEMPICO_API FPicoScriptedMessageQueue
+{
+public:
+    /// <summary>Runs `Respond` once `LatencySeconds` have been ticked. Returns a request ID for the trace.</summary>
+    uint64 Post(float LatencySeconds, TFunction<void()> Respond);
+
+    void Tick(float DeltaTime);
+
+    int32 Num() const { return Posted.Num(); }
+    double GetTime() const { return Time; }
+
+private:
+    struct FPosted
+    {
+        double DueTime = 0.0;
+        TFunction<void()> Respond;
+    };
+
+    TArray<FPosted> Posted;
+    double Time = 0.0;
+    uint64 NextRequestId = 1;
+};
+
+/** @addtogroup Function Function
+ *  This is the Function group
+ *  @{
+ */
+
+ /** @defgroup Requests Requests
+  *  This is the Requests group
+  *  @{
+  */
+
+/// <summary>
+/// Sends ppfRequests and hands back a TFuture instead of taking a callback, so independent requests can be issued
+/// together and composed with the combinators in `PicoFutures`. Futures are fulfilled on the game thread, and every
+/// request is recorded in a latency trace.
+/// </summary>
+class ONLINESUBSYSTEMPICO_API FPicoRequestFutures
+{
+public:
+    /// <param name="InSubsystem">Sends real requests. Null for a scripted only instance on a simulated clock.</param>
+    FPicoRequestFutures(FOnlineSubsystemPico* InSubsystem);
+    ~FPicoRequestFutures();
+
+    /// <summary>
+    /// Sends an already issued request. `Decode` turns the response into the future's value; it runs on the game thread
+    /// while the message is valid.
+    /// </summary>
+    /// <param name="Name">Name of the request in the latency trace.</param>
+    /// <param name="RequestId">The request returned by a `ppf_*` call.</param>
+    /// <param name="Decode">Reads the value out of the response.</param>
+    /// <param name="TimeoutSeconds">Fails the future when there is no response in time. 0 for no timeout.</param>
+    /// <param name="CancelToken">Fails the future when cancelled. Optional.</param>
+    template<typename T>
+    TFuture<TPicoRequestResult<T>> Send(const TCHAR* Name, ppfRequest RequestId, TFunction<T(ppfMessageHandle)> Decode,
+        float TimeoutSeconds = 0.0f, const FPicoCancelToken* CancelToken = nullptr);
+
+    /// <summary>Same as Send, answered with `Response` by the scripted message queue after `LatencySeconds`.</summary>
+    template<typename T>
+    TFuture<TPicoRequestResult<T>> SendScripted(const TCHAR* Name, float LatencySeconds, TPicoRequestResult<T> Response,
+        float TimeoutSeconds = 0.0f, const FPicoCancelToken* CancelToken = nullptr);
+
+    /// <summary>Fails with a timeout if `Future` is not ready after `Seconds`, e.g. to bound a whole chain.</summary>
+    template<typename T>
+    TFuture<TPicoRequestResult<T>> WithTimeout(TFuture<TPicoRequestResult<T>>&& Future, float Seconds);
+
+    void Tick(float DeltaTime);
+
+    double GetTime() const;
+    int32 GetNumPending() const { return Pending.Num(); }
+    FPicoScriptedMessageQueue& GetScriptedQueue() { return ScriptedQueue; }
+
+    const TMap<FString, FPicoRequestStats>& GetStats() const { return Stats; }
+
+    /// <summary>The most recent requests, oldest first.</summary>
+    void GetTrace(TArray<FPicoRequestTrace>& OutTrace) const;
+
+    void DumpTrace(FOutputDevice& Ar, int32 NumRecent) const;
+
+private:
+    struct FPendingRequest
+    {
+        virtual ~FPendingRequest() = default;
+        virtual void Fail(FPicoRequestTrace::EOutcome Outcome, const FString& ErrorMessage) = 0;
+
+        FString Name;
+        uint64 RequestId = 0;
+        double SendTime = 0.0;
+        double Deadline = 0.0;
+        double CompleteTime = -1.0;
+        bool bDone = false;
+        FPicoRequestTrace::EOutcome Outcome = FPicoRequestTrace::EOutcome::Succeeded;
+    };
+
+    template<typename T>
+    struct TPendingRequest : public FPendingRequest
+    {
+        TPromise<TPicoRequestResult<T>> Promise;
+
+        void Resolve(TPicoRequestResult<T>&& Result)
+        {
+            if (bDone)
+            {
+                return;
+            }
+            bDone = true;
+            Outcome = !Result.bIsError ? FPicoRequestTrace::EOutcome::Succeeded
+                : (Result.bTimedOut ? FPicoRequestTrace::EOutcome::TimedOut
+                : (Result.bCancelled ? FPicoRequestTrace::EOutcome::Cancelled : FPicoRequestTrace::EOutcome::Failed));
+            Promise.SetValue(MoveTemp(Result));
+        }
+
+        virtual void Fail(FPicoRequestTrace::EOutcome InOutcome, const FString& ErrorMessage) override
+        {
+            TPicoRequestResult<T> Result = TPicoRequestResult<T>::Error(ErrorMessage);
+            Result.bTimedOut = InOutcome == FPicoRequestTrace::EOutcome::TimedOut;
+            Result.bCancelled = InOutcome == FPicoRequestTrace::EOutcome::Cancelled;
+            Resolve(MoveTemp(Result));
+        }
+    };
+
+    struct FTimer
+    {
+        double Deadline = 0.0;
+        TFunction<void()> OnExpired;
+    };
+
+    template<typename T>
+    TSharedRef<TPendingRequest<T>> AddPending(const TCHAR* Name, uint64 RequestId, float TimeoutSeconds, const FPicoCancelToken* CancelToken);
+
+    /**
+     * Registers the request with the subsystem; `Resolve` runs with the response unless the request already failed.
+     * The response only holds the request weakly, it may arrive after this object is gone.
+     */
+    void SendRequest(ppfRequest RequestId, const TSharedRef<FPendingRequest>& Request, TFunction<void(FPendingRequest&, ppfMessageHandle, bool)>&& Resolve);
+
+    void RecordTrace(const FPendingRequest& Request);
+
+    FOnlineSubsystemPico* PicoSubsystem;
+    FPicoScriptedMessageQueue ScriptedQueue;
+    double SimulatedTime = 0.0;
+
+    TMap<uint64, TSharedRef<FPendingRequest>> Pending;
+    uint64 NextSequence = 1;
+    TArray<FTimer> Timers;
+
+    TArray<FPicoRequestTrace> Trace;
+    int32 TraceHead = 0;
+    int32 TraceCapacity = 256;
+    TMap<FString, FPicoRequestStats> Stats;
+};
+
+template<typename T>
+TSharedRef<FPicoRequestFutures::TPendingRequest<T>> FPicoRequestFutures::AddPending(const TCHAR* Name, uint64 RequestId, float TimeoutSeconds, const FPicoCancelToken* CancelToken)
+{
+    TSharedRef<TPendingRequest<T>> Request = MakeShared<TPendingRequest<T>>();
+    Request->Name = Name;
+    Request->RequestId = RequestId;
+    Request->SendTime = GetTime();
+    Request->Deadline = TimeoutSeconds > 0.0f ? Request->SendTime + TimeoutSeconds : 0.0;
+    Pending.Add(NextSequence++, Request);
+
+    if (CancelToken)
+    {
+        TWeakPtr<TPendingRequest<T>> WeakRequest = Request;
+        CancelToken->OnCancel([WeakRequest]()
+            {
+                if (TSharedPtr<TPendingRequest<T>> Cancelled = WeakRequest.Pin())
+                {
+                    Cancelled->Fail(FPicoRequestTrace::EOutcome::Cancelled, TEXT("Cancelled"));
+                }
+            });
+    }
+    return Request;
+}
+
+template<typename T>
+TFuture<TPicoRequestResult<T>> FPicoRequestFutures::Send(const TCHAR* Name, ppfRequest RequestId, TFunction<T(ppfMessageHandle)> Decode,
+    float TimeoutSeconds, const FPicoCancelToken* CancelToken)
+{
+    check(PicoSubsystem);
+    TSharedRef<TPendingRequest<T>> Request = AddPending<T>(Name, RequestId, TimeoutSeconds, CancelToken);
+    TFuture<TPicoRequestResult<T>> Future = Request->Promise.GetFuture();
+    if (RequestId == 0)
+    {
+        Request->Fail(FPicoRequestTrace::EOutcome::Failed, TEXT("Sending request failed"));
+        return Future;
+    }
+
+    SendRequest(RequestId, Request, [Decode = MoveTemp(Decode)](FPendingRequest& Pending, ppfMessageHandle Message, bool bIsError)
+        {
+            TPicoRequestResult<T> Result;
+            if (bIsError)
+            {
+                ppfErrorHandle Error = ppf_Message_GetError(Message);
+                Result = TPicoRequestResult<T>::Error(UTF8_TO_TCHAR(ppf_Error_GetMessage(Error)), ppf_Error_GetCode(Error));
+            }
+            else
+            {
+                Result.Value = Decode(Message);
+            }
+            static_cast<TPendingRequest<T>&>(Pending).Resolve(MoveTemp(Result));
+        });
+    return Future;
+}
+
+template<typename T>
+TFuture<TPicoRequestResult<T>> FPicoRequestFutures::SendScripted(const TCHAR* Name, float LatencySeconds, TPicoRequestResult<T> Response,
+    float TimeoutSeconds, const FPicoCancelToken* CancelToken)
+{
+    TSharedRef<TPendingRequest<T>> Request = AddPending<T>(Name, 0, TimeoutSeconds, CancelToken);
+    TWeakPtr<TPendingRequest<T>> WeakRequest = Request;
+    Request->RequestId = ScriptedQueue.Post(LatencySeconds, [WeakRequest, Response = MoveTemp(Response)]() mutable
+        {
+            if (TSharedPtr<TPendingRequest<T>> Answered = WeakRequest.Pin())
+            {
+                Answered->Resolve(MoveTemp(Response));
+            }
+        });
+    return Request->Promise.GetFuture();
+}
+
+template<typename T>
+TFuture<TPicoRequestResult<T>> FPicoRequestFutures::WithTimeout(TFuture<TPicoRequestResult<T>>&& Future, float Seconds)
+{
+    struct FState
+    {
+        TPromise<TPicoRequestResult<T>> Promise;
+        bool bDone = false;
+    };
+    TSharedRef<FState> State = MakeShared<FState>();
+    TFuture<TPicoRequestResult<T>> Result = State->Promise.GetFuture();
+
+    FTimer& Timer = Timers.AddDefaulted_GetRef();
+    Timer.Deadline = GetTime() + Seconds;
+    Timer.OnExpired = [State]()
+    {
+        if (!State->bDone)
+        {
+            State->bDone = true;
+            TPicoRequestResult<T> TimedOut = TPicoRequestResult<T>::Error(TEXT("Timed out"));
+            TimedOut.bTimedOut = true;
+            State->Promise.SetValue(MoveTemp(TimedOut));
+        }
+    };
+
+    Future.Then([State](TFuture<TPicoRequestResult<T>> Done)
+        {
+            if (!State->bDone)
+            {
+                State->bDone = true;
+                State->Promise.SetValue(Done.Get());
+            }
+        });
+    return Result;
+}
+
+/// <summary>Combinators for request futures. Continuations run where the future is fulfilled, the game thread for requests.</summary>
+namespace PicoFutures
+{
+    /// <summary>Ready when all futures are, with their values in order.</summary>
+    template<typename T>
+    TFuture<TArray<T>> WhenAll(TArray<TFuture<T>>&& Futures)
+    {
+        struct FState
+        {
+            TPromise<TArray<T>> Promise;
+            TArray<T> Values;
+            int32 Remaining = 0;
+        };
+        TSharedRef<FState> State = MakeShared<FState>();
+        TFuture<TArray<T>> Result = State->Promise.GetFuture();
+        State->Values.SetNum(Futures.Num());
+        State->Remaining = Futures.Num();
+        if (Futures.Num() == 0)
+        {
+            State->Promise.SetValue(TArray<T>());
+            return Result;
+        }
+
+        for (int32 Index = 0; Index < Futures.Num(); ++Index)
+        {
+            Futures[Index].Then([State, Index](TFuture<T> Done)
+                {
+                    State->Values[Index] = Done.Get();
+                    if (--State->Remaining == 0)
+                    {
+                        State->Promise.SetValue(MoveTemp(State->Values));
+                    }
+                });
+        }
+        return Result;
+    }
+
+    /// <summary>Ready when both futures are.</summary>
+    template<typename FirstType, typename SecondType>
+    TFuture<TTuple<FirstType, SecondType>> WhenAll(TFuture<FirstType>&& First, TFuture<SecondType>&& Second)
+    {
+        struct FState
+        {
+            TPromise<TTuple<FirstType, SecondType>> Promise;
+            TTuple<FirstType, SecondType> Values;
+            int32 Remaining = 2;
+        };
+        TSharedRef<FState> State = MakeShared<FState>();
+        TFuture<TTuple<FirstType, SecondType>> Result = State->Promise.GetFuture();
+
+        First.Then([State](TFuture<FirstType> Done)
+            {
+                State->Values.template Get<0>() = Done.Get();
+                if (--State->Remaining == 0)
+                {
+                    State->Promise.SetValue(MoveTemp(State->Values));
+                }
+            });
+        Second.Then([State](TFuture<SecondType> Done)
+            {
+                State->Values.template Get<1>() = Done.Get();
+                if (--State->Remaining == 0)
+                {
+                    State->Promise.SetValue(MoveTemp(State->Values));
+                }
+            });
+        return Result;
+    }
+
+    /// <summary>Ready with the index and value of the first future that is.</summary>
+    template<typename T>
+    TFuture<TPair<int32, T>> WhenAny(TArray<TFuture<T>>&& Futures)
+    {
+        struct FState
+        {
+            TPromise<TPair<int32, T>> Promise;
+            bool bDone = false;
+        };
+        TSharedRef<FState> State = MakeShared<FState>();
+        TFuture<TPair<int32, T>> Result = State->Promise.GetFuture();
+
+        for (int32 Index = 0; Index < Futures.Num(); ++Index)
+        {
+            Futures[Index].Then([State, Index](TFuture<T> Done)
+                {
+                    if (!State->bDone)
+                    {
+                        State->bDone = true;
+                        State->Promise.SetValue(TPair<int32, T>(Index, Done.Get()));
+                    }
+                });
+        }
+        return Result;
+    }
+
+    /// <summary>
+    /// Runs `Continuation` with the value of a successful request and waits for the future it returns, so requests
+    /// can be chained without nesting. An error skips the continuation and is passed on.
+    /// </summary>
+    template<typename T, typename FuncType>
+    auto Then(TFuture<TPicoRequestResult<T>>&& Future, FuncType&& Continuation) -> decltype(Continuation(DeclVal<const T&>()))
+    {
+        typedef decltype(Continuation(DeclVal<const T&>())) FNextFuture;
+        typedef typename TPicoFutureValue<FNextFuture>::Type FNextResult;
+
+        TSharedRef<TPromise<FNextResult>> Promise = MakeShared<TPromise<FNextResult>>();
+        FNextFuture Result = Promise->GetFuture();
+        Future.Then([Promise, Continuation = Forward<FuncType>(Continuation)](TFuture<TPicoRequestResult<T>> Done) mutable
+            {
+                const TPicoRequestResult<T>& Previous = Done.Get();
+                if (Previous.bIsError)
+                {
+                    Promise->SetValue(FNextResult::FromError(Previous));
+                    return;
+                }
+                Continuation(Previous.Value).Then([Promise](FNextFuture Next)
+                    {
+                        Promise->SetValue(Next.Get());
+                    });
+            });
+        return Result;
+    }
+}
+
+/** @} */ // end of Requests
+/** @} */ // end of Function
@@ -7,6 +7,7 @@
 #include "OnlineSubsystemPicoNames.h"
 #include "OnlineSubsystemPico.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "PicoAchievementWriteQueue.h"
 #include "Pico_Achievements.generated.h"
 
 /// @file Pico_Achievements.h
@@ -47,10 +48,24 @@ private:
 
     FOnlineSubsystemPico& PicoSubsystem;
 
+    TSharedRef<FPicoAchievementWriteQueue> WriteQueue;
+
+    FDelegateHandle LoginCompleteHandle;
+    /** The write queue is kept per user. */
+    void OnLoginComplete(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserId, const FString& Error);
+
 public:
     FPicoAchievementsInterface(FOnlineSubsystemPico& InSubsystem);
     ~FPicoAchievementsInterface();
 
+    /// <summary>Sends the queued achievement writes that are due, see FPicoAchievementWriteQueue.</summary>
+    void Tick(float DeltaTime);
+
+    /// <summary>Saves the queued achievement writes and sends them on the next tick, e.g. at the end of a level.</summary>
+    void Checkpoint();
+
+    FPicoAchievementWriteQueue& GetWriteQueue() const { return *WriteQueue; }
+
     FAddCount AddCountDelegate;
     FAddFields AddFieldsDelegate;
     FUnlock UnlockDelegate;
@@ -61,6 +76,7 @@ public:
 
     /// <summary>Adds a count to a specified count achievement. The count will be added to the current count,
     /// for example, if the current count is 1 and the count you would like to add is 7, the final count will be 8 if the request succeeds.
+    /// Counts added to the same achievement are merged and sent together, and kept across restarts until the server has them.
     /// @note Available to count achievements only.
     /// </summary>
     /// <param name="Name">The API name of the achievement.</param>
@@ -80,6 +96,7 @@ public:
     bool AddCount(const FString& Name, const int64& Count, const FString& ExtraData, FAddCount InAddCountDelegate);
 
     /// <summary>Unlocks the bit(s) of a specified bitfield achievement. The status of the bit(s) is then unchangeable.
+    /// Bits unlocked for the same achievement are merged and sent together, and kept across restarts until the server has them.
     /// @note Available to bitfield achievements only.
     /// </summary>
     /// <param name="Name">The API name of the achievement to unlock bit(s) for.</param>
@@ -97,7 +114,9 @@ public:
     /// </returns>
     bool AddFields(const FString& Name, const FString& Fields, const FString& ExtraData, FAddFields InAddFieldsCallback);
 
-    /// <summary>Unlocks a specified achievement of any type even if the target for unlocking this achievement is not reached.</summary>
+    /// <summary>Unlocks a specified achievement of any type even if the target for unlocking this achievement is not reached.
+    /// Sent on the next tick, and kept across restarts until the server has it.
+    /// </summary>
     /// <param name="Name">The API name of the achievement to unlock.</param>
     /// <param name="ExtraData">Custom extension fields that can be used to record key information when unlocking achievements.</param>
     /// <param name="InUnlockCallback">Will be executed when the request has been completed. 
@@ -196,6 +215,7 @@ public:
 
     /// <summary>Adds a count to a specified count achievement. The count will be added to the current count,
     /// for example, if the current count is 1 and the count you would like to add is 7, the final count will be 8 if the request succeeds.
+    /// Counts added to the same achievement are merged and sent together, and kept across restarts until the server has them.
     /// @note Available to count achievements only.
     /// </summary>
     /// <param name ="WorldContextObject">Used to get the information about the current world.</param>
@@ -210,6 +230,7 @@ public:
     static void PicoAddCount(UObject* WorldContextObject, const FString& Name, const FString& Count, const FString& ExtraData, FAddCount InAddCountCallback);
 
     /// <summary>Unlocks the bit(s) of a specified bitfield achievement. The status of the bit(s) is then unchangeable.
+    /// Bits unlocked for the same achievement are merged and sent together, and kept across restarts until the server has them.
     /// @note Available to bitfield achievements only.
     /// </summary>
     /// <param name ="WorldContextObject">Used to get the information about the current world.</param>
@@ -294,6 +315,7 @@ class ONLINESUBSYSTEMPICO_API UPico_AchievementUpdate : public UObject
     
 public:
     void InitParams(ppfAchievementUpdateHandle ppfAchievementUpdateHandle);
+    void InitParams(const FString& InName, bool bInJustUnlocked);
 
 private:
     FString Name = FString();
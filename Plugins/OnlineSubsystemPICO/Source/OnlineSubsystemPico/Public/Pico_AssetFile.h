@@ -7,6 +7,7 @@
 #include "PPF_Platform.h"
 #include "OnlineSubsystemPicoNames.h"
 #include "OnlineSubsystemPico.h"
+#include "PicoAssetFileMounter.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Pico_AssetFile.generated.h"
 
@@ -17,6 +18,29 @@
  */
 DECLARE_LOG_CATEGORY_EXTERN(PicoAssetFile, Log, All);
 
+/// <summary>Download progress of an asset file as plain data. Used for the frequent download update notification.</summary>
+USTRUCT(BlueprintType, meta = (DisplayName = "PicoAssetFileDownloadUpdateData"))
+struct FPicoAssetFileDownloadUpdateData
+{
+    GENERATED_USTRUCT_BODY()
+
+    UPROPERTY(BlueprintReadOnly, Category = "AssetFile")
+    FString AssetId; /*!< The ID of the DLC file */
+
+    UPROPERTY(BlueprintReadOnly, Category = "AssetFile")
+    int64 BytesTotal = 0; /*!< The total bytes of the DLC file */
+
+    UPROPERTY(BlueprintReadOnly, Category = "AssetFile")
+    int64 BytesTransferred = 0; /*!< The transferred bytes of the DLC file */
+
+    UPROPERTY(BlueprintReadOnly, Category = "AssetFile")
+    EAssetFileDownloadCompleteStatus CompleteStatus = EAssetFileDownloadCompleteStatus::Unkonw; /*!< The download status of the DLC file */
+
+    ppfID ppfAssetId = 0;
+
+    void InitParams(ppfAssetFileDownloadUpdateHandle InppfAssetFileDownloadUpdateHandle);
+};
+
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FAssetFileDeleteResult, bool, bIsError, const FString&, ErrorMessage, UPico_AssetFileDeleteResult*, DeleteResult);
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FAssetFileDownloadResult, bool, bIsError, const FString&, ErrorMessage, UPico_AssetFileDownloadResult*, DownloadResult);
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FAssetFileDownloadCancelResult, bool, bIsError, const FString&, ErrorMessage, UPico_AssetFileDownloadCancelResult*, DownloadCancelResult);
@@ -24,10 +48,10 @@ DECLARE_DYNAMIC_DELEGATE_ThreeParams(FGetAssetFileStatus, bool, bIsError, const
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FGetAssetFileList, bool, bIsError, const FString&, ErrorMessage, UPico_AssetDetailsArray*, AssetDetailsArray);
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FAssetFileDownloadUpdateNotify, UPico_AssetFileDownloadUpdate* /*AssetFileDownloadUpdateObj*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FAssetFileDownloadUpdateDataNotify, const FPicoAssetFileDownloadUpdateData& /*DownloadUpdate*/);
 DECLARE_MULTICAST_DELEGATE_OneParam(FAssetFileDeleteForSafetyNotify, UPico_AssetFileDeleteForSafety* /*AssetFileDeleteForSafetyObj*/);
 
 
-
 /** @addtogroup Function Function
  *  This is the Function group
  *  @{
@@ -68,6 +92,15 @@ public:
     /// </summary>
     FAssetFileDownloadUpdateNotify AssetFileDownloadUpdateCallback;
 
+    /// <summary>
+    /// Same as `AssetFileDownloadUpdateCallback`, without creating a UObject per update.
+    /// The data is only valid during the broadcast.
+    /// </summary>
+    FAssetFileDownloadUpdateDataNotify AssetFileDownloadUpdateDataCallback;
+
+    /// <summary>Wraps download progress in a UPico_AssetFileDownloadUpdate for Blueprint listeners.</summary>
+    static UPico_AssetFileDownloadUpdate* CreateDownloadUpdateObject(const FPicoAssetFileDownloadUpdateData& DownloadUpdate);
+
     /// <summary>
     /// Sets the callback to automatically delete a downloaded asset file if it is different from the original one,
     /// and the app will receive a notification. 
@@ -216,11 +249,51 @@ public:
     /// </returns>     
     bool GetAssetFileStatusByName(FString AssetFileName, FGetAssetFileStatus InGetAssetFileStatusByNameDelegate);
 
+    /// <summary>
+    /// Verifies a downloaded asset file on a worker thread, mounts it on the game thread, then loads its primary assets
+    /// a few at a time so the game thread does not hitch.
+    /// </summary>
+    /// <param name="Request">The pak file, its expected hash and the assets to preload.</param>
+    /// <param name="OnComplete">Executed on the game thread once the assets are loaded or a step failed.</param>
+    void MountAssetFile(const FPicoAssetMountRequest& Request, FPicoAssetMountComplete OnComplete);
+
+    /// <summary>
+    /// Downloads an asset file by asset file ID and passes it to `MountAssetFile` once the download completes.
+    /// `Request.Filepath` is taken from the download result.
+    /// </summary>
+    /// <param name="AssetFileID">The ID of the asset file to download.</param>
+    /// <param name="Request">The expected hash and the assets to preload.</param>
+    /// <param name="OnComplete">Executed on the game thread once the assets are loaded or a step failed.</param>
+    /// <returns>Bool:
+    /// <ul>
+    /// <li>`true`: Sending request succeeded</li>
+    /// <li>`false`: Sending request failed</li>
+    /// </ul>
+    /// </returns>
+    bool DownloadAndMountById(FString AssetFileID, const FPicoAssetMountRequest& Request, FPicoAssetMountComplete OnComplete);
+
+    void Tick(float DeltaTime);
+
     FDelegateHandle AssetFileDownloadUpdateHandle;
     void OnAssetFileDownloadUpdate(ppfMessageHandle Message, bool bIsError);
+    FPicoAssetFileDownloadUpdateData DownloadUpdateData;
 
     FDelegateHandle AssetFileDeleteForSafetyHandle;
     void OnAssetFileDeleteForSafety(ppfMessageHandle Message, bool bIsError);
+
+private:
+    /** A DownloadAndMountById waiting for both its download result (the file path) and the completed download. */
+    struct FPendingMount
+    {
+        FPicoAssetMountRequest Request;
+        FPicoAssetMountComplete OnComplete;
+        bool bDownloaded = false;
+    };
+
+    void UpdatePendingMount(const FString& AssetFileID, const FString* Filepath, EAssetFileDownloadCompleteStatus Status, const FString& ErrorMessage);
+
+    FPicoAssetFileMounter Mounter;
+    TMap<FString, FPendingMount> PendingMounts;
 };
 
 
@@ -613,6 +686,7 @@ class ONLINESUBSYSTEMPICO_API UPico_AssetFileDownloadUpdate : public UObject
 
 public:
     void InitParams(ppfAssetFileDownloadUpdate* InppfAssetFileDownloadUpdateHandle);
+    void InitParams(const FPicoAssetFileDownloadUpdateData& InDownloadUpdate);
 
 private:
     FString AssetId = FString();
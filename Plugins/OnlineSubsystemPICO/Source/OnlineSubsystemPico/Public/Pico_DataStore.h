@@ -28,6 +28,7 @@ private:
 
 public:
 	void InitParams(ppfDataStore* InppfDataStoreHandle);
+	void InitParams(const TMap<FString, FString>& InDataStoreMap);
 
 	/** @brief With UserId as the key, find its index in the DataStoreMap data structure.*/
 	UFUNCTION(BlueprintPure, Category = "Pico Platform|Misc|Data Store")
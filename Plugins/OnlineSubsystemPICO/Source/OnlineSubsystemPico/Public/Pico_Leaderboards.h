@@ -41,6 +41,78 @@ DECLARE_DYNAMIC_DELEGATE_ThreeParams(FWriteEntryWithSupplementaryMetric, bool, b
  *  @{
  */
 
+/// @brief One page of leaderboard entries, stored column by column so a cached page costs a handful of arrays instead of a UObject per entry.
+struct ONLINESUBSYSTEMPICO_API FPicoLeaderboardPage
+{
+    TArray<ppfID> IDs;
+    TArray<int32> Ranks;
+    TArray<int64> Scores;
+    TArray<uint64> Timestamps;
+    TArray<FString> DisplayScores;
+    TArray<FString> UserIDs;
+    TArray<FString> UserDisplayNames;
+    TArray<FString> UserImageUrls;
+    TArray<FString> UserSmallImageUrls;
+    /** The supplementary metric columns are only meaningful where `HasSupplementaryMetric` is set. */
+    TBitArray<> HasSupplementaryMetric;
+    TArray<ppfID> SupplementaryMetricIDs;
+    TArray<int64> SupplementaryMetrics;
+    /** The extra data of entry `i` is `ExtraData[ExtraDataOffsets[i], ExtraDataOffsets[i + 1])`. */
+    TArray<int32> ExtraDataOffsets;
+    TArray<uint8> ExtraData;
+    unsigned long long TotalSize = 0;
+    bool bHasNextPage = false;
+    bool bHasPreviousPage = false;
+
+    void InitParams(ppfLeaderboardEntryArrayHandle InppfLeaderboardEntryArrayHandle);
+    int32 Num() const { return IDs.Num(); }
+    SIZE_T GetAllocatedSize() const;
+};
+
+/// @brief Identifies a page of `GetEntries` or `GetEntriesAfterRank`.
+struct FPicoLeaderboardPageKey
+{
+    FString LeaderboardName;
+    int32 PageIdx = 0;
+    int32 PageSize = 0;
+    /** `GetEntries` pages. */
+    ppfLeaderboardFilterType Filter = ppfLeaderboard_FilterNone;
+    ppfLeaderboardStartAt StartAt = ppfLeaderboard_StartAtTop;
+    /** `GetEntriesAfterRank` pages. */
+    bool bAfterRank = false;
+    unsigned long long AfterRank = 0;
+
+    bool operator==(const FPicoLeaderboardPageKey& Other) const
+    {
+        return PageIdx == Other.PageIdx && PageSize == Other.PageSize && Filter == Other.Filter && StartAt == Other.StartAt
+            && bAfterRank == Other.bAfterRank && AfterRank == Other.AfterRank && LeaderboardName == Other.LeaderboardName;
+    }
+
+    friend uint32 GetTypeHash(const FPicoLeaderboardPageKey& Key)
+    {
+        uint32 Hash = HashCombine(GetTypeHash(Key.LeaderboardName), GetTypeHash(Key.PageIdx));
+        Hash = HashCombine(Hash, GetTypeHash(Key.PageSize));
+        Hash = HashCombine(Hash, GetTypeHash(((int32)Key.Filter << 8) | ((int32)Key.StartAt << 1) | (Key.bAfterRank ? 1 : 0)));
+        return HashCombine(Hash, GetTypeHash((uint64)Key.AfterRank));
+    }
+};
+
+/// @brief Counters of the leaderboard page cache since startup.
+struct FPicoLeaderboardCacheStats
+{
+    /** Pages served from the cache or joined to a request already in flight. */
+    int64 Hits = 0;
+    int64 Misses = 0;
+    /** Page requests sent to the platform, prefetches included. */
+    int64 Requests = 0;
+    int64 Prefetches = 0;
+    int64 Invalidations = 0;
+    int32 CachedPages = 0;
+    SIZE_T CachedBytes = 0;
+
+    float GetHitRate() const { return Hits + Misses > 0 ? (float)Hits / (float)(Hits + Misses) : 0.f; }
+};
+
 /// @brief PicoLeaderboardsInterface class.
 class ONLINESUBSYSTEMPICO_API FPicoLeaderboardsInterface
 {
@@ -48,10 +120,49 @@ private:
 
     FOnlineSubsystemPico& PicoSubsystem;
 
+    typedef TFunction<void(bool bIsError, const FString& ErrorMessage, const TSharedPtr<const FPicoLeaderboardPage>& Page)> FOnPageReady;
+
+    struct FCachedPage
+    {
+        TSharedPtr<const FPicoLeaderboardPage> Page;
+        uint64 LastUsed = 0;
+    };
+
+    struct FPendingPage
+    {
+        /** Empty for prefetches nobody has asked for yet. */
+        TArray<FOnPageReady> Callbacks;
+        uint32 Generation = 0;
+    };
+
+    /** Pages by key, evicted least recently used first once there are more than `MaxCachedPages`. */
+    TMap<FPicoLeaderboardPageKey, FCachedPage> PageCache;
+    TMap<FPicoLeaderboardPageKey, FPendingPage> PendingPages;
+    /** Bumped by every successful score write, so pages requested before the write are not cached. */
+    TMap<FString, uint32> LeaderboardGenerations;
+    uint64 UseCounter = 0;
+    int32 MaxCachedPages = 64;
+    bool bPrefetchAdjacentPages = true;
+    FPicoLeaderboardCacheStats CacheStats;
+
+    void RequestPage(const FPicoLeaderboardPageKey& Key, FOnPageReady OnPageReady);
+    void SendPageRequest(const FPicoLeaderboardPageKey& Key);
+    void OnPageRequestComplete(ppfMessageHandle Message, bool bIsError, FPicoLeaderboardPageKey Key);
+    void AddToCache(const FPicoLeaderboardPageKey& Key, const TSharedPtr<const FPicoLeaderboardPage>& Page);
+    void PrefetchAdjacentPages(const FPicoLeaderboardPageKey& Key, const FPicoLeaderboardPage& Page);
+    uint32 GetGeneration(const FString& LeaderboardName) const;
+
 public:
     FPicoLeaderboardsInterface(FOnlineSubsystemPico& InSubsystem);
     ~FPicoLeaderboardsInterface();
 
+    /// <summary>Drops the cached pages of a leaderboard. Called after a successful score write.</summary>
+    /// <param name="LeaderboardName">Leaderboard name.</param>
+    void InvalidateLeaderboard(const FString& LeaderboardName);
+
+    /// <summary>Gets the counters of the page cache used by `GetEntries` and `GetEntriesAfterRank`.</summary>
+    FPicoLeaderboardCacheStats GetCacheStats() const;
+
     FGet GetDelegate;
     FGetEntries GetEntriesDelegate;
     FGetEntriesAfterRank GetEntriesAfterRankDelegate;
@@ -312,6 +423,7 @@ class ONLINESUBSYSTEMPICO_API UPico_LeaderboardEntry : public UObject
     
 public:
     void InitParams(ppfLeaderboardEntryHandle ppfLeaderboardEntryHandle);
+    void InitParams(const FPicoLeaderboardPage& Page, int32 Index);
 
 private:
     ppfID ID = 0;
@@ -401,14 +513,17 @@ class ONLINESUBSYSTEMPICO_API UPico_LeaderboardEntryArray : public UObject
 {
     GENERATED_BODY()
 private:
+	/** Filled lazily by `GetElement` from `Page`. */
 	UPROPERTY()
     TArray<UPico_LeaderboardEntry*> LeaderboardEntryArray;
+	TSharedPtr<const FPicoLeaderboardPage> Page;
     int32 Size = 0;
 	unsigned long long TotalSize = 0;
     bool bHasNextPage;
 	bool bHasPreviousPage;
 public:
     void InitParams(ppfLeaderboardEntryArrayHandle InppfLeaderboardEntryArrayHandle);
+    void InitParams(const TSharedPtr<const FPicoLeaderboardPage>& InPage);
 
     /** @brief Get LeaderboardEntryArray element form Index.*/
     UFUNCTION(BlueprintPure, Category = "Pico Platform|Leaderboards|Leaderboard Entry Array")
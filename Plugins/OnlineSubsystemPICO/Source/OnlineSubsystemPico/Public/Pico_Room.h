@@ -19,6 +19,60 @@ class UPico_UserArray;
 class UPico_Room;
 class UPico_RoomArray;
 
+/// <summary>Room information as plain data. Used for the frequent room notifications, where
+/// creating a UPico_Room with its datastore, owner and user objects per message churns the GC.</summary>
+USTRUCT(BlueprintType, meta = (DisplayName = "PicoRoomData"))
+struct FPicoRoomData
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	FString RoomID; /*!< Room ID */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	FString RoomName; /*!< Room name */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	FString Description; /*!< Room description */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	FPicoUserInfo Owner; /*!< Room owner, empty UserId if the room has none */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	TArray<FPicoUserInfo> Users; /*!< Room members */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	TMap<FString, FString> DataStore; /*!< Room datastore */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	bool bIsMembershipLocked = false; /*!< Whether the room is locked */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	ERoomJoinPolicy JoinPolicy = ERoomJoinPolicy::JoinPolicyUnknown; /*!< Room's join policy */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	ERoomJoinabilit Joinability = ERoomJoinabilit::JoinabilityUnknown; /*!< Room's joinability */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	ERoomType RoomType = ERoomType::TypeUnknown; /*!< Room type */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	int32 MaxUsers = 0; /*!< The maximum number of users allowed to join the room */
+
+	UPROPERTY(BlueprintReadOnly, Category = "Pico Room")
+	int32 PlayerNumber = 0; /*!< The number of users in the room */
+
+	ppfID ID = 0;
+
+	/** Refills the struct from a room handle. Strings and user entries reuse their buffers, so do datastore values while the keys stay the same. */
+	void InitParams(ppfRoomHandle InRoomHandle);
+
+	void Reset();
+
+	/** Number of UObjects UPico_Room::InitParams(const FPicoRoomData&) creates for this room. */
+	int32 GetWrapperObjectCount() const { return 4 + Users.Num(); }
+};
+
 
 /**
  * 
@@ -27,6 +81,7 @@ DECLARE_MULTICAST_DELEGATE_FourParams(FRoomUpdateNotify, bool, /*bIsError*/ int,
 DECLARE_MULTICAST_DELEGATE_ThreeParams(FRoomUpdateOwnerNotify, bool, /*bIsError*/ int, /*ErrorCode*/ const FString&/*ErrorMessage*/);
 DECLARE_MULTICAST_DELEGATE_FourParams(FRoomJoinNotify, bool, /*bIsError*/ int, /*ErrorCode*/ const FString&, /*ErrorMessage*/ UPico_Room* /*Room*/);
 DECLARE_MULTICAST_DELEGATE_FourParams(FRoomLeaveNotify, bool, /*bIsError*/ int, /*ErrorCode*/ const FString&, /*ErrorMessage*/ UPico_Room* /*Room*/);
+DECLARE_MULTICAST_DELEGATE_FourParams(FRoomDataNotify, bool, /*bIsError*/ int, /*ErrorCode*/ const FString&, /*ErrorMessage*/ const FPicoRoomData& /*Room*/);
 DECLARE_MULTICAST_DELEGATE_FourParams(FRoomInviteAcceptedNotify, bool, /*bIsError*/ int, /*ErrorCode*/ const FString&, /*ErrorMessage*/ const FString& /*RoomID*/);
 
 DECLARE_DYNAMIC_DELEGATE_ThreeParams(FRoomLaunchInvitableUserFlow, bool, bIsError, int, ErrorCode, const FString&, ErrorMessage);
@@ -91,6 +146,22 @@ public:
 	FRoomLeaveNotify RoomLeaveNotify;
 	FRoomInviteAcceptedNotify RoomInviteAcceptedNotify;
 
+	/// <summary>Struct counterparts of `RoomUpdateNotify`, `RoomJoinNotify` and `RoomLeaveNotify`.
+	/// They don't allocate UObjects. The room data is reused between notifications and is only valid during the broadcast.</summary>
+	FRoomDataNotify RoomUpdateDataNotify;
+	FRoomDataNotify RoomJoinDataNotify;
+	FRoomDataNotify RoomLeaveDataNotify;
+
+	/// <summary>Wraps room data in a UPico_Room for Blueprint listeners.</summary>
+	static UPico_Room* CreateRoomObject(const FPicoRoomData& RoomData);
+
+	/// <summary>Runs synthetic room updates through the room update notification path, to measure how many result UObjects a busy room produces.
+	/// The updates go to private delegates, so listeners of `RoomUpdateNotify` and `RoomUpdateDataNotify` never see them.</summary>
+	/// <param name="NumUpdates">The number of room updates to dispatch.</param>
+	/// <param name="NumUsers">The number of users in the simulated room.</param>
+	/// <param name="bObjectListener">Whether to simulate a `RoomUpdateNotify` listener in addition to a `RoomUpdateDataNotify` one.</param>
+	void SimulateRoomUpdates(int32 NumUpdates, int32 NumUsers, bool bObjectListener);
+
 	FRoomLaunchInvitableUserFlow LaunchInvitableUserFlowDelegate;
 	FRoomUpdateDataStore UpdateDataStoreDelegate;
 	FRoomCreateAndJoinPrivate2 CreateAndJoinPrivate2Delegate;
@@ -391,6 +462,14 @@ public:
 	bool JoinOrCreateNamedRoom(ERoomJoinPolicy JoinPolicy, bool CreateIfNotExist, uint32 MaxUsers, FPicoRoomOptions Options, FRoomJoinOrCreateNamedRoom OnRoomJoinOrCreateNamedRoomCallback);
 
 private:
+	template<typename LegacyNotifyType>
+	void BroadcastRoomNotification(const TCHAR* NotificationName, FRoomDataNotify& DataNotify, LegacyNotifyType& LegacyNotify, ppfMessageHandle Message, bool bIsError);
+
+	template<typename LegacyNotifyType>
+	void BroadcastRoomData(FRoomDataNotify& DataNotify, LegacyNotifyType& LegacyNotify, const FPicoRoomData& RoomData);
+
+	FPicoRoomData NotificationRoomData;
+
 	ppfRoomOptions* GetppfRoomOptions(FPicoRoomOptions PicoRoomOptions);
 	
 	ppfRoomJoinPolicy GetppfRoomJoinPolicy(ERoomJoinPolicy JoinPolicy);
@@ -671,6 +750,7 @@ private:
 
 public:
 	void InitParams(ppfRoomHandle InRoomHandle);
+	void InitParams(const FPicoRoomData& InRoomData);
 
 	/** @brief Get the datastore that stores a room's metadata. The maximum datastore key length is 32 bytes and the maximum datastore value length is 64 bytes. */
 	UFUNCTION(BlueprintPure, Category = "Pico Platform|Room|Room")
@@ -526,6 +526,12 @@ class ONLINESUBSYSTEMPICO_API UPico_User : public UObject
 public:
     void InitParams(ppfUser* ppfUserHandle);
 
+    /** @brief Initializes the profile fields only, for users restored from a cache. Presence is left unknown. */
+    void InitParams(const FString& InID, const FString& InDisplayName, const FString& InImageUrl, const FString& InSmallImageUrl);
+
+    /** @brief Initializes from user data decoded without a UObject, see FPicoRoomData. */
+    void InitParams(const FPicoUserInfo& InUserInfo);
+
 private:
     FString DisplayName = FString();
     FString ImageUrl = FString();
@@ -620,6 +626,7 @@ class ONLINESUBSYSTEMPICO_API UPico_UserArray : public UObject
 
 public:
     void InitParams(ppfUserArray* InppfUserArrayHandle);
+    void InitParams(const TArray<FPicoUserInfo>& InUsers);
 
 private:
     UPROPERTY()
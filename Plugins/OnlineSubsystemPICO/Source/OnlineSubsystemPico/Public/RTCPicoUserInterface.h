@@ -220,6 +220,32 @@ DECLARE_MULTICAST_DELEGATE_ThreeParams(FRtcBinaryMessageReceived, const FString&
 DECLARE_MULTICAST_DELEGATE_ThreeParams(FRtcBinaryArrayMessageReceived, const FString& /*RoomId*/, const FString& /*UserId*/, TArray<uint8> /*BinaryArray*/)
 DECLARE_MULTICAST_DELEGATE_ThreeParams(FRtcRoomMessageReceived, const FString& /*RoomId*/, const FString& /*UserId*/, const FString& /*Message*/)
 DECLARE_MULTICAST_DELEGATE_ThreeParams(FRtcUserMessageReceived, const FString& /*RoomId*/, const FString& /*UserId*/, const FString& /*Message*/)
+
+/// <summary>Speaking state of one audio stream, updated in place from the audio properties reports.</summary>
+struct FRtcSpeakerState
+{
+    /// <summary>Interned room and user ID, resolve with `FRTCPicoUserInterface::ResolveRtcId`. `INDEX_NONE` for the local user.</summary>
+    int32 RoomId = INDEX_NONE;
+    int32 UserId = INDEX_NONE;
+    ERtcStreamIndex StreamIndex = ERtcStreamIndex::Main;
+    bool bIsLocal = false;
+
+    /// <summary>The last reported volume, 0 to 255.</summary>
+    int32 Volume = 0;
+
+    /// <summary>The volume smoothed with a fast attack and a slower release, 0 to 1. Suited for lip-flap.</summary>
+    float SmoothedLevel = 0.f;
+
+    bool bIsSpeaking = false;
+    double SpeakingChangedTime = 0.0;
+
+    double LastReportTime = 0.0;
+    double LastLoudTime = 0.0;
+    uint32 ReportGeneration = 0;
+};
+
+DECLARE_DELEGATE_OneParam(FRtcSpeakingChanged, const FRtcSpeakerState& /*Speaker*/);
+DECLARE_DELEGATE_OneParam(FRtcSpeakerLevels, TArrayView<const FRtcSpeakerState> /*Speakers*/);
 /** @addtogroup Function Function
  *  This is the Function group
  *  @{
@@ -295,6 +321,34 @@ public:
     /// </param>
     void RtcEnableAudioPropertiesReport(int Interval);
 
+    /// <summary>Subscribes to the speaking state table built from the audio properties reports.
+    /// Enable the reports with `RtcEnableAudioPropertiesReport` first.</summary>
+    /// <param name="LevelUpdateRate">The maximum rate (in Hz) at which `OnLevels` is called. It is only called when a level has changed.
+    /// Set it to `0` to only receive speaking start and stop.</param>
+    /// <param name="OnSpeakingChanged">Called as soon as a user starts or stops speaking.</param>
+    /// <param name="OnLevels">Called with the whole table. The view is only valid during the call.</param>
+    /// <returns>The subscription ID, used to unsubscribe.</returns>
+    int32 SubscribeSpeakingState(float LevelUpdateRate, FRtcSpeakingChanged OnSpeakingChanged, FRtcSpeakerLevels OnLevels);
+
+    /// <summary>Removes a subscription added with `SubscribeSpeakingState`.</summary>
+    void UnsubscribeSpeakingState(int32 SubscriptionId);
+
+    /// <summary>The current speaking state of every stream seen in the reports.</summary>
+    TArrayView<const FRtcSpeakerState> GetSpeakerStates() const { return SpeakerStates; }
+
+    /// <summary>Resolves the room or user ID of a `FRtcSpeakerState`. The string lives as long as the subsystem.</summary>
+    const FString& ResolveRtcId(int32 InternedId) const;
+
+    /// <summary>Reports processed into the speaking state table and their average game thread cost, in microseconds.</summary>
+    void GetSpeakingStateStats(int64& OutReports, double& OutAverageMicroseconds) const;
+
+    /// <summary>Feeds synthetic remote reports through the speaking state table to measure the game thread cost per report.
+    /// The benchmark speakers use made-up IDs that are never interned, and are removed again afterwards.</summary>
+    /// <param name="NumSpeakers">The number of remote users in each report.</param>
+    /// <param name="NumReports">The number of reports to process.</param>
+    /// <returns>The average cost of a report, in microseconds.</returns>
+    double RunSpeakingStateBenchmark(int32 NumSpeakers, int32 NumReports);
+
     /// <summary>Leaves a room.</summary>
     /// <param name="RoomId">Room ID.</param>
     /// <returns>Int:
@@ -594,6 +648,45 @@ public:
 private:
     TArray<uint8> GetBytesByInt(int32 Inint);
 
+    struct FSpeakingSubscription
+    {
+        int32 Id = 0;
+        double MinLevelInterval = 0.0;
+        double LastLevelTime = 0.0;
+        uint32 LastLevelsVersion = 0;
+        FRtcSpeakingChanged OnSpeakingChanged;
+        FRtcSpeakerLevels OnLevels;
+    };
+
+    void UpdateSpeakerState(int32 RoomId, int32 UserId, ERtcStreamIndex StreamIndex, int32 Volume, bool bIsLocal, double Now);
+    void FinishSpeakerReport(bool bIsLocal, double Now);
+    void StepSpeakerState(int32 SpeakerIndex, int32 Volume, double Now);
+    void RemoveSpeakers(int32 RoomId, int32 UserId);
+    /** Calls every subscriber with the given states. Safe against callbacks that subscribe or unsubscribe. */
+    void BroadcastSpeakingChanged(TArrayView<const FRtcSpeakerState> ChangedStates);
+    static uint64 GetSpeakerKey(int32 RoomId, int32 UserId, ERtcStreamIndex StreamIndex, bool bIsLocal);
+
+    TArray<FRtcSpeakerState> SpeakerStates;
+    TMap<uint64, int32> SpeakerIndices;
+    TArray<FSpeakingSubscription> SpeakingSubscriptions;
+    int32 NextSpeakingSubscriptionId = 1;
+
+    /** Indices into SpeakerStates whose speaking flag flipped during the current report. Reused between reports. */
+    TArray<int32> SpeakingEdges;
+    bool bSpeakerLevelsChanged = false;
+    uint32 SpeakerLevelsVersion = 0;
+    uint32 RemoteReportGeneration = 0;
+    uint32 LocalReportGeneration = 0;
+
+    float SpeakingStartLevel = 0.1f;
+    float SpeakingStopLevel = 0.05f;
+    float SpeakingHoldTime = 0.3f;
+    float LevelAttackTime = 0.05f;
+    float LevelReleaseTime = 0.2f;
+
+    int64 SpeakerReportsProcessed = 0;
+    uint64 SpeakerReportCycles = 0;
+
 
 PACKAGE_SCOPE:
 
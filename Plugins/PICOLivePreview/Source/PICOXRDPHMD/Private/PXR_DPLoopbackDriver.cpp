@@ -0,0 +1,333 @@
+//Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#include "PXR_DPLoopbackDriver.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "RenderingThread.h"
+#include "PXR_Log.h"
+
+FPXRDPLoopbackDriver::FPXRDPLoopbackDriver(StreamingDataReceiveWrapper* InReceiver, float InPoseRate, double InUplinkSeconds, double InDownlinkSeconds)
+	: Receiver(InReceiver)
+	, PoseRate(FMath::Clamp(InPoseRate, 1.0f, 240.0f))
+	, UplinkSeconds(InUplinkSeconds)
+	, DownlinkSeconds(InDownlinkSeconds)
+{
+}
+
+FPXRDPLoopbackDriver::~FPXRDPLoopbackDriver()
+{
+	DisconnectFromService();
+}
+
+DriverResultCode FPXRDPLoopbackDriver::ConnectToService()
+{
+	if (!bConnected.exchange(true))
+	{
+		bStopPoses = false;
+		PoseThread = Async(EAsyncExecution::Thread, [this]() { RunPoseThread(); });
+		Receiver->NotifyConnectToService(DriverResultCode::kOk);
+	}
+	return DriverResultCode::kOk;
+}
+
+DriverResultCode FPXRDPLoopbackDriver::DisconnectFromService()
+{
+	if (bConnected.exchange(false))
+	{
+		bStopPoses = true;
+		PoseThread.Wait();
+		Receiver->NotifyDisconnectFromService(DriverResultCode::kOk);
+	}
+	return DriverResultCode::kOk;
+}
+
+DriverResultCode FPXRDPLoopbackDriver::StartStreaming(const DriverMediaConfig& media_config)
+{
+	State = StreamingState::kStreamingReady;
+	Receiver->NotifyStreamingStateUpdated(StreamingState::kStreamingReady, media_config);
+	return DriverResultCode::kOk;
+}
+
+DriverResultCode FPXRDPLoopbackDriver::StopStreaming()
+{
+	State = StreamingState::kStreamingFinished;
+	DriverMediaConfig MediaConfig;
+	Receiver->GetDriverMediaConfig(MediaConfig);
+	Receiver->NotifyStreamingStateUpdated(StreamingState::kStreamingFinished, MediaConfig);
+	return DriverResultCode::kOk;
+}
+
+DriverResultCode FPXRDPLoopbackDriver::SubmitLayerImage(const pxr_base::DriverSharedImages& layer)
+{
+	FPXRDPLoopbackSubmission Submission;
+	Submission.SubmitTime = FPlatformTime::Seconds();
+	Submission.PhotonTime = Submission.SubmitTime + DownlinkSeconds;
+	Submission.bHasSharedHandles = layer.shared_handle(0) != nullptr && layer.shared_handle(1) != nullptr;
+	const pxr_base::Vector Position = layer.position();
+	const pxr_base::Rotation Rotation = layer.rotation();
+
+	FScopeLock ScopeLock(&Lock);
+	// The frame carries the driver pose it was rendered from, newest first finds it fastest
+	for (uint64 Index = NumSent; Index > 0 && Index + NumSentPoses > NumSent; Index--)
+	{
+		const FSentPose& Sent = SentPoses[(Index - 1) % NumSentPoses];
+		if (Sent.Position[0] == Position.x() && Sent.Position[1] == Position.y() && Sent.Position[2] == Position.z()
+			&& Sent.Rotation[0] == Rotation.x() && Sent.Rotation[1] == Rotation.y() && Sent.Rotation[2] == Rotation.z() && Sent.Rotation[3] == Rotation.w())
+		{
+			Submission.SampleTime = Sent.SampleTime;
+			break;
+		}
+	}
+	Submissions.Add(Submission);
+	return DriverResultCode::kOk;
+}
+
+TArray<FPXRDPLoopbackSubmission> FPXRDPLoopbackDriver::TakeSubmissions()
+{
+	FScopeLock ScopeLock(&Lock);
+	return MoveTemp(Submissions);
+}
+
+DriverResultCode FPXRDPLoopbackDriver::VibrateController(const pxr_base::ControllerVibration& vibration)
+{
+	return DriverResultCode::kOk;
+}
+
+DriverResultCode FPXRDPLoopbackDriver::SetTrackingOrigin(pxr_base::DeviceTrackingOrigin origin)
+{
+	return DriverResultCode::kOk;
+}
+
+bool FPXRDPLoopbackDriver::IsConnected()
+{
+	return bConnected;
+}
+
+StreamingState FPXRDPLoopbackDriver::GetStreamingState()
+{
+	return State;
+}
+
+FPXRDPPose FPXRDPLoopbackDriver::GetTruePose(double Time)
+{
+	// Driver space is Y up, -Z forward. A brisk look around: peaks near 150 deg/s of yaw
+	const double Yaw = 0.8 * FMath::Sin(TWO_PI * 0.5 * Time);
+	const double Pitch = 0.2 * FMath::Sin(TWO_PI * 0.3 * Time);
+	const FQuat Rotation = FQuat(FVector(0, 1, 0), Yaw) * FQuat(FVector(1, 0, 0), Pitch);
+
+	FPXRDPPose Pose;
+	Pose.Position[0] = 0.05 * FMath::Sin(TWO_PI * 0.4 * Time);
+	Pose.Position[1] = 1.6;
+	Pose.Position[2] = 0.02 * FMath::Cos(TWO_PI * 0.4 * Time);
+	Pose.Rotation[0] = Rotation.X;
+	Pose.Rotation[1] = Rotation.Y;
+	Pose.Rotation[2] = Rotation.Z;
+	Pose.Rotation[3] = Rotation.W;
+	Pose.bActive = true;
+	return Pose;
+}
+
+void FPXRDPLoopbackDriver::RunPoseThread()
+{
+	const double Interval = 1.0 / PoseRate;
+	double NextPoseTime = FPlatformTime::Seconds();
+	while (!bStopPoses)
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now < NextPoseTime)
+		{
+			FPlatformProcess::Sleep(FMath::Min(NextPoseTime - Now, 0.001));
+			continue;
+		}
+		NextPoseTime = FMath::Max(NextPoseTime + Interval, Now);
+
+		// Sampled on the headset, reported through the same callback as a real driver, which stamps it on arrival
+		const double SampleTime = Now - UplinkSeconds;
+		const FPXRDPPose Pose = GetTruePose(SampleTime);
+		pxr_base::DevicePose DevicePose;
+		DevicePose.SetPoseType_(pxr_base::PoseType::kHmd);
+		DevicePose.SetIndex_(0);
+		DevicePose.SetActive_(true);
+		DevicePose.SetPostion_(Pose.Position[0], Pose.Position[1], Pose.Position[2]);
+		DevicePose.SetRotation_(Pose.Rotation[0], Pose.Rotation[1], Pose.Rotation[2], Pose.Rotation[3]);
+		{
+			FScopeLock ScopeLock(&Lock);
+			FSentPose& Sent = SentPoses[NumSent++ % NumSentPoses];
+			Sent.SampleTime = SampleTime;
+			FMemory::Memcpy(Sent.Position, Pose.Position, sizeof(Sent.Position));
+			FMemory::Memcpy(Sent.Rotation, Pose.Rotation, sizeof(Sent.Rotation));
+		}
+		Receiver->NotifyDevicePoseUpdated(&DevicePose, 1);
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	double Percentile(TArray<double>& Values, double Fraction)
+	{
+		if (Values.Num() == 0)
+		{
+			return 0.0;
+		}
+		Values.Sort();
+		return Values[FMath::Clamp((int32)(Fraction * (Values.Num() - 1) + 0.5), 0, Values.Num() - 1)];
+	}
+
+	double AngleDegrees(const FPXRDPPose& A, const FPXRDPPose& B)
+	{
+		const FQuat QuatA(A.Rotation[0], A.Rotation[1], A.Rotation[2], A.Rotation[3]);
+		const FQuat QuatB(B.Rotation[0], B.Rotation[1], B.Rotation[2], B.Rotation[3]);
+		return FMath::RadiansToDegrees(QuatA.AngularDistance(QuatB));
+	}
+
+	/** Frames measured by PICO.LivePreview.MeasureLatency. Filled on the render thread, read after a flush. */
+	struct FLatencyRun
+	{
+		std::shared_ptr<FPXRDPLoopbackDriver> Driver;
+		StreamingDriverInterface::Ptr_t PreviousDriver;
+		double EndTime = 0.0;
+
+		TArray<double> MotionToPhoton;
+		TArray<double> RenderToSubmit;
+		TArray<double> SuggestedLatency;
+		double LatestError = 0.0;
+		double PredictedError = 0.0;
+		int32 Frames = 0;
+		int32 Unsubmitted = 0;
+		int32 UnmatchedPoses = 0;
+		int32 WithoutSharedHandles = 0;
+		int32 LateUpdateChanged = 0;
+	};
+
+	bool bMeasuringLatency = false;
+
+	/** Render thread, right after the frame went out through FPICOXRDPManager::SendMessage. */
+	void MeasureSubmittedFrame(FLatencyRun& Run)
+	{
+		const TArray<FPXRDPLoopbackSubmission> Submissions = Run.Driver->TakeSubmissions();
+		FPXRDPFramePose FramePose;
+		if (Submissions.Num() == 0 || !FPICOXRDPManager::GetFramePose(GFrameCounterRenderThread, FramePose) || FramePose.SubmitTime <= 0.0)
+		{
+			Run.Unsubmitted++;
+			return;
+		}
+
+		const FPXRDPLoopbackSubmission& Submission = Submissions.Last();
+		Run.Frames++;
+		Run.WithoutSharedHandles += Submission.bHasSharedHandles ? 0 : 1;
+		Run.RenderToSubmit.Add(Submission.SubmitTime - FramePose.RenderTime);
+		if (Submission.SampleTime <= 0.0)
+		{
+			// The frame went out with a driver pose it was not rendered from
+			Run.UnmatchedPoses++;
+			return;
+		}
+
+		const FPXRDPPose Truth = FPXRDPLoopbackDriver::GetTruePose(Submission.PhotonTime);
+		Run.MotionToPhoton.Add(Submission.PhotonTime - Submission.SampleTime);
+		// Prediction counts from when the sample arrived, so the ideal target latency also covers its way in
+		Run.SuggestedLatency.Add(Submission.PhotonTime - FramePose.RenderTime + FramePose.Pose.Timestamp - Submission.SampleTime);
+		Run.LatestError += AngleDegrees(FPXRDPLoopbackDriver::GetTruePose(Submission.SampleTime), Truth);
+		Run.PredictedError += AngleDegrees(FramePose.Pose, Truth);
+	}
+
+	void ReportLatency(FLatencyRun& Run)
+	{
+		PXR_LOGD(PxrUnreal, "PXR_LivePreview MeasureLatency %d frames submitted, %d without a frame pose, %d with a pose they were not rendered from, %d without shared textures, %d late updates changed within a frame",
+			Run.Frames, Run.Unsubmitted, Run.UnmatchedPoses, Run.WithoutSharedHandles, Run.LateUpdateChanged);
+		const int32 Matched = Run.MotionToPhoton.Num();
+		if (Matched == 0)
+		{
+			PXR_LOGW(PxrUnreal, "PXR_LivePreview MeasureLatency measured no frames");
+			return;
+		}
+		PXR_LOGD(PxrUnreal, "PXR_LivePreview MeasureLatency motion to photon p50 %.1f ms, p95 %.1f ms, render to submit %.1f ms",
+			Percentile(Run.MotionToPhoton, 0.5) * 1000.0, Percentile(Run.MotionToPhoton, 0.95) * 1000.0, Percentile(Run.RenderToSubmit, 0.5) * 1000.0);
+		PXR_LOGD(PxrUnreal, "PXR_LivePreview MeasureLatency rotation error at photon time: latest pose %.2f deg, rendered pose (%.0f ms target latency) %.2f deg",
+			Run.LatestError / Matched, GetPXRDPTargetLatency() * 1000.0, Run.PredictedError / Matched);
+		PXR_LOGD(PxrUnreal, "PXR_LivePreview MeasureLatency suggests PICO.LivePreview.TargetLatencyMs %.0f", Percentile(Run.SuggestedLatency, 0.5) * 1000.0);
+	}
+
+	void MeasureLatency(const TArray<FString>& Args)
+	{
+		const double Seconds = Args.Num() > 0 ? FMath::Clamp(FCString::Atod(*Args[0]), 1.0, 60.0) : 5.0;
+		const double Uplink = Args.Num() > 1 ? FMath::Max(0.0, FCString::Atod(*Args[1])) / 1000.0 : 0.010;
+		const double Downlink = Args.Num() > 2 ? FMath::Max(0.0, FCString::Atod(*Args[2])) / 1000.0 : 0.030;
+		const float PoseRate = Args.Num() > 3 ? FCString::Atof(*Args[3]) : 90.0f;
+
+		StreamingDataReceiveWrapper* Receiver = FPICOXRDPManager::GetStreamingDataReceiver();
+		if (!Receiver)
+		{
+			PXR_LOGW(PxrUnreal, "PXR_LivePreview MeasureLatency needs Live Preview to be initialized");
+			return;
+		}
+		if (bMeasuringLatency || FPICOXRDPManager::IsStreaming())
+		{
+			PXR_LOGW(PxrUnreal, "PXR_LivePreview MeasureLatency can't run while streaming to a headset or measuring already");
+			return;
+		}
+
+		PXR_LOGD(PxrUnreal, "PXR_LivePreview MeasureLatency running for %.1fs, uplink %.1f ms, downlink %.1f ms", Seconds, Uplink * 1000.0, Downlink * 1000.0);
+
+		// The loopback driver stands in for the service until the run ends, frames go through the manager as usual
+		TSharedRef<FLatencyRun> Run = MakeShared<FLatencyRun>();
+		Run->Driver = std::make_shared<FPXRDPLoopbackDriver>(Receiver, PoseRate, Uplink, Downlink);
+		Run->PreviousDriver = FPICOXRDPManager::ReplaceStreamingDriver(Run->Driver);
+		Run->Driver->ConnectToService();
+		FPICOXRDPManager::OnBeginPlayStartStreaming();
+		bMeasuringLatency = true;
+		// Give the pose thread time for the velocity estimate to settle
+		const double StartTime = FPlatformTime::Seconds() + 0.1;
+		Run->EndTime = StartTime + Seconds;
+
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Run, StartTime](float DeltaTime)
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (Now < StartTime)
+			{
+				return true;
+			}
+			if (Now < Run->EndTime)
+			{
+				// Like the HMD: the game thread latches the frame's pose, the render thread late updates and submits it
+				FVector Position;
+				FQuat Rotation;
+				FPICOXRDPManager::GetHMDPositionAndRotation(Position, Rotation);
+				ENQUEUE_RENDER_COMMAND(PICOLivePreviewMeasureLatency)([Run](FRHICommandListImmediate& RHICmdList)
+				{
+					FVector LateUpdatePosition;
+					FQuat LateUpdateRotation;
+					FPICOXRDPManager::GetHMDPositionAndRotation(LateUpdatePosition, LateUpdateRotation);
+					// Every later call in the frame must see the same pose
+					FVector AgainPosition;
+					FQuat AgainRotation;
+					FPICOXRDPManager::GetHMDPositionAndRotation(AgainPosition, AgainRotation);
+					Run->LateUpdateChanged += (AgainPosition == LateUpdatePosition && AgainRotation == LateUpdateRotation) ? 0 : 1;
+
+					FPICOXRDPManager::SendMessage(0);
+					MeasureSubmittedFrame(*Run);
+				});
+				return true;
+			}
+
+			FlushRenderingCommands();
+			FPICOXRDPManager::OnEndPlayStopStreaming();
+			Run->Driver->DisconnectFromService();
+			FPICOXRDPManager::ReplaceStreamingDriver(Run->PreviousDriver);
+			bMeasuringLatency = false;
+			ReportLatency(*Run);
+			return false;
+		}));
+	}
+}
+
+static FAutoConsoleCommand CPICOLivePreviewMeasureLatency(
+	TEXT("PICO.LivePreview.MeasureLatency"),
+	TEXT("Swaps in a local loopback driver with synthetic head motion, sends one frame per engine frame through the Live Preview pose and\n")
+	TEXT("submit path and reports motion to photon, from the pose each submitted frame carries, and the rotation error of the latest and the rendered pose.\n")
+	TEXT("There is no display, so photon time is the submission plus DownlinkMs. Needs Live Preview initialized and no headset streaming.\n")
+	TEXT("Usage: PICO.LivePreview.MeasureLatency [Seconds=5] [UplinkMs=10] [DownlinkMs=30] [PoseHz=90]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&MeasureLatency));
+#endif
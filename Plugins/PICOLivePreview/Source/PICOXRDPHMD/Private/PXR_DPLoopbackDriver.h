@@ -0,0 +1,73 @@
+//Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "PXR_DPManager.h"
+#include "Async/Future.h"
+#include <atomic>
+
+/** What the loopback driver saw of one submitted frame. */
+struct FPXRDPLoopbackSubmission
+{
+	double SubmitTime = 0.0;
+	/** When the submitted driver pose was sampled on the simulated headset, 0 if it matches none that was sent. */
+	double SampleTime = 0.0;
+	/** SubmitTime plus the simulated downlink, when the frame would be shown. */
+	double PhotonTime = 0.0;
+	bool bHasSharedHandles = false;
+};
+
+/**
+ * Local stand-in for the streaming service. Feeds the receive wrapper driver poses of synthetic head motion, sampled
+ * UplinkSeconds before they arrive, and checks submitted frames against them, so the pose path of FPICOXRDPManager
+ * can be measured without a device.
+ */
+class FPXRDPLoopbackDriver : public StreamingDriverInterface
+{
+public:
+	FPXRDPLoopbackDriver(StreamingDataReceiveWrapper* InReceiver, float InPoseRate, double InUplinkSeconds, double InDownlinkSeconds);
+	virtual ~FPXRDPLoopbackDriver();
+
+	virtual DriverResultCode ConnectToService() override;
+	virtual DriverResultCode DisconnectFromService() override;
+	virtual DriverResultCode StartStreaming(const DriverMediaConfig& media_config) override;
+	virtual DriverResultCode StopStreaming() override;
+	virtual DriverResultCode SubmitLayerImage(const pxr_base::DriverSharedImages& layer) override;
+	virtual DriverResultCode VibrateController(const pxr_base::ControllerVibration& vibration) override;
+	virtual DriverResultCode SetTrackingOrigin(pxr_base::DeviceTrackingOrigin origin) override;
+	virtual bool IsConnected() override;
+	virtual StreamingState GetStreamingState() override;
+
+	/** Synthetic head motion at Time, in driver space: yaw and pitch sweeps and some sway. */
+	static FPXRDPPose GetTruePose(double Time);
+
+	/** Submissions since the last call, oldest first. */
+	TArray<FPXRDPLoopbackSubmission> TakeSubmissions();
+
+private:
+	void RunPoseThread();
+
+	struct FSentPose
+	{
+		double SampleTime = 0.0;
+		float Position[3] = { 0.f, 0.f, 0.f };
+		float Rotation[4] = { 0.f, 0.f, 0.f, 1.f };
+	};
+
+	StreamingDataReceiveWrapper* Receiver;
+	const float PoseRate;
+	const double UplinkSeconds;
+	const double DownlinkSeconds;
+
+	std::atomic<bool> bConnected{ false };
+	std::atomic<bool> bStopPoses{ false };
+	std::atomic<StreamingState> State{ StreamingState::kUndefinedStreamingState };
+	TFuture<void> PoseThread;
+
+	// Guarded by Lock. Enough sent poses to cover a second at any pose rate the command accepts
+	FCriticalSection Lock;
+	static constexpr int32 NumSentPoses = 256;
+	FSentPose SentPoses[NumSentPoses];
+	uint64 NumSent = 0;
+	TArray<FPXRDPLoopbackSubmission> Submissions;
+};
@@ -11,6 +11,7 @@
 #include "ScreenRendering.h"
 #include "PXR_DPHMD.h"
 #include "PXR_DPSettings.h"
+#include "HAL/IConsoleManager.h"
 #include "Microsoft/COMPointer.h"
 
 /** Utility struct, similar to FScopeLock but allows the lock to be enabled/disabled more easily */
@@ -59,19 +60,31 @@ void StreamingDataReceiveWrapper::NotifyIPDUpdated(float ipd)
 	PXR_LOGV(PxrUnreal, "PXR_LivePreview StreamingDataReceiver NotifyIPDUpdated:%f", ipd);
 }
 
-Rotation StreamingDataReceiveWrapper::GetControllerRotation(EControllerHand DeviceHand) const
+uint64 StreamingDataReceiveWrapper::AddHMDSample(FPXRDPDeviceState& State, FPXRDPPose Pose)
 {
-	return (DeviceHand == EControllerHand::Left) ? LeftRotation : RightRotation;
+	Pose.SampleId = ++HMDSampleCount;
+	HMDHistory.Add(Pose);
+	State.HMD = Pose;
+	return Pose.SampleId;
 }
 
-Vector StreamingDataReceiveWrapper::GetHMDPosition() const
+uint64 StreamingDataReceiveWrapper::PushHMDPose(const FPXRDPPose& Pose)
 {
-	return HMDPosition;
+	uint64 SampleId = 0;
+	DeviceState.Update([&](FPXRDPDeviceState& State)
+	{
+		SampleId = AddHMDSample(State, Pose);
+	});
+	return SampleId;
 }
 
-Rotation StreamingDataReceiveWrapper::GetHMDRotation() const
+void StreamingDataReceiveWrapper::GetDriverHMDPose(uint64 SampleId, Vector& OutPosition, Rotation& OutRotation) const
 {
-	return HMDRotation;
+	FConditionalScopeLock ScopeLock(&StateLock, true);
+	const FDriverHMDSample& Sample = DriverHMDSamples[SampleId % NumDriverHMDSamples];
+	const FDriverHMDSample& Found = (SampleId != 0 && Sample.SampleId == SampleId) ? Sample : DriverHMDSamples[LatestDriverHMDSample % NumDriverHMDSamples];
+	OutPosition = Found.DriverPosition;
+	OutRotation = Found.DriverRotation;
 }
 
 bool StreamingDataReceiveWrapper::GetDeviceFovInfo(DeviceFovInfo& FovInfo) const
@@ -88,67 +101,73 @@ bool StreamingDataReceiveWrapper::GetDeviceFovInfo(DeviceFovInfo& FovInfo) const
 	return false;
 }
 
-Vector StreamingDataReceiveWrapper::GetControllerPosition(EControllerHand DeviceHand) const
+static void CopyDevicePose(const pxr_base::DevicePose& Source, double Timestamp, FPXRDPPose& OutPose)
 {
-	return (DeviceHand == EControllerHand::Left) ? LeftPosition : RightPosition;
+	const pxr_base::Vector& Position = Source.position();
+	const pxr_base::Rotation& Rotation = Source.rotation();
+	OutPose.Position[0] = Position.x();
+	OutPose.Position[1] = Position.y();
+	OutPose.Position[2] = Position.z();
+	OutPose.Rotation[0] = Rotation.x();
+	OutPose.Rotation[1] = Rotation.y();
+	OutPose.Rotation[2] = Rotation.z();
+	OutPose.Rotation[3] = Rotation.w();
+	OutPose.bActive = Source.active();
+	OutPose.Timestamp = Timestamp;
 }
 
 void StreamingDataReceiveWrapper::NotifyDevicePoseUpdated(const pxr_base::DevicePose pose_arr[], size_t arr_size)
 {
-	for (int index = 0; index < arr_size; index++)
+	const double Now = FPlatformTime::Seconds();
+	DeviceState.Update([&](FPXRDPDeviceState& State)
 	{
-		switch (pose_arr[index].GetPoseType_())
+		for (int index = 0; index < arr_size; index++)
 		{
-		case pxr_base::PoseType::kUndefinedPoseType: break;
-		case pxr_base::PoseType::kHmd:
-			{
-				FConditionalScopeLock ScopeLock(&StateLock, true);
-				PXR_LOGV(PxrUnreal, "PXR_LivePreview NotifyDevicePoseUpdated HMD Index %lld", pose_arr[index].GetIndex_());
-				HMDPosition = pose_arr[index].position();
-				HMDRotation = pose_arr[index].rotation();
-
-			}
-			break;
-		case pxr_base::PoseType::kController:
+			switch (pose_arr[index].GetPoseType_())
 			{
-				PXR_LOGV(PxrUnreal, "PXR_LivePreview NotifyDevicePoseUpdated Controller Index %lld", pose_arr[index].GetIndex_());
-				if (pose_arr[index].GetIndex_() == 1)
+			case pxr_base::PoseType::kUndefinedPoseType: break;
+			case pxr_base::PoseType::kHmd:
 				{
-					LeftPosition = pose_arr[index].position();
-					LeftRotation = pose_arr[index].rotation();
-					bLeftActive = pose_arr[index].active();
+					PXR_LOGV(PxrUnreal, "PXR_LivePreview NotifyDevicePoseUpdated HMD Index %lld", pose_arr[index].GetIndex_());
+					FPXRDPPose Pose;
+					CopyDevicePose(pose_arr[index], Now, Pose);
+					const uint64 SampleId = AddHMDSample(State, Pose);
+
+					// Only the frame submission reads these, see SendMessage
+					FConditionalScopeLock ScopeLock(&StateLock, true);
+					FDriverHMDSample& Sample = DriverHMDSamples[SampleId % NumDriverHMDSamples];
+					Sample.SampleId = SampleId;
+					Sample.DriverPosition = pose_arr[index].position();
+					Sample.DriverRotation = pose_arr[index].rotation();
+					LatestDriverHMDSample = SampleId;
 				}
-				else
+				break;
+			case pxr_base::PoseType::kController:
 				{
-					RightPosition = pose_arr[index].position();
-					RightRotation = pose_arr[index].rotation();
-					bRightActive = pose_arr[index].active();
+					PXR_LOGV(PxrUnreal, "PXR_LivePreview NotifyDevicePoseUpdated Controller Index %lld", pose_arr[index].GetIndex_());
+					const EControllerHand Hand = (pose_arr[index].GetIndex_() == 1) ? EControllerHand::Left : EControllerHand::Right;
+					CopyDevicePose(pose_arr[index], Now, State.Controllers[(int32)Hand]);
 				}
+				break;
+			default: ;
 			}
-			break;
-		default: ;
 		}
-	}
+	});
 }
 
 void StreamingDataReceiveWrapper::NotifyControllerButtonUpdated(const pxr_base::ControllerButton& button)
 {
-	if (!button.index())
-	{
-		LeftJoystickX = button.joystick_x();
-		LeftJoystickY = button.joystick_y();
-		LeftTriggerValue = button.trigger_value();
-		LeftGripValue = button.grip_value();
-		LeftState = button.state();
-	}
-	else
+	const double Now = FPlatformTime::Seconds();
+	DeviceState.Update([&](FPXRDPDeviceState& State)
 	{
-		RightJoystickX = button.joystick_x();
-		RightJoystickY = button.joystick_y();
-		RightTriggerValue = button.trigger_value();
-		RightGripValue = button.grip_value();
-		RightState = button.state();
-	}
+		FPXRDPButtons& Buttons = State.Buttons[!button.index() ? (int32)EControllerHand::Left : (int32)EControllerHand::Right];
+		Buttons.JoystickX = button.joystick_x();
+		Buttons.JoystickY = button.joystick_y();
+		Buttons.TriggerValue = button.trigger_value();
+		Buttons.GripValue = button.grip_value();
+		Buttons.State = button.state();
+		Buttons.Timestamp = Now;
+	});
 }
 
 void StreamingDataReceiveWrapper::NotifyConnectToService(DriverResultCode result)
@@ -188,36 +207,6 @@ void StreamingDataReceiveWrapper::NotifyControllerStateUpdated(const ControllerS
 {
 }
 
-float StreamingDataReceiveWrapper::GetJoystickX(EControllerHand DeviceHand) const
-{
-	return (DeviceHand == EControllerHand::Left) ? LeftJoystickX : RightJoystickX;
-}
-
-float StreamingDataReceiveWrapper::GetJoystickY(EControllerHand DeviceHand) const
-{
-	return (DeviceHand == EControllerHand::Left) ? LeftJoystickY : RightJoystickY;
-}
-
-float StreamingDataReceiveWrapper::GetTriggerValue(EControllerHand DeviceHand) const
-{
-	return (DeviceHand == EControllerHand::Left) ? LeftTriggerValue : RightTriggerValue;
-}
-
-float StreamingDataReceiveWrapper::GetGripValue(EControllerHand DeviceHand) const
-{
-	return (DeviceHand == EControllerHand::Left) ? LeftGripValue : RightGripValue;
-}
-
-float StreamingDataReceiveWrapper::GetStateValue(EControllerHand DeviceHand) const
-{
-	return (DeviceHand == EControllerHand::Left) ? LeftState : RightState;
-}
-
-bool StreamingDataReceiveWrapper::GetConnectionStatus(EControllerHand DeviceHand) const
-{
-	return (DeviceHand == EControllerHand::Left) ? bLeftActive : bRightActive;
-}
-
 bool StreamingDataReceiveWrapper::IsStreaming() const
 {
 	return bStreaming;
@@ -238,6 +227,7 @@ bool StreamingDataReceiveWrapper::GetDriverMediaConfig(DriverMediaConfig& MediaC
 bool FPICOXRDPManager::bConnectToServiceSucceed = false;
 StreamingDriverInterface::Ptr_t FPICOXRDPManager::StreamingDriverInterfacePtr = nullptr;
 TSharedPtr<StreamingDataReceiveWrapper, ESPMode::ThreadSafe> FPICOXRDPManager::StreamingDataWrapperPtr = nullptr;
+FPXRDPFramePoseHistory FPICOXRDPManager::FramePoses;
 TArray<TRefCountPtr<ID3D11Texture2D>> FPICOXRDPManager::LeftDstSwapChainTextures;
 TArray<TRefCountPtr<ID3D11Texture2D>> FPICOXRDPManager::RightDstSwapChainTextures;
 TArray<void*> FPICOXRDPManager::LeftDstTextureHandles;
@@ -340,6 +330,18 @@ bool FPICOXRDPManager::CreateStreamingInterface()
 	return true;
 }
 
+StreamingDriverInterface::Ptr_t FPICOXRDPManager::ReplaceStreamingDriver(StreamingDriverInterface::Ptr_t Driver)
+{
+	StreamingDriverInterface::Ptr_t Previous = StreamingDriverInterfacePtr;
+	StreamingDriverInterfacePtr = Driver;
+	return Previous;
+}
+
+StreamingDataReceiveWrapper* FPICOXRDPManager::GetStreamingDataReceiver()
+{
+	return StreamingDataWrapperPtr.Get();
+}
+
 bool FPICOXRDPManager::ConnectStreamingServer()
 {
 	if (!StreamingDriverInterfacePtr)
@@ -413,12 +415,25 @@ TArray<FTextureRHIRef> FPICOXRDPManager::GetRightRHITextureSwapChain()
 static const uint32 DPSwapChainLength = 1;
 bool FPICOXRDPManager::SendMessage(int SwapChainIndex)
 {
+	if (!StreamingDriverInterfacePtr || !StreamingDataWrapperPtr
+		|| !LeftDstTextureHandles.IsValidIndex(SwapChainIndex) || !RightDstTextureHandles.IsValidIndex(SwapChainIndex))
+	{
+		return false;
+	}
+
 	pxr_base::DriverSharedImages submit_message;
 	submit_message.shared_handle(0) = LeftDstTextureHandles[SwapChainIndex];
 	submit_message.shared_handle(1) = RightDstTextureHandles[SwapChainIndex];
-	FConditionalScopeLock ScopeLock(&StreamingDataWrapperPtr->StateLock, true);
-	submit_message.SetPostion_(StreamingDataWrapperPtr->GetHMDPosition());
-	submit_message.SetRotation_(StreamingDataWrapperPtr->GetHMDRotation());
+
+	// Send back the sample this frame was rendered from, so the headset can reproject from the right pose
+	FPXRDPFramePose FramePose;
+	const bool bHasFramePose = FramePoses.MarkSubmitted(GFrameCounterRenderThread, FPlatformTime::Seconds(), FramePose);
+	pxr_base::Vector Position;
+	pxr_base::Rotation Rotation;
+	StreamingDataWrapperPtr->GetDriverHMDPose(bHasFramePose ? FramePose.Pose.SampleId : 0, Position, Rotation);
+	submit_message.SetPostion_(Position);
+	submit_message.SetRotation_(Rotation);
+	PXR_LOGV(PxrUnreal, "PXR_LivePreview Frame %llu HMD sample %llu", (uint64)GFrameCounterRenderThread, FramePose.Pose.SampleId);
 
 	PXR_LOGV(PxrUnreal, "PXR_LivePreview Left Shared Handle ID:%lu", HandleToULong(LeftDstTextureHandles[SwapChainIndex]));
 	PXR_LOGV(PxrUnreal, "PXR_LivePreview Right Shared Handle ID:%lu", HandleToULong(RightDstTextureHandles[SwapChainIndex]));
@@ -596,15 +611,38 @@ void FPICOXRDPManager::GetHMDPositionAndRotation(FVector& OutPostion, FQuat& Out
 {
 	if (StreamingDataWrapperPtr)
 	{
-		const pxr_base::Vector position = StreamingDataWrapperPtr->GetHMDPosition();
-		const pxr_base::Rotation rotation = StreamingDataWrapperPtr->GetHMDRotation();
-		OutPostion.X = position.x();
-		OutPostion.Y = position.y();
-		OutPostion.Z = position.z();
-		OutQuat.X = rotation.x();
-		OutQuat.Y = rotation.y();
-		OutQuat.Z = rotation.z();
-		OutQuat.W = rotation.w();
+		// Latch one pose per game frame, predicted to when the frame reaches the headset. The render thread late update
+		// samples again once and replaces it, so SendMessage submits the pose the frame was actually rendered with.
+		const bool bGameThread = IsInGameThread();
+		const bool bRenderThread = !bGameThread && IsInRenderingThread();
+		const uint64 FrameNumber = bGameThread ? GFrameCounter : GFrameCounterRenderThread;
+		FPXRDPFramePose FramePose;
+		const bool bLatched = (bGameThread || bRenderThread)
+			&& FramePoses.Find(FrameNumber, FramePose)
+			&& (bGameThread || FramePose.bLateUpdated);
+		if (!bLatched)
+		{
+			const double TargetLatency = GetPXRDPTargetLatency();
+			const FPXRDPPose Latest = StreamingDataWrapperPtr->GetDeviceState().HMD;
+			FramePose.FrameNumber = FrameNumber;
+			FramePose.RenderTime = FPlatformTime::Seconds();
+			FramePose.TargetTime = FramePose.RenderTime + TargetLatency;
+			// Without a target latency the latest sample is rendered as received
+			FramePose.Pose = TargetLatency > 0.0 ? PredictPXRDPPose(Latest, FramePose.TargetTime) : Latest;
+			FramePose.bLateUpdated = bRenderThread;
+			if (bGameThread || bRenderThread)
+			{
+				FramePoses.Record(FramePose);
+			}
+		}
+		const FPXRDPPose& HMD = FramePose.Pose;
+		OutPostion.X = HMD.Position[0];
+		OutPostion.Y = HMD.Position[1];
+		OutPostion.Z = HMD.Position[2];
+		OutQuat.X = HMD.Rotation[0];
+		OutQuat.Y = HMD.Rotation[1];
+		OutQuat.Z = HMD.Rotation[2];
+		OutQuat.W = HMD.Rotation[3];
 	}
 	else
 	{
@@ -615,13 +653,14 @@ void FPICOXRDPManager::GetHMDPositionAndRotation(FVector& OutPostion, FQuat& Out
 
 void FPICOXRDPManager::GetControllerPositionAndRotation(EControllerHand DeviceHand, float WorldScale, FVector& OutPostion, FRotator& OutQuat)
 {
-	if (StreamingDataWrapperPtr)
+	if (StreamingDataWrapperPtr && (DeviceHand == EControllerHand::Left || DeviceHand == EControllerHand::Right))
 	{
-		OutPostion.X = -StreamingDataWrapperPtr->GetControllerPosition(DeviceHand).z();
-		OutPostion.Y = StreamingDataWrapperPtr->GetControllerPosition(DeviceHand).x();
-		OutPostion.Z = StreamingDataWrapperPtr->GetControllerPosition(DeviceHand).y();
+		const FPXRDPPose Pose = StreamingDataWrapperPtr->GetDeviceState().Controllers[(int32)DeviceHand];
+		OutPostion.X = -Pose.Position[2];
+		OutPostion.Y = Pose.Position[0];
+		OutPostion.Z = Pose.Position[1];
 		OutPostion = OutPostion * WorldScale;
-		OutQuat = FQuat(StreamingDataWrapperPtr->GetControllerRotation(DeviceHand).z(), -StreamingDataWrapperPtr->GetControllerRotation(DeviceHand).x(), -StreamingDataWrapperPtr->GetControllerRotation(DeviceHand).y(), StreamingDataWrapperPtr->GetControllerRotation(DeviceHand).w()).Rotator();
+		OutQuat = FQuat(Pose.Rotation[2], -Pose.Rotation[0], -Pose.Rotation[1], Pose.Rotation[3]).Rotator();
 	}
 	else
 	{
@@ -632,22 +671,52 @@ void FPICOXRDPManager::GetControllerPositionAndRotation(EControllerHand DeviceHa
 
 bool FPICOXRDPManager::GetControllerConnectionStatus(EControllerHand DeviceHand)
 {
-	return StreamingDataWrapperPtr ? StreamingDataWrapperPtr->GetConnectionStatus(DeviceHand) : false;
+	FPXRDPDeviceState State;
+	return GetDeviceState(State) && (DeviceHand == EControllerHand::Left || DeviceHand == EControllerHand::Right) ? State.Controllers[(int32)DeviceHand].bActive : false;
 }
 
 int32 FPICOXRDPManager::GetControllerButtonStatus(EControllerHand DeviceHand)
 {
-	return StreamingDataWrapperPtr ? StreamingDataWrapperPtr->GetStateValue(DeviceHand) : 0;
+	FPXRDPDeviceState State;
+	return GetDeviceState(State) && (DeviceHand == EControllerHand::Left || DeviceHand == EControllerHand::Right) ? State.Buttons[(int32)DeviceHand].State : 0;
 }
 
-void FPICOXRDPManager::GetControllerAxisValue(EControllerHand DeviceHand, double& JoyStickX, double& JoyStickY, float& TriggerValue, float& GripValue)
+bool FPICOXRDPManager::GetFramePose(uint64 FrameNumber, FPXRDPFramePose& OutFramePose)
+{
+	return FramePoses.Find(FrameNumber, OutFramePose);
+}
+
+void FPICOXRDPManager::DumpPoseLatencyStats(FOutputDevice& Ar)
+{
+	Ar.Logf(TEXT("Target latency %.1f ms"), GetPXRDPTargetLatency() * 1000.0);
+	FramePoses.Dump(Ar);
+}
+
+static FAutoConsoleCommandWithOutputDevice CPICOLivePreviewPoseLatencyStats(
+	TEXT("PICO.LivePreview.PoseLatencyStats"),
+	TEXT("Prints how old the Live Preview HMD poses were when frames were rendered and submitted"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FPICOXRDPManager::DumpPoseLatencyStats));
+
+bool FPICOXRDPManager::GetDeviceState(FPXRDPDeviceState& OutState)
 {
 	if (StreamingDataWrapperPtr)
 	{
-		JoyStickX = StreamingDataWrapperPtr->GetJoystickX(DeviceHand);
-		JoyStickY = StreamingDataWrapperPtr->GetJoystickY(DeviceHand);
-		TriggerValue = StreamingDataWrapperPtr->GetTriggerValue(DeviceHand);
-		GripValue = StreamingDataWrapperPtr->GetGripValue(DeviceHand);
+		OutState = StreamingDataWrapperPtr->GetDeviceState();
+		return true;
+	}
+	return false;
+}
+
+void FPICOXRDPManager::GetControllerAxisValue(EControllerHand DeviceHand, double& JoyStickX, double& JoyStickY, float& TriggerValue, float& GripValue)
+{
+	FPXRDPDeviceState State;
+	if (GetDeviceState(State) && (DeviceHand == EControllerHand::Left || DeviceHand == EControllerHand::Right))
+	{
+		const FPXRDPButtons& Buttons = State.Buttons[(int32)DeviceHand];
+		JoyStickX = Buttons.JoystickX;
+		JoyStickY = Buttons.JoystickY;
+		TriggerValue = Buttons.TriggerValue;
+		GripValue = Buttons.GripValue;
 	}
 }
 
@@ -0,0 +1,317 @@
+//Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#include "PXR_DPPoseExchange.h"
+#include "Async/Async.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarPICOLivePreviewTargetLatencyMs(
+	TEXT("PICO.LivePreview.TargetLatencyMs"),
+	0.0f,
+	TEXT("Predicts the Live Preview HMD pose this many milliseconds past the render time, to when the streamed frame is expected on the headset.\n")
+	TEXT("0 renders the latest received pose. PICO.LivePreview.MeasureLatency estimates a value for the current setup.\n"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPICOLivePreviewMaxPredictionMs(
+	TEXT("PICO.LivePreview.MaxPredictionMs"),
+	100.0f,
+	TEXT("Upper bound of the Live Preview pose prediction, counted from when the pose was received\n"),
+	ECVF_Default);
+
+namespace
+{
+	// Samples closer than this are too jittery to take a velocity from
+	const double MinVelocityInterval = 0.004;
+	const double VelocityWindow = 0.05;
+
+	FQuat ToQuat(const float (&Rotation)[4])
+	{
+		return FQuat(Rotation[0], Rotation[1], Rotation[2], Rotation[3]);
+	}
+}
+
+void FPXRDPPoseHistory::Add(FPXRDPPose& Pose)
+{
+	const FPXRDPPose* Reference = nullptr;
+	for (int32 Age = 1; Age <= Num; Age++)
+	{
+		const FPXRDPPose& Sample = Samples[(Next - Age + Capacity) % Capacity];
+		const double Interval = Pose.Timestamp - Sample.Timestamp;
+		if (Interval > VelocityWindow)
+		{
+			break;
+		}
+		if (Interval >= MinVelocityInterval)
+		{
+			Reference = &Sample;
+		}
+	}
+
+	if (Reference)
+	{
+		const double InvInterval = 1.0 / (Pose.Timestamp - Reference->Timestamp);
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			Pose.LinearVelocity[Axis] = (Pose.Position[Axis] - Reference->Position[Axis]) * InvInterval;
+		}
+
+		FQuat Delta = ToQuat(Pose.Rotation) * ToQuat(Reference->Rotation).Inverse();
+		Delta.Normalize();
+		if (Delta.W < 0.0)
+		{
+			Delta = Delta * -1.0;
+		}
+		FVector RotationAxis;
+		double Angle;
+		Delta.ToAxisAndAngle(RotationAxis, Angle);
+		const FVector AngularVelocity = RotationAxis * (Angle * InvInterval);
+		Pose.AngularVelocity[0] = AngularVelocity.X;
+		Pose.AngularVelocity[1] = AngularVelocity.Y;
+		Pose.AngularVelocity[2] = AngularVelocity.Z;
+	}
+	else if (Num > 0)
+	{
+		// Arrived in the same burst as the previous sample, keep its estimate
+		const FPXRDPPose& Previous = Samples[(Next - 1 + Capacity) % Capacity];
+		FMemory::Memcpy(Pose.LinearVelocity, Previous.LinearVelocity, sizeof(Pose.LinearVelocity));
+		FMemory::Memcpy(Pose.AngularVelocity, Previous.AngularVelocity, sizeof(Pose.AngularVelocity));
+	}
+
+	Samples[Next] = Pose;
+	Next = (Next + 1) % Capacity;
+	Num = FMath::Min(Num + 1, Capacity);
+}
+
+void FPXRDPPoseHistory::Reset()
+{
+	Next = 0;
+	Num = 0;
+}
+
+FPXRDPPose PredictPXRDPPose(const FPXRDPPose& Pose, double TargetTime)
+{
+	const double MaxPrediction = FMath::Max(0.0f, CVarPICOLivePreviewMaxPredictionMs.GetValueOnAnyThread()) / 1000.0;
+	const double Interval = FMath::Clamp(TargetTime - Pose.Timestamp, 0.0, MaxPrediction);
+	if (Pose.Timestamp <= 0.0 || Interval <= 0.0)
+	{
+		return Pose;
+	}
+
+	FPXRDPPose Predicted = Pose;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Predicted.Position[Axis] += Pose.LinearVelocity[Axis] * Interval;
+	}
+
+	const FVector AngularVelocity(Pose.AngularVelocity[0], Pose.AngularVelocity[1], Pose.AngularVelocity[2]);
+	const double Speed = AngularVelocity.Size();
+	if (Speed > UE_SMALL_NUMBER)
+	{
+		FQuat Rotation = FQuat(AngularVelocity / Speed, Speed * Interval) * ToQuat(Pose.Rotation);
+		Rotation.Normalize();
+		Predicted.Rotation[0] = Rotation.X;
+		Predicted.Rotation[1] = Rotation.Y;
+		Predicted.Rotation[2] = Rotation.Z;
+		Predicted.Rotation[3] = Rotation.W;
+	}
+	return Predicted;
+}
+
+double GetPXRDPTargetLatency()
+{
+	return FMath::Max(0.0f, CVarPICOLivePreviewTargetLatencyMs.GetValueOnAnyThread()) / 1000.0;
+}
+
+void FPXRDPFramePoseHistory::Record(const FPXRDPFramePose& FramePose)
+{
+	FScopeLock ScopeLock(&Lock);
+	Frames[FramePose.FrameNumber % Capacity] = FramePose;
+}
+
+bool FPXRDPFramePoseHistory::Find(uint64 FrameNumber, FPXRDPFramePose& OutFramePose) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const FPXRDPFramePose& FramePose = Frames[FrameNumber % Capacity];
+	if (FramePose.FrameNumber != FrameNumber || FramePose.Pose.Timestamp <= 0.0)
+	{
+		return false;
+	}
+	OutFramePose = FramePose;
+	return true;
+}
+
+bool FPXRDPFramePoseHistory::MarkSubmitted(uint64 FrameNumber, double SubmitTime, FPXRDPFramePose& OutFramePose)
+{
+	FScopeLock ScopeLock(&Lock);
+	FPXRDPFramePose& FramePose = Frames[FrameNumber % Capacity];
+	if (FramePose.FrameNumber != FrameNumber || FramePose.Pose.Timestamp <= 0.0)
+	{
+		SubmittedWithoutPose++;
+		return false;
+	}
+
+	FramePose.SubmitTime = SubmitTime;
+	Submitted++;
+	SampleAgeAtRender += FramePose.RenderTime - FramePose.Pose.Timestamp;
+	SampleAgeAtSubmit += SubmitTime - FramePose.Pose.Timestamp;
+	MaxSampleAgeAtSubmit = FMath::Max(MaxSampleAgeAtSubmit, SubmitTime - FramePose.Pose.Timestamp);
+	if (FramePose.TargetTime > FramePose.RenderTime)
+	{
+		Prediction += FMath::Max(0.0, FramePose.TargetTime - FramePose.Pose.Timestamp);
+	}
+	OutFramePose = FramePose;
+	return true;
+}
+
+void FPXRDPFramePoseHistory::Reset()
+{
+	FScopeLock ScopeLock(&Lock);
+	for (FPXRDPFramePose& FramePose : Frames)
+	{
+		FramePose = FPXRDPFramePose();
+	}
+	Submitted = 0;
+	SubmittedWithoutPose = 0;
+	SampleAgeAtRender = 0.0;
+	SampleAgeAtSubmit = 0.0;
+	MaxSampleAgeAtSubmit = 0.0;
+	Prediction = 0.0;
+}
+
+void FPXRDPFramePoseHistory::Dump(FOutputDevice& Ar) const
+{
+	FScopeLock ScopeLock(&Lock);
+	const double Scale = Submitted > 0 ? 1000.0 / Submitted : 0.0;
+	Ar.Logf(TEXT("Submitted frames %llu, without a recorded pose %llu"), Submitted, SubmittedWithoutPose);
+	Ar.Logf(TEXT("Pose age at render %.2f ms, at submit %.2f ms (max %.2f ms), predicted ahead %.2f ms"),
+		SampleAgeAtRender * Scale, SampleAgeAtSubmit * Scale, MaxSampleAgeAtSubmit * 1000.0, Prediction * Scale);
+}
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	const int32 NumCheckedFields = 15;
+
+	void GetCheckedFields(FPXRDPDeviceState& State, float* (&OutFields)[NumCheckedFields])
+	{
+		float* Fields[NumCheckedFields] =
+		{
+			&State.HMD.Position[0], &State.HMD.Position[1], &State.HMD.Position[2],
+			&State.HMD.Rotation[0], &State.HMD.Rotation[1], &State.HMD.Rotation[2], &State.HMD.Rotation[3],
+			&State.Controllers[0].Position[0], &State.Controllers[0].Rotation[3],
+			&State.Controllers[1].Position[0], &State.Controllers[1].Rotation[3],
+			&State.Buttons[0].JoystickX, &State.Buttons[0].GripValue,
+			&State.Buttons[1].JoystickX, &State.Buttons[1].GripValue,
+		};
+		FMemory::Memcpy(OutFields, Fields, sizeof(Fields));
+	}
+
+	/** Every field derives from Value, so a snapshot mixing two writes is detectable. */
+	void FillDeviceState(int32 Value, FPXRDPDeviceState& OutState)
+	{
+		float* Fields[NumCheckedFields];
+		GetCheckedFields(OutState, Fields);
+		for (int32 Index = 0; Index < NumCheckedFields; Index++)
+		{
+			*Fields[Index] = (float)((Value + Index) & 0xFFFF);
+		}
+		OutState.HMD.Timestamp = Value;
+		OutState.Buttons[0].State = Value;
+		OutState.Buttons[1].State = Value;
+	}
+
+	bool IsConsistent(FPXRDPDeviceState State)
+	{
+		const int32 Value = State.Buttons[0].State;
+		float* Fields[NumCheckedFields];
+		GetCheckedFields(State, Fields);
+		for (int32 Index = 0; Index < NumCheckedFields; Index++)
+		{
+			if (*Fields[Index] != (float)((Value + Index) & 0xFFFF))
+			{
+				return false;
+			}
+		}
+		return State.HMD.Timestamp == Value && State.Buttons[1].State == Value;
+	}
+
+	void PoseExchangeStressTest(const TArray<FString>& Args)
+	{
+		const double Seconds = Args.Num() > 0 ? FMath::Max(0.1, FCString::Atod(*Args[0])) : 2.0;
+		const int32 NumReaders = Args.Num() > 1 ? FMath::Clamp(FCString::Atoi(*Args[1]), 1, 16) : 3;
+
+		FPXRDPDeviceStateExchange Exchange;
+		std::atomic<bool> bStop{ false };
+
+		// Two writers, like the pose and button callbacks arriving on different driver threads
+		TArray<TFuture<uint64>> Writers;
+		for (int32 Writer = 0; Writer < 2; Writer++)
+		{
+			Writers.Add(Async(EAsyncExecution::Thread, [&Exchange, &bStop]()
+			{
+				uint64 Writes = 0;
+				while (!bStop.load(std::memory_order_relaxed))
+				{
+					Exchange.Update([](FPXRDPDeviceState& State)
+					{
+						FillDeviceState(State.Buttons[0].State + 1, State);
+					});
+					Writes++;
+				}
+				return Writes;
+			}));
+		}
+
+		struct FReaderResult
+		{
+			uint64 Reads = 0;
+			uint64 Torn = 0;
+			uint64 Backwards = 0;
+		};
+		TArray<TFuture<FReaderResult>> Readers;
+		for (int32 Reader = 0; Reader < NumReaders; Reader++)
+		{
+			Readers.Add(Async(EAsyncExecution::Thread, [&Exchange, &bStop]()
+			{
+				FReaderResult Result;
+				int32 LastValue = 0;
+				while (!bStop.load(std::memory_order_relaxed))
+				{
+					const FPXRDPDeviceState State = Exchange.Read();
+					Result.Reads++;
+					Result.Torn += IsConsistent(State) ? 0 : 1;
+					Result.Backwards += State.Buttons[0].State < LastValue ? 1 : 0;
+					LastValue = State.Buttons[0].State;
+				}
+				return Result;
+			}));
+		}
+
+		FPlatformProcess::Sleep(Seconds);
+		bStop = true;
+
+		uint64 Writes = 0;
+		for (TFuture<uint64>& Writer : Writers)
+		{
+			Writes += Writer.Get();
+		}
+		FReaderResult Total;
+		for (TFuture<FReaderResult>& Reader : Readers)
+		{
+			const FReaderResult& Result = Reader.Get();
+			Total.Reads += Result.Reads;
+			Total.Torn += Result.Torn;
+			Total.Backwards += Result.Backwards;
+		}
+
+		const bool bPassed = Total.Torn == 0 && Total.Backwards == 0;
+		UE_LOG(LogTemp, Display, TEXT("PoseExchangeStressTest %s: %.1fs, %llu writes, %d readers, %llu reads, %llu retries, %llu torn, %llu out of order"),
+			bPassed ? TEXT("passed") : TEXT("FAILED"), Seconds, Writes, NumReaders, Total.Reads, Exchange.GetReadRetries(), Total.Torn, Total.Backwards);
+	}
+}
+
+static FAutoConsoleCommand CPICOLivePreviewPoseExchangeStressTest(
+	TEXT("PICO.LivePreview.PoseExchangeStressTest"),
+	TEXT("Hammers the Live Preview device state exchange from two writer and several reader threads and reports torn or out of order snapshots.\n")
+	TEXT("Usage: PICO.LivePreview.PoseExchangeStressTest [Seconds=2] [Readers=3]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&PoseExchangeStressTest));
+#endif
@@ -2,6 +2,7 @@
 
 #pragma once
 #include "CoreMinimal.h"
+#include "PXR_DPPoseExchange.h"
 #if PLATFORM_WINDOWS
 #include "D3D11RHIPrivate.h"
 #include "streamingDriverInterface/streaming_driver_interface.h"
@@ -39,53 +40,49 @@ public:
 	virtual void NotifyStreamingStateUpdated(StreamingState state, const DriverMediaConfig& media_config) override;
 	virtual void NotifyControllerStateUpdated(const ControllerState controller_states[], size_t size) override;
 	
-	Vector GetControllerPosition(EControllerHand DeviceHand) const;
-	Rotation GetControllerRotation(EControllerHand DeviceHand) const;
-	Vector GetHMDPosition() const;
-	Rotation GetHMDRotation() const;
+	/** Latest poses and buttons as one consistent snapshot, never blocks the driver. */
+	FPXRDPDeviceState GetDeviceState() const { return DeviceState.Read(); }
+	const FPXRDPDeviceStateExchange& GetDeviceStateExchange() const { return DeviceState; }
+
+	/** Stamps, estimates the velocity of and publishes an HMD pose that does not come from the driver. */
+	uint64 PushHMDPose(const FPXRDPPose& Pose);
+
+	/** The driver pose an HMD sample was made from, for submitting frames back. Falls back to the latest one. */
+	void GetDriverHMDPose(uint64 SampleId, Vector& OutPosition, Rotation& OutRotation) const;
 
 	bool GetDeviceFovInfo(DeviceFovInfo& FovInfo) const;
-	float GetJoystickX(EControllerHand DeviceHand) const;
-	float GetJoystickY(EControllerHand DeviceHand) const;
-	float GetTriggerValue(EControllerHand DeviceHand) const;
-	float GetGripValue(EControllerHand DeviceHand) const;
-	float GetStateValue(EControllerHand DeviceHand) const;
-	bool GetConnectionStatus(EControllerHand DeviceHand) const;
 	bool IsStreaming() const;
 	bool GetDriverMediaConfig(DriverMediaConfig& MediaConfig) const;
 	
 	FOnDeviceConnectedResultsEvent OnDeviceConnectedResultsEvent;
 	FOnConnectFromServiceEvent OnConnectFromServiceEvent;
 	FOnFovUpdatedFromServiceEvent OnFovUpdatedFromServiceEvent;
-	FCriticalSection StateLock;
+	mutable FCriticalSection StateLock;
 	
 private:
+	/** Call from a DeviceState update only. */
+	uint64 AddHMDSample(FPXRDPDeviceState& State, FPXRDPPose Pose);
+
 
 	//DeviceInfo Device_Info;
-	bool bLeftActive;
-	bool bRightActive;
 	bool bStreaming;
 	DeviceFovInfo PDCDeviceFovInfo;
 	DriverMediaConfig PDCMediaConfig;
 	
-	Vector LeftPosition;
-	Rotation LeftRotation;
-	Vector RightPosition;
-	Rotation RightRotation;
-	Vector HMDPosition;
-	Rotation HMDRotation;
-
-	float LeftJoystickX;
-	float LeftJoystickY;
-	float LeftTriggerValue;
-	float LeftGripValue;
-	int32 LeftState;
-
-	float RightJoystickX;
-	float RightJoystickY;
-	float RightTriggerValue;
-	float RightGripValue;
-	int32 RightState;
+	FPXRDPDeviceStateExchange DeviceState;
+	FPXRDPPoseHistory HMDHistory;
+	uint64 HMDSampleCount = 0;
+
+	// Guarded by StateLock
+	struct FDriverHMDSample
+	{
+		uint64 SampleId = 0;
+		Vector DriverPosition;
+		Rotation DriverRotation;
+	};
+	static constexpr int32 NumDriverHMDSamples = 16;
+	FDriverHMDSample DriverHMDSamples[NumDriverHMDSamples];
+	uint64 LatestDriverHMDSample = 0;
 
 };
 
@@ -107,6 +104,10 @@ public:
 	static void GetControllerPositionAndRotation(EControllerHand DeviceHand,float WorldScale, FVector& OutPostion, FRotator& OutQuat);
 	static bool GetControllerConnectionStatus(EControllerHand DeviceHand);
 	static int32 GetControllerButtonStatus(EControllerHand DeviceHand);
+	static bool GetDeviceState(FPXRDPDeviceState& OutState);
+	/** Pose the given frame was rendered with, see PICO.LivePreview.TargetLatencyMs. */
+	static bool GetFramePose(uint64 FrameNumber, FPXRDPFramePose& OutFramePose);
+	static void DumpPoseLatencyStats(FOutputDevice& Ar);
 	static void GetControllerAxisValue(EControllerHand DeviceHand,double &JoyStickX,double& JoyStickY,float &TriggerValue,float &GripValue);
 	static bool IsConnectToServiceSucceed();
 	static bool GetPICOXRFrustumDP(FPICOXRFrustumDP& PICOXRFrustumDP);
@@ -116,6 +117,11 @@ public:
 	static bool SetDisconnectFromServiceEvent(const FOnConnectFromServiceEvent &OnConnectFromServiceEvent);
 	static bool SetFovUpdatedFromServiceEvent(const FOnFovUpdatedFromServiceEvent &OnFovUpdatedFromServiceEvent);
 
+	/** Swaps the streaming driver, e.g. for the loopback one of PICO.LivePreview.MeasureLatency. Returns the previous driver. */
+	static StreamingDriverInterface::Ptr_t ReplaceStreamingDriver(StreamingDriverInterface::Ptr_t Driver);
+	/** The callback every streaming driver reports to, null before InitializeLivePreview. */
+	static StreamingDataReceiveWrapper* GetStreamingDataReceiver();
+
 	static FTextureRHIRef GetLeftBindingTexture();
 	static FTextureRHIRef GetRightBindingTexture();
 	
@@ -149,6 +155,7 @@ private:
 	static TSharedPtr<StreamingDataReceiveWrapper,ESPMode::ThreadSafe> StreamingDataWrapperPtr;
 
 	static uint32 SwapChainIndex_RHIThread;
+	static FPXRDPFramePoseHistory FramePoses;
 	
 	static TArray<TRefCountPtr<ID3D11Texture2D>> LeftDstSwapChainTextures;
 	static TArray<TRefCountPtr<ID3D11Texture2D>> RightDstSwapChainTextures;
@@ -0,0 +1,142 @@
+//Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "PXR_SeqLock.h"
+#include <atomic>
+
+/** Pose as received from the streaming driver, in driver space. */
+struct FPXRDPPose
+{
+	float Position[3] = { 0.f, 0.f, 0.f };
+	float Rotation[4] = { 0.f, 0.f, 0.f, 1.f };
+	bool bActive = false;
+	/** FPlatformTime::Seconds when the driver reported it, 0 if never. */
+	double Timestamp = 0.0;
+	/** Driver space, per second. Angular velocity is axis times angle, applied on the left of Rotation. */
+	float LinearVelocity[3] = { 0.f, 0.f, 0.f };
+	float AngularVelocity[3] = { 0.f, 0.f, 0.f };
+	/** Counts HMD samples, 0 for controllers. */
+	uint64 SampleId = 0;
+};
+
+struct FPXRDPButtons
+{
+	float JoystickX = 0.f;
+	float JoystickY = 0.f;
+	float TriggerValue = 0.f;
+	float GripValue = 0.f;
+	int32 State = 0;
+	double Timestamp = 0.0;
+};
+
+/** Everything the game reads from the headset in one frame. */
+struct FPXRDPDeviceState
+{
+	FPXRDPPose HMD;
+	/** Indexed by EControllerHand::Left and EControllerHand::Right. */
+	FPXRDPPose Controllers[2];
+	FPXRDPButtons Buttons[2];
+};
+
+/**
+ * Hands device state from the streaming driver callbacks to the game, render and RHI threads.
+ *
+ * The driver threads each update their part of a private copy under WriteLock and publish the whole state; readers
+ * always get one consistent snapshot and never take a lock.
+ */
+class FPXRDPDeviceStateExchange
+{
+public:
+	template<typename FuncType>
+	void Update(FuncType&& Func)
+	{
+		FScopeLock ScopeLock(&WriteLock);
+		Func(Pending);
+		Published.Write(Pending);
+	}
+
+	FPXRDPDeviceState Read() const
+	{
+		FPXRDPDeviceState State;
+		const uint32 Retries = Published.Read(State);
+		if (Retries > 0)
+		{
+			ReadRetries.fetch_add(Retries, std::memory_order_relaxed);
+		}
+		return State;
+	}
+
+	uint32 GetSequence() const { return Published.GetSequence(); }
+	uint64 GetReadRetries() const { return ReadRetries.load(std::memory_order_relaxed); }
+
+private:
+	FCriticalSection WriteLock;
+	FPXRDPDeviceState Pending;
+	TPXRSeqLock<FPXRDPDeviceState> Published;
+	mutable std::atomic<uint64> ReadRetries{ 0 };
+};
+
+/** Last few HMD samples, estimates the velocity of each new one. */
+class PICOXRDPHMD_API FPXRDPPoseHistory
+{
+public:
+	/** Fills in the velocities of Pose from the oldest sample within the window, then keeps it. */
+	void Add(FPXRDPPose& Pose);
+	void Reset();
+
+private:
+	static constexpr int32 Capacity = 8;
+
+	FPXRDPPose Samples[Capacity];
+	int32 Next = 0;
+	int32 Num = 0;
+};
+
+/**
+ * Extrapolates Pose to TargetTime along its velocities, by at most PICO.LivePreview.MaxPredictionMs. Counts from when
+ * the pose was received, so callers skip it when PICO.LivePreview.TargetLatencyMs is 0.
+ */
+PICOXRDPHMD_API FPXRDPPose PredictPXRDPPose(const FPXRDPPose& Pose, double TargetTime);
+
+/** PICO.LivePreview.TargetLatencyMs in seconds. */
+PICOXRDPHMD_API double GetPXRDPTargetLatency();
+
+/** Pose a frame was rendered with, kept until the frame is submitted to the headset. */
+struct FPXRDPFramePose
+{
+	uint64 FrameNumber = 0;
+	/** Predicted pose, Timestamp and SampleId still name the sample it was predicted from. */
+	FPXRDPPose Pose;
+	double RenderTime = 0.0;
+	double TargetTime = 0.0;
+	double SubmitTime = 0.0;
+	/** Set once the render thread sampled the frame again, later calls in the same frame reuse that pose. */
+	bool bLateUpdated = false;
+};
+
+/** Frame poses between the game and the render thread, and how old they were when submitted. */
+class PICOXRDPHMD_API FPXRDPFramePoseHistory
+{
+public:
+	void Record(const FPXRDPFramePose& FramePose);
+	bool Find(uint64 FrameNumber, FPXRDPFramePose& OutFramePose) const;
+	/** Stamps the submission and accounts the frame's latency. */
+	bool MarkSubmitted(uint64 FrameNumber, double SubmitTime, FPXRDPFramePose& OutFramePose);
+	void Reset();
+	void Dump(FOutputDevice& Ar) const;
+
+private:
+	static constexpr int32 Capacity = 8;
+
+	mutable FCriticalSection Lock;
+	FPXRDPFramePose Frames[Capacity];
+
+	// Seconds, summed over Submitted frames
+	uint64 Submitted = 0;
+	uint64 SubmittedWithoutPose = 0;
+	double SampleAgeAtRender = 0.0;
+	double SampleAgeAtSubmit = 0.0;
+	double MaxSampleAgeAtSubmit = 0.0;
+	double Prediction = 0.0;
+};
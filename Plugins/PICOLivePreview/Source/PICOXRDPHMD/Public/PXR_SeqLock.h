@@ -0,0 +1,96 @@
+//Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/**
+ * Sequence lock: one writer publishes a value, any number of readers copy it out without ever blocking the writer.
+ *
+ * The value is kept as relaxed atomic words, so a reader racing the writer sees a torn copy only transiently and
+ * retries when the sequence changed under it. Writers must be serialized by the caller.
+ *
+ * Only depends on the standard library, so it builds on every platform, with or without the engine.
+ * PICOLivePreview/Tests/PXR_SeqLockStressTest.cpp hammers it from plain threads outside the engine, see there for how to run it.
+ */
+template<typename ValueType>
+class TPXRSeqLock
+{
+	static_assert(std::is_trivially_copyable<ValueType>::value, "TPXRSeqLock values are copied word by word");
+
+public:
+	TPXRSeqLock()
+	{
+		Store(ValueType());
+	}
+
+	void Write(const ValueType& Value)
+	{
+		const std::uint32_t Seq = Sequence.load(std::memory_order_relaxed);
+		Sequence.store(Seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		Store(Value);
+		Sequence.store(Seq + 2, std::memory_order_release);
+	}
+
+	/** Returns the number of retries it took to get a consistent copy. */
+	std::uint32_t Read(ValueType& OutValue) const
+	{
+		for (std::uint32_t Retries = 0;; Retries++)
+		{
+			const std::uint32_t Begin = Sequence.load(std::memory_order_acquire);
+			if ((Begin & 1) == 0)
+			{
+				Load(OutValue);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Sequence.load(std::memory_order_relaxed) == Begin)
+				{
+					return Retries;
+				}
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	ValueType Read() const
+	{
+		ValueType Value;
+		Read(Value);
+		return Value;
+	}
+
+	/** Even, and bumped by two on every write. */
+	std::uint32_t GetSequence() const
+	{
+		return Sequence.load(std::memory_order_acquire);
+	}
+
+private:
+	static constexpr int NumWords = (sizeof(ValueType) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+	void Store(const ValueType& Value)
+	{
+		std::uint64_t Buffer[NumWords] = {};
+		std::memcpy(Buffer, &Value, sizeof(ValueType));
+		for (int Index = 0; Index < NumWords; Index++)
+		{
+			Words[Index].store(Buffer[Index], std::memory_order_relaxed);
+		}
+	}
+
+	void Load(ValueType& OutValue) const
+	{
+		std::uint64_t Buffer[NumWords];
+		for (int Index = 0; Index < NumWords; Index++)
+		{
+			Buffer[Index] = Words[Index].load(std::memory_order_relaxed);
+		}
+		std::memcpy(&OutValue, Buffer, sizeof(ValueType));
+	}
+
+	std::atomic<std::uint32_t> Sequence{ 0 };
+	std::atomic<std::uint64_t> Words[NumWords];
+};
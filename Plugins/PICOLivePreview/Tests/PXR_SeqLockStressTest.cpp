@@ -0,0 +1,129 @@
+//Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+// Hammers TPXRSeqLock from two writer and several reader threads, outside the engine, and fails on any torn or out of
+// order snapshot. The payload has the size of FPXRDPDeviceState. Not part of any module; from the plugin directory:
+//
+//   c++ -std=c++17 -O2 -pthread -ISource/PICOXRDPHMD/Public Tests/PXR_SeqLockStressTest.cpp -o SeqLockStressTest
+//   ./SeqLockStressTest [Seconds=2] [Readers=3]
+
+#include "PXR_SeqLock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	const int NumFields = 66;
+
+	/** Three poses and two button sets worth of words, every one derived from Value. */
+	struct FStressState
+	{
+		std::int32_t Value = 0;
+		float Fields[NumFields] = {};
+		double Timestamp = 0.0;
+	};
+	static_assert(sizeof(FStressState) == 280, "Keep the payload the size of FPXRDPDeviceState");
+
+	void FillState(std::int32_t Value, FStressState& OutState)
+	{
+		OutState.Value = Value;
+		for (int Index = 0; Index < NumFields; Index++)
+		{
+			OutState.Fields[Index] = (float)((Value + Index) & 0xFFFF);
+		}
+		OutState.Timestamp = Value;
+	}
+
+	bool IsConsistent(const FStressState& State)
+	{
+		for (int Index = 0; Index < NumFields; Index++)
+		{
+			if (State.Fields[Index] != (float)((State.Value + Index) & 0xFFFF))
+			{
+				return false;
+			}
+		}
+		return State.Timestamp == State.Value;
+	}
+
+	struct FReaderResult
+	{
+		std::uint64_t Reads = 0;
+		std::uint64_t Retries = 0;
+		std::uint64_t Torn = 0;
+		std::uint64_t Backwards = 0;
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const double Seconds = argc > 1 ? std::max(0.1, std::atof(argv[1])) : 2.0;
+	const int NumReaders = argc > 2 ? std::min(std::max(std::atoi(argv[2]), 1), 16) : 3;
+
+	TPXRSeqLock<FStressState> SeqLock;
+	// Writers are serialized by the caller, as FPXRDPDeviceStateExchange does with its WriteLock
+	std::mutex WriteLock;
+	FStressState Pending;
+	std::atomic<bool> bStop{ false };
+
+	// Two writers, like the pose and button callbacks arriving on different driver threads
+	std::vector<std::uint64_t> Writes(2, 0);
+	std::vector<std::thread> Threads;
+	for (int Writer = 0; Writer < 2; Writer++)
+	{
+		Threads.emplace_back([&, Writer]()
+		{
+			while (!bStop.load(std::memory_order_relaxed))
+			{
+				std::lock_guard<std::mutex> ScopeLock(WriteLock);
+				FillState(Pending.Value + 1, Pending);
+				SeqLock.Write(Pending);
+				Writes[Writer]++;
+			}
+		});
+	}
+
+	std::vector<FReaderResult> Results(NumReaders);
+	for (int Reader = 0; Reader < NumReaders; Reader++)
+	{
+		Threads.emplace_back([&, Reader]()
+		{
+			FReaderResult& Result = Results[Reader];
+			std::int32_t LastValue = 0;
+			FStressState State;
+			while (!bStop.load(std::memory_order_relaxed))
+			{
+				Result.Retries += SeqLock.Read(State);
+				Result.Reads++;
+				Result.Torn += IsConsistent(State) ? 0 : 1;
+				Result.Backwards += State.Value < LastValue ? 1 : 0;
+				LastValue = State.Value;
+			}
+		});
+	}
+
+	std::this_thread::sleep_for(std::chrono::duration<double>(Seconds));
+	bStop = true;
+	for (std::thread& Thread : Threads)
+	{
+		Thread.join();
+	}
+
+	FReaderResult Total;
+	for (const FReaderResult& Result : Results)
+	{
+		Total.Reads += Result.Reads;
+		Total.Retries += Result.Retries;
+		Total.Torn += Result.Torn;
+		Total.Backwards += Result.Backwards;
+	}
+
+	const bool bPassed = Total.Torn == 0 && Total.Backwards == 0 && Total.Reads > 0 && Writes[0] + Writes[1] > 0;
+	std::printf("SeqLockStressTest %s: %.1fs, %llu writes, %d readers, %llu reads, %llu retries, %llu torn, %llu out of order\n",
+		bPassed ? "passed" : "FAILED", Seconds, (unsigned long long)(Writes[0] + Writes[1]), NumReaders,
+		(unsigned long long)Total.Reads, (unsigned long long)Total.Retries, (unsigned long long)Total.Torn, (unsigned long long)Total.Backwards);
+	return bPassed ? 0 : 1;
+}
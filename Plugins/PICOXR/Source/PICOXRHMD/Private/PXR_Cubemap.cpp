@@ -4,18 +4,212 @@
 
 
 #include "PXR_Cubemap.h"
-#include "Engine/StaticMeshActor.h"
 #include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "IImageWrapper.h"
 #include "IImageWrapperModule.h"
-#include "ImageUtils.h"
-#include "TimerManager.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "Engine/World.h"
+#include "EngineUtils.h"
 #include "Misc/FileHelper.h"
 #include "Modules/ModuleManager.h"
+#include "Async/Async.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+#include "PXR_Log.h"
+#include <atomic>
+
+namespace
+{
+	const int32 NumCubeFaces = 6;
+
+	// Right, left, top, bottom, front, back, relative to the actor
+	const FQuat FaceOrientations[NumCubeFaces] =
+	{
+		{ FVector(0, 0, 1), PI / 2 }, { FVector(0, 0, 1), -PI / 2 },
+		{ FVector(0, 1, 0), -PI / 2 }, { FVector(0, 1, 0), PI / 2 },
+		{ FVector(0, 0, 1), 0 }, { FVector(0, 0, 1), -PI },
+	};
+
+	EPixelFormat GetCapturePixelFormat(EPXRCubemapFormat Format)
+	{
+		return Format == EPXRCubemapFormat::EXR ? PF_FloatRGBA : PF_B8G8R8A8;
+	}
+
+	/** Sets alpha to opaque, 16 bytes at a time. Pixels are BGRA8, or RGBA16F for EXR. */
+	void ForceOpaque(uint8* Data, int64 NumBytes, EPXRCubemapFormat Format)
+	{
+		// Little endian lanes: BGRA8 keeps alpha in the top byte of every word, RGBA16F in the top half of every second one
+		const bool bHalf = Format == EPXRCubemapFormat::EXR;
+		const VectorRegister4Int KeepMask = bHalf ? MakeVectorRegisterInt(-1, 0x0000FFFF, -1, 0x0000FFFF) : MakeVectorRegisterInt(0x00FFFFFF, 0x00FFFFFF, 0x00FFFFFF, 0x00FFFFFF);
+		const VectorRegister4Int OpaqueBits = bHalf ? MakeVectorRegisterInt(0, 0x3C000000, 0, 0x3C000000) : MakeVectorRegisterInt(0xFF000000, 0xFF000000, 0xFF000000, 0xFF000000);
+
+		int64 Offset = 0;
+		for (; Offset + 16 <= NumBytes; Offset += 16)
+		{
+			const VectorRegister4Int Pixels = VectorIntLoad(Data + Offset);
+			VectorIntStore(VectorIntOr(VectorIntAnd(Pixels, KeepMask), OpaqueBits), Data + Offset);
+		}
+
+		const int32 BytesPerPixel = bHalf ? 8 : 4;
+		for (; Offset + BytesPerPixel <= NumBytes; Offset += BytesPerPixel)
+		{
+			if (bHalf)
+			{
+				Data[Offset + 6] = 0x00;
+				Data[Offset + 7] = 0x3C;
+			}
+			else
+			{
+				Data[Offset + 3] = 0xFF;
+			}
+		}
+	}
+}
+
+/** One capture on its way from the GPU to a file. */
+struct FPXRCubemapJob
+{
+	uint32 Resolution = 0;
+	EPXRCubemapLayout Layout = EPXRCubemapLayout::Strip;
+	EPXRCubemapFormat Format = EPXRCubemapFormat::PNG;
+	int32 BytesPerPixel = 4;
+	FString Filename;
+
+	// Render thread until bFacesReady
+	TUniquePtr<FRHIGPUTextureReadback> Readbacks[NumCubeFaces];
+	/** Tightly packed faces, written by the render thread and read by the worker. */
+	TArray64<uint8> Faces[NumCubeFaces];
+
+	std::atomic<bool> bPollQueued{ false };
+	std::atomic<bool> bFacesReady{ false };
+
+	/** Copies the faces out once every readback landed. */
+	void Poll_RenderThread()
+	{
+		for (int32 Face = 0; Face < NumCubeFaces; Face++)
+		{
+			if (!Readbacks[Face]->IsReady())
+			{
+				return;
+			}
+		}
+
+		const int64 RowBytes = (int64)Resolution * BytesPerPixel;
+		for (int32 Face = 0; Face < NumCubeFaces; Face++)
+		{
+			int32 RowPitchInPixels = 0;
+			const uint8* Src = static_cast<const uint8*>(Readbacks[Face]->Lock(RowPitchInPixels));
+			Faces[Face].SetNumUninitialized(RowBytes * Resolution);
+			if (Src)
+			{
+				for (uint32 Y = 0; Y < Resolution; Y++)
+				{
+					FMemory::Memcpy(Faces[Face].GetData() + Y * RowBytes, Src + (int64)Y * RowPitchInPixels * BytesPerPixel, RowBytes);
+				}
+			}
+			else
+			{
+				FMemory::Memzero(Faces[Face].GetData(), Faces[Face].Num());
+			}
+			Readbacks[Face]->Unlock();
+			Readbacks[Face].Reset();
+		}
+		bFacesReady = true;
+	}
+
+	/** Lays the faces out into one image. */
+	void Assemble(TArray64<uint8>& OutImage, int32& OutWidth, int32& OutHeight) const
+	{
+		const int64 FaceRowBytes = (int64)Resolution * BytesPerPixel;
+		if (Layout == EPXRCubemapLayout::Strip)
+		{
+			OutWidth = Resolution * NumCubeFaces;
+			OutHeight = Resolution;
+			OutImage.SetNumUninitialized(FaceRowBytes * NumCubeFaces * Resolution);
+			for (int32 Face = 0; Face < NumCubeFaces; Face++)
+			{
+				for (uint32 Y = 0; Y < Resolution; Y++)
+				{
+					FMemory::Memcpy(OutImage.GetData() + (Y * NumCubeFaces + Face) * FaceRowBytes, Faces[Face].GetData() + Y * FaceRowBytes, FaceRowBytes);
+				}
+			}
+			return;
+		}
+
+		// Equirect: for every output pixel, sample the face its direction points through
+		OutWidth = Resolution * 4;
+		OutHeight = Resolution * 2;
+		OutImage.SetNumUninitialized((int64)OutWidth * OutHeight * BytesPerPixel);
+		uint8* Dst = OutImage.GetData();
+		for (int32 Y = 0; Y < OutHeight; Y++)
+		{
+			const double Latitude = HALF_PI - PI * (Y + 0.5) / OutHeight;
+			for (int32 X = 0; X < OutWidth; X++)
+			{
+				const double Longitude = TWO_PI * (X + 0.5) / OutWidth - PI;
+				const FVector Direction(FMath::Cos(Latitude) * FMath::Cos(Longitude), FMath::Cos(Latitude) * FMath::Sin(Longitude), FMath::Sin(Latitude));
+
+				int32 BestFace = 0;
+				FVector BestLocal = FVector::ZeroVector;
+				for (int32 Face = 0; Face < NumCubeFaces; Face++)
+				{
+					const FVector Local = FaceOrientations[Face].UnrotateVector(Direction);
+					if (Face == 0 || Local.X > BestLocal.X)
+					{
+						BestFace = Face;
+						BestLocal = Local;
+					}
+				}
+
+				// Captures look down X with Y to the right and Z up
+				const int32 U = FMath::Clamp((int32)((BestLocal.Y / BestLocal.X + 1.0) * 0.5 * Resolution), 0, (int32)Resolution - 1);
+				const int32 V = FMath::Clamp((int32)((1.0 - BestLocal.Z / BestLocal.X) * 0.5 * Resolution), 0, (int32)Resolution - 1);
+				FMemory::Memcpy(Dst, Faces[BestFace].GetData() + (V * FaceRowBytes) + (int64)U * BytesPerPixel, BytesPerPixel);
+				Dst += BytesPerPixel;
+			}
+		}
+	}
+
+	/** Runs on a worker thread. */
+	bool Save()
+	{
+		for (TArray64<uint8>& Face : Faces)
+		{
+			ForceOpaque(Face.GetData(), Face.Num(), Format);
+		}
+
+		TArray64<uint8> Image;
+		int32 Width = 0;
+		int32 Height = 0;
+		Assemble(Image, Width, Height);
+		for (TArray64<uint8>& Face : Faces)
+		{
+			Face.Empty();
+		}
+
+		IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(Format == EPXRCubemapFormat::EXR ? EImageFormat::EXR : EImageFormat::PNG);
+		if (!ImageWrapper.IsValid())
+		{
+			return false;
+		}
+
+		const bool bRawSet = Format == EPXRCubemapFormat::EXR
+			? ImageWrapper->SetRaw(Image.GetData(), Image.Num(), Width, Height, ERGBFormat::RGBAF, 16)
+			: ImageWrapper->SetRaw(Image.GetData(), Image.Num(), Width, Height, ERGBFormat::BGRA, 8);
+		if (!bRawSet)
+		{
+			return false;
+		}
+
+		const TArray64<uint8>& Compressed = ImageWrapper->GetCompressed(Format == EPXRCubemapFormat::EXR ? 0 : 100);
+		return Compressed.Num() > 0 && FFileHelper::SaveArrayToFile(Compressed, *Filename);
+	}
+};
 
 // Sets default values
 APXR_Cubemap::APXR_Cubemap()
@@ -32,6 +226,23 @@ void APXR_Cubemap::BeginPlay()
 
 }
 
+void APXR_Cubemap::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (PollHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PollHandle);
+		PollHandle.Reset();
+	}
+	for (USceneCaptureComponent2D* CaptureComponent : CaptureComponents)
+	{
+		CaptureComponent->DestroyComponent();
+	}
+	CaptureComponents.SetNum(0);
+	bCapturing = false;
+
+	Super::EndPlay(EndPlayReason);
+}
+
 // Called every frame
 void APXR_Cubemap::Tick(float DeltaTime)
 {
@@ -39,107 +250,252 @@ void APXR_Cubemap::Tick(float DeltaTime)
 
 }
 
-bool APXR_Cubemap::SaveCubeMap_PICO()
+void APXR_Cubemap::CreateCaptureComponents()
 {
-	Location = GetRootComponent()->GetComponentLocation();
-	Orientation = GetRootComponent()->GetComponentQuat();
-
-	const FVector ZAxis(0, 0, 1);
-	const FVector YAxis(0, 1, 0);
-
-	const FQuat FaceOrientations[] = {
-										{ZAxis, PI / 2}, { ZAxis, -PI / 2},// right, left
-										{YAxis, -PI / 2}, { YAxis, PI / 2},   // top, bottom
-										{ZAxis, 0}, { ZAxis, -PI},// front, back
-	};
+	const EPixelFormat PixelFormat = GetCapturePixelFormat(OutputFormat);
+	if (CaptureComponents.Num() == NumCubeFaces && CaptureComponents[0]->TextureTarget
+		&& CaptureComponents[0]->TextureTarget->SizeX == CaptureBoxSideRes && CaptureComponents[0]->TextureTarget->GetFormat() == PixelFormat)
+	{
+		return;
+	}
 
-	for (int i = 0; i < 6; ++i)
+	for (USceneCaptureComponent2D* CaptureComponent : CaptureComponents)
 	{
-		USceneCaptureComponent2D* CaptureComponent = NewObject<USceneCaptureComponent2D>();
-		CaptureComponent->SetVisibility(true);
-		CaptureComponent->SetHiddenInGame(false);
+		CaptureComponent->DestroyComponent();
+	}
+	CaptureComponents.SetNum(0);
 
-		//Different from 4.27,not have this property
-		//CaptureComponent->CaptureStereoPass = EStereoscopicPass::eSSP_FULL;//LEFT_EYE; //??
+	for (int32 Face = 0; Face < NumCubeFaces; ++Face)
+	{
+		USceneCaptureComponent2D* CaptureComponent = NewObject<USceneCaptureComponent2D>(this, NAME_None, RF_Transient);
 		CaptureComponent->FOVAngle = 90.f;
-		CaptureComponent->bCaptureEveryFrame = true;
-		CaptureComponent->CaptureSource = ESceneCaptureSource::SCS_FinalColorLDR;
+		// Captured on request only, see SaveCubeMap_PICO
+		CaptureComponent->bCaptureEveryFrame = false;
+		CaptureComponent->bCaptureOnMovement = false;
+		CaptureComponent->CaptureSource = OutputFormat == EPXRCubemapFormat::EXR ? ESceneCaptureSource::SCS_SceneColorHDR : ESceneCaptureSource::SCS_FinalColorLDR;
 
 		const FName TargetName = MakeUniqueObjectName(this, UTextureRenderTarget2D::StaticClass(), TEXT("SceneCaptureTextureTarget"));
-		CaptureComponent->TextureTarget = NewObject<UTextureRenderTarget2D>(this, TargetName);
-		CaptureComponent->TextureTarget->InitCustomFormat(CaptureBoxSideRes, CaptureBoxSideRes, CaptureFormat, false);
+		CaptureComponent->TextureTarget = NewObject<UTextureRenderTarget2D>(this, TargetName, RF_Transient);
+		CaptureComponent->TextureTarget->InitCustomFormat(CaptureBoxSideRes, CaptureBoxSideRes, PixelFormat, OutputFormat == EPXRCubemapFormat::EXR);
 
+		CaptureComponent->RegisterComponentWithWorld(GetWorld());
 		CaptureComponents.Add(CaptureComponent);
+	}
+}
 
-		CaptureComponent->RegisterComponentWithWorld(GWorld);
-
-		CaptureComponent->SetWorldLocationAndRotation(Location, Orientation * FaceOrientations[i]);
-
-		CaptureComponent->UpdateContent();
+bool APXR_Cubemap::SaveCubeMap_PICO()
+{
+	if (bCapturing || !GetWorld())
+	{
+		return false;
 	}
 
-	FActorSpawnParameters SpawnInfo;
-	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
-	SpawnInfo.bNoFail = true;
-	SpawnInfo.ObjectFlags = RF_Transient;
-	AStaticMeshActor* InGameActor;
-	InGameActor = GetWorld()->SpawnActor<AStaticMeshActor>(SpawnInfo);
+	Location = GetRootComponent() ? GetRootComponent()->GetComponentLocation() : GetActorLocation();
+	Orientation = GetRootComponent() ? GetRootComponent()->GetComponentQuat() : GetActorQuat();
+
+	CreateCaptureComponents();
 
 	OutputDir = FPaths::ProjectSavedDir() + TEXT("/Cubemaps");
 	IFileManager::Get().MakeDirectory(*OutputDir);
 
-	auto CopyRT2D = [=]()
+	TSharedPtr<FPXRCubemapJob, ESPMode::ThreadSafe> Job = MakeShared<FPXRCubemapJob, ESPMode::ThreadSafe>();
+	Job->Resolution = CaptureBoxSideRes;
+	Job->Layout = OutputLayout;
+	Job->Format = OutputFormat;
+	Job->BytesPerPixel = GPixelFormats[GetCapturePixelFormat(OutputFormat)].BlockBytes;
+	Job->Filename = OutputDir + FString::Printf(TEXT("/%s-%d-%s.%s"), OutputLayout == EPXRCubemapLayout::Equirect ? TEXT("Equirect") : TEXT("Cubemap"),
+		CaptureBoxSideRes, *FDateTime::Now().ToString(TEXT("%m.%d-%H.%M.%S")), OutputFormat == EPXRCubemapFormat::EXR ? TEXT("exr") : TEXT("png"));
+
+	// The captures are queued on the render thread right away, the readbacks are queued behind them
+	FTextureRenderTargetResource* Targets[NumCubeFaces];
+	for (int32 Face = 0; Face < NumCubeFaces; ++Face)
 	{
-		IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+		CaptureComponents[Face]->SetWorldLocationAndRotation(Location, Orientation * FaceOrientations[Face]);
+		CaptureComponents[Face]->CaptureScene();
+		Targets[Face] = CaptureComponents[Face]->TextureTarget->GameThread_GetRenderTargetResource();
+		Job->Readbacks[Face] = MakeUnique<FRHIGPUTextureReadback>(TEXT("PXRCubemapFace"));
+	}
+
+	ENQUEUE_RENDER_COMMAND(PXRCubemapReadback)([Job, Targets](FRHICommandListImmediate& RHICmdList)
+	{
+		for (int32 Face = 0; Face < NumCubeFaces; ++Face)
+		{
+			Job->Readbacks[Face]->EnqueueCopy(RHICmdList, Targets[Face]->GetRenderTargetTexture());
+		}
+	});
 
-		TArray<FColor> OneFaceSurface, WholeCubemapData;
-		OneFaceSurface.AddUninitialized(CaptureBoxSideRes * CaptureBoxSideRes);
-		WholeCubemapData.AddUninitialized(CaptureBoxSideRes * 6 * CaptureBoxSideRes);
+	CurrentJob = Job;
+	bCapturing = true;
+	PollHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &APXR_Cubemap::PollReadback));
+	return true;
+}
+
+bool APXR_Cubemap::PollReadback(float DeltaTime)
+{
+	TSharedPtr<FPXRCubemapJob, ESPMode::ThreadSafe> Job = CurrentJob;
+	if (!Job.IsValid())
+	{
+		PollHandle.Reset();
+		return false;
+	}
 
-		for (int cubeFaceIdx = 0; cubeFaceIdx < 6; ++cubeFaceIdx)
+	if (!Job->bFacesReady)
+	{
+		if (!Job->bPollQueued.exchange(true))
 		{
-			auto RenderTarget = CaptureComponents[cubeFaceIdx]->TextureTarget->GameThread_GetRenderTargetResource();
-			RenderTarget->ReadPixelsPtr(OneFaceSurface.GetData(), FReadSurfaceDataFlags());
+			ENQUEUE_RENDER_COMMAND(PXRCubemapPoll)([Job](FRHICommandListImmediate& RHICmdList)
+			{
+				Job->Poll_RenderThread();
+				Job->bPollQueued = false;
+			});
+		}
+		return true;
+	}
 
-			for (FColor& Color : OneFaceSurface)
+	// Lay out, compress and write off the game thread
+	CurrentJob.Reset();
+	PollHandle.Reset();
+	FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	TWeakObjectPtr<APXR_Cubemap> WeakThis(this);
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [Job, WeakThis]()
+	{
+		const bool bSaved = Job->Save();
+		const FString Filename = Job->Filename;
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, bSaved, Filename]()
+		{
+			if (bSaved)
 			{
-				Color.A = 255;
+				PXR_LOGI(PxrUnreal, "Cubemap saved to %s", PLATFORM_CHAR(*Filename));
 			}
-
-			const uint32 Stride = CaptureBoxSideRes * 6;
-			const uint32 XOff = cubeFaceIdx * CaptureBoxSideRes;
-			const uint32 StripSizeInBytes = CaptureBoxSideRes * sizeof(FColor);
-			for (uint32 y = 0; y < CaptureBoxSideRes; ++y)
+			else
 			{
-				FMemory::Memcpy(WholeCubemapData.GetData() + XOff + y * Stride, OneFaceSurface.GetData() + y * CaptureBoxSideRes, StripSizeInBytes);
+				PXR_LOGE(PxrUnreal, "Cubemap could not be saved to %s", PLATFORM_CHAR(*Filename));
 			}
-		}
+			if (APXR_Cubemap* This = WeakThis.Get())
+			{
+				This->isCatchImageWP = bSaved;
+				This->bCapturing = false;
+				This->OnCubemapSaved.Broadcast(bSaved, Filename);
+			}
+		});
+	});
+	return false;
+}
 
-		ImageWrapper->SetRaw(WholeCubemapData.GetData(), WholeCubemapData.GetAllocatedSize(), CaptureBoxSideRes * 6, CaptureBoxSideRes, ERGBFormat::BGRA, 8);
-		const TArray64<uint8>& PNGData = ImageWrapper->GetCompressed(100);
-		const FString Filename = OutputDir + FString::Printf(TEXT("/Cubemap-%d-%s.png"), CaptureBoxSideRes, *FDateTime::Now().ToString(TEXT("%m.%d-%H.%M.%S")));
+void APXR_Cubemap::PXR_CubemapHandler()
+{
+#if !UE_BUILD_SHIPPING
+	SaveCubeMap_PICO();
+#endif
+}
 
-		isCatchImageWP = FFileHelper::SaveArrayToFile(PNGData, *Filename);
+#if !UE_BUILD_SHIPPING
+static void CaptureCubemapsCommand(const TArray<FString>& Args, UWorld* World)
+{
+	if (!World)
+	{
+		return;
+	}
 
-		for (int i = 0; i < CaptureComponents.Num(); ++i)
+	uint32 Resolution = 1024;
+	EPXRCubemapFormat Format = EPXRCubemapFormat::PNG;
+	EPXRCubemapLayout Layout = EPXRCubemapLayout::Strip;
+	bool bQuit = false;
+	for (const FString& Arg : Args)
+	{
+		if (Arg.IsNumeric())
+		{
+			Resolution = FMath::Clamp(FCString::Atoi(*Arg), 16, 8192);
+		}
+		else if (Arg.Equals(TEXT("exr"), ESearchCase::IgnoreCase))
+		{
+			Format = EPXRCubemapFormat::EXR;
+		}
+		else if (Arg.Equals(TEXT("equirect"), ESearchCase::IgnoreCase))
+		{
+			Layout = EPXRCubemapLayout::Equirect;
+		}
+		else if (Arg.Equals(TEXT("quit"), ESearchCase::IgnoreCase))
 		{
-			CaptureComponents[i]->UnregisterComponent();
+			bQuit = true;
 		}
-		CaptureComponents.SetNum(0);
+	}
 
-	};
+	TArray<APXR_Cubemap*> Captures;
+	for (TActorIterator<APXR_Cubemap> It(World); It; ++It)
+	{
+		Captures.Add(*It);
+	}
 
-	FTimerHandle TimerHandle;
-	GetWorld()->GetTimerManager().SetTimer(TimerHandle, CopyRT2D, 0.001f, false, 0);
+	// Without placed actors, capture from the player camera with a temporary one
+	TWeakObjectPtr<APXR_Cubemap> Temporary;
+	if (Captures.Num() == 0)
+	{
+		APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(World, 0);
+		FActorSpawnParameters SpawnInfo;
+		SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnInfo.ObjectFlags = RF_Transient;
+		const FVector SpawnLocation = CameraManager ? CameraManager->GetCameraLocation() : FVector::ZeroVector;
+		APXR_Cubemap* Actor = World->SpawnActor<APXR_Cubemap>(SpawnLocation, FRotator::ZeroRotator, SpawnInfo);
+		if (Actor)
+		{
+			USceneComponent* Root = NewObject<USceneComponent>(Actor);
+			Actor->SetRootComponent(Root);
+			Root->RegisterComponent();
+			Root->SetWorldLocation(SpawnLocation);
+			Captures.Add(Actor);
+			Temporary = Actor;
+		}
+	}
 
-	return isCatchImageWP;
-}
+	TSharedRef<int32> Remaining = MakeShared<int32>(0);
+	for (APXR_Cubemap* Capture : Captures)
+	{
+		Capture->CaptureBoxSideRes = Resolution;
+		Capture->OutputFormat = Format;
+		Capture->OutputLayout = Layout;
+		// Each capture listens for its own save only, so repeated runs do not pile up handlers on placed actors
+		TSharedRef<FDelegateHandle> Handle = MakeShared<FDelegateHandle>();
+		TWeakObjectPtr<APXR_Cubemap> WeakCapture(Capture);
+		*Handle = Capture->OnCubemapSaved.AddLambda([Remaining, bQuit, Temporary, WeakCapture, Handle](bool bSuccess, const FString& Filename)
+		{
+			if (APXR_Cubemap* Saved = WeakCapture.Get())
+			{
+				Saved->OnCubemapSaved.Remove(*Handle);
+			}
+			if (--(*Remaining) == 0)
+			{
+				if (Temporary.IsValid())
+				{
+					Temporary->Destroy();
+				}
+				if (bQuit)
+				{
+					FPlatformMisc::RequestExit(false);
+				}
+			}
+		});
+		if (Capture->SaveCubeMap_PICO())
+		{
+			++(*Remaining);
+		}
+		else
+		{
+			Capture->OnCubemapSaved.Remove(*Handle);
+		}
+	}
+	PXR_LOGI(PxrUnreal, "PICO.CaptureCubemaps started %d captures", *Remaining);
 
-void APXR_Cubemap::PXR_CubemapHandler()
-{
-#if !UE_BUILD_SHIPPING
-	SaveCubeMap_PICO();
-#endif
+	if (*Remaining == 0 && bQuit)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
 }
 
+static FAutoConsoleCommandWithWorldAndArgs CPICOCaptureCubemaps(
+	TEXT("PICO.CaptureCubemaps"),
+	TEXT("Saves a cubemap from every PXR_Cubemap actor in the level, or from the player camera if there is none, to Saved/Cubemaps.\n")
+	TEXT("Usage: PICO.CaptureCubemaps [Resolution] [png|exr] [strip|equirect] [quit]\n")
+	TEXT("Batch job: run the game with -RenderOffscreen -ExecCmds=\"PICO.CaptureCubemaps 2048 exr equirect quit\""),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&CaptureCubemapsCommand));
+#endif
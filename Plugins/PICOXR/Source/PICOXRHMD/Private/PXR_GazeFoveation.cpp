@@ -0,0 +1,516 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+
+#include "PXR_GazeFoveation.h"
+#include "PXR_HMDModule.h"
+#include "PXR_Log.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderingThread.h"
+#include "RHICommandList.h"
+
+static TAutoConsoleVariable<int32> CVarPICOFoveationEyeTracked(
+	TEXT("PICO.Foveation.EyeTracked"),
+	0,
+	TEXT("0: Fixed foveation from the runtime (Default)\n")
+	TEXT("1: Move the full rate region with the gaze, needs eye tracking and a foveation level\n"),
+	ECVF_Default);
+
+namespace
+{
+	// Below this the lid covers too much of the pupil to trust the gaze
+	const float MinOpenness = 0.3f;
+	// UV per second, roughly 180 deg/s on a 90 deg eye frustum
+	const float SaccadeSpeed = 2.0f;
+	// Seconds the region stays widened after a saccade, covers tracker and pipeline lag
+	const double SaccadeHold = 0.05;
+	const float SaccadeRadiusScale = 1.5f;
+	const double FixationTimeConstant = 0.03;
+	const double ConfidenceRiseTime = 0.05;
+	const double ConfidenceFallTime = 0.2;
+
+	float GetDistance(const FVector2f& UV, const FVector2f& Center, float Aspect)
+	{
+		return FMath::Sqrt(FMath::Square((UV.X - Center.X) * Aspect) + FMath::Square(UV.Y - Center.Y));
+	}
+}
+
+bool FPXRFoveationFrame::NearlyEquals(const FPXRFoveationFrame& Other, float Tolerance) const
+{
+	return Center[0].Equals(Other.Center[0], Tolerance) && Center[1].Equals(Other.Center[1], Tolerance)
+		&& FMath::IsNearlyEqual(RadiusScale, Other.RadiusScale, 0.01f);
+}
+
+// The runtime does not expose the density maps behind its levels. These are hand tuned to look alike on the device,
+// full rate in the middle and coarser towards the edge the higher the level, not values read back from the runtime.
+FPXRFoveationShape FPXRFoveationShape::FromLevel(PxrFoveationLevel Level)
+{
+	FPXRFoveationShape Shape;
+	switch (Level)
+	{
+	case PxrFoveationLevel::PXR_FOVEATION_LEVEL_LOW:
+		Shape.Radius = 0.30f; Shape.Falloff = 2.0f; Shape.MinDensity = 0.5f;
+		break;
+	case PxrFoveationLevel::PXR_FOVEATION_LEVEL_MID:
+		Shape.Radius = 0.25f; Shape.Falloff = 3.0f; Shape.MinDensity = 0.25f;
+		break;
+	case PxrFoveationLevel::PXR_FOVEATION_LEVEL_HIGH:
+		Shape.Radius = 0.20f; Shape.Falloff = 4.0f; Shape.MinDensity = 0.25f;
+		break;
+	case PxrFoveationLevel::PXR_FOVEATION_LEVEL_TOP_HIGH:
+		Shape.Radius = 0.15f; Shape.Falloff = 5.0f; Shape.MinDensity = 0.125f;
+		break;
+	default:
+		Shape.Radius = 2.0f; Shape.Falloff = 0.0f; Shape.MinDensity = 1.0f;
+		break;
+	}
+	return Shape;
+}
+
+float FPXRFoveationShape::GetDensity(float Distance, float RadiusScale) const
+{
+	const float ScaledRadius = Radius * RadiusScale;
+	if (Distance <= ScaledRadius)
+	{
+		return 1.0f;
+	}
+	// Density maps are quantized to power of two rates by the hardware anyway
+	const float Density = FMath::Max(MinDensity, 1.0f - Falloff * (Distance - ScaledRadius));
+	return FMath::Max(MinDensity, FMath::Exp2(FMath::FloorToFloat(FMath::Log2(FMath::Max(Density, 1e-3f)))));
+}
+
+FPXRFoveationFrame FPXRGazeFoveationFilter::Update(const FPXRGazeSample& Sample, const FVector2f LensCenter[2])
+{
+	const double DeltaTime = LastTime > 0.0 ? FMath::Clamp(Sample.Time - LastTime, 0.0, 0.1) : 0.0;
+	LastTime = Sample.Time;
+
+	const bool bUsable = Sample.bValid && Sample.Openness >= MinOpenness;
+	if (bUsable)
+	{
+		const float Speed = (bHasGaze && DeltaTime > 0.0) ? FVector2f::Distance(Sample.Gaze[0], LastGaze[0]) / DeltaTime : 0.0f;
+		if (!bHasGaze || Speed > SaccadeSpeed)
+		{
+			if (bHasGaze)
+			{
+				SaccadeEndTime = Sample.Time + SaccadeHold;
+			}
+			Smoothed[0] = Sample.Gaze[0];
+			Smoothed[1] = Sample.Gaze[1];
+		}
+		else
+		{
+			const float Alpha = 1.0f - FMath::Exp(-DeltaTime / FixationTimeConstant);
+			Smoothed[0] = FMath::Lerp(Smoothed[0], Sample.Gaze[0], Alpha);
+			Smoothed[1] = FMath::Lerp(Smoothed[1], Sample.Gaze[1], Alpha);
+		}
+		LastGaze[0] = Sample.Gaze[0];
+		LastGaze[1] = Sample.Gaze[1];
+		bHasGaze = true;
+		Confidence = FMath::Min(1.0f, Confidence + float(DeltaTime / ConfidenceRiseTime));
+	}
+	else
+	{
+		Confidence = FMath::Max(0.0f, Confidence - float(DeltaTime / ConfidenceFallTime));
+		if (Confidence <= 0.0f)
+		{
+			bHasGaze = false;
+		}
+	}
+
+	FPXRFoveationFrame Frame;
+	Frame.Confidence = Confidence;
+	Frame.RadiusScale = Sample.Time < SaccadeEndTime ? SaccadeRadiusScale : 1.0f;
+	for (int32 Eye = 0; Eye < 2; Eye++)
+	{
+		Frame.Center[Eye] = bHasGaze ? FMath::Lerp(LensCenter[Eye], Smoothed[Eye], Confidence) : LensCenter[Eye];
+	}
+	return Frame;
+}
+
+void FPXRGazeFoveationFilter::Reset()
+{
+	*this = FPXRGazeFoveationFilter();
+}
+
+bool FPICOXRGazeFoveation::IsEnabled()
+{
+	return CVarPICOFoveationEyeTracked.GetValueOnAnyThread() != 0;
+}
+
+FVector2f FPICOXRGazeFoveation::GetFrustumUV(const FVector3f& Direction, const FVector4f& Tangents)
+{
+	if (Direction.Z >= -KINDA_SMALL_NUMBER)
+	{
+		return FVector2f(0.5f, 0.5f);
+	}
+	const float TanX = Direction.X / -Direction.Z;
+	const float TanY = Direction.Y / -Direction.Z;
+	// V grows downwards
+	return FVector2f(
+		FMath::Clamp((TanX - Tangents.X) / (Tangents.Y - Tangents.X), 0.0f, 1.0f),
+		FMath::Clamp((Tangents.Z - TanY) / (Tangents.Z - Tangents.W), 0.0f, 1.0f));
+}
+
+void FPICOXRGazeFoveation::SampleGaze(double PredictedDisplayTimeMs, const FVector4f EyeTangents[2], FPXRGazeSample& Sample, FVector2f LensCenter[2])
+{
+	Sample.Time = PredictedDisplayTimeMs / 1000.0;
+	for (int32 Eye = 0; Eye < 2; Eye++)
+	{
+		LensCenter[Eye] = GetFrustumUV(FVector3f(0.0f, 0.0f, -1.0f), EyeTangents[Eye]);
+	}
+
+#if PLATFORM_ANDROID
+	PxrEyeTrackingDataGetInfo GetInfo;
+	FMemory::Memzero(&GetInfo, sizeof(GetInfo));
+	GetInfo.apiVersion = PXR_EYE_TRACKING_API_VERSION;
+	GetInfo.displayTime = int64(PredictedDisplayTimeMs * 1000000.0);
+	GetInfo.flags = PXR_EYE_ORIENTATION;
+
+	PxrEyeTrackingData1 Data;
+	FMemory::Memzero(&Data, sizeof(Data));
+	Data.apiVersion = PXR_EYE_TRACKING_API_VERSION;
+	if (PXRP_SUCCESS(FPICOXRHMDModule::GetPluginWrapper().GetEyeTrackingData1(&GetInfo, &Data)))
+	{
+		Sample.bValid = true;
+		Sample.Openness = 1.0f;
+		for (int32 Eye = 0; Eye < 2; Eye++)
+		{
+			const PxrPerEyeData& EyeData = Data.eyeDatas[Eye];
+			const PxrQuaternionf& Orientation = EyeData.pose.orientation;
+			// Head relative, in runtime space
+			const FVector3f Direction = FQuat4f(Orientation.x, Orientation.y, Orientation.z, Orientation.w).RotateVector(FVector3f(0.0f, 0.0f, -1.0f));
+			Sample.Gaze[Eye] = GetFrustumUV(Direction, EyeTangents[Eye]);
+			Sample.bValid &= EyeData.isPoseValid;
+			if (EyeData.isOpennessValid)
+			{
+				Sample.Openness = FMath::Min(Sample.Openness, EyeData.openness);
+			}
+		}
+	}
+#endif
+
+	if (Recording.IsValid())
+	{
+		const FString Line = FString::Printf(TEXT("%.6f,%d,%.3f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f\n"), Sample.Time, Sample.bValid ? 1 : 0, Sample.Openness,
+			Sample.Gaze[0].X, Sample.Gaze[0].Y, Sample.Gaze[1].X, Sample.Gaze[1].Y, LensCenter[0].X, LensCenter[0].Y, LensCenter[1].X, LensCenter[1].Y);
+		const FTCHARToUTF8 Utf8(*Line);
+		Recording->Serialize(const_cast<ANSICHAR*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+void FPICOXRGazeFoveation::Update_GameThread(double PredictedDisplayTimeMs, const FVector4f EyeTangents[2], PxrFoveationLevel Level)
+{
+	check(IsInGameThread());
+
+	FVector2f LensCenter[2];
+	FPXRGazeSample Sample;
+	SampleGaze(PredictedDisplayTimeMs, EyeTangents, Sample, LensCenter);
+
+	const FPXRFoveationFrame Frame = Filter.Update(Sample, LensCenter);
+	const FPXRFoveationShape Shape = FPXRFoveationShape::FromLevel(Level);
+	bActive_GameThread = true;
+	ENQUEUE_RENDER_COMMAND(PICOGazeFoveation)([this, Frame, Shape](FRHICommandListImmediate& RHICmdList)
+	{
+		Frame_RenderThread = Frame;
+		Shape_RenderThread = Shape;
+		bActive_RenderThread = true;
+	});
+}
+
+void FPICOXRGazeFoveation::Record_GameThread(double PredictedDisplayTimeMs, const FVector4f EyeTangents[2])
+{
+	check(IsInGameThread());
+	if (!Recording.IsValid())
+	{
+		return;
+	}
+
+	// Same trace as with the mode on, so a fixed foveation session can be replayed against the gaze filter
+	FVector2f LensCenter[2];
+	FPXRGazeSample Sample;
+	SampleGaze(PredictedDisplayTimeMs, EyeTangents, Sample, LensCenter);
+}
+
+void FPICOXRGazeFoveation::Disable_GameThread()
+{
+	check(IsInGameThread());
+	if (!bActive_GameThread)
+	{
+		return;
+	}
+
+	// Start from the lens center again when it comes back
+	bActive_GameThread = false;
+	Filter.Reset();
+	ENQUEUE_RENDER_COMMAND(PICOGazeFoveationDisable)([this](FRHICommandListImmediate& RHICmdList)
+	{
+		bActive_RenderThread = false;
+	});
+}
+
+bool FPICOXRGazeFoveation::IsActive_RenderThread() const
+{
+	return IsEnabled() && bActive_RenderThread;
+}
+
+bool FPICOXRGazeFoveation::NeedsReallocate_RenderThread() const
+{
+	check(IsInRenderingThread());
+	return bAllocatedWhileEnabled != IsActive_RenderThread();
+}
+
+bool FPICOXRGazeFoveation::AllocateTexture_RenderThread(FRHITexture* RuntimeTexture, FTexture2DRHIRef& OutTexture)
+{
+	check(IsInRenderingThread());
+	Release_RenderThread();
+	bAllocatedWhileEnabled = IsActive_RenderThread();
+	if (!bAllocatedWhileEnabled || !RuntimeTexture)
+	{
+		return false;
+	}
+
+	// Two channel fragment density maps only, anything else stays with the runtime's fixed map
+	const FRHITextureDesc& RuntimeDesc = RuntimeTexture->GetDesc();
+	if (RuntimeDesc.Format != PF_R8G8)
+	{
+		PXR_LOGW(PxrUnreal, "Eye tracked foveation needs an R8G8 density map, runtime uses format %d, keeping fixed foveation", (int32)RuntimeDesc.Format);
+		return false;
+	}
+
+	const bool bArray = RuntimeDesc.IsTextureArray();
+	const ETextureCreateFlags Flags = ETextureCreateFlags::Foveation | ETextureCreateFlags::ShaderResource;
+	const FRHITextureCreateDesc Desc = (bArray
+		? FRHITextureCreateDesc::Create2DArray(TEXT("PICOGazeFoveation"), RuntimeDesc.Extent, RuntimeDesc.ArraySize, RuntimeDesc.Format)
+		: FRHITextureCreateDesc::Create2D(TEXT("PICOGazeFoveation"), RuntimeDesc.Extent, RuntimeDesc.Format))
+		.SetFlags(Flags)
+		.SetInitialState(ERHIAccess::ShadingRateSource);
+	Texture = RHICreateTexture(Desc);
+
+	// Array slices are written through a staging texture each, UpdateTexture2D only reaches the first slice
+	if (bArray)
+	{
+		for (int32 Slice = 0; Slice < RuntimeDesc.ArraySize; Slice++)
+		{
+			StagingSlices.Add(RHICreateTexture(FRHITextureCreateDesc::Create2D(TEXT("PICOGazeFoveationStaging"), RuntimeDesc.Extent, RuntimeDesc.Format)
+				.SetFlags(ETextureCreateFlags::ShaderResource)
+				.SetInitialState(ERHIAccess::CopySrc)));
+		}
+	}
+	Texels.SetNumUninitialized(RuntimeDesc.Extent.X * RuntimeDesc.Extent.Y * 2);
+	PXR_LOGI(PxrUnreal, "Eye tracked foveation allocated %d x %d x %d density map", RuntimeDesc.Extent.X, RuntimeDesc.Extent.Y, (int32)RuntimeDesc.ArraySize);
+
+	OutTexture = Texture;
+	return true;
+}
+
+void FPICOXRGazeFoveation::FillDensityMap(FIntPoint Size, const FVector2f& Center, float RadiusScale, const FPXRFoveationShape& Shape, uint8* OutTexels)
+{
+	const float Aspect = float(Size.X) / FMath::Max(Size.Y, 1);
+	for (int32 Y = 0; Y < Size.Y; Y++)
+	{
+		for (int32 X = 0; X < Size.X; X++)
+		{
+			const FVector2f UV((X + 0.5f) / Size.X, (Y + 0.5f) / Size.Y);
+			const uint8 Value = (uint8)FMath::RoundToInt(Shape.GetDensity(GetDistance(UV, Center, Aspect), RadiusScale) * 255.0f);
+			// Horizontal and vertical density
+			OutTexels[(Y * Size.X + X) * 2 + 0] = Value;
+			OutTexels[(Y * Size.X + X) * 2 + 1] = Value;
+		}
+	}
+}
+
+void FPICOXRGazeFoveation::UpdateTexture_RenderThread(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+	if (!Texture.IsValid())
+	{
+		return;
+	}
+
+	// Until the renderer reallocates, a disabled map stays uniform instead of keeping the last gaze
+	const FPXRFoveationShape Shape = IsActive_RenderThread() ? Shape_RenderThread : FPXRFoveationShape::FromLevel(PxrFoveationLevel::PXR_FOVEATION_LEVEL_NONE);
+	const bool bShapeChanged = Shape.Radius != UploadedShape.Radius || Shape.Falloff != UploadedShape.Falloff || Shape.MinDensity != UploadedShape.MinDensity;
+	const FIntPoint Size = Texture->GetSizeXY();
+	const float Tolerance = 0.5f / FMath::Max(1, FMath::Min(Size.X, Size.Y));
+	if (bUploaded && !bShapeChanged && Frame_RenderThread.NearlyEquals(UploadedFrame, Tolerance))
+	{
+		return;
+	}
+
+	const FUpdateTextureRegion2D Region(0, 0, 0, 0, Size.X, Size.Y);
+	if (StagingSlices.Num() == 0)
+	{
+		// Single texture shared by both eyes, follow the left one
+		FillDensityMap(Size, Frame_RenderThread.Center[0], Frame_RenderThread.RadiusScale, Shape, Texels.GetData());
+		RHICmdList.Transition(FRHITransitionInfo(Texture, ERHIAccess::Unknown, ERHIAccess::CopyDest));
+		RHICmdList.UpdateTexture2D(Texture, 0, Region, Size.X * 2, Texels.GetData());
+	}
+	else
+	{
+		RHICmdList.Transition(FRHITransitionInfo(Texture, ERHIAccess::Unknown, ERHIAccess::CopyDest));
+		for (int32 Slice = 0; Slice < StagingSlices.Num(); Slice++)
+		{
+			FRHITexture* Staging = StagingSlices[Slice];
+			FillDensityMap(Size, Frame_RenderThread.Center[FMath::Min(Slice, 1)], Frame_RenderThread.RadiusScale, Shape, Texels.GetData());
+			RHICmdList.Transition(FRHITransitionInfo(Staging, ERHIAccess::Unknown, ERHIAccess::CopyDest));
+			RHICmdList.UpdateTexture2D(Staging, 0, Region, Size.X * 2, Texels.GetData());
+			RHICmdList.Transition(FRHITransitionInfo(Staging, ERHIAccess::CopyDest, ERHIAccess::CopySrc));
+
+			FRHICopyTextureInfo CopyInfo;
+			CopyInfo.Size = FIntVector(Size.X, Size.Y, 1);
+			CopyInfo.DestSliceIndex = Slice;
+			RHICmdList.CopyTexture(Staging, Texture, CopyInfo);
+		}
+	}
+	RHICmdList.Transition(FRHITransitionInfo(Texture, ERHIAccess::CopyDest, ERHIAccess::ShadingRateSource));
+
+	UploadedFrame = Frame_RenderThread;
+	UploadedShape = Shape;
+	bUploaded = true;
+}
+
+void FPICOXRGazeFoveation::Release_RenderThread()
+{
+	Texture.SafeRelease();
+	StagingSlices.Empty();
+	bUploaded = false;
+}
+
+void FPICOXRGazeFoveation::SetRecording(const FString& Filename)
+{
+	check(IsInGameThread());
+	Recording.Reset();
+	if (Filename.IsEmpty())
+	{
+		return;
+	}
+
+	const FString Path = FPaths::IsRelative(Filename) ? FPaths::Combine(FPaths::ProjectSavedDir(), Filename) : Filename;
+	Recording.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!Recording.IsValid())
+	{
+		PXR_LOGW(PxrUnreal, "Eye tracked foveation could not record to %s", PLATFORM_CHAR(*Path));
+		return;
+	}
+	const ANSICHAR Header[] = "Time,Valid,Openness,LeftU,LeftV,RightU,RightV,LeftLensU,LeftLensV,RightLensU,RightLensV\n";
+	Recording->Serialize(const_cast<ANSICHAR*>(Header), sizeof(Header) - 1);
+	PXR_LOGI(PxrUnreal, "Eye tracked foveation recording gaze to %s", PLATFORM_CHAR(*Path));
+}
+
+namespace
+{
+	struct FFoveationCost
+	{
+		double FullRate = 0.0;
+		double Shaded = 0.0;
+		int64 Misses = 0;
+	};
+
+	/** Accounts one frame of one eye: texels at full rate, shading work relative to full rate, and whether the gaze fell outside. */
+	void AccountFrame(FIntPoint Size, const FVector2f& Center, float RadiusScale, const FPXRFoveationShape& Shape, const FVector2f* Gaze, FFoveationCost& Cost)
+	{
+		const float Aspect = float(Size.X) / Size.Y;
+		int32 FullRate = 0;
+		double Shaded = 0.0;
+		for (int32 Y = 0; Y < Size.Y; Y++)
+		{
+			for (int32 X = 0; X < Size.X; X++)
+			{
+				const float Density = Shape.GetDensity(GetDistance(FVector2f((X + 0.5f) / Size.X, (Y + 0.5f) / Size.Y), Center, Aspect), RadiusScale);
+				FullRate += Density >= 1.0f ? 1 : 0;
+				Shaded += Density * Density;
+			}
+		}
+		const double Texels = double(Size.X) * Size.Y;
+		Cost.FullRate += FullRate / Texels;
+		Cost.Shaded += Shaded / Texels;
+		if (Gaze && Shape.GetDensity(GetDistance(*Gaze, Center, Aspect), RadiusScale) < 1.0f)
+		{
+			Cost.Misses++;
+		}
+	}
+
+	void EvaluateTrace(const TArray<FString>& Args, FOutputDevice& Ar)
+	{
+		if (Args.Num() < 1)
+		{
+			Ar.Log(TEXT("Usage: PICO.Foveation.EvaluateTrace <File.csv> [Level=2] [Width=64] [Height=64]"));
+			return;
+		}
+		const FString Path = FPaths::IsRelative(Args[0]) ? FPaths::Combine(FPaths::ProjectSavedDir(), Args[0]) : Args[0];
+		const PxrFoveationLevel Level = (PxrFoveationLevel)FMath::Clamp(Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 2, 0, 3);
+		const FIntPoint Size(Args.Num() > 2 ? FMath::Clamp(FCString::Atoi(*Args[2]), 4, 512) : 64, Args.Num() > 3 ? FMath::Clamp(FCString::Atoi(*Args[3]), 4, 512) : 64);
+
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+		{
+			Ar.Logf(TEXT("Could not read %s"), *Path);
+			return;
+		}
+
+		const FPXRFoveationShape Shape = FPXRFoveationShape::FromLevel(Level);
+		FPXRGazeFoveationFilter Filter;
+		FFoveationCost Fixed;
+		FFoveationCost Tracked;
+		int64 Frames = 0;
+		int64 GazeFrames = 0;
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Fields;
+			Line.ParseIntoArray(Fields, TEXT(","));
+			if (Fields.Num() < 11 || !FCString::IsNumeric(*Fields[0]))
+			{
+				continue;
+			}
+			FPXRGazeSample Sample;
+			Sample.Time = FCString::Atod(*Fields[0]);
+			Sample.bValid = FCString::Atoi(*Fields[1]) != 0;
+			Sample.Openness = FCString::Atof(*Fields[2]);
+			FVector2f LensCenter[2];
+			for (int32 Eye = 0; Eye < 2; Eye++)
+			{
+				Sample.Gaze[Eye] = FVector2f(FCString::Atof(*Fields[3 + Eye * 2]), FCString::Atof(*Fields[4 + Eye * 2]));
+				LensCenter[Eye] = FVector2f(FCString::Atof(*Fields[7 + Eye * 2]), FCString::Atof(*Fields[8 + Eye * 2]));
+			}
+
+			const FPXRFoveationFrame Frame = Filter.Update(Sample, LensCenter);
+			// Misses are only meaningful where the tracker saw the eye
+			const bool bHasGaze = Sample.bValid && Sample.Openness >= MinOpenness;
+			for (int32 Eye = 0; Eye < 2; Eye++)
+			{
+				const FVector2f* Gaze = bHasGaze ? &Sample.Gaze[Eye] : nullptr;
+				AccountFrame(Size, LensCenter[Eye], 1.0f, Shape, Gaze, Fixed);
+				AccountFrame(Size, Frame.Center[Eye], Frame.RadiusScale, Shape, Gaze, Tracked);
+			}
+			Frames++;
+			GazeFrames += bHasGaze ? 1 : 0;
+		}
+
+		if (Frames == 0)
+		{
+			Ar.Logf(TEXT("No samples in %s"), *Path);
+			return;
+		}
+		const double EyeFrames = Frames * 2.0;
+		const double GazeEyeFrames = FMath::Max<int64>(GazeFrames, 1) * 2.0;
+		Ar.Logf(TEXT("%lld frames, %lld with gaze, level %d, %d x %d density map"), Frames, GazeFrames, (int32)Level, Size.X, Size.Y);
+		Ar.Log(TEXT("Mode      FullRate  ShadedWork  GazeOutsideFullRate"));
+		Ar.Logf(TEXT("fixed     %7.1f%%  %9.1f%%  %18.1f%%"), Fixed.FullRate / EyeFrames * 100.0, Fixed.Shaded / EyeFrames * 100.0, Fixed.Misses / GazeEyeFrames * 100.0);
+		Ar.Logf(TEXT("tracked   %7.1f%%  %9.1f%%  %18.1f%%"), Tracked.FullRate / EyeFrames * 100.0, Tracked.Shaded / EyeFrames * 100.0, Tracked.Misses / GazeEyeFrames * 100.0);
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CPICOFoveationEvaluateTrace(
+	TEXT("PICO.Foveation.EvaluateTrace"),
+	TEXT("Replays a gaze trace recorded with PICO.Foveation.RecordGaze through the eye tracked foveation filter and compares it with fixed foveation:\n")
+	TEXT("share of texels at full rate, shading work relative to full rate, and how often the gaze fell outside the full rate region.\n")
+	TEXT("Both use the approximate shapes of FPXRFoveationShape::FromLevel, so compare the two rows rather than the absolute numbers.\n")
+	TEXT("Usage: PICO.Foveation.EvaluateTrace <File.csv> [Level=2] [Width=64] [Height=64]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld*, FOutputDevice& Ar)
+	{
+		EvaluateTrace(Args, Ar);
+	}));
@@ -0,0 +1,125 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+
+#pragma once
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include "PXR_PluginWrapper.h"
+
+/** One eye tracker reading, gaze in texture UV of each eye. */
+struct FPXRGazeSample
+{
+	/** Seconds, display time the gaze was predicted for. */
+	double Time = 0.0;
+	FVector2f Gaze[2] = { FVector2f(0.5f, 0.5f), FVector2f(0.5f, 0.5f) };
+	bool bValid = false;
+	float Openness = 1.0f;
+};
+
+/** Center and size of the full rate region of each eye for one frame. */
+struct FPXRFoveationFrame
+{
+	FVector2f Center[2] = { FVector2f(0.5f, 0.5f), FVector2f(0.5f, 0.5f) };
+	float RadiusScale = 1.0f;
+	/** 0 while showing fixed foveation, 1 while fully following the gaze. */
+	float Confidence = 0.0f;
+
+	bool NearlyEquals(const FPXRFoveationFrame& Other, float Tolerance) const;
+};
+
+/** Density falloff around the center, in UV of the eye texture. */
+struct FPXRFoveationShape
+{
+	float Radius = 0.25f;
+	/** Density lost per UV outside the radius. */
+	float Falloff = 3.0f;
+	float MinDensity = 0.25f;
+
+	/** Approximation of the runtime's fixed foveation at Level, which it does not report. Uniform full rate for none. */
+	static FPXRFoveationShape FromLevel(PxrFoveationLevel Level);
+
+	/** Power of two fraction of full rate at Distance (aspect corrected UV) from the center. */
+	float GetDensity(float Distance, float RadiusScale) const;
+};
+
+/**
+ * Turns raw gaze into a foveation center.
+ *
+ * Fixations are smoothed so tracker noise does not move the full rate region every frame. Saccades snap to the new gaze
+ * and widen the region for a moment, since the tracker and the frame pipeline lag the eye. Without usable gaze the
+ * center eases back to the lens center, which matches the runtime's fixed foveation.
+ */
+class FPXRGazeFoveationFilter
+{
+public:
+	/** LensCenter is the UV the eye looks straight through, per eye. */
+	FPXRFoveationFrame Update(const FPXRGazeSample& Sample, const FVector2f LensCenter[2]);
+	void Reset();
+
+private:
+	double LastTime = 0.0;
+	bool bHasGaze = false;
+	FVector2f LastGaze[2];
+	FVector2f Smoothed[2];
+	float Confidence = 0.0f;
+	double SaccadeEndTime = 0.0;
+};
+
+/**
+ * Eye tracked foveation for the eye layer, enabled by PICO.Foveation.EyeTracked.
+ *
+ * The runtime only takes fixed foveation levels, so when enabled the HMD hands the renderer a density map of its own,
+ * sized and formatted like the runtime's, and moves the full rate region with the gaze every frame.
+ */
+class FPICOXRGazeFoveation
+{
+public:
+	static bool IsEnabled();
+
+	/** UV where Direction (runtime space, -Z forward) crosses an eye frustum given as left, right, up and down tangents. */
+	static FVector2f GetFrustumUV(const FVector3f& Direction, const FVector4f& Tangents);
+
+	/** Samples the gaze for the frame about to render and passes the result to the render thread. */
+	void Update_GameThread(double PredictedDisplayTimeMs, const FVector4f EyeTangents[2], PxrFoveationLevel Level);
+	/** Called instead of Update_GameThread while the mode is off or the foveation level is none. */
+	void Disable_GameThread();
+	/** Only records the gaze while a recording runs, for frames that do not call Update_GameThread. */
+	void Record_GameThread(double PredictedDisplayTimeMs, const FVector4f EyeTangents[2]);
+
+	/** True when the mode was toggled since the shading rate texture was allocated. */
+	bool NeedsReallocate_RenderThread() const;
+	/** Creates a density map like RuntimeTexture and returns it in OutTexture, false to keep the runtime's. */
+	bool AllocateTexture_RenderThread(FRHITexture* RuntimeTexture, FTexture2DRHIRef& OutTexture);
+	/** Rewrites the density map when the center or the level changed, uniform full rate while disabled. */
+	void UpdateTexture_RenderThread(FRHICommandListImmediate& RHICmdList);
+	void Release_RenderThread();
+
+	/** Writes every raw gaze sample to a csv trace for PICO.Foveation.EvaluateTrace, empty Filename stops. Records with the mode on or off. */
+	void SetRecording(const FString& Filename);
+
+	/** Fills one eye's texels of a density map of Size, two bytes per texel. */
+	static void FillDensityMap(FIntPoint Size, const FVector2f& Center, float RadiusScale, const FPXRFoveationShape& Shape, uint8* OutTexels);
+
+private:
+	bool IsActive_RenderThread() const;
+	/** Reads the eye tracker and writes the sample to the recording, if any. */
+	void SampleGaze(double PredictedDisplayTimeMs, const FVector4f EyeTangents[2], FPXRGazeSample& Sample, FVector2f LensCenter[2]);
+
+	FPXRGazeFoveationFilter Filter;
+	TUniquePtr<FArchive> Recording;
+	bool bActive_GameThread = false;
+
+	// Render thread
+	FPXRFoveationFrame Frame_RenderThread;
+	FPXRFoveationShape Shape_RenderThread;
+	bool bActive_RenderThread = false;
+	FPXRFoveationFrame UploadedFrame;
+	FPXRFoveationShape UploadedShape;
+	bool bUploaded = false;
+	bool bAllocatedWhileEnabled = false;
+	FTexture2DRHIRef Texture;
+	TArray<FTexture2DRHIRef> StagingSlices;
+	TArray<uint8> Texels;
+};
@@ -22,6 +22,10 @@
 
 #define PICO_PAUSED_IDLE_FPS 10
 
+DECLARE_STATS_GROUP(TEXT("PICOXR"), STATGROUP_PICOXR, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Settings Snapshots"), STAT_PXR_SettingsSnapshots, STATGROUP_PICOXR);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Settings Snapshots Per Second"), STAT_PXR_SettingsSnapshotsPerSecond, STATGROUP_PICOXR);
+
 static TAutoConsoleVariable<int32> CVarPICOEnableSubsampledLayout(
 	TEXT("r.Mobile.PICO.EnableSubsampled"),
 	0,
@@ -545,6 +549,7 @@ void FPICOXRHMD::OnBeginRendering_GameThread()
 void FPICOXRHMD::OnBeginRendering_RenderThread(FRHICommandListImmediate& RHICmdList, FSceneViewFamily& ViewFamily)
 {
 	CheckInRenderThread();
+	GazeFoveation.UpdateTexture_RenderThread(RHICmdList);
 }
 
 bool FPICOXRHMD::OnStartGameFrame(FWorldContext& WorldContext)
@@ -719,18 +724,23 @@ void FPICOXRHMD::AdjustViewRect(int32 ViewIndex, int32& X, int32& Y, uint32& Siz
 void FPICOXRHMD::SetFinalViewRect(FRHICommandListImmediate& RHICmdList, const int32 ViewIndex, const FIntRect& FinalViewRect)
 {
 	CheckInRenderThread();
-	if (GameSettings_RenderThread.IsValid() && GameSettings_RenderThread->Flags.bPixelDensityAdaptive)
+	// Snapshots are shared, so a changed viewport gets a private copy
+	if (GameSettings_RenderThread.IsValid() && GameSettings_RenderThread->Flags.bPixelDensityAdaptive && GameSettings_RenderThread->EyeRenderViewport[ViewIndex] != FinalViewRect)
 	{
-		GameSettings_RenderThread->EyeRenderViewport[ViewIndex] = FinalViewRect;
+		FSettingsPtr Settings = GameSettings_RenderThread->Clone();
+		Settings->EyeRenderViewport[ViewIndex] = FinalViewRect;
+		GameSettings_RenderThread = Settings;
 	}
 
 	ExecuteOnRHIThread_DoNotWait([this, ViewIndex, FinalViewRect]()
 		{
 			CheckInRHIThread();
 
-			if (GameSettings_RHIThread.IsValid() && GameSettings_RHIThread->Flags.bPixelDensityAdaptive)
+			if (GameSettings_RHIThread.IsValid() && GameSettings_RHIThread->Flags.bPixelDensityAdaptive && GameSettings_RHIThread->EyeRenderViewport[ViewIndex] != FinalViewRect)
 			{
-				GameSettings_RHIThread->EyeRenderViewport[ViewIndex] = FinalViewRect;
+				FSettingsPtr Settings = GameSettings_RHIThread->Clone();
+				Settings->EyeRenderViewport[ViewIndex] = FinalViewRect;
+				GameSettings_RHIThread = Settings;
 			}
 		});
 }
@@ -2078,7 +2088,7 @@ bool FPICOXRHMD::AllocateRenderTargetTexture(uint32 Index, uint32 SizeX, uint32
 bool FPICOXRHMD::NeedReAllocateShadingRateTexture(const TRefCountPtr<IPooledRenderTarget>& FoveationTarget)
 {
 	CheckInRenderThread();
-	return GameSettings_RenderThread->IsStereoEnabled() && bNeedReAllocateFoveationTexture_RenderThread;
+	return GameSettings_RenderThread->IsStereoEnabled() && (bNeedReAllocateFoveationTexture_RenderThread || GazeFoveation.NeedsReallocate_RenderThread());
 }
 
 bool FPICOXRHMD::AllocateShadingRateTexture(uint32 Index, uint32 RenderSizeX, uint32 RenderSizeY, uint8 Format, uint32 NumMips, ETextureCreateFlags InTexFlags, ETextureCreateFlags InTargetableTextureFlags, FTexture2DRHIRef& OutTexture, FIntPoint& OutTextureSize)
@@ -2119,7 +2129,10 @@ bool FPICOXRHMD::AllocateShadingRateTexture(uint32 Index, uint32 RenderSizeX, ui
 					PXR_LOGI(PxrUnreal, "%d x %d variable resolution swapchain is a divider of %d x %d color swapchain, no edge problems", TexSize.X, TexSize.Y, RenderSizeX, RenderSizeY);
 				}
 
-                OutTexture = Texture;
+                if (!GazeFoveation.AllocateTexture_RenderThread(Texture, OutTexture))
+                {
+                    OutTexture = Texture;
+                }
                 OutTextureSize = TexSize;
                 return true;
             }
@@ -2235,8 +2248,124 @@ IStereoLayers::FLayerDesc FPICOXRHMD::GetDebugCanvasLayerDesc(FTextureRHIRef Tex
 void FPICOXRHMD::GetAllocatedTexture(uint32 LayerId, FTextureRHIRef& Texture, FTextureRHIRef& LeftTexture)
 {
  	Texture = LeftTexture = nullptr;
+
+	// Only direct render layers hand out their swapchain, everything else is copied from LayerDesc.Texture
+	if (!IsInRenderingThread())
+	{
+		return;
+	}
+	for (const FPICOLayerPtr& Layer : PXRLayers_RenderThread)
+	{
+		if (Layer->GetID() == LayerId && Layer->IsDirectRender())
+		{
+			if (Layer->GetSwapChain().IsValid())
+			{
+				Texture = Layer->GetSwapChain()->GetTexture();
+			}
+			if (Layer->GetLeftSwapChain().IsValid())
+			{
+				LeftTexture = Layer->GetLeftSwapChain()->GetTexture();
+			}
+			return;
+		}
+	}
+}
+
+void FPICOXRHMD::SetLayerContentVersion(uint32 LayerId, uint64 Version, const FIntRect& DirtyRect)
+{
+	check(IsInGameThread());
+	FPICOLayerPtr* LayerFound = PXRLayerMap.Find(LayerId);
+	if (LayerFound)
+	{
+		(*LayerFound)->SetContentVersion(Version, DirtyRect);
+		if (!((*LayerFound)->GetPXRLayerDesc().Flags & IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE))
+		{
+			(*LayerFound)->MarkTextureForUpdate();
+		}
+	}
 }
 
+int32 FPICOXRHMD::MarkLayerTextureDirty(FRHITexture* Texture, const FIntRect& DirtyRect)
+{
+	check(IsInGameThread());
+	int32 NumLayers = 0;
+	if (Texture)
+	{
+		for (auto& Pair : PXRLayerMap)
+		{
+			const IStereoLayers::FLayerDesc& Desc = Pair.Value->GetPXRLayerDesc();
+			if (Desc.Texture.GetReference() == Texture || Desc.LeftTexture.GetReference() == Texture)
+			{
+				SetLayerContentVersion(Pair.Key, Pair.Value->GetContentVersion() + 1, DirtyRect);
+				NumLayers++;
+			}
+		}
+	}
+	return NumLayers;
+}
+
+void FPICOXRHMD::SetLayerDirectRender(uint32 LayerId, bool bDirectRender)
+{
+	check(IsInGameThread());
+	FPICOLayerPtr* LayerFound = PXRLayerMap.Find(LayerId);
+	if (LayerFound && LayerId != 0)
+	{
+		(*LayerFound)->SetDirectRender(bDirectRender);
+	}
+}
+
+void FPICOXRHMD::DumpLayerCopyStats(FOutputDevice& Ar) const
+{
+	check(IsInGameThread());
+	FPICOXRHMD* This = const_cast<FPICOXRHMD*>(this);
+	TArray<FString> Lines;
+	Lines.Add(TEXT("Layer  Mode       Images  LastFrame(KB)  AvgCopied(KB)  Copied  Skipped"));
+	ExecuteOnRenderThread([This, &Lines]()
+	{
+		for (const FPICOLayerPtr& Layer : This->PXRLayers_RenderThread)
+		{
+			const FPICOXRLayerCopyStatePtr& CopyState = Layer->GetCopyState();
+			if (Layer->GetID() == 0 || !CopyState.IsValid())
+			{
+				continue;
+			}
+			const int64 Copied = CopyState->FramesCopied;
+			const TCHAR* Mode = Layer->IsDirectRender() ? TEXT("direct") : Layer->TracksContentVersion() ? TEXT("tracked") : TEXT("full");
+			Lines.Add(FString::Printf(TEXT("%5u  %-9s  %6d  %13.1f  %13.1f  %6lld  %7lld"), Layer->GetID(), Mode, CopyState->NumImages,
+				CopyState->BytesCopiedLastFrame / 1024.0, Copied > 0 ? CopyState->BytesCopiedTotal / 1024.0 / Copied : 0.0, Copied, (int64)CopyState->FramesSkipped));
+		}
+	});
+	for (const FString& Line : Lines)
+	{
+		Ar.Log(Line);
+	}
+}
+
+static FAutoConsoleCommandWithOutputDevice CPICOStereoLayerCopyStats(
+	TEXT("PICO.StereoLayerCopyStats"),
+	TEXT("Prints the bytes copied into the swapchain of every stereo layer"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		static FName SystemName(TEXT("PICOXRHMD"));
+		if (GEngine && GEngine->XRSystem.IsValid() && GEngine->XRSystem->GetSystemName() == SystemName)
+		{
+			static_cast<FPICOXRHMD*>(GEngine->XRSystem.Get())->DumpLayerCopyStats(Ar);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CPICOFoveationRecordGaze(
+	TEXT("PICO.Foveation.RecordGaze"),
+	TEXT("Records the gaze of every rendered frame to a csv file under Saved for PICO.Foveation.EvaluateTrace, no file stops recording.\n")
+	TEXT("Usage: PICO.Foveation.RecordGaze [File.csv]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld*, FOutputDevice& Ar)
+	{
+		static FName SystemName(TEXT("PICOXRHMD"));
+		if (GEngine && GEngine->XRSystem.IsValid() && GEngine->XRSystem->GetSystemName() == SystemName)
+		{
+			static_cast<FPICOXRHMD*>(GEngine->XRSystem.Get())->SetGazeRecording(Args.Num() > 0 ? Args[0] : FString());
+		}
+	}));
+
 void FPICOXRHMD::OnBeginPlay(FWorldContext& InWorldContext)
 {
 	bNeedDrawBlackEye = false;
@@ -2579,8 +2708,23 @@ void FPICOXRHMD::LateUpdatePose()
 		 {
 			 NextGameFrameNumber++;
 		 }
-		 FSettingsPtr PXRSettings = GameSettings->Clone();
+		 FSettingsSnapshotPtr PXRSettings = PublishGameSettings_GameThread();
 		 FPXRGameFramePtr PXRFrame = NextGameFrameToRender_GameThread->CloneMyself();
+		 const FVector4f EyeTangents[2] =
+		 {
+			 FVector4f(FMath::Tan(LeftFrustum.FovLeft), FMath::Tan(LeftFrustum.FovRight), FMath::Tan(LeftFrustum.FovUp), FMath::Tan(LeftFrustum.FovDown)),
+			 FVector4f(FMath::Tan(RightFrustum.FovLeft), FMath::Tan(RightFrustum.FovRight), FMath::Tan(RightFrustum.FovUp), FMath::Tan(RightFrustum.FovDown)),
+		 };
+		 if (FPICOXRGazeFoveation::IsEnabled() && PXRSettings->FoveatedRenderingLevel != PxrFoveationLevel::PXR_FOVEATION_LEVEL_NONE)
+		 {
+			 GazeFoveation.Update_GameThread(PXRFrame->predictedDisplayTimeMs, EyeTangents, PXRSettings->FoveatedRenderingLevel);
+		 }
+		 else
+		 {
+			 // Keep recording with fixed foveation, that is the baseline PICO.Foveation.EvaluateTrace compares against
+			 GazeFoveation.Record_GameThread(PXRFrame->predictedDisplayTimeMs, EyeTangents);
+			 GazeFoveation.Disable_GameThread();
+		 }
 		 PXR_LOGV(PxrUnreal, "OnRenderFrameBegin_GameThread %u has been eaten by render-thread!", NextGameFrameToRender_GameThread->FrameNumber);
 		 TArray<FPICOLayerPtr> PXRLayers;
 
@@ -2598,6 +2742,7 @@ void FPICOXRHMD::LateUpdatePose()
 			 {
 				 Pair.Value->MarkTextureForUpdate(false);
 			 }
+			 Pair.Value->ClearContentDirty();
 		 }
 		 PXRLayers.Sort(FPICOLayerPtr_SortById());
 
@@ -2668,6 +2813,7 @@ void FPICOXRHMD::OnRenderFrameEnd_RenderThread(FRDGBuilder& RDGBuilder)
 
 	AddPass(RDGBuilder, RDG_EVENT_NAME("RenderFrameEnd"), [this](FRHICommandListImmediate& RHICmdList)
 	{
+		bool bLayersCopied = false;
 		if (GameFrame_RenderThread.IsValid() && !PICOSplash->IsShown())
 		{
 			if (GameFrame_RenderThread->ShowFlags.Rendering)
@@ -2676,6 +2822,19 @@ void FPICOXRHMD::OnRenderFrameEnd_RenderThread(FRDGBuilder& RDGBuilder)
 				{
 					PXRLayers_RenderThread[i]->PXRLayersCopy_RenderThread(RenderBridge, RHICmdList);
 				}
+				bLayersCopied = true;
+			}
+		}
+
+		if (!bLayersCopied)
+		{
+			// Not copied this frame, so the changes it carried are only known to be in no image
+			for (int32 i = 0; i < PXRLayers_RenderThread.Num(); i++)
+			{
+				if (PXRLayers_RenderThread[i]->GetCopyState().IsValid())
+				{
+					PXRLayers_RenderThread[i]->GetCopyState()->Invalidate_RenderThread();
+				}
 			}
 		}
 		
@@ -2689,7 +2848,7 @@ void FPICOXRHMD::OnRHIFrameBegin_RenderThread()
 	 check(IsInRenderingThread());
 	 if (GameFrame_RenderThread.IsValid())
 	 {
-		 FSettingsPtr PXRSettings = GameSettings_RenderThread->Clone();
+		 FSettingsSnapshotPtr PXRSettings = GameSettings_RenderThread;
 		 FPXRGameFramePtr PXRFrame = GameFrame_RenderThread->CloneMyself();
 		 TArray<FPICOLayerPtr> PXRLayers = PXRLayers_RenderThread;
 
@@ -2770,3 +2929,31 @@ void FPICOXRHMD::OnRHIFrameBegin_RenderThread()
 	 FSettingsPtr Result(MakeShareable(new FGameSettings()));
 	 return Result;
  }
+
+ FSettingsSnapshotPtr FPICOXRHMD::PublishGameSettings_GameThread()
+ {
+	 CheckInGameThread();
+
+	 const FString Changes = PublishedSettings.IsValid() ? GameSettings->DescribeChanges(*PublishedSettings) : FString(TEXT("all"));
+	 if (!Changes.IsEmpty())
+	 {
+		 FSettingsPtr Snapshot = GameSettings->Clone();
+		 Snapshot->Version = ++SettingsSnapshotsCreated;
+		 GameSettings->Version = Snapshot->Version;
+		 PublishedSettings = Snapshot;
+		 SettingsSnapshotsInWindow++;
+		 INC_DWORD_STAT(STAT_PXR_SettingsSnapshots);
+		 PXR_LOGD(PxrUnreal, "Settings snapshot %u: %s", Snapshot->Version, PLATFORM_CHAR(*Changes));
+	 }
+
+	 const double Now = FPlatformTime::Seconds();
+	 if (Now - SettingsSnapshotWindowStart >= 1.0)
+	 {
+		 SettingsSnapshotsPerSecond = SettingsSnapshotWindowStart > 0.0 ? SettingsSnapshotsInWindow / (Now - SettingsSnapshotWindowStart) : 0.0f;
+		 SettingsSnapshotsInWindow = 0;
+		 SettingsSnapshotWindowStart = Now;
+	 }
+	 SET_FLOAT_STAT(STAT_PXR_SettingsSnapshotsPerSecond, SettingsSnapshotsPerSecond);
+
+	 return PublishedSettings;
+ }
@@ -19,6 +19,7 @@
 #include "PXR_GameFrame.h"
 #include "StereoLayerManager.h"
 #include "PXR_DelayDeleteLayer.h"
+#include "PXR_GazeFoveation.h"
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FPICOPollEventDelegate, PxrEventDataBuffer* /*EventData*/);
 
@@ -237,6 +238,15 @@ public:
 	uint32 CreateMRCStereoLayer(FTextureRHIRef BackgroundRTTexture, FTextureRHIRef ForegroundRTTexture);
 	void DestroyMRCLayer();
 
+	/** See FPICOXRStereoLayer::SetContentVersion. DirtyRect is in texels of the layer texture, empty for all of it. */
+	PICOXRHMD_API void SetLayerContentVersion(uint32 LayerId, uint64 Version, const FIntRect& DirtyRect = FIntRect());
+	/** Marks every layer showing Texture as changed in DirtyRect, bumping its content version. Returns the layers found. */
+	PICOXRHMD_API int32 MarkLayerTextureDirty(FRHITexture* Texture, const FIntRect& DirtyRect = FIntRect());
+	/** Lets the source of the layer render into the texture returned by GetAllocatedTexture instead of being copied. */
+	PICOXRHMD_API void SetLayerDirectRender(uint32 LayerId, bool bDirectRender);
+	/** Bytes copied into the swapchain of each layer, last frame and on average. */
+	void DumpLayerCopyStats(FOutputDevice& Ar) const;
+
 	FString GetRHIString();
 
 	void OnPreLoadMap(const FString& MapName);
@@ -251,6 +261,8 @@ public:
 	void OnRHIFrameBegin_RenderThread();
 	void OnRHIFrameEnd_RHIThread();
 	FSettingsPtr CreateNewSettings() const;
+	/** Returns the snapshot of GameSettings for the render thread, publishing a new version only if GameSettings changed. */
+	FSettingsSnapshotPtr PublishGameSettings_GameThread();
 	FPXRGameFramePtr MakeNewGameFrame() const;
 	void UpdateStereoRenderingParams();
 	bool UpdateHMDBatteryLevelFromJava(int32& BatteryLevel);
@@ -259,6 +271,11 @@ public:
 	
 	// Game thread
 	FSettingsPtr GameSettings;
+	FSettingsSnapshotPtr PublishedSettings;
+	uint32 SettingsSnapshotsCreated = 0;
+	uint32 SettingsSnapshotsInWindow = 0;
+	double SettingsSnapshotWindowStart = 0.0;
+	float SettingsSnapshotsPerSecond = 0.0f;
 	uint32 NextGameFrameNumber;
 	uint32 WaitedFrameNumber;
 	FPXRGameFramePtr GameFrame_GameThread;
@@ -267,12 +284,12 @@ public:
 	TMap<uint32, FPICOLayerPtr> PXRLayerMap;
 	FPICOLayerPtr CurrentMRCLayer;
 	// Render thread
-	FSettingsPtr GameSettings_RenderThread;
+	FSettingsSnapshotPtr GameSettings_RenderThread;
 	FPXRGameFramePtr GameFrame_RenderThread;
 	TArray<FPICOLayerPtr> PXRLayers_RenderThread;
 	FPICOLayerPtr PXREyeLayer_RenderThread;
 	// RHI thread
-	FSettingsPtr GameSettings_RHIThread;
+	FSettingsSnapshotPtr GameSettings_RHIThread;
 	FPXRGameFramePtr GameFrame_RHIThread;
 	TArray<FPICOLayerPtr> PXRLayers_RHIThread;
 	double CurrentFramePredictedTime = 0;
@@ -285,10 +302,12 @@ public:
 	bool MRCEnabled=false;
 
 	bool bNeedReAllocateFoveationTexture_RenderThread = false;
+	FPICOXRGazeFoveation GazeFoveation;
 	bool bNeedReAllocateViewportRenderTarget;
 	bool inputFocusState = true;
 
 	PICOXRHMD_API void PollEvent();
+	void SetGazeRecording(const FString& Filename) { GazeFoveation.SetRecording(Filename); }
 	UPICOContentResourceFinder* GetContentResourceFinder(){return ContentResourceFinder;}
 	void AllocateEyeLayer();
 	bool IsUsingMobileMultiView() { return bIsUsingMobileMultiView; }
@@ -9,6 +9,8 @@
 #include "PXR_HMDRuntimeSettings.h"
 #include "PXR_BoundarySystem.h"
 #include "PXR_Utils.h"
+#include "Engine/Texture.h"
+#include "TextureResource.h"
 
 FPICOXRIPDChangedDelegate UPICOXRHMDFunctionLibrary::PICOXRIPDChangedCallback;
 FPICOXRHMD* UPICOXRHMDFunctionLibrary::PICOXRHMD = nullptr;
@@ -658,4 +660,13 @@ float UPICOXRHMDFunctionLibrary::PXR_GetTrackingOriginHeight()
     float OriginHeight = 0.0f;
     FPICOXRHMDModule::GetPluginWrapper().GetConfigFloat(PxrConfigType::PXR_TRACKING_ORIGIN_HEIGHT, &OriginHeight);
     return OriginHeight;
-}
\ No newline at end of file
+}
+int32 UPICOXRHMDFunctionLibrary::PXR_MarkStereoLayerTextureDirty(UTexture* Texture, FIntPoint DirtyMin, FIntPoint DirtyMax)
+{
+	FPICOXRHMD* PICOHMD = GetPICOXRHMD();
+	if (PICOHMD == nullptr || Texture == nullptr || Texture->GetResource() == nullptr)
+	{
+		return 0;
+	}
+	return PICOHMD->MarkLayerTextureDirty(Texture->GetResource()->TextureRHI, FIntRect(DirtyMin, DirtyMax));
+}
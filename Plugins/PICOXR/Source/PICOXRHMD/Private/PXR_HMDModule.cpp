@@ -8,6 +8,7 @@
 #include "Interfaces/IPluginManager.h"
 #include "PXR_HMDPrivateRHI.h"
 #include "PXR_Log.h"
+#include "PXR_LogBuffer.h"
 #include "Misc/Paths.h"
 #include "Engine/RendererSettings.h"
 
@@ -64,6 +65,7 @@ void FPICOXRHMDModule::UnregisterSettings()
 void FPICOXRHMDModule::StartupModule()
 {
 	IHeadMountedDisplayModule::StartupModule();
+	FPXRLogBuffer::Startup();
 	FCoreDelegates::OnFEngineLoopInitComplete.AddRaw(this,&FPICOXRHMDModule::RegisterSettings);
 	FString PluginShaderDir = FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("PICOXR"))->GetBaseDir(), TEXT("Shaders"));
 	AddShaderSourceDirectoryMapping(TEXT("/Plugin/PICOXR"), PluginShaderDir);
@@ -72,6 +74,7 @@ void FPICOXRHMDModule::StartupModule()
 void FPICOXRHMDModule::ShutdownModule()
 {
 	UnregisterSettings();
+	FPXRLogBuffer::Shutdown();
 #if PICO_HMD_SUPPORTED_PLATFORMS
 	if (PluginWrapper.Initialized)
 	{
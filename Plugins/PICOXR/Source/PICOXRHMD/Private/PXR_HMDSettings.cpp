@@ -21,6 +21,7 @@ FGameSettings::FGameSettings() :
 	, bLateLatching(false)
 	, bWaitFrameAtGameFrameTail(false)
 	, SeeThroughState(0)
+	, Version(0)
 {
 	Flags.Raw = 0;
 	Flags.bHMDEnabled = true;
@@ -35,6 +36,8 @@ FGameSettings::FGameSettings() :
 	CurrentShaderPlatform = EShaderPlatform::SP_PCD3D_SM5;
 #endif
 	EyeRenderViewport[0] = EyeRenderViewport[1] = FIntRect(0, 0, 0, 0);
+	EyeUnscaledRenderViewport[0] = EyeUnscaledRenderViewport[1] = FIntRect(0, 0, 0, 0);
+	EyeProjectionMatrices[0] = EyeProjectionMatrices[1] = MonoProjectionMatrix = FMatrix::Identity;
 	RenderTargetSize = FIntPoint(0, 0);
 }
 
@@ -44,6 +47,41 @@ TSharedPtr<FGameSettings, ESPMode::ThreadSafe> FGameSettings::Clone() const
 	return NewSettings;
 }
 
+FString FGameSettings::DescribeChanges(const FGameSettings& Other) const
+{
+	FString Changes;
+	auto Check = [&Changes](bool bSame, const TCHAR* Name)
+	{
+		if (!bSame)
+		{
+			Changes += Changes.IsEmpty() ? Name : *FString::Printf(TEXT(", %s"), Name);
+		}
+	};
+	auto SameVector4f = [](const PxrVector4f& A, const PxrVector4f& B)
+	{
+		return A.x == B.x && A.y == B.y && A.z == B.z && A.w == B.w;
+	};
+
+	Check(Flags.Raw == Other.Flags.Raw, TEXT("Flags"));
+	Check(BaseOffset == Other.BaseOffset, TEXT("BaseOffset"));
+	Check(BaseOrientation == Other.BaseOrientation, TEXT("BaseOrientation"));
+	Check(CustomOffsetYaw == Other.CustomOffsetYaw, TEXT("CustomOffsetYaw"));
+	Check(EyeRenderViewport[0] == Other.EyeRenderViewport[0] && EyeRenderViewport[1] == Other.EyeRenderViewport[1], TEXT("EyeRenderViewport"));
+	Check(EyeUnscaledRenderViewport[0] == Other.EyeUnscaledRenderViewport[0] && EyeUnscaledRenderViewport[1] == Other.EyeUnscaledRenderViewport[1], TEXT("EyeUnscaledRenderViewport"));
+	Check(EyeProjectionMatrices[0] == Other.EyeProjectionMatrices[0] && EyeProjectionMatrices[1] == Other.EyeProjectionMatrices[1], TEXT("EyeProjectionMatrices"));
+	Check(MonoProjectionMatrix == Other.MonoProjectionMatrix, TEXT("MonoProjectionMatrix"));
+	Check(RenderTargetSize == Other.RenderTargetSize, TEXT("RenderTargetSize"));
+	Check(PixelDensity == Other.PixelDensity && PixelDensityMin == Other.PixelDensityMin && PixelDensityMax == Other.PixelDensityMax, TEXT("PixelDensity"));
+	Check(FoveatedRenderingLevel == Other.FoveatedRenderingLevel, TEXT("FoveatedRenderingLevel"));
+	Check(CoordinateType == Other.CoordinateType, TEXT("CoordinateType"));
+	Check(bApplyColorScaleAndOffsetToAllLayers == Other.bApplyColorScaleAndOffsetToAllLayers && SameVector4f(ColorScale, Other.ColorScale) && SameVector4f(ColorOffset, Other.ColorOffset), TEXT("ColorScaleAndOffset"));
+	Check(CurrentShaderPlatform == Other.CurrentShaderPlatform, TEXT("CurrentShaderPlatform"));
+	Check(bLateLatching == Other.bLateLatching, TEXT("bLateLatching"));
+	Check(bWaitFrameAtGameFrameTail == Other.bWaitFrameAtGameFrameTail, TEXT("bWaitFrameAtGameFrameTail"));
+	Check(SeeThroughState == Other.SeeThroughState, TEXT("SeeThroughState"));
+	return Changes;
+}
+
 void FGameSettings::SetPixelDensity(float NewPixelDensity)
 {
 	if (Flags.bPixelDensityAdaptive)
@@ -56,6 +56,9 @@ public:
 	bool bWaitFrameAtGameFrameTail;
 
 	int SeeThroughState;
+
+	/** Version of a published snapshot, 0 for settings that were never published. */
+	uint32 Version;
 public:
 	FGameSettings();
 	virtual ~FGameSettings() {}
@@ -65,8 +68,13 @@ public:
 	void SetPixelDensity(float NewPixelDensity);
 	
 	TSharedPtr<FGameSettings, ESPMode::ThreadSafe> Clone() const;
+
+	/** Names of the settings that differ from Other, comma separated, empty if none. Version is not compared. */
+	FString DescribeChanges(const FGameSettings& Other) const;
 };
 
 typedef TSharedPtr<FGameSettings, ESPMode::ThreadSafe> FSettingsPtr;
+/** Settings published by the game thread, shared as is by the render and RHI threads and never changed. */
+typedef TSharedPtr<const FGameSettings, ESPMode::ThreadSafe> FSettingsSnapshotPtr;
 
 #endif //PICO_HMD_SUPPORTED_PLATFORMS
@@ -17,14 +17,16 @@ DEFINE_LOG_CATEGORY_STATIC(LogMRC, Log, All);
 
 #elif PLATFORM_ANDROID
 	#define PLATFORM_CHAR(str) TCHAR_TO_UTF8(str)
-	#include <android/Log.h>
+	#include "PXR_LogBuffer.h"
 
-	#define PXR_LOGV(TAG, fmt, ...) FPICOXRHMDModule::GetPluginWrapper().LogPrint(PxrLogPriority::PXR_LOG_VERBOSE, #TAG, fmt, ##__VA_ARGS__)
-	#define PXR_LOGD(TAG, fmt, ...) FPICOXRHMDModule::GetPluginWrapper().LogPrint(PxrLogPriority::PXR_LOG_DEBUG, #TAG, fmt, ##__VA_ARGS__)
-	#define PXR_LOGI(TAG, fmt, ...) FPICOXRHMDModule::GetPluginWrapper().LogPrint(PxrLogPriority::PXR_LOG_INFO, #TAG, fmt, ##__VA_ARGS__)
-	#define PXR_LOGW(TAG, fmt, ...) FPICOXRHMDModule::GetPluginWrapper().LogPrint(PxrLogPriority::PXR_LOG_WARN, #TAG, fmt, ##__VA_ARGS__)
-	#define PXR_LOGE(TAG, fmt, ...) FPICOXRHMDModule::GetPluginWrapper().LogPrint(PxrLogPriority::PXR_LOG_ERROR, #TAG, fmt, ##__VA_ARGS__)
-	#define PXR_LOGF(TAG, fmt, ...) FPICOXRHMDModule::GetPluginWrapper().LogPrint(PxrLogPriority::PXR_LOG_FATAL, #TAG, fmt, ##__VA_ARGS__)
+	// Gated before the arguments are evaluated, then stored and formatted off the calling thread, see FPXRLogBuffer.
+	#define PXR_LOGV(TAG, fmt, ...) PXR_LOG_DEFERRED(PxrLogPriority::PXR_LOG_VERBOSE, TAG, fmt, ##__VA_ARGS__)
+	#define PXR_LOGD(TAG, fmt, ...) PXR_LOG_DEFERRED(PxrLogPriority::PXR_LOG_DEBUG, TAG, fmt, ##__VA_ARGS__)
+	#define PXR_LOGI(TAG, fmt, ...) PXR_LOG_DEFERRED(PxrLogPriority::PXR_LOG_INFO, TAG, fmt, ##__VA_ARGS__)
+	#define PXR_LOGW(TAG, fmt, ...) PXR_LOG_DEFERRED(PxrLogPriority::PXR_LOG_WARN, TAG, fmt, ##__VA_ARGS__)
+	#define PXR_LOGE(TAG, fmt, ...) PXR_LOG_DEFERRED(PxrLogPriority::PXR_LOG_ERROR, TAG, fmt, ##__VA_ARGS__)
+	// Fatal is written synchronously, the process may not live to format it
+	#define PXR_LOGF(TAG, fmt, ...) do { FPXRLogBuffer::Flush(); FPICOXRHMDModule::GetPluginWrapper().LogPrint(PxrLogPriority::PXR_LOG_FATAL, #TAG, fmt, ##__VA_ARGS__); } while (0)
 
 #else
 	#define PLATFORM_CHAR(str) str
@@ -0,0 +1,608 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#include "PXR_LogBuffer.h"
+#include "PXR_HMDModule.h"
+#include "PXR_Log.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/CoreDelegates.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+#if UE_BUILD_SHIPPING
+int32 FPXRLogBuffer::RuntimePriority = PXR_LOG_INFO;
+#else
+int32 FPXRLogBuffer::RuntimePriority = PXR_LOG_VERBOSE;
+#endif
+
+static FAutoConsoleVariableRef CVarPICOLogPriority(
+	TEXT("PICO.LogPriority"),
+	FPXRLogBuffer::RuntimePriority,
+	TEXT("Lowest priority of the PXR_LOG calls that are logged in shipping builds.\n")
+	TEXT("2: Verbose, 3: Debug, 4: Info (Default), 5: Warning, 6: Error, 7: Fatal\n"),
+	ECVF_Default);
+
+static int32 GPICOLogDeferred = 1;
+static FAutoConsoleVariableRef CVarPICOLogDeferred(
+	TEXT("PICO.LogDeferred"),
+	GPICOLogDeferred,
+	TEXT("0: Format PXR_LOG calls on the calling thread\n")
+	TEXT("1: Store them and format them on a background thread (Default)\n"),
+	ECVF_Default);
+
+namespace
+{
+	const uint32 RingCapacity = 32 * 1024;
+	const uint32 MaxStringBytes = 256;
+	const uint32 MaxRecordBytes = 2048;
+	const int32 MaxFormattedBytes = 1024;
+	const float FormatIntervalSeconds = 0.05f;
+
+	/** Record layout in the ring: the header, then per argument a type byte and 8 bytes, or a uint16 length and the characters. */
+	struct FRecordHeader
+	{
+		uint32 Size; /* Whole record, padded to 8 bytes; a record without format skips to the end of the ring */
+		int32 Priority;
+		const char* Tag;
+		const char* Format;
+		int32 NumArgs;
+	};
+
+	uint32 AlignRecord(uint32 Size)
+	{
+		return (Size + 7) & ~7u;
+	}
+
+	/** Written by its thread only, read by whoever holds ConsumerLock. */
+	struct FThreadRing
+	{
+		uint8 Data[RingCapacity];
+		std::atomic<uint64> Head{ 0 };
+		std::atomic<uint64> Tail{ 0 };
+		std::atomic<uint64> Dropped{ 0 };
+		uint64 DroppedReported = 0;
+	};
+
+	FCriticalSection RingsLock;
+	TArray<FThreadRing*> Rings;
+	FCriticalSection ConsumerLock;
+	std::atomic<bool> bDeferring{ false };
+	std::atomic<bool> bNullOutput{ false }; /* Set by the benchmark so it measures the backend, not logcat */
+
+	void Emit(int32 Priority, const char* Tag, const char* Message)
+	{
+		if (bNullOutput)
+		{
+			return;
+		}
+#if PLATFORM_ANDROID
+		if (FPICOXRHMDModule::GetPluginWrapper().LogPrint)
+		{
+			FPICOXRHMDModule::GetPluginWrapper().LogPrint(Priority, Tag, "%s", Message);
+		}
+#else
+		UE_LOG(PxrUnreal, Log, TEXT("%s: %s"), UTF8_TO_TCHAR(Tag), UTF8_TO_TCHAR(Message));
+#endif
+	}
+
+	int64 AsSigned(const FPXRLogBuffer::FArg& Arg)
+	{
+		switch (Arg.Type)
+		{
+		case FPXRLogBuffer::EArgType::Double: return (int64)Arg.Double;
+		case FPXRLogBuffer::EArgType::Pointer: return (int64)(UPTRINT)Arg.Pointer;
+		default: return Arg.Signed;
+		}
+	}
+
+	double AsDouble(const FPXRLogBuffer::FArg& Arg)
+	{
+		switch (Arg.Type)
+		{
+		case FPXRLogBuffer::EArgType::Double: return Arg.Double;
+		case FPXRLogBuffer::EArgType::Unsigned: return (double)Arg.Unsigned;
+		case FPXRLogBuffer::EArgType::Signed: return (double)Arg.Signed;
+		default: return 0.0;
+		}
+	}
+
+	/** printf with already decoded arguments: every conversion is handed to snprintf on its own with the type it expects. */
+	void FormatRecord(const char* Format, const FPXRLogBuffer::FArg* Args, int32 NumArgs, char* Out, int32 OutSize)
+	{
+		int32 Length = 0;
+		int32 ArgIndex = 0;
+		auto Append = [&](int32 Written)
+		{
+			Length = FMath::Min(Length + FMath::Max(Written, 0), OutSize - 1);
+		};
+		auto NextArg = [&]() -> const FPXRLogBuffer::FArg*
+		{
+			return ArgIndex < NumArgs ? &Args[ArgIndex++] : nullptr;
+		};
+
+		for (const char* Cursor = Format; *Cursor && Length < OutSize - 1; )
+		{
+			if (*Cursor != '%')
+			{
+				Out[Length++] = *Cursor++;
+				continue;
+			}
+			if (Cursor[1] == '%')
+			{
+				Out[Length++] = '%';
+				Cursor += 2;
+				continue;
+			}
+
+			// Rebuild the conversion with '*' resolved and without length modifiers, which we pick ourselves
+			char Spec[32];
+			int32 SpecLength = 0;
+			Spec[SpecLength++] = *Cursor++;
+			// Flags, width and precision leave room for the longest suffix, "ll" plus conversion plus terminator
+			auto AppendSpec = [&](const char* Text, int32 TextLength)
+			{
+				TextLength = FMath::Clamp(TextLength, 0, (int32)sizeof(Spec) - 4 - SpecLength);
+				FMemory::Memcpy(Spec + SpecLength, Text, TextLength);
+				SpecLength += TextLength;
+			};
+			auto SetSuffix = [&](const char* Suffix)
+			{
+				FMemory::Memcpy(Spec + SpecLength, Suffix, strlen(Suffix) + 1);
+			};
+			while (*Cursor && strchr("-+ #0", *Cursor))
+			{
+				AppendSpec(Cursor++, 1);
+			}
+			for (int32 Part = 0; Part < 2; ++Part)
+			{
+				if (Part == 1)
+				{
+					if (*Cursor != '.')
+					{
+						break;
+					}
+					AppendSpec(Cursor++, 1);
+				}
+				if (*Cursor == '*')
+				{
+					const FPXRLogBuffer::FArg* Arg = NextArg();
+					char Number[16];
+					AppendSpec(Number, snprintf(Number, sizeof(Number), "%d", Arg ? (int32)AsSigned(*Arg) : 0));
+					++Cursor;
+				}
+				while (*Cursor >= '0' && *Cursor <= '9')
+				{
+					AppendSpec(Cursor++, 1);
+				}
+			}
+			bool bNoLength = true;
+			while (*Cursor && strchr("hljztLq", *Cursor))
+			{
+				bNoLength = false;
+				++Cursor;
+			}
+			const char Conversion = *Cursor;
+			if (Conversion == 0)
+			{
+				break;
+			}
+			++Cursor;
+
+			const FPXRLogBuffer::FArg* Arg = NextArg();
+			char* Target = Out + Length;
+			const int32 Remaining = OutSize - Length;
+			switch (Conversion)
+			{
+			case 'd':
+			case 'i':
+			{
+				SetSuffix("lld");
+				const int64 Value = Arg ? AsSigned(*Arg) : 0;
+				Append(snprintf(Target, Remaining, Spec, (long long)(bNoLength ? (int64)(int32)Value : Value)));
+				break;
+			}
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+			{
+				const char Suffix[4] = { 'l', 'l', Conversion, 0 };
+				SetSuffix(Suffix);
+				const uint64 Value = Arg ? (uint64)AsSigned(*Arg) : 0;
+				Append(snprintf(Target, Remaining, Spec, (unsigned long long)(bNoLength ? (uint64)(uint32)Value : Value)));
+				break;
+			}
+			case 'c':
+				SetSuffix("c");
+				Append(snprintf(Target, Remaining, Spec, Arg ? (int)AsSigned(*Arg) : ' '));
+				break;
+			case 'f':
+			case 'F':
+			case 'e':
+			case 'E':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+			{
+				const char Suffix[2] = { Conversion, 0 };
+				SetSuffix(Suffix);
+				Append(snprintf(Target, Remaining, Spec, Arg ? AsDouble(*Arg) : 0.0));
+				break;
+			}
+			case 's':
+				SetSuffix("s");
+				Append(snprintf(Target, Remaining, Spec, Arg && Arg->Type == FPXRLogBuffer::EArgType::String && Arg->String ? Arg->String : "(null)"));
+				break;
+			case 'p':
+				SetSuffix("p");
+				Append(snprintf(Target, Remaining, Spec, Arg ? (const void*)(UPTRINT)AsSigned(*Arg) : nullptr));
+				break;
+			default:
+				// %n and unknown conversions print nothing
+				break;
+			}
+		}
+		Out[Length] = 0;
+	}
+
+	void FormatAndEmit(int32 Priority, const char* Tag, const char* Format, const FPXRLogBuffer::FArg* Args, int32 NumArgs)
+	{
+		char Message[MaxFormattedBytes];
+		FormatRecord(Format, Args, NumArgs, Message, sizeof(Message));
+		Emit(Priority, Tag, Message);
+	}
+
+	/** Decodes and emits the records of one ring; the caller holds ConsumerLock. */
+	void DrainRing(FThreadRing& Ring)
+	{
+		const uint64 Head = Ring.Head.load(std::memory_order_acquire);
+		uint64 Tail = Ring.Tail.load(std::memory_order_relaxed);
+		FPXRLogBuffer::FArg Args[32];
+		char Strings[MaxRecordBytes];
+		while (Tail < Head)
+		{
+			const uint32 ToEnd = RingCapacity - (Tail % RingCapacity);
+			if (ToEnd < sizeof(FRecordHeader))
+			{
+				// Too short for a record, the writer skipped it
+				Tail += ToEnd;
+				continue;
+			}
+			const uint8* Record = Ring.Data + (Tail % RingCapacity);
+			FRecordHeader Header;
+			FMemory::Memcpy(&Header, Record, sizeof(Header));
+			if (Header.Format != nullptr)
+			{
+				// Strings are copied out so they stay valid until the record is formatted
+				const uint8* Cursor = Record + sizeof(FRecordHeader);
+				int32 StringsUsed = 0;
+				const int32 NumArgs = FMath::Min(Header.NumArgs, (int32)UE_ARRAY_COUNT(Args));
+				for (int32 Index = 0; Index < NumArgs; ++Index)
+				{
+					FPXRLogBuffer::FArg& Arg = Args[Index];
+					Arg.Type = (FPXRLogBuffer::EArgType)*Cursor++;
+					if (Arg.Type == FPXRLogBuffer::EArgType::String)
+					{
+						uint16 StringLength;
+						FMemory::Memcpy(&StringLength, Cursor, sizeof(StringLength));
+						Cursor += sizeof(StringLength);
+						FMemory::Memcpy(Strings + StringsUsed, Cursor, StringLength);
+						Strings[StringsUsed + StringLength] = 0;
+						Arg.String = Strings + StringsUsed;
+						StringsUsed += StringLength + 1;
+						Cursor += StringLength;
+					}
+					else
+					{
+						FMemory::Memcpy(&Arg.Unsigned, Cursor, sizeof(uint64));
+						Cursor += sizeof(uint64);
+					}
+				}
+				FormatAndEmit(Header.Priority, Header.Tag, Header.Format, Args, NumArgs);
+			}
+			Tail += Header.Size;
+		}
+		Ring.Tail.store(Tail, std::memory_order_release);
+
+		const uint64 Dropped = Ring.Dropped.load(std::memory_order_relaxed);
+		if (Dropped != Ring.DroppedReported)
+		{
+			char Message[64];
+			snprintf(Message, sizeof(Message), "%llu log records dropped, the log ring was full", (unsigned long long)(Dropped - Ring.DroppedReported));
+			Emit(PXR_LOG_WARN, "PxrUnreal", Message);
+			Ring.DroppedReported = Dropped;
+		}
+	}
+
+	void DrainAll()
+	{
+		TArray<FThreadRing*, TInlineAllocator<32>> Snapshot;
+		{
+			FScopeLock ScopeLock(&RingsLock);
+			Snapshot = Rings;
+		}
+		for (FThreadRing* Ring : Snapshot)
+		{
+			DrainRing(*Ring);
+		}
+	}
+
+	/** Owns the ring of its thread. Whatever the thread logged right before exiting is formatted before the ring is freed. */
+	struct FThreadRingOwner
+	{
+		FThreadRing* Ring = nullptr;
+
+		~FThreadRingOwner()
+		{
+			if (Ring == nullptr)
+			{
+				return;
+			}
+			// Consumers only touch rings under ConsumerLock, so none is draining this one when it goes
+			FScopeLock ConsumerScope(&ConsumerLock);
+			DrainRing(*Ring);
+			{
+				FScopeLock ScopeLock(&RingsLock);
+				Rings.RemoveSingleSwap(Ring);
+			}
+			delete Ring;
+		}
+	};
+
+	FThreadRing* GetThreadRing()
+	{
+		static thread_local FThreadRingOwner LocalRing;
+		if (LocalRing.Ring == nullptr)
+		{
+			FScopeLock ScopeLock(&RingsLock);
+			LocalRing.Ring = new FThreadRing();
+			Rings.Add(LocalRing.Ring);
+		}
+		return LocalRing.Ring;
+	}
+
+	class FPXRLogFormatter : public FRunnable
+	{
+	public:
+		FPXRLogFormatter()
+		{
+			WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+			Thread = FRunnableThread::Create(this, TEXT("PXRLogFormatter"), 0, TPri_Lowest);
+		}
+
+		virtual ~FPXRLogFormatter()
+		{
+			if (Thread)
+			{
+				Thread->Kill(true);
+				delete Thread;
+			}
+			FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping)
+			{
+				WakeEvent->Wait(FTimespan::FromSeconds(FormatIntervalSeconds));
+				FScopeLock ScopeLock(&ConsumerLock);
+				DrainAll();
+			}
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping = true;
+			WakeEvent->Trigger();
+		}
+
+		bool IsRunning() const
+		{
+			return Thread != nullptr;
+		}
+
+	private:
+		FRunnableThread* Thread = nullptr;
+		FEvent* WakeEvent = nullptr;
+		FThreadSafeBool bStopping;
+	};
+
+	FPXRLogFormatter* Formatter = nullptr;
+	FDelegateHandle SystemErrorHandle;
+
+	void StartFormatter()
+	{
+		if (Formatter == nullptr)
+		{
+			Formatter = new FPXRLogFormatter();
+			if (Formatter->IsRunning())
+			{
+				bDeferring = true;
+				// Whatever is still in the rings is the most useful part of a crash log
+				SystemErrorHandle = FCoreDelegates::OnHandleSystemError.AddStatic(&FPXRLogBuffer::Flush);
+			}
+		}
+	}
+
+	void StopFormatter()
+	{
+		bDeferring = false;
+		FCoreDelegates::OnHandleSystemError.Remove(SystemErrorHandle);
+		delete Formatter;
+		Formatter = nullptr;
+		FPXRLogBuffer::Flush();
+	}
+}
+
+void FPXRLogBuffer::Write(int32 Priority, const char* Tag, const char* Format, const FArg* Args, int32 NumArgs)
+{
+	if (!bDeferring.load(std::memory_order_relaxed) || !GPICOLogDeferred)
+	{
+		FormatAndEmit(Priority, Tag, Format, Args, NumArgs);
+		return;
+	}
+
+	uint32 StringLengths[32];
+	NumArgs = FMath::Min(NumArgs, (int32)UE_ARRAY_COUNT(StringLengths));
+	uint32 Size = sizeof(FRecordHeader);
+	for (int32 Index = 0; Index < NumArgs; ++Index)
+	{
+		if (Args[Index].Type == EArgType::String)
+		{
+			StringLengths[Index] = Args[Index].String ? (uint32)strnlen(Args[Index].String, MaxStringBytes) : 0;
+			Size += 1 + sizeof(uint16) + StringLengths[Index];
+		}
+		else
+		{
+			Size += 1 + sizeof(uint64);
+		}
+	}
+	Size = AlignRecord(Size);
+
+	FThreadRing& Ring = *GetThreadRing();
+	const uint64 Head = Ring.Head.load(std::memory_order_relaxed);
+	const uint64 Tail = Ring.Tail.load(std::memory_order_acquire);
+	const uint32 Offset = Head % RingCapacity;
+	// A record never wraps, the space left at the end of the ring is skipped with an empty record
+	const uint32 Padding = Offset + Size > RingCapacity ? RingCapacity - Offset : 0;
+	if (Size > MaxRecordBytes || Head + Padding + Size - Tail > RingCapacity)
+	{
+		Ring.Dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	uint64 WriteHead = Head;
+	if (Padding >= sizeof(FRecordHeader))
+	{
+		const FRecordHeader Skip = { Padding, 0, nullptr, nullptr, 0 };
+		FMemory::Memcpy(Ring.Data + Offset, &Skip, sizeof(Skip));
+	}
+	WriteHead += Padding;
+
+	uint8* Record = Ring.Data + (WriteHead % RingCapacity);
+	const FRecordHeader Header = { Size, Priority, Tag, Format, NumArgs };
+	FMemory::Memcpy(Record, &Header, sizeof(Header));
+	uint8* Cursor = Record + sizeof(FRecordHeader);
+	for (int32 Index = 0; Index < NumArgs; ++Index)
+	{
+		*Cursor++ = (uint8)Args[Index].Type;
+		if (Args[Index].Type == EArgType::String)
+		{
+			const uint16 StringLength = (uint16)StringLengths[Index];
+			FMemory::Memcpy(Cursor, &StringLength, sizeof(StringLength));
+			Cursor += sizeof(StringLength);
+			FMemory::Memcpy(Cursor, Args[Index].String, StringLength);
+			Cursor += StringLength;
+		}
+		else
+		{
+			FMemory::Memcpy(Cursor, &Args[Index].Unsigned, sizeof(uint64));
+			Cursor += sizeof(uint64);
+		}
+	}
+	Ring.Head.store(WriteHead + Size, std::memory_order_release);
+}
+
+void FPXRLogBuffer::Startup()
+{
+#if PXR_LOG_FORMATTER_THREAD
+	StartFormatter();
+#endif
+}
+
+void FPXRLogBuffer::Shutdown()
+{
+	StopFormatter();
+}
+
+void FPXRLogBuffer::Flush()
+{
+	// The crash may have happened while formatting, in which case the lock is never released
+	if (ConsumerLock.TryLock())
+	{
+		DrainAll();
+		ConsumerLock.Unlock();
+	}
+}
+
+FString FPXRLogBuffer::RunBenchmark(int32 Iterations)
+{
+	Iterations = FMath::Max(Iterations, 1);
+	const int32 SavedPriority = RuntimePriority;
+	const int32 SavedDeferred = GPICOLogDeferred;
+	const FRotator Rotation(10.0, 20.0, 30.0);
+	const FVector Position(1.0, 2.0, 3.0);
+	uint32 FrameNumber = 0;
+
+	// Deferred calls are measured against a running formatter, as in the builds that use them
+	const bool bStartedFormatter = Formatter == nullptr;
+	StartFormatter();
+
+	// Logging is stopped while measuring and formatted but not printed, so the numbers are the cost of the backend.
+	// Calls are timed in batches that fit a ring, and the rings are drained between batches, outside of the timing.
+	bNullOutput = true;
+	auto TimeBatches = [Iterations](int32 BatchSize, auto&& Call) -> double
+	{
+		double Elapsed = 0.0;
+		for (int32 Done = 0; Done < Iterations; Done += BatchSize)
+		{
+			const int32 Batch = FMath::Min(BatchSize, Iterations - Done);
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Batch; ++Index)
+			{
+				Call();
+			}
+			Elapsed += FPlatformTime::Seconds() - StartTime;
+			Flush();
+		}
+		return Elapsed * 1e9 / Iterations;
+	};
+	auto Measure = [&](int32 Priority, int32 Deferred) -> double
+	{
+		RuntimePriority = Priority;
+		GPICOLogDeferred = Deferred;
+		return TimeBatches(256, [&]()
+		{
+			// The per frame log of UpdateSensorValue
+			PXR_LOG_DEFERRED(PXR_LOG_VERBOSE, PxrUnreal, "UpdateSensorValue:%u,PredtTime:%f,ViewNumber:%d,Rotation:%s,Position:%s", ++FrameNumber, 16.6, 2,
+				TCHAR_TO_UTF8(*Rotation.ToString()), TCHAR_TO_UTF8(*Position.ToString()));
+		});
+	};
+	const double SuppressedNs = Measure(PXR_LOG_INFO, 1);
+	const double DeferredNs = Measure(PXR_LOG_VERBOSE, 1);
+	const double FormattedNs = Measure(PXR_LOG_VERBOSE, 0);
+
+	// The caller side cost of a deferred call alone, without the vector formatting of its arguments
+	RuntimePriority = PXR_LOG_VERBOSE;
+	GPICOLogDeferred = 1;
+	const double NumericNs = TimeBatches(1024, [&]()
+	{
+		PXR_LOG_DEFERRED(PXR_LOG_VERBOSE, PxrUnreal, "EndFrame %u,SubmitViewNum:%d", ++FrameNumber, 2);
+	});
+	const bool bDeferred = bDeferring;
+	bNullOutput = false;
+	RuntimePriority = SavedPriority;
+	GPICOLogDeferred = SavedDeferred;
+	if (bStartedFormatter)
+	{
+		StopFormatter();
+	}
+
+	return FString::Printf(TEXT("PXR_LOGV over %d calls: suppressed %.1f ns, deferred %.1f ns (numeric arguments only %.1f ns), formatted on the spot %.1f ns%s"),
+		Iterations, SuppressedNs, DeferredNs, NumericNs, FormattedNs, bDeferred ? TEXT("") : TEXT("; the formatter thread is not running, deferred calls were formatted on the spot"));
+}
+
+static FAutoConsoleCommand CPICOLogBenchmark(
+	TEXT("PICO.LogBenchmark"),
+	TEXT("Times suppressed and enabled PXR_LOGV calls. Usage: PICO.LogBenchmark [Iterations]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000;
+		UE_LOG(PxrUnreal, Display, TEXT("%s"), *FPXRLogBuffer::RunBenchmark(Iterations));
+	}));
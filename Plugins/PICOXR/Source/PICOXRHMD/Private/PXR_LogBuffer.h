@@ -0,0 +1,136 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#pragma once
+#include "CoreMinimal.h"
+#include "PXR_Plugin_Types.h"
+#include <type_traits>
+
+// Priorities below this are compiled out of shipping builds, 2 (PXR_LOG_VERBOSE) keeps everything.
+#ifndef PXR_LOG_COMPILED_PRIORITY
+	#define PXR_LOG_COMPILED_PRIORITY 2
+#endif
+
+// The formatter thread only runs in the builds whose PXR_LOG* go through this backend, see PXR_Log.h.
+#ifndef PXR_LOG_FORMATTER_THREAD
+	#define PXR_LOG_FORMATTER_THREAD (UE_BUILD_SHIPPING && PLATFORM_ANDROID)
+#endif
+
+/**
+ * Binary log backend of PXR_LOG* in shipping builds.
+ *
+ * A call below the runtime priority (PICO.LogPriority) costs one compare, its arguments are not evaluated. A call
+ * above it stores the format, tag and raw arguments in a ring owned by the calling thread, without locking or
+ * formatting; a background thread formats the records and hands them to the runtime logger. Records that do not fit
+ * a full ring are counted and dropped rather than blocking the render or RHI thread. Flush() formats everything
+ * pending on the calling thread, it runs on a crash and at shutdown. A thread's ring is formatted and freed when the
+ * thread exits.
+ *
+ * Format strings and tags must be literals, only their pointers are stored. String arguments are copied.
+ */
+class PICOXRHMD_API FPXRLogBuffer
+{
+public:
+	/** The lowest priority logged, see PICO.LogPriority. */
+	static int32 RuntimePriority;
+
+	static FORCEINLINE bool IsEnabled(int32 Priority)
+	{
+		return Priority >= RuntimePriority;
+	}
+
+	template <typename... ArgTypes>
+	static void Log(int32 Priority, const char* Tag, const char* Format, ArgTypes... Args)
+	{
+		const FArg Encoded[sizeof...(Args) + 1] = { MakeArg(Args)..., FArg() };
+		Write(Priority, Tag, Format, Encoded, sizeof...(Args));
+	}
+
+	/**
+	 * Starts the formatting thread if PXR_LOG_FORMATTER_THREAD is set. Before that, and after Shutdown, records are
+	 * formatted on the calling thread.
+	 */
+	static void Startup();
+	static void Shutdown();
+
+	/** Formats and emits every pending record. */
+	static void Flush();
+
+	/** Times suppressed and enabled verbose calls, deferred and formatted on the spot. Runs the formatting thread while it measures. */
+	static FString RunBenchmark(int32 Iterations);
+
+	enum class EArgType : uint8
+	{
+		Signed,
+		Unsigned,
+		Double,
+		Pointer,
+		String,
+	};
+
+	struct FArg
+	{
+		EArgType Type = EArgType::Signed;
+		union
+		{
+			int64 Signed;
+			uint64 Unsigned;
+			double Double;
+			const void* Pointer;
+			const char* String;
+		};
+
+		FArg() : Signed(0) {}
+	};
+
+private:
+	template <typename T>
+	static FArg MakeArg(T Value)
+	{
+		FArg Arg;
+		if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>)
+		{
+			Arg.Type = EArgType::String;
+			Arg.String = Value;
+		}
+		else if constexpr (std::is_pointer_v<T> || std::is_null_pointer_v<T>)
+		{
+			Arg.Type = EArgType::Pointer;
+			Arg.Pointer = Value;
+		}
+		else if constexpr (std::is_enum_v<T>)
+		{
+			Arg.Type = EArgType::Signed;
+			Arg.Signed = (int64)Value;
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			Arg.Type = EArgType::Double;
+			Arg.Double = (double)Value;
+		}
+		else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+		{
+			Arg.Type = EArgType::Signed;
+			Arg.Signed = (int64)Value;
+		}
+		else
+		{
+			static_assert(std::is_integral_v<T>, "PXR_LOG arguments must be numbers, enums, pointers or C strings");
+			Arg.Type = EArgType::Unsigned;
+			Arg.Unsigned = (uint64)Value;
+		}
+		return Arg;
+	}
+
+	static void Write(int32 Priority, const char* Tag, const char* Format, const FArg* Args, int32 NumArgs);
+};
+
+#define PXR_LOG_DEFERRED(Priority, TAG, fmt, ...) \
+	do \
+	{ \
+		if ((int32)(Priority) >= PXR_LOG_COMPILED_PRIORITY && FPXRLogBuffer::IsEnabled((int32)(Priority))) \
+		{ \
+			FPXRLogBuffer::Log((int32)(Priority), #TAG, fmt, ##__VA_ARGS__); \
+		} \
+	} while (0)
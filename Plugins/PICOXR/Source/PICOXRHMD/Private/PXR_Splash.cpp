@@ -388,7 +388,7 @@ void FPXRSplash::RenderSplashFrame_RenderThread(FRHICommandListImmediate& RHICmd
 
 	FScopeLock ScopeLock(&RenderThreadLock);
 
-	FSettingsPtr PXRSettings = Settings->Clone();
+	FSettingsSnapshotPtr PXRSettings = Settings;
 	FPXRGameFramePtr SplashFrame = PXRFrame->CloneMyself();
 	SplashFrame->FrameNumber = PICOXRHMD->NextGameFrameNumber;
 	SplashFrame->predictedDisplayTimeMs = PICOXRHMD->CurrentFramePredictedTime + 1000.0f / PICOXRHMD->DisplayRefreshRate;
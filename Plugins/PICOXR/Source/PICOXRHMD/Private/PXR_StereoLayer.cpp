@@ -37,6 +37,74 @@ FPxrLayer::~FPxrLayer()
 	}
 }
 
+namespace
+{
+	bool IsRectEmpty(const FIntRect& Rect)
+	{
+		return Rect.Width() <= 0 || Rect.Height() <= 0;
+	}
+
+	/** Union that treats an empty rect as nothing. */
+	void UnionRect(FIntRect& InOutRect, const FIntRect& Rect)
+	{
+		if (IsRectEmpty(Rect))
+		{
+			return;
+		}
+		if (IsRectEmpty(InOutRect))
+		{
+			InOutRect = Rect;
+			return;
+		}
+		InOutRect.Min = InOutRect.Min.ComponentMin(Rect.Min);
+		InOutRect.Max = InOutRect.Max.ComponentMax(Rect.Max);
+	}
+}
+
+FPICOXRLayerCopyState::FPICOXRLayerCopyState(int32 InNumImages)
+	: NumImages(FMath::Max(InNumImages, 1))
+{
+}
+
+FIntRect FPICOXRLayerCopyState::AddFrame_RenderThread(const FIntRect& FrameDirtyRect, const FIntRect& FullRect, int32 ImageIndex)
+{
+	check(IsInRenderingThread());
+
+	// Images that were never written need everything
+	if (PendingDirtyRects.Num() != NumImages)
+	{
+		PendingDirtyRects.Init(FullRect, NumImages);
+	}
+	for (FIntRect& Rect : PendingDirtyRects)
+	{
+		UnionRect(Rect, FrameDirtyRect);
+	}
+
+	if (!PendingDirtyRects.IsValidIndex(ImageIndex))
+	{
+		// An image we do not know about, nothing can be assumed about any of them
+		PendingDirtyRects.Reset();
+		return FullRect;
+	}
+	const FIntRect CopyRect = PendingDirtyRects[ImageIndex];
+	PendingDirtyRects[ImageIndex] = FIntRect();
+	return CopyRect;
+}
+
+void FPICOXRLayerCopyState::RecordCopy_RenderThread(int64 Bytes)
+{
+	BytesCopiedLastFrame = Bytes;
+	BytesCopiedTotal += Bytes;
+	if (Bytes > 0)
+	{
+		FramesCopied++;
+	}
+	else
+	{
+		FramesSkipped++;
+	}
+}
+
 uint64_t OverlayImages[2] = {};
 uint64_t OverlayNativeImages[2][3] = {};
 
@@ -51,6 +119,10 @@ FPICOXRStereoLayer::FPICOXRStereoLayer(FPICOXRHMD* InHMDDevice, uint32 InPXRLaye
 	, ID(InPXRLayerId)
 	, PxrLayerID(0)
     , bTextureNeedUpdate(false)
+	, ContentVersion(0)
+	, bContentDirty(false)
+	, bTracksContentVersion(false)
+	, bDirectRender(false)
     , UnderlayMeshComponent(NULL)
     , UnderlayActor(NULL)
     , PxrLayer(nullptr)
@@ -78,6 +150,12 @@ FPICOXRStereoLayer::FPICOXRStereoLayer(const FPICOXRStereoLayer& InPXRLayer)
     , LeftSwapChain(InPXRLayer.LeftSwapChain)
     , FoveationSwapChain(InPXRLayer.FoveationSwapChain)
     , bTextureNeedUpdate(InPXRLayer.bTextureNeedUpdate)
+	, ContentVersion(InPXRLayer.ContentVersion)
+	, ContentDirtyRect(InPXRLayer.ContentDirtyRect)
+	, bContentDirty(InPXRLayer.bContentDirty)
+	, bTracksContentVersion(InPXRLayer.bTracksContentVersion)
+	, bDirectRender(InPXRLayer.bDirectRender)
+	, CopyState(InPXRLayer.CopyState)
     , UnderlayMeshComponent(InPXRLayer.UnderlayMeshComponent)
     , UnderlayActor(InPXRLayer.UnderlayActor)
     , PxrLayer(InPXRLayer.PxrLayer)
@@ -101,12 +179,40 @@ void FPICOXRStereoLayer::SetPXRLayerDesc(const IStereoLayers::FLayerDesc& InDesc
 	if (LayerDesc.Texture != InDesc.Texture || LayerDesc.LeftTexture != InDesc.LeftTexture)
 	{
 		bTextureNeedUpdate = true;
+		bContentDirty = true;
+		ContentDirtyRect = FIntRect();
 	}
 	LayerDesc = InDesc;
 
 	ManageUnderlayComponent(bRatioChanged);
 }
 
+void FPICOXRStereoLayer::SetContentVersion(uint64 InVersion, const FIntRect& DirtyRect)
+{
+	if (bTracksContentVersion && InVersion == ContentVersion)
+	{
+		return;
+	}
+
+	if (!bTracksContentVersion || IsRectEmpty(DirtyRect))
+	{
+		// The first version, or an unknown change, needs a full copy
+		ContentDirtyRect = FIntRect();
+	}
+	else if (!bContentDirty)
+	{
+		ContentDirtyRect = DirtyRect;
+	}
+	else if (!IsRectEmpty(ContentDirtyRect))
+	{
+		UnionRect(ContentDirtyRect, DirtyRect);
+	}
+
+	ContentVersion = InVersion;
+	bContentDirty = true;
+	bTracksContentVersion = true;
+}
+
 void FPICOXRStereoLayer::ManageUnderlayComponent(bool bRatioChanged)
 {
 	if (IsLayerSupportDepth())
@@ -314,6 +420,17 @@ void FPICOXRStereoLayer::PXRLayersCopy_RenderThread(FPICOXRRenderBridge* RenderB
 
 	PXR_LOGV(PxrUnreal, "ID=%d, bTextureNeedUpdate=%d, IsVisible:%d, SwapChain.IsValid=%d, LayerDesc.Texture.IsValid=%d", ID, bTextureNeedUpdate, IsVisible(), SwapChain.IsValid(), LayerDesc.Texture.IsValid());
 
+	if (bDirectRender && IsVisible() && SwapChain.IsValid())
+	{
+		// The source drew into the swapchain image itself
+		if (CopyState.IsValid())
+		{
+			CopyState->RecordCopy_RenderThread(0);
+		}
+		bTextureNeedUpdate = false;
+		return;
+	}
+
 	if (bTextureNeedUpdate && IsVisible())
 	{
 		// Copy textures
@@ -331,6 +448,50 @@ void FPICOXRStereoLayer::PXRLayersCopy_RenderThread(FPICOXRRenderBridge* RenderB
 #else
 			DstRect = SrcRect = FIntRect();
 #endif
+			FIntRect FullRect = IsRectEmpty(SrcRect) ? FIntRect(0, 0, PxrLayerCreateParam.width, PxrLayerCreateParam.height) : SrcRect;
+			const int64 Eyes = (LayerDesc.LeftTexture.IsValid() && LeftSwapChain.IsValid()) ? 2 : 1;
+			const int64 Faces = LayerDesc.HasShape<FCubemapLayer>() ? 6 : 1;
+			FIntRect CopyRect = FullRect;
+			// Only continuously updated layers copy every frame, which the per image history relies on
+			if (bTracksContentVersion && (LayerDesc.Flags & IStereoLayers::LAYER_FLAG_TEX_CONTINUOUS_UPDATE) && CopyState.IsValid())
+			{
+				// Sub rects map texel to texel only between equally sized single mip 2D textures that are not flipped
+				FRHITexture2D* SrcTexture2D = SrcTexture->GetTexture2D();
+				FRHITexture2D* DstTexture2D = DstTexture->GetTexture2D();
+				const bool bCanCopyPart = SrcTexture2D && DstTexture2D && SrcTexture2D->GetSizeXY() == DstTexture2D->GetSizeXY() && SrcTexture->GetNumMips() == 1 && !bInvertY;
+
+				FIntRect FrameRect;
+				if (bContentDirty)
+				{
+					FrameRect = FullRect;
+					if (bCanCopyPart && !IsRectEmpty(ContentDirtyRect))
+					{
+						FrameRect.Clip(ContentDirtyRect);
+					}
+				}
+
+				CopyRect = CopyState->AddFrame_RenderThread(FrameRect, FullRect, SwapChain->GetSwapChainIndex_RHIThread());
+				if (IsRectEmpty(CopyRect))
+				{
+					CopyState->RecordCopy_RenderThread(0);
+					bTextureNeedUpdate = false;
+					return;
+				}
+				if (bCanCopyPart)
+				{
+					CopyRect.Clip(FullRect);
+					DstRect = SrcRect = CopyRect;
+				}
+				else
+				{
+					CopyRect = FullRect;
+				}
+			}
+			if (CopyState.IsValid())
+			{
+				CopyState->RecordCopy_RenderThread((int64)CopyRect.Area() * GPixelFormats[DstTexture->GetFormat()].BlockBytes * Eyes * Faces);
+			}
+
 			RenderBridge->TransferImage_RenderThread(RHICmdList, DstTexture, SrcTexture, DstRect, SrcRect, true, bNoAlpha, bMRCLayer, bInvertY);
 
 			// Stereo
@@ -473,6 +634,7 @@ bool FPICOXRStereoLayer::InitPXRLayer_RenderThread(const FGameSettings* Settings
 		SwapChain = InLayer->SwapChain;
 		LeftSwapChain = InLayer->LeftSwapChain;
         FoveationSwapChain =InLayer->FoveationSwapChain;
+		CopyState = InLayer->CopyState;
 		bTextureNeedUpdate |= InLayer->bTextureNeedUpdate;
 		bNeedsTexSrgbCreate = InLayer->bNeedsTexSrgbCreate;
 	}
@@ -568,6 +730,7 @@ bool FPICOXRStereoLayer::InitPXRLayer_RenderThread(const FGameSettings* Settings
 				ETextureCreateFlags	TCF = TexCreate_Foveation;
 				FoveationSwapChain = CustomPresent->CreateSwapChain_RenderThread(ID,PxrLayerID, ResourceType, FFRTextureResources, PF_R8G8, FoveationWidth, FoveationHeight, PxrLayerCreateParam.arraySize, 1, 1, Flags, TCF, 1);
 			}	
+			CopyState = MakeShared<FPICOXRLayerCopyState, ESPMode::ThreadSafe>(TextureResources.Num());
 			bTextureNeedUpdate = true;
 		}
 		else
@@ -622,6 +785,7 @@ void FPICOXRStereoLayer::ReleaseResources_RHIThread()
 	SwapChain.Reset();
 	FoveationSwapChain.Reset();
 	LeftSwapChain.Reset();
+	CopyState.Reset();
 	bTextureNeedUpdate = false;
 }
 
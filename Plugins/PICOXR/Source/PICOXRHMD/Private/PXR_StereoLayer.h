@@ -10,6 +10,7 @@
 #include "GameFramework/PlayerController.h"
 #include "PXR_PluginWrapper.h"
 #include "Components/StereoLayerComponent.h"
+#include <atomic>
 #include "PXR_StereoLayer.generated.h"
 
 class FDelayDeleteLayerManager;
@@ -30,6 +31,36 @@ private:
 
 typedef TSharedPtr<FPxrLayer, ESPMode::ThreadSafe> FPxrLayerPtr;
 
+/** Copy bookkeeping of one swapchain, shared by the game, render and RHI thread copies of a layer while they reuse it. */
+class FPICOXRLayerCopyState
+{
+public:
+	explicit FPICOXRLayerCopyState(int32 InNumImages);
+
+	/**
+	 * Records the texels of the source that changed this frame, empty if none, and returns the rect swapchain image
+	 * ImageIndex needs: everything that changed since that image was last written. The runtime picks the image, so
+	 * they are not assumed to rotate in order.
+	 */
+	FIntRect AddFrame_RenderThread(const FIntRect& FrameDirtyRect, const FIntRect& FullRect, int32 ImageIndex);
+
+	void RecordCopy_RenderThread(int64 Bytes);
+
+	/** Forgets what the images hold, for frames the layer was not copied in while the images may have rotated. */
+	void Invalidate_RenderThread() { PendingDirtyRects.Reset(); }
+
+	int32 NumImages;
+	/** What each swapchain image missed since it was last written, by image index. Empty until the first frame. */
+	TArray<FIntRect> PendingDirtyRects;
+
+	std::atomic<int64> BytesCopiedLastFrame{ 0 };
+	std::atomic<int64> BytesCopiedTotal{ 0 };
+	std::atomic<int64> FramesCopied{ 0 };
+	std::atomic<int64> FramesSkipped{ 0 };
+};
+
+typedef TSharedPtr<FPICOXRLayerCopyState, ESPMode::ThreadSafe> FPICOXRLayerCopyStatePtr;
+
 class FPICOXRStereoLayer : public TSharedFromThis<FPICOXRStereoLayer, ESPMode::ThreadSafe>
 {
 public:
@@ -55,6 +86,18 @@ public:
 	void SetEyeLayerDesc(uint32 SizeX, uint32 SizeY, uint32 ArraySize, uint32 NumMips, uint32 NumSamples, FString RHIString,bool EnableSubSampled);
     void PXRLayersCopy_RenderThread(FPICOXRRenderBridge* RenderBridge, FRHICommandListImmediate& RHICmdList);
 	void MarkTextureForUpdate(bool bUpdate = true) { bTextureNeedUpdate = bUpdate; }
+	/**
+	 * Reports the version of the content of LayerDesc.Texture, and which texels changed since the last reported
+	 * version (empty for all). Once a layer reports versions, continuous updates only copy what changed.
+	 */
+	void SetContentVersion(uint64 InVersion, const FIntRect& DirtyRect);
+	void ClearContentDirty() { bContentDirty = false; ContentDirtyRect = FIntRect(); }
+	uint64 GetContentVersion() const { return ContentVersion; }
+	bool TracksContentVersion() const { return bTracksContentVersion; }
+	/** The source renders straight into the swapchain returned by GetAllocatedTexture, nothing is copied. */
+	void SetDirectRender(bool bInDirectRender) { bDirectRender = bInDirectRender; }
+	bool IsDirectRender() const { return bDirectRender; }
+	const FPICOXRLayerCopyStatePtr& GetCopyState() const { return CopyState; }
 	bool InitPXRLayer_RenderThread(const FGameSettings* Settings, FPICOXRRenderBridge* CustomPresent, FDelayDeleteLayerManager* DelayDeletion, FRHICommandListImmediate& RHICmdList, const FPICOXRStereoLayer* InLayer = nullptr);
 	bool IfCanReuseLayers(const FPICOXRStereoLayer* InLayer) const;
 	void ReleaseResources_RHIThread();
@@ -79,6 +122,12 @@ protected:
 	FXRSwapChainPtr LeftSwapChain;
 	FXRSwapChainPtr FoveationSwapChain;
     bool bTextureNeedUpdate;
+	uint64 ContentVersion;
+	FIntRect ContentDirtyRect;
+	bool bContentDirty;
+	bool bTracksContentVersion;
+	bool bDirectRender;
+	FPICOXRLayerCopyStatePtr CopyState;
 	UProceduralMeshComponent* UnderlayMeshComponent;
 	AActor* UnderlayActor;
 	FPxrLayerPtr PxrLayer;
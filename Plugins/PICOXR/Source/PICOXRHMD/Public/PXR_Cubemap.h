@@ -6,9 +6,28 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Containers/Ticker.h"
 #include "PXR_Cubemap.generated.h"
 
 class USceneCaptureComponent2D;
+struct FPXRCubemapJob;
+
+/** How the six faces are laid out in the saved image. */
+enum class EPXRCubemapLayout : uint8
+{
+	Strip,		// Right, left, top, bottom, front, back, side by side
+	Equirect,	// Latitude-longitude, twice as wide as high
+};
+
+/** Saved image format, EXR keeps the HDR scene color for lighting bakes. */
+enum class EPXRCubemapFormat : uint8
+{
+	PNG,
+	EXR,
+};
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FPXRCubemapSavedDelegate, bool /*bSuccess*/, const FString& /*Filename*/);
+
 UCLASS()
 class PICOXRHMD_API APXR_Cubemap : public AActor
 {
@@ -21,6 +40,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	// Called every frame
@@ -31,15 +51,32 @@ public:
 	uint32 CaptureBoxSideRes = 1024;
 	FQuat Orientation = FQuat::Identity;
 	FVector Location = FVector::ZeroVector;
-	EPixelFormat CaptureFormat = PF_A16B16G16R16;
+	EPXRCubemapLayout OutputLayout = EPXRCubemapLayout::Strip;
+	EPXRCubemapFormat OutputFormat = EPXRCubemapFormat::PNG;
 
+	/**
+	 * Captures the six faces and saves them without stalling the game thread: the faces are read back from the GPU
+	 * asynchronously, then laid out, compressed and written on a worker thread. OnCubemapSaved is broadcast on the
+	 * game thread once the file is written. Returns false if a capture is still in progress.
+	 */
 	bool SaveCubeMap_PICO();
 
+	bool IsCapturing() const { return bCapturing; }
+
+	FPXRCubemapSavedDelegate OnCubemapSaved;
+
 private:
-	UPROPERTY()
+	void CreateCaptureComponents();
+	bool PollReadback(float DeltaTime);
+
+	/** Recreated on every capture, never saved with the actor. */
+	UPROPERTY(Transient)
 		TArray<USceneCaptureComponent2D*> CaptureComponents;
 
 	UFUNCTION(BlueprintCallable, CallInEditor, Category = "PXR|PXRHMD")
 		void PXR_CubemapHandler();
 
+	TSharedPtr<FPXRCubemapJob, ESPMode::ThreadSafe> CurrentJob;
+	FTSTicker::FDelegateHandle PollHandle;
+	bool bCapturing = false;
 };
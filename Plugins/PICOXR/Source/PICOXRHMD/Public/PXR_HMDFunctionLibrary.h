@@ -11,6 +11,7 @@
 #include "PXR_HMDFunctionLibrary.generated.h"
 
 class UTexture2D;
+class UTexture;
 
 /* Boundary boundary types*/
 UENUM(BlueprintType)
@@ -760,4 +761,17 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "PXR|PXRHMD")
 	static float PXR_GetTrackingOriginHeight();
+
+	/// <summary>
+	/// Reports that part of a texture shown by continuously updated stereo layers changed. From the first call on,
+	/// those layers copy only the changed area into their swapchain, and nothing in frames without a call.
+	/// Nothing calls this automatically: a widget or scene capture drawing into the texture does not report what it
+	/// redrew, so call it after every change. Layers it is never called for keep copying the whole texture every frame.
+	/// </summary>
+	/// <param name="Texture">The texture of the stereo layers.</param>
+	/// <param name="DirtyMin">Top left texel that changed.</param>
+	/// <param name="DirtyMax">Texel after the bottom right one that changed, equal to DirtyMin for the whole texture.</param>
+	/// <returns>The number of layers showing the texture.</returns>
+	UFUNCTION(BlueprintCallable, Category = "PXR|PXRHMD")
+	static int32 PXR_MarkStereoLayerTextureDirty(UTexture* Texture, FIntPoint DirtyMin, FIntPoint DirtyMax);
 };
@@ -467,7 +467,7 @@ bool FPICOXRInput::GetControllerOrientationAndPosition(const int32 ControllerInd
 	FVector SourcePosition = FVector::ZeroVector;
 	FQuat SourceOrientation = FQuat::Identity;
 	FPXRGameFrame* CurrentFrame = nullptr;
-	FGameSettings* CurrentSettings = nullptr;
+	const FGameSettings* CurrentSettings = nullptr;
 	if (IsInRenderingThread() && PICOXRHMD)
 	{
 		CurrentSettings = PICOXRHMD->GameSettings_RenderThread.Get();
@@ -538,7 +538,7 @@ bool FPICOXRInput::GetPredictedLocationAndRotation(EControllerHand DeviceHand, f
 	FVector SourcePosition = FVector::ZeroVector;
 	FQuat SourceOrientation = FQuat::Identity;
 	FPXRGameFrame* CurrentFrame = nullptr;
-	FGameSettings* CurrentSettings = nullptr;
+	const FGameSettings* CurrentSettings = nullptr;
 
 	if (IsInRenderingThread() && PICOXRHMD)
 	{
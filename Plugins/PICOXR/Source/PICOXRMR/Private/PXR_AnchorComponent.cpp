@@ -43,6 +43,47 @@ UPICOAnchorComponent::UPICOAnchorComponent(const FObjectInitializer& ObjectIniti
 void UPICOAnchorComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	if (bBatchPoseUpdate)
+	{
+		SetComponentTickEnabled(false);
+		FPICOAnchorManager::GetInstance()->RegisterBatchedAnchor(this);
+	}
+	if (AnchorUUID.IsValid())
+	{
+		FPICOAnchorManager::GetInstance()->GetSceneGeometry().OnAnchorRegistered(AnchorUUID);
+	}
+}
+
+void UPICOAnchorComponent::SetAnchorUUID(FPICOAnchorUUID NewAnchorUUID)
+{
+	AnchorUUID = NewAnchorUUID;
+	if (HasBegunPlay() && AnchorUUID.IsValid())
+	{
+		FPICOAnchorManager::GetInstance()->GetSceneGeometry().OnAnchorRegistered(AnchorUUID);
+	}
+}
+
+void UPICOAnchorComponent::SetBatchPoseUpdate(bool bNewBatchPoseUpdate)
+{
+	if (bBatchPoseUpdate == bNewBatchPoseUpdate)
+	{
+		return;
+	}
+
+	bBatchPoseUpdate = bNewBatchPoseUpdate;
+	if (HasBegunPlay())
+	{
+		SetComponentTickEnabled(!bBatchPoseUpdate);
+		if (bBatchPoseUpdate)
+		{
+			FPICOAnchorManager::GetInstance()->RegisterBatchedAnchor(this);
+		}
+		else
+		{
+			FPICOAnchorManager::GetInstance()->UnregisterBatchedAnchor(this);
+		}
+	}
 }
 
 void UPICOAnchorComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
@@ -58,6 +99,7 @@ void UPICOAnchorComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
+	FPICOAnchorManager::GetInstance()->UnregisterBatchedAnchor(this);
 	if (IsAnchorValid())
 	{
 		FPICOAnchorManager::GetInstance()->DestroyAnchorEntity(GetOwner(), nullptr);
@@ -7,6 +7,16 @@
 #include "PXR_PluginWrapper.h"
 #include "PXR_HMDModule.h"
 #include "PXR_HMDPrivate.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarPICOAnchorUpdateThreshold(
+	TEXT("PICO.Anchor.UpdateThreshold"),
+	0.1f,
+	TEXT("Batched anchors only move their actor once the pose moved more than this many centimeters or tenths of a degree (Default 0.1)\n"),
+	ECVF_Default);
 
 FPICOAnchorManager::FPICOAnchorManager()
 {
@@ -44,6 +54,8 @@ void FPICOAnchorManager::Initialize(FPICOXRHMD* InPICOXRHMD)
 	{
 		PXR_LOGI(PxrMR, "FPICOAnchorManager::Initialize Bind PollEvent");
 		HandleOfPollEvent = PICOXRHMD->OnPollEventDelegate().AddRaw(FPICOAnchorManager::GetInstance(), &FPICOAnchorManager::PollEvent);
+		HandleOfWorldPostActorTick = FWorldDelegates::OnWorldPostActorTick.AddRaw(this, &FPICOAnchorManager::OnWorldPostActorTick);
+		SceneGeometry.Initialize();
 	}
 }
 
@@ -54,6 +66,9 @@ void FPICOAnchorManager::Shutdown()
 	{
 		PICOXRHMD->OnPollEventDelegate().Remove(HandleOfPollEvent);
 	}
+	FWorldDelegates::OnWorldPostActorTick.Remove(HandleOfWorldPostActorTick);
+	BatchedAnchors.Empty();
+	SceneGeometry.Shutdown();
 }
 
 void FPICOAnchorManager::PollEvent(PxrEventDataBuffer* EventData)
@@ -586,41 +601,21 @@ bool FPICOAnchorManager::GetAnchorPlanePolygonInfo(AActor* BoundActor, FPICOAnch
 	}
 
 	UPICOAnchorComponent* AnchorComponent = GetAnchorComponent(BoundActor);
-	FPICOAnchor AnchorHandle = AnchorComponent->GetAnchorHandle();
-
-	PxrAnchorPlanePolygonInfo PolygonInfo;
-	PolygonInfo.polygonSizeCapacityInput = 0;
-	PolygonInfo.polygonSizeCountOutput = 0;
-	PolygonInfo.polygonVertices = nullptr;
-	EPICOResult Result = CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorPlanePolygonInfo(AnchorHandle.GetValue(), &PolygonInfo));
-
-	PXR_LOGI(PxrMR, "FPICOAnchorManager::GetAnchorPlanePolygonInfo Call PxrAPI Result[%d], Handle[%llu], VerticesNum[%u]", (int32)Result, (uint64)AnchorHandle.GetValue(), (uint32)PolygonInfo.polygonSizeCountOutput);
-	if (PXR_SUCCESS(Result) && PolygonInfo.polygonSizeCountOutput > 0)
+	FPICOSceneGeometry Uncached;
+	const FPICOSceneGeometry* Geometry = FindSceneGeometry(AnchorComponent, Uncached);
+	if (!Geometry || !Geometry->bHasPlane || Geometry->PlaneVertices.Num() == 0)
 	{
-		PolygonInfo.polygonSizeCapacityInput = PolygonInfo.polygonSizeCountOutput;
-		PxrVector3f* Data = new PxrVector3f[PolygonInfo.polygonSizeCountOutput];
-		PolygonInfo.polygonVertices = Data;
-		EPICOResult DoubleResult = CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorPlanePolygonInfo(AnchorHandle.GetValue(), &PolygonInfo));
-
-		PXR_LOGI(PxrMR, "FPICOAnchorManager::GetAnchorPlanePolygonInfo Double Call PxrAPI Result[%d]", (int32)Result);
-		if (PXR_SUCCESS(DoubleResult))
-		{
-			float WorldToMetersScale = AnchorComponent->GetWorld()->GetWorldSettings()->WorldToMeters;
-
-			OutAnchorPlanePolygonInfo.VerticesNum = PolygonInfo.polygonSizeCountOutput;
-			OutAnchorPlanePolygonInfo.Vertices.SetNum(OutAnchorPlanePolygonInfo.VerticesNum);
-			for (int32 Index = 0; Index < OutAnchorPlanePolygonInfo.VerticesNum; ++Index)
-			{
-				OutAnchorPlanePolygonInfo.Vertices[Index] = ToFVector(Data[Index]) * WorldToMetersScale;
-				PXR_LOGI(PxrMR, "FPICOAnchorManager::GetAnchorPlanePolygonInfo Vertex[%s] for [%d/%d]", *OutAnchorPlanePolygonInfo.Vertices[Index].ToString(), Index, OutAnchorPlanePolygonInfo.VerticesNum);
-			}
-			delete[] Data;
-			return true;
-		}
-		delete[] Data;
+		return false;
 	}
 
-	return false;
+	float WorldToMetersScale = AnchorComponent->GetWorld()->GetWorldSettings()->WorldToMeters;
+	OutAnchorPlanePolygonInfo.VerticesNum = Geometry->PlaneVertices.Num();
+	OutAnchorPlanePolygonInfo.Vertices.SetNum(OutAnchorPlanePolygonInfo.VerticesNum);
+	for (int32 Index = 0; Index < OutAnchorPlanePolygonInfo.VerticesNum; ++Index)
+	{
+		OutAnchorPlanePolygonInfo.Vertices[Index] = Geometry->PlaneVertices[Index] * WorldToMetersScale;
+	}
+	return true;
 }
 
 bool FPICOAnchorManager::GetAnchorVolumeInfo(AActor* BoundActor, FPICOAnchorVolumeInfo& OutAnchorVolumeInfo)
@@ -631,26 +626,111 @@ bool FPICOAnchorManager::GetAnchorVolumeInfo(AActor* BoundActor, FPICOAnchorVolu
 	}
 
 	UPICOAnchorComponent* AnchorComponent = GetAnchorComponent(BoundActor);
-	FPICOAnchor AnchorHandle = AnchorComponent->GetAnchorHandle();
-	PxrAnchorBoxInfo BoxInfo;
-	EPICOResult Result = CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorBoxInfo(AnchorHandle.GetValue(), &BoxInfo));
+	FPICOSceneGeometry Uncached;
+	const FPICOSceneGeometry* Geometry = FindSceneGeometry(AnchorComponent, Uncached);
+	if (!Geometry || !Geometry->bHasVolume)
+	{
+		return false;
+	}
 
-	PXR_LOGI(PxrMR, "FPICOAnchorManager::GetAnchorVolumeInfo Call PxrAPI Result[%d], Handle[%llu]", (int32)Result, (uint64)AnchorHandle.GetValue());
+	float WorldToMetersScale = AnchorComponent->GetWorld()->GetWorldSettings()->WorldToMeters;
+	OutAnchorVolumeInfo.Center = Geometry->VolumeCenter * WorldToMetersScale;
+	OutAnchorVolumeInfo.Extent = Geometry->VolumeExtent * WorldToMetersScale;
+	return true;
+}
+
+bool FPICOAnchorManager::FetchSceneGeometry(uint64_t AnchorHandle, const FPICOAnchorUUID& AnchorUUID, FPICOSceneGeometry& OutGeometry)
+{
+	OutGeometry = FPICOSceneGeometry();
+	OutGeometry.AnchorUUID = AnchorUUID;
+	OutGeometry.AnchorHandle = AnchorHandle;
+
+	PxrAnchorComponentTypeFlags PxrComponentFlags = 0;
+	EPICOResult Result = CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorComponentFlags(AnchorHandle, &PxrComponentFlags));
 	if (PXR_FAILURE(Result))
 	{
+		PXR_LOGI(PxrMR, "FPICOAnchorManager::FetchSceneGeometry Flags Call PxrAPI Result[%d], Handle[%llu]", (int32)Result, (uint64)AnchorHandle);
 		return false;
 	}
 
-	float WorldToMetersScale = AnchorComponent->GetWorld()->GetWorldSettings()->WorldToMeters;
-	OutAnchorVolumeInfo.Center = ToFVector(BoxInfo.center) * WorldToMetersScale;
-	OutAnchorVolumeInfo.Extent.X = BoxInfo.extent.z * WorldToMetersScale;
-	OutAnchorVolumeInfo.Extent.Y = BoxInfo.extent.x * WorldToMetersScale;
-	OutAnchorVolumeInfo.Extent.Z = BoxInfo.extent.y * WorldToMetersScale;
+	if (PxrComponentFlags & PXR_ANCHOR_COMPONENT_TYPE_SCENE_LABEL_BIT_)
+	{
+		PxrSceneLabel SceneLabel;
+		if (PXR_SUCCESS(CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorSceneLabel(AnchorHandle, &SceneLabel))))
+		{
+			OutGeometry.SceneLabel = (EPICOAnchorSceneLabel)SceneLabel;
+		}
+	}
+
+	if (PxrComponentFlags & PXR_ANCHOR_COMPONENT_TYPE_PLANE_BIT_)
+	{
+		PxrAnchorPlaneBoundaryInfo BoundaryInfo;
+		if (PXR_SUCCESS(CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorPlaneBoundaryInfo(AnchorHandle, &BoundaryInfo))))
+		{
+			OutGeometry.PlaneCenter = ToFVector(BoundaryInfo.center);
+			OutGeometry.PlaneExtent = FVector2D(BoundaryInfo.extent.height, BoundaryInfo.extent.width);
+			OutGeometry.bHasPlane = true;
+		}
+
+		PxrAnchorPlanePolygonInfo PolygonInfo;
+		PolygonInfo.polygonSizeCapacityInput = 0;
+		PolygonInfo.polygonSizeCountOutput = 0;
+		PolygonInfo.polygonVertices = nullptr;
+		Result = CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorPlanePolygonInfo(AnchorHandle, &PolygonInfo));
+		if (PXR_SUCCESS(Result) && PolygonInfo.polygonSizeCountOutput > 0)
+		{
+			TArray<PxrVector3f> Data;
+			Data.SetNumUninitialized(PolygonInfo.polygonSizeCountOutput);
+			PolygonInfo.polygonSizeCapacityInput = PolygonInfo.polygonSizeCountOutput;
+			PolygonInfo.polygonVertices = Data.GetData();
+			if (PXR_SUCCESS(CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorPlanePolygonInfo(AnchorHandle, &PolygonInfo))))
+			{
+				OutGeometry.PlaneVertices.Reserve(PolygonInfo.polygonSizeCountOutput);
+				for (uint32 Index = 0; Index < PolygonInfo.polygonSizeCountOutput; ++Index)
+				{
+					OutGeometry.PlaneVertices.Add(ToFVector(Data[Index]));
+				}
+				OutGeometry.bHasPlane = true;
+			}
+		}
+	}
+
+	if (PxrComponentFlags & PXR_ANCHOR_COMPONENT_TYPE_BOX_BIT_)
+	{
+		PxrAnchorBoxInfo BoxInfo;
+		if (PXR_SUCCESS(CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorBoxInfo(AnchorHandle, &BoxInfo))))
+		{
+			OutGeometry.VolumeCenter = ToFVector(BoxInfo.center);
+			OutGeometry.VolumeExtent = FVector(BoxInfo.extent.z, BoxInfo.extent.x, BoxInfo.extent.y);
+			OutGeometry.bHasVolume = true;
+		}
+	}
 
-	PXR_LOGI(PxrMR, "FPICOAnchorManager::GetAnchorVolumeInfo Center[%s], Extent[%s]", *OutAnchorVolumeInfo.Center.ToString(), *OutAnchorVolumeInfo.Extent.ToString());
+	PXR_LOGI(PxrMR, "FPICOAnchorManager::FetchSceneGeometry Handle[%llu], UUID[%s], Label[%d], Plane[%d], Vertices[%d], Volume[%d]", (uint64)AnchorHandle, *AnchorUUID.ToString(),
+		(int32)OutGeometry.SceneLabel, (int32)OutGeometry.bHasPlane, OutGeometry.PlaneVertices.Num(), (int32)OutGeometry.bHasVolume);
 	return true;
 }
 
+const FPICOSceneGeometry* FPICOAnchorManager::FindSceneGeometry(UPICOAnchorComponent* AnchorComponent, FPICOSceneGeometry& OutUncached)
+{
+	const FPICOAnchorUUID AnchorUUID = AnchorComponent->GetAnchorUUID();
+	if (const FPICOSceneGeometry* Cached = AnchorUUID.IsValid() ? SceneGeometry.Find(AnchorUUID) : nullptr)
+	{
+		return Cached;
+	}
+	if (!FetchSceneGeometry(AnchorComponent->GetAnchorHandle().GetValue(), AnchorUUID, OutUncached))
+	{
+		return nullptr;
+	}
+	// Without a UUID there is nothing to key it by, hand out this one copy
+	if (!AnchorUUID.IsValid())
+	{
+		return &OutUncached;
+	}
+	SceneGeometry.Update(MoveTemp(OutUncached));
+	return SceneGeometry.Find(AnchorUUID);
+}
+
 bool FPICOAnchorManager::GetAnchorPose(UPICOAnchorComponent* AnchorComponent, FTransform& OutAnchorPose)
 {
 	if (!IsAnchorValid(AnchorComponent))
@@ -664,7 +744,7 @@ bool FPICOAnchorManager::GetAnchorPose(UPICOAnchorComponent* AnchorComponent, FT
 	FPICOXRHMDModule::GetPluginWrapper().GetTrackingOrigin(&TrackingOrigin);
 
 	PxrPosef AnchorPose;
-	EPICOResult Result = CastToPICOResult(FPICOXRHMDModule::GetPluginWrapper().GetAnchorPose(AnchorHandle.GetValue(), TrackingOrigin, &AnchorPose));
+	EPICOResult Result = CastToPICOResult(QueryAnchorPose(AnchorHandle.GetValue(), TrackingOrigin, &AnchorPose));
 
 	PXR_LOGV(PxrMR, "FPICOAnchorManager::UpdateAnchor Call PxrAPI Result[%d]", (int32)Result);
 	if (PXR_FAILURE(Result))
@@ -699,6 +779,129 @@ bool FPICOAnchorManager::UpdateAnchor(UPICOAnchorComponent* AnchorComponent)
 	return true;
 }
 
+void FPICOAnchorManager::RegisterBatchedAnchor(UPICOAnchorComponent* AnchorComponent)
+{
+	check(IsInGameThread());
+	BatchedAnchors.AddUnique(AnchorComponent);
+	BatchedAnchorsSerial++;
+}
+
+void FPICOAnchorManager::UnregisterBatchedAnchor(UPICOAnchorComponent* AnchorComponent)
+{
+	check(IsInGameThread());
+	BatchedAnchors.RemoveSwap(AnchorComponent);
+	BatchedAnchorsSerial++;
+}
+
+void FPICOAnchorManager::SwapBatchedAnchors(TArray<TWeakObjectPtr<UPICOAnchorComponent>>& Anchors)
+{
+	check(IsInGameThread());
+	Swap(BatchedAnchors, Anchors);
+	BatchedAnchorsSerial++;
+}
+
+void FPICOAnchorManager::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (TickType != LEVELTICK_TimeOnly && IsValid(World) && World->IsGameWorld())
+	{
+		UpdateAnchors(World);
+	}
+}
+
+PxrResult FPICOAnchorManager::QueryAnchorPose(uint64_t AnchorHandle, PxrTrackingOrigin TrackingOrigin, PxrPosef* OutPose) const
+{
+	if (AnchorPoseSource)
+	{
+		return AnchorPoseSource(AnchorHandle, TrackingOrigin, OutPose);
+	}
+	return FPICOXRHMDModule::GetPluginWrapper().GetAnchorPose(AnchorHandle, TrackingOrigin, OutPose);
+}
+
+void FPICOAnchorManager::UpdateAnchors(UWorld* World)
+{
+	check(IsInGameThread());
+	if (!PICOXRHMD || BatchedAnchors.Num() == 0)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// Everything that is the same for all anchors this frame
+	PxrTrackingOrigin TrackingOrigin = PxrTrackingOrigin::PXR_EYE_LEVEL;
+	FPICOXRHMDModule::GetPluginWrapper().GetTrackingOrigin(&TrackingOrigin);
+	const float WorldToMetersScale = World->GetWorldSettings()->WorldToMeters;
+	const FQuat BaseOrientation = PICOXRHMD->GetBaseOrientation();
+	const FVector BaseOffset = PICOXRHMD->GetBaseOffsetInMeters();
+	const FTransform TrackingToWorld = PICOXRHMD->GetTrackingToWorldTransform();
+	const float Threshold = FMath::Max(0.0f, CVarPICOAnchorUpdateThreshold.GetValueOnGameThread());
+	const float ThresholdSquared = FMath::Square(Threshold);
+	const float AngleThreshold = FMath::DegreesToRadians(Threshold * 0.1f);
+
+	int32 Anchors = 0;
+	int32 Queried = 0;
+	int32 Moved = 0;
+	for (int32 Index = BatchedAnchors.Num() - 1; Index >= 0; Index--)
+	{
+		UPICOAnchorComponent* AnchorComponent = BatchedAnchors[Index].Get();
+		if (!AnchorComponent)
+		{
+			BatchedAnchors.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+		if (AnchorComponent->GetWorld() != World)
+		{
+			continue;
+		}
+		Anchors++;
+
+		AActor* BoundActor = AnchorComponent->GetOwner();
+		if (!AnchorComponent->IsAnchorValid() || !IsValid(BoundActor))
+		{
+			continue;
+		}
+
+		PxrPosef AnchorPose;
+		Queried++;
+		if (PXR_FAILURE(CastToPICOResult(QueryAnchorPose(AnchorComponent->GetAnchorHandle().GetValue(), TrackingOrigin, &AnchorPose))))
+		{
+			continue;
+		}
+
+		FPose UnrealPose;
+		ConvertPose_Private(AnchorPose, UnrealPose, BaseOrientation, BaseOffset, WorldToMetersScale);
+		const FVector Location = TrackingToWorld.TransformPosition(UnrealPose.Position);
+		const FQuat Rotation = TrackingToWorld.TransformRotation(UnrealPose.Orientation);
+
+		// Compared with the actor rather than the last pose, so actors moved by anyone else are put back
+		if (FVector::DistSquared(Location, BoundActor->GetActorLocation()) <= ThresholdSquared
+			&& Rotation.AngularDistance(BoundActor->GetActorQuat()) <= AngleThreshold)
+		{
+			continue;
+		}
+		BoundActor->SetActorLocationAndRotation(Location, Rotation);
+		Moved++;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+	UpdateStats.Anchors = Anchors;
+	UpdateStats.Queried = Queried;
+	UpdateStats.Moved = Moved;
+	UpdateStats.Seconds = Seconds;
+	UpdateStats.Frames++;
+	UpdateStats.TotalMoved += Moved;
+	UpdateStats.TotalSeconds += Seconds;
+	UpdateStats.MaxSeconds = FMath::Max(UpdateStats.MaxSeconds, Seconds);
+}
+
+void FPICOAnchorManager::DumpAnchorUpdateStats(FOutputDevice& Ar) const
+{
+	const uint64 Frames = FMath::Max<uint64>(UpdateStats.Frames, 1);
+	Ar.Logf(TEXT("Last frame: %d anchors, %d queried, %d moved, %.3f ms"), UpdateStats.Anchors, UpdateStats.Queried, UpdateStats.Moved, UpdateStats.Seconds * 1000.0);
+	Ar.Logf(TEXT("%llu frames: %.3f ms average, %.3f ms max, %.1f moved per frame"), UpdateStats.Frames, UpdateStats.TotalSeconds * 1000.0 / Frames,
+		UpdateStats.MaxSeconds * 1000.0, double(UpdateStats.TotalMoved) / Frames);
+}
+
 void FPICOAnchorManager::HandleCreateAnchorEntityEvent(uint64_t AsyncTaskId, EPICOResult Result, const FPICOAnchor& AnchorHandle, const FPICOAnchorUUID& AnchorUUID)
 {
 	PXR_LOGI(PxrMR, "FPICOAnchorManager::HandleCreateAnchorEntityEvent Params: AsyncTaskId[%llu], Result[%d], AnchorHandle[%llu], AnchorUUID[%s]", (uint64)AsyncTaskId, (int32)Result, (uint64)AnchorHandle.GetValue(), *AnchorUUID.ToString());
@@ -836,6 +1039,16 @@ void FPICOAnchorManager::HandleLoadAnchorEntityEvent(uint64_t AsyncTaskId, EPICO
 		LoadedAnchors[Index].AnchorHandle = PxrLoadedAnchors[Index].anchor;
 		LoadedAnchors[Index].AnchorUUID = PxrLoadedAnchors[Index].uuid.value;
 	}
+
+	// Copy the scene geometry out once, off the game thread; collision and navmesh for it are built in the background too
+	TArray<TPair<uint64, FPICOAnchorUUID>> SceneAnchors;
+	SceneAnchors.Reserve(LoadedAnchors.Num());
+	for (const FAnchorLoadResult& LoadedAnchor : LoadedAnchors)
+	{
+		SceneAnchors.Emplace(LoadedAnchor.AnchorHandle.GetValue(), LoadedAnchor.AnchorUUID);
+	}
+	SceneGeometry.FetchLoaded(MoveTemp(SceneAnchors), FPlatformTime::Seconds());
+
 	TaskInfo->Delegate.ExecuteIfBound(LoadResult, LoadedAnchors);
 	LoadAnchorsBindings.Remove(AsyncTaskId);
 }
@@ -851,6 +1064,12 @@ void FPICOAnchorManager::HandleStartSpatialSceneCaptureEvent(uint64_t AsyncTaskI
 		return;
 	}
 
+	// The room may have changed, cached geometry is fetched again and whatever changed is rebuilt
+	if (PXR_SUCCESS(Result))
+	{
+		SceneGeometry.Invalidate();
+	}
+
 	TaskInfo->Delegate.ExecuteIfBound(Result, SpatialSceneCaptureStatus);
 	StartSpatialSceneCaptureBindings.Remove(AsyncTaskId);
 }
@@ -919,4 +1138,129 @@ EPICOResult FPICOAnchorManager::CastToPICOResult(PxrResult Result)
 	default:break;
 	}
 	return PICOResult;
-}
\ No newline at end of file
+}
+
+static FAutoConsoleCommandWithOutputDevice CPICOAnchorUpdateStats(
+	TEXT("PICO.Anchor.UpdateStats"),
+	TEXT("Prints how many batched anchors were queried and moved and what it cost"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		FPICOAnchorManager::GetInstance()->DumpAnchorUpdateStats(Ar);
+	}));
+
+#if !UE_BUILD_SHIPPING
+namespace
+{
+	const uint64 FirstBenchmarkHandle = 0x7000000000000000ull;
+
+	/** Stand-in runtime: anchors on a 1 m grid, every twentieth one drifts 5 mm per frame. */
+	struct FSimulatedAnchorRuntime
+	{
+		uint64 Frame = 0;
+
+		PxrResult GetAnchorPose(uint64_t AnchorHandle, PxrTrackingOrigin TrackingOrigin, PxrPosef* OutPose) const
+		{
+			const uint64 Index = AnchorHandle - FirstBenchmarkHandle;
+			OutPose->orientation = PxrQuaternionf{ 0.0f, 0.0f, 0.0f, 1.0f };
+			OutPose->position.x = float(Index % 32);
+			OutPose->position.y = (Index % 20 == 0) ? 0.005f * Frame : 0.0f;
+			OutPose->position.z = -float(Index / 32);
+			return PxrResult::PXR_SUCCESS;
+		}
+	};
+
+	void BenchmarkAnchorUpdate(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!IsValid(World) || !World->IsGameWorld() || !GEngine || !GEngine->XRSystem.IsValid() || GEngine->XRSystem->GetSystemName() != FName(TEXT("PICOXRHMD")))
+		{
+			Ar.Log(TEXT("PICO.Anchor.BenchmarkUpdate needs a game world running on the PICO HMD"));
+			return;
+		}
+		const int32 Frames = Args.Num() > 0 ? FMath::Clamp(FCString::Atoi(*Args[0]), 1, 10000) : 200;
+		TArray<int32> Counts;
+		for (int32 Index = 1; Index < Args.Num(); Index++)
+		{
+			Counts.Add(FMath::Clamp(FCString::Atoi(*Args[Index]), 1, 10000));
+		}
+		if (Counts.Num() == 0)
+		{
+			Counts = { 100, 500, 1000 };
+		}
+
+		FPICOAnchorManager* Manager = FPICOAnchorManager::GetInstance();
+		TSharedRef<FSimulatedAnchorRuntime> Runtime = MakeShared<FSimulatedAnchorRuntime>();
+		Manager->SetAnchorPoseSource([Runtime](uint64_t AnchorHandle, PxrTrackingOrigin TrackingOrigin, PxrPosef* OutPose)
+		{
+			return Runtime->GetAnchorPose(AnchorHandle, TrackingOrigin, OutPose);
+		});
+
+		Ar.Logf(TEXT("%d frames per run, every twentieth anchor moves each frame. Per component runs exclude the component tick dispatch itself."), Frames);
+		Ar.Log(TEXT("Anchors  PerComponent(ms/frame)  Batched(ms/frame)  Moved/frame"));
+
+		// Real anchors would be fed simulated poses too, keep them out of the batch until the runs are done
+		TArray<TWeakObjectPtr<UPICOAnchorComponent>> RealAnchors;
+		Manager->SwapBatchedAnchors(RealAnchors);
+		for (const int32 Count : Counts)
+		{
+			TArray<AActor*> Actors;
+			TArray<UPICOAnchorComponent*> Components;
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				FActorSpawnParameters SpawnParameters;
+				SpawnParameters.ObjectFlags = RF_Transient;
+				AActor* Actor = World->SpawnActor<AActor>(SpawnParameters);
+				USceneComponent* Root = NewObject<USceneComponent>(Actor);
+				Actor->SetRootComponent(Root);
+				Root->RegisterComponent();
+				UPICOAnchorComponent* AnchorComponent = NewObject<UPICOAnchorComponent>(Actor);
+				AnchorComponent->SetAnchorHandle(FPICOAnchor(FirstBenchmarkHandle + Index));
+				AnchorComponent->RegisterComponent();
+				Actors.Add(Actor);
+				Components.Add(AnchorComponent);
+			}
+
+			// Old path: every component queries and moves its actor on its own
+			Runtime->Frame = 0;
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < Frames; Frame++)
+			{
+				Runtime->Frame++;
+				for (UPICOAnchorComponent* AnchorComponent : Components)
+				{
+					Manager->UpdateAnchor(AnchorComponent);
+				}
+			}
+			const double PerComponentSeconds = FPlatformTime::Seconds() - StartTime;
+
+			Runtime->Frame = 0;
+			uint64 Moved = 0;
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < Frames; Frame++)
+			{
+				Runtime->Frame++;
+				Manager->UpdateAnchors(World);
+				Moved += Manager->GetLastUpdateMoved();
+			}
+			const double BatchedSeconds = FPlatformTime::Seconds() - StartTime;
+
+			Ar.Logf(TEXT("%7d  %22.3f  %17.3f  %11.1f"), Count, PerComponentSeconds * 1000.0 / Frames, BatchedSeconds * 1000.0 / Frames, double(Moved) / Frames);
+
+			// No runtime anchor behind these, keep EndPlay from destroying one
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				Components[Index]->SetAnchorHandle(FPICOAnchor(0));
+				Actors[Index]->Destroy();
+			}
+		}
+
+		Manager->SwapBatchedAnchors(RealAnchors);
+		Manager->SetAnchorPoseSource(nullptr);
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CPICOAnchorBenchmarkUpdate(
+	TEXT("PICO.Anchor.BenchmarkUpdate"),
+	TEXT("Spawns temporary anchors fed by a simulated runtime and compares per component pose updates with the batched update.\n")
+	TEXT("Usage: PICO.Anchor.BenchmarkUpdate [Frames=200] [AnchorCounts...=100 500 1000]"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&BenchmarkAnchorUpdate));
+#endif
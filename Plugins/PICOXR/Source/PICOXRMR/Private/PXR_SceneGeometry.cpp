@@ -0,0 +1,643 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#include "PXR_SceneGeometry.h"
+#include "PXR_AnchorManager.h"
+#include "PXR_AnchorComponent.h"
+#include "AI/NavigationSystemBase.h"
+#include "Async/Async.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+static TAutoConsoleVariable<float> CVarPICOSceneGeometryApplyBudget(
+	TEXT("PICO.SceneGeometry.ApplyBudgetMs"),
+	1.0f,
+	TEXT("Game thread time per frame spent attaching rebuilt scene collision to anchor actors (Default 1.0)\n"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarPICOSceneGeometryCollision(
+	TEXT("PICO.SceneGeometry.Collision"),
+	1,
+	TEXT("0: Leave anchor actors without scene collision, colliders already attached are removed as their anchors are applied again\n")
+	TEXT("1: Attach a collision box for each anchor's plane or volume (Default)\n"),
+	ECVF_Default);
+
+namespace
+{
+	// Planes get a collision slab this thick, in meters
+	const float PlaneThickness = 0.02f;
+	// Seconds between apply passes while anchors wait for an actor that registered outside the batched update
+	const double ApplyRetryInterval = 0.25;
+	// Seconds after the fetch the load timing waits for anchor actors that may never be spawned
+	const double LoadTimingTimeout = 10.0;
+	// Seconds an anchor waits for its actor before it is parked until one registers
+	const double ParkTimeout = 10.0;
+
+	/** Polygon normal by Newell's method, robust to a few collinear or slightly bent vertices. */
+	FVector GetPolygonNormal(const TArray<FVector>& Vertices)
+	{
+		FVector Normal = FVector::ZeroVector;
+		for (int32 Index = 0; Index < Vertices.Num(); Index++)
+		{
+			const FVector& A = Vertices[Index];
+			const FVector& B = Vertices[(Index + 1) % Vertices.Num()];
+			Normal.X += (A.Y - B.Y) * (A.Z + B.Z);
+			Normal.Y += (A.Z - B.Z) * (A.X + B.X);
+			Normal.Z += (A.X - B.X) * (A.Y + B.Y);
+		}
+		return Normal.GetSafeNormal();
+	}
+
+	bool IsInTriangle(const FVector2D& P, const FVector2D& A, const FVector2D& B, const FVector2D& C)
+	{
+		return FVector2D::CrossProduct(B - A, P - A) >= 0.0 && FVector2D::CrossProduct(C - B, P - B) >= 0.0 && FVector2D::CrossProduct(A - C, P - C) >= 0.0;
+	}
+
+	/** Ear clipping of a simple polygon given counter clockwise in 2D. */
+	void Triangulate(const TArray<FVector2D>& Points, TArray<int32>& OutIndices)
+	{
+		TArray<int32> Remaining;
+		for (int32 Index = 0; Index < Points.Num(); Index++)
+		{
+			Remaining.Add(Index);
+		}
+
+		int32 Guard = Points.Num() * Points.Num();
+		while (Remaining.Num() > 3 && Guard-- > 0)
+		{
+			bool bClipped = false;
+			for (int32 Index = 0; Index < Remaining.Num(); Index++)
+			{
+				const int32 Prev = Remaining[(Index + Remaining.Num() - 1) % Remaining.Num()];
+				const int32 Curr = Remaining[Index];
+				const int32 Next = Remaining[(Index + 1) % Remaining.Num()];
+				if (FVector2D::CrossProduct(Points[Curr] - Points[Prev], Points[Next] - Points[Curr]) <= 0.0)
+				{
+					continue;
+				}
+				bool bEar = true;
+				for (const int32 Other : Remaining)
+				{
+					if (Other != Prev && Other != Curr && Other != Next && IsInTriangle(Points[Other], Points[Prev], Points[Curr], Points[Next]))
+					{
+						bEar = false;
+						break;
+					}
+				}
+				if (bEar)
+				{
+					OutIndices.Append({ Prev, Curr, Next });
+					Remaining.RemoveAt(Index);
+					bClipped = true;
+					break;
+				}
+			}
+			// Self intersecting or degenerate, fan out what is left
+			if (!bClipped)
+			{
+				break;
+			}
+		}
+		for (int32 Index = 1; Index + 1 < Remaining.Num(); Index++)
+		{
+			OutIndices.Append({ Remaining[0], Remaining[Index], Remaining[Index + 1] });
+		}
+	}
+
+	void BuildPlane(const FPICOSceneGeometry& Geometry, FPICOSceneGeometryBuild& Build)
+	{
+		const TArray<FVector>& Vertices = Geometry.PlaneVertices;
+		const FVector Normal = GetPolygonNormal(Vertices);
+		if (Vertices.Num() < 3 || Normal.IsZero())
+		{
+			return;
+		}
+
+		// In plane axes along the longest edge, which is where a box fits a room plane best
+		FVector Axis = FVector::ZeroVector;
+		for (int32 Index = 0; Index < Vertices.Num(); Index++)
+		{
+			const FVector Edge = FVector::VectorPlaneProject(Vertices[(Index + 1) % Vertices.Num()] - Vertices[Index], Normal);
+			Axis = Edge.SizeSquared() > Axis.SizeSquared() ? Edge : Axis;
+		}
+		const FVector AxisU = Axis.GetSafeNormal();
+		if (AxisU.IsZero())
+		{
+			return;
+		}
+
+		// Newell's normal already makes the polygon counter clockwise around it
+		const FVector AxisV = Normal ^ AxisU;
+		TArray<FVector2D> Points;
+		FBox2D Bounds(ForceInit);
+		for (const FVector& Vertex : Vertices)
+		{
+			Points.Add(FVector2D(Vertex | AxisU, Vertex | AxisV));
+			Bounds += Points.Last();
+		}
+		Build.Vertices = Vertices;
+		Triangulate(Points, Build.Indices);
+
+		const double Offset = Vertices[0] | Normal;
+		const FVector2D Center = Bounds.GetCenter();
+		Build.bHasCollision = true;
+		Build.CollisionTransform = FTransform(FMatrix(AxisU, AxisV, Normal, FVector::ZeroVector).ToQuat(), AxisU * Center.X + AxisV * Center.Y + Normal * Offset);
+		Build.CollisionExtent = FVector(Bounds.GetExtent(), PlaneThickness * 0.5f);
+	}
+
+	void BuildVolume(const FPICOSceneGeometry& Geometry, FPICOSceneGeometryBuild& Build)
+	{
+		const FVector HalfExtent = Geometry.VolumeExtent * 0.5f;
+		for (int32 Corner = 0; Corner < 8; Corner++)
+		{
+			Build.Vertices.Add(Geometry.VolumeCenter + HalfExtent * FVector((Corner & 1) ? 1 : -1, (Corner & 2) ? 1 : -1, (Corner & 4) ? 1 : -1));
+		}
+		// Two triangles per side, counter clockwise around the outward normal like the planes
+		Build.Indices = {
+			0, 2, 1, 1, 2, 3,  4, 5, 6, 5, 7, 6,
+			0, 1, 4, 1, 5, 4,  2, 6, 3, 3, 6, 7,
+			0, 4, 2, 2, 4, 6,  1, 3, 5, 3, 7, 5 };
+		Build.bHasCollision = true;
+		Build.CollisionTransform = FTransform(Geometry.VolumeCenter);
+		Build.CollisionExtent = HalfExtent;
+	}
+}
+
+uint32 FPICOSceneGeometry::GetContentHash() const
+{
+	uint32 Hash = GetTypeHash((uint8)SceneLabel);
+	Hash = HashCombine(Hash, GetTypeHash(bHasPlane));
+	Hash = HashCombine(Hash, GetTypeHash(bHasVolume));
+	Hash = HashCombine(Hash, GetTypeHash(PlaneCenter));
+	Hash = HashCombine(Hash, GetTypeHash(PlaneExtent));
+	Hash = HashCombine(Hash, GetTypeHash(VolumeCenter));
+	Hash = HashCombine(Hash, GetTypeHash(VolumeExtent));
+	for (const FVector& Vertex : PlaneVertices)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Vertex));
+	}
+	return Hash;
+}
+
+FPICOSceneGeometryBuild FPICOSceneGeometryBuild::Build(const FPICOSceneGeometry& Geometry)
+{
+	FPICOSceneGeometryBuild Build;
+	Build.AnchorUUID = Geometry.AnchorUUID;
+	Build.Version = Geometry.Version;
+	// A volume is the better collider where the runtime reports both
+	if (Geometry.bHasVolume)
+	{
+		BuildVolume(Geometry, Build);
+	}
+	else if (Geometry.bHasPlane)
+	{
+		BuildPlane(Geometry, Build);
+	}
+	return Build;
+}
+
+void FPICOSceneGeometryCache::Initialize()
+{
+	if (!TickHandle.IsValid())
+	{
+		TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FPICOSceneGeometryCache::Tick));
+	}
+}
+
+void FPICOSceneGeometryCache::Shutdown()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+	TickHandle.Reset();
+	while (BuildsInFlight.load() > 0 || FetchesInFlight.load() > 0)
+	{
+		FPlatformProcess::Sleep(0.001f);
+	}
+
+	Entries.Empty();
+	Builds.Empty();
+	AppliedVersions.Empty();
+	Colliders.Empty();
+	PendingApply.Empty();
+	Parked.Empty();
+	Completed.Empty();
+	Fetched.Empty();
+	bTimingLoad = false;
+}
+
+bool FPICOSceneGeometryCache::Update(FPICOSceneGeometry&& Geometry)
+{
+	check(IsInGameThread());
+	const uint32 ContentHash = Geometry.GetContentHash();
+	FEntry& Entry = Entries.FindOrAdd(Geometry.AnchorUUID);
+	const bool bKnown = Entry.Geometry.Version > 0;
+	Entry.bStale = false;
+	if (bKnown && Entry.ContentHash == ContentHash)
+	{
+		Entry.Geometry.AnchorHandle = Geometry.AnchorHandle;
+		return false;
+	}
+
+	Geometry.Version = Entry.Geometry.Version + 1;
+	Entry.Geometry = MoveTemp(Geometry);
+	Entry.ContentHash = ContentHash;
+
+	BuildsInFlight++;
+	Async(EAsyncExecution::ThreadPool, [this, Geometry = Entry.Geometry]()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		FPICOSceneGeometryBuild Build = FPICOSceneGeometryBuild::Build(Geometry);
+		{
+			FScopeLock ScopeLock(&CompletedLock);
+			BuildSeconds += FPlatformTime::Seconds() - StartTime;
+			Completed.Add(MoveTemp(Build));
+		}
+		BuildsInFlight--;
+	});
+	return true;
+}
+
+const FPICOSceneGeometry* FPICOSceneGeometryCache::Find(const FPICOAnchorUUID& AnchorUUID) const
+{
+	const FEntry* Entry = Entries.Find(AnchorUUID);
+	return Entry && !Entry->bStale ? &Entry->Geometry : nullptr;
+}
+
+bool FPICOSceneGeometryCache::FindBuild(const FPICOAnchorUUID& AnchorUUID, FPICOSceneGeometryBuild& OutBuild) const
+{
+	const FPICOSceneGeometryBuild* Build = Builds.Find(AnchorUUID);
+	if (Build)
+	{
+		OutBuild = *Build;
+	}
+	return Build != nullptr;
+}
+
+void FPICOSceneGeometryCache::FetchLoaded(TArray<TPair<uint64, FPICOAnchorUUID>>&& Anchors, double LoadTime)
+{
+	Fetch(MoveTemp(Anchors), true, LoadTime);
+}
+
+void FPICOSceneGeometryCache::Invalidate()
+{
+	check(IsInGameThread());
+	TArray<TPair<uint64, FPICOAnchorUUID>> Anchors;
+	for (TPair<FPICOAnchorUUID, FEntry>& Pair : Entries)
+	{
+		Pair.Value.bStale = true;
+		if (Pair.Value.Geometry.AnchorHandle != 0)
+		{
+			Anchors.Emplace(Pair.Value.Geometry.AnchorHandle, Pair.Key);
+		}
+	}
+	// Update clears the stale flag again, and only rebuilds what the capture changed
+	if (Anchors.Num() > 0)
+	{
+		Fetch(MoveTemp(Anchors), false, 0.0);
+	}
+}
+
+void FPICOSceneGeometryCache::OnAnchorRegistered(const FPICOAnchorUUID& AnchorUUID)
+{
+	check(IsInGameThread());
+	if (Parked.Contains(AnchorUUID))
+	{
+		QueueApply(AnchorUUID, FPlatformTime::Seconds());
+	}
+}
+
+void FPICOSceneGeometryCache::Fetch(TArray<TPair<uint64, FPICOAnchorUUID>>&& Anchors, bool bLoad, double LoadTime)
+{
+	check(IsInGameThread());
+	// One task per load, a room's worth of runtime calls is what used to stall the frame
+	FetchesInFlight++;
+	Async(EAsyncExecution::ThreadPool, [this, Anchors = MoveTemp(Anchors), bLoad, LoadTime]()
+	{
+		FFetchBatch Batch;
+		Batch.bLoad = bLoad;
+		Batch.LoadTime = LoadTime;
+		Batch.Geometries.Reserve(Anchors.Num());
+		for (const TPair<uint64, FPICOAnchorUUID>& Anchor : Anchors)
+		{
+			FPICOSceneGeometry Geometry;
+			if (FPICOAnchorManager::FetchSceneGeometry(Anchor.Key, Anchor.Value, Geometry))
+			{
+				Batch.Geometries.Add(MoveTemp(Geometry));
+			}
+		}
+		Batch.FetchedTime = FPlatformTime::Seconds();
+		{
+			FScopeLock ScopeLock(&CompletedLock);
+			Fetched.Add(MoveTemp(Batch));
+		}
+		FetchesInFlight--;
+	});
+}
+
+void FPICOSceneGeometryCache::QueueApply(const FPICOAnchorUUID& AnchorUUID, double Now)
+{
+	Parked.Remove(AnchorUUID);
+	if (!PendingApply.Contains(AnchorUUID))
+	{
+		PendingApply.Add(AnchorUUID, Now);
+	}
+	bApplyPassNeeded = true;
+}
+
+void FPICOSceneGeometryCache::BeginLoadTiming(const TArray<FPICOAnchorUUID>& AnchorUUIDs, double LoadTime, double FetchedTime)
+{
+	LoadTiming = FLoadTiming();
+	LoadTiming.Remaining.Append(AnchorUUIDs);
+	LoadTiming.Anchors = AnchorUUIDs.Num();
+	LoadTiming.LoadTime = LoadTime;
+	LoadTiming.FetchedTime = FetchedTime;
+	bTimingLoad = AnchorUUIDs.Num() > 0;
+
+	// Unchanged geometry is not rebuilt, but its actor may be new. ApplyBuild skips the ones still attached.
+	const double Now = FPlatformTime::Seconds();
+	for (const FPICOAnchorUUID& AnchorUUID : AnchorUUIDs)
+	{
+		if (Builds.Contains(AnchorUUID))
+		{
+			QueueApply(AnchorUUID, Now);
+		}
+	}
+}
+
+bool FPICOSceneGeometryCache::Tick(float DeltaTime)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_PICOSceneGeometryTick);
+
+	TArray<FFetchBatch> NewFetches;
+	TArray<FPICOSceneGeometryBuild> NewBuilds;
+	{
+		FScopeLock ScopeLock(&CompletedLock);
+		NewFetches = MoveTemp(Fetched);
+		NewBuilds = MoveTemp(Completed);
+	}
+	for (FFetchBatch& Batch : NewFetches)
+	{
+		TArray<FPICOAnchorUUID> SceneAnchorUUIDs;
+		for (FPICOSceneGeometry& Geometry : Batch.Geometries)
+		{
+			// Loads bring every kind of anchor, only scene anchors are kept. A refetch also has to see a plane or
+			// volume disappear.
+			if (!Batch.bLoad || Geometry.bHasPlane || Geometry.bHasVolume)
+			{
+				SceneAnchorUUIDs.Add(Geometry.AnchorUUID);
+				Update(MoveTemp(Geometry));
+			}
+		}
+		if (Batch.bLoad)
+		{
+			BeginLoadTiming(SceneAnchorUUIDs, Batch.LoadTime, Batch.FetchedTime);
+		}
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	for (FPICOSceneGeometryBuild& Build : NewBuilds)
+	{
+		const FEntry* Entry = Entries.Find(Build.AnchorUUID);
+		// Superseded by a newer version still on its way
+		if (!Entry || Entry->Geometry.Version != Build.Version)
+		{
+			continue;
+		}
+		BuildsCompleted++;
+		QueueApply(Build.AnchorUUID, Now);
+		Builds.Add(Build.AnchorUUID, MoveTemp(Build));
+	}
+	if (bTimingLoad && LoadTiming.BuiltTime == 0.0 && BuildsInFlight.load() == 0 && NewBuilds.Num() > 0)
+	{
+		LoadTiming.BuiltTime = FPlatformTime::Seconds();
+	}
+
+	// Anchor actors show up whenever gameplay spawns them. Batched ones are noticed right away, anchors that tick on
+	// their own only by looking again every so often. Parked anchors are not looked for, OnAnchorRegistered brings
+	// them back.
+	FPICOAnchorManager* AnchorManager = FPICOAnchorManager::GetInstance();
+	if (AnchorManager->GetBatchedAnchorsSerial() != LastAnchorsSerial)
+	{
+		LastAnchorsSerial = AnchorManager->GetBatchedAnchorsSerial();
+		bApplyPassNeeded = true;
+	}
+	if (PendingApply.Num() > 0 && Now >= NextApplyPassTime)
+	{
+		bApplyPassNeeded = true;
+	}
+
+	if (bApplyPassNeeded && PendingApply.Num() > 0)
+	{
+		bApplyPassNeeded = false;
+		NextApplyPassTime = Now + ApplyRetryInterval;
+		TMap<FPICOAnchorUUID, UPICOAnchorComponent*> AnchorComponents;
+		for (TObjectIterator<UPICOAnchorComponent> It; It; ++It)
+		{
+			UPICOAnchorComponent* AnchorComponent = *It;
+			if (!IsValid(AnchorComponent) || !AnchorComponent->HasBegunPlay() || !AnchorComponent->GetAnchorUUID().IsValid())
+			{
+				continue;
+			}
+			UWorld* World = AnchorComponent->GetWorld();
+			if (World && World->IsGameWorld())
+			{
+				AnchorComponents.Add(AnchorComponent->GetAnchorUUID(), AnchorComponent);
+			}
+		}
+
+		const bool bCollision = CVarPICOSceneGeometryCollision.GetValueOnGameThread() != 0;
+		const double StartTime = FPlatformTime::Seconds();
+		const double Budget = FMath::Max(0.0f, CVarPICOSceneGeometryApplyBudget.GetValueOnGameThread()) / 1000.0;
+		for (TMap<FPICOAnchorUUID, double>::TIterator It = PendingApply.CreateIterator(); It; ++It)
+		{
+			if (FPlatformTime::Seconds() - StartTime > Budget)
+			{
+				bApplyPassNeeded = true;
+				break;
+			}
+			UPICOAnchorComponent** AnchorComponent = AnchorComponents.Find(It.Key());
+			if (!AnchorComponent)
+			{
+				// Gameplay may never spawn an actor for it
+				if (Now - It.Value() > ParkTimeout)
+				{
+					Parked.Add(It.Key());
+					It.RemoveCurrent();
+				}
+				continue;
+			}
+			ApplyBuild(Builds.FindChecked(It.Key()), *AnchorComponent, bCollision && (*AnchorComponent)->bGenerateSceneCollision);
+			if (bTimingLoad && LoadTiming.Remaining.Remove(It.Key()) > 0)
+			{
+				LoadTiming.LastAppliedTime = FPlatformTime::Seconds();
+				if (!LoadTiming.World.IsValid())
+				{
+					LoadTiming.World = (*AnchorComponent)->GetWorld();
+				}
+			}
+			It.RemoveCurrent();
+		}
+		MaxApplySliceSeconds = FMath::Max(MaxApplySliceSeconds, FPlatformTime::Seconds() - StartTime);
+	}
+
+	if (bTimingLoad)
+	{
+		UpdateLoadTiming(LoadTiming.World.Get());
+	}
+	return true;
+}
+
+void FPICOSceneGeometryCache::ApplyBuild(const FPICOSceneGeometryBuild& Build, UPICOAnchorComponent* AnchorComponent, bool bCollision)
+{
+	AActor* BoundActor = AnchorComponent->GetOwner();
+	if (!IsValid(BoundActor) || !IsValid(AnchorComponent->GetWorld()))
+	{
+		return;
+	}
+	TWeakObjectPtr<UBoxComponent>& Collider = Colliders.FindOrAdd(Build.AnchorUUID);
+	if (!bCollision || !Build.bHasCollision)
+	{
+		if (Collider.IsValid())
+		{
+			Collider->DestroyComponent();
+		}
+		Colliders.Remove(Build.AnchorUUID);
+		AppliedVersions.Add(Build.AnchorUUID, Build.Version);
+		return;
+	}
+
+	const uint32* AppliedVersion = AppliedVersions.Find(Build.AnchorUUID);
+	if (AppliedVersion && *AppliedVersion == Build.Version && Collider.IsValid() && Collider->GetOwner() == BoundActor)
+	{
+		return;
+	}
+	AppliedVersions.Add(Build.AnchorUUID, Build.Version);
+
+	if (!Collider.IsValid() || Collider->GetOwner() != BoundActor)
+	{
+		UBoxComponent* Box = NewObject<UBoxComponent>(BoundActor, MakeUniqueObjectName(BoundActor, UBoxComponent::StaticClass(), TEXT("PICOSceneCollision")), RF_Transient);
+		if (USceneComponent* Root = BoundActor->GetRootComponent())
+		{
+			Box->SetupAttachment(Root);
+		}
+		else
+		{
+			BoundActor->SetRootComponent(Box);
+		}
+		Box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Box->SetCanEverAffectNavigation(true);
+		Box->RegisterComponent();
+		Collider = Box;
+	}
+
+	const float WorldToMetersScale = AnchorComponent->GetWorld()->GetWorldSettings()->WorldToMeters;
+	FTransform Transform = Build.CollisionTransform;
+	Transform.ScaleTranslation(WorldToMetersScale);
+	if (Collider.Get() != BoundActor->GetRootComponent())
+	{
+		Collider->SetRelativeTransform(Transform);
+	}
+	Collider->SetBoxExtent(Build.CollisionExtent * WorldToMetersScale);
+	// Dirties just the navmesh tiles under the old and new bounds
+	FNavigationSystem::UpdateComponentData(*Collider.Get());
+	CollidersApplied++;
+}
+
+void FPICOSceneGeometryCache::UpdateLoadTiming(UWorld* World)
+{
+	const double Now = FPlatformTime::Seconds();
+	if (LoadTiming.AppliedTime == 0.0)
+	{
+		if (LoadTiming.Remaining.Num() > 0)
+		{
+			if (Now - LoadTiming.FetchedTime < LoadTimingTimeout)
+			{
+				return;
+			}
+			// Gameplay never spawned an actor for these, time the ones it did and stop looking for them
+			LoadTiming.Unspawned = LoadTiming.Remaining.Num();
+			for (const FPICOAnchorUUID& AnchorUUID : LoadTiming.Remaining)
+			{
+				if (PendingApply.Remove(AnchorUUID) > 0)
+				{
+					Parked.Add(AnchorUUID);
+				}
+			}
+			LoadTiming.Remaining.Reset();
+		}
+		LoadTiming.AppliedTime = LoadTiming.LastAppliedTime > 0.0 ? LoadTiming.LastAppliedTime : Now;
+		LoadTiming.AppliedFrame = GFrameCounter;
+		if (LoadTiming.BuiltTime == 0.0)
+		{
+			LoadTiming.BuiltTime = LoadTiming.AppliedTime;
+		}
+	}
+
+	// The navigation system only picks up the dirtied tiles on its next tick, which may come before or after this
+	// ticker within a frame
+	if (GFrameCounter <= LoadTiming.AppliedFrame + 1)
+	{
+		return;
+	}
+	UNavigationSystemBase* NavigationSystem = World ? World->GetNavigationSystem() : nullptr;
+	if (NavigationSystem && NavigationSystem->IsNavigationBuildInProgress())
+	{
+		return;
+	}
+	LoadTiming.NavigableTime = Now;
+	bTimingLoad = false;
+
+	PXR_LOGI(PxrMR, "FPICOSceneGeometryCache %d anchors navigable %.1f ms after load: fetch %.1f ms, build %.1f ms, collision %.1f ms, navmesh %.1f ms",
+		LoadTiming.Anchors, (LoadTiming.NavigableTime - LoadTiming.LoadTime) * 1000.0, (LoadTiming.FetchedTime - LoadTiming.LoadTime) * 1000.0,
+		(LoadTiming.BuiltTime - LoadTiming.FetchedTime) * 1000.0, (LoadTiming.AppliedTime - LoadTiming.BuiltTime) * 1000.0,
+		(LoadTiming.NavigableTime - LoadTiming.AppliedTime) * 1000.0);
+	if (LoadTiming.Unspawned > 0)
+	{
+		PXR_LOGI(PxrMR, "FPICOSceneGeometryCache %d loaded anchors never got an actor and are not included", LoadTiming.Unspawned);
+	}
+}
+
+void FPICOSceneGeometryCache::Dump(FOutputDevice& Ar) const
+{
+	int32 Stale = 0;
+	for (const TPair<FPICOAnchorUUID, FEntry>& Pair : Entries)
+	{
+		Stale += Pair.Value.bStale ? 1 : 0;
+	}
+	double TotalBuildSeconds = 0.0;
+	{
+		FScopeLock ScopeLock(&CompletedLock);
+		TotalBuildSeconds = BuildSeconds;
+	}
+	Ar.Logf(TEXT("%d anchors cached (%d stale), %d built, %d waiting for their actor, %d parked, %d fetches and %d builds in flight"),
+		Entries.Num(), Stale, Builds.Num(), PendingApply.Num(), Parked.Num(), FetchesInFlight.load(), BuildsInFlight.load());
+	Ar.Logf(TEXT("%llu builds, %.3f ms average on the thread pool, %llu colliders applied, %.3f ms longest apply slice"),
+		BuildsCompleted, BuildsCompleted > 0 ? TotalBuildSeconds * 1000.0 / BuildsCompleted : 0.0, CollidersApplied, MaxApplySliceSeconds * 1000.0);
+	if (LoadTiming.NavigableTime > 0.0)
+	{
+		Ar.Logf(TEXT("Last load: %d anchors navigable after %.1f ms (fetch %.1f, build %.1f, collision %.1f, navmesh %.1f)"), LoadTiming.Anchors,
+			(LoadTiming.NavigableTime - LoadTiming.LoadTime) * 1000.0, (LoadTiming.FetchedTime - LoadTiming.LoadTime) * 1000.0,
+			(LoadTiming.BuiltTime - LoadTiming.FetchedTime) * 1000.0, (LoadTiming.AppliedTime - LoadTiming.BuiltTime) * 1000.0,
+			(LoadTiming.NavigableTime - LoadTiming.AppliedTime) * 1000.0);
+		if (LoadTiming.Unspawned > 0)
+		{
+			Ar.Logf(TEXT("%d loaded anchors never got an actor and are not included"), LoadTiming.Unspawned);
+		}
+	}
+	else if (bTimingLoad)
+	{
+		Ar.Logf(TEXT("Load in progress: %d of %d anchors still without collision"), LoadTiming.Remaining.Num(), LoadTiming.Anchors);
+	}
+}
+
+static FAutoConsoleCommandWithOutputDevice CPICOSceneGeometryStats(
+	TEXT("PICO.SceneGeometry.Stats"),
+	TEXT("Prints the scene geometry cache, its background builds and how long the last anchor load took to become navigable"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		FPICOAnchorManager::GetInstance()->GetSceneGeometry().Dump(Ar);
+	}));
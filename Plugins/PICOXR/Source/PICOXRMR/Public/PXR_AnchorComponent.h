@@ -52,7 +52,7 @@ public:
 	bool IsAnchorValid() const { return AnchorHandle.IsValid(); }
 
 	UFUNCTION(BlueprintCallable, Category = "PXR|MR")
-	void SetAnchorUUID(FPICOAnchorUUID NewAnchorUUID) { AnchorUUID = NewAnchorUUID; }
+	void SetAnchorUUID(FPICOAnchorUUID NewAnchorUUID);
 
 	UFUNCTION(BlueprintCallable, Category = "PXR|MR")
 	FPICOAnchorUUID GetAnchorUUID() const { return AnchorUUID; }
@@ -60,6 +60,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "PXR|MR")
 	FString GetAnchorUUIDString() const {return AnchorUUID.ToString(); }
 
+	/** Switches between the batched pose update and ticking, also while playing. */
+	UFUNCTION(BlueprintCallable, Category = "PXR|MR")
+	void SetBatchPoseUpdate(bool bNewBatchPoseUpdate);
+
+	/** Let the anchor manager move the owner together with all other anchors once per frame instead of ticking. Change with SetBatchPoseUpdate. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PXR|MR")
+	bool bBatchPoseUpdate = true;
+
+	/** Let the scene geometry cache attach a collision box for the anchor's plane or volume to the owner. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "PXR|MR")
+	bool bGenerateSceneCollision = true;
+
 protected:
 	FPICOAnchor AnchorHandle;
 	FPICOAnchorUUID AnchorUUID;
@@ -10,6 +10,7 @@
 #include "PXR_HMD.h"
 #include "PXR_MRTypes.h"
 #include "PXR_AnchorComponent.h"
+#include "PXR_SceneGeometry.h"
 
 DECLARE_DELEGATE_TwoParams(FPICOCreateAnchorEntityDelegate, EPICOResult, UPICOAnchorComponent*);
 DECLARE_DELEGATE_OneParam(FPICODestroyAnchorEntityDelegate, EPICOResult);
@@ -56,6 +57,26 @@ public:
 	bool GetAnchorPose(UPICOAnchorComponent* AnchorComponent, FTransform& OutAnchorPose);
 	bool UpdateAnchor(UPICOAnchorComponent* AnchorComponent);
 
+	void RegisterBatchedAnchor(UPICOAnchorComponent* AnchorComponent);
+	void UnregisterBatchedAnchor(UPICOAnchorComponent* AnchorComponent);
+	/** Exchanges the batched anchors with Anchors, so a benchmark can update only its own. */
+	void SwapBatchedAnchors(TArray<TWeakObjectPtr<UPICOAnchorComponent>>& Anchors);
+	/** Moves the owners of all batched anchors in World that moved more than PICO.Anchor.UpdateThreshold, once per frame. */
+	void UpdateAnchors(UWorld* World);
+	void DumpAnchorUpdateStats(FOutputDevice& Ar) const;
+	int32 GetLastUpdateMoved() const { return UpdateStats.Moved; }
+	const TArray<TWeakObjectPtr<UPICOAnchorComponent>>& GetBatchedAnchors() const { return BatchedAnchors; }
+	/** Changes whenever a batched anchor is registered or unregistered. */
+	uint32 GetBatchedAnchorsSerial() const { return BatchedAnchorsSerial; }
+
+	FPICOSceneGeometryCache& GetSceneGeometry() { return SceneGeometry; }
+	/** Copies the anchor's scene components out of the runtime. Touches no manager state, so the cache calls it from the thread pool. */
+	static bool FetchSceneGeometry(uint64_t AnchorHandle, const FPICOAnchorUUID& AnchorUUID, FPICOSceneGeometry& OutGeometry);
+
+	typedef TFunction<PxrResult(uint64_t, PxrTrackingOrigin, PxrPosef*)> FAnchorPoseSource;
+	/** Reads anchor poses from Source instead of the runtime, an unbound Source restores the runtime. */
+	void SetAnchorPoseSource(FAnchorPoseSource Source) { AnchorPoseSource = MoveTemp(Source); }
+
 private:
 	FPICOAnchorManager();
 	~FPICOAnchorManager();
@@ -90,6 +111,11 @@ private:
 	void HandleLoadAnchorEntityEvent(uint64_t AsyncTaskId, EPICOResult Result, uint32_t AnchorCount, EPICOPersistLocation PersistLocation);
 	void HandleStartSpatialSceneCaptureEvent(uint64_t AsyncTaskId, EPICOResult Result, EPICOSpatialSceneCaptureStatus SpatialSceneCaptureStatus);
 
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	PxrResult QueryAnchorPose(uint64_t AnchorHandle, PxrTrackingOrigin TrackingOrigin, PxrPosef* OutPose) const;
+	/** From the cache, fetched on a miss. OutUncached holds it when the anchor has no UUID to cache it by. */
+	const FPICOSceneGeometry* FindSceneGeometry(UPICOAnchorComponent* AnchorComponent, FPICOSceneGeometry& OutUncached);
+
 	bool IsAnchorValid(AActor* BoundActor);
 	bool IsAnchorValid(UPICOAnchorComponent* AnchorComponent);
 	UPICOAnchorComponent* GetAnchorComponent(AActor* BoundActor);
@@ -97,7 +123,7 @@ private:
 private:
 	FPICOXRHMD* PICOXRHMD;
 
-	EPICOResult CastToPICOResult(PxrResult Result);
+	static EPICOResult CastToPICOResult(PxrResult Result);
 
 	struct FAnchorCreateInfo
 	{
@@ -146,4 +172,23 @@ private:
 	TMap<uint64_t, FStartSpatialSceneCaptureInfo> StartSpatialSceneCaptureBindings;
 
 	FDelegateHandle HandleOfPollEvent;
+	FDelegateHandle HandleOfWorldPostActorTick;
+
+	TArray<TWeakObjectPtr<UPICOAnchorComponent>> BatchedAnchors;
+	uint32 BatchedAnchorsSerial = 0;
+	FPICOSceneGeometryCache SceneGeometry;
+	FAnchorPoseSource AnchorPoseSource;
+
+	struct FAnchorUpdateStats
+	{
+		int32 Anchors = 0;
+		int32 Queried = 0;
+		int32 Moved = 0;
+		double Seconds = 0.0;
+		uint64 Frames = 0;
+		uint64 TotalMoved = 0;
+		double TotalSeconds = 0.0;
+		double MaxSeconds = 0.0;
+	};
+	FAnchorUpdateStats UpdateStats;
 };
\ No newline at end of file
@@ -0,0 +1,155 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "PXR_MRTypes.h"
+#include <atomic>
+
+class UBoxComponent;
+class UPICOAnchorComponent;
+
+/** Scene geometry of one anchor as the runtime reported it. Anchor space, meters, Unreal axes. */
+struct PICOXRMR_API FPICOSceneGeometry
+{
+	FPICOAnchorUUID AnchorUUID;
+	EPICOAnchorSceneLabel SceneLabel = EPICOAnchorSceneLabel::SceneLabel_Unknown;
+
+	bool bHasPlane = false;
+	FVector PlaneCenter = FVector::ZeroVector;
+	FVector2D PlaneExtent = FVector2D::ZeroVector;
+	TArray<FVector> PlaneVertices;
+
+	bool bHasVolume = false;
+	FVector VolumeCenter = FVector::ZeroVector;
+	/** Full size, not half. */
+	FVector VolumeExtent = FVector::ZeroVector;
+
+	/** Bumped whenever a refresh from the runtime changed any of the above. */
+	uint32 Version = 0;
+	/** Runtime handle it was fetched through, to fetch it again after a scene capture. Not part of the content. */
+	uint64 AnchorHandle = 0;
+
+	uint32 GetContentHash() const;
+};
+
+/** What the background pipeline makes of one FPICOSceneGeometry. Anchor space, meters. */
+struct PICOXRMR_API FPICOSceneGeometryBuild
+{
+	FPICOAnchorUUID AnchorUUID;
+	uint32 Version = 0;
+
+	TArray<FVector> Vertices;
+	TArray<int32> Indices;
+
+	bool bHasCollision = false;
+	FTransform CollisionTransform;
+	FVector CollisionExtent = FVector::ZeroVector;
+
+	/** Triangulates the plane polygon or the volume and fits a collision box around it. */
+	static FPICOSceneGeometryBuild Build(const FPICOSceneGeometry& Geometry);
+};
+
+/**
+ * Scene geometry keyed by anchor UUID, so it is copied out of the runtime once per load or scene capture instead of
+ * on every query. Loads and captures fetch it on the thread pool.
+ *
+ * Every version that changed is triangulated and fitted with a collision box on the thread pool. The results are
+ * handed to the game thread and attached to the anchor actors in slices of at most PICO.SceneGeometry.ApplyBudgetMs
+ * per frame. Only changed anchors get their collider touched, so the navigation system only rebuilds the navmesh
+ * tiles they overlap. PICO.SceneGeometry.Collision and UPICOAnchorComponent::bGenerateSceneCollision opt out.
+ * Anchors whose actor does not show up within a few seconds are parked until one registers for them.
+ */
+class PICOXRMR_API FPICOSceneGeometryCache
+{
+public:
+	void Initialize();
+	void Shutdown();
+
+	/** Stores Geometry and queues a rebuild if it differs from the cached version. Returns true when it changed. */
+	bool Update(FPICOSceneGeometry&& Geometry);
+	/** Null when the anchor was never fetched or the scene was captured again since. */
+	const FPICOSceneGeometry* Find(const FPICOAnchorUUID& AnchorUUID) const;
+	bool FindBuild(const FPICOAnchorUUID& AnchorUUID, FPICOSceneGeometryBuild& OutBuild) const;
+	/**
+	 * Fetches the loaded anchors on the thread pool and stores the ones with a plane or volume. Once stored they are
+	 * queued for another apply pass, their actors may have been respawned since, and it is timed how long it takes
+	 * until they have collision and the navmesh is built. Anchors whose actor is not spawned within a few seconds are
+	 * left out of the timing.
+	 */
+	void FetchLoaded(TArray<TPair<uint64, FPICOAnchorUUID>>&& Anchors, double LoadTime);
+	/** After a new scene capture: marks everything stale and fetches it again, anchors that changed are rebuilt. */
+	void Invalidate();
+	/** Queues a parked anchor again once a component with its UUID has begun play. */
+	void OnAnchorRegistered(const FPICOAnchorUUID& AnchorUUID);
+	void Dump(FOutputDevice& Ar) const;
+
+private:
+	bool Tick(float DeltaTime);
+	void Fetch(TArray<TPair<uint64, FPICOAnchorUUID>>&& Anchors, bool bLoad, double LoadTime);
+	void BeginLoadTiming(const TArray<FPICOAnchorUUID>& AnchorUUIDs, double LoadTime, double FetchedTime);
+	void QueueApply(const FPICOAnchorUUID& AnchorUUID, double Now);
+	void ApplyBuild(const FPICOSceneGeometryBuild& Build, UPICOAnchorComponent* AnchorComponent, bool bCollision);
+	void UpdateLoadTiming(UWorld* World);
+
+	struct FEntry
+	{
+		FPICOSceneGeometry Geometry;
+		uint32 ContentHash = 0;
+		bool bStale = false;
+	};
+	TMap<FPICOAnchorUUID, FEntry> Entries;
+	TMap<FPICOAnchorUUID, FPICOSceneGeometryBuild> Builds;
+	TMap<FPICOAnchorUUID, uint32> AppliedVersions;
+	TMap<FPICOAnchorUUID, TWeakObjectPtr<UBoxComponent>> Colliders;
+	/** Anchors waiting for their actor, and since when. */
+	TMap<FPICOAnchorUUID, double> PendingApply;
+	/** Waited too long for their actor, left out of the apply passes until OnAnchorRegistered. */
+	TSet<FPICOAnchorUUID> Parked;
+	bool bApplyPassNeeded = false;
+	uint32 LastAnchorsSerial = 0;
+	double NextApplyPassTime = 0.0;
+
+	// Written by the thread pool
+	mutable FCriticalSection CompletedLock;
+	TArray<FPICOSceneGeometryBuild> Completed;
+	std::atomic<int32> BuildsInFlight{ 0 };
+	struct FFetchBatch
+	{
+		TArray<FPICOSceneGeometry> Geometries;
+		bool bLoad = false;
+		double LoadTime = 0.0;
+		double FetchedTime = 0.0;
+	};
+	TArray<FFetchBatch> Fetched;
+	std::atomic<int32> FetchesInFlight{ 0 };
+
+	FTSTicker::FDelegateHandle TickHandle;
+
+	struct FLoadTiming
+	{
+		TSet<FPICOAnchorUUID> Remaining;
+		int32 Anchors = 0;
+		double LoadTime = 0.0;
+		double FetchedTime = 0.0;
+		double BuiltTime = 0.0;
+		double AppliedTime = 0.0;
+		double NavigableTime = 0.0;
+		double LastAppliedTime = 0.0;
+		uint64 AppliedFrame = 0;
+		/** Anchors whose actor never showed up before the timing gave up on them. */
+		int32 Unspawned = 0;
+		TWeakObjectPtr<UWorld> World;
+	};
+	FLoadTiming LoadTiming;
+	bool bTimingLoad = false;
+
+	uint64 BuildsCompleted = 0;
+	uint64 CollidersApplied = 0;
+	// Under CompletedLock
+	double BuildSeconds = 0.0;
+	double MaxApplySliceSeconds = 0.0;
+};
@@ -0,0 +1,194 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#include "PXR_MRCCaptureScheduler.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "RenderingThread.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarPICOMRCBackgroundRate(
+	TEXT("PICO.MRC.BackgroundRate"),
+	30.0f,
+	TEXT("Captures per second of the MRC background layer, 0 for every frame\n"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarPICOMRCForegroundRate(
+	TEXT("PICO.MRC.ForegroundRate"),
+	30.0f,
+	TEXT("Captures per second of the MRC foreground layer, 0 for every frame\n"),
+	ECVF_Default);
+
+namespace
+{
+	// Frame pacing jitter tolerated before a capture counts as late for its slot
+	const double CaptureSlack = 0.002;
+
+	const TCHAR* LayerNames[] = { TEXT("Background"), TEXT("Foreground") };
+
+	float GetCaptureRate(FPICOXRMRCCaptureScheduler::ELayer Layer)
+	{
+		return Layer == FPICOXRMRCCaptureScheduler::Background ? CVarPICOMRCBackgroundRate.GetValueOnGameThread() : CVarPICOMRCForegroundRate.GetValueOnGameThread();
+	}
+}
+
+FPICOXRMRCCaptureScheduler::FPICOXRMRCCaptureScheduler()
+	: RenderState(MakeShared<FRenderState, ESPMode::ThreadSafe>())
+{
+	Reset();
+}
+
+bool FPICOXRMRCCaptureScheduler::ConsumeIfDue(ELayer Layer, double Now)
+{
+	const float Rate = GetCaptureRate(Layer);
+	if (Rate != ScheduledRate[Layer])
+	{
+		// Start over rather than wait out a slot of the old rate
+		ScheduledRate[Layer] = Rate;
+		NextCaptureTime[Layer] = 0.0;
+	}
+	if (Rate <= 0.0f)
+	{
+		return true;
+	}
+
+	const double Interval = 1.0 / Rate;
+	if (NextCaptureTime[Layer] <= 0.0)
+	{
+		NextCaptureTime[Layer] = Now;
+		if (Layer == Foreground && NextCaptureTime[Background] > 0.0 && ScheduledRate[Background] > 0.0f)
+		{
+			// Half a background period off its slots, so at equal rates the two layers never capture on the same frame
+			const double Start = NextCaptureTime[Background] - 0.5 / ScheduledRate[Background];
+			NextCaptureTime[Layer] = Start + FMath::Max(0.0, FMath::CeilToDouble((Now - Start) / Interval)) * Interval;
+		}
+	}
+	if (Now + CaptureSlack < NextCaptureTime[Layer])
+	{
+		return false;
+	}
+
+	// Keep the cadence and its phase, but do not try to catch up on slots missed by a long frame
+	NextCaptureTime[Layer] += Interval;
+	if (NextCaptureTime[Layer] + CaptureSlack < Now)
+	{
+		NextCaptureTime[Layer] += FMath::CeilToDouble((Now - CaptureSlack - NextCaptureTime[Layer]) / Interval) * Interval;
+	}
+	return true;
+}
+
+void FPICOXRMRCCaptureScheduler::SkipDue(double Now, bool bForeground)
+{
+	for (int32 Layer = 0; Layer < NumLayers; Layer++)
+	{
+		if ((Layer != Foreground || bForeground) && ConsumeIfDue((ELayer)Layer, Now))
+		{
+			RenderState->Stats[Layer].Skipped++;
+		}
+	}
+}
+
+void FPICOXRMRCCaptureScheduler::Capture(ELayer Layer, USceneCaptureComponent2D* CaptureComponent)
+{
+	check(IsInGameThread());
+	if (!CaptureComponent)
+	{
+		return;
+	}
+
+	FRenderState* State = &RenderState.Get();
+	ENQUEUE_RENDER_COMMAND(PXRMRCCaptureBegin)([RenderState = RenderState, Layer](FRHICommandListImmediate& RHICmdList)
+	{
+		RenderState->Begin_RenderThread(Layer, RHICmdList);
+	});
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	CaptureComponent->CaptureScene();
+	State->Stats[Layer].GameThreadCycles += FPlatformTime::Cycles64() - StartCycles;
+	State->Stats[Layer].Captures++;
+
+	ENQUEUE_RENDER_COMMAND(PXRMRCCaptureEnd)([RenderState = RenderState, Layer](FRHICommandListImmediate& RHICmdList)
+	{
+		RenderState->End_RenderThread(Layer, RHICmdList);
+	});
+}
+
+void FPICOXRMRCCaptureScheduler::Reset()
+{
+	for (int32 Layer = 0; Layer < NumLayers; Layer++)
+	{
+		NextCaptureTime[Layer] = 0.0;
+		ScheduledRate[Layer] = -1.0f;
+	}
+}
+
+void FPICOXRMRCCaptureScheduler::Dump(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Layer       Rate(Hz)  Captures  Skipped  GameThread(ms)  RenderThread(ms)  GPU(ms)"));
+	for (int32 Layer = 0; Layer < NumLayers; Layer++)
+	{
+		const FLayerStats& Stats = RenderState->Stats[Layer];
+		const int64 Captures = Stats.Captures;
+		const int64 GpuSamples = Stats.GpuSamples;
+		const double GameThreadMs = Captures > 0 ? FPlatformTime::ToMilliseconds64(Stats.GameThreadCycles) / Captures : 0.0;
+		const double RenderThreadMs = Captures > 0 ? FPlatformTime::ToMilliseconds64(Stats.RenderThreadCycles) / Captures : 0.0;
+		const FString GpuMs = GpuSamples > 0 ? FString::Printf(TEXT("%7.2f"), Stats.GpuMicroseconds / 1000.0 / GpuSamples) : FString(TEXT("    n/a"));
+		Ar.Logf(TEXT("%-10s  %8.1f  %8lld  %7lld  %14.2f  %16.2f  %s"), LayerNames[Layer], GetCaptureRate((ELayer)Layer),
+			Captures, (int64)Stats.Skipped, GameThreadMs, RenderThreadMs, *GpuMs);
+	}
+}
+
+void FPICOXRMRCCaptureScheduler::FRenderState::Begin_RenderThread(ELayer Layer, FRHICommandListImmediate& RHICmdList)
+{
+	RenderThreadStart[Layer] = FPlatformTime::Cycles64();
+
+	ResolveGpuTimings_RenderThread(Layer);
+	if (!GSupportsTimestampRenderQueries)
+	{
+		return;
+	}
+
+	FGpuTiming& Timing = GpuTimings[Layer][NextGpuTiming[Layer]];
+	if (Timing.bPending)
+	{
+		// Every slot is still in flight, leave this capture untimed
+		return;
+	}
+	if (!Timing.Begin.IsValid())
+	{
+		Timing.Begin = RHICreateRenderQuery(RQT_AbsoluteTime);
+		Timing.End = RHICreateRenderQuery(RQT_AbsoluteTime);
+	}
+	RHICmdList.EndRenderQuery(Timing.Begin);
+}
+
+void FPICOXRMRCCaptureScheduler::FRenderState::End_RenderThread(ELayer Layer, FRHICommandListImmediate& RHICmdList)
+{
+	Stats[Layer].RenderThreadCycles += FPlatformTime::Cycles64() - RenderThreadStart[Layer];
+
+	FGpuTiming& Timing = GpuTimings[Layer][NextGpuTiming[Layer]];
+	if (GSupportsTimestampRenderQueries && Timing.Begin.IsValid() && !Timing.bPending)
+	{
+		RHICmdList.EndRenderQuery(Timing.End);
+		Timing.bPending = true;
+		NextGpuTiming[Layer] = (NextGpuTiming[Layer] + 1) % NumGpuTimings;
+	}
+}
+
+void FPICOXRMRCCaptureScheduler::FRenderState::ResolveGpuTimings_RenderThread(ELayer Layer)
+{
+	for (FGpuTiming& Timing : GpuTimings[Layer])
+	{
+		uint64 BeginMicroseconds = 0;
+		uint64 EndMicroseconds = 0;
+		if (Timing.bPending && RHIGetRenderQueryResult(Timing.End, EndMicroseconds, false) && RHIGetRenderQueryResult(Timing.Begin, BeginMicroseconds, false))
+		{
+			if (EndMicroseconds >= BeginMicroseconds)
+			{
+				Stats[Layer].GpuMicroseconds += EndMicroseconds - BeginMicroseconds;
+				Stats[Layer].GpuSamples++;
+			}
+			Timing.bPending = false;
+		}
+	}
+}
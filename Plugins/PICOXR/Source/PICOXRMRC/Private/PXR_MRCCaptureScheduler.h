@@ -0,0 +1,85 @@
+// Copyright® 2015-2023 PICO Technology Co., Ltd. All rights reserved.
+// This plugin incorporates portions of the Unreal® Engine. Unreal® is a trademark or registered trademark of Epic Games, Inc. in the United States of America and elsewhere.
+// Unreal® Engine, Copyright 1998 – 2023, Epic Games, Inc. All rights reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI.h"
+#include <atomic>
+
+class USceneCaptureComponent2D;
+
+/**
+ * Decides which MRC layers are captured each tick and measures what the captures cost.
+ *
+ * Each layer has its own capture rate (PICO.MRC.BackgroundRate, PICO.MRC.ForegroundRate). The foreground runs half a
+ * period behind the background, so at equal rates the two captures land on different frames. Captures run immediately
+ * through USceneCaptureComponent2D::CaptureScene, bracketed by render commands that time the render thread and,
+ * where timestamp queries are supported, the GPU.
+ */
+class FPICOXRMRCCaptureScheduler
+{
+public:
+	enum ELayer
+	{
+		Background,
+		Foreground,
+		NumLayers
+	};
+
+	FPICOXRMRCCaptureScheduler();
+
+	/** Whether Layer is due at Now, in FPlatformTime::Seconds. Consumes the slot if it is. */
+	bool ConsumeIfDue(ELayer Layer, double Now);
+
+	/** Counts the layers that were due but not captured because nothing consumes the frames. */
+	void SkipDue(double Now, bool bForeground);
+
+	void Capture(ELayer Layer, USceneCaptureComponent2D* CaptureComponent);
+
+	/** Drops the schedule, the next tick starts a new one. A layer is also rescheduled when its rate changes. */
+	void Reset();
+
+	void Dump(FOutputDevice& Ar) const;
+
+private:
+	struct FLayerStats
+	{
+		std::atomic<int64> Captures{ 0 };
+		std::atomic<int64> Skipped{ 0 };
+		std::atomic<int64> GameThreadCycles{ 0 };
+		std::atomic<int64> RenderThreadCycles{ 0 };
+		std::atomic<int64> GpuMicroseconds{ 0 };
+		std::atomic<int64> GpuSamples{ 0 };
+	};
+
+	/** Timestamp queries of one capture, reused once resolved. */
+	struct FGpuTiming
+	{
+		FRenderQueryRHIRef Begin;
+		FRenderQueryRHIRef End;
+		bool bPending = false;
+	};
+
+	/** Render thread part, outlives the scheduler until the render commands that use it ran. */
+	struct FRenderState
+	{
+		static constexpr int32 NumGpuTimings = 4;
+
+		FLayerStats Stats[NumLayers];
+		FGpuTiming GpuTimings[NumLayers][NumGpuTimings];
+		int32 NextGpuTiming[NumLayers] = {};
+		uint64 RenderThreadStart[NumLayers] = {};
+
+		void Begin_RenderThread(ELayer Layer, FRHICommandListImmediate& RHICmdList);
+		void End_RenderThread(ELayer Layer, FRHICommandListImmediate& RHICmdList);
+		void ResolveGpuTimings_RenderThread(ELayer Layer);
+	};
+
+	TSharedRef<FRenderState, ESPMode::ThreadSafe> RenderState;
+	/** 0 while the layer is not scheduled. */
+	double NextCaptureTime[NumLayers];
+	/** The rate NextCaptureTime was scheduled with. */
+	float ScheduledRate[NumLayers];
+};
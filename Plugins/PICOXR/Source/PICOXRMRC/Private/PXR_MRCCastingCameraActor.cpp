@@ -32,6 +32,7 @@ APICOXRMRC_CastingCameraActor::APICOXRMRC_CastingCameraActor(const FObjectInitia
 	,bEnableForeground(true)
 	,ForegroundMaxDistance(300.f)
 	,bHasInitializedInGameCamOnce(false)
+	,MRCLayerContentVersion(0)
 	,MRState(nullptr)
 	,M_MRC(nullptr)
 	,MI_Background(nullptr)
@@ -42,6 +43,11 @@ APICOXRMRC_CastingCameraActor::APICOXRMRC_CastingCameraActor(const FObjectInitia
 	
 	ForegroundCaptureActor = NULL;
 
+	// Captures are issued by CaptureScheduler
+	GetCaptureComponent2D()->bCaptureEveryFrame = false;
+	GetCaptureComponent2D()->bCaptureOnMovement = false;
+	GetCaptureComponent2D()->bAlwaysPersistRenderingState = true;
+
 	static ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> BGRef(TEXT("TextureRenderTarget2D'/PICOXR/Textures/MRCRT_BG.MRCRT_BG'"));
 	BackgroundRenderTarget = BGRef.Object;
 	check(BackgroundRenderTarget != nullptr);
@@ -78,8 +84,6 @@ void APICOXRMRC_CastingCameraActor::Tick(float DeltaTime)
 	if (bHasInitializedInGameCamOnce)
 	{
 		SetMRCTrackingReference();
-		UpdateInGameCamPose();
-		UpdateCamMatrixAndDepth();
 			
 		if (bEnableForeground&&!ForegroundCaptureActor)
 		{
@@ -88,30 +92,44 @@ void APICOXRMRC_CastingCameraActor::Tick(float DeltaTime)
 		else if(!bEnableForeground&&ForegroundCaptureActor)
 		{
 			DestroyForeroundCaptureActor();
-			if (!GetCaptureComponent2D()->IsVisible())
-			{
-				GetCaptureComponent2D()->SetVisibility(true);
-			}
 		}
-		
-		if (ForegroundCaptureActor && GetCaptureComponent2D()->IsVisible())
+
+		const double Now = FPlatformTime::Seconds();
+		if (!FPICOXRMRCModule::Get().IsCastingConsumingFrames())
 		{
-			ForegroundCaptureActor->GetCaptureComponent2D()->TextureTarget = ForegroundRenderTarget;
-			GetCaptureComponent2D()->SetVisibility(false);
-			ForegroundCaptureActor->GetCaptureComponent2D()->SetVisibility(true);
-			
+			CaptureScheduler.SkipDue(Now, ForegroundCaptureActor != nullptr);
+			return;
+		}
+
+		const bool bCaptureBackground = CaptureScheduler.ConsumeIfDue(FPICOXRMRCCaptureScheduler::Background, Now);
+		const bool bCaptureForeground = ForegroundCaptureActor && CaptureScheduler.ConsumeIfDue(FPICOXRMRCCaptureScheduler::Foreground, Now);
+		if (!bCaptureBackground && !bCaptureForeground)
+		{
+			return;
 		}
-		else if (ForegroundCaptureActor && ForegroundCaptureActor->GetCaptureComponent2D()->IsVisible())
+
+		// Pose, calibration and projections are worked out once and shared by both captures
+		UpdateInGameCamPose();
+		UpdateCamMatrixAndDepth();
+
+		if (bCaptureBackground)
 		{
-			GetCaptureComponent2D()->TextureTarget = BackgroundRenderTarget;
-			ForegroundCaptureActor->GetCaptureComponent2D()->SetVisibility(false);
-			GetCaptureComponent2D()->SetVisibility(true);
+			CaptureScheduler.Capture(FPICOXRMRCCaptureScheduler::Background, GetCaptureComponent2D());
 		}
-		else if (!ForegroundCaptureActor && !GetCaptureComponent2D()->IsVisible())
+		if (bCaptureForeground)
 		{
-			GetCaptureComponent2D()->SetVisibility(true);
+			CaptureScheduler.Capture(FPICOXRMRCCaptureScheduler::Foreground, ForegroundCaptureActor->GetCaptureComponent2D());
 		}
+		MarkMRCLayerUpdated();
+	}
+}
 
+void APICOXRMRC_CastingCameraActor::MarkMRCLayerUpdated()
+{
+	FPICOXRHMD* PICOXRHMD = FPICOXRMRCModule::GetPICOXRHMD();
+	if (PICOXRHMD && PICOXRHMD->CurrentMRCLayer.IsValid())
+	{
+		PICOXRHMD->SetLayerContentVersion(PICOXRHMD->CurrentMRCLayer->GetID(), ++MRCLayerContentVersion);
 	}
 }
 
@@ -127,7 +145,10 @@ void APICOXRMRC_CastingCameraActor::SpawnForegroundCaptureActor()
 		PXR_LOGI(LogMRC, "Begin Spawn Forground MRC Capture Actor!");
 		ForegroundCaptureActor = GetWorld()->SpawnActor<ASceneCapture2D>();
 		ForegroundCaptureActor->GetCaptureComponent2D()->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
-		ForegroundCaptureActor->GetCaptureComponent2D()->SetVisibility(false);
+		ForegroundCaptureActor->GetCaptureComponent2D()->TextureTarget = ForegroundRenderTarget;
+		ForegroundCaptureActor->GetCaptureComponent2D()->bCaptureEveryFrame = false;
+		ForegroundCaptureActor->GetCaptureComponent2D()->bCaptureOnMovement = false;
+		ForegroundCaptureActor->GetCaptureComponent2D()->bAlwaysPersistRenderingState = true;
 		ForegroundCaptureActor->GetCaptureComponent2D()->MaxViewDistanceOverride = ForegroundMaxDistance;
 		float x = MRState->TrackedCamera.Width;
 		float y = MRState->TrackedCamera.Height;
@@ -148,6 +169,7 @@ void APICOXRMRC_CastingCameraActor::DestroyForeroundCaptureActor()
 		}
 		ForegroundCaptureActor->Destroy();
 		ForegroundCaptureActor = nullptr;
+		MarkMRCLayerUpdated();
 	}
 }
 
@@ -201,7 +223,7 @@ void APICOXRMRC_CastingCameraActor::UpdateInGameCamPose()
 	}
 	else
 	{
-		FPICOXRMRCModule::Get().GetMRCCalibrationData(MRState->TrackedCamera);
+		FPICOXRMRCModule::Get().GetCachedMRCCalibrationData(MRState->TrackedCamera);
 
 		if (FPICOXRMRCModule::Get().PICOXRHMD && !bHasInitializedInGameCamOnce || MRState->bUpdateMRCCameraZ)
 		{
@@ -304,7 +326,8 @@ void APICOXRMRC_CastingCameraActor::InitializeRTSize()
 
 void APICOXRMRC_CastingCameraActor::InitializeInGameCam()
 {
-	FPICOXRMRCModule::Get().GetMRCCalibrationData(MRState->TrackedCamera);
+	FPICOXRMRCModule::Get().GetCachedMRCCalibrationData(MRState->TrackedCamera);
+	CaptureScheduler.Reset();
 
 	SetMRCTrackingReference();
 
@@ -316,6 +339,7 @@ void APICOXRMRC_CastingCameraActor::InitializeInGameCam()
 	
 		// LDR for gamma correction and post process
 		GetCaptureComponent2D()->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
+		GetCaptureComponent2D()->TextureTarget = BackgroundRenderTarget;
 		float x = MRState->TrackedCamera.Width;
 		float y = MRState->TrackedCamera.Height;
 		GetCaptureComponent2D()->FOVAngle = MRState->TrackedCamera.FOV * (x / y);
@@ -8,6 +8,7 @@
 #include "UObject/ObjectMacros.h"
 #include "Engine/SceneCapture2D.h"
 #include "PXR_MRCModule.h"
+#include "PXR_MRCCaptureScheduler.h"
 #include "PXR_MRCCastingCameraActor.generated.h"
 
 class UPXRInGameThirdCamState;
@@ -42,6 +43,8 @@ public:
 	UTextureRenderTarget2D* ForegroundRenderTarget;
 
 	bool bEnableForeground;
+
+	FPICOXRMRCCaptureScheduler CaptureScheduler;
 private:
 	
 	void InitializeInGameCam();
@@ -51,9 +54,12 @@ private:
 	void UpdateCamMatrixAndDepth();
 	void SpawnForegroundCaptureActor();
 	void DestroyForeroundCaptureActor();
+	/** Tells the HMD the MRC layer textures changed, so the layer is copied this frame. */
+	void MarkMRCLayerUpdated();
 
 	float ForegroundMaxDistance;
 	bool bHasInitializedInGameCamOnce;
+	uint64 MRCLayerContentVersion;
 
 private:
 	UPROPERTY()
@@ -31,6 +31,9 @@ FPICOXRMRCModule::FPICOXRMRCModule()
 	, WorldAddedDelegate()
 	, WorldDestroyedDelegate()
 	, WorldLoadDelegate()
+	, bCachedCalibrationValid(false)
+	, bCachedCalibrationFromRuntime(false)
+	, bSupportMovingMrc(false)
 #if PLATFORM_ANDROID
 	, bCpture2DActorActivated(false)
 #endif
@@ -131,6 +134,59 @@ bool FPICOXRMRCModule::GetMRCCalibrationData(FPXRTrackedCamera& CameraState)
 	return false;
 }
 
+bool FPICOXRMRCModule::GetCachedMRCCalibrationData(FPXRTrackedCamera& CameraState)
+{
+	if (!bCachedCalibrationValid || bSupportMovingMrc)
+	{
+		bCachedCalibrationFromRuntime = GetMRCCalibrationData(CachedCalibration);
+		bCachedCalibrationValid = true;
+	}
+	CameraState = CachedCalibration;
+	return bCachedCalibrationFromRuntime;
+}
+
+void FPICOXRMRCModule::InvalidateMRCCalibration()
+{
+	bCachedCalibrationValid = false;
+}
+
+bool FPICOXRMRCModule::IsCastingConsumingFrames() const
+{
+#if PLATFORM_ANDROID
+	// The MRC layer is only submitted with the rest of a rendered frame
+	if (PICOXRHMD && PICOXRHMD->CurrentMRCLayer.IsValid() && (PICOXRHMD->MRCEnabled || bSimulateEnableMRC))
+	{
+		const bool bPaused = PICOXRHMD->GameSettings.IsValid() && PICOXRHMD->GameSettings->Flags.bPauseRendering;
+		const bool bSplashShown = PICOXRHMD->GetSplash().IsValid() && PICOXRHMD->GetSplash()->IsShown();
+		return !bPaused && !bSplashShown;
+	}
+#endif
+	return false;
+}
+
+void FPICOXRMRCModule::DumpCaptureStats(FOutputDevice& Ar) const
+{
+	if (InGameThirdCam && IsValid(InGameThirdCam))
+	{
+		InGameThirdCam->CaptureScheduler.Dump(Ar);
+	}
+	else
+	{
+		Ar.Logf(TEXT("MRC capture is not active"));
+	}
+}
+
+static FAutoConsoleCommandWithOutputDevice CPICOMRCCaptureStats(
+	TEXT("PICO.MRC.CaptureStats"),
+	TEXT("Prints the rate and the game thread, render thread and GPU cost per capture of each MRC layer"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Ar)
+	{
+		if (FPICOXRMRCModule::IsAvailable())
+		{
+			FPICOXRMRCModule::Get().DumpCaptureStats(Ar);
+		}
+	}));
+
 bool FPICOXRMRCModule::GetMRCRT(UTextureRenderTarget2D*& Background_RT, UTextureRenderTarget2D*& Forground_RT)
 {
 #if PLATFORM_ANDROID
@@ -232,6 +288,7 @@ void FPICOXRMRCModule::ResetInGameThirdCamState()
 void FPICOXRMRCModule::OnWorldCreated(UWorld* NewWorld)
 {
 	ResetInGameThirdCamState();
+	InvalidateMRCCalibration();
 #if PLATFORM_ANDROID
 	PXR_LOGI(LogMRC, "OnWorldCreated Delegates!");
 	CurrentWorld = NewWorld;
@@ -294,11 +351,13 @@ bool FPICOXRMRCModule::ReadCameraRawDataFromXML()
 			{
 				PXR_LOGI(LogMRC, "CurrentVersion:%d SetIsSupportMovingMrc to true!", CurrentVersion);
 				FPICOXRHMDModule::GetPluginWrapper().SetIsSupportMovingMrc(true);
+				bSupportMovingMrc = true;
 	}
 			FPICOXRHMDModule::GetPluginWrapper().SetMrcPose(&Newpose);
 			FPICOXRHMDModule::GetPluginWrapper().SetConfigUint64(PxrConfigType::PXR_MRC_TEXTURE_WIDTH, RawCameraDateFromXML.width);
 			FPICOXRHMDModule::GetPluginWrapper().SetConfigUint64(PxrConfigType::PXR_MRC_TEXTURE_HEIGHT, RawCameraDateFromXML.height);
 			RawCameraDateFromXML.refreshed = true;
+			InvalidateMRCCalibration();
 			return true;
 		}
 #endif
@@ -323,6 +382,7 @@ void FPICOXRMRCModule::SwitchCaptureActive()
 		if (!bCpture2DActorActivated)
 		{
 			PXR_LOGI(LogMRC, "Activating MRC Capture");
+			InvalidateMRCCalibration();
 			OpenInGameCam();
 			bCpture2DActorActivated = true;
 		}
@@ -394,6 +454,7 @@ void FPICOXRMRCModule::OnInitialWorldCreated(UWorld* NewWorld)
 void FPICOXRMRCModule::OnTrackingOriginChanged(const IXRTrackingSystem* TrackingSys)
 {
 	UpdateZCounter = 2;
+	InvalidateMRCCalibration();
 }
 
 #undef LOCTEXT_NAMESPACE
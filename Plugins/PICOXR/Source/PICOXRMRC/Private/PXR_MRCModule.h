@@ -9,6 +9,7 @@
 #include "Engine/EngineBaseTypes.h"
 #include "IPXR_MRCModule.h"
 #include "PXR_Log.h"
+#include "PXR_MRCState.h"
 
 const int MRCSupportVersion = 0x2000300;
 
@@ -16,7 +17,6 @@ class UTextureRenderTarget2D;
 class FPICOXRHMD;
 class UPXRInGameThirdCamState;
 class APICOXRMRC_CastingCameraActor;
-struct FPXRTrackedCamera;
 
 struct FRawCameraDataFromXML
 {
@@ -57,6 +57,20 @@ public:
 	/** Obtain calibration data */
 	bool GetMRCCalibrationData(FPXRTrackedCamera & CameraState);
 
+	/**
+	 * Calibration data as of the last query. The runtime is queried again only after InvalidateMRCCalibration, or on
+	 * every call if it supports a moving MRC camera.
+	 */
+	bool GetCachedMRCCalibrationData(FPXRTrackedCamera & CameraState);
+
+	/** Called when casting starts, the tracking origin changes or a world is created. */
+	void InvalidateMRCCalibration();
+
+	/** Whether casting takes the MRC layer this frame, captures are wasted otherwise. */
+	bool IsCastingConsumingFrames() const;
+
+	void DumpCaptureStats(FOutputDevice& Ar) const;
+
 	bool GetMRCRT(UTextureRenderTarget2D* &Background_RT,UTextureRenderTarget2D* &Forground_RT);
 
 	void EnableForeground(bool enable);
@@ -73,6 +87,10 @@ private:
 	FDelegateHandle WorldDestroyedDelegate;
 	FDelegateHandle WorldLoadDelegate;
 	FRawCameraDataFromXML RawCameraDateFromXML;
+	FPXRTrackedCamera CachedCalibration;
+	bool bCachedCalibrationValid;
+	bool bCachedCalibrationFromRuntime;
+	bool bSupportMovingMrc;
 #if PLATFORM_ANDROID
     PxrPosef MRCPose;
 #endif
@@ -2,16 +2,33 @@
 #include "Kismet/KismetSystemLibrary.h"
 #include "Kismet/GameplayStatics.h"
 #include "Haptics/HapticFeedbackEffect_Base.h"
+#include "GameFramework/Pawn.h"
+#include "Net/UnrealNetwork.h"
+#include "VRAvatarPose.h"
+#include "VRCharacter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVRGrab, Log, All);
 
 UGrabComponent::UGrabComponent()
 {
-	PrimaryComponentTick.bCanEverTick = false;
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	SetIsReplicatedByDefault(true);
 
 	mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("StaticMesh"));
 }
 
 void UGrabComponent::BeginPlay()
 {
+	Super::BeginPlay();
+}
+
+void UGrabComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UGrabComponent, grabState);
 }
 
 bool UGrabComponent::TryGrab(UMotionControllerComponent* motionControllerComponent)
@@ -30,25 +47,343 @@ bool UGrabComponent::TryGrab(UMotionControllerComponent* motionControllerCompone
 		true
 	);
 
+	handSamples.Reset();
+	isCorrecting = false;
+	UpdateTickEnabled();
+
 	return isAttached;
 }
 
 void UGrabComponent::TryRelease()
 {
 	//UKismetSystemLibrary::PrintString(GetWorld(), L"Release", true, true, FLinearColor::Green);
-	UPrimitiveComponent* primComponent = Cast<UPrimitiveComponent>(GetAttachParent());
-	primComponent->SetSimulatePhysics(true);
+	FVector linearVelocity;
+	FVector angularVelocity;
+	EstimateVelocity(linearVelocity, angularVelocity);
+
+	Detach();
+
+	UPrimitiveComponent* primComponent = GetGrabbedPrimitive();
+	primComponent->SetPhysicsLinearVelocity(linearVelocity);
+	primComponent->SetPhysicsAngularVelocityInDegrees(angularVelocity);
+}
+
+bool UGrabComponent::PredictGrab(APawn* holder, UMotionControllerComponent* motionControllerComponent)
+{
+	// Somebody else already holds it as far as we know; don't bother the server.
+	if (IsValid(grabState.holder) && grabState.holder != holder) return false;
+
+	if (!TryGrab(motionControllerComponent)) return false;
+
+	BeginPrediction(holder);
+	return true;
+}
+
+FVRGrabReleaseSnapshot UGrabComponent::PredictRelease()
+{
+	FVector linearVelocity;
+	FVector angularVelocity;
+	EstimateVelocity(linearVelocity, angularVelocity);
+
+	TryRelease();
+
+	const FTransform transform = GetGrabbedPrimitive()->GetComponentTransform();
+
+	FVRGrabReleaseSnapshot snapshot;
+	snapshot.location = transform.GetLocation();
+	snapshot.rotation = VRAvatarPose::CompressRotation(transform.GetRotation());
+	snapshot.linearVelocity = linearVelocity;
+	snapshot.angularVelocity = angularVelocity;
+
+	BeginPrediction(nullptr);
+
+	return snapshot;
+}
+
+uint8 UGrabComponent::GetPredictionId() const
+{
+	return lastPredictionId;
+}
+
+void UGrabComponent::BeginPrediction(APawn* holder)
+{
+	predictedHolder = holder;
+	hasPendingPrediction = true;
+	predictionTime = GetWorld()->GetTimeSeconds();
+	++lastPredictionId;
+	UpdateTickEnabled();
+}
+
+bool UGrabComponent::ResolvePrediction(uint8 predictionId, bool accepted, uint8 epoch)
+{
+	if (!hasPendingPrediction || predictionId != lastPredictionId) return false;
+
+	hasPendingPrediction = false;
+	UpdateTickEnabled();
+
+	if (accepted)
+	{
+		// The replicated state either matches our prediction or is on its way. Only a state that moved on past
+		// our request (someone grabbed it right after we let go) needs applying now.
+		if (static_cast<int8>(grabState.epoch - epoch) > 0)
+		{
+			ApplyGrabState(true);
+		}
+		return true;
+	}
+
+	UE_LOG(LogVRGrab, Verbose, TEXT("%s: predicted %s rejected by server, correcting"),
+		*GetOwner()->GetName(), IsValid(predictedHolder) ? TEXT("grab") : TEXT("release"));
+
+	ApplyGrabState(true);
+	return true;
+}
+
+void UGrabComponent::AbandonPrediction()
+{
+	UE_LOG(LogVRGrab, Verbose, TEXT("%s: no answer to predicted %s, following replicated state"),
+		*GetOwner()->GetName(), IsValid(predictedHolder) ? TEXT("grab") : TEXT("release"));
+
+	// A late answer is ignored; if the server did accept, the replicated state brings the object back.
+	hasPendingPrediction = false;
+	UpdateTickEnabled();
+	ApplyGrabState(true);
+}
+
+bool UGrabComponent::IsWithinReach(const APawn* requester, bool isLeftHand, const FVector& location) const
+{
+	const AVRCharacter* character = Cast<AVRCharacter>(requester);
+	const UMotionControllerComponent* hand = character ? character->GetMotionController(isLeftHand) : nullptr;
+	return hand && FVector::Dist(hand->GetComponentLocation(), location) <= maxGrabDistance;
+}
+
+bool UGrabComponent::ServerTryGrab(APawn* requester, bool isLeftHand, const FVector& gripLocation, uint32 gripRotation)
+{
+	if (!IsValid(requester)) return false;
+	if (IsValid(grabState.holder) && grabState.holder != requester) return false;
+
+	// The client only tells us which object and where in its hand; check both against the server's view.
+	UPrimitiveComponent* primComponent = GetGrabbedPrimitive();
+	if (!IsValid(primComponent) || !IsActive()) return false;
+	if (gripLocation.Size() > maxGrabDistance || !IsWithinReach(requester, isLeftHand, primComponent->GetComponentLocation()))
+	{
+		UE_LOG(LogVRGrab, Verbose, TEXT("%s: grab by %s out of reach"), *GetOwner()->GetName(), *requester->GetName());
+		return false;
+	}
+
+	grabState.holder = requester;
+	grabState.isLeftHand = isLeftHand;
+	grabState.gripLocation = gripLocation;
+	grabState.gripRotation = gripRotation;
+	++grabState.epoch;
+
+	// While held the holder's client drives the object through its hand pose, so the server stops
+	// replicating movement and hands net ownership to the holder.
+	AActor* owner = GetOwner();
+	owner->SetReplicateMovement(false);
+	owner->SetOwner(requester);
+
+	if (!requester->IsLocallyControlled())
+	{
+		ApplyGrabState(false);
+	}
+
+	return true;
+}
+
+bool UGrabComponent::ServerTryRelease(APawn* requester, const FVRGrabReleaseSnapshot& snapshot)
+{
+	if (!IsValid(requester) || grabState.holder != requester) return false;
+
+	// The object has to leave the hand where the hand is, and no faster than anyone can throw.
+	if (!requester->IsLocallyControlled() && !IsWithinReach(requester, grabState.isLeftHand, snapshot.location))
+	{
+		UE_LOG(LogVRGrab, Verbose, TEXT("%s: release by %s out of reach"), *GetOwner()->GetName(), *requester->GetName());
+		return false;
+	}
+
+	grabState.holder = nullptr;
+	++grabState.epoch;
+
+	if (!requester->IsLocallyControlled())
+	{
+		Detach();
+
+		UPrimitiveComponent* primComponent = GetGrabbedPrimitive();
+		primComponent->SetWorldLocationAndRotation(snapshot.location, VRAvatarPose::DecompressRotation(snapshot.rotation), false, nullptr, ETeleportType::TeleportPhysics);
+		primComponent->SetPhysicsLinearVelocity(FVector(snapshot.linearVelocity).GetClampedToMaxSize(maxThrowSpeed));
+		primComponent->SetPhysicsAngularVelocityInDegrees(FVector(snapshot.angularVelocity).GetClampedToMaxSize(maxThrowAngularSpeed));
+	}
+
+	AActor* owner = GetOwner();
+	owner->SetOwner(nullptr);
+	owner->SetReplicateMovement(true);
 
-	GetAttachParent()->K2_DetachFromComponent
+	return true;
+}
+
+FTransform UGrabComponent::GetGripTransform() const
+{
+	const USceneComponent* parent = GetAttachParent();
+	const USceneComponent* hand = parent ? parent->GetAttachParent() : nullptr;
+	if (!hand) return FTransform::Identity;
+
+	return parent->GetComponentTransform().GetRelativeTransform(hand->GetComponentTransform());
+}
+
+APawn* UGrabComponent::GetHolder() const
+{
+	return grabState.holder;
+}
+
+uint8 UGrabComponent::GetEpoch() const
+{
+	return grabState.epoch;
+}
+
+void UGrabComponent::OnRep_GrabState()
+{
+	// This may predate our request even when it looks like what we predicted; the tagged answer settles it.
+	if (hasPendingPrediction) return;
+
+	ApplyGrabState(true);
+}
+
+UPrimitiveComponent* UGrabComponent::GetGrabbedPrimitive() const
+{
+	return Cast<UPrimitiveComponent>(GetAttachParent());
+}
+
+UMotionControllerComponent* UGrabComponent::GetHolderHand(const FVRGrabState& state) const
+{
+	const AVRCharacter* character = Cast<AVRCharacter>(state.holder);
+	return character ? character->GetMotionController(state.isLeftHand) : nullptr;
+}
+
+void UGrabComponent::ApplyGrabState(bool smooth)
+{
+	UMotionControllerComponent* hand = GetHolderHand(grabState);
+	USceneComponent* currentParent = GetGrabbedPrimitive()->GetAttachParent();
+
+	if (hand)
+	{
+		// The local holder placed the object itself when it grabbed.
+		if (grabState.holder->IsLocallyControlled() && currentParent == hand) return;
+
+		const FTransform gripTransform(VRAvatarPose::DecompressRotation(grabState.gripRotation), grabState.gripLocation);
+		AttachToHand(hand, gripTransform, smooth);
+	}
+	else if (currentParent && currentParent->IsA<UMotionControllerComponent>())
+	{
+		// Released or never ours: hand it back to physics; replicated movement corrects it from here.
+		Detach();
+	}
+}
+
+void UGrabComponent::AttachToHand(UMotionControllerComponent* hand, const FTransform& gripTransform, bool smooth)
+{
+	UPrimitiveComponent* primComponent = GetGrabbedPrimitive();
+	const FTransform previousWorld = primComponent->GetComponentTransform();
+
+	primComponent->SetSimulatePhysics(false);
+	primComponent->AttachToComponent(hand, FAttachmentTransformRules::KeepWorldTransform);
+
+	correctionTarget = gripTransform;
+	correctionFrom = previousWorld.GetRelativeTransform(hand->GetComponentTransform());
+	correctionAlpha = 0.f;
+	isCorrecting = smooth && correctionTime > 0.f;
+
+	primComponent->SetRelativeTransform(isCorrecting ? correctionFrom : correctionTarget);
+	UpdateTickEnabled();
+}
+
+void UGrabComponent::Detach()
+{
+	UPrimitiveComponent* primComponent = GetGrabbedPrimitive();
+
+	primComponent->K2_DetachFromComponent
 	(
 		EDetachmentRule::KeepWorld,
 		EDetachmentRule::KeepWorld,
 		EDetachmentRule::KeepWorld
 	);
+	primComponent->SetSimulatePhysics(true);
+
+	isCorrecting = false;
+	handSamples.Reset();
+	UpdateTickEnabled();
 }
 
-void UGrabComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UGrabComponent::SampleHand()
 {
+	const USceneComponent* parent = GetAttachParent();
+	if (!parent || !parent->GetAttachParent()) return;
+
+	if (handSamples.Num() >= handSampleCount)
+	{
+		handSamples.RemoveAt(0, 1, false);
+	}
+	handSamples.Add({ GetWorld()->GetTimeSeconds(), parent->GetComponentTransform() });
 }
 
+void UGrabComponent::EstimateVelocity(FVector& outLinear, FVector& outAngular) const
+{
+	outLinear = FVector::ZeroVector;
+	outAngular = FVector::ZeroVector;
+
+	if (handSamples.Num() < 2) return;
 
+	const FHandSample& oldest = handSamples[0];
+	const FHandSample& newest = handSamples.Last();
+	const double span = newest.time - oldest.time;
+	if (span <= 0.0) return;
+
+	outLinear = (newest.transform.GetLocation() - oldest.transform.GetLocation()) / span;
+
+	FVector axis;
+	double angle;
+	(newest.transform.GetRotation() * oldest.transform.GetRotation().Inverse()).GetNormalized().ToAxisAndAngle(axis, angle);
+	if (angle > UE_PI)
+	{
+		angle -= 2.0 * UE_PI;
+	}
+	outAngular = axis * FMath::RadiansToDegrees(angle) / span;
+}
+
+void UGrabComponent::UpdateTickEnabled()
+{
+	const USceneComponent* parent = GetAttachParent();
+	const USceneComponent* hand = parent ? parent->GetAttachParent() : nullptr;
+	const APawn* holder = hasPendingPrediction ? predictedHolder : grabState.holder;
+
+	const bool isHeldLocally = hand && hand->IsA<UMotionControllerComponent>() && IsValid(holder) && holder->IsLocallyControlled();
+
+	SetComponentTickEnabled(isHeldLocally || isCorrecting || hasPendingPrediction);
+}
+
+void UGrabComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SampleHand();
+
+	if (isCorrecting)
+	{
+		correctionAlpha = FMath::Min(1.f, correctionAlpha + DeltaTime / correctionTime);
+
+		FTransform blended;
+		blended.Blend(correctionFrom, correctionTarget, correctionAlpha);
+		GetGrabbedPrimitive()->SetRelativeTransform(blended);
+
+		if (correctionAlpha >= 1.f)
+		{
+			isCorrecting = false;
+			UpdateTickEnabled();
+		}
+	}
+
+	if (hasPendingPrediction && GetWorld()->GetTimeSeconds() - predictionTime > predictionTimeout)
+	{
+		AbandonPrediction();
+	}
+}
@@ -3,25 +3,152 @@
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
 #include "MotionControllerComponent.h"
+#include "Engine/NetSerialization.h"
 #include "GrabComponent.generated.h"
 
+// Who holds the object and where it sits in the holder's hand. Owned by the server.
+USTRUCT()
+struct FVRGrabState
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	class APawn* holder = nullptr;
+
+	UPROPERTY()
+	bool isLeftHand = false;
+
+	UPROPERTY()
+	FVector_NetQuantize100 gripLocation;
+
+	// Smallest-three compressed, see VRAvatarPose::CompressRotation.
+	UPROPERTY()
+	uint32 gripRotation = 0;
+
+	// Bumped by the server on every grab and release.
+	UPROPERTY()
+	uint8 epoch = 0;
+};
+
+// Object state at the moment the holding client let go.
+USTRUCT()
+struct FVRGrabReleaseSnapshot
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize100 location;
+
+	UPROPERTY()
+	uint32 rotation = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize10 linearVelocity;
+
+	// Degrees per second.
+	UPROPERTY()
+	FVector_NetQuantize10 angularVelocity;
+};
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class VRPROJECT_API UGrabComponent : public USceneComponent
 {
 	GENERATED_BODY()
 
+	struct FHandSample
+	{
+		double time;
+		FTransform transform;
+	};
+
+	static constexpr int32 handSampleCount = 6;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Mesh")
 	class UStaticMeshComponent* mesh;
 
-public:	
+	UPROPERTY(ReplicatedUsing = OnRep_GrabState)
+	FVRGrabState grabState;
+
+	// Time over which a corrected object blends into its authoritative place in the hand.
+	UPROPERTY(EditDefaultsOnly, Category = "Grab")
+	float correctionTime = 0.15f;
+
+	// How long a predicted grab or release waits for the server before reconciling anyway.
+	UPROPERTY(EditDefaultsOnly, Category = "Grab")
+	float predictionTimeout = 1.f;
+
+	// Server side reach check: how far the requesting hand may be from the object, with slack for latency.
+	UPROPERTY(EditDefaultsOnly, Category = "Grab")
+	float maxGrabDistance = 60.f;
+
+	// Server side clamp on the velocities a release snapshot may carry.
+	UPROPERTY(EditDefaultsOnly, Category = "Grab")
+	float maxThrowSpeed = 2000.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Grab")
+	float maxThrowAngularSpeed = 1440.f;
+
+	UPROPERTY()
+	class APawn* predictedHolder;
+
+	bool hasPendingPrediction = false;
+	double predictionTime = 0.0;
+
+	// Tags every prediction so answers to an earlier one are ignored.
+	uint8 lastPredictionId = 0;
+
+	TArray<FHandSample> handSamples;
+
+	bool isCorrecting = false;
+	float correctionAlpha = 0.f;
+	FTransform correctionFrom;
+	FTransform correctionTarget;
+
+public:
 	UGrabComponent();
 
 protected:
 	virtual void BeginPlay() override;
 
-public:	
+public:
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	bool TryGrab(UMotionControllerComponent* motionControllerComponent);
 	void TryRelease();
+
+	// Client side prediction: grab or release locally right away and remember what we expect the server to confirm.
+	bool PredictGrab(class APawn* holder, UMotionControllerComponent* motionControllerComponent);
+	FVRGrabReleaseSnapshot PredictRelease();
+	uint8 GetPredictionId() const;
+	// Settles the prediction tagged predictionId with the server's answer and the epoch it left the state at.
+	// Returns false for answers to a prediction that was superseded or timed out.
+	bool ResolvePrediction(uint8 predictionId, bool accepted, uint8 epoch);
+
+	// Server side arbitration. The first valid request wins; the holder owns the object until it lets go.
+	bool ServerTryGrab(class APawn* requester, bool isLeftHand, const FVector& gripLocation, uint32 gripRotation);
+	bool ServerTryRelease(class APawn* requester, const FVRGrabReleaseSnapshot& snapshot);
+
+	FTransform GetGripTransform() const;
+	class APawn* GetHolder() const;
+	uint8 GetEpoch() const;
+
+	UFUNCTION()
+	void OnRep_GrabState();
+
+private:
+	UPrimitiveComponent* GetGrabbedPrimitive() const;
+	UMotionControllerComponent* GetHolderHand(const FVRGrabState& state) const;
+
+	bool IsWithinReach(const class APawn* requester, bool isLeftHand, const FVector& location) const;
+	void BeginPrediction(class APawn* holder);
+	void AbandonPrediction();
+
+	void ApplyGrabState(bool smooth);
+	void AttachToHand(UMotionControllerComponent* hand, const FTransform& gripTransform, bool smooth);
+	void Detach();
+
+	void SampleHand();
+	void EstimateVelocity(FVector& outLinear, FVector& outAngular) const;
+	void UpdateTickEnabled();
 };
@@ -7,6 +7,9 @@ AGrabCube::AGrabCube()
 {
 	PrimaryActorTick.bCanEverTick = true;
 
+	bReplicates = true;
+	SetReplicatingMovement(true);
+
 	mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("StaticMesh"));
 	mesh->SetupAttachment(RootComponent);
 
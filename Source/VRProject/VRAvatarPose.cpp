@@ -0,0 +1,233 @@
+#include "VRAvatarPose.h"
+
+uint32 VRAvatarPose::CompressRotation(const FQuat& rotation)
+{
+	const FQuat normalized = rotation.GetNormalized();
+	const double components[4] = { normalized.X, normalized.Y, normalized.Z, normalized.W };
+
+	int32 largest = 0;
+	for (int32 i = 1; i < 4; ++i)
+	{
+		if (FMath::Abs(components[i]) > FMath::Abs(components[largest]))
+		{
+			largest = i;
+		}
+	}
+
+	// q and -q are the same rotation, so flip the sign to make the dropped component positive.
+	const double sign = (components[largest] < 0.0) ? -1.0 : 1.0;
+	const int32 maxValue = (1 << RotationComponentBits) - 1;
+
+	uint32 packed = (uint32)largest;
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (i == largest) continue;
+
+		const double unit = (components[i] * sign / UE_HALF_SQRT_2 + 1.0) * 0.5;
+		const int32 quantized = FMath::Clamp(FMath::RoundToInt(unit * maxValue), 0, maxValue);
+		packed = (packed << RotationComponentBits) | (uint32)quantized;
+	}
+
+	return packed;
+}
+
+FQuat VRAvatarPose::DecompressRotation(uint32 packed)
+{
+	const uint32 maxValue = (1u << RotationComponentBits) - 1;
+	const int32 largest = (int32)(packed >> (RotationComponentBits * 3));
+
+	double components[4];
+	double sumSquares = 0.0;
+	int32 shift = RotationComponentBits * 2;
+
+	for (int32 i = 0; i < 4; ++i)
+	{
+		if (i == largest) continue;
+
+		const uint32 quantized = (packed >> shift) & maxValue;
+		shift -= RotationComponentBits;
+
+		components[i] = ((double)quantized / maxValue * 2.0 - 1.0) * UE_HALF_SQRT_2;
+		sumSquares += components[i] * components[i];
+	}
+
+	components[largest] = FMath::Sqrt(FMath::Max(0.0, 1.0 - sumSquares));
+
+	FQuat rotation(components[0], components[1], components[2], components[3]);
+	rotation.Normalize();
+	return rotation;
+}
+
+FVRAvatarPose::FVRAvatarPose()
+{
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		locations[tracker] = FVector::ZeroVector;
+		rotations[tracker] = FQuat::Identity;
+	}
+}
+
+FVRAvatarPose FVRAvatarPose::Interpolate(const FVRAvatarPose& a, const FVRAvatarPose& b, float alpha)
+{
+	FVRAvatarPose result;
+
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		result.locations[tracker] = FMath::Lerp(a.locations[tracker], b.locations[tracker], (double)alpha);
+		result.rotations[tracker] = FQuat::Slerp(a.rotations[tracker], b.rotations[tracker], alpha);
+	}
+
+	return result;
+}
+
+FVRCompressedAvatarPose::FVRCompressedAvatarPose()
+{
+	FMemory::Memzero(locations);
+
+	const uint32 identity = VRAvatarPose::CompressRotation(FQuat::Identity);
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		rotations[tracker] = identity;
+	}
+}
+
+FVRCompressedAvatarPose FVRCompressedAvatarPose::Compress(const FVRAvatarPose& pose)
+{
+	FVRCompressedAvatarPose result;
+
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			const int32 quantized = FMath::RoundToInt(pose.locations[tracker][axis] * VRAvatarPose::LocationScale);
+			result.locations[tracker * 3 + axis] = (int16)FMath::Clamp(quantized, -MAX_int16, (int32)MAX_int16);
+		}
+
+		result.rotations[tracker] = VRAvatarPose::CompressRotation(pose.rotations[tracker]);
+	}
+
+	return result;
+}
+
+FVRAvatarPose FVRCompressedAvatarPose::Decompress() const
+{
+	FVRAvatarPose result;
+
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			result.locations[tracker][axis] = locations[tracker * 3 + axis] / VRAvatarPose::LocationScale;
+		}
+
+		result.rotations[tracker] = VRAvatarPose::DecompressRotation(rotations[tracker]);
+	}
+
+	return result;
+}
+
+uint8 FVRCompressedAvatarPose::GetChangedFields(const FVRCompressedAvatarPose& other) const
+{
+	uint8 mask = 0;
+
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		const int32 first = tracker * 3;
+		if (locations[first] != other.locations[first] || locations[first + 1] != other.locations[first + 1] || locations[first + 2] != other.locations[first + 2])
+		{
+			mask |= VRAvatarPose::LocationBit(tracker);
+		}
+
+		if (rotations[tracker] != other.rotations[tracker])
+		{
+			mask |= VRAvatarPose::RotationBit(tracker);
+		}
+	}
+
+	return mask;
+}
+
+void FVRCompressedAvatarPose::CopyFields(const FVRCompressedAvatarPose& source, uint8 mask)
+{
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		if (mask & VRAvatarPose::LocationBit(tracker))
+		{
+			for (int32 axis = 0; axis < 3; ++axis)
+			{
+				locations[tracker * 3 + axis] = source.locations[tracker * 3 + axis];
+			}
+		}
+
+		if (mask & VRAvatarPose::RotationBit(tracker))
+		{
+			rotations[tracker] = source.rotations[tracker];
+		}
+	}
+}
+
+void FVRCompressedAvatarPose::SerializeFields(FArchive& Ar, uint8 mask)
+{
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		if (mask & VRAvatarPose::LocationBit(tracker))
+		{
+			for (int32 axis = 0; axis < 3; ++axis)
+			{
+				Ar << locations[tracker * 3 + axis];
+			}
+		}
+
+		if (mask & VRAvatarPose::RotationBit(tracker))
+		{
+			Ar << rotations[tracker];
+		}
+	}
+}
+
+bool FVRCompressedAvatarPose::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	SerializeFields(Ar, VRAvatarPose::AllFieldsMask);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+bool FVRCompressedAvatarPose::Identical(const FVRCompressedAvatarPose* other, uint32 portFlags) const
+{
+	return *this == *other;
+}
+
+bool FVRCompressedAvatarPose::operator==(const FVRCompressedAvatarPose& other) const
+{
+	return GetChangedFields(other) == 0;
+}
+
+bool FVRAvatarPoseDelta::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << sequence;
+
+	uint8 keyframeBit = isKeyframe ? 1 : 0;
+	Ar.SerializeBits(&keyframeBit, 1);
+	isKeyframe = (keyframeBit != 0);
+
+	if (isKeyframe)
+	{
+		changedMask = VRAvatarPose::AllFieldsMask;
+	}
+	else
+	{
+		Ar << baselineSequence;
+
+		if (Ar.IsLoading())
+		{
+			changedMask = 0;
+		}
+		Ar.SerializeBits(&changedMask, VRAvatarPose::FieldCount);
+	}
+
+	pose.SerializeFields(Ar, changedMask);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VRAvatarPose.generated.h"
+
+namespace VRAvatarPose
+{
+	enum ETracker : int32
+	{
+		Head = 0,
+		Left,
+		Right,
+		TrackerCount
+	};
+
+	constexpr int32 FieldCount = TrackerCount * 2;
+	constexpr uint8 AllFieldsMask = (1 << FieldCount) - 1;
+
+	// Positions are quantized relative to the actor in 0.5 mm steps (+-16 m range in an int16).
+	constexpr double LocationScale = 20.0;
+	// Smallest-three quaternion: 2 bits for the dropped component index, 10 bits for each of the other three.
+	constexpr int32 RotationComponentBits = 10;
+
+	inline uint8 LocationBit(int32 tracker) { return 1 << (tracker * 2); }
+	inline uint8 RotationBit(int32 tracker) { return 1 << (tracker * 2 + 1); }
+
+	uint32 CompressRotation(const FQuat& rotation);
+	FQuat DecompressRotation(uint32 packed);
+
+	// Sequence numbers wrap, so "newer" is decided on the signed 16 bit difference.
+	inline bool IsNewerSequence(uint16 a, uint16 b) { return (int16)(a - b) > 0; }
+}
+
+// Head and hand transforms relative to the owning actor, in full precision.
+struct VRPROJECT_API FVRAvatarPose
+{
+	FVector locations[VRAvatarPose::TrackerCount];
+	FQuat rotations[VRAvatarPose::TrackerCount];
+
+	FVRAvatarPose();
+
+	static FVRAvatarPose Interpolate(const FVRAvatarPose& a, const FVRAvatarPose& b, float alpha);
+};
+
+// Quantized pose as it goes over the wire. A full pose is 3 * (48 + 32) = 240 bits.
+USTRUCT()
+struct VRPROJECT_API FVRCompressedAvatarPose
+{
+	GENERATED_BODY()
+
+	int16 locations[VRAvatarPose::TrackerCount * 3];
+	uint32 rotations[VRAvatarPose::TrackerCount];
+
+	FVRCompressedAvatarPose();
+
+	static FVRCompressedAvatarPose Compress(const FVRAvatarPose& pose);
+	FVRAvatarPose Decompress() const;
+
+	// Bit mask (see VRAvatarPose::LocationBit/RotationBit) of the fields that differ from other.
+	uint8 GetChangedFields(const FVRCompressedAvatarPose& other) const;
+	void CopyFields(const FVRCompressedAvatarPose& source, uint8 mask);
+	void SerializeFields(FArchive& Ar, uint8 mask);
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+	bool Identical(const FVRCompressedAvatarPose* other, uint32 portFlags) const;
+	bool operator==(const FVRCompressedAvatarPose& other) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FVRCompressedAvatarPose> : public TStructOpsTypeTraitsBase2<FVRCompressedAvatarPose>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdentical = true,
+	};
+};
+
+// Owner -> server pose update. Only the fields that changed since the last pose acknowledged
+// by the server (baselineSequence) are serialized; keyframes carry every field.
+USTRUCT()
+struct VRPROJECT_API FVRAvatarPoseDelta
+{
+	GENERATED_BODY()
+
+	uint16 sequence = 0;
+	uint16 baselineSequence = 0;
+	bool isKeyframe = true;
+	uint8 changedMask = VRAvatarPose::AllFieldsMask;
+	FVRCompressedAvatarPose pose;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FVRAvatarPoseDelta> : public TStructOpsTypeTraitsBase2<FVRAvatarPoseDelta>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
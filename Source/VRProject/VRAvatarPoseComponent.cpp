@@ -0,0 +1,396 @@
+#include "VRAvatarPoseComponent.h"
+#include "Components/SceneComponent.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/BitWriter.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogVRAvatarPose, Log, All);
+
+static TAutoConsoleVariable<int32> CVarAvatarPoseLogStats(
+	TEXT("vr.AvatarPose.LogStats"),
+	0,
+	TEXT("Log bandwidth and reconstruction error of replicated avatar poses once per second.\n")
+	TEXT("0: off, 1: on"));
+
+UVRAvatarPoseComponent::UVRAvatarPoseComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	SetIsReplicatedByDefault(true);
+	trackedComponents.SetNumZeroed(VRAvatarPose::TrackerCount);
+}
+
+void UVRAvatarPoseComponent::SetTrackedComponents(USceneComponent* head, USceneComponent* left, USceneComponent* right)
+{
+	trackedComponents.SetNumZeroed(VRAvatarPose::TrackerCount);
+	trackedComponents[VRAvatarPose::Head] = head;
+	trackedComponents[VRAvatarPose::Left] = left;
+	trackedComponents[VRAvatarPose::Right] = right;
+}
+
+FVRAvatarPoseStats UVRAvatarPoseComponent::GetPoseStats() const
+{
+	return stats;
+}
+
+void UVRAvatarPoseComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	lastSampledPose = SampleTrackedPose();
+	statsWindowStart = GetWorld()->GetTimeSeconds();
+}
+
+void UVRAvatarPoseComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(UVRAvatarPoseComponent, replicatedPose, COND_SkipOwner);
+}
+
+void UVRAvatarPoseComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (IsLocallyControlled())
+	{
+		const FVRAvatarPose pose = SampleTrackedPose();
+		const float motion = UpdateMotion(pose, DeltaTime);
+		float rate = FMath::Lerp(idleSendRate, maxSendRate, motion);
+		if (GetOwnerRole() == ROLE_Authority)
+		{
+			rate *= GetViewerDistanceRateScale();
+		}
+
+		if (ShouldSend(rate))
+		{
+			if (GetOwnerRole() == ROLE_Authority)
+			{
+				// Listen server host: nothing to acknowledge, forward straight to the other clients.
+				const FVRCompressedAvatarPose compressed = FVRCompressedAvatarPose::Compress(pose);
+				ForwardPose(compressed);
+
+				FBitWriter writer(0, true);
+				FVRCompressedAvatarPose copy = compressed;
+				bool success = true;
+				copy.NetSerialize(writer, nullptr, success);
+				RecordSend(writer.GetNumBits(), pose, compressed);
+			}
+			else
+			{
+				SendOwnerPose(pose);
+			}
+		}
+	}
+	else
+	{
+		if (hasPendingForward && ShouldSend(FMath::Lerp(idleSendRate, maxSendRate, smoothedMotion) * GetViewerDistanceRateScale()))
+		{
+			hasPendingForward = false;
+			ForwardPose(pendingForwardPose);
+		}
+
+		FVRAvatarPose pose;
+		if (SampleInterpolationBuffer(GetWorld()->GetTimeSeconds() - interpolationDelay, pose))
+		{
+			ApplyPose(pose);
+		}
+	}
+
+	UpdateStats();
+}
+
+bool UVRAvatarPoseComponent::IsLocallyControlled() const
+{
+	const APawn* pawn = Cast<APawn>(GetOwner());
+	return pawn && pawn->IsLocallyControlled();
+}
+
+FVRAvatarPose UVRAvatarPoseComponent::SampleTrackedPose() const
+{
+	FVRAvatarPose pose;
+
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		const USceneComponent* component = trackedComponents.IsValidIndex(tracker) ? trackedComponents[tracker] : nullptr;
+		if (IsValid(component))
+		{
+			pose.locations[tracker] = component->GetRelativeLocation();
+			pose.rotations[tracker] = component->GetRelativeRotation().Quaternion();
+		}
+	}
+
+	return pose;
+}
+
+void UVRAvatarPoseComponent::ApplyPose(const FVRAvatarPose& pose)
+{
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		USceneComponent* component = trackedComponents.IsValidIndex(tracker) ? trackedComponents[tracker] : nullptr;
+		if (IsValid(component))
+		{
+			component->SetRelativeLocationAndRotation(pose.locations[tracker], pose.rotations[tracker]);
+		}
+	}
+}
+
+float UVRAvatarPoseComponent::UpdateMotion(const FVRAvatarPose& pose, float deltaTime)
+{
+	if (deltaTime <= 0.f) return smoothedMotion;
+
+	float motion = 0.f;
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		const float linearSpeed = FVector::Dist(pose.locations[tracker], lastSampledPose.locations[tracker]) / deltaTime;
+		const float angularSpeed = FMath::RadiansToDegrees(pose.rotations[tracker].AngularDistance(lastSampledPose.rotations[tracker])) / deltaTime;
+
+		motion = FMath::Max3(motion, linearSpeed / fastLinearSpeed, angularSpeed / fastAngularSpeed);
+	}
+
+	lastSampledPose = pose;
+
+	// Rise immediately so the start of a fast gesture is not missed, decay over ~0.25 s.
+	motion = FMath::Clamp(motion, 0.f, 1.f);
+	smoothedMotion = (motion > smoothedMotion) ? motion : FMath::FInterpTo(smoothedMotion, motion, deltaTime, 4.f);
+	return smoothedMotion;
+}
+
+float UVRAvatarPoseComponent::GetViewerDistanceRateScale() const
+{
+	const FVector ownerLocation = GetOwner()->GetActorLocation();
+	double closestDistanceSquared = TNumericLimits<double>::Max();
+
+	for (FConstPlayerControllerIterator iterator = GetWorld()->GetPlayerControllerIterator(); iterator; ++iterator)
+	{
+		const APlayerController* controller = iterator->Get();
+		if (!controller || controller->GetPawn() == GetOwner()) continue;
+
+		FVector viewLocation;
+		FRotator viewRotation;
+		controller->GetPlayerViewPoint(viewLocation, viewRotation);
+		closestDistanceSquared = FMath::Min(closestDistanceSquared, FVector::DistSquared(viewLocation, ownerLocation));
+	}
+
+	if (closestDistanceSquared == TNumericLimits<double>::Max()) return farDistanceRateScale;
+
+	const float alpha = FMath::GetRangePct(nearDistance, farDistance, (float)FMath::Sqrt(closestDistanceSquared));
+	return FMath::Lerp(1.f, farDistanceRateScale, FMath::Clamp(alpha, 0.f, 1.f));
+}
+
+bool UVRAvatarPoseComponent::ShouldSend(float rate) const
+{
+	if (lastSendTime < 0.0) return true;
+
+	return (GetWorld()->GetTimeSeconds() - lastSendTime) >= 1.0 / FMath::Max(rate, KINDA_SMALL_NUMBER);
+}
+
+void UVRAvatarPoseComponent::SendOwnerPose(const FVRAvatarPose& pose)
+{
+	FVRAvatarPoseDelta delta;
+	delta.sequence = nextSequence++;
+	delta.pose = FVRCompressedAvatarPose::Compress(pose);
+
+	// Fall back to a keyframe until the server acknowledged something, or when the last ack is
+	// so old that the server may no longer hold that baseline.
+	const bool baselineUsable = hasAckedBaseline && (uint16)(delta.sequence - ackedSequence) < historySize / 2;
+	if (baselineUsable)
+	{
+		delta.isKeyframe = false;
+		delta.baselineSequence = ackedSequence;
+		delta.changedMask = delta.pose.GetChangedFields(ackedBaseline);
+
+		// Nothing changed since the acknowledged pose and the server already has it.
+		if (delta.changedMask == 0 && delta.pose == lastSentPose)
+		{
+			--nextSequence;
+			return;
+		}
+	}
+
+	sentHistory.Add(TPair<uint16, FVRCompressedAvatarPose>(delta.sequence, delta.pose));
+	if (sentHistory.Num() > historySize)
+	{
+		sentHistory.RemoveAt(0, sentHistory.Num() - historySize, false);
+	}
+
+	FBitWriter writer(0, true);
+	bool success = true;
+	delta.NetSerialize(writer, nullptr, success);
+
+	ServerSendPose(delta);
+	RecordSend(writer.GetNumBits(), pose, delta.pose);
+}
+
+void UVRAvatarPoseComponent::ServerSendPose_Implementation(const FVRAvatarPoseDelta& delta)
+{
+	FVRCompressedAvatarPose pose;
+
+	if (delta.isKeyframe)
+	{
+		pose = delta.pose;
+	}
+	else
+	{
+		const TPair<uint16, FVRCompressedAvatarPose>* baseline = receivedHistory.FindByPredicate([&delta](const TPair<uint16, FVRCompressedAvatarPose>& entry)
+		{
+			return entry.Key == delta.baselineSequence;
+		});
+
+		// Baseline already evicted; the client switches to keyframes once its acks go stale.
+		if (!baseline) return;
+
+		pose = baseline->Value;
+		pose.CopyFields(delta.pose, delta.changedMask);
+	}
+
+	receivedHistory.Add(TPair<uint16, FVRCompressedAvatarPose>(delta.sequence, pose));
+	if (receivedHistory.Num() > historySize)
+	{
+		receivedHistory.RemoveAt(0, receivedHistory.Num() - historySize, false);
+	}
+
+	ClientAckPose(delta.sequence);
+
+	// Late packets still serve as baselines but never move the pose backwards.
+	if (hasReceived && !VRAvatarPose::IsNewerSequence(delta.sequence, newestReceivedSequence)) return;
+
+	hasReceived = true;
+	newestReceivedSequence = delta.sequence;
+
+	const double now = GetWorld()->GetTimeSeconds();
+	const FVRAvatarPose decompressed = pose.Decompress();
+	PushSample(decompressed);
+	UpdateMotion(decompressed, (float)(now - lastReceiveTime));
+
+	lastReceiveTime = now;
+	pendingForwardPose = pose;
+	hasPendingForward = true;
+}
+
+void UVRAvatarPoseComponent::ClientAckPose_Implementation(uint16 sequence)
+{
+	if (hasAckedBaseline && !VRAvatarPose::IsNewerSequence(sequence, ackedSequence)) return;
+
+	const TPair<uint16, FVRCompressedAvatarPose>* sent = sentHistory.FindByPredicate([sequence](const TPair<uint16, FVRCompressedAvatarPose>& entry)
+	{
+		return entry.Key == sequence;
+	});
+	if (!sent) return;
+
+	hasAckedBaseline = true;
+	ackedSequence = sequence;
+	ackedBaseline = sent->Value;
+}
+
+void UVRAvatarPoseComponent::ForwardPose(const FVRCompressedAvatarPose& pose)
+{
+	replicatedPose = pose;
+	lastSentPose = pose;
+	lastSendTime = GetWorld()->GetTimeSeconds();
+}
+
+void UVRAvatarPoseComponent::OnRep_ReplicatedPose()
+{
+	PushSample(replicatedPose.Decompress());
+}
+
+void UVRAvatarPoseComponent::PushSample(const FVRAvatarPose& pose)
+{
+	interpolationBuffer.Add({ GetWorld()->GetTimeSeconds(), pose });
+	if (interpolationBuffer.Num() > bufferSize)
+	{
+		interpolationBuffer.RemoveAt(0, interpolationBuffer.Num() - bufferSize, false);
+	}
+}
+
+bool UVRAvatarPoseComponent::SampleInterpolationBuffer(double renderTime, FVRAvatarPose& outPose) const
+{
+	const int32 count = interpolationBuffer.Num();
+	if (count == 0) return false;
+
+	if (count == 1 || renderTime <= interpolationBuffer[0].time)
+	{
+		outPose = interpolationBuffer[renderTime <= interpolationBuffer[0].time ? 0 : count - 1].pose;
+		return true;
+	}
+
+	for (int32 i = count - 1; i > 0; --i)
+	{
+		const FPoseSample& from = interpolationBuffer[i - 1];
+		const FPoseSample& to = interpolationBuffer[i];
+
+		if (renderTime >= from.time && renderTime <= to.time)
+		{
+			const double span = to.time - from.time;
+			const float alpha = (span > 0.0) ? (float)((renderTime - from.time) / span) : 1.f;
+			outPose = FVRAvatarPose::Interpolate(from.pose, to.pose, alpha);
+			return true;
+		}
+	}
+
+	// Starved: continue along the last segment for a short while, then hold.
+	const FPoseSample& from = interpolationBuffer[count - 2];
+	const FPoseSample& to = interpolationBuffer[count - 1];
+	const double span = to.time - from.time;
+	const double ahead = FMath::Min(renderTime - to.time, (double)maxExtrapolationTime);
+
+	outPose = (span > 0.0) ? FVRAvatarPose::Interpolate(from.pose, to.pose, (float)(1.0 + ahead / span)) : to.pose;
+	return true;
+}
+
+void UVRAvatarPoseComponent::RecordSend(int64 bits, const FVRAvatarPose& source, const FVRCompressedAvatarPose& compressed)
+{
+	lastSentPose = compressed;
+	lastSendTime = GetWorld()->GetTimeSeconds();
+
+	windowBits += bits;
+	++windowPackets;
+
+	const FVRAvatarPose reconstructed = compressed.Decompress();
+	for (int32 tracker = 0; tracker < VRAvatarPose::TrackerCount; ++tracker)
+	{
+		const float locationError = FVector::Dist(source.locations[tracker], reconstructed.locations[tracker]);
+		const float rotationError = FMath::RadiansToDegrees(source.rotations[tracker].AngularDistance(reconstructed.rotations[tracker]));
+
+		locationErrorSum += locationError;
+		rotationErrorSum += rotationError;
+		windowMaxLocationError = FMath::Max(windowMaxLocationError, locationError);
+		windowMaxRotationError = FMath::Max(windowMaxRotationError, rotationError);
+		++errorSamples;
+	}
+}
+
+void UVRAvatarPoseComponent::UpdateStats()
+{
+	const double now = GetWorld()->GetTimeSeconds();
+	const double elapsed = now - statsWindowStart;
+	if (elapsed < 1.0) return;
+
+	stats.bytesPerSecond = (float)(windowBits / 8.0 / elapsed);
+	stats.packetsPerSecond = (float)(windowPackets / elapsed);
+	stats.averageLocationError = errorSamples > 0 ? (float)(locationErrorSum / errorSamples) : 0.f;
+	stats.averageRotationErrorDegrees = errorSamples > 0 ? (float)(rotationErrorSum / errorSamples) : 0.f;
+	stats.maxLocationError = windowMaxLocationError;
+	stats.maxRotationErrorDegrees = windowMaxRotationError;
+
+	if (CVarAvatarPoseLogStats.GetValueOnGameThread() != 0 && windowPackets > 0)
+	{
+		UE_LOG(LogVRAvatarPose, Log, TEXT("%s: %.1f bytes/s, %.1f packets/s, location error avg %.3f max %.3f cm, rotation error avg %.3f max %.3f deg"),
+			*GetOwner()->GetName(), stats.bytesPerSecond, stats.packetsPerSecond,
+			stats.averageLocationError, stats.maxLocationError, stats.averageRotationErrorDegrees, stats.maxRotationErrorDegrees);
+	}
+
+	statsWindowStart = now;
+	windowBits = 0;
+	windowPackets = 0;
+	errorSamples = 0;
+	locationErrorSum = 0.0;
+	rotationErrorSum = 0.0;
+	windowMaxLocationError = 0.f;
+	windowMaxRotationError = 0.f;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "VRAvatarPose.h"
+#include "VRAvatarPoseComponent.generated.h"
+
+class USceneComponent;
+
+USTRUCT(BlueprintType)
+struct FVRAvatarPoseStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float bytesPerSecond = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float packetsPerSecond = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float averageLocationError = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float maxLocationError = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float averageRotationErrorDegrees = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Replication")
+	float maxRotationErrorDegrees = 0.f;
+};
+
+// Replicates the head and hand transforms of a VR pawn in compressed form.
+// The locally controlled pawn sends deltas against the last pose the server acknowledged,
+// the server forwards the full compressed pose to everybody else, and remote copies
+// render from an interpolation buffer (extrapolating briefly when it runs dry).
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class VRPROJECT_API UVRAvatarPoseComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	struct FPoseSample
+	{
+		double time;
+		FVRAvatarPose pose;
+	};
+
+	static constexpr int32 historySize = 32;
+	static constexpr int32 bufferSize = 16;
+
+	// Indexed by VRAvatarPose::ETracker.
+	UPROPERTY()
+	TArray<class USceneComponent*> trackedComponents;
+
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedPose)
+	FVRCompressedAvatarPose replicatedPose;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Send Rate")
+	float idleSendRate = 5.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Send Rate")
+	float maxSendRate = 45.f;
+
+	// Linear (cm/s) and angular (deg/s) speeds at which the pose is sent at maxSendRate.
+	UPROPERTY(EditDefaultsOnly, Category = "Send Rate")
+	float fastLinearSpeed = 100.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Send Rate")
+	float fastAngularSpeed = 180.f;
+
+	// The server scales its forwarding rate down to farDistanceRateScale as the closest viewer moves from nearDistance to farDistance.
+	UPROPERTY(EditDefaultsOnly, Category = "Send Rate")
+	float nearDistance = 500.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Send Rate")
+	float farDistance = 3000.f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Send Rate")
+	float farDistanceRateScale = 0.2f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Interpolation")
+	float interpolationDelay = 0.1f;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Interpolation")
+	float maxExtrapolationTime = 0.15f;
+
+	// Owner side.
+	uint16 nextSequence = 0;
+	uint16 ackedSequence = 0;
+	bool hasAckedBaseline = false;
+	FVRCompressedAvatarPose ackedBaseline;
+	TArray<TPair<uint16, FVRCompressedAvatarPose>> sentHistory;
+
+	// Server side.
+	uint16 newestReceivedSequence = 0;
+	bool hasReceived = false;
+	TArray<TPair<uint16, FVRCompressedAvatarPose>> receivedHistory;
+	FVRCompressedAvatarPose pendingForwardPose;
+	bool hasPendingForward = false;
+	double lastReceiveTime = 0.0;
+
+	// Shared between sending roles.
+	FVRAvatarPose lastSampledPose;
+	FVRCompressedAvatarPose lastSentPose;
+	float smoothedMotion = 0.f;
+	double lastSendTime = -1.0;
+
+	// Remote side.
+	TArray<FPoseSample> interpolationBuffer;
+
+	// Measurement window.
+	double statsWindowStart = 0.0;
+	int64 windowBits = 0;
+	int32 windowPackets = 0;
+	int32 errorSamples = 0;
+	double locationErrorSum = 0.0;
+	double rotationErrorSum = 0.0;
+	float windowMaxLocationError = 0.f;
+	float windowMaxRotationError = 0.f;
+	FVRAvatarPoseStats stats;
+
+public:
+	UVRAvatarPoseComponent();
+
+	void SetTrackedComponents(USceneComponent* head, USceneComponent* left, USceneComponent* right);
+
+	UFUNCTION(BlueprintCallable, Category = "Replication")
+	FVRAvatarPoseStats GetPoseStats() const;
+
+protected:
+	virtual void BeginPlay() override;
+
+public:
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION(Server, Unreliable)
+	void ServerSendPose(const FVRAvatarPoseDelta& delta);
+
+	UFUNCTION(Client, Unreliable)
+	void ClientAckPose(uint16 sequence);
+
+	UFUNCTION()
+	void OnRep_ReplicatedPose();
+
+private:
+	bool IsLocallyControlled() const;
+	FVRAvatarPose SampleTrackedPose() const;
+	void ApplyPose(const FVRAvatarPose& pose);
+
+	float UpdateMotion(const FVRAvatarPose& pose, float deltaTime);
+	float GetViewerDistanceRateScale() const;
+	bool ShouldSend(float rate) const;
+
+	void SendOwnerPose(const FVRAvatarPose& pose);
+	void ForwardPose(const FVRCompressedAvatarPose& pose);
+
+	void PushSample(const FVRAvatarPose& pose);
+	bool SampleInterpolationBuffer(double renderTime, FVRAvatarPose& outPose) const;
+
+	void RecordSend(int64 bits, const FVRAvatarPose& source, const FVRCompressedAvatarPose& compressed);
+	void UpdateStats();
+};
@@ -14,6 +14,8 @@
 #include "NiagaraComponent.h"
 #include "VRTeleportVisualizer.h"
 #include "NiagaraDataInterfaceArrayFunctionLibrary.h"
+#include "VRAvatarPoseComponent.h"
+#include "VRAvatarPose.h"
 
 AVRCharacter::AVRCharacter()
 {
@@ -38,6 +40,9 @@ AVRCharacter::AVRCharacter()
 
 	teleportTraceNiagaraSystem = CreateDefaultSubobject<UNiagaraComponent>(TEXT("teleportTraceNiagara"));
 	teleportTraceNiagaraSystem->SetupAttachment(RootComponent);
+
+	avatarPose = CreateDefaultSubobject<UVRAvatarPoseComponent>(TEXT("AvatarPose"));
+	avatarPose->SetTrackedComponents(camera, leftMotionController, rightMotionController);
 }
 
 void AVRCharacter::BeginPlay()
@@ -106,7 +111,7 @@ void AVRCharacter::Grab_Started(const FInputActionValue& value, UMotionControlle
 		if (actor->IsA(AGrabCube::StaticClass()))
 		{
 			UGrabComponent* grabComponent = Cast<AGrabCube>(actor)->GetGrabComponent();
-			grabComponent->TryGrab(motionController);
+			if (!RequestGrab(grabComponent, motionController)) continue;
 		
 			if (motionController->GetTrackingMotionSource() == "Left")
 			{
@@ -127,16 +132,90 @@ void AVRCharacter::Grab_Completed(const FInputActionValue& value, UMotionControl
 	//UKismetSystemLibrary::PrintString(GetWorld(), L"Grab_Completed", true, true, FLinearColor::Green);
 	if ((motionController->GetTrackingMotionSource() == "Left") && IsValid(leftGrabComponent))
 	{
-		leftGrabComponent->TryRelease();
+		RequestRelease(leftGrabComponent);
 		leftGrabComponent = nullptr;
 	}
 	else if ((motionController->GetTrackingMotionSource() == "Right") && IsValid(rightGrabComponent))
 	{
-		rightGrabComponent->TryRelease();
+		RequestRelease(rightGrabComponent);
 		rightGrabComponent = nullptr;
 	}
 }
 
+bool AVRCharacter::RequestGrab(UGrabComponent* grabComponent, UMotionControllerComponent* motionController)
+{
+	const bool isLeftHand = (motionController == leftMotionController);
+
+	// Where the object sits in the hand, taken before attaching so every machine can place it the same way.
+	const FTransform grip = grabComponent->GetAttachParent()->GetComponentTransform().GetRelativeTransform(motionController->GetComponentTransform());
+	const uint32 gripRotation = VRAvatarPose::CompressRotation(grip.GetRotation());
+
+	if (HasAuthority())
+	{
+		if (!grabComponent->ServerTryGrab(this, isLeftHand, grip.GetLocation(), gripRotation)) return false;
+		return grabComponent->TryGrab(motionController);
+	}
+
+	// Follow the hand right away; the server confirms or we roll back.
+	if (!grabComponent->PredictGrab(this, motionController)) return false;
+
+	ServerGrab(grabComponent, grabComponent->GetPredictionId(), isLeftHand, grip.GetLocation(), gripRotation);
+	return true;
+}
+
+void AVRCharacter::RequestRelease(UGrabComponent* grabComponent)
+{
+	if (HasAuthority())
+	{
+		grabComponent->TryRelease();
+
+		const FTransform transform = grabComponent->GetAttachParent()->GetComponentTransform();
+		FVRGrabReleaseSnapshot snapshot;
+		snapshot.location = transform.GetLocation();
+		snapshot.rotation = VRAvatarPose::CompressRotation(transform.GetRotation());
+		grabComponent->ServerTryRelease(this, snapshot);
+		return;
+	}
+
+	const FVRGrabReleaseSnapshot snapshot = grabComponent->PredictRelease();
+	ServerRelease(grabComponent, grabComponent->GetPredictionId(), snapshot);
+}
+
+UMotionControllerComponent* AVRCharacter::GetMotionController(bool isLeftHand) const
+{
+	return isLeftHand ? leftMotionController : rightMotionController;
+}
+
+void AVRCharacter::ServerGrab_Implementation(UGrabComponent* grabComponent, uint8 predictionId, bool isLeftHand, FVector_NetQuantize100 gripLocation, uint32 gripRotation)
+{
+	if (!IsValid(grabComponent)) return;
+
+	const bool accepted = grabComponent->ServerTryGrab(this, isLeftHand, gripLocation, gripRotation);
+	ClientGrabResult(grabComponent, predictionId, accepted, grabComponent->GetEpoch());
+}
+
+void AVRCharacter::ServerRelease_Implementation(UGrabComponent* grabComponent, uint8 predictionId, const FVRGrabReleaseSnapshot& snapshot)
+{
+	if (!IsValid(grabComponent)) return;
+
+	const bool accepted = grabComponent->ServerTryRelease(this, snapshot);
+	ClientGrabResult(grabComponent, predictionId, accepted, grabComponent->GetEpoch());
+}
+
+void AVRCharacter::ClientGrabResult_Implementation(UGrabComponent* grabComponent, uint8 predictionId, bool accepted, uint8 epoch)
+{
+	if (!IsValid(grabComponent)) return;
+
+	// An answer to a grab we already let go of, or gave up waiting for
+	if (!grabComponent->ResolvePrediction(predictionId, accepted, epoch)) return;
+
+	if (!accepted)
+	{
+		if (leftGrabComponent == grabComponent) leftGrabComponent = nullptr;
+		if (rightGrabComponent == grabComponent) rightGrabComponent = nullptr;
+	}
+}
+
 void AVRCharacter::Teleport_Started(const FInputActionValue& value)
 {
 	//UKismetSystemLibrary::PrintString(GetWorld(), L"Teleport_Started", true, true, FLinearColor::Green);
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "InputActionValue.h"
+#include "GrabComponent.h"
 #include "VRCharacter.generated.h"
 
 class UMotionControllerComponent;
@@ -14,6 +15,7 @@ class UGrabComponent;
 class USphereComponent;
 class UNiagaraComponent;
 class AVRTeleportVisualizer;
+class UVRAvatarPoseComponent;
 
 UCLASS()
 class VRPROJECT_API AVRCharacter : public ACharacter
@@ -33,6 +35,9 @@ class VRPROJECT_API AVRCharacter : public ACharacter
 	UPROPERTY(EditDefaultsOnly, Category = "Motion")
 	class UMotionControllerComponent* rightMotionController;
 
+	UPROPERTY(EditDefaultsOnly, Category = "Replication")
+	class UVRAvatarPoseComponent* avatarPose;
+
 	UPROPERTY(EditDefaultsOnly, Category = "Enhanced Input")
 	class UInputMappingContext* inputMapping;
 
@@ -85,6 +90,18 @@ public:
 
 	void Grab_Started(const FInputActionValue& value, UMotionControllerComponent* motionController);
 	void Grab_Completed(const FInputActionValue& value, UMotionControllerComponent* motionController);
+	bool RequestGrab(UGrabComponent* grabComponent, UMotionControllerComponent* motionController);
+	void RequestRelease(UGrabComponent* grabComponent);
+	UMotionControllerComponent* GetMotionController(bool isLeftHand) const;
+
+	UFUNCTION(Server, Reliable)
+	void ServerGrab(UGrabComponent* grabComponent, uint8 predictionId, bool isLeftHand, FVector_NetQuantize100 gripLocation, uint32 gripRotation);
+
+	UFUNCTION(Server, Reliable)
+	void ServerRelease(UGrabComponent* grabComponent, uint8 predictionId, const FVRGrabReleaseSnapshot& snapshot);
+
+	UFUNCTION(Client, Reliable)
+	void ClientGrabResult(UGrabComponent* grabComponent, uint8 predictionId, bool accepted, uint8 epoch);
 
 	void Teleport_Started(const FInputActionValue& value);
 	void Teleport_Triggered(const FInputActionValue& value);